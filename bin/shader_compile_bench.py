@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+# Copyright © 2022 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Replay a shader corpus through a standalone compiler and time it.
+
+The compiler command is run once per shader file, with the file appended to
+its arguments, e.g.:
+
+    shader_compile_bench.py --out new.json --baseline old.json \\
+        shaders/*.frag -- build/src/compiler/glsl/glsl_compiler --version 450 --time
+
+Phases the compiler reports itself on stderr as "time: <phase> <file> <us>"
+lines, like glsl_compiler --time does, are recorded separately.  The wall
+time of the whole process is always recorded as the "total" phase, so any
+compiler can be benchmarked.  Hardware backends can be run headlessly by
+passing the drm-shim library, e.g. --env LD_PRELOAD=.../libintel_noop_drm_shim.so.
+
+Each shader is compiled --repeat times and the fastest time is kept.  With
+--baseline, phases that got slower than --threshold percent are reported and
+the script exits with a non-zero status.
+"""
+
+import argparse
+import json
+import os
+import pathlib
+import re
+import subprocess
+import sys
+import time
+import typing
+
+TIME_RE = re.compile(r'^time: (?P<phase>\S+) (?P<file>.+) (?P<us>\d+)$')
+
+Results = typing.Dict[str, typing.Dict[str, int]]
+
+
+def parse_timings(stderr: str) -> typing.Dict[str, int]:
+    """Sums the per-phase times a compiler printed, in microseconds."""
+    phases: typing.Dict[str, int] = {}
+    for line in stderr.splitlines():
+        m = TIME_RE.match(line.strip())
+        if m:
+            phase = m.group('phase')
+            phases[phase] = phases.get(phase, 0) + int(m.group('us'))
+    return phases
+
+
+def run_one(cmd: typing.List[str], shader: str,
+            env: typing.Dict[str, str]) -> typing.Optional[typing.Dict[str, int]]:
+    start = time.perf_counter_ns()
+    p = subprocess.run(cmd + [shader], env=env, stdout=subprocess.DEVNULL,
+                       stderr=subprocess.PIPE, universal_newlines=True)
+    total = (time.perf_counter_ns() - start) // 1000
+    if p.returncode != 0:
+        print(f'{shader}: compiler exited with {p.returncode}', file=sys.stderr)
+        return None
+
+    phases = parse_timings(p.stderr)
+    phases['total'] = total
+    return phases
+
+
+def run(cmd: typing.List[str], shaders: typing.List[str], repeat: int,
+        env: typing.Dict[str, str]) -> Results:
+    results: Results = {}
+    for shader in shaders:
+        best: typing.Dict[str, int] = {}
+        for _ in range(repeat):
+            phases = run_one(cmd, shader, env)
+            if phases is None:
+                break
+            for phase, us in phases.items():
+                best[phase] = min(best.get(phase, us), us)
+        if best:
+            results[shader] = best
+    return results
+
+
+def compare(baseline: Results, results: Results,
+            threshold: float) -> typing.List[str]:
+    """Returns a message for every phase that regressed past threshold.
+
+    Shaders and phases that are only in one of the two sets are ignored, so
+    that the corpus can grow without invalidating old baselines.  The sum of
+    each phase over the whole corpus is also compared, because it catches
+    small regressions spread over many shaders.
+    """
+    regressions = []
+    old_sums: typing.Dict[str, int] = {}
+    new_sums: typing.Dict[str, int] = {}
+
+    for shader, phases in sorted(results.items()):
+        old_phases = baseline.get(shader)
+        if old_phases is None:
+            continue
+        for phase, us in sorted(phases.items()):
+            old = old_phases.get(phase)
+            if old is None:
+                continue
+            old_sums[phase] = old_sums.get(phase, 0) + old
+            new_sums[phase] = new_sums.get(phase, 0) + us
+            if old > 0 and us > old * (1 + threshold / 100):
+                regressions.append(f'{shader}: {phase} {old} -> {us} us '
+                                   f'(+{(us - old) * 100 / old:.1f}%)')
+
+    for phase, old in sorted(old_sums.items()):
+        new = new_sums[phase]
+        if old > 0 and new > old * (1 + threshold / 100):
+            regressions.append(f'all shaders: {phase} {old} -> {new} us '
+                               f'(+{(new - old) * 100 / old:.1f}%)')
+
+    return regressions
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0],
+        epilog='Everything after -- is the compiler command line.')
+    parser.add_argument('shaders', nargs='+', help='Shader files to compile')
+    parser.add_argument('--out', type=pathlib.Path,
+                        help='Write the results to this JSON file')
+    parser.add_argument('--baseline', type=pathlib.Path,
+                        help='Compare against results of a previous run')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='Allowed slowdown in percent (default: 5)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='Compile each shader this many times (default: 3)')
+    parser.add_argument('--env', action='append', default=[],
+                        metavar='NAME=VALUE',
+                        help='Extra environment for the compiler, e.g. a drm-shim LD_PRELOAD')
+    argv = sys.argv[1:]
+    if '--' not in argv:
+        parser.error('missing compiler command after --')
+    split = argv.index('--')
+    args = parser.parse_args(argv[:split])
+    cmd = argv[split + 1:]
+    if not cmd:
+        parser.error('missing compiler command after --')
+
+    env = dict(os.environ)
+    for e in args.env:
+        name, _, value = e.partition('=')
+        env[name] = value
+
+    results = run(cmd, args.shaders, args.repeat, env)
+
+    if args.out:
+        with args.out.open('w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+    if args.baseline:
+        with args.baseline.open('r') as f:
+            baseline = json.load(f)
+        regressions = compare(baseline, results, args.threshold)
+        for r in regressions:
+            print(r)
+        if regressions:
+            sys.exit(1)
+
+    if len(results) != len(args.shaders):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
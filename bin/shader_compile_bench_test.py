@@ -0,0 +1,62 @@
+# Copyright © 2022 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+from .shader_compile_bench import compare, parse_timings
+
+
+def test_parse_timings() -> None:
+    stderr = '\n'.join([
+        'Info log for a.frag:',
+        'time: compile a.frag 120',
+        'time: compile b.frag 30',
+        'time: link a.frag 50',
+        'time: not a number',
+    ])
+    assert parse_timings(stderr) == {'compile': 150, 'link': 50}
+
+
+def test_compare_no_regression() -> None:
+    baseline = {'a.frag': {'compile': 100, 'total': 1000}}
+    results = {'a.frag': {'compile': 104, 'total': 900}}
+    assert compare(baseline, results, 5.0) == []
+
+
+def test_compare_regression() -> None:
+    baseline = {'a.frag': {'compile': 100, 'total': 1000}}
+    results = {'a.frag': {'compile': 120, 'total': 1000}}
+    regressions = compare(baseline, results, 5.0)
+    assert len(regressions) == 2
+    assert regressions[0].startswith('a.frag: compile 100 -> 120')
+    assert regressions[1].startswith('all shaders: compile')
+
+
+def test_compare_ignores_new_shaders_and_phases() -> None:
+    baseline = {'a.frag': {'total': 1000}}
+    results = {'a.frag': {'total': 1000, 'link': 10},
+               'b.frag': {'total': 5000}}
+    assert compare(baseline, results, 5.0) == []
+
+
+def test_compare_sum_regression() -> None:
+    # No single shader regresses past the threshold, but the corpus does.
+    baseline = {f'{i}.frag': {'total': 100} for i in range(10)}
+    results = {f'{i}.frag': {'total': 104} for i in range(10)}
+    assert compare(baseline, results, 5.0) == []
+    assert len(compare(baseline, results, 3.0)) == 11
@@ -36,6 +36,7 @@
 #include "sid.h"
 #include "util/hash_table.h"
 #include "util/macros.h"
+#include "util/ralloc.h"
 #include "util/simple_mtx.h"
 #include "util/u_atomic.h"
 #include "util/format/u_format.h"
@@ -94,8 +95,16 @@
 struct ac_addrlib {
    ADDR_HANDLE handle;
    simple_mtx_t lock;
+
+   /* ADDR2_GET_PREFERRED_SURF_SETTING_INPUT -> swizzle mode + 1,
+    * protected by lock.
+    */
+   struct hash_table *swizzle_mode_cache;
 };
 
+/* Drop all remembered swizzle modes once there are this many of them. */
+#define AC_SWIZZLE_MODE_CACHE_MAX_ENTRIES 4096
+
 bool ac_modifier_has_dcc(uint64_t modifier)
 {
    return IS_AMD_FMT_MOD(modifier) && AMD_FMT_MOD_GET(DCC, modifier);
@@ -578,6 +587,7 @@ struct ac_addrlib *ac_addrlib_create(const struct radeon_info *info,
 
 void ac_addrlib_destroy(struct ac_addrlib *addrlib)
 {
+   _mesa_hash_table_destroy(addrlib->swizzle_mode_cache, NULL);
    simple_mtx_destroy(&addrlib->lock);
    AddrDestroy(addrlib->handle);
    free(addrlib);
@@ -1422,18 +1432,84 @@ static int gfx6_compute_surface(ADDR_HANDLE addrlib, const struct radeon_info *i
    return 0;
 }
 
+static uint32_t swizzle_mode_cache_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(ADDR2_GET_PREFERRED_SURF_SETTING_INPUT));
+}
+
+static bool swizzle_mode_cache_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(ADDR2_GET_PREFERRED_SURF_SETTING_INPUT)) == 0;
+}
+
+/* Addr2GetPreferredSurfaceSetting goes through every allowed swizzle mode to
+ * find the best one, which adds up for apps creating lots of textures. The
+ * result only depends on its input, so remember it.
+ */
+static ADDR_E_RETURNCODE
+get_preferred_surface_setting(struct ac_addrlib *addrlib,
+                              const ADDR2_GET_PREFERRED_SURF_SETTING_INPUT *sin,
+                              AddrSwizzleMode *swizzle_mode)
+{
+   ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT sout = {0};
+   ADDR_E_RETURNCODE ret;
+
+   simple_mtx_lock(&addrlib->lock);
+   if (addrlib->swizzle_mode_cache) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search(addrlib->swizzle_mode_cache, sin);
+      if (entry) {
+         *swizzle_mode = (AddrSwizzleMode)((uintptr_t)entry->data - 1);
+         simple_mtx_unlock(&addrlib->lock);
+         return ADDR_OK;
+      }
+   }
+   simple_mtx_unlock(&addrlib->lock);
+
+   sout.size = sizeof(ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT);
+
+   ret = Addr2GetPreferredSurfaceSetting(addrlib->handle, sin, &sout);
+   if (ret != ADDR_OK)
+      return ret;
+
+   *swizzle_mode = sout.swizzleMode;
+
+   simple_mtx_lock(&addrlib->lock);
+   if (addrlib->swizzle_mode_cache &&
+       addrlib->swizzle_mode_cache->entries >= AC_SWIZZLE_MODE_CACHE_MAX_ENTRIES) {
+      _mesa_hash_table_destroy(addrlib->swizzle_mode_cache, NULL);
+      addrlib->swizzle_mode_cache = NULL;
+   }
+   if (!addrlib->swizzle_mode_cache) {
+      addrlib->swizzle_mode_cache =
+         _mesa_hash_table_create(NULL, swizzle_mode_cache_hash, swizzle_mode_cache_equal);
+   }
+   if (addrlib->swizzle_mode_cache) {
+      void *key = ralloc_size(addrlib->swizzle_mode_cache, sizeof(*sin));
+      if (key) {
+         memcpy(key, sin, sizeof(*sin));
+         _mesa_hash_table_insert(addrlib->swizzle_mode_cache, key,
+                                 (void *)(uintptr_t)(sout.swizzleMode + 1));
+      }
+   }
+   simple_mtx_unlock(&addrlib->lock);
+
+   return ADDR_OK;
+}
+
 /* This is only called when expecting a tiled layout. */
-static int gfx9_get_preferred_swizzle_mode(ADDR_HANDLE addrlib, const struct radeon_info *info,
+static int gfx9_get_preferred_swizzle_mode(struct ac_addrlib *addrlib, const struct radeon_info *info,
                                            struct radeon_surf *surf,
                                            ADDR2_COMPUTE_SURFACE_INFO_INPUT *in, bool is_fmask,
                                            AddrSwizzleMode *swizzle_mode)
 {
    ADDR_E_RETURNCODE ret;
-   ADDR2_GET_PREFERRED_SURF_SETTING_INPUT sin = {0};
-   ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT sout = {0};
+   ADDR2_GET_PREFERRED_SURF_SETTING_INPUT sin;
+
+   /* The whole struct, padding included, is the cache key. */
+   memset(&sin, 0, sizeof(sin));
 
    sin.size = sizeof(ADDR2_GET_PREFERRED_SURF_SETTING_INPUT);
-   sout.size = sizeof(ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT);
 
    sin.flags = in->flags;
    sin.resourceType = in->resourceType;
@@ -1509,11 +1585,10 @@ static int gfx9_get_preferred_swizzle_mode(ADDR_HANDLE addrlib, const struct rad
       sin.preferredSwSet.sw_S = 1;
    }
 
-   ret = Addr2GetPreferredSurfaceSetting(addrlib, &sin, &sout);
+   ret = get_preferred_surface_setting(addrlib, &sin, swizzle_mode);
    if (ret != ADDR_OK)
       return ret;
 
-   *swizzle_mode = sout.swizzleMode;
    return 0;
 }
 
@@ -2034,7 +2109,7 @@ static int gfx9_compute_miptree(struct ac_addrlib *addrlib, const struct radeon_
          fin.size = sizeof(ADDR2_COMPUTE_FMASK_INFO_INPUT);
          fout.size = sizeof(ADDR2_COMPUTE_FMASK_INFO_OUTPUT);
 
-         ret = gfx9_get_preferred_swizzle_mode(addrlib->handle, info, surf, in, true, &fin.swizzleMode);
+         ret = gfx9_get_preferred_swizzle_mode(addrlib, info, surf, in, true, &fin.swizzleMode);
          if (ret != ADDR_OK)
             return ret;
 
@@ -2307,7 +2382,7 @@ static int gfx9_compute_surface(struct ac_addrlib *addrlib, const struct radeon_
             break;
          }
 
-         r = gfx9_get_preferred_swizzle_mode(addrlib->handle, info, surf, &AddrSurfInfoIn, false,
+         r = gfx9_get_preferred_swizzle_mode(addrlib, info, surf, &AddrSurfInfoIn, false,
                                              &AddrSurfInfoIn.swizzleMode);
          if (r)
             return r;
@@ -2356,7 +2431,7 @@ static int gfx9_compute_surface(struct ac_addrlib *addrlib, const struct radeon_
       AddrSurfInfoIn.format = ADDR_FMT_8;
 
       if (!AddrSurfInfoIn.flags.depth) {
-         r = gfx9_get_preferred_swizzle_mode(addrlib->handle, info, surf, &AddrSurfInfoIn, false,
+         r = gfx9_get_preferred_swizzle_mode(addrlib, info, surf, &AddrSurfInfoIn, false,
                                              &AddrSurfInfoIn.swizzleMode);
          if (r)
             return r;
@@ -26,7 +26,8 @@
 
 #include "common/sid.h"
 
-#include <map>
+#include <algorithm>
+#include <bitset>
 #include <stack>
 #include <vector>
 
@@ -42,6 +43,8 @@ namespace {
  * The in-context is the joined out-contexts of the predecessors.
  * The context contains a map: gpr -> wait_entry
  * consisting of the information about the cnt values to be waited for.
+ * The map is a vector sorted by register, with a bitset of the registers
+ * present, so that copying and joining contexts stays cheap.
  * Note: After merge-nodes, it might occur that for the same register
  *       multiple cnt values are to be waited for.
  *
@@ -168,6 +171,96 @@ struct wait_entry {
    }
 };
 
+class gpr_wait_map {
+public:
+   using value_type = std::pair<PhysReg, wait_entry>;
+   using iterator = std::vector<value_type>::iterator;
+   using const_iterator = std::vector<value_type>::const_iterator;
+
+   iterator begin() { return entries.begin(); }
+   iterator end() { return entries.end(); }
+   const_iterator begin() const { return entries.begin(); }
+   const_iterator end() const { return entries.end(); }
+
+   wait_entry* find(PhysReg reg)
+   {
+      if (!regs[reg.reg()])
+         return NULL;
+
+      iterator it = lower_bound(reg, entries.end());
+      assert(it != entries.end() && it->first == reg);
+      return &it->second;
+   }
+
+   /* Returns the entry of the register and whether it was newly inserted. */
+   std::pair<wait_entry*, bool> emplace(PhysReg reg, const wait_entry& entry)
+   {
+      assert(reg.reg() < max_regs);
+      iterator it = lower_bound(reg, entries.end());
+      if (regs[reg.reg()])
+         return std::make_pair(&it->second, false);
+
+      regs.set(reg.reg());
+      it = entries.emplace(it, reg, entry);
+      return std::make_pair(&it->second, true);
+   }
+
+   /* Removes all entries without counters left. */
+   void remove_empty()
+   {
+      auto is_empty = [&](const value_type& e)
+      {
+         if (e.second.counters)
+            return false;
+         regs.reset(e.first.reg());
+         return true;
+      };
+      entries.erase(std::remove_if(entries.begin(), entries.end(), is_empty), entries.end());
+   }
+
+   bool join(const gpr_wait_map& other, bool logical)
+   {
+      bool changed = false;
+      size_t num_entries = entries.size();
+
+      for (const value_type& entry : other.entries) {
+         if (entry.second.logical != logical)
+            continue;
+
+         if (regs[entry.first.reg()]) {
+            /* only the first num_entries entries are sorted at this point */
+            iterator it = lower_bound(entry.first, entries.begin() + num_entries);
+            changed |= it->second.join(entry.second);
+         } else {
+            /* other's entries are sorted, so the new ones are as well */
+            regs.set(entry.first.reg());
+            entries.push_back(entry);
+            changed = true;
+         }
+      }
+
+      if (entries.size() != num_entries) {
+         std::inplace_merge(entries.begin(), entries.begin() + num_entries, entries.end(),
+                            [](const value_type& a, const value_type& b)
+                            { return a.first < b.first; });
+      }
+
+      return changed;
+   }
+
+private:
+   static constexpr unsigned max_regs = 512;
+
+   std::bitset<max_regs> regs;
+   std::vector<value_type> entries;
+
+   iterator lower_bound(PhysReg reg, iterator last)
+   {
+      return std::lower_bound(entries.begin(), last, reg,
+                              [](const value_type& e, PhysReg r) { return e.first < r; });
+   }
+};
+
 struct wait_ctx {
    Program* program;
    enum amd_gfx_level gfx_level;
@@ -188,7 +281,7 @@ struct wait_ctx {
    wait_imm barrier_imm[storage_count];
    uint16_t barrier_events[storage_count] = {}; /* use wait_event notion */
 
-   std::map<PhysReg, wait_entry> gpr_map;
+   gpr_wait_map gpr_map;
 
    wait_ctx() {}
    wait_ctx(Program* program_)
@@ -214,18 +307,7 @@ struct wait_ctx {
       pending_flat_vm |= other->pending_flat_vm;
       pending_s_buffer_store |= other->pending_s_buffer_store;
 
-      for (const auto& entry : other->gpr_map) {
-         if (entry.second.logical != logical)
-            continue;
-
-         using iterator = std::map<PhysReg, wait_entry>::iterator;
-         const std::pair<iterator, bool> insert_pair = gpr_map.insert(entry);
-         if (insert_pair.second) {
-            changed = true;
-         } else {
-            changed |= insert_pair.first->second.join(entry.second);
-         }
-      }
+      changed |= gpr_map.join(other->gpr_map, logical);
 
       for (unsigned i = 0; i < storage_count; i++) {
          changed |= barrier_imm[i].combine(other->barrier_imm[i]);
@@ -252,11 +334,11 @@ check_instr(wait_ctx& ctx, wait_imm& wait, Instruction* instr)
       /* check consecutively read gprs */
       for (unsigned j = 0; j < op.size(); j++) {
          PhysReg reg{op.physReg() + j};
-         std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.find(reg);
-         if (it == ctx.gpr_map.end() || !it->second.wait_on_read)
+         wait_entry* entry = ctx.gpr_map.find(reg);
+         if (!entry || !entry->wait_on_read)
             continue;
 
-         wait.combine(it->second.imm);
+         wait.combine(entry->imm);
       }
    }
 
@@ -265,24 +347,23 @@ check_instr(wait_ctx& ctx, wait_imm& wait, Instruction* instr)
       for (unsigned j = 0; j < def.getTemp().size(); j++) {
          PhysReg reg{def.physReg() + j};
 
-         std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.find(reg);
-         if (it == ctx.gpr_map.end())
+         wait_entry* entry = ctx.gpr_map.find(reg);
+         if (!entry)
             continue;
 
          /* Vector Memory reads and writes return in the order they were issued */
          bool has_sampler = instr->isMIMG() && !instr->operands[1].isUndefined() &&
                             instr->operands[1].regClass() == s4;
-         if (instr->isVMEM() && ((it->second.events & vm_events) == event_vmem) &&
-             it->second.has_vmem_nosampler == !has_sampler &&
-             it->second.has_vmem_sampler == has_sampler)
+         if (instr->isVMEM() && ((entry->events & vm_events) == event_vmem) &&
+             entry->has_vmem_nosampler == !has_sampler && entry->has_vmem_sampler == has_sampler)
             continue;
 
          /* LDS reads and writes return in the order they were issued. same for GDS */
          if (instr->isDS() &&
-             (it->second.events & lgkm_events) == (instr->ds().gds ? event_gds : event_lds))
+             (entry->events & lgkm_events) == (instr->ds().gds ? event_gds : event_lds))
             continue;
 
-         wait.combine(it->second.imm);
+         wait.combine(entry->imm);
       }
    }
 }
@@ -436,21 +517,17 @@ kill(wait_imm& imm, Instruction* instr, wait_ctx& ctx, memory_sync_info sync_inf
       }
 
       /* remove all gprs with higher counter from map */
-      std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.begin();
-      while (it != ctx.gpr_map.end()) {
-         if (imm.exp != wait_imm::unset_counter && imm.exp <= it->second.imm.exp)
-            ctx.wait_and_remove_from_entry(it->first, it->second, counter_exp);
-         if (imm.vm != wait_imm::unset_counter && imm.vm <= it->second.imm.vm)
-            ctx.wait_and_remove_from_entry(it->first, it->second, counter_vm);
-         if (imm.lgkm != wait_imm::unset_counter && imm.lgkm <= it->second.imm.lgkm)
-            ctx.wait_and_remove_from_entry(it->first, it->second, counter_lgkm);
-         if (imm.vs != wait_imm::unset_counter && imm.vs <= it->second.imm.vs)
-            ctx.wait_and_remove_from_entry(it->first, it->second, counter_vs);
-         if (!it->second.counters)
-            it = ctx.gpr_map.erase(it);
-         else
-            it++;
+      for (std::pair<PhysReg, wait_entry>& e : ctx.gpr_map) {
+         if (imm.exp != wait_imm::unset_counter && imm.exp <= e.second.imm.exp)
+            ctx.wait_and_remove_from_entry(e.first, e.second, counter_exp);
+         if (imm.vm != wait_imm::unset_counter && imm.vm <= e.second.imm.vm)
+            ctx.wait_and_remove_from_entry(e.first, e.second, counter_vm);
+         if (imm.lgkm != wait_imm::unset_counter && imm.lgkm <= e.second.imm.lgkm)
+            ctx.wait_and_remove_from_entry(e.first, e.second, counter_lgkm);
+         if (imm.vs != wait_imm::unset_counter && imm.vs <= e.second.imm.vs)
+            ctx.wait_and_remove_from_entry(e.first, e.second, counter_vs);
       }
+      ctx.gpr_map.remove_empty();
    }
 
    if (imm.vm == 0)
@@ -521,7 +598,7 @@ update_counters(wait_ctx& ctx, wait_event event, memory_sync_info sync = memory_
    if (ctx.pending_flat_vm)
       counters &= ~counter_vm;
 
-   for (std::pair<const PhysReg, wait_entry>& e : ctx.gpr_map) {
+   for (std::pair<PhysReg, wait_entry>& e : ctx.gpr_map) {
       wait_entry& entry = e.second;
 
       if (entry.events & ctx.unordered_events)
@@ -556,7 +633,7 @@ update_counters_for_flat_load(wait_ctx& ctx, memory_sync_info sync = memory_sync
 
    update_barrier_imm(ctx, counter_vm | counter_lgkm, event_flat, sync);
 
-   for (std::pair<PhysReg, wait_entry> e : ctx.gpr_map) {
+   for (std::pair<PhysReg, wait_entry>& e : ctx.gpr_map) {
       if (e.second.counters & counter_vm)
          e.second.imm.vm = 0;
       if (e.second.counters & counter_lgkm)
@@ -588,7 +665,7 @@ insert_wait_entry(wait_ctx& ctx, PhysReg reg, RegClass rc, wait_event event, boo
    for (unsigned i = 0; i < rc.size(); i++) {
       auto it = ctx.gpr_map.emplace(PhysReg{reg.reg() + i}, new_entry);
       if (!it.second)
-         it.first->second.join(new_entry);
+         it.first->join(new_entry);
    }
 }
 
@@ -767,6 +844,12 @@ insert_wait_states(Program* program)
    std::vector<wait_ctx> in_ctx(program->blocks.size(), wait_ctx(program));
    std::vector<wait_ctx> out_ctx(program->blocks.size(), wait_ctx(program));
 
+   /* When out_ctx of a block was last written and when in_ctx was last joined,
+    * so that revisiting a loop only joins blocks whose predecessors changed. */
+   std::vector<unsigned> out_version(program->blocks.size());
+   std::vector<unsigned> join_version(program->blocks.size());
+   unsigned version = 0;
+
    std::stack<unsigned, std::vector<unsigned>> loop_header_indices;
    unsigned loop_progress = 0;
 
@@ -779,7 +862,6 @@ insert_wait_states(Program* program)
 
    for (unsigned i = 0; i < program->blocks.size();) {
       Block& current = program->blocks[i++];
-      wait_ctx ctx = in_ctx[current.index];
 
       if (current.kind & block_kind_loop_header) {
          loop_header_indices.push(current.index);
@@ -795,6 +877,15 @@ insert_wait_states(Program* program)
             continue;
       }
 
+      if (done[current.index]) {
+         auto is_stale = [&](unsigned b) { return out_version[b] > join_version[current.index]; };
+         if (std::none_of(current.linear_preds.begin(), current.linear_preds.end(), is_stale) &&
+             std::none_of(current.logical_preds.begin(), current.logical_preds.end(), is_stale))
+            continue;
+      }
+      join_version[current.index] = ++version;
+
+      wait_ctx ctx = in_ctx[current.index];
       bool changed = false;
       for (unsigned b : current.linear_preds)
          changed |= ctx.join(&out_ctx[b], false);
@@ -810,6 +901,7 @@ insert_wait_states(Program* program)
 
       if (current.instructions.empty()) {
          out_ctx[current.index] = std::move(ctx);
+         out_version[current.index] = ++version;
          continue;
       }
 
@@ -819,6 +911,7 @@ insert_wait_states(Program* program)
       handle_block(program, current, ctx);
 
       out_ctx[current.index] = std::move(ctx);
+      out_version[current.index] = ++version;
    }
 }
 
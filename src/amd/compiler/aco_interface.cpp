@@ -47,8 +47,12 @@ static const std::array<aco_compiler_statistic_info, aco::num_statistics> statis
    ret[aco::statistic_branches] = aco_compiler_statistic_info{"Branches", "Branch instructions"};
    ret[aco::statistic_latency] =
       aco_compiler_statistic_info{"Latency", "Issue cycles plus stall cycles"};
+   ret[aco::statistic_stall_cycles] = aco_compiler_statistic_info{
+      "Stall Cycles", "Estimated cycles spent waiting for dependencies or busy units"};
    ret[aco::statistic_inv_throughput] = aco_compiler_statistic_info{
       "Inverse Throughput", "Estimated busy cycles to execute one wave"};
+   ret[aco::statistic_nop_cycles] =
+      aco_compiler_statistic_info{"NOP Cycles", "Wait states inserted with s_nop"};
    ret[aco::statistic_vmem_clauses] = aco_compiler_statistic_info{
       "VMEM Clause", "Number of VMEM clauses (includes 1-sized clauses)"};
    ret[aco::statistic_smem_clauses] = aco_compiler_statistic_info{
@@ -208,6 +212,9 @@ aco_compile_shader(const struct aco_compiler_options* options,
    /* Lower to HW Instructions */
    aco::lower_to_hw_instr(program.get());
 
+   if (!options->key.optimisations_disabled && !(aco::debug_flags & aco::DEBUG_NO_SCHED))
+      aco::schedule_postRA(program.get());
+
    /* Insert Waitcnt */
    aco::insert_wait_states(program.get());
    aco::insert_NOPs(program.get());
@@ -34,6 +34,8 @@ namespace aco {
 
 uint64_t debug_flags = 0;
 
+thread_local aco::monotonic_buffer_resource* instruction_buffer = nullptr;
+
 static const struct debug_control aco_debug_options[] = {{"validateir", DEBUG_VALIDATE_IR},
                                                          {"validatera", DEBUG_VALIDATE_RA},
                                                          {"perfwarn", DEBUG_PERFWARN},
@@ -43,6 +45,7 @@ static const struct debug_control aco_debug_options[] = {{"validateir", DEBUG_VA
                                                          {"nosched", DEBUG_NO_SCHED},
                                                          {"perfinfo", DEBUG_PERF_INFO},
                                                          {"liveinfo", DEBUG_LIVE_INFO},
+                                                         {"trysched", DEBUG_TRY_SCHED},
                                                          {NULL, 0}};
 
 static once_flag init_once_flag = ONCE_FLAG_INIT;
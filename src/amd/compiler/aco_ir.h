@@ -34,6 +34,7 @@
 #include "nir.h"
 
 #include <bitset>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -53,6 +54,7 @@ enum {
    DEBUG_NO_SCHED = 0x40,
    DEBUG_PERF_INFO = 0x80,
    DEBUG_LIVE_INFO = 0x100,
+   DEBUG_TRY_SCHED = 0x200,
 };
 
 /**
@@ -1695,8 +1697,16 @@ struct Pseudo_reduction_instruction : public Instruction {
 static_assert(sizeof(Pseudo_reduction_instruction) == sizeof(Instruction) + 4,
               "Unexpected padding");
 
+/* Instructions are allocated from the Program's memory resource and freed all
+ * at once when the Program is destroyed.
+ */
+extern thread_local aco::monotonic_buffer_resource* instruction_buffer;
+
 struct instr_deleter_functor {
-   void operator()(void* p) { free(p); }
+   /* Don't yet free any instructions. They will be de-allocated
+    * all at once after compilation finished.
+    */
+   void operator()(void* p) { return; }
 };
 
 template <typename T> using aco_ptr = std::unique_ptr<T, instr_deleter_functor>;
@@ -1708,13 +1718,15 @@ create_instruction(aco_opcode opcode, Format format, uint32_t num_operands,
 {
    std::size_t size =
       sizeof(T) + num_operands * sizeof(Operand) + num_definitions * sizeof(Definition);
-   char* data = (char*)calloc(1, size);
+   assert(instruction_buffer && "instructions need a Program");
+   void* data = instruction_buffer->allocate(size, alignof(T));
+   memset(data, 0, size);
    T* inst = (T*)data;
 
    inst->opcode = opcode;
    inst->format = format;
 
-   uint16_t operands_offset = data + sizeof(T) - (char*)&inst->operands;
+   uint16_t operands_offset = (char*)data + sizeof(T) - (char*)&inst->operands;
    inst->operands = aco::span<Operand>(operands_offset, num_operands);
    uint16_t definitions_offset = (char*)inst->operands.end() - (char*)&inst->definitions;
    inst->definitions = aco::span<Definition>(definitions_offset, num_definitions);
@@ -2012,7 +2024,9 @@ enum statistic {
    statistic_copies,
    statistic_branches,
    statistic_latency,
+   statistic_stall_cycles,
    statistic_inv_throughput,
+   statistic_nop_cycles,
    statistic_vmem_clauses,
    statistic_smem_clauses,
    statistic_sgpr_presched,
@@ -2048,6 +2062,18 @@ enum class CompilationProgress {
 
 class Program final {
 public:
+   Program() : m(65536) { instruction_buffer = &m; }
+   ~Program()
+   {
+      if (instruction_buffer == &m)
+         instruction_buffer = nullptr;
+   }
+
+   Program(const Program&) = delete;
+   Program& operator=(const Program&) = delete;
+
+   /* Backing memory of all instructions, declared first so it outlives them */
+   aco::monotonic_buffer_resource m;
    std::vector<Block> blocks;
    std::vector<RegClass> temp_rc = {s1};
    RegisterDemand max_reg_demand = RegisterDemand();
@@ -2191,6 +2217,7 @@ void register_allocation(Program* program, std::vector<IDSet>& live_out_per_bloc
 void ssa_elimination(Program* program);
 void lower_to_hw_instr(Program* program);
 void schedule_program(Program* program, live& live_vars);
+void schedule_postRA(Program* program);
 void spill(Program* program, live& live_vars);
 void insert_wait_states(Program* program);
 void insert_NOPs(Program* program);
@@ -2214,6 +2241,24 @@ void perfwarn(Program* program, bool cond, const char* msg, Instruction* instr =
 
 void collect_presched_stats(Program* program);
 void collect_preasm_stats(Program* program);
+
+struct block_cycle_estimate {
+   int32_t cycles;       /* cycles of one execution of the block */
+   int32_t stall_cycles; /* part of cycles spent waiting for dependencies or busy units */
+   double frequency;     /* estimated executions per wave */
+};
+
+struct cycle_estimate {
+   std::vector<block_cycle_estimate> blocks;
+   double latency;         /* cycles of one wave, weighted by block frequency */
+   double stall_cycles;    /* part of latency spent stalling */
+   double parallelism;     /* waves per SIMD which can hide each other's stalls */
+   double max_utilization; /* fraction of lanes active in a workgroup's waves */
+   double inv_throughput;  /* cycles per wave64 when interleaving waves */
+};
+
+cycle_estimate estimate_program_cycles(Program* program);
+double estimate_inv_throughput(Program* program);
 void collect_postasm_stats(Program* program, const std::vector<uint32_t>& code);
 
 enum print_flags {
@@ -310,10 +310,28 @@ struct vn_ctx {
 
 /* dominates() returns true if the parent block dominates the child block and
  * if the parent block is part of the same loop or has a smaller loop nest depth.
+ *
+ * Uniform expressions are also allowed to be reused after leaving the loop of
+ * the parent block: a block which dominates the loop exit is executed in the
+ * last iteration, so the scalar result of that iteration is still valid.
  */
 bool
-dominates(vn_ctx& ctx, uint32_t parent, uint32_t child)
+dominates(vn_ctx& ctx, uint32_t parent, uint32_t child, bool uniform)
 {
+   if (uniform) {
+      /* The temporary is used outside of the loop, which requires linear dominance. */
+      uint32_t linear_child = child;
+      while (parent < linear_child)
+         linear_child = ctx.program->blocks[linear_child].linear_idom;
+      if (parent != linear_child)
+         return false;
+
+      while (parent < child)
+         child = ctx.program->blocks[child].logical_idom;
+
+      return parent == child;
+   }
+
    unsigned parent_loop_nest_depth = ctx.program->blocks[parent].loop_nest_depth;
    while (parent < child && parent_loop_nest_depth <= ctx.program->blocks[child].loop_nest_depth)
       child = ctx.program->blocks[child].logical_idom;
@@ -321,6 +339,23 @@ dominates(vn_ctx& ctx, uint32_t parent, uint32_t child)
    return parent == child;
 }
 
+/* Returns whether the result of the instruction is independent of the
+ * execution mask, like scalar ALU and reorderable SMEM loads.
+ */
+bool
+is_uniform_expr(Instruction* instr)
+{
+   if (!instr->isSALU() && !instr->isSMEM())
+      return false;
+
+   for (const Operand& op : instr->operands) {
+      if (op.isFixed() && (op.physReg() == exec_lo || op.physReg() == exec_hi))
+         return false;
+   }
+
+   return true;
+}
+
 /** Returns whether this instruction can safely be removed
  *  and replaced by an equal expression.
  *  This is in particular true for ALU instructions and
@@ -404,7 +439,7 @@ process_block(vn_ctx& ctx, Block& block)
          Instruction* orig_instr = res.first->first;
          assert(instr->definitions.size() == orig_instr->definitions.size());
          /* check if the original instruction dominates the current one */
-         if (dominates(ctx, res.first->second, block.index) &&
+         if (dominates(ctx, res.first->second, block.index, is_uniform_expr(instr.get())) &&
              ctx.program->blocks[res.first->second].fp_mode.canReplace(block.fp_mode)) {
             for (unsigned i = 0; i < instr->definitions.size(); i++) {
                assert(instr->definitions[i].regClass() == orig_instr->definitions[i].regClass());
@@ -31,6 +31,7 @@
 #include <unordered_set>
 #include <vector>
 
+/* Base values for the target wave count, which are adjusted per block */
 #define SMEM_WINDOW_SIZE    (350 - ctx.num_waves * 35)
 #define VMEM_WINDOW_SIZE    (1024 - ctx.num_waves * 64)
 #define POS_EXP_WINDOW_SIZE 512
@@ -128,6 +129,12 @@ struct sched_ctx {
    MoveState mv;
    bool schedule_pos_exports = true;
    unsigned schedule_pos_export_div = 1;
+
+   /* Window sizes and move limits for the current block */
+   int smem_window;
+   int vmem_window;
+   int smem_max_moves;
+   int vmem_max_moves;
 };
 
 /* This scheduler is a simple bottom-up pass based on ideas from
@@ -644,8 +651,8 @@ schedule_SMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
               Instruction* current, int idx)
 {
    assert(idx != 0);
-   int window_size = SMEM_WINDOW_SIZE;
-   int max_moves = SMEM_MAX_MOVES;
+   int window_size = ctx.smem_window;
+   int max_moves = ctx.smem_max_moves;
    int16_t k = 0;
 
    /* don't move s_memtime/s_memrealtime */
@@ -786,8 +793,8 @@ schedule_VMEM(sched_ctx& ctx, Block* block, std::vector<RegisterDemand>& registe
               Instruction* current, int idx)
 {
    assert(idx != 0);
-   int window_size = VMEM_WINDOW_SIZE;
-   int max_moves = VMEM_MAX_MOVES;
+   int window_size = ctx.vmem_window;
+   int max_moves = ctx.vmem_max_moves;
    int clause_max_grab_dist = VMEM_CLAUSE_MAX_GRAB_DIST;
    bool only_clauses = false;
    int16_t k = 0;
@@ -1000,9 +1007,61 @@ schedule_position_export(sched_ctx& ctx, Block* block, std::vector<RegisterDeman
    }
 }
 
+int
+scale_window(int base, int block_size, int num_mem)
+{
+   if (!num_mem)
+      return base;
+
+   /* Memory instructions that are far apart, like in long unrolled loops,
+    * need a larger window to find enough independent instructions to cover
+    * their latency. When they are close together, the windows of
+    * neighbouring instructions overlap and a smaller one finds about the same
+    * candidates for less compile time.
+    */
+   int spacing = block_size / num_mem;
+   return CLAMP(spacing * 4, base / 2, base * 2);
+}
+
+int
+scale_max_moves(int base, int demand, int max_registers)
+{
+   /* Most moves fail the register pressure check when there is little
+    * headroom, so don't try as many. */
+   int headroom = max_registers - demand;
+   if (headroom * 2 >= max_registers)
+      return base * 2;
+   else if (headroom * 8 < max_registers)
+      return std::max(base / 2, 1);
+   return base;
+}
+
+void
+init_block_windows(sched_ctx& ctx, Block* block)
+{
+   int num_smem = 0;
+   int num_vmem = 0;
+   for (aco_ptr<Instruction>& instr : block->instructions) {
+      if (instr->isSMEM())
+         num_smem++;
+      else if (instr->isVMEM() || instr->isFlatLike())
+         num_vmem++;
+   }
+
+   int size = block->instructions.size();
+   ctx.smem_window = scale_window(SMEM_WINDOW_SIZE, size, num_smem);
+   ctx.vmem_window = scale_window(VMEM_WINDOW_SIZE, size, num_vmem);
+   ctx.smem_max_moves = scale_max_moves(SMEM_MAX_MOVES, block->register_demand.sgpr,
+                                        ctx.mv.max_registers.sgpr);
+   ctx.vmem_max_moves = scale_max_moves(VMEM_MAX_MOVES, block->register_demand.vgpr,
+                                        ctx.mv.max_registers.vgpr);
+}
+
 void
 schedule_block(sched_ctx& ctx, Program* program, Block* block, live& live_vars)
 {
+   init_block_windows(ctx, block);
+
    ctx.last_SMEM_dep_idx = 0;
    ctx.last_SMEM_stall = INT16_MIN;
    ctx.mv.block = block;
@@ -1042,6 +1101,74 @@ schedule_block(sched_ctx& ctx, Program* program, Block* block, live& live_vars)
    }
 }
 
+void
+set_target_waves(sched_ctx& ctx, Program* program, uint16_t num_waves)
+{
+   unsigned wave_fac = program->dev.physical_vgprs / 256;
+   ctx.num_waves = std::max<uint16_t>(num_waves, program->min_waves);
+   ctx.num_waves = std::min<uint16_t>(ctx.num_waves, program->num_waves);
+   ctx.num_waves = max_suitable_waves(program, ctx.num_waves);
+
+   /* VMEM_MAX_MOVES and such assume pre-GFX10 wave count */
+   ctx.num_waves = std::max<uint16_t>(ctx.num_waves / wave_fac, 1);
+
+   assert(ctx.num_waves > 0);
+   ctx.mv.max_registers = {int16_t(get_addr_vgpr_from_waves(program, ctx.num_waves * wave_fac) - 2),
+                           int16_t(get_addr_sgpr_from_waves(program, ctx.num_waves * wave_fac))};
+}
+
+RegisterDemand
+schedule_blocks(sched_ctx& ctx, Program* program, live& live_vars)
+{
+   for (Block& block : program->blocks)
+      schedule_block(ctx, program, &block, live_vars);
+
+   RegisterDemand new_demand;
+   for (Block& block : program->blocks) {
+      new_demand.update(block.register_demand);
+   }
+   return new_demand;
+}
+
+/* The instruction order and register demand of all blocks, so that different
+ * schedules of the same program can be compared. */
+struct schedule_state {
+   std::vector<std::vector<Instruction*>> instructions;
+   std::vector<std::vector<RegisterDemand>> register_demand;
+   std::vector<RegisterDemand> block_demand;
+};
+
+void
+save_schedule(Program* program, live& live_vars, schedule_state& state)
+{
+   state.instructions.resize(program->blocks.size());
+   state.block_demand.resize(program->blocks.size());
+   for (Block& block : program->blocks) {
+      std::vector<Instruction*>& instrs = state.instructions[block.index];
+      instrs.clear();
+      for (aco_ptr<Instruction>& instr : block.instructions)
+         instrs.push_back(instr.get());
+      state.block_demand[block.index] = block.register_demand;
+   }
+   state.register_demand = live_vars.register_demand;
+}
+
+void
+restore_schedule(Program* program, live& live_vars, const schedule_state& state)
+{
+   for (Block& block : program->blocks) {
+      /* Scheduling only reorders the instructions of a block. */
+      const std::vector<Instruction*>& instrs = state.instructions[block.index];
+      assert(instrs.size() == block.instructions.size());
+      for (aco_ptr<Instruction>& instr : block.instructions)
+         (void)instr.release();
+      for (unsigned i = 0; i < instrs.size(); i++)
+         block.instructions[i].reset(instrs[i]);
+      block.register_demand = state.block_demand[block.index];
+   }
+   live_vars.register_demand = state.register_demand;
+}
+
 void
 schedule_program(Program* program, live& live_vars)
 {
@@ -1060,24 +1187,16 @@ schedule_program(Program* program, live& live_vars)
     * seem to hurt anything else. */
    // TODO: account for possible uneven num_waves on GFX10+
    unsigned wave_fac = program->dev.physical_vgprs / 256;
+   uint16_t target_waves;
    if (program->num_waves <= 5 * wave_fac)
-      ctx.num_waves = program->num_waves;
+      target_waves = program->num_waves;
    else if (demand.vgpr >= 29)
-      ctx.num_waves = 5 * wave_fac;
+      target_waves = 5 * wave_fac;
    else if (demand.vgpr >= 25)
-      ctx.num_waves = 6 * wave_fac;
+      target_waves = 6 * wave_fac;
    else
-      ctx.num_waves = 7 * wave_fac;
-   ctx.num_waves = std::max<uint16_t>(ctx.num_waves, program->min_waves);
-   ctx.num_waves = std::min<uint16_t>(ctx.num_waves, program->num_waves);
-   ctx.num_waves = max_suitable_waves(program, ctx.num_waves);
-
-   /* VMEM_MAX_MOVES and such assume pre-GFX10 wave count */
-   ctx.num_waves = std::max<uint16_t>(ctx.num_waves / wave_fac, 1);
-
-   assert(ctx.num_waves > 0);
-   ctx.mv.max_registers = {int16_t(get_addr_vgpr_from_waves(program, ctx.num_waves * wave_fac) - 2),
-                           int16_t(get_addr_sgpr_from_waves(program, ctx.num_waves * wave_fac))};
+      target_waves = 7 * wave_fac;
+   set_target_waves(ctx, program, target_waves);
 
    /* NGG culling shaders are very sensitive to position export scheduling.
     * Schedule less aggressively when early primitive export is used, and
@@ -1090,15 +1209,36 @@ schedule_program(Program* program, live& live_vars)
          ctx.schedule_pos_export_div = 4;
    }
 
-   for (Block& block : program->blocks)
-      schedule_block(ctx, program, &block, live_vars);
-
-   /* update max_reg_demand and num_waves */
-   RegisterDemand new_demand;
-   for (Block& block : program->blocks) {
-      new_demand.update(block.register_demand);
+   if (!(debug_flags & DEBUG_TRY_SCHED) || ctx.num_waves * wave_fac >= program->num_waves) {
+      /* update max_reg_demand and num_waves */
+      update_vgpr_sgpr_demand(program, schedule_blocks(ctx, program, live_vars));
+   } else {
+      /* The schedule above trades occupancy for latency hiding. Also try one
+       * that keeps all waves and keep whichever is estimated to be faster.
+       */
+      uint16_t prev_num_waves = program->num_waves;
+      RegisterDemand prev_max_reg_demand = program->max_reg_demand;
+
+      schedule_state unscheduled, ilp;
+      save_schedule(program, live_vars, unscheduled);
+
+      RegisterDemand ilp_demand = schedule_blocks(ctx, program, live_vars);
+      update_vgpr_sgpr_demand(program, ilp_demand);
+      double ilp_cost = estimate_inv_throughput(program);
+      save_schedule(program, live_vars, ilp);
+
+      restore_schedule(program, live_vars, unscheduled);
+      program->num_waves = prev_num_waves;
+      program->max_reg_demand = prev_max_reg_demand;
+      set_target_waves(ctx, program, prev_num_waves);
+      update_vgpr_sgpr_demand(program, schedule_blocks(ctx, program, live_vars));
+      double occupancy_cost = estimate_inv_throughput(program);
+
+      if (ilp_cost < occupancy_cost) {
+         restore_schedule(program, live_vars, ilp);
+         update_vgpr_sgpr_demand(program, ilp_demand);
+      }
    }
-   update_vgpr_sgpr_demand(program, new_demand);
 
 /* if enabled, this code asserts that register_demand is updated correctly */
 #if 0
@@ -0,0 +1,405 @@
+/*
+ * Copyright © 2022 Valve Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+
+#include "aco_ir.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+/*
+ * Light list scheduler for hardware instructions, which runs after register
+ * allocation and the lowering of parallel copies.
+ *
+ * On GFX6-9, an instruction placed right after the VALU instruction writing
+ * one of its operands often requires wait states, which insert_NOPs() fills
+ * with s_nop. Within each region between control flow and pseudo
+ * instructions, this pass keeps the original order but moves independent work
+ * in front of instructions which would otherwise require NOPs.
+ */
+
+namespace aco {
+namespace {
+
+constexpr const size_t max_reg_cnt = 512;
+
+/* The largest number of wait states required by any of the modelled hazards. */
+constexpr const int max_hazard_wait_states = 5;
+
+struct sched_ctx {
+   Program* program;
+
+   /* dependency graph of the current region */
+   std::vector<std::vector<unsigned>> succs;
+   std::vector<unsigned> num_preds;
+
+   /* last instruction of the region writing each register and the
+    * instructions which read it since then */
+   std::array<int, max_reg_cnt> last_write;
+   std::array<std::vector<unsigned>, max_reg_cnt> reads;
+   std::vector<unsigned> touched_regs;
+   int last_mem;
+
+   /* The instructions already emitted in the block and their wait states,
+    * including the s_nop which would be inserted in front of them. */
+   std::vector<std::pair<Instruction*, int>> history;
+
+   unsigned nops_saved = 0;
+
+   sched_ctx(Program* program_) : program(program_) { last_write.fill(-1); }
+};
+
+int
+get_wait_states(Instruction* instr)
+{
+   if (instr->opcode == aco_opcode::s_nop)
+      return instr->sopp().imm + 1;
+   else if (instr->opcode == aco_opcode::p_constaddr)
+      return 3; /* lowered to 3 instructions in the assembler */
+   else
+      return 1;
+}
+
+bool
+writes_reg(Instruction* instr, PhysReg reg, unsigned size)
+{
+   for (const Definition& def : instr->definitions) {
+      if (def.physReg().reg() < reg.reg() + size && reg.reg() < def.physReg().reg() + def.size())
+         return true;
+   }
+   return false;
+}
+
+bool
+writes_operand(Instruction* instr, const Operand& op)
+{
+   return !op.isConstant() && !op.isUndefined() && writes_reg(instr, op.physReg(), op.size());
+}
+
+/* Returns the number of wait states required between pred and instr, for the
+ * register hazards handled by insert_NOPs() on GFX6-9. Anything not modelled
+ * here is still resolved by insert_NOPs().
+ */
+int
+get_hazard_wait_states(Program* program, Instruction* pred, Instruction* instr)
+{
+   if (pred->isSALU()) {
+      bool m0_then_lds = instr->isDS() && instr->ds().gds;
+      if (program->gfx_level == GFX9)
+         m0_then_lds |= instr->isVINTRP();
+      return m0_then_lds && writes_reg(pred, m0, 1) ? 1 : 0;
+   }
+
+   if (!pred->isVALU())
+      return 0;
+
+   int wait_states = 0;
+
+   if (instr->isVMEM() || instr->isFlatLike()) {
+      for (const Operand& op : instr->operands) {
+         if (op.regClass().type() == RegType::sgpr && writes_operand(pred, op))
+            wait_states = MAX2(wait_states, 5);
+      }
+   } else if (instr->isSMEM() && program->gfx_level == GFX6) {
+      for (const Operand& op : instr->operands) {
+         if (writes_operand(pred, op))
+            wait_states = MAX2(wait_states, 4);
+      }
+   } else if (instr->isVALU()) {
+      if (instr->isDPP()) {
+         if (writes_operand(pred, instr->operands[0]))
+            wait_states = MAX2(wait_states, 2);
+         if (writes_reg(pred, exec, 2))
+            wait_states = MAX2(wait_states, 5);
+      }
+
+      if ((instr->opcode == aco_opcode::v_readlane_b32 ||
+           instr->opcode == aco_opcode::v_readlane_b32_e64 ||
+           instr->opcode == aco_opcode::v_writelane_b32 ||
+           instr->opcode == aco_opcode::v_writelane_b32_e64) &&
+          writes_operand(pred, instr->operands[1]))
+         wait_states = MAX2(wait_states, 4);
+
+      if ((instr->opcode == aco_opcode::v_div_fmas_f32 ||
+           instr->opcode == aco_opcode::v_div_fmas_f64) &&
+          writes_reg(pred, vcc, 2))
+         wait_states = MAX2(wait_states, 4);
+   }
+
+   return wait_states;
+}
+
+/* Returns the number of NOPs instr would require if it was emitted next. */
+int
+get_nops_needed(sched_ctx& ctx, Instruction* instr)
+{
+   int nops = 0;
+   int distance = 0;
+   for (int i = ctx.history.size() - 1; i >= 0 && distance < max_hazard_wait_states; i--) {
+      Instruction* pred = ctx.history[i].first;
+      nops = MAX2(nops, get_hazard_wait_states(ctx.program, pred, instr) - distance);
+      distance += ctx.history[i].second;
+   }
+   return nops;
+}
+
+/* Appends instr to the history and returns the number of NOPs it requires. */
+int
+emit(sched_ctx& ctx, Instruction* instr)
+{
+   int nops = get_nops_needed(ctx, instr);
+   ctx.history.emplace_back(instr, nops + get_wait_states(instr));
+   return nops;
+}
+
+bool
+is_region_boundary(Instruction* instr)
+{
+   if (instr->isSOPP() || instr->isPseudo() || instr->isBranch() || instr->isBarrier() ||
+       instr->isReduction())
+      return true;
+
+   switch (instr->opcode) {
+   case aco_opcode::s_setreg_b32:
+   case aco_opcode::s_setreg_imm32_b32:
+   case aco_opcode::s_getreg_b32:
+   case aco_opcode::s_movrels_b32:
+   case aco_opcode::s_movrels_b64:
+   case aco_opcode::s_movreld_b32:
+   case aco_opcode::s_movreld_b64:
+   case aco_opcode::v_movrels_b32:
+   case aco_opcode::v_movreld_b32:
+   case aco_opcode::v_movrelsd_b32: return true;
+   default: break;
+   }
+
+   /* vccz and execz are implicitly written together with vcc and exec */
+   for (const Operand& op : instr->operands) {
+      if (!op.isConstant() && (op.physReg() == vccz || op.physReg() == execz))
+         return true;
+   }
+
+   return false;
+}
+
+bool
+is_memory(Instruction* instr)
+{
+   return instr->isVMEM() || instr->isFlatLike() || instr->isSMEM() || instr->isDS() ||
+          instr->isEXP();
+}
+
+void
+add_dep(sched_ctx& ctx, unsigned pred, unsigned succ)
+{
+   if (pred == succ)
+      return;
+   ctx.succs[pred].push_back(succ);
+   ctx.num_preds[succ]++;
+}
+
+void
+add_read(sched_ctx& ctx, unsigned idx, unsigned reg)
+{
+   assert(reg < max_reg_cnt);
+   if (ctx.last_write[reg] >= 0)
+      add_dep(ctx, ctx.last_write[reg], idx);
+   if (ctx.last_write[reg] < 0 && ctx.reads[reg].empty())
+      ctx.touched_regs.push_back(reg);
+   ctx.reads[reg].push_back(idx);
+}
+
+void
+add_write(sched_ctx& ctx, unsigned idx, unsigned reg)
+{
+   assert(reg < max_reg_cnt);
+   if (ctx.last_write[reg] >= 0)
+      add_dep(ctx, ctx.last_write[reg], idx);
+   else if (ctx.reads[reg].empty())
+      ctx.touched_regs.push_back(reg);
+   for (unsigned read : ctx.reads[reg])
+      add_dep(ctx, read, idx);
+   ctx.reads[reg].clear();
+   ctx.last_write[reg] = idx;
+}
+
+void
+build_dependencies(sched_ctx& ctx, std::vector<aco_ptr<Instruction>>& region)
+{
+   ctx.succs.assign(region.size(), std::vector<unsigned>());
+   ctx.num_preds.assign(region.size(), 0);
+   ctx.last_mem = -1;
+
+   for (unsigned i = 0; i < region.size(); i++) {
+      Instruction* instr = region[i].get();
+
+      for (const Operand& op : instr->operands) {
+         if (op.isConstant() || op.isUndefined())
+            continue;
+         for (unsigned j = 0; j < op.size(); j++)
+            add_read(ctx, i, op.physReg().reg() + j);
+      }
+
+      /* Everything but scalar instructions depends on the execution mask. */
+      if (!instr->isSALU() && !instr->isSMEM()) {
+         add_read(ctx, i, exec_lo.reg());
+         add_read(ctx, i, exec_hi.reg());
+      }
+
+      if (is_memory(instr)) {
+         if (ctx.last_mem >= 0)
+            add_dep(ctx, ctx.last_mem, i);
+         ctx.last_mem = i;
+      }
+
+      for (const Definition& def : instr->definitions) {
+         for (unsigned j = 0; j < def.size(); j++)
+            add_write(ctx, i, def.physReg().reg() + j);
+      }
+   }
+
+   for (unsigned reg : ctx.touched_regs) {
+      ctx.last_write[reg] = -1;
+      ctx.reads[reg].clear();
+   }
+   ctx.touched_regs.clear();
+}
+
+void
+schedule_region(sched_ctx& ctx, std::vector<aco_ptr<Instruction>>& region,
+                std::vector<aco_ptr<Instruction>>& instructions)
+{
+   if (region.empty())
+      return;
+
+   /* Number of NOPs needed when keeping the original order. */
+   size_t history_size = ctx.history.size();
+   int orig_nops = 0;
+   for (aco_ptr<Instruction>& instr : region)
+      orig_nops += emit(ctx, instr.get());
+   ctx.history.resize(history_size);
+
+   if (!orig_nops) {
+      for (aco_ptr<Instruction>& instr : region) {
+         emit(ctx, instr.get());
+         instructions.emplace_back(std::move(instr));
+      }
+      region.clear();
+      return;
+   }
+
+   build_dependencies(ctx, region);
+
+   /* ready instructions, in their original order */
+   std::vector<unsigned> ready;
+   for (unsigned i = 0; i < region.size(); i++) {
+      if (!ctx.num_preds[i])
+         ready.push_back(i);
+   }
+
+   std::vector<unsigned> order;
+   order.reserve(region.size());
+   int new_nops = 0;
+   while (!ready.empty()) {
+      /* Prefer the first ready instruction, unless a later one needs fewer NOPs. */
+      unsigned best = 0;
+      int best_nops = get_nops_needed(ctx, region[ready[0]].get());
+      for (unsigned i = 1; i < ready.size() && best_nops; i++) {
+         int nops = get_nops_needed(ctx, region[ready[i]].get());
+         if (nops < best_nops) {
+            best = i;
+            best_nops = nops;
+         }
+      }
+
+      unsigned idx = ready[best];
+      ready.erase(ready.begin() + best);
+      order.push_back(idx);
+      new_nops += emit(ctx, region[idx].get());
+
+      for (unsigned succ : ctx.succs[idx]) {
+         if (--ctx.num_preds[succ] == 0)
+            ready.insert(std::lower_bound(ready.begin(), ready.end(), succ), succ);
+      }
+   }
+   assert(order.size() == region.size());
+   ctx.history.resize(history_size);
+
+   /* The greedy choice isn't guaranteed to be better overall. */
+   if (new_nops < orig_nops) {
+      ctx.nops_saved += orig_nops - new_nops;
+   } else {
+      for (unsigned i = 0; i < region.size(); i++)
+         order[i] = i;
+   }
+
+   for (unsigned idx : order) {
+      emit(ctx, region[idx].get());
+      instructions.emplace_back(std::move(region[idx]));
+   }
+   region.clear();
+}
+
+void
+schedule_block(sched_ctx& ctx, Block& block)
+{
+   std::vector<aco_ptr<Instruction>> instructions;
+   instructions.reserve(block.instructions.size());
+   std::vector<aco_ptr<Instruction>> region;
+
+   ctx.history.clear();
+
+   for (aco_ptr<Instruction>& instr : block.instructions) {
+      if (is_region_boundary(instr.get())) {
+         schedule_region(ctx, region, instructions);
+         emit(ctx, instr.get());
+         instructions.emplace_back(std::move(instr));
+      } else {
+         region.emplace_back(std::move(instr));
+      }
+   }
+   schedule_region(ctx, region, instructions);
+
+   block.instructions = std::move(instructions);
+}
+
+} /* end namespace */
+
+void
+schedule_postRA(Program* program)
+{
+   /* GFX10+ resolves most of these hazards in hardware. */
+   if (program->gfx_level >= GFX10)
+      return;
+
+   sched_ctx ctx(program);
+   for (Block& block : program->blocks)
+      schedule_block(ctx, block);
+
+   if (debug_flags & DEBUG_PERF_INFO)
+      fprintf(stderr, "postRA_sched_nops_saved: %u\n", ctx.nops_saved);
+}
+
+} // namespace aco
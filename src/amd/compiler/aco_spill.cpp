@@ -60,6 +60,7 @@ namespace {
 
 struct remat_info {
    Instruction* instr;
+   unsigned loop_nest_depth;
 };
 
 struct spill_ctx {
@@ -79,6 +80,9 @@ struct spill_ctx {
    std::vector<std::vector<uint32_t>> affinities;
    std::vector<bool> is_reloaded;
    std::unordered_map<Temp, remat_info> remat;
+   /* Cheap definitions with temporary operands, which can only be
+    * rematerialized where all operands are in registers. */
+   std::unordered_map<Temp, remat_info> remat_with_temps;
    std::set<Instruction*> unused_remats;
    unsigned wave_size;
 
@@ -306,6 +310,91 @@ should_rematerialize(aco_ptr<Instruction>& instr)
    return true;
 }
 
+bool
+should_rematerialize_with_temps(aco_ptr<Instruction>& instr)
+{
+   switch (instr->opcode) {
+   case aco_opcode::s_mov_b32:
+   case aco_opcode::s_mov_b64:
+   case aco_opcode::s_mul_i32:
+   case aco_opcode::v_mov_b32:
+   case aco_opcode::v_add_u32:
+   case aco_opcode::v_sub_u32:
+   case aco_opcode::v_lshlrev_b32:
+   case aco_opcode::v_and_b32:
+   case aco_opcode::v_or_b32:
+   case aco_opcode::v_mul_u32_u24:
+   case aco_opcode::v_lshl_add_u32:
+   case aco_opcode::v_add_lshl_u32:
+   case aco_opcode::v_lshl_or_b32:
+   case aco_opcode::v_mad_u32_u24:
+   case aco_opcode::p_create_vector:
+   case aco_opcode::p_parallelcopy: break;
+   default: return false;
+   }
+
+   /* no DPP, SDWA or VOP3 encoding of VOP1/VOP2 */
+   if (instr->format != Format::SOP1 && instr->format != Format::SOP2 &&
+       instr->format != Format::VOP1 && instr->format != Format::VOP2 &&
+       instr->format != Format::VOP3 && instr->format != Format::PSEUDO)
+      return false;
+
+   if (instr->definitions.size() != 1 || instr->definitions[0].isFixed())
+      return false;
+
+   bool has_temp = false;
+   for (const Operand& op : instr->operands) {
+      if (op.isFixed() || op.isUndefined())
+         return false;
+      if (op.isTemp()) {
+         if (op.regClass().is_linear_vgpr())
+            return false;
+         has_temp = true;
+      }
+   }
+
+   return has_temp;
+}
+
+aco_ptr<Instruction>
+rematerialize(Instruction* instr, Temp new_name)
+{
+   aco_ptr<Instruction> res;
+   if (instr->isVOP1()) {
+      res.reset(create_instruction<VOP1_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+   } else if (instr->isVOP2()) {
+      res.reset(create_instruction<VOP2_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+   } else if (instr->isVOP3()) {
+      res.reset(create_instruction<VOP3_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+      VOP3_instruction& vop3 = res->vop3();
+      std::copy(std::begin(instr->vop3().abs), std::end(instr->vop3().abs), vop3.abs);
+      std::copy(std::begin(instr->vop3().neg), std::end(instr->vop3().neg), vop3.neg);
+      vop3.opsel = instr->vop3().opsel;
+      vop3.omod = instr->vop3().omod;
+      vop3.clamp = instr->vop3().clamp;
+   } else if (instr->isSOP1()) {
+      res.reset(create_instruction<SOP1_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+   } else if (instr->isSOP2()) {
+      res.reset(create_instruction<SOP2_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+   } else if (instr->isPseudo()) {
+      res.reset(create_instruction<Pseudo_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+   } else if (instr->isSOPK()) {
+      res.reset(create_instruction<SOPK_instruction>(
+         instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
+      res->sopk().imm = instr->sopk().imm;
+   }
+   for (unsigned i = 0; i < instr->operands.size(); i++)
+      res->operands[i] = instr->operands[i];
+   res->definitions[0] = Definition(new_name);
+   return res;
+}
+
 aco_ptr<Instruction>
 do_reload(spill_ctx& ctx, Temp tmp, Temp new_name, uint32_t spill_id)
 {
@@ -318,32 +407,11 @@ do_reload(spill_ctx& ctx, Temp tmp, Temp new_name, uint32_t spill_id)
               instr->opcode == aco_opcode::p_parallelcopy) &&
              "unsupported");
       assert(instr->definitions.size() == 1 && "unsupported");
+      assert(std::none_of(instr->operands.begin(), instr->operands.end(),
+                          [](const Operand& op) { return op.isTemp(); }) &&
+             "unsupported");
 
-      aco_ptr<Instruction> res;
-      if (instr->isVOP1()) {
-         res.reset(create_instruction<VOP1_instruction>(
-            instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
-      } else if (instr->isSOP1()) {
-         res.reset(create_instruction<SOP1_instruction>(
-            instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
-      } else if (instr->isPseudo()) {
-         res.reset(create_instruction<Pseudo_instruction>(
-            instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
-      } else if (instr->isSOPK()) {
-         res.reset(create_instruction<SOPK_instruction>(
-            instr->opcode, instr->format, instr->operands.size(), instr->definitions.size()));
-         res->sopk().imm = instr->sopk().imm;
-      }
-      for (unsigned i = 0; i < instr->operands.size(); i++) {
-         res->operands[i] = instr->operands[i];
-         if (instr->operands[i].isTemp()) {
-            assert(false && "unsupported");
-            if (ctx.remat.count(instr->operands[i].getTemp()))
-               ctx.unused_remats.erase(ctx.remat[instr->operands[i].getTemp()].instr);
-         }
-      }
-      res->definitions[0] = Definition(new_name);
-      return res;
+      return rematerialize(instr, new_name);
    } else {
       aco_ptr<Pseudo_instruction> reload{
          create_instruction<Pseudo_instruction>(aco_opcode::p_reload, Format::PSEUDO, 1, 1)};
@@ -367,10 +435,13 @@ get_rematerialize_info(spill_ctx& ctx)
          if (logical && should_rematerialize(instr)) {
             for (const Definition& def : instr->definitions) {
                if (def.isTemp()) {
-                  ctx.remat[def.getTemp()] = remat_info{instr.get()};
+                  ctx.remat[def.getTemp()] = remat_info{instr.get(), block.loop_nest_depth};
                   ctx.unused_remats.insert(instr.get());
                }
             }
+         } else if (logical && should_rematerialize_with_temps(instr)) {
+            Temp def = instr->definitions[0].getTemp();
+            ctx.remat_with_temps[def] = remat_info{instr.get(), block.loop_nest_depth};
          }
       }
    }
@@ -1150,6 +1221,64 @@ add_coupling_code(spill_ctx& ctx, Block* block, unsigned block_idx)
    block->instructions = std::move(instructions);
 }
 
+/* Recomputes a spilled variable from its operands instead of reloading it, if
+ * they are all live in registers at this point so that it doesn't increase
+ * register demand. The spill is then removed later unless another reload of
+ * the variable needs it.
+ */
+aco_ptr<Instruction>
+rematerialize_with_temps(spill_ctx& ctx, Block* block, unsigned block_idx, unsigned idx, Temp tmp,
+                         Temp new_name,
+                         const std::map<Temp, std::pair<Temp, uint32_t>>& reloads)
+{
+   auto remat_it = ctx.remat_with_temps.find(tmp);
+   if (remat_it == ctx.remat_with_temps.end())
+      return nullptr;
+
+   /* Without next-use information for this block, we don't know which
+    * operands are still live. */
+   if (!block->register_demand.exceeds(ctx.target_pressure))
+      return nullptr;
+
+   /* Lanes which left a divergent loop early may have different operand
+    * values than the ones the definition used. */
+   if (block->loop_nest_depth < remat_it->second.loop_nest_depth)
+      return nullptr;
+
+   Instruction* instr = remat_it->second.instr;
+   const std::vector<std::pair<Temp, uint32_t>>& live = ctx.local_next_use_distance[idx];
+   const std::unordered_map<Temp, uint32_t>& current_spills = ctx.spills_exit[block_idx];
+   for (const Operand& op : instr->operands) {
+      if (!op.isTemp())
+         continue;
+      Temp op_tmp = op.getTemp();
+      if (current_spills.count(op_tmp) ||
+          std::none_of(live.begin(), live.end(),
+                       [op_tmp](const auto& pair) { return pair.first == op_tmp; }) ||
+          std::any_of(reloads.begin(), reloads.end(),
+                      [op_tmp](const auto& pair) { return pair.second.first == op_tmp; }))
+         return nullptr;
+   }
+
+   aco_ptr<Instruction> res = rematerialize(instr, new_name);
+   for (Operand& op : res->operands) {
+      if (!op.isTemp())
+         continue;
+      op.setKill(false);
+
+      auto rename_it = ctx.renames[block_idx].find(op.getTemp());
+      if (rename_it != ctx.renames[block_idx].end()) {
+         op.setTemp(rename_it->second);
+      } else {
+         /* prevent its definining instruction from being DCE'd if it could be rematerialized */
+         auto it = ctx.remat.find(op.getTemp());
+         if (it != ctx.remat.end())
+            ctx.unused_remats.erase(it->second.instr);
+      }
+   }
+   return res;
+}
+
 void
 process_block(spill_ctx& ctx, unsigned block_idx, Block* block, RegisterDemand spilled_registers)
 {
@@ -1262,8 +1391,10 @@ process_block(spill_ctx& ctx, unsigned block_idx, Block* block, RegisterDemand s
 
       /* add reloads and instruction to new instructions */
       for (std::pair<const Temp, std::pair<Temp, uint32_t>>& pair : reloads) {
-         aco_ptr<Instruction> reload =
-            do_reload(ctx, pair.second.first, pair.first, pair.second.second);
+         aco_ptr<Instruction> reload = rematerialize_with_temps(
+            ctx, block, block_idx, idx, pair.second.first, pair.first, reloads);
+         if (!reload)
+            reload = do_reload(ctx, pair.second.first, pair.first, pair.second.second);
          instructions.emplace_back(std::move(reload));
       }
       instructions.emplace_back(std::move(instr));
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <deque>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace aco {
@@ -63,9 +64,14 @@ public:
    Program* program;
 
    int32_t cur_cycle = 0;
+   /* Cycles of cur_cycle spent waiting for dependencies or resources. */
+   int32_t stall_cycles = 0;
    int32_t res_available[(int)BlockCycleEstimator::resource_count] = {0};
    unsigned res_usage[(int)BlockCycleEstimator::resource_count] = {0};
    int32_t reg_available[512] = {0};
+   /* Used instead of reg_available before register allocation. Only tracks
+    * temporaries defined in the same block. */
+   std::unordered_map<uint32_t, int32_t> temp_available;
    std::deque<int32_t> lgkm;
    std::deque<int32_t> exp;
    std::deque<int32_t> vm;
@@ -306,6 +312,16 @@ BlockCycleEstimator::get_dependency_cost(aco_ptr<Instruction>& instr)
    if (instr->opcode == aco_opcode::s_endpgm) {
       for (unsigned i = 0; i < 512; i++)
          deps_available = MAX2(deps_available, reg_available[i]);
+   } else if (program->progress < CompilationProgress::after_ra) {
+      /* There are no waitcnts yet, so the latency of memory instructions is
+       * only visible through the temporaries they define. */
+      for (Operand& op : instr->operands) {
+         if (!op.isTemp())
+            continue;
+         auto it = temp_available.find(op.tempId());
+         if (it != temp_available.end())
+            deps_available = MAX2(deps_available, it->second);
+      }
    } else if (program->gfx_level >= GFX10) {
       for (Operand& op : instr->operands) {
          if (op.isConstant() || op.isUndefined())
@@ -354,13 +370,17 @@ BlockCycleEstimator::add(aco_ptr<Instruction>& instr)
 {
    perf_info perf = get_perf_info(program, instr);
 
-   cur_cycle += get_dependency_cost(instr);
+   unsigned dependency_cost = get_dependency_cost(instr);
+   cur_cycle += dependency_cost;
+   stall_cycles += dependency_cost;
 
    unsigned start;
    bool dual_issue = program->gfx_level >= GFX10 && program->wave_size == 64 &&
                      is_vector(instr->opcode) && program->workgroup_size > 32;
    for (unsigned i = 0; i < (dual_issue ? 2 : 1); i++) {
-      cur_cycle += cycles_until_res_available(instr);
+      int32_t res_cost = cycles_until_res_available(instr);
+      cur_cycle += res_cost;
+      stall_cycles += res_cost;
 
       start = cur_cycle;
       use_resources(instr);
@@ -396,6 +416,12 @@ BlockCycleEstimator::add(aco_ptr<Instruction>& instr)
    int32_t result_available = start + MAX2(perf.latency, latency);
 
    for (Definition& def : instr->definitions) {
+      if (program->progress < CompilationProgress::after_ra) {
+         if (def.isTemp())
+            temp_available[def.tempId()] = result_available;
+         continue;
+      }
+
       int32_t* available = &reg_available[def.physReg().reg()];
       for (unsigned i = 0; i < def.size(); i++)
          available[i] = MAX2(available[i], result_available);
@@ -430,47 +456,44 @@ BlockCycleEstimator::join(const BlockCycleEstimator& pred)
    join_queue(vs, pred.vs, -pred.cur_cycle);
 }
 
-/* instructions/branches/vmem_clauses/smem_clauses/cycles */
-void
-collect_preasm_stats(Program* program)
+static double
+get_block_frequency(Program* program, Block& block)
 {
-   for (Block& block : program->blocks) {
-      std::set<Instruction*> vmem_clause;
-      std::set<Instruction*> smem_clause;
-
-      program->statistics[statistic_instructions] += block.instructions.size();
-
-      for (aco_ptr<Instruction>& instr : block.instructions) {
-         if (instr->isSOPP() && instr->sopp().block != -1)
-            program->statistics[statistic_branches]++;
-
-         if (instr->opcode == aco_opcode::p_constaddr)
-            program->statistics[statistic_instructions] += 2;
+   /* TODO: it would be nice to be able to consider estimated loop trip
+    * counts used for loop unrolling.
+    */
 
-         if (instr->isVMEM() && !instr->operands.empty()) {
-            if (std::none_of(vmem_clause.begin(), vmem_clause.end(),
-                             [&](Instruction* other)
-                             { return should_form_clause(instr.get(), other); }))
-               program->statistics[statistic_vmem_clauses]++;
-            vmem_clause.insert(instr.get());
-         } else {
-            vmem_clause.clear();
-         }
+   /* TODO: estimate the trip_count of divergent loops (those which break
+    * divergent) higher than of uniform loops
+    */
 
-         if (instr->isSMEM() && !instr->operands.empty()) {
-            if (std::none_of(smem_clause.begin(), smem_clause.end(),
-                             [&](Instruction* other)
-                             { return should_form_clause(instr.get(), other); }))
-               program->statistics[statistic_smem_clauses]++;
-            smem_clause.insert(instr.get());
-         } else {
-            smem_clause.clear();
-         }
-      }
-   }
+   /* Assume loops execute 8-2 times, uniform branches are taken 50% the time,
+    * and any lane in the wave takes a side of a divergent branch 75% of the
+    * time.
+    */
+   double iter = 1.0;
+   iter *= block.loop_nest_depth > 0 ? 8.0 : 1.0;
+   iter *= block.loop_nest_depth > 1 ? 4.0 : 1.0;
+   iter *= block.loop_nest_depth > 2 ? pow(2.0, block.loop_nest_depth - 2) : 1.0;
+   iter *= pow(0.5, block.uniform_if_depth);
+   iter *= pow(0.75, block.divergent_if_logical_depth);
+
+   bool divergent_if_linear_else =
+      block.logical_preds.empty() && block.linear_preds.size() == 1 &&
+      block.linear_succs.size() == 1 &&
+      program->blocks[block.linear_preds[0]].kind & (block_kind_branch | block_kind_invert);
+   if (divergent_if_linear_else)
+      iter *= 0.25;
+
+   return iter;
+}
 
-   double latency = 0;
-   double usage[(int)BlockCycleEstimator::resource_count] = {0};
+/* Estimates the cycles of a wave weighted by how often each block executes, in
+ * total and per resource.
+ */
+static void
+estimate_cycles(Program* program, bool set_pass_flags, cycle_estimate* estimate, double* usage)
+{
    std::vector<BlockCycleEstimator> blocks(program->blocks.size(), program);
 
    if (program->stage.has(SWStage::VS) && program->info.vs.has_prolog) {
@@ -482,6 +505,10 @@ collect_preasm_stats(Program* program)
       }
    }
 
+   estimate->blocks.resize(program->blocks.size());
+   estimate->latency = 0;
+   estimate->stall_cycles = 0;
+
    for (Block& block : program->blocks) {
       BlockCycleEstimator& block_est = blocks[block.index];
       for (unsigned pred : block.linear_preds)
@@ -490,61 +517,104 @@ collect_preasm_stats(Program* program)
       for (aco_ptr<Instruction>& instr : block.instructions) {
          unsigned before = block_est.cur_cycle;
          block_est.add(instr);
-         instr->pass_flags = block_est.cur_cycle - before;
+         if (set_pass_flags)
+            instr->pass_flags = block_est.cur_cycle - before;
       }
 
-      /* TODO: it would be nice to be able to consider estimated loop trip
-       * counts used for loop unrolling.
-       */
-
-      /* TODO: estimate the trip_count of divergent loops (those which break
-       * divergent) higher than of uniform loops
-       */
-
-      /* Assume loops execute 8-2 times, uniform branches are taken 50% the time,
-       * and any lane in the wave takes a side of a divergent branch 75% of the
-       * time.
-       */
-      double iter = 1.0;
-      iter *= block.loop_nest_depth > 0 ? 8.0 : 1.0;
-      iter *= block.loop_nest_depth > 1 ? 4.0 : 1.0;
-      iter *= block.loop_nest_depth > 2 ? pow(2.0, block.loop_nest_depth - 2) : 1.0;
-      iter *= pow(0.5, block.uniform_if_depth);
-      iter *= pow(0.75, block.divergent_if_logical_depth);
-
-      bool divergent_if_linear_else =
-         block.logical_preds.empty() && block.linear_preds.size() == 1 &&
-         block.linear_succs.size() == 1 &&
-         program->blocks[block.linear_preds[0]].kind & (block_kind_branch | block_kind_invert);
-      if (divergent_if_linear_else)
-         iter *= 0.25;
-
-      latency += block_est.cur_cycle * iter;
+      double iter = get_block_frequency(program, block);
+
+      block_cycle_estimate& block_estimate = estimate->blocks[block.index];
+      block_estimate.cycles = block_est.cur_cycle;
+      block_estimate.stall_cycles = block_est.stall_cycles;
+      block_estimate.frequency = iter;
+
+      estimate->latency += block_est.cur_cycle * iter;
+      estimate->stall_cycles += block_est.stall_cycles * iter;
       for (unsigned i = 0; i < (unsigned)BlockCycleEstimator::resource_count; i++)
          usage[i] += block_est.res_usage[i] * iter;
    }
+}
 
+static double
+get_wave64_per_cycle(Program* program, double latency, const double* usage, double* parallelism,
+                     double* max_utilization)
+{
    /* This likely exaggerates the effectiveness of parallelism because it
     * ignores instruction ordering. It can assume there might be SALU/VALU/etc
     * work to from other waves while one is idle but that might not be the case
     * because those other waves have not reached such a point yet.
     */
 
-   double parallelism = program->num_waves;
+   *parallelism = program->num_waves;
    for (unsigned i = 0; i < (unsigned)BlockCycleEstimator::resource_count; i++) {
       if (usage[i] > 0.0)
-         parallelism = MIN2(parallelism, latency / usage[i]);
+         *parallelism = MIN2(*parallelism, latency / usage[i]);
    }
-   double waves_per_cycle = 1.0 / latency * parallelism;
+   double waves_per_cycle = 1.0 / latency * *parallelism;
    double wave64_per_cycle = waves_per_cycle * (program->wave_size / 64.0);
 
-   double max_utilization = 1.0;
+   *max_utilization = 1.0;
    if (program->workgroup_size != UINT_MAX)
-      max_utilization =
+      *max_utilization =
          program->workgroup_size / (double)align(program->workgroup_size, program->wave_size);
-   wave64_per_cycle *= max_utilization;
+   wave64_per_cycle *= *max_utilization;
+
+   return wave64_per_cycle;
+}
+
+/* instructions/branches/vmem_clauses/smem_clauses/cycles */
+void
+collect_preasm_stats(Program* program)
+{
+   for (Block& block : program->blocks) {
+      std::set<Instruction*> vmem_clause;
+      std::set<Instruction*> smem_clause;
+
+      program->statistics[statistic_instructions] += block.instructions.size();
+
+      for (aco_ptr<Instruction>& instr : block.instructions) {
+         if (instr->isSOPP() && instr->sopp().block != -1)
+            program->statistics[statistic_branches]++;
+
+         if (instr->opcode == aco_opcode::p_constaddr)
+            program->statistics[statistic_instructions] += 2;
+
+         if (instr->opcode == aco_opcode::s_nop)
+            program->statistics[statistic_nop_cycles] += instr->sopp().imm + 1;
+
+         if (instr->isVMEM() && !instr->operands.empty()) {
+            if (std::none_of(vmem_clause.begin(), vmem_clause.end(),
+                             [&](Instruction* other)
+                             { return should_form_clause(instr.get(), other); }))
+               program->statistics[statistic_vmem_clauses]++;
+            vmem_clause.insert(instr.get());
+         } else {
+            vmem_clause.clear();
+         }
+
+         if (instr->isSMEM() && !instr->operands.empty()) {
+            if (std::none_of(smem_clause.begin(), smem_clause.end(),
+                             [&](Instruction* other)
+                             { return should_form_clause(instr.get(), other); }))
+               program->statistics[statistic_smem_clauses]++;
+            smem_clause.insert(instr.get());
+         } else {
+            smem_clause.clear();
+         }
+      }
+   }
+
+   cycle_estimate estimate;
+   double usage[(int)BlockCycleEstimator::resource_count] = {0};
+   estimate_cycles(program, true, &estimate, usage);
+   double latency = estimate.latency;
+   double parallelism = 0;
+   double max_utilization = 0;
+   double wave64_per_cycle =
+      get_wave64_per_cycle(program, latency, usage, &parallelism, &max_utilization);
 
    program->statistics[statistic_latency] = round(latency);
+   program->statistics[statistic_stall_cycles] = round(estimate.stall_cycles);
    program->statistics[statistic_inv_throughput] = round(1.0 / wave64_per_cycle);
 
    if (debug_flags & DEBUG_PERF_INFO) {
@@ -560,6 +630,7 @@ collect_preasm_stats(Program* program)
       fprintf(stderr, "export_gds_usage: %f\n", usage[(int)BlockCycleEstimator::export_gds]);
       fprintf(stderr, "vmem_usage: %f\n", usage[(int)BlockCycleEstimator::vmem]);
       fprintf(stderr, "latency: %f\n", latency);
+      fprintf(stderr, "stall_cycles: %f\n", estimate.stall_cycles);
       fprintf(stderr, "parallelism: %f\n", parallelism);
       fprintf(stderr, "max_utilization: %f\n", max_utilization);
       fprintf(stderr, "wave64_per_cycle: %f\n", wave64_per_cycle);
@@ -567,6 +638,30 @@ collect_preasm_stats(Program* program)
    }
 }
 
+/* The model behind statistic_latency, statistic_stall_cycles and
+ * statistic_inv_throughput. Unlike collect_preasm_stats(), this can be used at
+ * any point of the compilation, including before register allocation, and
+ * leaves the program unchanged.
+ */
+cycle_estimate
+estimate_program_cycles(Program* program)
+{
+   cycle_estimate estimate;
+   double usage[(int)BlockCycleEstimator::resource_count] = {0};
+   estimate_cycles(program, false, &estimate, usage);
+
+   double wave64_per_cycle = get_wave64_per_cycle(program, estimate.latency, usage,
+                                                  &estimate.parallelism, &estimate.max_utilization);
+   estimate.inv_throughput = 1.0 / wave64_per_cycle;
+   return estimate;
+}
+
+double
+estimate_inv_throughput(Program* program)
+{
+   return estimate_program_cycles(program).inv_throughput;
+}
+
 void
 collect_postasm_stats(Program* program, const std::vector<uint32_t>& code)
 {
@@ -381,6 +381,7 @@ radv_handle_thread_trace(VkQueue _queue)
    if (!thread_trace_enabled) {
       bool frame_trigger = num_frames == queue->device->thread_trace.start_frame;
       bool file_trigger = false;
+      bool signal_trigger = radv_thread_trace_signal_triggered();
 #ifndef _WIN32
       if (queue->device->thread_trace.trigger_file &&
           access(queue->device->thread_trace.trigger_file, W_OK) == 0) {
@@ -394,7 +395,7 @@ radv_handle_thread_trace(VkQueue _queue)
       }
 #endif
 
-      if (frame_trigger || file_trigger || resize_trigger) {
+      if (frame_trigger || file_trigger || signal_trigger || resize_trigger) {
          if (ac_check_profile_state(&queue->device->physical_device->rad_info)) {
             fprintf(stderr, "radv: Canceling RGP trace request as a hang condition has been "
                             "detected. Force the GPU into a profiling mode with e.g. "
@@ -819,6 +819,223 @@ radix_sort_vk_sort_devaddr(radix_sort_vk_t const *                   rs,
 #endif
 }
 
+//
+// Sorts several keyval arrays with the same pipelines, interleaving the
+// dispatches of each step so that all of the sorts share the barriers
+// between steps.
+//
+// Extensions and debug labels are not supported here.
+//
+void
+radix_sort_vk_sort_devaddr_batch(radix_sort_vk_t const *                   rs,
+                                 uint32_t                                  info_count,
+                                 radix_sort_vk_sort_devaddr_info_t const * infos,
+                                 VkDevice                                  device,
+                                 VkCommandBuffer                           cb,
+                                 VkDeviceAddress *                         keyvals_sorted)
+{
+  //
+  // How many passes?  The key bits may differ between infos so each sort
+  // starts at its own pass and all of them end on the last one.
+  //
+  uint32_t const keyval_bytes = rs->config.keyval_dwords * (uint32_t)sizeof(uint32_t);
+  uint32_t const keyval_bits  = keyval_bytes * 8;
+
+  uint32_t const scatter_wg_size   = 1 << rs->config.scatter.workgroup_size_log2;
+  uint32_t const scatter_block_kvs = scatter_wg_size * rs->config.scatter.block_rows;
+  uint32_t const histo_wg_size     = 1 << rs->config.histogram.workgroup_size_log2;
+  uint32_t const histo_block_kvs   = histo_wg_size * rs->config.histogram.block_rows;
+
+  uint32_t max_passes = 0;
+
+  for (uint32_t ii = 0; ii < info_count; ii++)
+    {
+      radix_sort_vk_sort_devaddr_info_t const * info = infos + ii;
+
+      if ((info->count <= 1) || (info->key_bits == 0))
+        {
+          keyvals_sorted[ii] = info->keyvals_even.devaddr;
+
+          continue;
+        }
+
+      uint32_t const key_bits = MIN_MACRO(uint32_t, info->key_bits, keyval_bits);
+      uint32_t const passes   = (key_bits + RS_RADIX_LOG2 - 1) / RS_RADIX_LOG2;
+
+      keyvals_sorted[ii] = ((passes & 1) != 0) ? info->keyvals_odd : info->keyvals_even.devaddr;
+
+      max_passes = MAX_MACRO(uint32_t, max_passes, passes);
+
+      //
+      // Pad fractional blocks with max-valued keyvals and zero the
+      // histograms and partitions, see radix_sort_vk_sort_devaddr().
+      //
+      uint32_t const scatter_blocks   = (info->count + scatter_block_kvs - 1) / scatter_block_kvs;
+      uint32_t const count_ru_scatter = scatter_blocks * scatter_block_kvs;
+      uint32_t const histo_blocks     = (count_ru_scatter + histo_block_kvs - 1) / histo_block_kvs;
+      uint32_t const count_ru_histo   = histo_blocks * histo_block_kvs;
+
+      if (count_ru_histo > info->count)
+        {
+          info->fill_buffer(cb,
+                            &info->keyvals_even,
+                            info->count * keyval_bytes,
+                            (count_ru_histo - info->count) * keyval_bytes,
+                            0xFFFFFFFF);
+        }
+
+      uint32_t const histo_partition_count = passes + scatter_blocks - 1;
+      uint32_t const pass_idx              = (keyval_bytes - passes);
+
+      VkDeviceSize const fill_base = pass_idx * (RS_RADIX_SIZE * sizeof(uint32_t));
+
+      info->fill_buffer(cb,
+                        &info->internal,
+                        rs->internal.histograms.offset + fill_base,
+                        histo_partition_count * (RS_RADIX_SIZE * sizeof(uint32_t)),
+                        0);
+    }
+
+  //
+  // Anything to do?
+  //
+  if (max_passes == 0)
+    return;
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // Pipeline: HISTOGRAM
+  //
+  vk_barrier_transfer_w_to_compute_r(cb);
+
+  vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, rs->pipelines.named.histogram);
+
+  for (uint32_t ii = 0; ii < info_count; ii++)
+    {
+      radix_sort_vk_sort_devaddr_info_t const * info = infos + ii;
+
+      if ((info->count <= 1) || (info->key_bits == 0))
+        continue;
+
+      uint32_t const key_bits = MIN_MACRO(uint32_t, info->key_bits, keyval_bits);
+      uint32_t const passes   = (key_bits + RS_RADIX_LOG2 - 1) / RS_RADIX_LOG2;
+
+      uint32_t const scatter_blocks   = (info->count + scatter_block_kvs - 1) / scatter_block_kvs;
+      uint32_t const count_ru_scatter = scatter_blocks * scatter_block_kvs;
+      uint32_t const histo_blocks     = (count_ru_scatter + histo_block_kvs - 1) / histo_block_kvs;
+
+      struct rs_push_histogram const push_histogram = {
+
+        .devaddr_histograms = info->internal.devaddr + rs->internal.histograms.offset,
+        .devaddr_keyvals    = info->keyvals_even.devaddr,
+        .passes             = passes
+      };
+
+      vkCmdPushConstants(cb,
+                         rs->pipeline_layouts.named.histogram,
+                         VK_SHADER_STAGE_COMPUTE_BIT,
+                         0,
+                         sizeof(push_histogram),
+                         &push_histogram);
+
+      vkCmdDispatch(cb, histo_blocks, 1, 1);
+    }
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // Pipeline: PREFIX
+  //
+  vk_barrier_compute_w_to_compute_r(cb);
+
+  vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, rs->pipelines.named.prefix);
+
+  for (uint32_t ii = 0; ii < info_count; ii++)
+    {
+      radix_sort_vk_sort_devaddr_info_t const * info = infos + ii;
+
+      if ((info->count <= 1) || (info->key_bits == 0))
+        continue;
+
+      uint32_t const key_bits = MIN_MACRO(uint32_t, info->key_bits, keyval_bits);
+      uint32_t const passes   = (key_bits + RS_RADIX_LOG2 - 1) / RS_RADIX_LOG2;
+
+      struct rs_push_prefix const push_prefix = {
+
+        .devaddr_histograms = info->internal.devaddr + rs->internal.histograms.offset,
+      };
+
+      vkCmdPushConstants(cb,
+                         rs->pipeline_layouts.named.prefix,
+                         VK_SHADER_STAGE_COMPUTE_BIT,
+                         0,
+                         sizeof(push_prefix),
+                         &push_prefix);
+
+      vkCmdDispatch(cb, passes, 1, 1);
+    }
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // Pipeline: SCATTER
+  //
+  // Pass indices are absolute so a sort with fewer passes simply joins in
+  // later.  Each sort's even/odd parity is relative to its first pass.
+  //
+  for (uint32_t pass_idx = keyval_bytes - max_passes; pass_idx < keyval_bytes; pass_idx++)
+    {
+      vk_barrier_compute_w_to_compute_r(cb);
+
+      uint32_t const pass_dword = pass_idx / 4;
+
+      for (uint32_t ii = 0; ii < info_count; ii++)
+        {
+          radix_sort_vk_sort_devaddr_info_t const * info = infos + ii;
+
+          if ((info->count <= 1) || (info->key_bits == 0))
+            continue;
+
+          uint32_t const key_bits   = MIN_MACRO(uint32_t, info->key_bits, keyval_bits);
+          uint32_t const passes     = (key_bits + RS_RADIX_LOG2 - 1) / RS_RADIX_LOG2;
+          uint32_t const first_pass = keyval_bytes - passes;
+
+          if (pass_idx < first_pass)
+            continue;
+
+          bool const is_even = ((pass_idx - first_pass) & 1) == 0;
+
+          uint32_t const scatter_blocks = (info->count + scatter_block_kvs - 1) / scatter_block_kvs;
+
+          VkDeviceAddress const devaddr_histograms = info->internal.devaddr +
+                                                     rs->internal.histograms.offset;
+
+          struct rs_push_scatter const push_scatter = {
+
+            .devaddr_keyvals_even = info->keyvals_even.devaddr,
+            .devaddr_keyvals_odd  = info->keyvals_odd,
+            .devaddr_partitions   = info->internal.devaddr + rs->internal.partitions.offset,
+            .devaddr_histograms   = devaddr_histograms + pass_idx * (RS_RADIX_SIZE * sizeof(uint32_t)),
+            .pass_offset          = (pass_idx & 3) * RS_RADIX_LOG2,
+          };
+
+          VkPipelineLayout const pl = is_even ? rs->pipeline_layouts.named.scatter[pass_dword].even  //
+                                              : rs->pipeline_layouts.named.scatter[pass_dword].odd;
+          VkPipeline const       p  = is_even ? rs->pipelines.named.scatter[pass_dword].even  //
+                                              : rs->pipelines.named.scatter[pass_dword].odd;
+
+          vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, p);
+
+          vkCmdPushConstants(cb,
+                             pl,
+                             VK_SHADER_STAGE_COMPUTE_BIT,
+                             0,
+                             sizeof(push_scatter),
+                             &push_scatter);
+
+          vkCmdDispatch(cb, scatter_blocks, 1, 1);
+        }
+    }
+}
+
 //
 //
 //
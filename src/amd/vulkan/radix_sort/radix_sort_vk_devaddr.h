@@ -64,6 +64,21 @@ radix_sort_vk_sort_devaddr(radix_sort_vk_t const *                   rs,
                            VkCommandBuffer                           cb,
                            VkDeviceAddress *                         keyvals_sorted);
 
+//
+// Sorts `info_count` arrays at once.  The dispatches of all sorts are
+// interleaved so they share one set of barriers, which is much cheaper than
+// back to back calls to radix_sort_vk_sort_devaddr() for many small sorts.
+//
+// `keyvals_sorted` must have room for `info_count` addresses.
+//
+void
+radix_sort_vk_sort_devaddr_batch(radix_sort_vk_t const *                   rs,
+                                 uint32_t                                  info_count,
+                                 radix_sort_vk_sort_devaddr_info_t const * infos,
+                                 VkDevice                                  device,
+                                 VkCommandBuffer                           cb,
+                                 VkDeviceAddress *                         keyvals_sorted);
+
 //
 // Indirect dispatch sorting using buffer device addresses
 // -------------------------------------------------------
@@ -2149,46 +2149,69 @@ radv_CmdBuildAccelerationStructuresKHR(
 
       cmd_buffer->state.flush_bits |= flush_bits;
 
+      /* Sort all of the builds at once so they share the barriers between the
+       * radix sort passes.
+       */
+      struct radix_sort_vk_sort_devaddr_info *sort_infos =
+         malloc(infoCount * sizeof(*sort_infos));
+      VkDeviceAddress *sort_results = malloc(infoCount * sizeof(*sort_results));
+      if (!sort_infos || !sort_results) {
+         free(sort_infos);
+         free(sort_results);
+         free(bvh_states);
+         radv_meta_restore(&saved_state, cmd_buffer);
+         cmd_buffer->record_result = VK_ERROR_OUT_OF_HOST_MEMORY;
+         return;
+      }
+
       for (uint32_t i = 0; i < infoCount; ++i) {
          struct radix_sort_vk_memory_requirements requirements;
          radix_sort_vk_get_memory_requirements(
             cmd_buffer->device->meta_state.accel_struct_build.radix_sort, bvh_states[i].node_count,
             &requirements);
 
-         struct radix_sort_vk_sort_devaddr_info info =
-            cmd_buffer->device->meta_state.accel_struct_build.radix_sort_info;
-         info.count = bvh_states[i].node_count;
+         struct radix_sort_vk_sort_devaddr_info *info = &sort_infos[i];
+         *info = cmd_buffer->device->meta_state.accel_struct_build.radix_sort_info;
+         info->count = bvh_states[i].node_count;
 
          VkDeviceAddress base_addr =
             pInfos[i].scratchData.deviceAddress + SCRATCH_TOTAL_BOUNDS_SIZE;
 
-         info.keyvals_even.buffer = VK_NULL_HANDLE;
-         info.keyvals_even.offset = 0;
-         info.keyvals_even.devaddr = base_addr;
+         info->keyvals_even.buffer = VK_NULL_HANDLE;
+         info->keyvals_even.offset = 0;
+         info->keyvals_even.devaddr = base_addr;
+
+         info->keyvals_odd = base_addr + requirements.keyvals_size;
 
-         info.keyvals_odd = base_addr + requirements.keyvals_size;
+         info->internal.buffer = VK_NULL_HANDLE;
+         info->internal.offset = 0;
+         info->internal.devaddr = base_addr + requirements.keyvals_size * 2;
+      }
 
-         info.internal.buffer = VK_NULL_HANDLE;
-         info.internal.offset = 0;
-         info.internal.devaddr = base_addr + requirements.keyvals_size * 2;
+      radix_sort_vk_sort_devaddr_batch(
+         cmd_buffer->device->meta_state.accel_struct_build.radix_sort, infoCount, sort_infos,
+         radv_device_to_handle(cmd_buffer->device), commandBuffer, sort_results);
 
-         VkDeviceAddress result_addr;
-         radix_sort_vk_sort_devaddr(cmd_buffer->device->meta_state.accel_struct_build.radix_sort,
-                                    &info, radv_device_to_handle(cmd_buffer->device), commandBuffer,
-                                    &result_addr);
+      for (uint32_t i = 0; i < infoCount; ++i) {
+         const struct radix_sort_vk_sort_devaddr_info *info = &sort_infos[i];
+         uint64_t keyvals_size = info->keyvals_odd - info->keyvals_even.devaddr;
 
-         assert(result_addr == info.keyvals_even.devaddr || result_addr == info.keyvals_odd);
+         assert(sort_results[i] == info->keyvals_even.devaddr ||
+                sort_results[i] == info->keyvals_odd);
 
-         if (result_addr == info.keyvals_even.devaddr) {
+         if (sort_results[i] == info->keyvals_even.devaddr) {
             bvh_states[i].buffer_1_offset = SCRATCH_TOTAL_BOUNDS_SIZE;
-            bvh_states[i].buffer_2_offset = SCRATCH_TOTAL_BOUNDS_SIZE + requirements.keyvals_size;
+            bvh_states[i].buffer_2_offset = SCRATCH_TOTAL_BOUNDS_SIZE + keyvals_size;
          } else {
-            bvh_states[i].buffer_1_offset = SCRATCH_TOTAL_BOUNDS_SIZE + requirements.keyvals_size;
+            bvh_states[i].buffer_1_offset = SCRATCH_TOTAL_BOUNDS_SIZE + keyvals_size;
             bvh_states[i].buffer_2_offset = SCRATCH_TOTAL_BOUNDS_SIZE;
          }
          bvh_states[i].scratch_offset = bvh_states[i].buffer_1_offset;
       }
 
+      free(sort_infos);
+      free(sort_results);
+
       cmd_buffer->state.flush_bits |= flush_bits;
    } else {
       for (uint32_t i = 0; i < infoCount; ++i) {
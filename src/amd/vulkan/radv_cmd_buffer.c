@@ -4634,6 +4634,10 @@ radv_BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBegi
    }
 
    memset(&cmd_buffer->state, 0, sizeof(cmd_buffer->state));
+   /* The vkCmdSet* functions skip values that match the current dynamic state,
+    * which is only meaningful once it has been emitted. Emit all of it with the
+    * first draw. */
+   cmd_buffer->state.dirty = RADV_CMD_DIRTY_DYNAMIC_ALL;
    cmd_buffer->state.last_primitive_reset_en = -1;
    cmd_buffer->state.last_index_type = -1;
    cmd_buffer->state.last_num_instances = -1;
@@ -5241,6 +5245,11 @@ radv_CmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint3
    assert(firstViewport < MAX_VIEWPORTS);
    assert(total_count >= 1 && total_count <= MAX_VIEWPORTS);
 
+   if (state->dynamic.viewport.count >= total_count &&
+       !memcmp(state->dynamic.viewport.viewports + firstViewport, pViewports,
+               viewportCount * sizeof(*pViewports)))
+      return;
+
    if (state->dynamic.viewport.count < total_count)
       state->dynamic.viewport.count = total_count;
 
@@ -5266,6 +5275,11 @@ radv_CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_
    assert(firstScissor < MAX_SCISSORS);
    assert(total_count >= 1 && total_count <= MAX_SCISSORS);
 
+   if (state->dynamic.scissor.count >= total_count &&
+       !memcmp(state->dynamic.scissor.scissors + firstScissor, pScissors,
+               scissorCount * sizeof(*pScissors)))
+      return;
+
    if (state->dynamic.scissor.count < total_count)
       state->dynamic.scissor.count = total_count;
 
@@ -5280,6 +5294,9 @@ radv_CmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
 {
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
 
+   if (cmd_buffer->state.dynamic.line_width == lineWidth)
+      return;
+
    cmd_buffer->state.dynamic.line_width = lineWidth;
    cmd_buffer->state.dirty |= RADV_CMD_DIRTY_DYNAMIC_LINE_WIDTH;
 }
@@ -5291,6 +5308,11 @@ radv_CmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFacto
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_bias.bias == depthBiasConstantFactor &&
+       state->dynamic.depth_bias.clamp == depthBiasClamp &&
+       state->dynamic.depth_bias.slope == depthBiasSlopeFactor)
+      return;
+
    state->dynamic.depth_bias.bias = depthBiasConstantFactor;
    state->dynamic.depth_bias.clamp = depthBiasClamp;
    state->dynamic.depth_bias.slope = depthBiasSlopeFactor;
@@ -5304,6 +5326,9 @@ radv_CmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConsta
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (!memcmp(state->dynamic.blend_constants, blendConstants, sizeof(float) * 4))
+      return;
+
    memcpy(state->dynamic.blend_constants, blendConstants, sizeof(float) * 4);
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_BLEND_CONSTANTS;
@@ -5315,6 +5340,10 @@ radv_CmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, floa
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_bounds.min == minDepthBounds &&
+       state->dynamic.depth_bounds.max == maxDepthBounds)
+      return;
+
    state->dynamic.depth_bounds.min = minDepthBounds;
    state->dynamic.depth_bounds.max = maxDepthBounds;
 
@@ -5419,6 +5448,9 @@ radv_CmdSetCullMode(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode)
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.cull_mode == cullMode)
+      return;
+
    state->dynamic.cull_mode = cullMode;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_CULL_MODE;
@@ -5430,6 +5462,9 @@ radv_CmdSetFrontFace(VkCommandBuffer commandBuffer, VkFrontFace frontFace)
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.front_face == frontFace)
+      return;
+
    state->dynamic.front_face = frontFace;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_FRONT_FACE;
@@ -5444,6 +5479,9 @@ radv_CmdSetPrimitiveTopology(VkCommandBuffer commandBuffer, VkPrimitiveTopology
    bool old_is_linestrip = (state->dynamic.primitive_topology == V_008958_DI_PT_LINESTRIP);
    bool new_is_linestrip = (primitive_topology == V_008958_DI_PT_LINESTRIP);
 
+   if (state->dynamic.primitive_topology == primitive_topology)
+      return;
+
    if (old_is_linestrip != new_is_linestrip)
       state->dirty |= RADV_CMD_DIRTY_DYNAMIC_LINE_STIPPLE;
    state->dynamic.primitive_topology = primitive_topology;
@@ -5472,6 +5510,9 @@ radv_CmdSetDepthTestEnable(VkCommandBuffer commandBuffer, VkBool32 depthTestEnab
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_test_enable == depthTestEnable)
+      return;
+
    state->dynamic.depth_test_enable = depthTestEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_DEPTH_TEST_ENABLE;
@@ -5483,6 +5524,9 @@ radv_CmdSetDepthWriteEnable(VkCommandBuffer commandBuffer, VkBool32 depthWriteEn
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_write_enable == depthWriteEnable)
+      return;
+
    state->dynamic.depth_write_enable = depthWriteEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_DEPTH_WRITE_ENABLE;
@@ -5494,6 +5538,9 @@ radv_CmdSetDepthCompareOp(VkCommandBuffer commandBuffer, VkCompareOp depthCompar
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_compare_op == depthCompareOp)
+      return;
+
    state->dynamic.depth_compare_op = depthCompareOp;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_DEPTH_COMPARE_OP;
@@ -5505,6 +5552,9 @@ radv_CmdSetDepthBoundsTestEnable(VkCommandBuffer commandBuffer, VkBool32 depthBo
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_bounds_test_enable == depthBoundsTestEnable)
+      return;
+
    state->dynamic.depth_bounds_test_enable = depthBoundsTestEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_DEPTH_BOUNDS_TEST_ENABLE;
@@ -5516,6 +5566,9 @@ radv_CmdSetStencilTestEnable(VkCommandBuffer commandBuffer, VkBool32 stencilTest
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.stencil_test_enable == stencilTestEnable)
+      return;
+
    state->dynamic.stencil_test_enable = stencilTestEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_STENCIL_TEST_ENABLE;
@@ -5566,6 +5619,9 @@ radv_CmdSetDepthBiasEnable(VkCommandBuffer commandBuffer, VkBool32 depthBiasEnab
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.depth_bias_enable == depthBiasEnable)
+      return;
+
    state->dynamic.depth_bias_enable = depthBiasEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_DEPTH_BIAS_ENABLE;
@@ -5577,6 +5633,9 @@ radv_CmdSetPrimitiveRestartEnable(VkCommandBuffer commandBuffer, VkBool32 primit
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.primitive_restart_enable == primitiveRestartEnable)
+      return;
+
    state->dynamic.primitive_restart_enable = primitiveRestartEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_PRIMITIVE_RESTART_ENABLE;
@@ -5588,6 +5647,9 @@ radv_CmdSetRasterizerDiscardEnable(VkCommandBuffer commandBuffer, VkBool32 raste
    RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
    struct radv_cmd_state *state = &cmd_buffer->state;
 
+   if (state->dynamic.rasterizer_discard_enable == rasterizerDiscardEnable)
+      return;
+
    state->dynamic.rasterizer_discard_enable = rasterizerDiscardEnable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_RASTERIZER_DISCARD_ENABLE;
@@ -5606,6 +5668,9 @@ radv_CmdSetLogicOpEXT(VkCommandBuffer commandBuffer, VkLogicOp logicOp)
    struct radv_cmd_state *state = &cmd_buffer->state;
    unsigned logic_op = si_translate_blend_logic_op(logicOp);
 
+   if (state->dynamic.logic_op == logic_op)
+      return;
+
    state->dynamic.logic_op = logic_op;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_LOGIC_OP;
@@ -5625,6 +5690,9 @@ radv_CmdSetColorWriteEnableEXT(VkCommandBuffer commandBuffer, uint32_t attachmen
       color_write_enable |= pColorWriteEnables[i] ? (0xfu << (i * 4)) : 0;
    }
 
+   if (state->dynamic.color_write_enable == color_write_enable)
+      return;
+
    state->dynamic.color_write_enable = color_write_enable;
 
    state->dirty |= RADV_CMD_DIRTY_DYNAMIC_COLOR_WRITE_ENABLE;
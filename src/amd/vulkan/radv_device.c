@@ -65,6 +65,7 @@ typedef void *drmDevicePtr;
 #include "util/mesa-sha1.h"
 #include "util/timespec.h"
 #include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
 #include "winsys/null/radv_null_winsys_public.h"
 #include "git_sha1.h"
 #include "sid.h"
@@ -330,7 +331,8 @@ static bool
 radv_thread_trace_enabled()
 {
    return radv_get_int_debug_option("RADV_THREAD_TRACE", -1) >= 0 ||
-          getenv("RADV_THREAD_TRACE_TRIGGER");
+          getenv("RADV_THREAD_TRACE_TRIGGER") ||
+          radv_get_int_debug_option("RADV_THREAD_TRACE_TRIGGER_SIGNAL", 0) > 0;
 }
 
 static bool
@@ -899,6 +901,7 @@ static const struct debug_control radv_debug_options[] = {
    {"nonggc", RADV_DEBUG_NO_NGGC},
    {"prologs", RADV_DEBUG_DUMP_PROLOGS},
    {"nodma", RADV_DEBUG_NO_DMA_BLIT},
+   {"nothreadedcompile", RADV_DEBUG_NO_THREADED_COMPILE},
    {NULL, 0}};
 
 const char *
@@ -3270,6 +3273,18 @@ radv_CreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCr
 
    radv_init_shader_arenas(device);
 
+   /* The calling thread compiles one of the stages itself. If creating the
+    * queue fails, all stages are compiled on the calling thread.
+    */
+   unsigned num_compiler_threads =
+      MIN2(util_get_cpu_caps()->nr_cpus, MESA_VULKAN_SHADER_STAGES) - 1;
+   if (num_compiler_threads) {
+      util_queue_init(&device->shader_compiler_queue, "radv_sh", 64, num_compiler_threads,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL | UTIL_QUEUE_INIT_SCALE_THREADS |
+                         UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY,
+                      NULL);
+   }
+
    device->overallocation_disallowed = overallocation_disallowed;
    mtx_init(&device->overallocation_mutex, mtx_plain);
 
@@ -3534,6 +3549,9 @@ fail:
    simple_mtx_destroy(&device->trace_mtx);
    mtx_destroy(&device->overallocation_mutex);
 
+   if (util_queue_is_initialized(&device->shader_compiler_queue))
+      util_queue_destroy(&device->shader_compiler_queue);
+
    vk_device_finish(&device->vk);
    vk_free(&device->vk.alloc, device);
    return result;
@@ -3582,6 +3600,9 @@ radv_DestroyDevice(VkDevice _device, const VkAllocationCallbacks *pAllocator)
    radv_trap_handler_finish(device);
    radv_finish_trace(device);
 
+   if (util_queue_is_initialized(&device->shader_compiler_queue))
+      util_queue_destroy(&device->shader_compiler_queue);
+
    radv_destroy_shader_arenas(device);
 
    radv_thread_trace_finish(device);
@@ -411,18 +411,22 @@ meta_free(void *_device, void *data)
 }
 
 #ifndef _WIN32
+/* The cache is per GPU family, so that systems with several GPUs don't keep
+ * replacing each other's shaders. */
 static bool
-radv_builtin_cache_path(char *path)
+radv_builtin_cache_path(const struct radv_device *device, char *path)
 {
    char *xdg_cache_home = getenv("XDG_CACHE_HOME");
    const char *suffix = "/radv_builtin_shaders";
    const char *suffix2 = "/.cache/radv_builtin_shaders";
+   const char *family = ac_get_family_name(device->physical_device->rad_info.family);
    struct passwd pwd, *result;
    char path2[PATH_MAX + 1]; /* PATH_MAX is not a real max,but suffices here. */
    int ret;
 
    if (xdg_cache_home) {
-      ret = snprintf(path, PATH_MAX + 1, "%s%s%zd", xdg_cache_home, suffix, sizeof(void *) * 8);
+      ret = snprintf(path, PATH_MAX + 1, "%s%s%zd_%s", xdg_cache_home, suffix, sizeof(void *) * 8,
+                     family);
       return ret > 0 && ret < PATH_MAX + 1;
    }
 
@@ -435,7 +439,8 @@ radv_builtin_cache_path(char *path)
    if (mkdir(path, 0755) && errno != EEXIST)
       return false;
 
-   ret = snprintf(path, PATH_MAX + 1, "%s%s%zd", pwd.pw_dir, suffix2, sizeof(void *) * 8);
+   ret = snprintf(path, PATH_MAX + 1, "%s%s%zd_%s", pwd.pw_dir, suffix2, sizeof(void *) * 8,
+                  family);
    return ret > 0 && ret < PATH_MAX + 1;
 }
 #endif
@@ -451,7 +456,7 @@ radv_load_meta_pipeline(struct radv_device *device)
    void *data = NULL;
    bool ret = false;
 
-   if (!radv_builtin_cache_path(path))
+   if (!radv_builtin_cache_path(device, path))
       return false;
 
    int fd = open(path, O_RDONLY);
@@ -489,7 +494,7 @@ radv_store_meta_pipeline(struct radv_device *device)
                                  NULL))
       return;
 
-   if (!radv_builtin_cache_path(path))
+   if (!radv_builtin_cache_path(device, path))
       return;
 
    strcpy(path2, path);
@@ -532,8 +537,13 @@ radv_device_init_meta(struct radv_device *device)
 
    device->meta_state.cache.alloc = device->meta_state.alloc;
    radv_pipeline_cache_init(&device->meta_state.cache, device);
-   bool loaded_cache = radv_load_meta_pipeline(device);
-   bool on_demand = !loaded_cache;
+   radv_load_meta_pipeline(device);
+
+   /* Always create the meta pipelines when they are first used. Most apps only
+    * need a few of them, and with the builtin cache loaded creating one is a
+    * cache lookup rather than a compile, so there is nothing to gain from
+    * creating all of them upfront. */
+   bool on_demand = true;
 
    mtx_init(&device->meta_state.mtx, mtx_plain);
 
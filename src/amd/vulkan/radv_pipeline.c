@@ -4311,6 +4311,34 @@ radv_pipeline_create_gs_copy_shader(struct radv_pipeline *pipeline,
                                      pipeline_key->optimisations_disabled);
 }
 
+struct radv_shader_compile_job {
+   struct radv_device *device;
+   struct radv_pipeline_stage *pl_stage;
+   gl_shader_stage stage;
+   nir_shader *shaders[2];
+   unsigned shader_count;
+   const struct radv_pipeline_key *pipeline_key;
+   bool keep_executable_info;
+   bool keep_statistic_info;
+
+   struct radv_shader *shader;
+   struct radv_shader_binary *binary;
+   struct util_queue_fence fence;
+};
+
+static void
+radv_shader_compile_job_execute(void *data, void *gdata, int thread_index)
+{
+   struct radv_shader_compile_job *job = data;
+   int64_t stage_start = os_time_get_nano();
+
+   job->shader = radv_shader_nir_to_asm(job->device, job->pl_stage, job->shaders, job->shader_count,
+                                        job->pipeline_key, job->keep_executable_info,
+                                        job->keep_statistic_info, &job->binary);
+
+   job->pl_stage->feedback.duration += os_time_get_nano() - stage_start;
+}
+
 static void
 radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_stage *stages,
                          const struct radv_pipeline_key *pipeline_key,
@@ -4337,11 +4365,18 @@ radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_st
                                              gs_copy_binary);
    }
 
+   struct radv_shader_compile_job jobs[MESA_VULKAN_SHADER_STAGES];
+   unsigned num_jobs = 0;
+
    for (int s = MESA_VULKAN_SHADER_STAGES - 1; s >= 0; s--) {
       if (!(active_stages & (1 << s)) || pipeline->shaders[s])
          continue;
 
-      nir_shader *shaders[2] = { stages[s].nir, NULL };
+      struct radv_shader_compile_job *job = &jobs[num_jobs];
+      nir_shader **shaders = job->shaders;
+
+      shaders[0] = stages[s].nir;
+      shaders[1] = NULL;
       unsigned shader_count = 1;
 
       /* On GFX9+, TES is merged with GS and VS is merged with TCS or GS. */
@@ -4360,18 +4395,49 @@ radv_pipeline_nir_to_asm(struct radv_pipeline *pipeline, struct radv_pipeline_st
          shader_count = 2;
       }
 
-      int64_t stage_start = os_time_get_nano();
-
-      pipeline->shaders[s] = radv_shader_nir_to_asm(device, &stages[s], shaders, shader_count,
-                                                    pipeline_key, keep_executable_info,
-                                                    keep_statistic_info, &binaries[s]);
-
-      stages[s].feedback.duration += os_time_get_nano() - stage_start;
+      job->device = device;
+      job->pl_stage = &stages[s];
+      job->stage = s;
+      job->shader_count = shader_count;
+      job->pipeline_key = pipeline_key;
+      job->keep_executable_info = keep_executable_info;
+      job->keep_statistic_info = keep_statistic_info;
+      job->shader = NULL;
+      job->binary = NULL;
+      num_jobs++;
 
       active_stages &= ~(1 << shaders[0]->info.stage);
       if (shaders[1])
          active_stages &= ~(1 << shaders[1]->info.stage);
    }
+
+   /* Every job compiles its own NIR shaders and writes its own outputs, so
+    * the stages of the pipeline can be compiled at the same time. Keep the
+    * shader dumps readable by not interleaving them.
+    */
+   bool threaded = num_jobs > 1 && util_queue_is_initialized(&device->shader_compiler_queue) &&
+                   !(device->instance->debug_flags &
+                     (RADV_DEBUG_NO_THREADED_COMPILE | RADV_DEBUG_DUMP_SHADERS));
+
+   if (threaded) {
+      for (unsigned i = 1; i < num_jobs; i++) {
+         util_queue_fence_init(&jobs[i].fence);
+         util_queue_add_job(&device->shader_compiler_queue, &jobs[i], &jobs[i].fence,
+                            radv_shader_compile_job_execute, NULL, 0);
+      }
+   }
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      if (threaded && i > 0) {
+         util_queue_fence_wait(&jobs[i].fence);
+         util_queue_fence_destroy(&jobs[i].fence);
+      } else {
+         radv_shader_compile_job_execute(&jobs[i], NULL, 0);
+      }
+
+      pipeline->shaders[jobs[i].stage] = jobs[i].shader;
+      binaries[jobs[i].stage] = jobs[i].binary;
+   }
 }
 
 VkResult
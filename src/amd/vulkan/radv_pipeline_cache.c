@@ -313,26 +313,39 @@ radv_create_shaders_from_pipeline_cache(
          return false;
       }
 
+      /* Reading from the disk cache can take a while, so don't block the
+       * other threads using this cache meanwhile.
+       */
+      radv_pipeline_cache_unlock(cache);
+
       uint8_t disk_sha1[20];
       disk_cache_compute_key(device->physical_device->disk_cache, sha1, 20, disk_sha1);
 
-      entry =
+      struct cache_entry *disk_entry =
          (struct cache_entry *)disk_cache_get(device->physical_device->disk_cache, disk_sha1, NULL);
-      if (!entry) {
-         radv_pipeline_cache_unlock(cache);
+      if (!disk_entry)
          return false;
-      } else {
-         size_t size = entry_size(entry);
-         struct cache_entry *new_entry =
-            vk_alloc(&cache->alloc, size, 8, VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
-         if (!new_entry) {
-            free(entry);
-            radv_pipeline_cache_unlock(cache);
-            return false;
-         }
 
-         memcpy(new_entry, entry, entry_size(entry));
-         free(entry);
+      size_t size = entry_size(disk_entry);
+      struct cache_entry *new_entry =
+         vk_alloc(&cache->alloc, size, 8, VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+      if (!new_entry) {
+         free(disk_entry);
+         return false;
+      }
+
+      memcpy(new_entry, disk_entry, size);
+      free(disk_entry);
+
+      radv_pipeline_cache_lock(cache);
+
+      /* Another thread may have added the same entry while the lock was
+       * dropped, in which case use that one so its shaders are shared.
+       */
+      entry = radv_pipeline_cache_search_unlocked(cache, sha1);
+      if (entry) {
+         vk_free(&cache->alloc, new_entry);
+      } else {
          entry = new_entry;
 
          if (!(device->instance->debug_flags & RADV_DEBUG_NO_MEMORY_CACHE) ||
@@ -52,6 +52,7 @@
 #include "util/cnd_monotonic.h"
 #include "util/list.h"
 #include "util/macros.h"
+#include "util/u_queue.h"
 #include "util/rwlock.h"
 #include "util/xmlconfig.h"
 #include "vk_alloc.h"
@@ -820,6 +821,11 @@ struct radv_device {
    struct list_head shader_block_obj_pool;
    mtx_t shader_arena_mutex;
 
+   /* Compiles the shader stages of a pipeline in parallel. Not initialized
+    * on single-CPU systems.
+    */
+   struct util_queue shader_compiler_queue;
+
    /* For detecting VM faults reported by dmesg. */
    uint64_t dmesg_timestamp;
 
@@ -2752,6 +2758,7 @@ bool radv_get_thread_trace(struct radv_queue *queue, struct ac_thread_trace *thr
 void radv_emit_thread_trace_userdata(const struct radv_device *device, struct radeon_cmdbuf *cs,
                                      const void *data, uint32_t num_dwords);
 bool radv_is_instruction_timing_enabled(void);
+bool radv_thread_trace_signal_triggered(void);
 
 bool radv_sdma_copy_image(struct radv_cmd_buffer *cmd_buffer, struct radv_image *image,
                           struct radv_buffer *buffer, const VkBufferImageCopy2 *region);
@@ -22,6 +22,9 @@
  */
 
 #include <inttypes.h>
+#ifndef _WIN32
+#include <signal.h>
+#endif
 
 #include "radv_cs.h"
 #include "radv_private.h"
@@ -35,6 +38,50 @@ radv_is_instruction_timing_enabled(void)
    return debug_get_bool_option("RADV_THREAD_TRACE_INSTRUCTION_TIMING", true);
 }
 
+#ifndef _WIN32
+static volatile sig_atomic_t radv_thread_trace_signal_pending;
+
+static void
+radv_thread_trace_signal_handler(int signum)
+{
+   radv_thread_trace_signal_pending = 1;
+}
+#endif
+
+/* Returns whether the RADV_THREAD_TRACE_TRIGGER_SIGNAL signal was received
+ * since the last call. */
+bool
+radv_thread_trace_signal_triggered(void)
+{
+#ifndef _WIN32
+   if (!radv_thread_trace_signal_pending)
+      return false;
+
+   radv_thread_trace_signal_pending = 0;
+   return true;
+#else
+   return false;
+#endif
+}
+
+static void
+radv_thread_trace_init_signal(void)
+{
+#ifndef _WIN32
+   int signum = radv_get_int_debug_option("RADV_THREAD_TRACE_TRIGGER_SIGNAL", 0);
+   if (signum <= 0)
+      return;
+
+   struct sigaction sa = {0};
+   sa.sa_handler = radv_thread_trace_signal_handler;
+   sa.sa_flags = SA_RESTART;
+   sigemptyset(&sa.sa_mask);
+
+   if (sigaction(signum, &sa, NULL))
+      fprintf(stderr, "radv: could not install the thread trace signal handler for %d\n", signum);
+#endif
+}
+
 static bool
 radv_se_is_disabled(struct radv_device *device, unsigned se)
 {
@@ -476,6 +523,8 @@ radv_thread_trace_init(struct radv_device *device)
    if (trigger_file)
       device->thread_trace.trigger_file = strdup(trigger_file);
 
+   radv_thread_trace_init_signal();
+
    if (!radv_thread_trace_init_bo(device))
       return false;
 
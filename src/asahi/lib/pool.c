@@ -36,8 +36,12 @@
 static struct agx_bo *
 agx_pool_alloc_backing(struct agx_pool *pool, size_t bo_sz)
 {
-   struct agx_bo *bo = agx_bo_create(pool->dev, bo_sz,
-                            pool->create_flags);
+   struct agx_bo *bo;
+
+   if (bo_sz == POOL_SLAB_SIZE && pool->free_bos.size)
+      bo = util_dynarray_pop(&pool->free_bos, struct agx_bo *);
+   else
+      bo = agx_bo_create(pool->dev, bo_sz, pool->create_flags);
 
    util_dynarray_append(&pool->bos, struct agx_bo *, bo);
    pool->transient_bo = bo;
@@ -54,6 +58,7 @@ agx_pool_init(struct agx_pool *pool, struct agx_device *dev,
    pool->dev = dev;
    pool->create_flags = create_flags;
    util_dynarray_init(&pool->bos, dev->memctx);
+   util_dynarray_init(&pool->free_bos, dev->memctx);
 
    if (prealloc)
       agx_pool_alloc_backing(pool, POOL_SLAB_SIZE);
@@ -66,7 +71,29 @@ agx_pool_cleanup(struct agx_pool *pool)
 	   agx_bo_unreference(*bo);
    }
 
+   util_dynarray_foreach(&pool->free_bos, struct agx_bo *, bo) {
+      agx_bo_unreference(*bo);
+   }
+
    util_dynarray_fini(&pool->bos);
+   util_dynarray_fini(&pool->free_bos);
+}
+
+void
+agx_pool_reset(struct agx_pool *pool)
+{
+   util_dynarray_foreach(&pool->bos, struct agx_bo *, bo) {
+      if ((*bo)->size == POOL_SLAB_SIZE)
+         util_dynarray_append(&pool->free_bos, struct agx_bo *, *bo);
+      else
+         agx_bo_unreference(*bo);
+   }
+
+   util_dynarray_clear(&pool->bos);
+   pool->transient_bo = NULL;
+   pool->transient_offset = 0;
+
+   agx_pool_alloc_backing(pool, POOL_SLAB_SIZE);
 }
 
 void
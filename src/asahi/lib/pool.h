@@ -43,6 +43,9 @@ struct agx_pool {
    /* BOs allocated by this pool */
    struct util_dynarray bos;
 
+   /* Slab-sized BOs released by agx_pool_reset, reused before allocating */
+   struct util_dynarray free_bos;
+
    /* Current transient BO */
    struct agx_bo *transient_bo;
 
@@ -60,6 +63,11 @@ agx_pool_init(struct agx_pool *pool, struct agx_device *dev,
 void
 agx_pool_cleanup(struct agx_pool *pool);
 
+/* Frees every allocation at once. The caller must ensure the GPU is done with
+ * the pool's memory; its slabs are recycled for the next allocations */
+void
+agx_pool_reset(struct agx_pool *pool);
+
 static inline unsigned
 agx_pool_num_bos(struct agx_pool *pool)
 {
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2022 Alyssa Rosenzweig
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+
+#include "util/macros.h"
+#include "util/os_time.h"
+
+#include "tiling.h"
+
+#include <gtest/gtest.h>
+
+/* Run with --gtest_also_run_disabled_tests to get the throughput numbers. */
+
+static unsigned
+interleave(unsigned x)
+{
+   unsigned out = 0;
+
+   for (unsigned i = 0; i < 6; ++i)
+      out |= ((x >> i) & 1) << (2 * i);
+
+   return out;
+}
+
+/* Index of pixel (x, y) of a tiled image, straight from the definition of the
+ * layout: row-major tiles, Z-order with X in the low bit inside a tile */
+static unsigned
+reference_index(unsigned width, unsigned tile_shift, unsigned x, unsigned y)
+{
+   unsigned tile_size = 1 << tile_shift;
+   unsigned tiles_per_row = DIV_ROUND_UP(width, tile_size);
+   unsigned tile = (y >> tile_shift) * tiles_per_row + (x >> tile_shift);
+
+   return (tile << (2 * tile_shift)) +
+          interleave(x & (tile_size - 1)) +
+          (interleave(y & (tile_size - 1)) << 1);
+}
+
+static uint32_t
+pattern(unsigned x, unsigned y)
+{
+   return (x * 0x9E3779B1u) ^ (y * 0x85EBCA77u) ^ 0xdeadbeef;
+}
+
+class Tiling : public testing::TestWithParam<unsigned> {
+protected:
+   void
+   check(unsigned width, unsigned height, unsigned sx, unsigned sy,
+         unsigned smaxx, unsigned smaxy)
+   {
+      SCOPED_TRACE(testing::Message() << width << "x" << height << " tile "
+                   << (1 << tile_shift) << " [" << sx << ", " << smaxx << ") x ["
+                   << sy << ", " << smaxy << ")");
+
+      unsigned tile_size = 1 << tile_shift;
+      unsigned tiled_size = DIV_ROUND_UP(width, tile_size) *
+                            DIV_ROUND_UP(height, tile_size) *
+                            tile_size * tile_size;
+
+      /* Linear side starts at (sx, sy), with some padding per row */
+      unsigned linear_pitch = smaxx - sx + 3;
+      std::vector<uint32_t> linear(linear_pitch * (smaxy - sy), 0);
+      std::vector<uint32_t> tiled(tiled_size, 0);
+
+      for (unsigned y = sy; y < smaxy; ++y) {
+         for (unsigned x = sx; x < smaxx; ++x)
+            linear[(y - sy) * linear_pitch + (x - sx)] = pattern(x, y);
+      }
+
+      agx_tile(tiled.data(), linear.data(), width, 32, linear_pitch,
+               sx, sy, smaxx, smaxy, tile_shift);
+
+      unsigned written = 0;
+      for (unsigned i = 0; i < tiled_size; ++i)
+         written += tiled[i] != 0;
+
+      for (unsigned y = sy; y < smaxy; ++y) {
+         for (unsigned x = sx; x < smaxx; ++x) {
+            ASSERT_EQ(tiled[reference_index(width, tile_shift, x, y)],
+                      pattern(x, y)) << "at (" << x << ", " << y << ")";
+         }
+      }
+
+      /* Nothing outside of the rectangle may be written */
+      ASSERT_EQ(written, (smaxx - sx) * (smaxy - sy));
+
+      std::fill(linear.begin(), linear.end(), 0);
+      agx_detile(tiled.data(), linear.data(), width, 32, linear_pitch,
+                 sx, sy, smaxx, smaxy, tile_shift);
+
+      for (unsigned y = sy; y < smaxy; ++y) {
+         for (unsigned x = sx; x < smaxx; ++x) {
+            ASSERT_EQ(linear[(y - sy) * linear_pitch + (x - sx)],
+                      pattern(x, y)) << "at (" << x << ", " << y << ")";
+         }
+
+         for (unsigned x = smaxx; x < sx + linear_pitch; ++x)
+            ASSERT_EQ(linear[(y - sy) * linear_pitch + (x - sx)], 0);
+      }
+   }
+
+   void
+   SetUp() override
+   {
+      tile_shift = GetParam();
+   }
+
+   unsigned tile_shift;
+};
+
+TEST_P(Tiling, FullImage)
+{
+   check(128, 96, 0, 0, 128, 96);
+   check(100, 37, 0, 0, 100, 37);
+}
+
+TEST_P(Tiling, SubRectangles)
+{
+   const unsigned rects[][4] = {
+      { 0, 0, 1, 1 },
+      { 1, 2, 3, 4 },
+      { 5, 7, 70, 9 },
+      { 15, 1, 17, 90 },
+      { 31, 31, 97, 65 },
+      { 63, 0, 65, 96 },
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(rects); ++i)
+      check(128, 96, rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+}
+
+TEST_P(Tiling, DISABLED_Throughput)
+{
+   const unsigned width = 1024, height = 1024, iterations = 50;
+   std::vector<uint32_t> linear(width * height, 1);
+   std::vector<uint32_t> tiled(width * height, 0);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; ++i) {
+      agx_tile(tiled.data(), linear.data(), width, 32, width,
+               0, 0, width, height, tile_shift);
+   }
+   int64_t tile = os_time_get_nano() - start;
+
+   start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; ++i) {
+      agx_detile(tiled.data(), linear.data(), width, 32, width,
+                 0, 0, width, height, tile_shift);
+   }
+   int64_t detile = os_time_get_nano() - start;
+
+   double bytes = (double)width * height * 4 * iterations;
+   printf("tile %2u: tile %8.1f MB/s, detile %8.1f MB/s\n", 1 << tile_shift,
+          bytes / tile * 1000.0, bytes / detile * 1000.0);
+}
+
+INSTANTIATE_TEST_CASE_P(AllTileSizes, Tiling,
+                        testing::Values(0, 1, 2, 3, 4, 5, 6));
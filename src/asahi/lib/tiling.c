@@ -102,19 +102,24 @@ agx_space_bits(unsigned x)
 		unsigned tile_row = tile_y * tiles_per_row;\
 		unsigned x_offs = x_offs_start;\
 \
-		pixel_t *linear_row = linear;\
+		pixel_t *plinear = linear;\
+		unsigned x = sx;\
 		\
-		for (unsigned x = sx; x < smaxx; ++x) {\
-			unsigned tile_x = (x >> tile_shift);\
-			unsigned tile_idx = (tile_row + tile_x);\
-			unsigned tile_base = tile_idx * pixels_per_tile;\
+		while (x < smaxx) {\
+			/* Every pixel until the end of the tile shares its base, and\
+			 * x_offs wraps back to zero when crossing into the next one */\
+			unsigned tile_end = MIN2((x | (tile_size - 1)) + 1, smaxx);\
+			unsigned tile_idx = (tile_row + (x >> tile_shift));\
+			pixel_t *ptile = &tiled[tile_idx * pixels_per_tile + y_offs];\
 \
-			pixel_t *ptiled = &tiled[tile_base + y_offs + x_offs];\
-			pixel_t *plinear = (linear_row++);\
-			pixel_t *outp = (pixel_t *) (is_store ? ptiled : plinear); \
-			pixel_t *inp = (pixel_t *) (is_store ? plinear : ptiled); \
-			*outp = *inp;\
-			x_offs = (x_offs - space_mask) & space_mask;\
+			for (; x < tile_end; ++x) {\
+				pixel_t *ptiled = &ptile[x_offs];\
+				pixel_t *outp = (pixel_t *) (is_store ? ptiled : plinear); \
+				pixel_t *inp = (pixel_t *) (is_store ? plinear : ptiled); \
+				*outp = *inp;\
+				plinear++;\
+				x_offs = (x_offs - space_mask) & space_mask;\
+			}\
 		}\
 \
 		y_offs = (((y_offs >> 1) - space_mask) & space_mask) << 1;\
@@ -26,6 +26,10 @@
 
 #include "util/u_math.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void agx_detile(void *tiled, void *linear,
                 unsigned width, unsigned bpp, unsigned linear_pitch,
                 unsigned sx, unsigned sy, unsigned smaxx, unsigned smaxy, unsigned tile_shift);
@@ -58,4 +62,8 @@ agx_select_tile_size(unsigned width, unsigned height, unsigned level, unsigned b
    return 1 << agx_select_tile_shift(width, height, level, blocksize);
 }
 
+#ifdef __cplusplus
+} /* extern C */
+#endif
+
 #endif
@@ -2186,6 +2186,16 @@ schedule_instructions(struct v3d_compile *c,
                  * find an instruction to pair with it.
                  */
                 if (chosen) {
+                        /* If nothing else was left to hide the latency of
+                         * the TMU lookup, the QPU is going to stall
+                         * waiting for the result.
+                         */
+                        if (v3d_qpu_waits_on_tmu(inst) &&
+                            chosen->unblocked_time > time) {
+                                c->qpu_tmu_stall_cycles +=
+                                        chosen->unblocked_time - time;
+                        }
+
                         time = MAX2(chosen->unblocked_time, time);
                         pre_remove_head(scoreboard->dag, chosen);
 
@@ -2466,6 +2476,7 @@ v3d_qpu_schedule_instructions(struct v3d_compile *c)
         }
 
         uint32_t cycles = 0;
+        c->qpu_tmu_stall_cycles = 0;
         vir_for_each_block(block, c) {
                 block->start_qpu_ip = c->qpu_inst_count;
                 block->branch_qpu_ip = ~0;
@@ -2490,5 +2501,7 @@ v3d_qpu_schedule_instructions(struct v3d_compile *c)
 
         assert(next_uniform == c->num_uniforms);
 
+        c->qpu_sched_cycles = cycles;
+
         return cycles;
 }
@@ -878,6 +878,13 @@ struct v3d_compile {
         uint32_t qpu_inst_stalled_count;
         uint32_t nop_count;
 
+        /* Scheduler estimates of the cycles the program takes, not
+         * counting loops, and of the cycles of it spent waiting on TMU
+         * results that there were no other instructions to cover for.
+         */
+        uint32_t qpu_sched_cycles;
+        uint32_t qpu_tmu_stall_cycles;
+
         /* For the FS, the number of varying inputs not counting the
          * point/line varyings payload
          */
@@ -1659,7 +1659,8 @@ int v3d_shaderdb_dump(struct v3d_compile *c,
         return asprintf(shaderdb_str,
                         "%s shader: %d inst, %d threads, %d loops, "
                         "%d uniforms, %d max-temps, %d:%d spills:fills, "
-                        "%d sfu-stalls, %d inst-and-stalls, %d nops",
+                        "%d sfu-stalls, %d inst-and-stalls, %d nops, "
+                        "%d sched-cycles, %d tmu-stall-cycles",
                         vir_get_stage_name(c),
                         c->qpu_inst_count,
                         c->threads,
@@ -1670,7 +1671,9 @@ int v3d_shaderdb_dump(struct v3d_compile *c,
                         c->fills,
                         c->qpu_inst_stalled_count,
                         c->qpu_inst_count + c->qpu_inst_stalled_count,
-                        c->nop_count);
+                        c->nop_count,
+                        c->qpu_sched_cycles,
+                        c->qpu_tmu_stall_cycles);
 }
 
 /* This is a list of incremental changes to the compilation strategy
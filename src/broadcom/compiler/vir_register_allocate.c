@@ -1059,6 +1059,46 @@ update_graph_and_reg_classes_for_inst(struct v3d_compile *c, int *acc_nodes,
  *
  * The return value should be freed by the caller.
  */
+/**
+ * Returns whether allocating at the current thread count is bound to fail
+ * without TMU spilling.
+ *
+ * Temps that can only be spilled to the TMU all need a register of their own
+ * while they are live, so if more of them are live at any point of the
+ * program than there are registers, there is no point in building the
+ * interference graph and running the allocator.
+ */
+static bool
+pressure_requires_tmu_spills(struct v3d_compile *c)
+{
+        int max_ip = 0;
+        vir_for_each_inst_inorder(inst, c)
+                max_ip++;
+
+        int32_t *delta = rzalloc_array(NULL, int32_t, max_ip + 1);
+        for (uint32_t t = 0; t < c->num_temps; t++) {
+                if (c->temp_start[t] >= c->temp_end[t] ||
+                    get_spill_type_for_temp(c, t) != SPILL_TYPE_TMU) {
+                        continue;
+                }
+
+                delta[MIN2(c->temp_start[t], max_ip)]++;
+                delta[MIN2(c->temp_end[t], max_ip)]--;
+        }
+
+        const int32_t num_regs = (PHYS_COUNT >> c->thread_index) + ACC_COUNT;
+        int32_t pressure = 0;
+        bool too_high = false;
+        for (int ip = 0; ip < max_ip && !too_high; ip++) {
+                pressure += delta[ip];
+                too_high = pressure > num_regs;
+        }
+
+        ralloc_free(delta);
+
+        return too_high;
+}
+
 struct qpu_reg *
 v3d_register_allocate(struct v3d_compile *c)
 {
@@ -1091,6 +1131,16 @@ v3d_register_allocate(struct v3d_compile *c)
                         c->thread_index--;
         }
 
+        /* Skip straight to the next thread count or compile strategy if we
+         * can tell we would fail anyway.
+         */
+        if (!tmu_spilling_allowed(c) && pressure_requires_tmu_spills(c)) {
+                ralloc_free(c->nodes.info);
+                c->nodes.info = NULL;
+                c->nodes.alloc_count = 0;
+                return NULL;
+        }
+
         c->g = ra_alloc_interference_graph(c->compiler->regs,
                                            c->num_temps + ARRAY_SIZE(acc_nodes));
         ra_set_select_reg_callback(c->g, v3d_ra_select_callback, &callback_data);
@@ -82,6 +82,7 @@ v3dv_shader_module_internal_init(struct v3dv_device *device,
    vk_object_base_init(&device->vk, &module->base,
                        VK_OBJECT_TYPE_SHADER_MODULE);
    module->nir = nir;
+   module->nir_cache_enabled = false;
    module->size = 0;
 
    pipeline_compute_sha1_from_nir(nir, module->sha1);
@@ -1755,36 +1756,7 @@ link_shaders(nir_shader *producer, nir_shader *consumer)
    assert(producer);
    assert(consumer);
 
-   if (producer->options->lower_to_scalar) {
-      NIR_PASS_V(producer, nir_lower_io_to_scalar_early, nir_var_shader_out);
-      NIR_PASS_V(consumer, nir_lower_io_to_scalar_early, nir_var_shader_in);
-   }
-
-   nir_lower_io_arrays_to_elements(producer, consumer);
-
-   st_nir_opts(producer);
-   st_nir_opts(consumer);
-
-   if (nir_link_opt_varyings(producer, consumer))
-      st_nir_opts(consumer);
-
-   NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out, NULL);
-   NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in, NULL);
-
-   if (nir_remove_unused_varyings(producer, consumer)) {
-      NIR_PASS_V(producer, nir_lower_global_vars_to_local);
-      NIR_PASS_V(consumer, nir_lower_global_vars_to_local);
-
-      st_nir_opts(producer);
-      st_nir_opts(consumer);
-
-      /* Optimizations can cause varyings to become unused.
-       * nir_compact_varyings() depends on all dead varyings being removed so
-       * we need to call nir_remove_dead_variables() again here.
-       */
-      NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out, NULL);
-      NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in, NULL);
-   }
+   nir_link_shader_varyings(producer, consumer, st_nir_opts);
 }
 
 static void
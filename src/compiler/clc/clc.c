@@ -28,18 +28,22 @@
 #include "clc.h"
 #include "clc_helpers.h"
 #include "spirv/nir_spirv.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_debug.h"
+#include "util/u_queue.h"
 
 #include <stdlib.h>
 
 enum clc_debug_flags {
    CLC_DEBUG_DUMP_SPIRV = 1 << 0,
    CLC_DEBUG_VERBOSE = 1 << 1,
+   CLC_DEBUG_SERIAL_OPT = 1 << 2,
 };
 
 static const struct debug_named_value clc_debug_options[] = {
    { "dump_spirv",  CLC_DEBUG_DUMP_SPIRV, "Dump spirv blobs" },
    { "verbose",  CLC_DEBUG_VERBOSE, NULL },
+   { "serial_opt",  CLC_DEBUG_SERIAL_OPT, "Optimize libclc on a single thread" },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -112,6 +116,145 @@ clc_libclc_optimize(nir_shader *s)
    } while (progress);
 }
 
+/* Below this many instructions libclc isn't worth distributing. */
+#define CLC_PARALLEL_OPT_MIN_INSTRS 10000
+
+struct clc_optimize_job {
+   nir_shader *shader;
+   unsigned num_instrs;
+   struct util_queue_fence fence;
+};
+
+static void
+clc_optimize_job_execute(void *data, void *gdata, int thread_index)
+{
+   struct clc_optimize_job *job = data;
+   clc_libclc_optimize(job->shader);
+}
+
+static unsigned
+count_impl_instrs(nir_function_impl *impl)
+{
+   unsigned count = 0;
+   nir_foreach_block(block, impl)
+      count += exec_list_length(&block->instr_list);
+   return count;
+}
+
+/* Maps the functions and variables of a clone made by
+ * nir_shader_clone_functions() back to the shader it was cloned from.
+ */
+static struct hash_table *
+build_clone_remap_table(nir_shader *s, nir_shader *clone)
+{
+   struct hash_table *remap_table = _mesa_pointer_hash_table_create(NULL);
+
+   foreach_two_lists(clone_node, &clone->functions, orig_node, &s->functions) {
+      _mesa_hash_table_insert(remap_table,
+                              exec_node_data(nir_function, clone_node, node),
+                              exec_node_data(nir_function, orig_node, node));
+   }
+
+   foreach_two_lists(clone_node, &clone->variables, orig_node, &s->variables) {
+      _mesa_hash_table_insert(remap_table,
+                              exec_node_data(nir_variable, clone_node, node),
+                              exec_node_data(nir_variable, orig_node, node));
+   }
+
+   return remap_table;
+}
+
+/* libclc consists of thousands of independent functions which none of the
+ * optimizations below look across, so they're split into groups of about
+ * the same size, each optimized in its own shader on a worker thread, and
+ * copied back.
+ */
+static void
+clc_libclc_optimize_parallel(nir_shader *s)
+{
+   unsigned num_threads = util_get_cpu_caps()->nr_cpus;
+   unsigned num_instrs = 0, num_impls = 0;
+
+   nir_foreach_function(func, s) {
+      if (func->impl) {
+         num_instrs += count_impl_instrs(func->impl);
+         num_impls++;
+      }
+   }
+
+   num_threads = MIN3(num_threads, num_impls, 16);
+   if ((debug_get_option_debug_clc() & CLC_DEBUG_SERIAL_OPT) ||
+       num_threads <= 1 || num_instrs < CLC_PARALLEL_OPT_MIN_INSTRS) {
+      clc_libclc_optimize(s);
+      return;
+   }
+
+   struct util_queue queue;
+   if (!util_queue_init(&queue, "clc_opt", num_threads, num_threads, 0, NULL)) {
+      clc_libclc_optimize(s);
+      return;
+   }
+
+   struct clc_optimize_job *jobs = calloc(num_threads, sizeof(*jobs));
+   struct set **groups = calloc(num_threads, sizeof(*groups));
+   for (unsigned i = 0; i < num_threads; i++)
+      groups[i] = _mesa_pointer_set_create(NULL);
+
+   /* Hand each function to the least loaded group. */
+   nir_foreach_function(func, s) {
+      if (!func->impl)
+         continue;
+
+      unsigned min = 0;
+      for (unsigned i = 1; i < num_threads; i++) {
+         if (jobs[i].num_instrs < jobs[min].num_instrs)
+            min = i;
+      }
+
+      _mesa_set_add(groups[min], func);
+      jobs[min].num_instrs += count_impl_instrs(func->impl);
+   }
+
+   for (unsigned i = 0; i < num_threads; i++) {
+      jobs[i].shader = nir_shader_clone_functions(NULL, s, groups[i]);
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&queue, &jobs[i], &jobs[i].fence,
+                         clc_optimize_job_execute, NULL, 0);
+   }
+
+   for (unsigned i = 0; i < num_threads; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+
+      struct hash_table *remap_table =
+         build_clone_remap_table(s, jobs[i].shader);
+
+      nir_foreach_function(func, jobs[i].shader) {
+         if (!func->impl)
+            continue;
+
+         struct hash_entry *entry =
+            _mesa_hash_table_search(remap_table, func);
+         nir_function *orig = entry->data;
+
+         orig->impl = nir_function_impl_clone_remap_globals(s, func->impl,
+                                                            remap_table);
+         orig->impl->function = orig;
+      }
+
+      _mesa_hash_table_destroy(remap_table, NULL);
+      _mesa_set_destroy(groups[i], NULL);
+      ralloc_free(jobs[i].shader);
+   }
+
+   util_queue_destroy(&queue);
+   free(groups);
+   free(jobs);
+
+   /* Free the unoptimized impls. */
+   nir_sweep(s);
+}
+
 struct clc_libclc {
    const nir_shader *libclc_nir;
 };
@@ -152,7 +295,7 @@ clc_libclc_new(const struct clc_logger *logger, const struct clc_libclc_options
    }
 
    if (options && options->optimize)
-      clc_libclc_optimize(s);
+      clc_libclc_optimize_parallel(s);
 
    ralloc_steal(ctx, s);
    ctx->libclc_nir = s;
@@ -84,6 +84,7 @@
 #include <math.h>
 #include "builtin_functions.h"
 #include "util/hash_table.h"
+#include "util/set.h"
 
 #ifndef M_PIf
 #define M_PIf   ((float) M_PI)
@@ -1005,18 +1006,39 @@ public:
    /**
     * A shader to hold all the built-in signatures; created by this module.
     *
-    * This includes signatures for every built-in, regardless of version or
-    * enabled extensions.  The availability predicate associated with each
-    * signature allows matching_signature() to filter out the irrelevant ones.
+    * This includes signatures for every built-in that has been looked up so
+    * far, regardless of version or enabled extensions, along with all of the
+    * intrinsics.  The availability predicate associated with each signature
+    * allows matching_signature() to filter out the irrelevant ones.
     */
    gl_shader *shader;
 
+   ir_function *get_function(const char *name);
+
 private:
    void *mem_ctx;
 
+   /**
+    * Names which create_builtin() has already been run for, whether or not
+    * a built-in with that name exists.
+    */
+   struct set *created_names;
+
+   /**
+    * When not NULL, create_builtins() only creates the functions with this
+    * name.
+    */
+   const char *filter_name;
+
+   bool wants_function(const char *name) const
+   {
+      return filter_name == NULL || strcmp(name, filter_name) == 0;
+   }
+
    void create_shader();
    void create_intrinsics();
    void create_builtins();
+   void create_builtin(const char *name);
 
    /**
     * IR builder helpers:
@@ -1398,6 +1420,8 @@ builtin_builder::builtin_builder()
    : shader(NULL)
 {
    mem_ctx = NULL;
+   created_names = NULL;
+   filter_name = NULL;
 }
 
 builtin_builder::~builtin_builder()
@@ -1426,7 +1450,7 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
     */
    state->uses_builtin_functions = true;
 
-   ir_function *f = shader->symbols->get_function(name);
+   ir_function *f = get_function(name);
    if (f == NULL)
       return NULL;
 
@@ -1448,9 +1472,35 @@ builtin_builder::initialize()
    glsl_type_singleton_init_or_ref();
 
    mem_ctx = ralloc_context(NULL);
+   created_names = _mesa_set_create(mem_ctx, _mesa_hash_string,
+                                    _mesa_key_string_equal);
    create_shader();
+
+   /* The built-ins call the intrinsics, so those are always created.  The
+    * built-ins themselves are only created once a shader looks them up, as
+    * most shaders use a small fraction of them.
+    */
    create_intrinsics();
-   create_builtins();
+}
+
+/**
+ * Look up a built-in function or intrinsic by name, creating the built-in's
+ * signatures on the first lookup.
+ */
+ir_function *
+builtin_builder::get_function(const char *name)
+{
+   ir_function *f = shader->symbols->get_function(name);
+   if (f != NULL)
+      return f;
+
+   if (_mesa_set_search(created_names, name))
+      return NULL;
+
+   _mesa_set_add(created_names, ralloc_strdup(mem_ctx, name));
+   create_builtin(name);
+
+   return shader->symbols->get_function(name);
 }
 
 void
@@ -1458,6 +1508,7 @@ builtin_builder::release()
 {
    ralloc_free(mem_ctx);
    mem_ctx = NULL;
+   created_names = NULL;
 
    ralloc_free(shader);
    shader = NULL;
@@ -1733,6 +1784,27 @@ builtin_builder::create_intrinsics()
  *
  * Contains a list of every available built-in.
  */
+/**
+ * Create the signatures of the built-in function called \c name, if there is
+ * one.
+ */
+void
+builtin_builder::create_builtin(const char *name)
+{
+   filter_name = name;
+   create_builtins();
+   filter_name = NULL;
+}
+
+/* Evaluating the signature list is what builds the IR, so skip it entirely
+ * for the functions create_builtin() wasn't asked for.
+ */
+#define add_function(name, ...)                       \
+   do {                                               \
+      if (wants_function(name))                       \
+         add_function(name, __VA_ARGS__);             \
+   } while (0)
+
 void
 builtin_builder::create_builtins()
 {
@@ -5447,6 +5519,8 @@ builtin_builder::create_builtins()
 #undef FIU2_MIXED
 }
 
+#undef add_function
+
 void
 builtin_builder::add_function(const char *name, ...)
 {
@@ -5517,6 +5591,9 @@ builtin_builder::add_image_function(const char *name,
       glsl_type::uimage2DMSArray_type
    };
 
+   if (!wants_function(name))
+      return;
+
    ir_function *f = new(mem_ctx) ir_function(name);
 
    for (unsigned i = 0; i < ARRAY_SIZE(types); ++i) {
@@ -8718,7 +8795,7 @@ _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
    ir_function *f;
    bool ret = false;
    mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
+   f = builtins.get_function(name);
    if (f != NULL) {
       foreach_in_list(ir_function_signature, sig, &f->signatures) {
          if (sig->is_builtin_available(state)) {
@@ -98,6 +98,52 @@ skip_newline (const char *str)
 	return ret;
 }
 
+/* Whether preprocessing could change the meaning of the shader.
+ *
+ * Without directives, comments, line continuations or identifiers which
+ * may name a predefined macro (all of those start with "GL_" or "__"),
+ * the preprocessor only normalizes whitespace, which the GLSL lexer doesn't
+ * care about.  Lone carriage returns and vertical tabs or form feeds are
+ * whitespace to the preprocessor but not to the GLSL lexer, so they need
+ * preprocessing too.
+ */
+bool
+glcpp_shader_needs_preprocessing(const char *shader)
+{
+	const char *p = shader;
+
+	while (*p) {
+		unsigned char c = *p;
+
+		if (c == '#' || c == '/' || c == '\\' || c == '\v' || c == '\f')
+			return true;
+
+		if (c == '\r' && p[1] != '\n')
+			return true;
+
+		if (isalpha(c) || c == '_') {
+			if ((p[0] == '_' && p[1] == '_') ||
+			    (p[0] == 'G' && p[1] == 'L' && p[2] == '_'))
+				return true;
+
+			while (isalnum((unsigned char)*p) || *p == '_')
+				p++;
+			continue;
+		}
+
+		if (isdigit(c)) {
+			/* Skip the suffixes and exponents of numbers. */
+			while (isalnum((unsigned char)*p) || *p == '_' || *p == '.')
+				p++;
+			continue;
+		}
+
+		p++;
+	}
+
+	return false;
+}
+
 /* Initial output buffer size, 4096 minus ralloc() overhead. It was selected
  * to minimize total amount of allocated memory during shader-db run.
  */
@@ -2242,7 +2242,11 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       (void) p_atomic_cmpxchg(&ir_variable::temporaries_allocate_names,
                               false, true);
 
-   if (!source_has_shader_include || !force_recompile) {
+   /* Shaders without anything for the preprocessor to do, as is common for
+    * generated ones, are handed to the GLSL lexer directly.
+    */
+   if ((!source_has_shader_include || !force_recompile) &&
+       glcpp_shader_needs_preprocessing(source)) {
       state->error = glcpp_preprocess(state, &source, &state->info_log,
                                       add_builtin_defines, state, ctx);
    }
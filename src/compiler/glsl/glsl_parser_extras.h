@@ -1053,6 +1053,8 @@ typedef void (*glcpp_extension_iterator)(
               unsigned version,
               bool es);
 
+extern bool glcpp_shader_needs_preprocessing(const char *shader);
+
 extern int glcpp_preprocess(void *ctx, const char **shader, char **info_log,
                             glcpp_extension_iterator extensions,
                             struct _mesa_glsl_parse_state *state,
@@ -3574,6 +3574,24 @@ linker_optimisation_loop(const struct gl_constants *consts, exec_list *ir,
                            consts->NativeIntegers);
 }
 
+static void
+optimize_linked_shader(struct gl_linked_shader *sh, void *data)
+{
+   const struct gl_constants *consts = (const struct gl_constants *)data;
+   const unsigned stage = sh->Stage;
+
+   /* Call opts before lowering const arrays to uniforms so we can const
+    * propagate any elements accessed directly.
+    */
+   linker_optimisation_loop(consts, sh->ir, stage);
+
+   /* Call opts after lowering const arrays to copy propagate things. */
+   if (consts->GLSLLowerConstArrays &&
+       lower_const_arrays_to_uniforms(sh->ir, stage,
+                                      consts->Program[stage].MaxUniformComponents))
+      linker_optimisation_loop(consts, sh->ir, stage);
+}
+
 void
 link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
 {
@@ -3911,19 +3929,14 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
          }
       }
 
-      /* Call opts before lowering const arrays to uniforms so we can const
-       * propagate any elements accessed directly.
-       */
-      linker_optimisation_loop(consts, prog->_LinkedShaders[i]->ir, i);
-
-      /* Call opts after lowering const arrays to copy propagate things. */
-      if (consts->GLSLLowerConstArrays &&
-          lower_const_arrays_to_uniforms(prog->_LinkedShaders[i]->ir, i,
-                                         consts->Program[i].MaxUniformComponents))
-         linker_optimisation_loop(consts, prog->_LinkedShaders[i]->ir, i);
-
    }
 
+   /* The stages don't share any IR at this point, so they can be optimized
+    * in parallel.
+    */
+   link_util_run_stages_parallel(prog, optimize_linked_shader,
+                                 (void *)consts);
+
    /* Check and validate stream emissions in geometry shaders */
    validate_geometry_shader_emissions(consts, prog);
 
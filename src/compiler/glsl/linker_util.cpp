@@ -25,8 +25,11 @@
 
 #include "glsl_types.h"
 #include "linker_util.h"
+#include "c11/threads.h"
 #include "util/bitscan.h"
 #include "util/set.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 #include "ir_uniform.h" /* for gl_uniform_storage */
 #include "main/shader_types.h"
 #include "main/consts_exts.h"
@@ -438,3 +441,84 @@ link_util_mark_array_elements_referenced(const struct array_deref_range *dr,
 
    _mark_array_elements_referenced(dr, count, 1, 0, bits);
 }
+
+static struct util_queue link_queue;
+static bool link_queue_ready;
+static once_flag link_queue_once = ONCE_FLAG_INIT;
+
+static void
+init_link_queue(void)
+{
+   /* The calling thread runs one of the stages itself. */
+   unsigned num_threads = MIN2(util_get_cpu_caps()->nr_cpus,
+                               MESA_SHADER_STAGES) - 1;
+   if (num_threads == 0)
+      return;
+
+   link_queue_ready = util_queue_init(&link_queue, "glsl_link",
+                                      MESA_SHADER_STAGES, num_threads,
+                                      UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                                      UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY,
+                                      NULL);
+}
+
+struct link_stage_job {
+   struct util_queue_fence fence;
+   link_util_stage_func func;
+   struct gl_linked_shader *sh;
+   void *data;
+};
+
+static void
+execute_link_stage_job(void *data, void *gdata, int thread_index)
+{
+   struct link_stage_job *job = (struct link_stage_job *)data;
+   job->func(job->sh, job->data);
+}
+
+/**
+ * Call \c func for each linked shader of the program, running the stages in
+ * parallel on worker threads when there is more than one of them.
+ *
+ * \c func must only touch the linked shader it is given and data which is
+ * either read-only or private to that stage; anything that writes to the
+ * program, such as linker_error(), has to stay on the calling thread.
+ */
+void
+link_util_run_stages_parallel(struct gl_shader_program *prog,
+                              link_util_stage_func func, void *data)
+{
+   struct link_stage_job jobs[MESA_SHADER_STAGES];
+   unsigned num_jobs = 0;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (prog->_LinkedShaders[i]) {
+         jobs[num_jobs].func = func;
+         jobs[num_jobs].sh = prog->_LinkedShaders[i];
+         jobs[num_jobs].data = data;
+         num_jobs++;
+      }
+   }
+
+   if (num_jobs > 1)
+      call_once(&link_queue_once, init_link_queue);
+
+   if (num_jobs <= 1 || !link_queue_ready) {
+      for (unsigned i = 0; i < num_jobs; i++)
+         func(jobs[i].sh, data);
+      return;
+   }
+
+   for (unsigned i = 1; i < num_jobs; i++) {
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&link_queue, &jobs[i], &jobs[i].fence,
+                         execute_link_stage_job, NULL, 0);
+   }
+
+   func(jobs[0].sh, data);
+
+   for (unsigned i = 1; i < num_jobs; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
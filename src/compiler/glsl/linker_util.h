@@ -28,6 +28,7 @@
 #include "compiler/glsl/list.h"
 
 struct gl_constants;
+struct gl_linked_shader;
 struct gl_shader_program;
 struct gl_uniform_storage;
 
@@ -110,6 +111,12 @@ link_util_mark_array_elements_referenced(const struct array_deref_range *dr,
                                          unsigned count, unsigned array_depth,
                                          BITSET_WORD *bits);
 
+typedef void (*link_util_stage_func)(struct gl_linked_shader *sh, void *data);
+
+void
+link_util_run_stages_parallel(struct gl_shader_program *prog,
+                              link_util_stage_func func, void *data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include <getopt.h>
+#include <inttypes.h>
 
 /** @file standalone.cpp
  *
@@ -37,6 +38,7 @@
 #include "standalone_scaffolding.h"
 #include "standalone.h"
 #include "string_to_uint_map.h"
+#include "util/os_time.h"
 #include "util/set.h"
 #include "linker.h"
 #include "glsl_parser_extras.h"
@@ -377,6 +379,20 @@ load_text_file(void *ctx, const char *file_name)
    return text;
 }
 
+/**
+ * With --time, prints how long a phase took as "time: <phase> <file> <us>"
+ * on stderr, so that a benchmark script can pick it out of the output.
+ */
+static void
+print_timing(const char *phase, const char *file, int64_t start)
+{
+   if (!options->print_timing)
+      return;
+
+   fprintf(stderr, "time: %s %s %" PRId64 "\n", phase, file,
+           (os_time_get_nano() - start) / 1000);
+}
+
 static void
 compile_shader(struct gl_context *ctx, struct gl_shader *shader)
 {
@@ -495,7 +511,9 @@ standalone_compile_shader(const struct standalone_options *_options,
          exit(EXIT_FAILURE);
       }
 
+      int64_t start = os_time_get_nano();
       compile_shader(ctx, shader);
+      print_timing("compile", files[i], start);
 
       if (strlen(shader->InfoLog) > 0) {
          if (!options->just_log)
@@ -515,6 +533,7 @@ standalone_compile_shader(const struct standalone_options *_options,
    if (status == EXIT_SUCCESS) {
       _mesa_clear_shader_program_data(ctx, whole_program);
 
+      int64_t start = os_time_get_nano();
       if (options->do_link)  {
          link_shaders(ctx, whole_program);
       } else {
@@ -554,6 +573,7 @@ standalone_compile_shader(const struct standalone_options *_options,
             } while(progress);
          }
       }
+      print_timing(options->do_link ? "link" : "optimize", files[0], start);
 
       status = (whole_program->data->LinkStatus) ? EXIT_SUCCESS : EXIT_FAILURE;
 
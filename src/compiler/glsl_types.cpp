@@ -26,6 +26,7 @@
 #include "compiler/glsl/glsl_parser_extras.h"
 #include "glsl_types.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
 #include "util/u_string.h"
 
 
@@ -43,6 +44,26 @@ hash_table *glsl_type::subroutine_types = NULL;
  */
 static uint32_t glsl_type_users = 0;
 
+/* Direct-mapped cache of array types in front of glsl_type::array_types.  It
+ * is read without taking hash_mutex, so the common lookups of arrays of
+ * the same few types don't contend on the lock when compiling on several
+ * threads.  Entries are only written with hash_mutex held, and point to types
+ * which live until the last user is gone, at which point the cache is
+ * cleared along with the table.
+ */
+#define ARRAY_TYPE_CACHE_SIZE 1024
+static const glsl_type *array_type_cache[ARRAY_TYPE_CACHE_SIZE];
+
+static unsigned
+array_type_cache_index(const glsl_type *base, unsigned array_size,
+                       unsigned explicit_stride)
+{
+   uint32_t hash = _mesa_hash_pointer(base);
+   hash ^= array_size * 2654435761u;
+   hash ^= explicit_stride * 40503u;
+   return hash % ARRAY_TYPE_CACHE_SIZE;
+}
+
 glsl_type::glsl_type(GLenum gl_type,
                      glsl_base_type base_type, unsigned vector_elements,
                      unsigned matrix_columns, const char *name,
@@ -543,6 +564,7 @@ glsl_type_singleton_decref()
    }
 
    if (glsl_type::array_types != NULL) {
+      memset(array_type_cache, 0, sizeof(array_type_cache));
       _mesa_hash_table_destroy(glsl_type::array_types, hash_free_type_function);
       glsl_type::array_types = NULL;
    }
@@ -1232,6 +1254,14 @@ glsl_type::get_array_instance(const glsl_type *base,
                               unsigned array_size,
                               unsigned explicit_stride)
 {
+   const unsigned cache_index =
+      array_type_cache_index(base, array_size, explicit_stride);
+   const glsl_type *cached = p_atomic_read(&array_type_cache[cache_index]);
+   if (cached != NULL && cached->fields.array == base &&
+       cached->length == array_size &&
+       cached->explicit_stride == explicit_stride)
+      return cached;
+
    /* Generate a name using the base type pointer in the key.  This is
     * done because the name of the base type may not be unique across
     * shaders.  For example, two shaders may have different record types
@@ -1264,6 +1294,8 @@ glsl_type::get_array_instance(const glsl_type *base,
 
    glsl_type *t = (glsl_type *) entry->data;
 
+   p_atomic_set(&array_type_cache[cache_index], t);
+
    mtx_unlock(&glsl_type::hash_mutex);
 
    return t;
@@ -33,6 +33,7 @@
 #include <limits.h>
 #include <assert.h>
 #include <math.h>
+#include "util/os_memory.h"
 #include "util/u_math.h"
 #include "util/u_qsort.h"
 
@@ -184,6 +185,269 @@ nir_component_mask_reinterpret(nir_component_mask_t mask,
    return new_mask;
 }
 
+/*
+ * Instructions and phi sources are allocated from a pool per shader rather
+ * than with one malloc() each, so that instructions created together end up
+ * next to each other in memory and freeing them is cheap.
+ *
+ * Blocks are carved out of large chunks and recycled through free lists,
+ * one per 16-byte size class.  Each block is preceded by a header word
+ * holding its pool, which is aligned so that the low bits can hold the size
+ * class.  Bigger blocks, and all blocks in sanitizer builds so that use
+ * after free is still caught, are malloc()ed individually.
+ */
+#define INSTR_POOL_CHUNK_SIZE     (64 * 1024)
+#define INSTR_POOL_GRANULE        16
+#define INSTR_POOL_NUM_CLASSES    32
+#define INSTR_POOL_CLASS_MASK     63
+#define INSTR_POOL_LARGE          INSTR_POOL_CLASS_MASK
+
+#if defined(__SANITIZE_ADDRESS__)
+#define INSTR_POOL_USE_MALLOC 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define INSTR_POOL_USE_MALLOC 1
+#endif
+#endif
+
+struct instr_pool_chunk {
+   struct instr_pool_chunk *next;
+
+   /* Bytes of the chunk handed out so far. */
+   size_t used;
+
+   /* Bytes of the chunk on the free lists, only valid during a trim. */
+   size_t free_bytes;
+};
+
+struct nir_instr_pool {
+   /* Chunks, the one being carved up first. */
+   struct instr_pool_chunk *chunks;
+   char *next;
+   char *end;
+
+   void *free_list[INSTR_POOL_NUM_CLASSES];
+};
+
+#define INSTR_POOL_HEADER_SIZE sizeof(uintptr_t)
+#define INSTR_POOL_CHUNK_HEADER_SIZE \
+   ALIGN_POT(sizeof(struct instr_pool_chunk), INSTR_POOL_GRANULE)
+
+static struct nir_instr_pool *
+instr_pool_create(void)
+{
+   STATIC_ASSERT(INSTR_POOL_NUM_CLASSES <= INSTR_POOL_LARGE);
+
+   struct nir_instr_pool *pool =
+      os_malloc_aligned(sizeof(*pool), INSTR_POOL_CLASS_MASK + 1);
+   if (pool)
+      memset(pool, 0, sizeof(*pool));
+
+   return pool;
+}
+
+static void
+instr_pool_destroy(struct nir_instr_pool *pool)
+{
+   if (!pool)
+      return;
+
+   struct instr_pool_chunk *chunk = pool->chunks;
+   while (chunk) {
+      struct instr_pool_chunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+
+   os_free_aligned(pool);
+}
+
+static unsigned
+instr_pool_size_class(size_t size)
+{
+   return DIV_ROUND_UP(size + INSTR_POOL_HEADER_SIZE, INSTR_POOL_GRANULE) - 1;
+}
+
+/* Returns zeroed memory from the pool, like calloc(). */
+static void *
+instr_pool_zalloc(struct nir_instr_pool *pool, size_t size)
+{
+   unsigned size_class = instr_pool_size_class(size);
+   uintptr_t *header;
+
+#ifdef INSTR_POOL_USE_MALLOC
+   size_class = INSTR_POOL_LARGE;
+#endif
+
+   if (size_class >= INSTR_POOL_NUM_CLASSES) {
+      header = calloc(1, INSTR_POOL_HEADER_SIZE + size);
+      if (!header)
+         return NULL;
+
+      *header = (uintptr_t)pool | INSTR_POOL_LARGE;
+      return header + 1;
+   }
+
+   size_t block_size = (size_class + 1) * INSTR_POOL_GRANULE;
+
+   if (pool->free_list[size_class]) {
+      void *block = pool->free_list[size_class];
+      pool->free_list[size_class] = *(void **)block;
+      header = (uintptr_t *)block - 1;
+   } else {
+      if (pool->end - pool->next < (ptrdiff_t)block_size) {
+         struct instr_pool_chunk *chunk = malloc(INSTR_POOL_CHUNK_SIZE);
+         if (!chunk)
+            return NULL;
+
+         if (pool->chunks)
+            pool->chunks->used = pool->next - (char *)pool->chunks;
+         chunk->next = pool->chunks;
+         chunk->used = INSTR_POOL_CHUNK_HEADER_SIZE;
+         pool->chunks = chunk;
+         pool->next = (char *)chunk + INSTR_POOL_CHUNK_HEADER_SIZE;
+         pool->end = (char *)chunk + INSTR_POOL_CHUNK_SIZE;
+      }
+
+      header = (uintptr_t *)pool->next;
+      pool->next += block_size;
+   }
+
+   *header = (uintptr_t)pool | size_class;
+   memset(header + 1, 0, block_size - INSTR_POOL_HEADER_SIZE);
+
+   return header + 1;
+}
+
+/* Allocates from the pool that ptr was allocated from. */
+static void *
+instr_pool_zalloc_like(const void *ptr, size_t size)
+{
+   uintptr_t header = ((const uintptr_t *)ptr)[-1];
+   return instr_pool_zalloc((struct nir_instr_pool *)
+                            (header & ~(uintptr_t)INSTR_POOL_CLASS_MASK), size);
+}
+
+static void
+instr_pool_free(void *ptr)
+{
+   uintptr_t *header = (uintptr_t *)ptr - 1;
+   unsigned size_class = *header & INSTR_POOL_CLASS_MASK;
+
+   if (size_class == INSTR_POOL_LARGE) {
+      free(header);
+      return;
+   }
+
+   struct nir_instr_pool *pool =
+      (struct nir_instr_pool *)(*header & ~(uintptr_t)INSTR_POOL_CLASS_MASK);
+   *(void **)ptr = pool->free_list[size_class];
+   pool->free_list[size_class] = ptr;
+}
+
+static int
+compare_chunk_address(const void *a, const void *b)
+{
+   uintptr_t ca = (uintptr_t)*(struct instr_pool_chunk *const *)a;
+   uintptr_t cb = (uintptr_t)*(struct instr_pool_chunk *const *)b;
+   return ca < cb ? -1 : ca > cb;
+}
+
+static struct instr_pool_chunk *
+find_chunk(struct instr_pool_chunk **chunks, unsigned num_chunks,
+           const void *ptr)
+{
+   unsigned lo = 0, hi = num_chunks;
+
+   while (lo < hi) {
+      unsigned mid = (lo + hi) / 2;
+      if ((const char *)ptr < (const char *)chunks[mid])
+         hi = mid;
+      else if ((const char *)ptr >= (const char *)chunks[mid] + INSTR_POOL_CHUNK_SIZE)
+         lo = mid + 1;
+      else
+         return chunks[mid];
+   }
+
+   unreachable("block not allocated from this pool");
+}
+
+/**
+ * Releases the chunks of the shader's instruction pool which only contain
+ * freed blocks.
+ */
+void
+nir_shader_trim_instr_pool(nir_shader *shader)
+{
+   struct nir_instr_pool *pool = shader->instr_pool;
+   unsigned num_chunks = 0;
+
+   if (!pool || !pool->chunks)
+      return;
+
+   pool->chunks->used = pool->next - (char *)pool->chunks;
+
+   for (struct instr_pool_chunk *chunk = pool->chunks; chunk; chunk = chunk->next)
+      num_chunks++;
+
+   struct instr_pool_chunk **chunks = malloc(num_chunks * sizeof(*chunks));
+   if (!chunks)
+      return;
+
+   unsigned i = 0;
+   for (struct instr_pool_chunk *chunk = pool->chunks; chunk; chunk = chunk->next) {
+      chunk->free_bytes = INSTR_POOL_CHUNK_HEADER_SIZE;
+      chunks[i++] = chunk;
+   }
+   qsort(chunks, num_chunks, sizeof(*chunks), compare_chunk_address);
+
+   for (unsigned c = 0; c < INSTR_POOL_NUM_CLASSES; c++) {
+      for (void *block = pool->free_list[c]; block; block = *(void **)block) {
+         find_chunk(chunks, num_chunks, block)->free_bytes +=
+            (c + 1) * INSTR_POOL_GRANULE;
+      }
+   }
+
+   /* Drop the blocks of the chunks going away from the free lists.  The
+    * current chunk is kept, it'll be carved up further.
+    */
+   for (unsigned c = 0; c < INSTR_POOL_NUM_CLASSES; c++) {
+      void **link = &pool->free_list[c];
+      while (*link) {
+         struct instr_pool_chunk *chunk = find_chunk(chunks, num_chunks, *link);
+         if (chunk != pool->chunks && chunk->free_bytes == chunk->used)
+            *link = **(void ***)link;
+         else
+            link = *link;
+      }
+   }
+
+   struct instr_pool_chunk **link = &pool->chunks->next;
+   while (*link) {
+      struct instr_pool_chunk *chunk = *link;
+      if (chunk->free_bytes == chunk->used) {
+         *link = chunk->next;
+         free(chunk);
+      } else {
+         link = &chunk->next;
+      }
+   }
+
+   free(chunks);
+}
+
+/**
+ * Frees the memory of the shader's instruction pool.  All its instructions
+ * must have been freed already.
+ */
+void
+nir_shader_destroy_instr_pool(nir_shader *shader)
+{
+   assert(list_is_empty(&shader->gc_list));
+   instr_pool_destroy(shader->instr_pool);
+   shader->instr_pool = NULL;
+}
+
 static void
 nir_shader_destructor(void *ptr)
 {
@@ -193,6 +457,8 @@ nir_shader_destructor(void *ptr)
    list_for_each_entry_safe(nir_instr, instr, &shader->gc_list, gc_node) {
       nir_instr_free(instr);
    }
+
+   nir_shader_destroy_instr_pool(shader);
 }
 
 nir_shader *
@@ -207,6 +473,7 @@ nir_shader_create(void *mem_ctx,
 #ifndef NDEBUG
    nir_process_debug_variable();
 #endif
+   nir_pass_stats_init();
 
    exec_list_make_empty(&shader->variables);
 
@@ -222,6 +489,7 @@ nir_shader_create(void *mem_ctx,
    exec_list_make_empty(&shader->functions);
 
    list_inithead(&shader->gc_list);
+   shader->instr_pool = instr_pool_create();
 
    shader->num_inputs = 0;
    shader->num_outputs = 0;
@@ -694,8 +962,8 @@ nir_alu_instr *
 nir_alu_instr_create(nir_shader *shader, nir_op op)
 {
    unsigned num_srcs = nir_op_infos[op].num_inputs;
-   /* TODO: don't use calloc */
-   nir_alu_instr *instr = calloc(1, sizeof(nir_alu_instr) + num_srcs * sizeof(nir_alu_src));
+   nir_alu_instr *instr =
+      instr_pool_zalloc(shader->instr_pool, sizeof(nir_alu_instr) + num_srcs * sizeof(nir_alu_src));
 
    instr_init(&instr->instr, nir_instr_type_alu);
    instr->op = op;
@@ -711,7 +979,7 @@ nir_alu_instr_create(nir_shader *shader, nir_op op)
 nir_deref_instr *
 nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 {
-   nir_deref_instr *instr = calloc(1, sizeof(*instr));
+   nir_deref_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
 
    instr_init(&instr->instr, nir_instr_type_deref);
 
@@ -733,7 +1001,7 @@ nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 nir_jump_instr *
 nir_jump_instr_create(nir_shader *shader, nir_jump_type type)
 {
-   nir_jump_instr *instr = malloc(sizeof(*instr));
+   nir_jump_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
    instr_init(&instr->instr, nir_instr_type_jump);
    src_init(&instr->condition);
    instr->type = type;
@@ -750,7 +1018,8 @@ nir_load_const_instr_create(nir_shader *shader, unsigned num_components,
                             unsigned bit_size)
 {
    nir_load_const_instr *instr =
-      calloc(1, sizeof(*instr) + num_components * sizeof(*instr->value));
+      instr_pool_zalloc(shader->instr_pool,
+                        sizeof(*instr) + num_components * sizeof(*instr->value));
    instr_init(&instr->instr, nir_instr_type_load_const);
 
    nir_ssa_def_init(&instr->instr, &instr->def, num_components, bit_size);
@@ -764,9 +1033,9 @@ nir_intrinsic_instr *
 nir_intrinsic_instr_create(nir_shader *shader, nir_intrinsic_op op)
 {
    unsigned num_srcs = nir_intrinsic_infos[op].num_srcs;
-   /* TODO: don't use calloc */
    nir_intrinsic_instr *instr =
-      calloc(1, sizeof(nir_intrinsic_instr) + num_srcs * sizeof(nir_src));
+      instr_pool_zalloc(shader->instr_pool,
+                        sizeof(nir_intrinsic_instr) + num_srcs * sizeof(nir_src));
 
    instr_init(&instr->instr, nir_instr_type_intrinsic);
    instr->intrinsic = op;
@@ -787,7 +1056,8 @@ nir_call_instr_create(nir_shader *shader, nir_function *callee)
 {
    const unsigned num_params = callee->num_params;
    nir_call_instr *instr =
-      calloc(1, sizeof(*instr) + num_params * sizeof(instr->params[0]));
+      instr_pool_zalloc(shader->instr_pool,
+                        sizeof(*instr) + num_params * sizeof(instr->params[0]));
 
    instr_init(&instr->instr, nir_instr_type_call);
    instr->callee = callee;
@@ -811,7 +1081,7 @@ static int8_t default_tg4_offsets[4][2] =
 nir_tex_instr *
 nir_tex_instr_create(nir_shader *shader, unsigned num_srcs)
 {
-   nir_tex_instr *instr = calloc(1, sizeof(*instr));
+   nir_tex_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
    instr_init(&instr->instr, nir_instr_type_tex);
 
    dest_init(&instr->dest);
@@ -880,7 +1150,7 @@ nir_tex_instr_has_explicit_tg4_offsets(nir_tex_instr *tex)
 nir_phi_instr *
 nir_phi_instr_create(nir_shader *shader)
 {
-   nir_phi_instr *instr = malloc(sizeof(*instr));
+   nir_phi_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
    instr_init(&instr->instr, nir_instr_type_phi);
 
    dest_init(&instr->dest);
@@ -904,7 +1174,7 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_src src)
 {
    nir_phi_src *phi_src;
 
-   phi_src = calloc(1, sizeof(nir_phi_src));
+   phi_src = instr_pool_zalloc_like(instr, sizeof(nir_phi_src));
    phi_src->pred = pred;
    phi_src->src = src;
    phi_src->src.parent_instr = &instr->instr;
@@ -913,10 +1183,16 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_src src)
    return phi_src;
 }
 
+void
+nir_phi_src_free(nir_phi_src *src)
+{
+   instr_pool_free(src);
+}
+
 nir_parallel_copy_instr *
 nir_parallel_copy_instr_create(nir_shader *shader)
 {
-   nir_parallel_copy_instr *instr = malloc(sizeof(*instr));
+   nir_parallel_copy_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
    instr_init(&instr->instr, nir_instr_type_parallel_copy);
 
    exec_list_make_empty(&instr->entries);
@@ -931,7 +1207,7 @@ nir_ssa_undef_instr_create(nir_shader *shader,
                            unsigned num_components,
                            unsigned bit_size)
 {
-   nir_ssa_undef_instr *instr = malloc(sizeof(*instr));
+   nir_ssa_undef_instr *instr = instr_pool_zalloc(shader->instr_pool, sizeof(*instr));
    instr_init(&instr->instr, nir_instr_type_ssa_undef);
 
    nir_ssa_def_init(&instr->instr, &instr->def, num_components, bit_size);
@@ -1262,7 +1538,7 @@ void nir_instr_free(nir_instr *instr)
    case nir_instr_type_phi: {
       nir_phi_instr *phi = nir_instr_as_phi(instr);
       nir_foreach_phi_src_safe(phi_src, phi) {
-         free(phi_src);
+         instr_pool_free(phi_src);
       }
       break;
    }
@@ -1272,7 +1548,7 @@ void nir_instr_free(nir_instr *instr)
    }
 
    list_del(&instr->gc_node);
-   free(instr);
+   instr_pool_free(instr);
 }
 
 void
@@ -2102,6 +2378,30 @@ nir_block_get_following_loop(nir_block *block)
    return nir_cf_node_as_loop(next_node);
 }
 
+bool
+nir_if_falls_through(nir_if *nif)
+{
+   nir_foreach_block_in_cf_node(block, &nif->cf_node) {
+      nir_instr *last = nir_block_last_instr(block);
+      if (!last || last->type != nir_instr_type_jump)
+         continue;
+
+      nir_jump_type type = nir_instr_as_jump(last)->type;
+      if (type != nir_jump_break && type != nir_jump_continue)
+         return false;
+
+      /* Breaks and continues are fine if their loop is inside the if. */
+      nir_cf_node *node = block->cf_node.parent;
+      while (node != &nif->cf_node && node->type != nir_cf_node_loop)
+         node = node->parent;
+
+      if (node == &nif->cf_node)
+         return false;
+   }
+
+   return true;
+}
+
 static int
 compare_block_index(const void *p1, const void *p2)
 {
@@ -2915,6 +2915,8 @@ typedef enum {
     *   - nir_block::dom_post_index
     *
     * A pass can preserve this metadata type if it doesn't touch the CFG.
+    * Passes which drop it without changing the CFG don't force it to be
+    * recomputed, see nir_calc_dominance_impl().
     */
    nir_metadata_dominance = 0x2,
 
@@ -2962,6 +2964,15 @@ typedef enum {
     */
    nir_metadata_instr_index = 0x20,
 
+   /** Indicates that nir_opt_cse() found nothing to eliminate.
+    *
+    * CSE doesn't need to look at the impl again until it changes, so it
+    * returns early while this is set.  Since a pass which changes anything
+    * must not preserve nir_metadata_all, no pass needs to know about this
+    * metadata type.
+    */
+   nir_metadata_cse = 0x40,
+
    /** All metadata
     *
     * This includes all nir_metadata flags except not_properly_reset.  Passes
@@ -3011,6 +3022,9 @@ typedef struct {
     */
    bool structured;
 
+   /** Value of nir_cfg_generation when dominance was last computed */
+   uint64_t dominance_cfg_generation;
+
    nir_metadata valid_metadata;
 } nir_function_impl;
 
@@ -3220,6 +3234,8 @@ typedef enum {
    nir_pack_varying_interp_loc_sample         = (1 << 16),
    nir_pack_varying_interp_loc_centroid       = (1 << 17),
    nir_pack_varying_interp_loc_center         = (1 << 18),
+   /* Also pack 16-bit scalar varyings with each other. */
+   nir_pack_varying_16bit                     = (1 << 24),
 } nir_pack_varying_options;
 
 /** An instruction filtering callback
@@ -3571,6 +3587,20 @@ typedef struct nir_shader_compiler_options {
    unsigned max_unroll_iterations;
    unsigned max_unroll_iterations_aggressive;
 
+   /**
+    * Loops are only unrolled if the cost of their body times the trip count
+    * is at most the max_unroll_iterations limit in use times this.  If 0, a
+    * default of 26 is used.
+    */
+   unsigned max_unroll_cost_per_iteration;
+
+   /**
+    * Returns the cost of an instruction for the loop unrolling heuristics,
+    * in units of a simple ALU instruction.  If NULL, a generic estimate that
+    * only knows about lowered 64-bit operations is used.
+    */
+   unsigned (*loop_instr_cost)(const nir_instr *instr);
+
    bool lower_uniforms_to_ubo;
 
    /* If the precision is ignored, backends that don't handle
@@ -3648,6 +3678,7 @@ typedef struct nir_shader {
    struct exec_list functions; /** < list of nir_function */
 
    struct list_head gc_list; /** < list of all nir_instrs allocated on the shader but not yet freed. */
+   struct nir_instr_pool *instr_pool; /** < memory the instructions in gc_list are allocated from. */
 
    /**
     * The size of the variable space for load_input_*, load_uniform_*, etc.
@@ -3791,6 +3822,7 @@ nir_tex_instr *nir_tex_instr_create(nir_shader *shader, unsigned num_srcs);
 
 nir_phi_instr *nir_phi_instr_create(nir_shader *shader);
 nir_phi_src *nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_src src);
+void nir_phi_src_free(nir_phi_src *src);
 
 nir_parallel_copy_instr *nir_parallel_copy_instr_create(nir_shader *shader);
 
@@ -4048,6 +4080,8 @@ nir_instr_insert_after_cf_list(struct exec_list *list, nir_instr *after)
 
 void nir_instr_remove_v(nir_instr *instr);
 void nir_instr_free(nir_instr *instr);
+void nir_shader_trim_instr_pool(nir_shader *shader);
+void nir_shader_destroy_instr_pool(nir_shader *shader);
 void nir_instr_free_list(struct exec_list *list);
 
 static inline nir_cursor
@@ -4234,6 +4268,11 @@ nir_if *nir_block_get_following_if(nir_block *block);
 
 nir_loop *nir_block_get_following_loop(nir_block *block);
 
+/* Returns true if every path through the if continues to the block after
+ * it, i.e. the if contains no jumps leaving it.
+ */
+bool nir_if_falls_through(nir_if *nif);
+
 nir_block **nir_block_get_predecessors_sorted(const nir_block *block, void *mem_ctx);
 
 void nir_index_local_regs(nir_function_impl *impl);
@@ -4269,8 +4308,14 @@ nir_instr *nir_instr_clone_deep(nir_shader *s, const nir_instr *orig,
 nir_alu_instr *nir_alu_instr_clone(nir_shader *s, const nir_alu_instr *orig);
 
 nir_shader *nir_shader_clone(void *mem_ctx, const nir_shader *s);
+nir_shader *nir_shader_clone_functions(void *mem_ctx, const nir_shader *s,
+                                       const struct set *functions);
 nir_function_impl *nir_function_impl_clone(nir_shader *shader,
                                            const nir_function_impl *fi);
+nir_function_impl *
+nir_function_impl_clone_remap_globals(nir_shader *shader,
+                                      const nir_function_impl *fi,
+                                      struct hash_table *remap_table);
 nir_constant *nir_constant_clone(const nir_constant *c, nir_variable *var);
 nir_variable *nir_variable_clone(const nir_variable *c, nir_shader *shader);
 
@@ -4320,12 +4365,32 @@ static inline bool should_skip_nir(UNUSED const char *pass_name) { return false;
 static inline bool should_print_nir(UNUSED nir_shader *shader) { return false; }
 #endif /* NDEBUG */
 
+/** Set from NIR_PASS_STATS by nir_pass_stats_init(). */
+extern bool nir_pass_stats_enabled;
+
+struct nir_pass_stats {
+   const char *name;
+   uint64_t start_ns;
+   unsigned instr_count;
+   uint64_t ralloc_bytes;
+};
+
+void nir_pass_stats_init(void);
+void nir_pass_stats_begin(struct nir_pass_stats *stats, nir_shader *shader,
+                          const char *name);
+void nir_pass_stats_end(struct nir_pass_stats *stats, nir_shader *shader);
+
 #define _PASS(pass, nir, do_pass) do {                               \
    if (should_skip_nir(#pass)) {                                     \
       printf("skipping %s\n", #pass);                                \
       break;                                                         \
    }                                                                 \
+   struct nir_pass_stats _pass_stats = { 0 };                        \
+   if (unlikely(nir_pass_stats_enabled))                             \
+      nir_pass_stats_begin(&_pass_stats, nir, #pass);                \
    do_pass                                                           \
+   if (unlikely(nir_pass_stats_enabled))                             \
+      nir_pass_stats_end(&_pass_stats, nir);                         \
    if (NIR_DEBUG(CLONE)) {                                           \
       nir_shader *clone = nir_shader_clone(ralloc_parent(nir), nir); \
       nir_shader_replace(nir, clone);                                \
@@ -4357,6 +4422,32 @@ static inline bool should_print_nir(UNUSED nir_shader *shader) { return false; }
       nir_print_shader(nir, stdout);                                 \
 )
 
+/**
+ * NIR_PASS for fixed-point optimization loops, which skips passes that
+ * can't make progress.
+ *
+ * A pass that made no progress on a shader won't make any on the same
+ * shader the next time around the loop either.  So when a pass makes no
+ * progress, this call site is added to \p idempotent_set (a pointer set
+ * created by the caller for the whole loop) and it is skipped until some
+ * NIR_LOOP_PASS of the loop makes progress and clears the set.  Everything
+ * in the loop that may change the shader must go through NIR_LOOP_PASS,
+ * or clear the set itself.
+ */
+#define NIR_LOOP_PASS(progress, idempotent_set, nir, pass, ...) do {    \
+   static char _loop_pass_site;                                       \
+   if (!_mesa_set_search(idempotent_set, &_loop_pass_site)) {         \
+      bool _loop_pass_progress = false;                               \
+      NIR_PASS(_loop_pass_progress, nir, pass, ##__VA_ARGS__);        \
+      if (_loop_pass_progress) {                                      \
+         _mesa_set_clear(idempotent_set, NULL);                       \
+         progress = true;                                             \
+      } else {                                                        \
+         _mesa_set_add(idempotent_set, &_loop_pass_site);             \
+      }                                                               \
+   }                                                                  \
+} while (0)
+
 #define NIR_SKIP(name) should_skip_nir(#name)
 
 /** An instruction filtering callback with writemask
@@ -4536,6 +4627,8 @@ void nir_compact_varyings(nir_shader *producer, nir_shader *consumer,
                           bool default_to_smooth_interp);
 void nir_link_xfb_varyings(nir_shader *producer, nir_shader *consumer);
 bool nir_link_opt_varyings(nir_shader *producer, nir_shader *consumer);
+void nir_link_shader_varyings(nir_shader *producer, nir_shader *consumer,
+                              void (*optimize)(nir_shader *nir));
 void nir_link_varying_precision(nir_shader *producer, nir_shader *consumer);
 
 bool nir_slot_is_sysval_output(gl_varying_slot slot);
@@ -5267,6 +5360,7 @@ bool nir_unpack_16bit_varying_slots(nir_shader *nir, nir_variable_mode modes);
 bool nir_fold_16bit_sampler_conversions(nir_shader *nir,
                                         unsigned tex_src_types, uint32_t sampler_dims);
 bool nir_fold_16bit_image_load_store_conversions(nir_shader *nir);
+bool nir_opt_mediump_alu(nir_shader *nir, nir_alu_type types);
 
 typedef struct {
    bool legalize_type;         /* whether this src should be legalized */
@@ -5492,6 +5586,12 @@ typedef struct {
    nir_variable_mode robust_modes;
    void *cb_data;
    bool has_shared2_amd;
+
+   /* Move loads from the block after an if into the block before it when
+    * the block before has a load of the same resource, so that the two can
+    * be vectorized.
+    */
+   bool hoist_across_ifs;
 } nir_load_store_vectorize_options;
 
 bool nir_opt_load_store_vectorize(nir_shader *shader, const nir_load_store_vectorize_options *options);
@@ -5566,6 +5666,33 @@ typedef enum {
    nir_ray_query_value_world_ray_origin,
 } nir_ray_query_value;
 
+/* Generic cost model for nir_opt_preamble, for backends which don't need
+ * their own callbacks.  ALU and rewrite costs are per component.
+ */
+typedef struct {
+   /* Ordinary ALU instructions.  Moves and vecs are free. */
+   float alu;
+
+   /* Transcendental ALU instructions, like frcp, fsqrt or fsin. */
+   float alu_transcendental;
+
+   /* ALU instructions with a 64-bit source or destination. */
+   float alu_64bit;
+
+   float tex;
+
+   /* load_ubo with a non-constant block index or offset.  Fully constant
+    * ones are left to UBO lowering.
+    */
+   float load_ubo;
+
+   /* Loads from SSBOs and images, and get_ssbo_size. */
+   float load_memory;
+
+   /* Inserting a load_preamble in place of a value. */
+   float rewrite;
+} nir_opt_preamble_cost_table;
+
 typedef struct {
    /* True if gl_DrawID is considered uniform, i.e. if the preamble is run
     * at least once per "internal" draw rather than per user-visible draw.
@@ -5604,6 +5731,11 @@ typedef struct {
    nir_instr_filter_cb avoid_instr_cb;
 
    const void *cb_data;
+
+   /* Used in place of instr_cost_cb and rewrite_cost_cb when those are NULL,
+    * see nir_opt_preamble_cost_table.
+    */
+   const nir_opt_preamble_cost_table *cost_table;
 } nir_opt_preamble_options;
 
 bool
@@ -717,6 +717,25 @@ nir_function_impl_clone(nir_shader *shader, const nir_function_impl *fi)
    return nfi;
 }
 
+/**
+ * Clones a function_impl into another shader, looking up the functions and
+ * global variables it references in remap_table, which maps the objects of
+ * the impl's shader to those of the destination shader.
+ */
+nir_function_impl *
+nir_function_impl_clone_remap_globals(nir_shader *shader,
+                                      const nir_function_impl *fi,
+                                      struct hash_table *remap_table)
+{
+   clone_state state;
+   init_clone_state(&state, remap_table, true, false);
+
+   state.ns = shader;
+
+   /* The table belongs to the caller, so no free_clone_state(). */
+   return clone_function_impl(&state, fi);
+}
+
 static nir_function *
 clone_function(clone_state *state, const nir_function *fxn, nir_shader *ns)
 {
@@ -743,8 +762,8 @@ clone_function(clone_state *state, const nir_function *fxn, nir_shader *ns)
    return nfxn;
 }
 
-nir_shader *
-nir_shader_clone(void *mem_ctx, const nir_shader *s)
+static nir_shader *
+clone_shader(void *mem_ctx, const nir_shader *s, const struct set *functions)
 {
    clone_state state;
    init_clone_state(&state, NULL, true, false);
@@ -764,6 +783,9 @@ nir_shader_clone(void *mem_ctx, const nir_shader *s)
     * the functions will have in the list.
     */
    nir_foreach_function(fxn, s) {
+      if (functions && !_mesa_set_search(functions, fxn))
+         continue;
+
       nir_function *nfxn = remap_global(&state, fxn);
       nfxn->impl = clone_function_impl(&state, fxn->impl);
       nfxn->impl->function = nfxn;
@@ -790,6 +812,26 @@ nir_shader_clone(void *mem_ctx, const nir_shader *s)
    return ns;
 }
 
+nir_shader *
+nir_shader_clone(void *mem_ctx, const nir_shader *s)
+{
+   return clone_shader(mem_ctx, s, NULL);
+}
+
+/**
+ * Clones a shader, but only the bodies of the functions in the given set.
+ * The other functions are left without an impl.
+ *
+ * The functions and shader variables of the clone are in the same order as
+ * those of the original.
+ */
+nir_shader *
+nir_shader_clone_functions(void *mem_ctx, const nir_shader *s,
+                           const struct set *functions)
+{
+   return clone_shader(mem_ctx, s, functions);
+}
+
 /** Overwrites dst and replaces its contents with src
  *
  * Everything ralloc parented to dst and src itself (but not its children)
@@ -809,6 +851,7 @@ nir_shader_replace(nir_shader *dst, nir_shader *src)
    list_for_each_entry_safe(nir_instr, instr, &dst->gc_list, gc_node) {
       nir_instr_free(instr);
    }
+   nir_shader_destroy_instr_pool(dst);
 
    /* Re-parent all of src's ralloc children to dst */
    ralloc_adopt(dst, src);
@@ -820,6 +863,7 @@ nir_shader_replace(nir_shader *dst, nir_shader *src)
     */
    list_replace(&src->gc_list, &dst->gc_list);
    list_inithead(&src->gc_list);
+   src->instr_pool = NULL;
    exec_list_move_nodes_to(&src->variables, &dst->variables);
 
    /* Now move the functions over.  This takes a tiny bit more work */
@@ -45,10 +45,13 @@
  */
 /*@{*/
 
+uint64_t nir_cfg_generation = 1;
+
 static inline void
 block_add_pred(nir_block *block, nir_block *pred)
 {
    _mesa_set_add(block->predecessors, pred);
+   nir_cfg_changed();
 }
 
 static inline void
@@ -59,6 +62,7 @@ block_remove_pred(nir_block *block, nir_block *pred)
    assert(entry);
 
    _mesa_set_remove(block->predecessors, entry);
+   nir_cfg_changed();
 }
 
 static void
@@ -441,7 +445,7 @@ remove_phi_src(nir_block *block, nir_block *pred)
          if (src->pred == pred) {
             list_del(&src->src.use_link);
             exec_node_remove(&src->node);
-            free(src);
+            nir_phi_src_free(src);
          }
       }
    }
@@ -29,6 +29,20 @@
 #define NIR_CONTROL_FLOW_PRIVATE_H
 
 #include "nir_control_flow.h"
+#include "util/u_atomic.h"
+
+/* Bumped on every change to a CFG edge, in any shader.  Dominance only
+ * depends on the CFG, so dominance information computed at some generation
+ * is still correct as long as the generation hasn't moved, even if a pass
+ * conservatively dropped nir_metadata_dominance.
+ */
+extern uint64_t nir_cfg_generation;
+
+static inline void
+nir_cfg_changed(void)
+{
+   p_atomic_inc(&nir_cfg_generation);
+}
 
 
 /* Internal control-flow modification functions used when inserting/removing
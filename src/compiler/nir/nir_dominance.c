@@ -26,6 +26,7 @@
  */
 
 #include "nir.h"
+#include "nir_control_flow_private.h"
 
 /*
  * Implements the algorithms for computing the dominance tree and the
@@ -168,8 +169,14 @@ nir_calc_dominance_impl(nir_function_impl *impl)
    if (impl->valid_metadata & nir_metadata_dominance)
       return;
 
-   nir_metadata_require(impl, nir_metadata_block_index);
+   /* The CFG hasn't changed since the last time, so the dominance
+    * information stored in the blocks is still correct.
+    */
+   uint64_t cfg_generation = p_atomic_read(&nir_cfg_generation);
+   if (impl->dominance_cfg_generation == cfg_generation)
+      return;
 
+   nir_metadata_require(impl, nir_metadata_block_index);
 
    nir_foreach_block_unstructured(block, impl) {
       init_block(block, impl);
@@ -195,6 +202,8 @@ nir_calc_dominance_impl(nir_function_impl *impl)
 
    uint32_t dfs_index = 1;
    calc_dfs_indicies(start_block, &dfs_index);
+
+   impl->dominance_cfg_generation = cfg_generation;
 }
 
 void
@@ -262,15 +262,21 @@ get_interp_loc(nir_variable *var)
 }
 
 static bool
-is_packing_supported_for_type(const struct glsl_type *type)
+is_packing_supported_for_type(const struct glsl_type *type,
+                              nir_pack_varying_options options)
 {
    /* We ignore complex types such as arrays, matrices, structs and bitsizes
-    * other then 32bit. All other vector types should have been split into
-    * scalar variables by the lower_io_to_scalar pass. The only exception
-    * should be OpenGL xfb varyings.
+    * other then 32bit, and 16bit if the driver asks for it. All other vector
+    * types should have been split into scalar variables by the
+    * lower_io_to_scalar pass. The only exception should be OpenGL xfb
+    * varyings.
     * TODO: add support for more complex types?
     */
-   return glsl_type_is_scalar(type) && glsl_type_is_32bit(type);
+   if (!glsl_type_is_scalar(type))
+      return false;
+
+   return glsl_type_is_32bit(type) ||
+          (glsl_type_is_16bit(type) && (options & nir_pack_varying_16bit));
 }
 
 struct assigned_comps
@@ -279,6 +285,7 @@ struct assigned_comps
    uint8_t interp_type;
    uint8_t interp_loc;
    bool is_32bit;
+   bool is_16bit;
    bool is_mediump;
    bool is_per_primitive;
 };
@@ -292,6 +299,7 @@ get_unmoveable_components_masks(nir_shader *shader,
                                 nir_variable_mode mode,
                                 struct assigned_comps *comps,
                                 gl_shader_stage stage,
+                                nir_pack_varying_options options,
                                 bool default_to_smooth_interp)
 {
    nir_foreach_variable_with_modes_safe(var, shader, mode) {
@@ -310,7 +318,7 @@ get_unmoveable_components_masks(nir_shader *shader,
          /* If we can pack this varying then don't mark the components as
           * used.
           */
-         if (is_packing_supported_for_type(type) &&
+         if (is_packing_supported_for_type(type, options) &&
              !var->data.always_active_io)
             continue;
 
@@ -350,6 +358,8 @@ get_unmoveable_components_masks(nir_shader *shader,
             comps[location + i].interp_loc = get_interp_loc(var);
             comps[location + i].is_32bit =
                glsl_type_is_32bit(glsl_without_array(type));
+            comps[location + i].is_16bit =
+               glsl_type_is_16bit(glsl_without_array(type));
             comps[location + i].is_mediump =
                var->data.precision == GLSL_PRECISION_MEDIUM ||
                var->data.precision == GLSL_PRECISION_LOW;
@@ -471,6 +481,7 @@ struct varying_component {
    uint8_t interp_type;
    uint8_t interp_loc;
    bool is_32bit;
+   bool is_16bit;
    bool is_patch;
    bool is_per_primitive;
    bool is_mediump;
@@ -504,6 +515,10 @@ cmp_varying_component(const void *comp1_v, const void *comp2_v)
    if (comp1->is_mediump != comp2->is_mediump)
       return comp1->is_mediump ? 1 : -1;
 
+   /* 16-bit and 32-bit components can't share a slot, so group them too. */
+   if (comp1->is_16bit != comp2->is_16bit)
+      return comp1->is_16bit ? 1 : -1;
+
    /* We can only pack varyings with matching interpolation types so group
     * them together.
     */
@@ -530,6 +545,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
 {
    unsigned store_varying_info_idx[MAX_VARYINGS_INCL_PATCH][4] = {{0}};
    unsigned num_of_comps_to_pack = 0;
+   nir_pack_varying_options options = consumer->options->pack_varying_options;
 
    /* Count the number of varying that can be packed and create a mapping
     * of those varyings to the array we will pass to qsort.
@@ -550,7 +566,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
             type = glsl_get_array_element(type);
          }
 
-         if (!is_packing_supported_for_type(type))
+         if (!is_packing_supported_for_type(type, options))
             continue;
 
          unsigned loc = var->data.location - VARYING_SLOT_VAR0;
@@ -613,6 +629,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
                get_interp_type(in_var, type, default_to_smooth_interp);
             vc_info->interp_loc = get_interp_loc(in_var);
             vc_info->is_32bit = glsl_type_is_32bit(type);
+            vc_info->is_16bit = glsl_type_is_16bit(type);
             vc_info->is_patch = in_var->data.patch;
             vc_info->is_per_primitive = in_var->data.per_primitive;
             vc_info->is_mediump = !producer->options->linker_ignore_precision &&
@@ -679,6 +696,7 @@ gather_varying_component_info(nir_shader *producer, nir_shader *consumer,
                   get_interp_type(out_var, type, default_to_smooth_interp);
                vc_info->interp_loc = get_interp_loc(out_var);
                vc_info->is_32bit = glsl_type_is_32bit(type);
+               vc_info->is_16bit = glsl_type_is_16bit(type);
                vc_info->is_patch = out_var->data.patch;
                vc_info->is_per_primitive = out_var->data.per_primitive;
                vc_info->is_mediump = !producer->options->linker_ignore_precision &&
@@ -798,9 +816,10 @@ assign_remap_locations(struct varying_loc (*remap)[4],
          }
 
          /* We can only pack varyings with matching types, and the current
-          * algorithm only supports packing 32-bit.
+          * algorithm only supports packing 32-bit and 16-bit.
           */
-         if (!assigned_comps[tmp_cursor].is_32bit) {
+         if (!(assigned_comps[tmp_cursor].is_32bit && info->is_32bit) &&
+             !(assigned_comps[tmp_cursor].is_16bit && info->is_16bit)) {
             tmp_comp = 0;
             continue;
          }
@@ -823,6 +842,7 @@ assign_remap_locations(struct varying_loc (*remap)[4],
       assigned_comps[tmp_cursor].interp_type = info->interp_type;
       assigned_comps[tmp_cursor].interp_loc = info->interp_loc;
       assigned_comps[tmp_cursor].is_32bit = info->is_32bit;
+      assigned_comps[tmp_cursor].is_16bit = info->is_16bit;
       assigned_comps[tmp_cursor].is_mediump = info->is_mediump;
       assigned_comps[tmp_cursor].is_per_primitive = info->is_per_primitive;
 
@@ -938,19 +958,71 @@ nir_compact_varyings(nir_shader *producer, nir_shader *consumer,
 
    struct assigned_comps assigned_comps[MAX_VARYINGS_INCL_PATCH] = {{0}};
 
+   nir_pack_varying_options options = consumer->options->pack_varying_options;
+
    get_unmoveable_components_masks(producer, nir_var_shader_out,
                                    assigned_comps,
                                    producer->info.stage,
+                                   options,
                                    default_to_smooth_interp);
    get_unmoveable_components_masks(consumer, nir_var_shader_in,
                                    assigned_comps,
                                    consumer->info.stage,
+                                   options,
                                    default_to_smooth_interp);
 
    compact_components(producer, consumer, assigned_comps,
                       default_to_smooth_interp);
 }
 
+/**
+ * Runs the usual sequence of varying linking optimizations on a pair of
+ * adjacent stages: scalarizing and splitting I/O, propagating constant and
+ * duplicated outputs, and removing varyings the other side doesn't use.
+ *
+ * optimize is the driver's optimization loop.  It is run again after each
+ * step that made progress so that I/O which became dead is removed as well.
+ * Varyings are not compacted, drivers that want that should call
+ * nir_compact_varyings() afterwards.
+ */
+void
+nir_link_shader_varyings(nir_shader *producer, nir_shader *consumer,
+                         void (*optimize)(nir_shader *nir))
+{
+   if (producer->options->lower_to_scalar) {
+      NIR_PASS_V(producer, nir_lower_io_to_scalar_early, nir_var_shader_out);
+      NIR_PASS_V(consumer, nir_lower_io_to_scalar_early, nir_var_shader_in);
+   }
+
+   nir_lower_io_arrays_to_elements(producer, consumer);
+
+   optimize(producer);
+   optimize(consumer);
+
+   if (nir_link_opt_varyings(producer, consumer))
+      optimize(consumer);
+
+   NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out, NULL);
+   NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in, NULL);
+
+   if (nir_remove_unused_varyings(producer, consumer)) {
+      NIR_PASS_V(producer, nir_lower_global_vars_to_local);
+      NIR_PASS_V(consumer, nir_lower_global_vars_to_local);
+
+      optimize(producer);
+      optimize(consumer);
+
+      /* Optimizations can cause varyings to become unused.
+       * nir_compact_varyings() depends on all dead varyings being removed so
+       * we need to call nir_remove_dead_variables() again here.
+       */
+      NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out,
+                 NULL);
+      NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in,
+                 NULL);
+   }
+}
+
 /*
  * Mark XFB varyings as always_active_io in the consumer so the linking opts
  * don't touch them.
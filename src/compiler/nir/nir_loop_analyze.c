@@ -143,6 +143,9 @@ init_loop_def(nir_ssa_def *def, void *void_init_loop_state)
 static unsigned
 instr_cost(nir_instr *instr, const nir_shader_compiler_options *options)
 {
+   if (options->loop_instr_cost)
+      return options->loop_instr_cost(instr);
+
    if (instr->type == nir_instr_type_intrinsic ||
        instr->type == nir_instr_type_tex)
       return 1;
@@ -24,6 +24,7 @@
 
 #include "nir.h"
 #include "nir_builder.h"
+#include "nir_range_analysis.h"
 
 /**
  * Return the intrinsic if it matches the mask in "modes", else return NULL.
@@ -793,3 +794,297 @@ nir_fold_16bit_image_load_store_conversions(nir_shader *nir)
                                        nir_metadata_block_index | nir_metadata_dominance,
                                        NULL);
 }
+
+static bool
+is_float_op_narrowable(nir_op op)
+{
+   switch (op) {
+   case nir_op_bcsel:
+   case nir_op_fabs:
+   case nir_op_fadd:
+   case nir_op_fceil:
+   case nir_op_ffloor:
+   case nir_op_ffma:
+   case nir_op_ffract:
+   case nir_op_flrp:
+   case nir_op_fmax:
+   case nir_op_fmin:
+   case nir_op_fmul:
+   case nir_op_fneg:
+   case nir_op_fround_even:
+   case nir_op_fsat:
+   case nir_op_fsign:
+   case nir_op_ftrunc:
+   case nir_op_mov:
+      return true;
+   default:
+      return false;
+   }
+}
+
+/* The low 16 bits of the result only depend on the low 16 bits of the
+ * sources.  Shifts aren't included because the shift count is masked by the
+ * bit size.
+ */
+static bool
+is_int_op_narrowable(nir_op op)
+{
+   switch (op) {
+   case nir_op_bcsel:
+   case nir_op_iadd:
+   case nir_op_iand:
+   case nir_op_imul:
+   case nir_op_ineg:
+   case nir_op_inot:
+   case nir_op_ior:
+   case nir_op_ixor:
+   case nir_op_mov:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool
+is_narrowed_src(const nir_alu_instr *alu, unsigned i)
+{
+   /* The bcsel condition keeps its 1-bit type. */
+   return alu->op != nir_op_bcsel || i != 0;
+}
+
+static bool
+is_32bit_alu(const nir_alu_instr *alu)
+{
+   if (alu->dest.dest.ssa.bit_size != 32 || alu->exact)
+      return false;
+
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+      if (is_narrowed_src(alu, i) && nir_src_bit_size(alu->src[i].src) != 32)
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+is_i32_to_mediump_conversion(nir_instr *instr)
+{
+   return is_i32_to_i16_conversion(instr) ||
+          is_n_to_m_conversion(instr, 32, nir_op_i2imp);
+}
+
+/* Whether a float source of "alu" holds a value that is already exactly
+ * representable as a 16-bit float: a 16-bit value converted up, a constant
+ * that survives the round trip, or the result of an ALU chain of such values.
+ */
+static bool
+is_mediump_float_src(const BITSET_WORD *mediump, nir_alu_instr *alu,
+                     unsigned i)
+{
+   nir_ssa_def *def = alu->src[i].src.ssa;
+
+   if (def->parent_instr->type != nir_instr_type_load_const)
+      return BITSET_TEST(mediump, def->index);
+
+   for (unsigned c = 0; c < nir_ssa_alu_instr_src_components(alu, i); c++) {
+      if (!const_is_f16(nir_get_ssa_scalar(def, alu->src[i].swizzle[c])))
+         return false;
+   }
+
+   return true;
+}
+
+static void
+find_mediump_float_defs(nir_function_impl *impl, BITSET_WORD *mediump)
+{
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type != nir_instr_type_alu)
+            continue;
+
+         nir_alu_instr *alu = nir_instr_as_alu(instr);
+         bool is_mediump;
+
+         if (is_f16_to_f32_conversion(instr)) {
+            is_mediump = true;
+         } else if (is_float_op_narrowable(alu->op) && is_32bit_alu(alu)) {
+            is_mediump = true;
+            for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+               if (is_narrowed_src(alu, i))
+                  is_mediump &= is_mediump_float_src(mediump, alu, i);
+            }
+         } else {
+            is_mediump = false;
+         }
+
+         if (is_mediump)
+            BITSET_SET(mediump, alu->dest.dest.ssa.index);
+      }
+   }
+}
+
+static void
+narrow_alu_srcs(nir_builder *b, nir_alu_instr *alu,
+                nir_ssa_def *(*convert)(nir_builder *, nir_ssa_def *))
+{
+   b->cursor = nir_before_instr(&alu->instr);
+
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+      if (is_narrowed_src(alu, i)) {
+         nir_instr_rewrite_src_ssa(&alu->instr, &alu->src[i].src,
+                                   convert(b, alu->src[i].src.ssa));
+      }
+   }
+
+   alu->dest.dest.ssa.bit_size = 16;
+}
+
+/* Narrow a float ALU instruction whose sources are all mediump values and
+ * whose result is only consumed by f2fmp.  By the GLSL precision rules such
+ * an operation has medium precision, so evaluating it in 16 bits is allowed.
+ */
+static bool
+narrow_float_alu(nir_builder *b, const BITSET_WORD *mediump,
+                 nir_alu_instr *alu)
+{
+   nir_ssa_def *def = &alu->dest.dest.ssa;
+
+   if (!is_float_op_narrowable(alu->op) || !is_32bit_alu(alu) ||
+       !BITSET_TEST(mediump, def->index) || !list_is_empty(&def->if_uses) ||
+       list_is_empty(&def->uses))
+      return false;
+
+   nir_foreach_use(use, def) {
+      if (!is_n_to_m_conversion(use->parent_instr, 32, nir_op_f2fmp) ||
+          nir_instr_as_alu(use->parent_instr)->dest.saturate)
+         return false;
+   }
+
+   narrow_alu_srcs(b, alu, nir_f2fmp);
+
+   nir_foreach_use(use, def)
+      nir_instr_as_alu(use->parent_instr)->op = nir_op_mov;
+
+   return true;
+}
+
+/* Narrow an integer ALU instruction if nothing uses more than the low 16 bits
+ * of its result and at least one use converts it to 16 bits anyway.  Uses
+ * that aren't conversions get a zero-extended copy of the 16-bit result,
+ * which agrees with the original in every bit they read.
+ */
+static bool
+narrow_int_alu(nir_builder *b, nir_alu_instr *alu)
+{
+   nir_ssa_def *def = &alu->dest.dest.ssa;
+
+   if (!is_int_op_narrowable(alu->op) || !is_32bit_alu(alu) ||
+       !list_is_empty(&def->if_uses) ||
+       (nir_ssa_def_bits_used(def) & ~0xffffull))
+      return false;
+
+   bool has_conversion_use = false;
+   bool has_other_use = false;
+   nir_foreach_use(use, def) {
+      if (is_i32_to_mediump_conversion(use->parent_instr) &&
+          !nir_instr_as_alu(use->parent_instr)->dest.saturate)
+         has_conversion_use = true;
+      else
+         has_other_use = true;
+   }
+
+   if (!has_conversion_use)
+      return false;
+
+   narrow_alu_srcs(b, alu, nir_i2imp);
+
+   nir_ssa_def *wide = NULL;
+   if (has_other_use) {
+      b->cursor = nir_after_instr(&alu->instr);
+      wide = nir_u2u32(b, def);
+   }
+
+   nir_foreach_use_safe(use, def) {
+      if (wide && use->parent_instr == wide->parent_instr)
+         continue;
+
+      if (is_i32_to_mediump_conversion(use->parent_instr) &&
+          !nir_instr_as_alu(use->parent_instr)->dest.saturate)
+         nir_instr_as_alu(use->parent_instr)->op = nir_op_mov;
+      else
+         nir_instr_rewrite_src_ssa(use->parent_instr, use, wide);
+   }
+
+   return true;
+}
+
+/**
+ * Evaluate 32-bit ALU chains in 16 bits where that is known to be allowed,
+ * so that the conversions to 16 bits at the end of a chain move towards its
+ * leaves and eventually cancel out against the 16-bit I/O, texture and image
+ * values the chain started from.
+ *
+ * Float instructions are narrowed when all of their results feed f2fmp and
+ * all of their sources are exactly representable in 16 bits.  Integer
+ * instructions are narrowed when nir_ssa_def_bits_used() proves that only
+ * the low 16 bits of the result are read.
+ *
+ * Run this after nir_lower_mediump_io and the 16-bit sampler and image
+ * conversion folding, then run nir_opt_algebraic, copy propagation and DCE.
+ * Drivers opt in by calling it for the stages they want lowered.
+ */
+bool
+nir_opt_mediump_alu(nir_shader *nir, nir_alu_type types)
+{
+   bool changed = false;
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+   assert(impl);
+
+   /* Rounding modes would have to be preserved for the new 16-bit float
+    * instructions, so don't touch floats at all when they're set.
+    */
+   if (nir_has_any_rounding_mode_enabled(nir->info.float_controls_execution_mode))
+      types &= ~nir_type_float;
+
+   if (!(types & (nir_type_float | nir_type_int)))
+      return false;
+
+   nir_builder b;
+   nir_builder_init(&b, impl);
+
+   nir_index_ssa_defs(impl);
+   BITSET_WORD *mediump = calloc(BITSET_WORDS(impl->ssa_alloc),
+                                 sizeof(BITSET_WORD));
+   if (types & nir_type_float)
+      find_mediump_float_defs(impl, mediump);
+
+   /* Walk backwards so that narrowing an instruction, which converts its
+    * sources to 16 bits, lets the instructions producing them be narrowed in
+    * the same pass.  Instructions created on the way come after the ones
+    * that have been indexed, so they're never visited.
+    */
+   nir_foreach_block_reverse_safe (block, impl) {
+      nir_foreach_instr_reverse_safe (instr, block) {
+         if (instr->type != nir_instr_type_alu)
+            continue;
+
+         nir_alu_instr *alu = nir_instr_as_alu(instr);
+
+         if ((types & nir_type_float) && narrow_float_alu(&b, mediump, alu))
+            changed = true;
+         else if ((types & nir_type_int) && narrow_int_alu(&b, alu))
+            changed = true;
+      }
+   }
+
+   free(mediump);
+
+   if (changed) {
+      nir_metadata_preserve(impl, nir_metadata_dominance |
+                                  nir_metadata_block_index);
+   } else {
+      nir_metadata_preserve(impl, nir_metadata_all);
+   }
+
+   return changed;
+}
@@ -41,6 +41,9 @@ dominates(const nir_instr *old_instr, const nir_instr *new_instr)
 static bool
 nir_opt_cse_impl(nir_function_impl *impl)
 {
+   if (impl->valid_metadata & nir_metadata_cse)
+      return false;
+
    struct set *instr_set = nir_instr_set_create(NULL);
 
    _mesa_set_resize(instr_set, impl->ssa_alloc);
@@ -58,6 +61,7 @@ nir_opt_cse_impl(nir_function_impl *impl)
                                   nir_metadata_dominance);
    } else {
       nir_metadata_preserve(impl, nir_metadata_all);
+      impl->valid_metadata |= nir_metadata_cse;
    }
 
    nir_instr_set_destroy(instr_set);
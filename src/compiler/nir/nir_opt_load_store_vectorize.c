@@ -36,7 +36,8 @@
  *
  * There are a few situations where this doesn't vectorize as well as it could:
  * - It won't turn four consecutive vec3 loads into 3 vec4 loads.
- * - It doesn't do global vectorization.
+ * - It doesn't do global vectorization, except for loads hoisted across ifs
+ *   when nir_load_store_vectorize_options::hoist_across_ifs is set.
  * Handling these cases probably wouldn't provide much benefit though.
  *
  * This probably doesn't handle big-endian GPUs correctly.
@@ -1498,6 +1499,209 @@ process_block(nir_function_impl *impl, struct vectorize_ctx *ctx, nir_block *blo
    return progress;
 }
 
+/* Instructions which loads can't be moved across when hoisting them over an
+ * if: anything which may write memory, order memory accesses or end the
+ * invocation.
+ */
+static bool
+is_hoist_barrier(nir_instr *instr)
+{
+   if (instr->type == nir_instr_type_call)
+      return true;
+
+   if (instr->type != nir_instr_type_intrinsic)
+      return false;
+
+   nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+   return !(nir_intrinsic_infos[intrin->intrinsic].flags &
+            NIR_INTRINSIC_CAN_ELIMINATE);
+}
+
+static bool
+if_has_hoist_barrier(nir_if *nif)
+{
+   nir_foreach_block_in_cf_node(block, &nif->cf_node) {
+      nir_foreach_instr(instr, block) {
+         if (is_hoist_barrier(instr))
+            return true;
+      }
+   }
+
+   return false;
+}
+
+static bool can_hoist_src(nir_src *src, void *state);
+
+struct hoist_state {
+   nir_block *pred;
+   nir_block *merge;
+   unsigned depth;
+};
+
+/* Whether "instr" is available in the block before the if, or is a pure
+ * instruction from the block after it which can be moved there along with
+ * its sources.
+ */
+static bool
+can_hoist_instr(nir_instr *instr, struct hoist_state *state)
+{
+   if (instr->block != state->merge)
+      return nir_block_dominates(instr->block, state->pred);
+
+   switch (instr->type) {
+   case nir_instr_type_alu:
+   case nir_instr_type_deref:
+   case nir_instr_type_load_const:
+   case nir_instr_type_ssa_undef:
+      break;
+   case nir_instr_type_intrinsic:
+      if (!nir_intrinsic_can_reorder(nir_instr_as_intrinsic(instr)))
+         return false;
+      break;
+   default:
+      return false;
+   }
+
+   /* Keep the walk over address calculations short. */
+   if (state->depth >= 8)
+      return false;
+
+   state->depth++;
+   bool ok = nir_foreach_src(instr, can_hoist_src, state);
+   state->depth--;
+
+   return ok;
+}
+
+static bool
+can_hoist_src(nir_src *src, void *state)
+{
+   if (!src->is_ssa)
+      return false;
+
+   return can_hoist_instr(src->ssa->parent_instr, state);
+}
+
+static bool
+hoist_src(nir_src *src, void *state)
+{
+   struct hoist_state *hoist = state;
+   nir_instr *instr = src->ssa->parent_instr;
+
+   if (instr->block == hoist->merge) {
+      nir_foreach_src(instr, hoist_src, hoist);
+      nir_instr_move(nir_after_block(hoist->pred), instr);
+   }
+
+   return true;
+}
+
+static struct entry *
+create_hoist_entry(struct vectorize_ctx *ctx, void *mem_ctx, nir_instr *instr,
+                   nir_variable_mode *mode_out)
+{
+   if (instr->type != nir_instr_type_intrinsic)
+      return NULL;
+
+   nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+   const struct intrinsic_info *info = get_info(intrin->intrinsic);
+   if (!info || info->is_atomic || info->value_src >= 0)
+      return NULL;
+
+   nir_variable_mode mode = info->mode;
+   if (!mode)
+      mode = nir_src_as_deref(intrin->src[info->deref_src])->modes;
+   if (!(mode & aliasing_modes(ctx->options->modes)))
+      return NULL;
+
+   if (nir_intrinsic_has_access(intrin) &&
+       (nir_intrinsic_access(intrin) & ACCESS_VOLATILE))
+      return NULL;
+
+   struct entry *entry = create_entry(ctx, info, intrin);
+   ralloc_steal(mem_ctx, entry);
+
+   *mode_out = mode;
+   return entry;
+}
+
+/* Moves loads from the block following an if to the end of the block before
+ * it, when the block before already has a load with the same key.  Both
+ * blocks are control equivalent when every path through the if reaches the
+ * block after it, so this doesn't make the load execute more often, and the
+ * per-block vectorization afterwards can combine the two loads.
+ */
+static bool
+hoist_loads_across_ifs(struct vectorize_ctx *ctx, nir_function_impl *impl)
+{
+   bool progress = false;
+   void *mem_ctx = ralloc_context(NULL);
+   struct hash_table *keys[nir_num_variable_modes] = { NULL };
+
+   nir_metadata_require(impl, nir_metadata_dominance);
+
+   nir_foreach_block(merge, impl) {
+      nir_cf_node *prev = nir_cf_node_prev(&merge->cf_node);
+      if (!prev || prev->type != nir_cf_node_if)
+         continue;
+
+      nir_if *nif = nir_cf_node_as_if(prev);
+      if (!nir_if_falls_through(nif) || if_has_hoist_barrier(nif))
+         continue;
+
+      struct hoist_state state = {
+         .pred = nir_cf_node_as_block(nir_cf_node_prev(&nif->cf_node)),
+         .merge = merge,
+      };
+
+      for (unsigned i = 0; i < nir_num_variable_modes; i++) {
+         if (keys[i])
+            _mesa_hash_table_clear(keys[i], NULL);
+      }
+
+      bool has_keys = false;
+      nir_foreach_instr(instr, state.pred) {
+         nir_variable_mode mode;
+         struct entry *entry = create_hoist_entry(ctx, mem_ctx, instr, &mode);
+         if (!entry)
+            continue;
+
+         unsigned mode_index = mode_to_index(mode);
+         if (!keys[mode_index]) {
+            keys[mode_index] = _mesa_hash_table_create(mem_ctx, &hash_entry_key,
+                                                       &entry_key_equals);
+         }
+         _mesa_hash_table_insert(keys[mode_index], entry->key, entry);
+         has_keys = true;
+      }
+
+      if (!has_keys)
+         continue;
+
+      nir_foreach_instr_safe(instr, merge) {
+         if (is_hoist_barrier(instr))
+            break;
+
+         nir_variable_mode mode;
+         struct entry *entry = create_hoist_entry(ctx, mem_ctx, instr, &mode);
+         if (!entry)
+            continue;
+
+         struct hash_table *ht = keys[mode_to_index(mode)];
+         if (!ht || !_mesa_hash_table_search(ht, entry->key) ||
+             !nir_foreach_src(instr, can_hoist_src, &state))
+            continue;
+
+         nir_foreach_src(instr, hoist_src, &state);
+         nir_instr_move(nir_after_block(state.pred), instr);
+         progress = true;
+      }
+   }
+
+   ralloc_free(mem_ctx);
+   return progress;
+}
+
 bool
 nir_opt_load_store_vectorize(nir_shader *shader, const nir_load_store_vectorize_options *options)
 {
@@ -1514,13 +1718,17 @@ nir_opt_load_store_vectorize(nir_shader *shader, const nir_load_store_vectorize_
          if (options->modes & nir_var_function_temp)
             nir_function_impl_index_vars(function->impl);
 
+         bool hoisted = options->hoist_across_ifs &&
+                        hoist_loads_across_ifs(ctx, function->impl);
+
          nir_foreach_block(block, function->impl)
             progress |= process_block(function->impl, ctx, block);
 
          nir_metadata_preserve(function->impl,
                                nir_metadata_block_index |
                                nir_metadata_dominance |
-                               nir_metadata_live_ssa_defs);
+                               (hoisted ? 0 : nir_metadata_live_ssa_defs));
+         progress |= hoisted;
       }
    }
 
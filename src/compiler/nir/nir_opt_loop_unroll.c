@@ -846,7 +846,10 @@ check_unrolling_restrictions(nir_shader *shader, nir_loop *loop)
    if (li->force_unroll && !li->guessed_trip_count && trip_count <= max_iter)
       return true;
 
-   unsigned cost_limit = max_iter * LOOP_UNROLL_LIMIT;
+   unsigned cost_per_iter = shader->options->max_unroll_cost_per_iteration ?
+                            shader->options->max_unroll_cost_per_iteration :
+                            LOOP_UNROLL_LIMIT;
+   unsigned cost_limit = max_iter * cost_per_iter;
    unsigned cost = li->instr_cost * trip_count;
 
    if (cost <= cost_limit && trip_count <= max_iter)
@@ -1088,12 +1091,32 @@ exit:
    return progress;
 }
 
+static bool
+impl_has_loops(nir_function_impl *impl)
+{
+   nir_foreach_block(block, impl) {
+      if (nir_block_get_following_loop(block))
+         return true;
+   }
+
+   return false;
+}
+
 static bool
 nir_opt_loop_unroll_impl(nir_function_impl *impl,
                          nir_variable_mode indirect_mask,
                          bool force_unroll_sampler_indirect)
 {
    bool progress = false;
+
+   /* Optimization loops call this until there is no progress, which usually
+    * means after all loops are gone.  Skip the loop analysis then.
+    */
+   if (!impl_has_loops(impl)) {
+      nir_metadata_preserve(impl, nir_metadata_all);
+      return false;
+   }
+
    nir_metadata_require(impl, nir_metadata_loop_analysis, indirect_mask,
                         (int) force_unroll_sampler_indirect);
    nir_metadata_require(impl, nir_metadata_block_index);
@@ -80,6 +80,73 @@ typedef struct {
    const nir_opt_preamble_options *options;
 } opt_preamble_ctx;
 
+static float
+table_alu_cost(nir_alu_instr *alu, const nir_opt_preamble_cost_table *table)
+{
+   unsigned components = alu->dest.dest.ssa.num_components;
+
+   if (nir_op_is_vec(alu->op))
+      return 0;
+
+   switch (alu->op) {
+   case nir_op_frcp:
+   case nir_op_fsqrt:
+   case nir_op_frsq:
+   case nir_op_flog2:
+   case nir_op_fexp2:
+   case nir_op_fpow:
+   case nir_op_fsin:
+   case nir_op_fcos:
+      return table->alu_transcendental * components;
+
+   default:
+      break;
+   }
+
+   bool is_64bit = alu->dest.dest.ssa.bit_size == 64;
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++)
+      is_64bit |= nir_src_bit_size(alu->src[i].src) == 64;
+
+   return (is_64bit ? table->alu_64bit : table->alu) * components;
+}
+
+static float
+table_instr_cost(nir_instr *instr, const nir_opt_preamble_cost_table *table)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      return table_alu_cost(nir_instr_as_alu(instr), table);
+
+   case nir_instr_type_tex:
+      return table->tex;
+
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+      switch (intrin->intrinsic) {
+      case nir_intrinsic_load_ubo:
+         if (nir_src_is_const(intrin->src[0]) &&
+             nir_src_is_const(intrin->src[1]))
+            return 0;
+         return table->load_ubo;
+
+      case nir_intrinsic_load_ssbo:
+      case nir_intrinsic_get_ssbo_size:
+      case nir_intrinsic_image_load:
+      case nir_intrinsic_image_deref_load:
+      case nir_intrinsic_bindless_image_load:
+         return table->load_memory;
+
+      /* Most likely a sysval, which is as cheap as a load_preamble. */
+      default:
+         return 0;
+      }
+   }
+
+   default:
+      return 0;
+   }
+}
+
 static float
 get_instr_cost(nir_instr *instr, const nir_opt_preamble_options *options)
 {
@@ -90,9 +157,21 @@ get_instr_cost(nir_instr *instr, const nir_opt_preamble_options *options)
        instr->type == nir_instr_type_ssa_undef)
       return 0;
 
+   if (!options->instr_cost_cb)
+      return table_instr_cost(instr, options->cost_table);
+
    return options->instr_cost_cb(instr, options->cb_data);
 }
 
+static float
+get_rewrite_cost(nir_ssa_def *def, const nir_opt_preamble_options *options)
+{
+   if (!options->rewrite_cost_cb)
+      return options->cost_table->rewrite * def->num_components;
+
+   return options->rewrite_cost_cb(def, options->cb_data);
+}
+
 static bool
 can_move_src(nir_src *src, void *state)
 {
@@ -285,6 +364,9 @@ avoid_instr(nir_instr *instr, const nir_opt_preamble_options *options)
    if (instr->type == nir_instr_type_deref)
       return true;
 
+   if (!options->avoid_instr_cb)
+      return false;
+
    return options->avoid_instr_cb(instr, options->cb_data);
 }
 
@@ -459,8 +541,7 @@ nir_opt_preamble(nir_shader *shader, const nir_opt_preamble_options *options,
          }
 
          if (state->candidate) {
-            state->benefit = state->value -
-               options->rewrite_cost_cb(def, options->cb_data);
+            state->benefit = state->value - get_rewrite_cost(def, options);
 
             if (state->benefit > 0) {
                options->def_size(def, &state->size, &state->align);
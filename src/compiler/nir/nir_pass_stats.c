@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Per-pass statistics for NIR_PASS and NIR_PASS_V, enabled with
+ * NIR_PASS_STATS=true.
+ *
+ * Each pass invocation records its wall time, the change in the number of
+ * instructions of the shader and the number of bytes the thread allocated
+ * with ralloc while it ran.  Invocations are emitted as perfetto slices
+ * when perfetto is enabled, and a summary per pass name is printed to
+ * stderr when the process exits.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nir.h"
+#include "c11/threads.h"
+#include "util/debug.h"
+#include "util/hash_table.h"
+#include "util/os_time.h"
+#include "util/simple_mtx.h"
+#include "util/u_perfetto.h"
+
+bool nir_pass_stats_enabled = false;
+
+struct nir_pass_summary {
+   const char *name;
+   uint64_t calls;
+   uint64_t time_ns;
+   int64_t instr_delta;
+   uint64_t ralloc_bytes;
+};
+
+static simple_mtx_t summary_mtx = _SIMPLE_MTX_INITIALIZER_NP;
+static struct hash_table *summary_table;
+
+static unsigned
+count_instrs(nir_shader *shader)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(func, shader) {
+      if (!func->impl)
+         continue;
+
+      nir_foreach_block(block, func->impl)
+         count += exec_list_length(&block->instr_list);
+   }
+
+   return count;
+}
+
+static int
+compare_summary_time(const void *a, const void *b)
+{
+   const struct nir_pass_summary *sa = *(const struct nir_pass_summary **)a;
+   const struct nir_pass_summary *sb = *(const struct nir_pass_summary **)b;
+
+   if (sa->time_ns != sb->time_ns)
+      return sa->time_ns < sb->time_ns ? 1 : -1;
+
+   return strcmp(sa->name, sb->name);
+}
+
+static void
+print_summary(void)
+{
+   simple_mtx_lock(&summary_mtx);
+
+   if (!summary_table) {
+      simple_mtx_unlock(&summary_mtx);
+      return;
+   }
+
+   unsigned count = summary_table->entries;
+   struct nir_pass_summary **passes =
+      ralloc_array(summary_table, struct nir_pass_summary *, count);
+   uint64_t total_ns = 0;
+   unsigned i = 0;
+
+   hash_table_foreach(summary_table, entry) {
+      passes[i++] = entry->data;
+      total_ns += ((struct nir_pass_summary *)entry->data)->time_ns;
+   }
+
+   qsort(passes, count, sizeof(*passes), compare_summary_time);
+
+   fprintf(stderr, "NIR pass statistics (%.3f ms total):\n",
+           total_ns / 1000000.0);
+   fprintf(stderr, "%-40s %10s %12s %12s %14s\n",
+           "pass", "calls", "time (ms)", "instr delta", "ralloc (KiB)");
+
+   for (i = 0; i < count; i++) {
+      fprintf(stderr, "%-40s %10" PRIu64 " %12.3f %12" PRId64 " %14.1f\n",
+              passes[i]->name, passes[i]->calls,
+              passes[i]->time_ns / 1000000.0, passes[i]->instr_delta,
+              passes[i]->ralloc_bytes / 1024.0);
+   }
+
+   ralloc_free(summary_table);
+   summary_table = NULL;
+
+   simple_mtx_unlock(&summary_mtx);
+}
+
+static void
+nir_pass_stats_init_once(void)
+{
+   nir_pass_stats_enabled = env_var_as_boolean("NIR_PASS_STATS", false);
+   if (!nir_pass_stats_enabled)
+      return;
+
+   summary_table = _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                           _mesa_key_string_equal);
+   atexit(print_summary);
+}
+
+void
+nir_pass_stats_init(void)
+{
+   static once_flag flag = ONCE_FLAG_INIT;
+   call_once(&flag, nir_pass_stats_init_once);
+}
+
+void
+nir_pass_stats_begin(struct nir_pass_stats *stats, nir_shader *shader,
+                     const char *name)
+{
+   stats->name = name;
+   stats->instr_count = count_instrs(shader);
+   stats->ralloc_bytes = ralloc_thread_allocated_bytes();
+
+   util_perfetto_trace_begin(name);
+
+   /* Sample the clock last so the bookkeeping above isn't counted. */
+   stats->start_ns = os_time_get_nano();
+}
+
+void
+nir_pass_stats_end(struct nir_pass_stats *stats, nir_shader *shader)
+{
+   uint64_t time_ns = os_time_get_nano() - stats->start_ns;
+   uint64_t ralloc_bytes =
+      ralloc_thread_allocated_bytes() - stats->ralloc_bytes;
+
+   util_perfetto_trace_end();
+
+   int64_t instr_delta =
+      (int64_t)count_instrs(shader) - (int64_t)stats->instr_count;
+
+   simple_mtx_lock(&summary_mtx);
+
+   /* The table is gone once the summary has been printed at exit. */
+   if (summary_table) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search(summary_table, stats->name);
+      struct nir_pass_summary *summary;
+
+      if (entry) {
+         summary = entry->data;
+      } else {
+         summary = rzalloc(summary_table, struct nir_pass_summary);
+         summary->name = ralloc_strdup(summary, stats->name);
+         _mesa_hash_table_insert(summary_table, summary->name, summary);
+      }
+
+      summary->calls++;
+      summary->time_ns += time_ns;
+      summary->instr_delta += instr_delta;
+      summary->ralloc_bytes += ralloc_bytes;
+   }
+
+   simple_mtx_unlock(&summary_mtx);
+}
@@ -1736,6 +1736,7 @@ ssa_def_bits_used(const nir_ssa_def *def, int recur)
 
          case nir_op_u2u16:
          case nir_op_i2i16:
+         case nir_op_i2imp:
             bits_used |= all_bits & 0xffff;
             break;
 
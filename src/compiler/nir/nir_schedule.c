@@ -22,6 +22,7 @@
  */
 
 #include "nir_schedule.h"
+#include "util/bitset.h"
 #include "util/dag.h"
 #include "util/u_dynarray.h"
 
@@ -51,6 +52,12 @@
  * work may include doing some local search before locking in a choice, to try
  * to more reliably find the case where just a few choices going against the
  * heuristic can manage to free the whole vector.
+ *
+ * Since the DDG is per block, a texture fetch right after an if can't be
+ * started before it.  With nir_schedule_options::hoist_across_ifs set, such
+ * fetches are first moved to the end of the block before the if, where the
+ * block-level scheduling can start them early and the if covers their
+ * latency.
  */
 
 static bool debug;
@@ -1180,6 +1187,194 @@ nir_schedule_validate_uses(nir_schedule_scoreboard *scoreboard)
    assert(!any_uses);
 }
 
+/* Intrinsics which may write memory, or order memory accesses, which a
+ * texture fetch must not be moved across.
+ */
+static bool
+nir_schedule_is_fetch_barrier(nir_instr *instr)
+{
+   if (instr->type == nir_instr_type_call)
+      return true;
+
+   if (instr->type != nir_instr_type_intrinsic)
+      return false;
+
+   nir_intrinsic_op op = nir_instr_as_intrinsic(instr)->intrinsic;
+   return !(nir_intrinsic_infos[op].flags & NIR_INTRINSIC_CAN_ELIMINATE);
+}
+
+static bool
+nir_schedule_if_has_fetch_barrier(nir_if *nif)
+{
+   nir_foreach_block_in_cf_node(block, &nif->cf_node) {
+      nir_foreach_instr(instr, block) {
+         if (nir_schedule_is_fetch_barrier(instr))
+            return true;
+      }
+   }
+
+   return false;
+}
+
+typedef struct {
+   nir_block *pred;
+   nir_block *merge;
+   unsigned depth;
+} nir_schedule_hoist_state;
+
+static bool nir_schedule_can_hoist_def(nir_ssa_def *def,
+                                       nir_schedule_hoist_state *state);
+
+static bool
+nir_schedule_can_hoist_src(nir_src *src, void *in_state)
+{
+   return src->is_ssa && nir_schedule_can_hoist_def(src->ssa, in_state);
+}
+
+/* Whether def is available at the end of the block before the if, either
+ * already or after moving its defining deref or constant there too.
+ */
+static bool
+nir_schedule_can_hoist_def(nir_ssa_def *def, nir_schedule_hoist_state *state)
+{
+   nir_instr *instr = def->parent_instr;
+
+   if (instr->block != state->merge)
+      return nir_block_dominates(instr->block, state->pred);
+
+   switch (instr->type) {
+   case nir_instr_type_load_const:
+      return true;
+
+   case nir_instr_type_deref: {
+      if (state->depth >= 8)
+         return false;
+
+      state->depth++;
+      bool ok = nir_foreach_src(instr, nir_schedule_can_hoist_src, state);
+      state->depth--;
+      return ok;
+   }
+
+   default:
+      return false;
+   }
+}
+
+static bool
+nir_schedule_hoist_src(nir_src *src, void *in_state)
+{
+   nir_schedule_hoist_state *state = in_state;
+   nir_instr *instr = src->ssa->parent_instr;
+
+   if (instr->block == state->merge) {
+      nir_foreach_src(instr, nir_schedule_hoist_src, state);
+      nir_instr_move(nir_after_block(state->pred), instr);
+   }
+
+   return true;
+}
+
+/* Channels of the SSA defs live into the blocks of the if, at most. */
+static int
+nir_schedule_if_pressure(nir_if *nif, nir_ssa_def **defs, unsigned num_defs)
+{
+   int max_pressure = 0;
+
+   nir_foreach_block_in_cf_node(block, &nif->cf_node) {
+      int pressure = 0;
+      unsigned i;
+      BITSET_FOREACH_SET(i, block->live_in, num_defs) {
+         if (defs[i])
+            pressure += defs[i]->num_components;
+      }
+      max_pressure = MAX2(max_pressure, pressure);
+   }
+
+   return max_pressure;
+}
+
+static bool
+nir_schedule_index_def(nir_ssa_def *def, void *state)
+{
+   nir_ssa_def **defs = state;
+   defs[def->index] = def;
+   return true;
+}
+
+static bool
+nir_schedule_hoist_across_ifs_impl(nir_function_impl *impl,
+                                   const nir_schedule_options *options)
+{
+   bool progress = false;
+
+   nir_ssa_def **defs = calloc(impl->ssa_alloc, sizeof(*defs));
+   if (!defs)
+      return false;
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_ssa_def(instr, nir_schedule_index_def, defs);
+   }
+
+   nir_foreach_block(merge, impl) {
+      nir_cf_node *prev = nir_cf_node_prev(&merge->cf_node);
+      if (!prev || prev->type != nir_cf_node_if)
+         continue;
+
+      nir_if *nif = nir_cf_node_as_if(prev);
+      if (!nir_if_falls_through(nif) ||
+          nir_schedule_if_has_fetch_barrier(nif))
+         continue;
+
+      nir_metadata_require(impl, nir_metadata_dominance |
+                                 nir_metadata_live_ssa_defs);
+
+      nir_schedule_hoist_state state = {
+         .pred = nir_cf_node_as_block(nir_cf_node_prev(&nif->cf_node)),
+         .merge = merge,
+      };
+      int pressure = nir_schedule_if_pressure(nif, defs, impl->ssa_alloc);
+      bool hoisted = false;
+
+      nir_foreach_instr_safe(instr, merge) {
+         if (nir_schedule_is_fetch_barrier(instr))
+            break;
+
+         if (instr->type != nir_instr_type_tex)
+            continue;
+
+         nir_tex_instr *tex = nir_instr_as_tex(instr);
+         if (!tex->dest.is_ssa)
+            continue;
+
+         /* The fetch result stays live across the whole if. */
+         int channels = tex->dest.ssa.num_components;
+         if (options->threshold && pressure + channels > options->threshold)
+            break;
+
+         if (!nir_foreach_src(instr, nir_schedule_can_hoist_src, &state))
+            continue;
+
+         nir_foreach_src(instr, nir_schedule_hoist_src, &state);
+         nir_instr_move(nir_after_block(state.pred), instr);
+
+         pressure += channels;
+         hoisted = true;
+      }
+
+      if (hoisted) {
+         nir_metadata_preserve(impl, nir_metadata_block_index |
+                                     nir_metadata_dominance);
+         progress = true;
+      }
+   }
+
+   free(defs);
+
+   return progress;
+}
+
 /**
  * Schedules the NIR instructions to try to decrease stalls (for example,
  * delaying texture reads) while managing register pressure.
@@ -1197,6 +1392,13 @@ void
 nir_schedule(nir_shader *shader,
              const nir_schedule_options *options)
 {
+   if (options->hoist_across_ifs) {
+      nir_foreach_function(function, shader) {
+         if (function->impl)
+            nir_schedule_hoist_across_ifs_impl(function->impl, options);
+      }
+   }
+
    nir_schedule_scoreboard *scoreboard = nir_schedule_get_scoreboard(shader,
                                                                      options);
 
@@ -81,6 +81,13 @@ typedef struct nir_schedule_options {
    /* Data to pass to the instruction delay callback */
    void *instr_delay_cb_data;
 
+   /* If set, texture fetches in the block following an if are moved before
+    * the if when their sources are available there, if the channels live
+    * across the if stay below the threshold.  The block-level scheduling
+    * can then hide their latency behind the if.
+    */
+   bool hoist_across_ifs;
+
 } nir_schedule_options;
 
 void nir_schedule(nir_shader *shader, const nir_schedule_options *options);
@@ -38,6 +38,8 @@ struct match_state {
    bool inexact_match;
    bool has_exact_alu;
    uint8_t comm_op_direction;
+   /* Commutative expressions whose direction the current match looked at. */
+   uint8_t comm_op_visited;
    unsigned variables_seen;
 
    /* Used for running the automaton on newly-constructed instructions. */
@@ -315,14 +317,17 @@ match_value(const nir_algebraic_table *table,
              instr->src[src].src.ssa->parent_instr->type != nir_instr_type_load_const)
             return false;
 
-         if (var->cond_index != -1 && !table->variable_cond[var->cond_index](state->range_ht, instr,
-                                                                             src, num_components, new_swizzle))
-            return false;
-
+         /* Check the type first, as the conditions may need range
+          * analysis, which is much more expensive.
+          */
          if (var->type != nir_type_invalid &&
              !src_is_type(instr->src[src].src, var->type))
             return false;
 
+         if (var->cond_index != -1 && !table->variable_cond[var->cond_index](state->range_ht, instr,
+                                                                             src, num_components, new_swizzle))
+            return false;
+
          state->variables_seen |= (1 << var->variable);
          state->variables[var->variable].src = instr->src[src].src;
          state->variables[var->variable].abs = false;
@@ -432,10 +437,12 @@ match_expression(const nir_algebraic_table *table, const nir_search_expression *
     * up its direction for the current search operation.  We'll use that value
     * to possibly flip the sources for the match.
     */
-   unsigned comm_op_flip =
-      (expr->comm_expr_idx >= 0 &&
-       expr->comm_expr_idx < NIR_SEARCH_MAX_COMM_OPS) ?
-      ((state->comm_op_direction >> expr->comm_expr_idx) & 1) : 0;
+   unsigned comm_op_flip = 0;
+   if (expr->comm_expr_idx >= 0 &&
+       expr->comm_expr_idx < NIR_SEARCH_MAX_COMM_OPS) {
+      comm_op_flip = (state->comm_op_direction >> expr->comm_expr_idx) & 1;
+      state->comm_op_visited |= 1 << expr->comm_expr_idx;
+   }
 
    bool matched = true;
    for (unsigned i = 0; i < nir_op_infos[instr->op].num_inputs; i++) {
@@ -713,12 +720,33 @@ nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
    unsigned comm_expr_combinations =
       1 << MIN2(search->comm_exprs, NIR_SEARCH_MAX_COMM_OPS);
 
+   /* A match that failed only depends on the directions of the commutative
+    * expressions it reached, so any combination that agrees with it on those
+    * directions fails the same way and can be skipped.  Most failures happen
+    * before most of the commutative expressions are reached, which saves
+    * trying all 2^comm_exprs combinations.
+    */
+   uint8_t failed_visited[1 << NIR_SEARCH_MAX_COMM_OPS];
+   uint8_t failed_direction[1 << NIR_SEARCH_MAX_COMM_OPS];
+   unsigned num_failed = 0;
+
    bool found = false;
    for (unsigned comb = 0; comb < comm_expr_combinations; comb++) {
+      bool known_failure = false;
+      for (unsigned i = 0; i < num_failed; i++) {
+         if ((comb & failed_visited[i]) == failed_direction[i]) {
+            known_failure = true;
+            break;
+         }
+      }
+      if (known_failure)
+         continue;
+
       /* The bitfield of directions is just the current iteration.  Hooray for
        * binary.
        */
       state.comm_op_direction = comb;
+      state.comm_op_visited = 0;
       state.variables_seen = 0;
 
       if (match_expression(table, search, instr,
@@ -727,6 +755,10 @@ nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
          found = true;
          break;
       }
+
+      failed_visited[num_failed] = state.comm_op_visited;
+      failed_direction[num_failed] = comb & state.comm_op_visited;
+      num_failed++;
    }
    if (!found)
       return NULL;
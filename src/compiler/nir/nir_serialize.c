@@ -29,6 +29,13 @@
 #define NIR_SERIALIZE_FUNC_HAS_IMPL ((void *)(intptr_t)1)
 #define MAX_OBJECT_IDS (1 << 20)
 
+/* Types which were already written are referred to by their index in the
+ * type table.  A reference is told apart from an encoded type by using a
+ * base type which encode_type_to_blob() never writes in the low bits.
+ */
+#define TYPE_REF_BASE_TYPE 0x1f
+#define TYPE_REF_INDEX_SHIFT 5
+
 typedef struct {
    size_t blob_offset;
    nir_ssa_def *src;
@@ -56,6 +63,12 @@ typedef struct {
    const struct glsl_type *last_interface_type;
    struct nir_variable_data last_var_data;
 
+   /* Maps types and strings already written to their index in the order
+    * they were written.
+    */
+   struct hash_table *type_table;
+   struct hash_table *string_table;
+
    /* For skipping equal ALU headers (typical after scalarization). */
    nir_instr_type last_instr_type;
    uintptr_t last_alu_header_offset;
@@ -86,6 +99,10 @@ typedef struct {
    const struct glsl_type *last_type;
    const struct glsl_type *last_interface_type;
    struct nir_variable_data last_var_data;
+
+   /* Types and strings read so far, in the order they were read. */
+   struct util_dynarray types;
+   struct util_dynarray strings;
 } read_ctx;
 
 static void
@@ -124,6 +141,88 @@ read_object(read_ctx *ctx)
    return read_lookup_object(ctx, blob_read_uint32(ctx->blob));
 }
 
+static void
+write_type(write_ctx *ctx, const struct glsl_type *type)
+{
+   if (!type) {
+      encode_type_to_blob(ctx->blob, NULL);
+      return;
+   }
+
+   struct hash_entry *entry = _mesa_hash_table_search(ctx->type_table, type);
+   if (entry) {
+      uint32_t index = (uintptr_t)entry->data;
+      blob_write_uint32(ctx->blob, TYPE_REF_BASE_TYPE |
+                                   (index << TYPE_REF_INDEX_SHIFT));
+      return;
+   }
+
+   uint32_t index = ctx->type_table->entries;
+   assert(index < (1u << (32 - TYPE_REF_INDEX_SHIFT)));
+   _mesa_hash_table_insert(ctx->type_table, type, (void *)(uintptr_t)index);
+   encode_type_to_blob(ctx->blob, type);
+}
+
+static const struct glsl_type *
+read_type(read_ctx *ctx)
+{
+   STATIC_ASSERT(GLSL_TYPE_ERROR < TYPE_REF_BASE_TYPE);
+
+   /* Peek at the first dword to see whether this is a reference. */
+   struct blob_reader peek = *ctx->blob;
+   uint32_t encoded = blob_read_uint32(&peek);
+
+   if ((encoded & TYPE_REF_BASE_TYPE) == TYPE_REF_BASE_TYPE) {
+      *ctx->blob = peek;
+      uint32_t index = encoded >> TYPE_REF_INDEX_SHIFT;
+      return *util_dynarray_element(&ctx->types, const struct glsl_type *,
+                                    index);
+   }
+
+   const struct glsl_type *type = decode_type_from_blob(ctx->blob);
+   if (type)
+      util_dynarray_append(&ctx->types, const struct glsl_type *, type);
+
+   return type;
+}
+
+/* Returns the index the string was written with before or -1 after adding
+ * it to the table.
+ */
+static int
+intern_string(write_ctx *ctx, const char *str)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(ctx->string_table, str);
+   if (entry)
+      return (uintptr_t)entry->data;
+
+   _mesa_hash_table_insert(ctx->string_table, str,
+                           (void *)(uintptr_t)ctx->string_table->entries);
+   return -1;
+}
+
+static void
+write_string(write_ctx *ctx, const char *str, int index)
+{
+   if (index >= 0)
+      blob_write_uint32(ctx->blob, index);
+   else
+      blob_write_string(ctx->blob, str);
+}
+
+static char *
+read_string(read_ctx *ctx, bool interned)
+{
+   if (interned) {
+      uint32_t index = blob_read_uint32(ctx->blob);
+      return *util_dynarray_element(&ctx->strings, char *, index);
+   }
+
+   char *str = blob_read_string(ctx->blob);
+   util_dynarray_append(&ctx->strings, char *, str);
+   return str;
+}
+
 static uint32_t
 encode_bit_size_3bits(uint8_t bit_size)
 {
@@ -213,7 +312,7 @@ union packed_var {
       unsigned data_encoding:2;
       unsigned type_same_as_last:1;
       unsigned interface_type_same_as_last:1;
-      unsigned _pad:1;
+      unsigned name_interned:1;
       unsigned num_members:16;
    } u;
 };
@@ -248,6 +347,9 @@ write_variable(write_ctx *ctx, const nir_variable *var)
    flags.u.num_state_slots = var->num_state_slots;
    flags.u.num_members = var->num_members;
 
+   int name_index = flags.u.has_name ? intern_string(ctx, var->name) : -1;
+   flags.u.name_interned = name_index >= 0;
+
    struct nir_variable_data data = var->data;
 
    /* When stripping, we expect that the location is no longer needed,
@@ -287,17 +389,17 @@ write_variable(write_ctx *ctx, const nir_variable *var)
    blob_write_uint32(ctx->blob, flags.u32);
 
    if (!flags.u.type_same_as_last) {
-      encode_type_to_blob(ctx->blob, var->type);
+      write_type(ctx, var->type);
       ctx->last_type = var->type;
    }
 
    if (var->interface_type && !flags.u.interface_type_same_as_last) {
-      encode_type_to_blob(ctx->blob, var->interface_type);
+      write_type(ctx, var->interface_type);
       ctx->last_interface_type = var->interface_type;
    }
 
    if (flags.u.has_name)
-      blob_write_string(ctx->blob, var->name);
+      write_string(ctx, var->name, name_index);
 
    if (flags.u.data_encoding == var_encode_full ||
        flags.u.data_encoding == var_encode_location_diff) {
@@ -346,7 +448,7 @@ read_variable(read_ctx *ctx)
    if (flags.u.type_same_as_last) {
       var->type = ctx->last_type;
    } else {
-      var->type = decode_type_from_blob(ctx->blob);
+      var->type = read_type(ctx);
       ctx->last_type = var->type;
    }
 
@@ -354,13 +456,13 @@ read_variable(read_ctx *ctx)
       if (flags.u.interface_type_same_as_last) {
          var->interface_type = ctx->last_interface_type;
       } else {
-         var->interface_type = decode_type_from_blob(ctx->blob);
+         var->interface_type = read_type(ctx);
          ctx->last_interface_type = var->interface_type;
       }
    }
 
    if (flags.u.has_name) {
-      const char *name = blob_read_string(ctx->blob);
+      const char *name = read_string(ctx, flags.u.name_interned);
       var->name = ralloc_strdup(var, name);
    } else {
       var->name = NULL;
@@ -1072,7 +1174,7 @@ write_deref(write_ctx *ctx, const nir_deref_instr *deref)
       blob_write_uint32(ctx->blob, deref->cast.align_mul);
       blob_write_uint32(ctx->blob, deref->cast.align_offset);
       if (!header.deref.cast_type_same_as_last) {
-         encode_type_to_blob(ctx->blob, deref->type);
+         write_type(ctx, deref->type);
          ctx->last_type = deref->type;
       }
       break;
@@ -1140,7 +1242,7 @@ read_deref(read_ctx *ctx, union packed_instr header)
       if (header.deref.cast_type_same_as_last) {
          deref->type = ctx->last_type;
       } else {
-         deref->type = decode_type_from_blob(ctx->blob);
+         deref->type = read_type(ctx);
          ctx->last_type = deref->type;
       }
       break;
@@ -1995,6 +2097,8 @@ read_function_impl(read_ctx *ctx, nir_function *fxn)
 static void
 write_function(write_ctx *ctx, const nir_function *fxn)
 {
+   int name_index = fxn->name ? intern_string(ctx, fxn->name) : -1;
+
    uint32_t flags = 0;
    if (fxn->is_entrypoint)
       flags |= 0x1;
@@ -2004,9 +2108,11 @@ write_function(write_ctx *ctx, const nir_function *fxn)
       flags |= 0x4;
    if (fxn->impl)
       flags |= 0x8;
+   if (name_index >= 0)
+      flags |= 0x10;
    blob_write_uint32(ctx->blob, flags);
    if (fxn->name)
-      blob_write_string(ctx->blob, fxn->name);
+      write_string(ctx, fxn->name, name_index);
 
    write_add_object(ctx, fxn);
 
@@ -2030,7 +2136,7 @@ read_function(read_ctx *ctx)
 {
    uint32_t flags = blob_read_uint32(ctx->blob);
    bool has_name = flags & 0x4;
-   char *name = has_name ? blob_read_string(ctx->blob) : NULL;
+   char *name = has_name ? read_string(ctx, flags & 0x10) : NULL;
 
    nir_function *fxn = nir_function_create(ctx->nir, name);
 
@@ -2062,6 +2168,9 @@ nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
 {
    write_ctx ctx = {0};
    ctx.remap_table = _mesa_pointer_hash_table_create(NULL);
+   ctx.type_table = _mesa_pointer_hash_table_create(NULL);
+   ctx.string_table = _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                              _mesa_key_string_equal);
    ctx.blob = blob;
    ctx.nir = nir;
    ctx.strip = strip;
@@ -2107,6 +2216,8 @@ nir_serialize(struct blob *blob, const nir_shader *nir, bool strip)
    blob_overwrite_uint32(blob, idx_size_offset, ctx.next_idx);
 
    _mesa_hash_table_destroy(ctx.remap_table, NULL);
+   _mesa_hash_table_destroy(ctx.type_table, NULL);
+   _mesa_hash_table_destroy(ctx.string_table, NULL);
    util_dynarray_fini(&ctx.phi_fixups);
 }
 
@@ -2118,6 +2229,8 @@ nir_deserialize(void *mem_ctx,
    read_ctx ctx = {0};
    ctx.blob = blob;
    list_inithead(&ctx.phi_srcs);
+   util_dynarray_init(&ctx.types, NULL);
+   util_dynarray_init(&ctx.strings, NULL);
    ctx.idx_table_len = blob_read_uint32(blob);
    ctx.idx_table = calloc(ctx.idx_table_len, sizeof(uintptr_t));
 
@@ -2160,6 +2273,8 @@ nir_deserialize(void *mem_ctx,
    }
 
    free(ctx.idx_table);
+   util_dynarray_fini(&ctx.types);
+   util_dynarray_fini(&ctx.strings);
 
    nir_validate_shader(ctx.nir, "after deserialize");
 
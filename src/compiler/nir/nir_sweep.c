@@ -162,6 +162,8 @@ nir_sweep(nir_shader *nir)
    }
    assert(list_is_empty(&instr_gc_list));
 
+   nir_shader_trim_instr_pool(nir);
+
    ralloc_steal(nir, nir->constant_data);
    ralloc_steal(nir, nir->printf_info);
    for (int i = 0; i < nir->printf_info_count; i++) {
@@ -80,6 +80,7 @@ protected:
    std::string swizzle(nir_alu_instr *instr, int src);
 
    nir_builder *b, _b;
+   bool hoist_across_ifs;
    std::map<unsigned, nir_alu_instr*> movs;
    std::map<unsigned, nir_alu_src*> loads;
    std::map<unsigned, nir_ssa_def*> res_map;
@@ -92,6 +93,7 @@ nir_load_store_vectorize_test::nir_load_store_vectorize_test()
    static const nir_shader_compiler_options options = { };
    _b = nir_builder_init_simple_shader(MESA_SHADER_COMPUTE, &options, "load store tests");
    b = &_b;
+   hoist_across_ifs = false;
 }
 
 nir_load_store_vectorize_test::~nir_load_store_vectorize_test()
@@ -164,6 +166,7 @@ nir_load_store_vectorize_test::run_vectorizer(nir_variable_mode modes,
    opts.callback = mem_vectorize_callback;
    opts.modes = modes;
    opts.robust_modes = robust_modes;
+   opts.hoist_across_ifs = hoist_across_ifs;
    bool progress = nir_opt_load_store_vectorize(b->shader, &opts);
 
    if (progress) {
@@ -926,6 +929,64 @@ TEST_F(nir_load_store_vectorize_test, ssbo_load_adjacent_demote)
    ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 1);
 }
 
+TEST_F(nir_load_store_vectorize_test, ssbo_load_adjacent_across_if)
+{
+   create_load(nir_var_mem_ssbo, 0, 0, 0x1);
+   nir_push_if(b, nir_imm_true(b));
+   create_load(nir_var_mem_ubo, 0, 0, 0x2);
+   nir_pop_if(b, NULL);
+   create_load(nir_var_mem_ssbo, 0, 4, 0x3);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 2);
+
+   hoist_across_ifs = true;
+   EXPECT_TRUE(run_vectorizer(nir_var_mem_ssbo));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 1);
+
+   nir_intrinsic_instr *load = get_intrinsic(nir_intrinsic_load_ssbo, 0);
+   ASSERT_EQ(load->dest.ssa.num_components, 2);
+   EXPECT_INSTR_SWIZZLES(movs[0x1], load, "x");
+   EXPECT_INSTR_SWIZZLES(movs[0x3], load, "y");
+}
+
+TEST_F(nir_load_store_vectorize_test, ssbo_load_adjacent_across_if_store)
+{
+   create_load(nir_var_mem_ssbo, 0, 0, 0x1);
+   nir_push_if(b, nir_imm_true(b));
+   create_store(nir_var_mem_ssbo, 0, 4, 0x2);
+   nir_pop_if(b, NULL);
+   create_load(nir_var_mem_ssbo, 0, 4, 0x3);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 2);
+
+   hoist_across_ifs = true;
+   EXPECT_FALSE(run_vectorizer(nir_var_mem_ssbo));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 2);
+}
+
+TEST_F(nir_load_store_vectorize_test, ssbo_load_adjacent_across_if_break)
+{
+   nir_loop *loop = nir_push_loop(b);
+   create_load(nir_var_mem_ssbo, 0, 0, 0x1);
+   nir_push_if(b, nir_imm_true(b));
+   nir_jump(b, nir_jump_break);
+   nir_pop_if(b, NULL);
+   create_load(nir_var_mem_ssbo, 0, 4, 0x2);
+   nir_pop_loop(b, loop);
+
+   nir_validate_shader(b->shader, NULL);
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 2);
+
+   hoist_across_ifs = true;
+   EXPECT_FALSE(run_vectorizer(nir_var_mem_ssbo));
+
+   ASSERT_EQ(count_intrinsics(nir_intrinsic_load_ssbo), 2);
+}
+
 TEST_F(nir_load_store_vectorize_test, ssbo_load_adjacent_8_8_16)
 {
    create_load(nir_var_mem_ssbo, 0, 0, 0x1, 8);
@@ -279,3 +279,27 @@ TEST_P(nir_serialize_all_but_one_test, single_channel)
 
    ASSERT_SWIZZLE_EQ(vec_alu, vec_alu_dup, 1, 0);
 }
+
+TEST_P(nir_serialize_all_test, repeated_types_and_names)
+{
+   const glsl_struct_field fields[] = {
+      glsl_struct_field(glsl_vector_type(GLSL_TYPE_FLOAT, GetParam()), "a"),
+      glsl_struct_field(glsl_uint_type(), "b"),
+   };
+   const glsl_type *s = glsl_struct_type(fields, ARRAY_SIZE(fields), "s", false);
+
+   /* Alternate the types so that only the type table catches repeats. */
+   for (unsigned i = 0; i < 4; i++) {
+      nir_variable_create(b->shader, nir_var_shader_temp, s, "v");
+      nir_variable_create(b->shader, nir_var_shader_temp, glsl_int_type(), "v");
+   }
+
+   serialize();
+
+   unsigned i = 0;
+   nir_foreach_variable_in_shader(var, dup) {
+      ASSERT_EQ(var->type, (i++ % 2) ? glsl_int_type() : s);
+      ASSERT_STREQ(var->name, "v");
+   }
+   ASSERT_EQ(i, 8u);
+}
@@ -6542,8 +6542,15 @@ spirv_to_nir(const uint32_t *words, size_t word_count,
       b->shader->info.workgroup_size[2] = const_size[2].u32;
    }
 
+   /* Find the functions reachable from the entry point so that the passes
+    * below can skip the others.  Libraries keep every function.
+    */
+   if (!options->create_library)
+      vtn_find_live_functions(b, words, word_end);
+
    /* Set types on all vtn_values */
-   vtn_foreach_instruction(b, words, word_end, vtn_set_instruction_result_type);
+   vtn_foreach_instruction(b, words, word_end,
+                           vtn_set_live_instruction_result_type);
 
    vtn_build_cfg(b, words, word_end);
 
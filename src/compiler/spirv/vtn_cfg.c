@@ -171,6 +171,129 @@ function_decoration_cb(struct vtn_builder *b, struct vtn_value *val, int member,
    }
 }
 
+static bool
+vtn_function_is_live(struct vtn_builder *b, uint32_t id)
+{
+   return b->live_functions == NULL || BITSET_TEST(b->live_functions, id);
+}
+
+struct vtn_call_graph_node {
+   uint32_t id;
+   unsigned first_call;
+   unsigned num_calls;
+};
+
+/* Walk the call graph from the entry point to find the functions which can
+ * be reached from it.  Only the OpFunction and OpFunctionCall words are
+ * looked at, so this is cheap compared to the passes it lets skip the rest
+ * of the functions in.
+ */
+void
+vtn_find_live_functions(struct vtn_builder *b, const uint32_t *words,
+                        const uint32_t *end)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   struct util_dynarray nodes, calls;
+   util_dynarray_init(&nodes, mem_ctx);
+   util_dynarray_init(&calls, mem_ctx);
+
+   /* Index of each function's node plus one, by id. */
+   unsigned *node_index = rzalloc_array(mem_ctx, unsigned, b->value_id_bound);
+   struct vtn_call_graph_node *node = NULL;
+
+   for (const uint32_t *w = words; w < end; ) {
+      SpvOp opcode = w[0] & SpvOpCodeMask;
+      unsigned count = w[0] >> SpvWordCountShift;
+      vtn_fail_if(count < 1 || w + count > end, "Malformed instruction");
+
+      switch (opcode) {
+      case SpvOpFunction:
+         vtn_fail_if(count < 3 || w[2] >= b->value_id_bound,
+                     "Malformed OpFunction");
+         util_dynarray_append(&nodes, struct vtn_call_graph_node,
+                              ((struct vtn_call_graph_node) {
+                                 .id = w[2],
+                                 .first_call = util_dynarray_num_elements(&calls, uint32_t),
+                              }));
+         node_index[w[2]] =
+            util_dynarray_num_elements(&nodes, struct vtn_call_graph_node);
+         node = util_dynarray_top_ptr(&nodes, struct vtn_call_graph_node);
+         break;
+
+      case SpvOpFunctionCall:
+         vtn_fail_if(node == NULL || count < 4 || w[3] >= b->value_id_bound,
+                     "Malformed OpFunctionCall");
+         util_dynarray_append(&calls, uint32_t, w[3]);
+         node->num_calls++;
+         break;
+
+      case SpvOpFunctionEnd:
+         node = NULL;
+         break;
+
+      default:
+         break;
+      }
+
+      w += count;
+   }
+
+   b->live_functions = rzalloc_array(b, BITSET_WORD,
+                                     BITSET_WORDS(b->value_id_bound));
+
+   struct vtn_call_graph_node *all_nodes = nodes.data;
+   uint32_t *all_calls = calls.data;
+   struct util_dynarray worklist;
+   util_dynarray_init(&worklist, mem_ctx);
+
+   uint32_t entry_id = b->entry_point - b->values;
+   BITSET_SET(b->live_functions, entry_id);
+   util_dynarray_append(&worklist, uint32_t, entry_id);
+
+   while (util_dynarray_num_elements(&worklist, uint32_t)) {
+      uint32_t id = util_dynarray_pop(&worklist, uint32_t);
+      if (node_index[id] == 0)
+         continue;
+
+      const struct vtn_call_graph_node *caller = &all_nodes[node_index[id] - 1];
+      for (unsigned i = 0; i < caller->num_calls; i++) {
+         uint32_t callee = all_calls[caller->first_call + i];
+         if (!BITSET_TEST(b->live_functions, callee)) {
+            BITSET_SET(b->live_functions, callee);
+            util_dynarray_append(&worklist, uint32_t, callee);
+         }
+      }
+   }
+
+   ralloc_free(mem_ctx);
+}
+
+/* Like vtn_set_instruction_result_type() but skips the bodies of functions
+ * which can't be reached from the entry point.  The function and its
+ * parameters are still typed since the CFG prepass creates those.
+ */
+bool
+vtn_set_live_instruction_result_type(struct vtn_builder *b, SpvOp opcode,
+                                     const uint32_t *w, unsigned count)
+{
+   switch (opcode) {
+   case SpvOpFunction:
+      b->func_is_dead = !vtn_function_is_live(b, w[2]);
+      break;
+   case SpvOpFunctionParameter:
+      break;
+   case SpvOpFunctionEnd:
+      b->func_is_dead = false;
+      return true;
+   default:
+      if (b->func_is_dead)
+         return true;
+      break;
+   }
+
+   return vtn_set_instruction_result_type(b, opcode, w, count);
+}
+
 static bool
 vtn_cfg_handle_prepass_instruction(struct vtn_builder *b, SpvOp opcode,
                                    const uint32_t *w, unsigned count)
@@ -193,6 +316,8 @@ vtn_cfg_handle_prepass_instruction(struct vtn_builder *b, SpvOp opcode,
       vtn_foreach_decoration(b, val, function_decoration_cb, b->func);
 
       b->func->type = vtn_get_type(b, w[4]);
+      b->func->referenced = b->live_functions &&
+                            BITSET_TEST(b->live_functions, w[2]);
       const struct vtn_type *func_type = b->func->type;
 
       vtn_assert(func_type->return_type->type == result_type);
@@ -875,6 +1000,10 @@ vtn_build_cfg(struct vtn_builder *b, const uint32_t *words, const uint32_t *end)
    vtn_foreach_cf_node(func_node, &b->functions) {
       struct vtn_function *func = vtn_cf_node_as_function(func_node);
 
+      /* Functions the entry point can't reach are never emitted. */
+      if (b->live_functions && !func->referenced)
+         continue;
+
       /* We build the CFG for each function by doing a breadth-first search on
        * the control-flow graph.  We keep track of our state using a worklist.
        * Doing a BFS ensures that we visit each structured control-flow
@@ -32,6 +32,7 @@
 
 #include "nir/nir.h"
 #include "nir/nir_builder.h"
+#include "util/bitset.h"
 #include "util/u_dynarray.h"
 #include "nir_spirv.h"
 #include "spirv.h"
@@ -299,6 +300,10 @@ VTN_DECL_CF_NODE_CAST(function)
 typedef bool (*vtn_instruction_handler)(struct vtn_builder *, SpvOp,
                                         const uint32_t *, unsigned);
 
+void vtn_find_live_functions(struct vtn_builder *b, const uint32_t *words,
+                             const uint32_t *end);
+bool vtn_set_live_instruction_result_type(struct vtn_builder *b, SpvOp opcode,
+                                          const uint32_t *w, unsigned count);
 void vtn_build_cfg(struct vtn_builder *b, const uint32_t *words,
                    const uint32_t *end);
 void vtn_function_emit(struct vtn_builder *b, struct vtn_function *func,
@@ -732,6 +737,16 @@ struct vtn_builder {
    struct vtn_function *func;
    struct list_head functions;
 
+   /* Ids of the functions reachable from the entry point, or NULL if every
+    * function is kept.  See vtn_find_live_functions().
+    */
+   BITSET_WORD *live_functions;
+
+   /* Whether vtn_set_live_instruction_result_type() is in a function which
+    * isn't live.
+    */
+   bool func_is_dead;
+
    /* Current function parameter index */
    unsigned func_param_idx;
 
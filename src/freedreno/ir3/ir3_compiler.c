@@ -172,6 +172,11 @@ static const nir_shader_compiler_options nir_options_a6xx = {
    .has_fsub = true,
    .has_isub = true,
    .max_unroll_iterations = 32,
+   /* Loops with known trip counts that load or sample with non-constant
+    * coordinates are unrolled further, so that ir3_sched can issue the
+    * samples of later iterations while the ALU of earlier ones runs.
+    */
+   .max_unroll_iterations_aggressive = 64,
    .force_indirect_unrolling = nir_var_all,
    .force_indirect_unrolling_sampler = true,
    .lower_wpos_pntc = true,
@@ -69,6 +69,14 @@ ir3_nir_should_vectorize_mem(unsigned align_mul, unsigned align_offset,
 
 #define OPT_V(nir, pass, ...) NIR_PASS_V(nir, pass, ##__VA_ARGS__)
 
+/* Same as OPT, for fixed-point loops with a "skip" set, see NIR_LOOP_PASS. */
+#define LOOP_OPT(nir, pass, ...)                                               \
+   ({                                                                          \
+      bool this_progress = false;                                              \
+      NIR_LOOP_PASS(this_progress, skip, nir, pass, ##__VA_ARGS__);            \
+      this_progress;                                                           \
+   })
+
 void
 ir3_optimize_loop(struct ir3_compiler *compiler, nir_shader *s)
 {
@@ -76,32 +84,33 @@ ir3_optimize_loop(struct ir3_compiler *compiler, nir_shader *s)
    unsigned lower_flrp = (s->options->lower_flrp16 ? 16 : 0) |
                          (s->options->lower_flrp32 ? 32 : 0) |
                          (s->options->lower_flrp64 ? 64 : 0);
+   struct set *skip = _mesa_pointer_set_create(NULL);
 
    do {
       progress = false;
 
-      OPT_V(s, nir_lower_vars_to_ssa);
-      progress |= OPT(s, nir_lower_alu_to_scalar, NULL, NULL);
-      progress |= OPT(s, nir_lower_phis_to_scalar, false);
+      LOOP_OPT(s, nir_lower_vars_to_ssa);
+      progress |= LOOP_OPT(s, nir_lower_alu_to_scalar, NULL, NULL);
+      progress |= LOOP_OPT(s, nir_lower_phis_to_scalar, false);
 
-      progress |= OPT(s, nir_copy_prop);
-      progress |= OPT(s, nir_opt_deref);
-      progress |= OPT(s, nir_opt_dce);
-      progress |= OPT(s, nir_opt_cse);
+      progress |= LOOP_OPT(s, nir_copy_prop);
+      progress |= LOOP_OPT(s, nir_opt_deref);
+      progress |= LOOP_OPT(s, nir_opt_dce);
+      progress |= LOOP_OPT(s, nir_opt_cse);
 
-      progress |= OPT(s, nir_opt_find_array_copies);
-      progress |= OPT(s, nir_opt_copy_prop_vars);
-      progress |= OPT(s, nir_opt_dead_write_vars);
+      progress |= LOOP_OPT(s, nir_opt_find_array_copies);
+      progress |= LOOP_OPT(s, nir_opt_copy_prop_vars);
+      progress |= LOOP_OPT(s, nir_opt_dead_write_vars);
 
       static int gcm = -1;
       if (gcm == -1)
          gcm = env_var_as_unsigned("GCM", 0);
       if (gcm == 1)
-         progress |= OPT(s, nir_opt_gcm, true);
+         progress |= LOOP_OPT(s, nir_opt_gcm, true);
       else if (gcm == 2)
-         progress |= OPT(s, nir_opt_gcm, false);
-      progress |= OPT(s, nir_opt_peephole_select, 16, true, true);
-      progress |= OPT(s, nir_opt_intrinsics);
+         progress |= LOOP_OPT(s, nir_opt_gcm, false);
+      progress |= LOOP_OPT(s, nir_opt_peephole_select, 16, true, true);
+      progress |= LOOP_OPT(s, nir_opt_intrinsics);
       /* NOTE: GS lowering inserts an output var with varying slot that
        * is larger than VARYING_SLOT_MAX (ie. GS_VERTEX_FLAGS_IR3),
        * which triggers asserts in nir_shader_gather_info().  To work
@@ -115,12 +124,12 @@ ir3_optimize_loop(struct ir3_compiler *compiler, nir_shader *s)
       if ((s->info.stage == MESA_SHADER_FRAGMENT) ||
           (s->info.stage == MESA_SHADER_COMPUTE) ||
           (s->info.stage == MESA_SHADER_KERNEL)) {
-         progress |= OPT(s, nir_opt_phi_precision);
+         progress |= LOOP_OPT(s, nir_opt_phi_precision);
       }
-      progress |= OPT(s, nir_opt_algebraic);
-      progress |= OPT(s, nir_lower_alu);
-      progress |= OPT(s, nir_lower_pack);
-      progress |= OPT(s, nir_opt_constant_folding);
+      progress |= LOOP_OPT(s, nir_opt_algebraic);
+      progress |= LOOP_OPT(s, nir_lower_alu);
+      progress |= LOOP_OPT(s, nir_lower_pack);
+      progress |= LOOP_OPT(s, nir_opt_constant_folding);
 
       static const nir_opt_offsets_options offset_options = {
          /* How large an offset we can encode in the instr's immediate field.
@@ -131,18 +140,18 @@ ir3_optimize_loop(struct ir3_compiler *compiler, nir_shader *s)
 
          .buffer_max = ~0,
       };
-      progress |= OPT(s, nir_opt_offsets, &offset_options);
+      progress |= LOOP_OPT(s, nir_opt_offsets, &offset_options);
 
       nir_load_store_vectorize_options vectorize_opts = {
          .modes = nir_var_mem_ubo,
          .callback = ir3_nir_should_vectorize_mem,
          .robust_modes = compiler->robust_ubo_access ? nir_var_mem_ubo : 0,
       };
-      progress |= OPT(s, nir_opt_load_store_vectorize, &vectorize_opts);
+      progress |= LOOP_OPT(s, nir_opt_load_store_vectorize, &vectorize_opts);
 
       if (lower_flrp != 0) {
-         if (OPT(s, nir_lower_flrp, lower_flrp, false /* always_precise */)) {
-            OPT(s, nir_opt_constant_folding);
+         if (LOOP_OPT(s, nir_lower_flrp, lower_flrp, false /* always_precise */)) {
+            LOOP_OPT(s, nir_opt_constant_folding);
             progress = true;
          }
 
@@ -152,22 +161,23 @@ ir3_optimize_loop(struct ir3_compiler *compiler, nir_shader *s)
          lower_flrp = 0;
       }
 
-      progress |= OPT(s, nir_opt_dead_cf);
-      if (OPT(s, nir_opt_trivial_continues)) {
+      progress |= LOOP_OPT(s, nir_opt_dead_cf);
+      if (LOOP_OPT(s, nir_opt_trivial_continues)) {
          progress |= true;
          /* If nir_opt_trivial_continues makes progress, then we need to clean
           * things up if we want any hope of nir_opt_if or nir_opt_loop_unroll
           * to make progress.
           */
-         OPT(s, nir_copy_prop);
-         OPT(s, nir_opt_dce);
+         LOOP_OPT(s, nir_copy_prop);
+         LOOP_OPT(s, nir_opt_dce);
       }
-      progress |= OPT(s, nir_opt_if, false);
-      progress |= OPT(s, nir_opt_loop_unroll);
-      progress |= OPT(s, nir_lower_64bit_phis);
-      progress |= OPT(s, nir_opt_remove_phis);
-      progress |= OPT(s, nir_opt_undef);
+      progress |= LOOP_OPT(s, nir_opt_if, false);
+      progress |= LOOP_OPT(s, nir_opt_loop_unroll);
+      progress |= LOOP_OPT(s, nir_lower_64bit_phis);
+      progress |= LOOP_OPT(s, nir_opt_remove_phis);
+      progress |= LOOP_OPT(s, nir_opt_undef);
    } while (progress);
+   _mesa_set_destroy(skip, NULL);
 
    OPT(s, nir_lower_var_copies);
 }
@@ -503,6 +513,14 @@ ir3_nir_post_finalize(struct ir3_shader *shader)
    if (compiler->gen >= 6)
       OPT_V(s, ir3_nir_lower_ssbo_size, compiler->storage_16bit ? 1 : 2);
 
+   /* Evaluate the ALU feeding the mediump outputs lowered above in 16 bits
+    * as well, the conversions then cancel out in the optimization loop.
+    */
+   if (compiler->gen >= 6 && s->info.stage == MESA_SHADER_FRAGMENT &&
+       !(ir3_shader_debug & IR3_DBG_NOFP16)) {
+      OPT_V(s, nir_opt_mediump_alu, nir_type_float | nir_type_int);
+   }
+
    ir3_optimize_loop(compiler, s);
 }
 
@@ -2533,6 +2533,88 @@ calc_limit_pressure_for_cs_with_barrier(struct ir3_shader_variant *v,
    }
 }
 
+/* A spilled value costs a store to pvtmem and a reload for every use, each of
+ * which has about the latency of this many ALU instructions that higher
+ * occupancy would have to hide.
+ */
+#define SPILL_COST 4
+
+/*
+ * Registers that the shader doesn't need are free, but a shader that needs
+ * slightly more than a wave count tier allows runs with the next lower wave
+ * count. Estimate for every higher tier whether spilling down to it is worth
+ * the loss of latency hiding, and lower the limit to the best one. Returns the
+ * number of waves the shader would have had without spilling, or 0 if the
+ * limit was left alone.
+ */
+static unsigned
+calc_limit_pressure_for_occupancy(struct ir3_shader_variant *v,
+                                  struct ir3_liveness *live,
+                                  const struct ir3_pressure *max_pressure,
+                                  struct ir3_pressure *limit_pressure)
+{
+   const struct ir3_compiler *compiler = v->compiler;
+
+   /* The limit only applies to full registers, which only covers every
+    * register with merged registers.
+    */
+   if (!v->mergedregs || !compiler->has_pvtmem ||
+       v->real_wavesize == IR3_DOUBLE_ONLY)
+      return 0;
+
+   unsigned reg_count = DIV_ROUND_UP(max_pressure->full, 2 * 4);
+   bool double_threadsize = ir3_should_double_threadsize(v, reg_count);
+   unsigned reg_independent_max_waves =
+      ir3_get_reg_independent_max_waves(v, double_threadsize);
+   unsigned waves = MIN2(reg_independent_max_waves,
+                         ir3_get_reg_dependent_max_waves(compiler, reg_count,
+                                                         double_threadsize));
+
+   if (waves >= reg_independent_max_waves)
+      return 0;
+
+   struct ir3_pressure min_limit;
+   calc_min_limit_pressure(v, live, &min_limit);
+
+   unsigned best_limit = 0;
+   int64_t best_score = 0;
+   for (unsigned target_waves = waves + compiler->wave_granularity;
+        target_waves <= reg_independent_max_waves;
+        target_waves += compiler->wave_granularity) {
+      unsigned target_regs =
+         compiler->reg_size_vec4 /
+         (target_waves / compiler->wave_granularity *
+          (double_threadsize ? 2 : 1));
+      unsigned target_limit = target_regs * 2 * 4;
+
+      if (target_limit < min_limit.full)
+         break;
+      if (target_limit >= limit_pressure->full ||
+          ir3_should_double_threadsize(v, target_regs) != double_threadsize)
+         continue;
+
+      uint64_t excess, total;
+      ir3_calc_spill_cost(v, live, target_limit, &excess, &total);
+
+      /* The gain is the fraction of latency that the extra waves hide. */
+      int64_t score = (int64_t)(total * (target_waves - waves) / target_waves) -
+                      (int64_t)(excess * SPILL_COST);
+      d("occupancy tier %u waves: limit %u, excess %" PRIu64 "/%" PRIu64
+        ", score %" PRId64, target_waves, target_limit, excess, total, score);
+
+      if (score > best_score) {
+         best_score = score;
+         best_limit = target_limit;
+      }
+   }
+
+   if (!best_limit)
+      return 0;
+
+   limit_pressure->full = best_limit;
+   return waves;
+}
+
 int
 ir3_ra(struct ir3_shader_variant *v)
 {
@@ -2578,8 +2660,14 @@ ir3_ra(struct ir3_shader_variant *v)
    }
 
    /* If requested, lower the limit so that spilling happens more often. */
-   if (ir3_shader_debug & IR3_DBG_SPILLALL)
+   v->unspilled_max_waves = 0;
+   if (ir3_shader_debug & IR3_DBG_SPILLALL) {
       calc_min_limit_pressure(v, live, &limit_pressure);
+   } else if (max_pressure.full <= limit_pressure.full &&
+              max_pressure.half <= limit_pressure.half) {
+      v->unspilled_max_waves = calc_limit_pressure_for_occupancy(
+         v, live, &max_pressure, &limit_pressure);
+   }
 
    if (max_pressure.shared > limit_pressure.shared) {
       /* TODO shared reg -> normal reg spilling */
@@ -162,6 +162,10 @@ struct ir3_pressure {
 void ir3_calc_pressure(struct ir3_shader_variant *v, struct ir3_liveness *live,
                        struct ir3_pressure *max_pressure);
 
+void ir3_calc_spill_cost(struct ir3_shader_variant *v,
+                         struct ir3_liveness *live, unsigned limit_full,
+                         uint64_t *excess, uint64_t *total);
+
 bool ir3_spill(struct ir3 *ir, struct ir3_shader_variant *v,
                struct ir3_liveness **live,
                const struct ir3_pressure *limit_pressure);
@@ -851,6 +851,13 @@ ir3_shader_disasm(struct ir3_shader_variant *so, uint32_t *bin, FILE *out)
       type, so->shader_id, so->id, so->info.sstall, so->info.ss,
       so->info.systall, so->info.sy, so->loops);
 
+   if (so->unspilled_max_waves) {
+      fprintf(out,
+              "; %s prog %d/%d: %d waves, %u without spilling, %u pvtmem\n",
+              type, so->shader_id, so->id, so->info.max_waves,
+              so->unspilled_max_waves, so->pvtmem_size);
+   }
+
    /* print shader type specific info: */
    switch (so->type) {
    case MESA_SHADER_VERTEX:
@@ -585,6 +585,11 @@ struct ir3_shader_variant {
    /* Whether we should use the new per-wave layout rather than per-fiber. */
    bool pvtmem_per_wave;
 
+   /* If RA spilled to reach a higher wave count than the register pressure
+    * allowed, the wave count the shader would have had otherwise.
+    */
+   unsigned unspilled_max_waves;
+
    /* Size in bytes of required shared memory */
    unsigned shared_size;
 
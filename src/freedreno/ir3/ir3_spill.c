@@ -121,6 +121,14 @@ struct ra_spill_ctx {
 
    struct ir3_pressure limit_pressure;
 
+   /* Used by ir3_calc_spill_cost(): the loop depth weight of the current
+    * block, the full pressure limit to compare against and the accumulated
+    * weights of all pressure points and of those above the limit.
+    */
+   uint64_t cost_weight;
+   unsigned cost_limit;
+   uint64_t cost_total, cost_excess;
+
    /* When spilling, we need to reserve a register to serve as the zero'd
     * "base". For simplicity we reserve a register at the beginning so that it's
     * always available.
@@ -1027,6 +1035,10 @@ update_max_pressure(struct ra_spill_ctx *ctx)
       MAX2(ctx->max_pressure.half, ctx->cur_pressure.half);
    ctx->max_pressure.shared =
       MAX2(ctx->max_pressure.shared, ctx->cur_pressure.shared);
+
+   ctx->cost_total += ctx->cost_weight;
+   if (ctx->cur_pressure.full > ctx->cost_limit)
+      ctx->cost_excess += ctx->cost_weight;
 }
 
 static void
@@ -2073,6 +2085,33 @@ ir3_calc_pressure(struct ir3_shader_variant *v, struct ir3_liveness *live,
    ralloc_free(ctx);
 }
 
+/* Estimate how expensive it would be to spill the shader down to a full
+ * register pressure of limit_full without actually spilling: count the
+ * points at which the pressure is above the limit, each of which will need
+ * a spill or reload nearby, weighted by how deep in loops they are. The
+ * total is the same weight summed over every point, so the two can be
+ * compared to get the fraction of the shader affected.
+ */
+void
+ir3_calc_spill_cost(struct ir3_shader_variant *v, struct ir3_liveness *live,
+                    unsigned limit_full, uint64_t *excess, uint64_t *total)
+{
+   struct ra_spill_ctx *ctx = rzalloc(NULL, struct ra_spill_ctx);
+   spill_ctx_init(ctx, v, live);
+
+   ctx->cost_limit = limit_full;
+
+   foreach_block (block, &v->ir->block_list) {
+      /* Assume every loop level runs 8 times. */
+      ctx->cost_weight = 1ull << (3 * MIN2(block->loop_depth, 16));
+      handle_block(ctx, block);
+   }
+
+   *excess = ctx->cost_excess;
+   *total = ctx->cost_total;
+   ralloc_free(ctx);
+}
+
 bool
 ir3_spill(struct ir3 *ir, struct ir3_shader_variant *v,
           struct ir3_liveness **live,
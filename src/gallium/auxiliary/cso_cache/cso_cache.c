@@ -102,15 +102,45 @@ static inline void sanitize_cb(struct cso_hash *hash, enum cso_cache_type type,
    }
 }
 
+static inline void
+cso_mru_clear(struct cso_cache *sc, enum cso_cache_type type)
+{
+   memset(sc->mru[type], 0, sizeof(sc->mru[type]));
+}
+
+/* Move the node to the front of the list, dropping the least recent one if
+ * it isn't in the list yet.
+ */
+static inline void
+cso_mru_push(struct cso_cache *sc, enum cso_cache_type type,
+             struct cso_node *node)
+{
+   struct cso_node **mru = sc->mru[type];
+   unsigned i;
+
+   for (i = 0; i < CSO_CACHE_MRU_SIZE - 1 && mru[i] != node; i++)
+      ;
+   memmove(&mru[1], &mru[0], i * sizeof(mru[0]));
+   mru[0] = node;
+}
+
 struct cso_hash_iter
 cso_insert_state(struct cso_cache *sc,
                  unsigned hash_key, enum cso_cache_type type,
                  void *state)
 {
    struct cso_hash *hash = _cso_hash_for_type(sc, type);
+
+   sc->num_misses++;
+
+   /* Sanitizing frees nodes. */
+   cso_mru_clear(sc, type);
    sanitize_hash(sc, hash, type, sc->max_size);
 
-   return cso_hash_insert(hash, hash_key, state);
+   struct cso_hash_iter iter = cso_hash_insert(hash, hash_key, state);
+   if (!cso_hash_iter_is_null(iter))
+      cso_mru_push(sc, type, iter.node);
+   return iter;
 }
 
 struct cso_hash_iter
@@ -146,11 +176,28 @@ struct cso_hash_iter cso_find_state_template(struct cso_cache *sc,
                                              unsigned hash_key, enum cso_cache_type type,
                                              void *templ, unsigned size)
 {
+   /* Apps tend to cycle between a few states, so check the recently found
+    * ones first. That avoids walking the bucket and its collision list.
+    */
+   for (unsigned i = 0; i < CSO_CACHE_MRU_SIZE && sc->mru[type][i]; i++) {
+      struct cso_node *node = sc->mru[type][i];
+
+      if (node->key == hash_key && !memcmp(node->value, templ, size)) {
+         struct cso_hash_iter iter = {_cso_hash_for_type(sc, type), node};
+
+         if (i)
+            cso_mru_push(sc, type, node);
+         return iter;
+      }
+   }
+
    struct cso_hash_iter iter = cso_find_state(sc, hash_key, type);
    while (!cso_hash_iter_is_null(iter)) {
       void *iter_data = cso_hash_iter_data(iter);
-      if (!memcmp(iter_data, templ, size))
+      if (!memcmp(iter_data, templ, size)) {
+         cso_mru_push(sc, type, iter.node);
          return iter;
+      }
       iter = cso_hash_iter_next(iter);
    }
    return iter;
@@ -206,8 +253,10 @@ void cso_set_maximum_cache_size(struct cso_cache *sc, int number)
 
    sc->max_size = number;
 
-   for (i = 0; i < CSO_CACHE_MAX; i++)
+   for (i = 0; i < CSO_CACHE_MAX; i++) {
+      cso_mru_clear(sc, i);
       sanitize_hash(sc, &sc->hashes[i], i, sc->max_size);
+   }
 }
 
 void cso_cache_set_sanitize_callback(struct cso_cache *sc,
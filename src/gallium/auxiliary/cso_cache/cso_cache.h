@@ -104,10 +104,22 @@ typedef void (*cso_sanitize_callback)(struct cso_hash *hash,
                                       int max_size,
                                       void *user_data);
 
+/* The number of recently found states per type that are checked before
+ * the hash table.
+ */
+#define CSO_CACHE_MRU_SIZE 4
+
 struct cso_cache {
    struct cso_hash hashes[CSO_CACHE_MAX];
    int    max_size;
 
+   /* Most recently found nodes, most recent first. Cleared whenever nodes
+    * may be removed from the hash table.
+    */
+   struct cso_node *mru[CSO_CACHE_MAX][CSO_CACHE_MRU_SIZE];
+
+   unsigned num_misses; /* states that had to be created, wraps around */
+
    cso_sanitize_callback sanitize_cb;
    void                 *sanitize_data;
 
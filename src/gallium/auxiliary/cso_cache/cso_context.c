@@ -127,6 +127,11 @@ struct pipe_context *cso_get_pipe_context(struct cso_context *cso)
    return cso->pipe;
 }
 
+unsigned cso_get_num_cache_misses(struct cso_context *cso)
+{
+   return cso->cache.num_misses;
+}
+
 static inline boolean delete_cso(struct cso_context *ctx,
                                  void *state, enum cso_cache_type type)
 {
@@ -1353,3 +1353,24 @@ void draw_set_constant_buffer_stride(struct draw_context *draw, unsigned num_byt
 {
    draw->constant_buffer_stride = num_bytes;
 }
+
+/**
+ * Let the llvm middle end split large vertex shader batches across up to
+ * num_threads worker threads.  Zero (the default) keeps all vertex
+ * processing on the calling thread.
+ */
+void draw_set_vs_threads(struct draw_context *draw, unsigned num_threads)
+{
+   draw->pt.num_vs_threads = MIN2(num_threads, DRAW_MAX_VS_THREADS);
+}
+
+/**
+ * Return the running totals of indices that went through the indexed
+ * split paths and of the vertices that had to be shaded for them.
+ */
+void draw_get_vertex_cache_stats(const struct draw_context *draw,
+                                 uint64_t *indices, uint64_t *shaded)
+{
+   *indices = draw->pt.vcache.indices;
+   *shaded = draw->pt.vcache.shaded;
+}
@@ -54,6 +54,7 @@
 #include "gallivm/lp_bld_misc.h"
 #include "tgsi/tgsi_exec.h"
 #include "tgsi/tgsi_dump.h"
+#include "tgsi/tgsi_parse.h"
 
 #include "util/u_math.h"
 #include "util/u_pointer.h"
@@ -832,20 +833,32 @@ draw_llvm_destroy(struct draw_llvm *llvm)
    FREE(llvm);
 }
 
+static bool
+draw_shader_is_cacheable(const struct pipe_shader_state *state)
+{
+   return state->type == PIPE_SHADER_IR_TGSI ? state->tokens != NULL
+                                             : state->ir.nir != NULL;
+}
+
 static void
-draw_get_ir_cache_key(struct nir_shader *nir,
+draw_get_ir_cache_key(const struct pipe_shader_state *state,
                       const void *key, size_t key_size,
                       uint32_t val_32bit,
                       unsigned char ir_sha1_cache_key[20])
 {
    struct blob blob = { 0 };
    unsigned ir_size;
-   void *ir_binary;
+   const void *ir_binary;
 
    blob_init(&blob);
-   nir_serialize(&blob, nir, true);
-   ir_binary = blob.data;
-   ir_size = blob.size;
+   if (state->type == PIPE_SHADER_IR_TGSI) {
+      ir_binary = state->tokens;
+      ir_size = tgsi_num_tokens(state->tokens) * sizeof(struct tgsi_token);
+   } else {
+      nir_serialize(&blob, state->ir.nir, true);
+      ir_binary = blob.data;
+      ir_size = blob.size;
+   }
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
@@ -885,8 +898,9 @@ draw_llvm_create_variant(struct draw_llvm *llvm,
    snprintf(module_name, sizeof(module_name), "draw_llvm_vs_variant%u",
             variant->shader->variants_cached);
 
-   if (shader->base.state.ir.nir && llvm->draw->disk_cache_cookie) {
-      draw_get_ir_cache_key(shader->base.state.ir.nir,
+   if (draw_shader_is_cacheable(&shader->base.state) &&
+       llvm->draw->disk_cache_cookie) {
+      draw_get_ir_cache_key(&shader->base.state,
                             key,
                             shader->variant_key_size,
                             num_inputs,
@@ -1563,32 +1577,41 @@ generate_clipmask(struct draw_llvm *llvm,
     * comparisons here).
     */
    /* Cliptest, for hardwired planes */
-   /*
-    * XXX should take guardband into account (currently not in key).
-    * Otherwise might run the draw pipeline stages for nothing.
-    */
    if (key->clip_xy) {
+      LLVMValueRef clip_x = pos_x, clip_y = pos_y;
+
+      /*
+       * With a guard band only vertices beyond twice the viewport extent
+       * are flagged, matching the planes draw_pt_post_vs_prepare() sets
+       * up for the clip stage.
+       */
+      if (key->guard_band_xy) {
+         LLVMValueRef half = lp_build_const_vec(gallivm, f32_type, 0.5);
+         clip_x = LLVMBuildFMul(builder, pos_x, half, "");
+         clip_y = LLVMBuildFMul(builder, pos_y, half, "");
+      }
+
       /* plane 1 */
-      test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, pos_x , pos_w);
+      test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, clip_x , pos_w);
       temp = shift;
       test = LLVMBuildAnd(builder, test, temp, "");
       mask = test;
 
       /* plane 2 */
-      test = LLVMBuildFAdd(builder, pos_x, pos_w, "");
+      test = LLVMBuildFAdd(builder, clip_x, pos_w, "");
       test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, zero, test);
       temp = LLVMBuildShl(builder, temp, shift, "");
       test = LLVMBuildAnd(builder, test, temp, "");
       mask = LLVMBuildOr(builder, mask, test, "");
 
       /* plane 3 */
-      test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, pos_y, pos_w);
+      test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, clip_y, pos_w);
       temp = LLVMBuildShl(builder, temp, shift, "");
       test = LLVMBuildAnd(builder, test, temp, "");
       mask = LLVMBuildOr(builder, mask, test, "");
 
       /* plane 4 */
-      test = LLVMBuildFAdd(builder, pos_y, pos_w, "");
+      test = LLVMBuildFAdd(builder, clip_y, pos_w, "");
       test = lp_build_compare(gallivm, f32_type, PIPE_FUNC_GREATER, zero, test);
       temp = LLVMBuildShl(builder, temp, shift, "");
       test = LLVMBuildAnd(builder, test, temp, "");
@@ -2383,6 +2406,7 @@ draw_llvm_make_variant_key(struct draw_llvm *llvm, char *store)
    key->clip_user = llvm->draw->clip_user;
    key->bypass_viewport = llvm->draw->bypass_viewport;
    key->clip_halfz = llvm->draw->rasterizer->clip_halfz;
+   key->guard_band_xy = llvm->draw->guard_band_xy;
    /* XXX assumes edgeflag output not at 0 */
    key->need_edgeflags = (llvm->draw->vs.edgeflag_output ? TRUE : FALSE);
    key->ucp_enable = llvm->draw->rasterizer->clip_plane_enable;
@@ -2468,6 +2492,7 @@ draw_llvm_dump_variant_key(struct draw_llvm_variant_key *key)
    debug_printf("clip_user = %u\n", key->clip_user);
    debug_printf("bypass_viewport = %u\n", key->bypass_viewport);
    debug_printf("clip_halfz = %u\n", key->clip_halfz);
+   debug_printf("guard_band_xy = %u\n", key->guard_band_xy);
    debug_printf("need_edgeflags = %u\n", key->need_edgeflags);
    debug_printf("has_gs_or_tes = %u\n", key->has_gs_or_tes);
    debug_printf("ucp_enable = %u\n", key->ucp_enable);
@@ -2941,8 +2966,9 @@ draw_gs_llvm_create_variant(struct draw_llvm *llvm,
 
    memcpy(&variant->key, key, shader->variant_key_size);
 
-   if (shader->base.state.ir.nir && llvm->draw->disk_cache_cookie) {
-      draw_get_ir_cache_key(shader->base.state.ir.nir,
+   if (draw_shader_is_cacheable(&shader->base.state) &&
+       llvm->draw->disk_cache_cookie) {
+      draw_get_ir_cache_key(&shader->base.state,
                             key,
                             shader->variant_key_size,
                             num_outputs,
@@ -3605,8 +3631,9 @@ draw_tcs_llvm_create_variant(struct draw_llvm *llvm,
 
    memcpy(&variant->key, key, shader->variant_key_size);
 
-   if (shader->base.state.ir.nir && llvm->draw->disk_cache_cookie) {
-      draw_get_ir_cache_key(shader->base.state.ir.nir,
+   if (draw_shader_is_cacheable(&shader->base.state) &&
+       llvm->draw->disk_cache_cookie) {
+      draw_get_ir_cache_key(&shader->base.state,
                             key,
                             shader->variant_key_size,
                             num_outputs,
@@ -4136,8 +4163,9 @@ draw_tes_llvm_create_variant(struct draw_llvm *llvm,
             variant->shader->variants_cached);
 
    memcpy(&variant->key, key, shader->variant_key_size);
-   if (shader->base.state.ir.nir && llvm->draw->disk_cache_cookie) {
-      draw_get_ir_cache_key(shader->base.state.ir.nir,
+   if (draw_shader_is_cacheable(&shader->base.state) &&
+       llvm->draw->disk_cache_cookie) {
+      draw_get_ir_cache_key(&shader->base.state,
                             key,
                             shader->variant_key_size,
                             num_outputs,
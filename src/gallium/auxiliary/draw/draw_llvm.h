@@ -502,6 +502,7 @@ struct draw_llvm_variant_key
    unsigned clip_z:1;
    unsigned clip_user:1;
    unsigned clip_halfz:1;
+   unsigned guard_band_xy:1;
    unsigned bypass_viewport:1;
    unsigned need_edgeflags:1;
    unsigned has_gs_or_tes:1;
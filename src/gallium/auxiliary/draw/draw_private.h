@@ -59,6 +59,13 @@ struct gallivm_state;
  */
 #define DRAW_MAX_FETCH_IDX 0xffffffff
 
+/**
+ * Maximum number of worker threads the vertex shader may be split across.
+ * Vertex batches are at most a few thousand vertices, so more threads than
+ * this only add synchronization overhead.
+ */
+#define DRAW_MAX_VS_THREADS 8
+
 /**
  * Maximum number of extra shader outputs.  These are allocated by:
  * - draw_pipe_aaline.c (1)
@@ -260,6 +267,15 @@ struct draw_context
 
       boolean test_fse;         /* enable FSE even though its not correct (eg for softpipe) */
       boolean no_fse;           /* disable FSE even when it is correct */
+
+      /** worker threads the llvm middle end may run the vertex shader on */
+      unsigned num_vs_threads;
+
+      /** vertex cache statistics: indices drawn and vertices shaded */
+      struct {
+         uint64_t indices;
+         uint64_t shaded;
+      } vcache;
    } pt;
 
    struct {
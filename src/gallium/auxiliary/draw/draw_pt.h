@@ -233,6 +233,11 @@ void draw_pt_post_vs_prepare( struct pt_post_vs *pvs,
                               boolean clip_halfz,
 			      boolean need_edgeflags );
 
+boolean draw_pt_post_vs_cull_tris( struct pt_post_vs *pvs,
+                                   const struct draw_vertex_info *info,
+                                   struct draw_prim_info *prim_info,
+                                   ushort *elts );
+
 struct pt_post_vs *draw_pt_post_vs_create( struct draw_context *draw );
 
 void draw_pt_post_vs_destroy( struct pt_post_vs *pvs );
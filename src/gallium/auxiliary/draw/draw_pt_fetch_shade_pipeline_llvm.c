@@ -28,6 +28,7 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
+#include "util/u_queue.h"
 #include "draw/draw_context.h"
 #include "draw/draw_gs.h"
 #include "draw/draw_tess.h"
@@ -39,8 +40,26 @@
 #include "draw/draw_llvm.h"
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_debug.h"
+#include "compiler/nir/nir.h"
 
 
+/* Don't bother splitting the vertex shader into jobs smaller than this. */
+#define LLVM_VS_MIN_JOB_VERTICES 128
+
+struct llvm_middle_end;
+
+/** One slice of a vertex shader batch, run on a worker thread. */
+struct llvm_vs_job {
+   struct llvm_middle_end *fpme;
+   struct vertex_header *verts;
+   unsigned count;
+   unsigned start_or_maxelt;
+   unsigned vid_base;
+   const unsigned *elts;
+   boolean clipped;
+   struct util_queue_fence fence;
+};
+
 struct llvm_middle_end {
    struct draw_pt_middle_end base;
    struct draw_context *draw;
@@ -58,6 +77,16 @@ struct llvm_middle_end {
 
    struct draw_llvm *llvm;
    struct draw_llvm_variant *current_variant;
+
+   /* Worker threads for vertex shading, see draw_set_vs_threads(). */
+   struct util_queue vs_queue;
+   unsigned num_vs_threads;
+   struct llvm_vs_job vs_jobs[DRAW_MAX_VS_THREADS];
+
+   /* Splitting a linear batch shifts its start, which the shader can see
+    * through gl_BaseVertex-style first vertex reads.
+    */
+   boolean vs_split_linear;
 };
 
 
@@ -410,6 +439,20 @@ llvm_middle_end_prepare( struct draw_pt_middle_end *middle,
    if (tes) {
       llvm_middle_end_prepare_tes(fpme);
    }
+
+   if (draw->pt.num_vs_threads && !fpme->num_vs_threads) {
+      if (util_queue_init(&fpme->vs_queue, "draw_vs", DRAW_MAX_VS_THREADS,
+                          draw->pt.num_vs_threads, 0, NULL)) {
+         fpme->num_vs_threads = draw->pt.num_vs_threads;
+         for (unsigned i = 0; i < ARRAY_SIZE(fpme->vs_jobs); i++)
+            util_queue_fence_init(&fpme->vs_jobs[i].fence);
+      }
+   }
+
+   fpme->vs_split_linear =
+      vs->state.type != PIPE_SHADER_IR_NIR ||
+      !BITSET_TEST(((const nir_shader *)vs->state.ir.nir)->info.system_values_read,
+                   SYSTEM_VALUE_FIRST_VERTEX);
 }
 
 static unsigned
@@ -556,6 +599,93 @@ emit(struct pt_emit *emit,
 }
 
 
+static boolean
+llvm_run_vs(struct llvm_middle_end *fpme, struct vertex_header *verts,
+            unsigned count, unsigned start_or_maxelt, unsigned vid_base,
+            const unsigned *elts)
+{
+   struct draw_context *draw = fpme->draw;
+
+   return fpme->current_variant->jit_func(&fpme->llvm->jit_context,
+                                          verts,
+                                          draw->pt.user.vbuffer,
+                                          count,
+                                          start_or_maxelt,
+                                          fpme->vertex_size,
+                                          draw->pt.vertex_buffer,
+                                          draw->instance_id,
+                                          vid_base,
+                                          draw->start_instance,
+                                          elts, draw->pt.user.drawid,
+                                          draw->pt.user.viewid);
+}
+
+
+static void
+llvm_vs_job_execute(void *data, void *gdata, int thread_index)
+{
+   struct llvm_vs_job *job = data;
+
+   job->clipped = llvm_run_vs(job->fpme, job->verts, job->count,
+                              job->start_or_maxelt, job->vid_base, job->elts);
+}
+
+
+/**
+ * Run the vertex shader over a batch, fanning it out to the worker threads
+ * when it is big enough.  Vertex shader invocations are independent and
+ * each slice writes its own range of the output vertices, so the rest of
+ * the pipeline still sees the batch in its original order.  The calling
+ * thread shades the first slice itself.
+ */
+static boolean
+llvm_shade_vertices(struct llvm_middle_end *fpme, struct vertex_header *verts,
+                    unsigned count, unsigned start_or_maxelt, unsigned vid_base,
+                    const unsigned *elts)
+{
+   const unsigned vector_length = lp_native_vector_width / 32;
+   unsigned num_jobs = MIN2(fpme->num_vs_threads + 1,
+                            count / LLVM_VS_MIN_JOB_VERTICES);
+
+   if (!elts && !fpme->vs_split_linear)
+      num_jobs = 1;
+
+   if (num_jobs <= 1)
+      return llvm_run_vs(fpme, verts, count, start_or_maxelt, vid_base, elts);
+
+   /* The shader stores whole vectors of vertices, so slices have to start
+    * on a vector boundary to not step on each other.
+    */
+   const unsigned slice = align(DIV_ROUND_UP(count, num_jobs), vector_length);
+   unsigned first = slice, num_queued = 0;
+
+   while (first < count) {
+      struct llvm_vs_job *job = &fpme->vs_jobs[num_queued++];
+
+      job->fpme = fpme;
+      job->verts = (struct vertex_header *)
+         ((char *)verts + first * fpme->vertex_size);
+      job->count = MIN2(slice, count - first);
+      job->start_or_maxelt = elts ? start_or_maxelt : start_or_maxelt + first;
+      job->vid_base = vid_base;
+      job->elts = elts ? elts + first : NULL;
+      util_queue_add_job(&fpme->vs_queue, job, &job->fence,
+                         llvm_vs_job_execute, NULL, 0);
+      first += slice;
+   }
+
+   boolean clipped = llvm_run_vs(fpme, verts, slice, start_or_maxelt,
+                                 vid_base, elts);
+
+   for (unsigned i = 0; i < num_queued; i++) {
+      util_queue_fence_wait(&fpme->vs_jobs[i].fence);
+      clipped |= fpme->vs_jobs[i].clipped;
+   }
+
+   return clipped;
+}
+
+
 static void
 llvm_pipeline_generic(struct draw_pt_middle_end *middle,
                       const struct draw_fetch_info *fetch_info,
@@ -576,6 +706,9 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
    struct draw_vertex_info *vert_info;
    struct draw_prim_info ia_prim_info;
    struct draw_vertex_info ia_vert_info;
+   struct draw_prim_info cull_prim_info;
+   unsigned cull_prim_length;
+   ushort *cull_elts = NULL;
    const struct draw_prim_info *prim_info = in_prim_info;
    boolean free_prim_info = FALSE;
    unsigned opt = fpme->opt;
@@ -618,18 +751,9 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       vid_base = draw->pt.user.eltBias;
       elts = fetch_info->elts;
    }
-   clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
-                                             llvm_vert_info.verts,
-                                             draw->pt.user.vbuffer,
-                                             fetch_info->count,
-                                             start_or_maxelt,
-                                             fpme->vertex_size,
-                                             draw->pt.vertex_buffer,
-                                             draw->instance_id,
-                                             vid_base,
-                                             draw->start_instance,
-                                             elts, draw->pt.user.drawid,
-                                             draw->pt.user.viewid);
+   clipped = llvm_shade_vertices(fpme, llvm_vert_info.verts,
+                                 fetch_info->count, start_or_maxelt,
+                                 vid_base, elts);
 
    /* Finished with fetch and vs:
     */
@@ -752,6 +876,32 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
                                draw->vs.vertex_shader->info.writes_viewport_index)) {
          clipped = draw_pt_post_vs_run( fpme->post_vs, vert_info, prim_info );
       }
+
+      /* Most clipped batches only have triangles which are entirely
+       * inside or entirely outside.  Drop the ones outside (and those
+       * which would be culled anyway) up front, which saves running the
+       * pipeline when nothing is left that really needs clipping.
+       */
+      if (clipped && !(opt & PT_PIPELINE) && !draw->vs.edgeflag_output &&
+          prim_info->prim == PIPE_PRIM_TRIANGLES &&
+          prim_info->primitive_count == 1 &&
+          (cull_elts = MALLOC(prim_info->count * sizeof(ushort)))) {
+         cull_prim_info = *prim_info;
+         cull_prim_info.primitive_lengths = &cull_prim_length;
+         clipped = draw_pt_post_vs_cull_tris(fpme->post_vs, vert_info,
+                                             &cull_prim_info, cull_elts);
+         /* the surviving elts are copied out, the old ones can go */
+         if (free_prim_info) {
+            FREE(prim_info->primitive_lengths);
+            FREE(tes_elts_out);
+            tes_elts_out = NULL;
+            free_prim_info = FALSE;
+         }
+         prim_info = &cull_prim_info;
+         if (prim_info->count == 0)
+            goto out;
+      }
+
       /* "clipped" also includes non-one edgeflag */
       if (clipped) {
          opt |= PT_PIPELINE;
@@ -767,6 +917,7 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       }
    }
 out:
+   FREE(cull_elts);
    FREE(vert_info->verts);
    if (gshader && gshader->num_vertex_streams > 1)
      for (unsigned i = 1; i < gshader->num_vertex_streams; i++)
@@ -903,6 +1054,12 @@ llvm_middle_end_destroy(struct draw_pt_middle_end *middle)
    if (fpme->post_vs)
       draw_pt_post_vs_destroy( fpme->post_vs );
 
+   if (fpme->num_vs_threads) {
+      util_queue_destroy(&fpme->vs_queue);
+      for (unsigned i = 0; i < ARRAY_SIZE(fpme->vs_jobs); i++)
+         util_queue_fence_destroy(&fpme->vs_jobs[i].fence);
+   }
+
    FREE(middle);
 }
 
@@ -87,6 +87,10 @@ dot4(const float *a, const float *b)
 #define TAG(x) x##_xy_gb_halfz_viewport
 #include "draw_cliptest_tmp.h"
 
+#define FLAGS (DO_CLIP_XY_GUARD_BAND | DO_CLIP_FULL_Z | DO_VIEWPORT)
+#define TAG(x) x##_xy_gb_fullz_viewport
+#include "draw_cliptest_tmp.h"
+
 #define FLAGS (DO_CLIP_FULL_Z | DO_VIEWPORT)
 #define TAG(x) x##_fullz_viewport
 #include "draw_cliptest_tmp.h"
@@ -124,6 +128,124 @@ boolean draw_pt_post_vs_run( struct pt_post_vs *pvs,
 }
 
 
+static inline const float *
+tri_vertex_pos(const struct draw_vertex_info *info, unsigned pos, unsigned idx)
+{
+   const struct vertex_header *v = (const struct vertex_header *)
+      ((const char *)info->verts + idx * info->stride);
+   return v->data[pos];
+}
+
+static inline unsigned
+tri_vertex_clipmask(const struct draw_vertex_info *info, unsigned idx)
+{
+   const struct vertex_header *v = (const struct vertex_header *)
+      ((const char *)info->verts + idx * info->stride);
+   return v->clipmask;
+}
+
+
+/**
+ * Pre-pass over a clip-tested triangle list, run before handing it to the
+ * draw pipeline.  Triangles with all vertices outside the same clip plane
+ * are dropped.  Triangles with all vertices inside are in window
+ * coordinates already, and are dropped if they fall outside the viewport
+ * (which only happens with the guard band) or are culled by the
+ * rasterizer state.  The survivors are written to elts and prim_info is
+ * redirected to them.
+ *
+ * Returns whether any surviving triangle still needs real clipping.
+ */
+boolean draw_pt_post_vs_cull_tris( struct pt_post_vs *pvs,
+                                   const struct draw_vertex_info *info,
+                                   struct draw_prim_info *prim_info,
+                                   ushort *elts )
+{
+   const struct draw_context *draw = pvs->draw;
+   const unsigned pos = draw_current_shader_position_output(draw);
+   const boolean window_coords = (pvs->flags & DO_VIEWPORT) != 0;
+   const unsigned cull_face = window_coords ? draw->rasterizer->cull_face :
+                                              PIPE_FACE_NONE;
+   const boolean front_ccw = draw->rasterizer->front_ccw;
+   const boolean vp_reject = window_coords &&
+      (pvs->flags & DO_CLIP_XY_GUARD_BAND) &&
+      !draw_current_shader_uses_viewport_index(draw);
+   const float *scale = draw->viewports[0].scale;
+   const float *trans = draw->viewports[0].translate;
+   const float minx = trans[0] - fabsf(scale[0]);
+   const float maxx = trans[0] + fabsf(scale[0]);
+   const float miny = trans[1] - fabsf(scale[1]);
+   const float maxy = trans[1] + fabsf(scale[1]);
+   unsigned need_clip = 0;
+   unsigned count = 0;
+
+   assert(prim_info->prim == PIPE_PRIM_TRIANGLES);
+   assert(prim_info->primitive_count == 1);
+
+   for (unsigned i = 0; i + 2 < prim_info->count; i += 3) {
+      unsigned idx[3];
+
+      for (unsigned j = 0; j < 3; j++)
+         idx[j] = prim_info->linear ? prim_info->start + i + j :
+                                      prim_info->elts[i + j];
+
+      const unsigned m0 = tri_vertex_clipmask(info, idx[0]);
+      const unsigned m1 = tri_vertex_clipmask(info, idx[1]);
+      const unsigned m2 = tri_vertex_clipmask(info, idx[2]);
+
+      /* trivially rejected */
+      if (m0 & m1 & m2)
+         continue;
+
+      if (m0 | m1 | m2) {
+         need_clip = 1;
+      } else if (vp_reject || cull_face != PIPE_FACE_NONE) {
+         const float *v0 = tri_vertex_pos(info, pos, idx[0]);
+         const float *v1 = tri_vertex_pos(info, pos, idx[1]);
+         const float *v2 = tri_vertex_pos(info, pos, idx[2]);
+
+         if (vp_reject &&
+             ((v0[0] < minx && v1[0] < minx && v2[0] < minx) ||
+              (v0[0] > maxx && v1[0] > maxx && v2[0] > maxx) ||
+              (v0[1] < miny && v1[1] < miny && v2[1] < miny) ||
+              (v0[1] > maxy && v1[1] > maxy && v2[1] > maxy)))
+            continue;
+
+         if (cull_face != PIPE_FACE_NONE) {
+            /* Same determinant and facing rules as draw_pipe_cull.c. */
+            const float ex = v0[0] - v2[0];
+            const float ey = v0[1] - v2[1];
+            const float fx = v1[0] - v2[0];
+            const float fy = v1[1] - v2[1];
+            const float det = ex * fy - ey * fx;
+            unsigned face;
+
+            if (det != 0)
+               face = ((det < 0) == front_ccw) ? PIPE_FACE_FRONT :
+                                                 PIPE_FACE_BACK;
+            else
+               face = PIPE_FACE_BACK;
+
+            if (face & cull_face)
+               continue;
+         }
+      }
+
+      elts[count++] = idx[0];
+      elts[count++] = idx[1];
+      elts[count++] = idx[2];
+   }
+
+   prim_info->linear = FALSE;
+   prim_info->start = 0;
+   prim_info->elts = elts;
+   prim_info->count = count;
+   prim_info->primitive_lengths[0] = count;
+
+   return need_clip != 0;
+}
+
+
 void draw_pt_post_vs_prepare( struct pt_post_vs *pvs,
 			      boolean clip_xy,
 			      boolean clip_z,
@@ -135,11 +257,6 @@ void draw_pt_post_vs_prepare( struct pt_post_vs *pvs,
 {
    pvs->flags = 0;
 
-   /* This combination not currently tested/in use:
-    */
-   if (!clip_halfz)
-      guard_band = FALSE;
-
    if (clip_xy && !guard_band) {
       pvs->flags |= DO_CLIP_XY;
       ASSIGN_4V( pvs->draw->plane[0], -1,  0,  0, 1 );
@@ -193,6 +310,10 @@ void draw_pt_post_vs_prepare( struct pt_post_vs *pvs,
       pvs->run = do_cliptest_xy_gb_halfz_viewport;
       break;
 
+   case DO_CLIP_XY_GUARD_BAND | DO_CLIP_FULL_Z | DO_VIEWPORT:
+      pvs->run = do_cliptest_xy_gb_fullz_viewport;
+      break;
+
    case DO_CLIP_FULL_Z | DO_VIEWPORT:
       pvs->run = do_cliptest_fullz_viewport;
       break;
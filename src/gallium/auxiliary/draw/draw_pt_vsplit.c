@@ -30,8 +30,17 @@
 #include "draw/draw_private.h"
 #include "draw/draw_pt.h"
 
-#define SEGMENT_SIZE 1024
-#define MAP_SIZE     256
+/* Segments going through the draw pipeline may be this large; segments
+ * emitted straight to the driver keep the limit its index buffers were
+ * sized for.
+ */
+#define SEGMENT_SIZE      4096
+#define EMIT_SEGMENT_SIZE 1024
+
+/* The vertex cache is CACHE_SETS sets of CACHE_WAYS entries each. */
+#define CACHE_SET_BITS 8
+#define CACHE_SETS     (1 << CACHE_SET_BITS)
+#define CACHE_WAYS     4
 
 /* The largest possible index within an index buffer */
 #define MAX_ELT_IDX 0xffffffff
@@ -54,9 +63,10 @@ struct vsplit_frontend {
 
    struct {
       /* map a fetch element to a draw element */
-      unsigned fetches[MAP_SIZE];
-      ushort draws[MAP_SIZE];
-      boolean has_max_fetch;
+      unsigned fetches[CACHE_SETS][CACHE_WAYS];
+      ushort draws[CACHE_SETS][CACHE_WAYS];
+      /* number of insertions into each set, the low bits pick the victim */
+      ushort fill[CACHE_SETS];
 
       ushort num_fetch_elts;
       ushort num_draw_elts;
@@ -67,8 +77,8 @@ struct vsplit_frontend {
 static void
 vsplit_clear_cache(struct vsplit_frontend *vsplit)
 {
-   memset(vsplit->cache.fetches, 0xff, sizeof(vsplit->cache.fetches));
-   vsplit->cache.has_max_fetch = FALSE;
+   /* Only the fill counts need resetting, entries past them are stale. */
+   memset(vsplit->cache.fill, 0, sizeof(vsplit->cache.fill));
    vsplit->cache.num_fetch_elts = 0;
    vsplit->cache.num_draw_elts = 0;
 }
@@ -76,6 +86,9 @@ vsplit_clear_cache(struct vsplit_frontend *vsplit)
 static void
 vsplit_flush_cache(struct vsplit_frontend *vsplit, unsigned flags)
 {
+   vsplit->draw->pt.vcache.indices += vsplit->cache.num_draw_elts;
+   vsplit->draw->pt.vcache.shaded += vsplit->cache.num_fetch_elts;
+
    vsplit->middle->run(vsplit->middle,
          vsplit->fetch_elts, vsplit->cache.num_fetch_elts,
          vsplit->draw_elts, vsplit->cache.num_draw_elts, flags);
@@ -83,27 +96,38 @@ vsplit_flush_cache(struct vsplit_frontend *vsplit, unsigned flags)
 
 /**
  * Add a fetch element and add it to the draw elements.
+ *
+ * Folding the high bits into the set index keeps a window of sequential
+ * indices spread evenly over the sets while also scattering meshes whose
+ * indices jump around by multiples of the set count.
  */
 static inline void
 vsplit_add_cache(struct vsplit_frontend *vsplit, unsigned fetch)
 {
-   unsigned hash;
-
-   hash = fetch % MAP_SIZE;
+   const unsigned set = (fetch ^ (fetch >> CACHE_SET_BITS) ^
+                         (fetch >> (2 * CACHE_SET_BITS))) & (CACHE_SETS - 1);
+   const unsigned fill = vsplit->cache.fill[set];
+   const unsigned valid = MIN2(fill, CACHE_WAYS);
+   unsigned way;
+
+   for (way = 0; way < valid; way++) {
+      if (vsplit->cache.fetches[set][way] == fetch)
+         break;
+   }
 
-   /* If the value isn't in the cache or it's an overflow due to the
-    * element bias */
-   if (vsplit->cache.fetches[hash] != fetch) {
-      /* update cache */
-      vsplit->cache.fetches[hash] = fetch;
-      vsplit->cache.draws[hash] = vsplit->cache.num_fetch_elts;
+   if (way == valid) {
+      /* miss: replace the oldest entry of the set */
+      way = fill % CACHE_WAYS;
+      vsplit->cache.fetches[set][way] = fetch;
+      vsplit->cache.draws[set][way] = vsplit->cache.num_fetch_elts;
+      vsplit->cache.fill[set] = fill + 1;
 
       /* add fetch */
       assert(vsplit->cache.num_fetch_elts < vsplit->segment_size);
       vsplit->fetch_elts[vsplit->cache.num_fetch_elts++] = fetch;
    }
 
-   vsplit->draw_elts[vsplit->cache.num_draw_elts++] = vsplit->cache.draws[hash];
+   vsplit->draw_elts[vsplit->cache.num_draw_elts++] = vsplit->cache.draws[set][way];
 }
 
 /**
@@ -125,12 +149,6 @@ vsplit_add_cache_ubyte(struct vsplit_frontend *vsplit, const ubyte *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -142,12 +160,6 @@ vsplit_add_cache_ushort(struct vsplit_frontend *vsplit, const ushort *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -167,13 +179,6 @@ vsplit_add_cache_uint(struct vsplit_frontend *vsplit, const uint *elts,
     */
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* Take care for DRAW_MAX_FETCH_IDX (since cache is initialized to -1). */
-   if (elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      /* force update - any value will do except DRAW_MAX_FETCH_IDX */
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -228,7 +233,8 @@ static void vsplit_prepare(struct draw_pt_front_end *frontend,
    vsplit->middle = middle;
    middle->prepare(middle, vsplit->prim, opt, &vsplit->max_vertices);
 
-   vsplit->segment_size = MIN2(SEGMENT_SIZE, vsplit->max_vertices);
+   vsplit->segment_size = MIN2((opt & PT_PIPELINE) ? SEGMENT_SIZE :
+                               EMIT_SEGMENT_SIZE, vsplit->max_vertices);
 }
 
 
@@ -0,0 +1,793 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* GALLIUM_PROFILE: a lightweight performance view of a gallium driver.
+ *
+ * Instead of wrapping every object like driver_trace, this replaces the
+ * handful of screen and context callbacks that move data or do work with
+ * versions that count what went through them and then call the original.
+ * Bytes are attributed to resources, draws and dispatches to the bound
+ * shader CSOs, and one in GALLIUM_PROFILE_SAMPLE calls of each kind is
+ * timed.  A ranked summary is printed to stderr when the screen is
+ * destroyed.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pr_public.h"
+
+#include "pipe/p_context.h"
+#include "pipe/p_screen.h"
+#include "pipe/p_state.h"
+#include "util/format/u_format.h"
+#include "util/hash_table.h"
+#include "util/os_time.h"
+#include "util/simple_mtx.h"
+#include "util/u_atomic.h"
+#include "util/u_debug.h"
+#include "util/u_dump.h"
+#include "util/u_dynarray.h"
+#include "util/u_framebuffer.h"
+#include "util/u_inlines.h"
+#include "util/u_memory.h"
+
+DEBUG_GET_ONCE_BOOL_OPTION(profile, "GALLIUM_PROFILE", false)
+DEBUG_GET_ONCE_NUM_OPTION(profile_sample, "GALLIUM_PROFILE_SAMPLE", 16)
+DEBUG_GET_ONCE_NUM_OPTION(profile_top, "GALLIUM_PROFILE_TOP", 20)
+
+enum pr_call {
+   PR_CALL_DRAW_VBO,
+   PR_CALL_LAUNCH_GRID,
+   PR_CALL_CLEAR,
+   PR_CALL_BLIT,
+   PR_CALL_RESOURCE_COPY_REGION,
+   PR_CALL_BUFFER_MAP,
+   PR_CALL_TEXTURE_MAP,
+   PR_CALL_BUFFER_SUBDATA,
+   PR_CALL_TEXTURE_SUBDATA,
+   PR_CALL_SET_FRAMEBUFFER_STATE,
+   PR_CALL_FLUSH,
+   PR_CALL_COUNT,
+};
+
+static const char *const pr_call_names[PR_CALL_COUNT] = {
+   [PR_CALL_DRAW_VBO] = "draw_vbo",
+   [PR_CALL_LAUNCH_GRID] = "launch_grid",
+   [PR_CALL_CLEAR] = "clear",
+   [PR_CALL_BLIT] = "blit",
+   [PR_CALL_RESOURCE_COPY_REGION] = "resource_copy_region",
+   [PR_CALL_BUFFER_MAP] = "buffer_map",
+   [PR_CALL_TEXTURE_MAP] = "texture_map",
+   [PR_CALL_BUFFER_SUBDATA] = "buffer_subdata",
+   [PR_CALL_TEXTURE_SUBDATA] = "texture_subdata",
+   [PR_CALL_SET_FRAMEBUFFER_STATE] = "set_framebuffer_state",
+   [PR_CALL_FLUSH] = "flush",
+};
+
+struct pr_call_stats {
+   uint64_t count;
+   uint64_t sampled;
+   uint64_t sampled_ns;
+};
+
+/* Everything counted for one resource.  The resource itself is only used
+ * as a key and is not referenced, so its description is copied.
+ */
+struct pr_resource {
+   enum pipe_texture_target target;
+   enum pipe_format format;
+   unsigned width0, height0, depth0, array_size;
+
+   uint64_t upload_bytes;
+   uint64_t download_bytes;
+   uint64_t blit_bytes;
+   uint64_t render_bytes;
+   unsigned uploads;
+
+   /* buffer_subdata calls that wrote the same data to the same range as
+    * the previous one.
+    */
+   unsigned redundant_uploads;
+   uint32_t last_upload_hash;
+   unsigned last_upload_offset, last_upload_size;
+};
+
+struct pr_shader {
+   const char *stage;
+   const void *cso;
+   uint64_t uses;
+};
+
+struct pr_screen {
+   void (*destroy)(struct pipe_screen *);
+   struct pipe_context *(*context_create)(struct pipe_screen *, void *,
+                                          unsigned);
+   void (*resource_destroy)(struct pipe_screen *, struct pipe_resource *);
+
+   unsigned sample_interval;
+
+   /* pipe_resource -> pr_resource of live resources */
+   struct hash_table *resources;
+   /* pr_resource of destroyed resources */
+   struct util_dynarray retired;
+   /* shader CSO -> pr_shader */
+   struct hash_table *shaders;
+
+   struct pr_call_stats calls[PR_CALL_COUNT];
+};
+
+struct pr_context {
+   struct pr_screen *pscreen;
+
+   /* Bound state that work is attributed to */
+   struct pipe_framebuffer_state fb;
+   void *vs, *fs, *cs;
+
+   /* The original callbacks */
+   void (*destroy)(struct pipe_context *);
+   void (*draw_vbo)(struct pipe_context *, const struct pipe_draw_info *,
+                    unsigned, const struct pipe_draw_indirect_info *,
+                    const struct pipe_draw_start_count_bias *, unsigned);
+   void (*launch_grid)(struct pipe_context *, const struct pipe_grid_info *);
+   void (*clear)(struct pipe_context *, unsigned,
+                 const struct pipe_scissor_state *,
+                 const union pipe_color_union *, double, unsigned);
+   void (*blit)(struct pipe_context *, const struct pipe_blit_info *);
+   void (*resource_copy_region)(struct pipe_context *, struct pipe_resource *,
+                                unsigned, unsigned, unsigned, unsigned,
+                                struct pipe_resource *, unsigned,
+                                const struct pipe_box *);
+   void *(*buffer_map)(struct pipe_context *, struct pipe_resource *,
+                       unsigned, unsigned, const struct pipe_box *,
+                       struct pipe_transfer **);
+   void *(*texture_map)(struct pipe_context *, struct pipe_resource *,
+                        unsigned, unsigned, const struct pipe_box *,
+                        struct pipe_transfer **);
+   void (*buffer_subdata)(struct pipe_context *, struct pipe_resource *,
+                          unsigned, unsigned, unsigned, const void *);
+   void (*texture_subdata)(struct pipe_context *, struct pipe_resource *,
+                           unsigned, unsigned, const struct pipe_box *,
+                           const void *, unsigned, unsigned);
+   void (*set_framebuffer_state)(struct pipe_context *,
+                                 const struct pipe_framebuffer_state *);
+   void (*flush)(struct pipe_context *, struct pipe_fence_handle **,
+                 unsigned);
+   void (*bind_vs_state)(struct pipe_context *, void *);
+   void (*bind_fs_state)(struct pipe_context *, void *);
+   void (*bind_compute_state)(struct pipe_context *, void *);
+};
+
+/* Protects pr_objects and everything in the pr_screens.  The original
+ * callbacks are always called without it held.
+ */
+static simple_mtx_t pr_lock = _SIMPLE_MTX_INITIALIZER_NP;
+
+/* pipe_screen -> pr_screen and pipe_context -> pr_context */
+static struct hash_table *pr_objects;
+
+static void *
+pr_lookup(const void *object)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(pr_objects, object);
+   return entry ? entry->data : NULL;
+}
+
+static struct pr_resource *
+pr_resource(struct pr_screen *pscreen, struct pipe_resource *res)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(pscreen->resources, res);
+   if (entry)
+      return entry->data;
+
+   struct pr_resource *r = CALLOC_STRUCT(pr_resource);
+   if (!r)
+      return NULL;
+
+   r->target = res->target;
+   r->format = res->format;
+   r->width0 = res->width0;
+   r->height0 = res->height0;
+   r->depth0 = res->depth0;
+   r->array_size = res->array_size;
+   _mesa_hash_table_insert(pscreen->resources, res, r);
+   return r;
+}
+
+static void
+pr_shader_use(struct pr_screen *pscreen, const char *stage, void *cso)
+{
+   if (!cso)
+      return;
+
+   struct hash_entry *entry = _mesa_hash_table_search(pscreen->shaders, cso);
+   struct pr_shader *shader = entry ? entry->data : NULL;
+   if (!shader) {
+      shader = CALLOC_STRUCT(pr_shader);
+      if (!shader)
+         return;
+      shader->stage = stage;
+      shader->cso = cso;
+      _mesa_hash_table_insert(pscreen->shaders, cso, shader);
+   }
+   shader->uses++;
+}
+
+static uint64_t
+pr_box_bytes(struct pipe_resource *res, enum pipe_format format,
+             const struct pipe_box *box)
+{
+   if (res->target == PIPE_BUFFER)
+      return abs(box->width);
+
+   return (uint64_t)util_format_get_nblocks(format, abs(box->width),
+                                            abs(box->height)) *
+          util_format_get_blocksize(format) * abs(box->depth);
+}
+
+static void
+pr_account_surface(struct pr_screen *pscreen, struct pipe_surface *surf)
+{
+   struct pr_resource *r = pr_resource(pscreen, surf->texture);
+   if (!r)
+      return;
+
+   unsigned layers = surf->texture->target == PIPE_BUFFER ? 1 :
+      surf->u.tex.last_layer - surf->u.tex.first_layer + 1;
+   r->render_bytes +=
+      (uint64_t)util_format_get_nblocks(surf->format, surf->width,
+                                        surf->height) *
+      util_format_get_blocksize(surf->format) *
+      MAX2(surf->texture->nr_samples, 1) * layers;
+}
+
+/* Render target bytes are an upper bound: every draw or clear is assumed
+ * to write the whole of each bound attachment once.
+ */
+static void
+pr_account_render(struct pr_context *pctx, unsigned buffers)
+{
+   const struct pipe_framebuffer_state *fb = &pctx->fb;
+
+   for (unsigned i = 0; i < fb->nr_cbufs; i++) {
+      if (fb->cbufs[i] && (buffers & (PIPE_CLEAR_COLOR0 << i)))
+         pr_account_surface(pctx->pscreen, fb->cbufs[i]);
+   }
+   if (fb->zsbuf && (buffers & PIPE_CLEAR_DEPTHSTENCIL))
+      pr_account_surface(pctx->pscreen, fb->zsbuf);
+}
+
+static void
+pr_account_transfer(struct pr_screen *pscreen, struct pipe_resource *res,
+                    unsigned usage, const struct pipe_box *box)
+{
+   struct pr_resource *r = pr_resource(pscreen, res);
+   if (!r)
+      return;
+
+   uint64_t bytes = pr_box_bytes(res, res->format, box);
+   if (usage & PIPE_MAP_WRITE) {
+      r->upload_bytes += bytes;
+      r->uploads++;
+   }
+   if (usage & PIPE_MAP_READ)
+      r->download_bytes += bytes;
+}
+
+/* Counts a call, and returns whether it should be timed.  Must be called
+ * with pr_lock held.
+ */
+static bool
+pr_sample(struct pr_screen *pscreen, enum pr_call call)
+{
+   return pscreen->calls[call].count++ % pscreen->sample_interval == 0;
+}
+
+static void
+pr_end_sample(struct pr_screen *pscreen, enum pr_call call, int64_t start)
+{
+   p_atomic_inc(&pscreen->calls[call].sampled);
+   p_atomic_add(&pscreen->calls[call].sampled_ns,
+                os_time_get_nano() - start);
+}
+
+static void
+pr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
+            unsigned drawid_offset,
+            const struct pipe_draw_indirect_info *indirect,
+            const struct pipe_draw_start_count_bias *draws,
+            unsigned num_draws)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_account_render(pctx, PIPE_CLEAR_COLOR | PIPE_CLEAR_DEPTHSTENCIL);
+   pr_shader_use(pctx->pscreen, "vs", pctx->vs);
+   pr_shader_use(pctx->pscreen, "fs", pctx->fs);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_DRAW_VBO);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->draw_vbo(pipe, info, drawid_offset, indirect, draws, num_draws);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_DRAW_VBO, start);
+}
+
+static void
+pr_launch_grid(struct pipe_context *pipe, const struct pipe_grid_info *info)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_shader_use(pctx->pscreen, "cs", pctx->cs);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_LAUNCH_GRID);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->launch_grid(pipe, info);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_LAUNCH_GRID, start);
+}
+
+static void
+pr_clear(struct pipe_context *pipe, unsigned buffers,
+         const struct pipe_scissor_state *scissor_state,
+         const union pipe_color_union *color, double depth, unsigned stencil)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_account_render(pctx, buffers);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_CLEAR);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->clear(pipe, buffers, scissor_state, color, depth, stencil);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_CLEAR, start);
+}
+
+static void
+pr_blit(struct pipe_context *pipe, const struct pipe_blit_info *info)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   struct pr_resource *src = pr_resource(pctx->pscreen, info->src.resource);
+   if (src) {
+      src->blit_bytes += pr_box_bytes(info->src.resource, info->src.format,
+                                      &info->src.box);
+   }
+   struct pr_resource *dst = pr_resource(pctx->pscreen, info->dst.resource);
+   if (dst) {
+      dst->blit_bytes += pr_box_bytes(info->dst.resource, info->dst.format,
+                                      &info->dst.box);
+   }
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_BLIT);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->blit(pipe, info);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_BLIT, start);
+}
+
+static void
+pr_resource_copy_region(struct pipe_context *pipe,
+                        struct pipe_resource *dst, unsigned dst_level,
+                        unsigned dstx, unsigned dsty, unsigned dstz,
+                        struct pipe_resource *src, unsigned src_level,
+                        const struct pipe_box *src_box)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   uint64_t bytes = pr_box_bytes(src, src->format, src_box);
+   struct pr_resource *r = pr_resource(pctx->pscreen, src);
+   if (r)
+      r->blit_bytes += bytes;
+   r = pr_resource(pctx->pscreen, dst);
+   if (r)
+      r->blit_bytes += bytes;
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_RESOURCE_COPY_REGION);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->resource_copy_region(pipe, dst, dst_level, dstx, dsty, dstz,
+                              src, src_level, src_box);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_RESOURCE_COPY_REGION, start);
+}
+
+static void *
+pr_buffer_map(struct pipe_context *pipe, struct pipe_resource *resource,
+              unsigned level, unsigned usage, const struct pipe_box *box,
+              struct pipe_transfer **out_transfer)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_account_transfer(pctx->pscreen, resource, usage, box);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_BUFFER_MAP);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   void *map = pctx->buffer_map(pipe, resource, level, usage, box,
+                                out_transfer);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_BUFFER_MAP, start);
+   return map;
+}
+
+static void *
+pr_texture_map(struct pipe_context *pipe, struct pipe_resource *resource,
+               unsigned level, unsigned usage, const struct pipe_box *box,
+               struct pipe_transfer **out_transfer)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_account_transfer(pctx->pscreen, resource, usage, box);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_TEXTURE_MAP);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   void *map = pctx->texture_map(pipe, resource, level, usage, box,
+                                 out_transfer);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_TEXTURE_MAP, start);
+   return map;
+}
+
+static void
+pr_buffer_subdata(struct pipe_context *pipe, struct pipe_resource *resource,
+                  unsigned usage, unsigned offset, unsigned size,
+                  const void *data)
+{
+   uint32_t hash = _mesa_hash_data(data, size);
+
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   struct pr_resource *r = pr_resource(pctx->pscreen, resource);
+   if (r) {
+      if (r->uploads && r->last_upload_hash == hash &&
+          r->last_upload_offset == offset && r->last_upload_size == size)
+         r->redundant_uploads++;
+      r->last_upload_hash = hash;
+      r->last_upload_offset = offset;
+      r->last_upload_size = size;
+      r->upload_bytes += size;
+      r->uploads++;
+   }
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_BUFFER_SUBDATA);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->buffer_subdata(pipe, resource, usage, offset, size, data);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_BUFFER_SUBDATA, start);
+}
+
+static void
+pr_texture_subdata(struct pipe_context *pipe, struct pipe_resource *resource,
+                   unsigned level, unsigned usage, const struct pipe_box *box,
+                   const void *data, unsigned stride, unsigned layer_stride)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   pr_account_transfer(pctx->pscreen, resource, PIPE_MAP_WRITE, box);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_TEXTURE_SUBDATA);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->texture_subdata(pipe, resource, level, usage, box, data, stride,
+                         layer_stride);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_TEXTURE_SUBDATA, start);
+}
+
+static void
+pr_set_framebuffer_state(struct pipe_context *pipe,
+                         const struct pipe_framebuffer_state *state)
+{
+   /* Dropping a surface reference can destroy a resource, which takes the
+    * lock, so copy the state without it.
+    */
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   simple_mtx_unlock(&pr_lock);
+
+   util_copy_framebuffer_state(&pctx->fb, state);
+
+   simple_mtx_lock(&pr_lock);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_SET_FRAMEBUFFER_STATE);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->set_framebuffer_state(pipe, state);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_SET_FRAMEBUFFER_STATE, start);
+}
+
+static void
+pr_flush(struct pipe_context *pipe, struct pipe_fence_handle **fence,
+         unsigned flags)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   bool sampled = pr_sample(pctx->pscreen, PR_CALL_FLUSH);
+   simple_mtx_unlock(&pr_lock);
+
+   int64_t start = sampled ? os_time_get_nano() : 0;
+   pctx->flush(pipe, fence, flags);
+   if (sampled)
+      pr_end_sample(pctx->pscreen, PR_CALL_FLUSH, start);
+}
+
+/* The bound CSOs are per context state, the lock is only needed for the
+ * lookup.
+ */
+static void
+pr_bind_vs_state(struct pipe_context *pipe, void *state)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   simple_mtx_unlock(&pr_lock);
+
+   pctx->vs = state;
+   pctx->bind_vs_state(pipe, state);
+}
+
+static void
+pr_bind_fs_state(struct pipe_context *pipe, void *state)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   simple_mtx_unlock(&pr_lock);
+
+   pctx->fs = state;
+   pctx->bind_fs_state(pipe, state);
+}
+
+static void
+pr_bind_compute_state(struct pipe_context *pipe, void *state)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   simple_mtx_unlock(&pr_lock);
+
+   pctx->cs = state;
+   pctx->bind_compute_state(pipe, state);
+}
+
+static void
+pr_context_destroy(struct pipe_context *pipe)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_context *pctx = pr_lookup(pipe);
+   _mesa_hash_table_remove_key(pr_objects, pipe);
+   simple_mtx_unlock(&pr_lock);
+
+   util_unreference_framebuffer_state(&pctx->fb);
+   pctx->destroy(pipe);
+   FREE(pctx);
+}
+
+static struct pipe_context *
+pr_context_create(struct pipe_screen *screen, void *priv, unsigned flags)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_screen *pscreen = pr_lookup(screen);
+   simple_mtx_unlock(&pr_lock);
+
+   struct pipe_context *pipe = pscreen->context_create(screen, priv, flags);
+   if (!pipe)
+      return NULL;
+
+   struct pr_context *pctx = CALLOC_STRUCT(pr_context);
+   if (!pctx)
+      return pipe;
+
+   pctx->pscreen = pscreen;
+
+#define PR_HOOK(name, hook) \
+   if (pipe->name) { \
+      pctx->name = pipe->name; \
+      pipe->name = hook; \
+   }
+
+   PR_HOOK(destroy, pr_context_destroy);
+   PR_HOOK(draw_vbo, pr_draw_vbo);
+   PR_HOOK(launch_grid, pr_launch_grid);
+   PR_HOOK(clear, pr_clear);
+   PR_HOOK(blit, pr_blit);
+   PR_HOOK(resource_copy_region, pr_resource_copy_region);
+   PR_HOOK(buffer_map, pr_buffer_map);
+   PR_HOOK(texture_map, pr_texture_map);
+   PR_HOOK(buffer_subdata, pr_buffer_subdata);
+   PR_HOOK(texture_subdata, pr_texture_subdata);
+   PR_HOOK(set_framebuffer_state, pr_set_framebuffer_state);
+   PR_HOOK(flush, pr_flush);
+   PR_HOOK(bind_vs_state, pr_bind_vs_state);
+   PR_HOOK(bind_fs_state, pr_bind_fs_state);
+   PR_HOOK(bind_compute_state, pr_bind_compute_state);
+
+#undef PR_HOOK
+
+   simple_mtx_lock(&pr_lock);
+   _mesa_hash_table_insert(pr_objects, pipe, pctx);
+   simple_mtx_unlock(&pr_lock);
+
+   return pipe;
+}
+
+static void
+pr_resource_destroy(struct pipe_screen *screen, struct pipe_resource *res)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_screen *pscreen = pr_lookup(screen);
+   struct hash_entry *entry = _mesa_hash_table_search(pscreen->resources, res);
+   if (entry) {
+      util_dynarray_append(&pscreen->retired, struct pr_resource *,
+                           entry->data);
+      _mesa_hash_table_remove(pscreen->resources, entry);
+   }
+   simple_mtx_unlock(&pr_lock);
+
+   pscreen->resource_destroy(screen, res);
+}
+
+static uint64_t
+pr_resource_total(const struct pr_resource *r)
+{
+   return r->upload_bytes + r->download_bytes + r->blit_bytes +
+          r->render_bytes;
+}
+
+static int
+pr_cmp_resource(const void *a, const void *b)
+{
+   uint64_t ta = pr_resource_total(*(const struct pr_resource *const *)a);
+   uint64_t tb = pr_resource_total(*(const struct pr_resource *const *)b);
+   return ta < tb ? 1 : ta > tb ? -1 : 0;
+}
+
+static int
+pr_cmp_shader(const void *a, const void *b)
+{
+   uint64_t ua = (*(const struct pr_shader *const *)a)->uses;
+   uint64_t ub = (*(const struct pr_shader *const *)b)->uses;
+   return ua < ub ? 1 : ua > ub ? -1 : 0;
+}
+
+static void
+pr_print_summary(struct pr_screen *pscreen)
+{
+   const unsigned top = debug_get_option_profile_top();
+
+   fprintf(stderr, "profile: %-22s %12s %10s %10s\n",
+           "call", "count", "sampled", "avg ns");
+   for (unsigned i = 0; i < PR_CALL_COUNT; i++) {
+      const struct pr_call_stats *stats = &pscreen->calls[i];
+      if (!stats->count)
+         continue;
+      fprintf(stderr, "profile: %-22s %12"PRIu64" %10"PRIu64" %10"PRIu64"\n",
+              pr_call_names[i], stats->count, stats->sampled,
+              stats->sampled ? stats->sampled_ns / stats->sampled : 0);
+   }
+
+   /* Resources, ranked by the total number of bytes moved */
+   struct util_dynarray all;
+   util_dynarray_clone(&all, NULL, &pscreen->retired);
+   hash_table_foreach(pscreen->resources, entry)
+      util_dynarray_append(&all, struct pr_resource *, entry->data);
+
+   unsigned count = util_dynarray_num_elements(&all, struct pr_resource *);
+   qsort(all.data, count, sizeof(struct pr_resource *), pr_cmp_resource);
+
+   fprintf(stderr, "profile:\nprofile: %-36s %12s %12s %12s %12s %8s %9s\n",
+           "resource", "upload", "download", "blit", "render", "uploads",
+           "redundant");
+   for (unsigned i = 0; i < MIN2(count, top); i++) {
+      const struct pr_resource *r =
+         *util_dynarray_element(&all, struct pr_resource *, i);
+      char desc[64];
+
+      snprintf(desc, sizeof(desc), "%s %ux%ux%u %s",
+               util_str_tex_target(r->target, true), r->width0, r->height0,
+               r->target == PIPE_TEXTURE_3D ? r->depth0 : r->array_size,
+               util_format_short_name(r->format));
+      fprintf(stderr, "profile: %-36s %12"PRIu64" %12"PRIu64" %12"PRIu64
+              " %12"PRIu64" %8u %9u\n", desc, r->upload_bytes,
+              r->download_bytes, r->blit_bytes, r->render_bytes, r->uploads,
+              r->redundant_uploads);
+   }
+   util_dynarray_fini(&all);
+
+   /* Shaders, ranked by the number of draws or dispatches using them */
+   struct util_dynarray shaders;
+   util_dynarray_init(&shaders, NULL);
+   hash_table_foreach(pscreen->shaders, entry)
+      util_dynarray_append(&shaders, struct pr_shader *, entry->data);
+
+   count = util_dynarray_num_elements(&shaders, struct pr_shader *);
+   qsort(shaders.data, count, sizeof(struct pr_shader *), pr_cmp_shader);
+
+   fprintf(stderr, "profile:\nprofile: %-22s %12s\n", "shader", "uses");
+   for (unsigned i = 0; i < MIN2(count, top); i++) {
+      const struct pr_shader *s =
+         *util_dynarray_element(&shaders, struct pr_shader *, i);
+      fprintf(stderr, "profile: %s %-19p %12"PRIu64"\n", s->stage, s->cso,
+              s->uses);
+   }
+   util_dynarray_fini(&shaders);
+}
+
+static void
+pr_screen_destroy(struct pipe_screen *screen)
+{
+   simple_mtx_lock(&pr_lock);
+   struct pr_screen *pscreen = pr_lookup(screen);
+   _mesa_hash_table_remove_key(pr_objects, screen);
+   simple_mtx_unlock(&pr_lock);
+
+   pr_print_summary(pscreen);
+
+   util_dynarray_foreach(&pscreen->retired, struct pr_resource *, r)
+      FREE(*r);
+   util_dynarray_fini(&pscreen->retired);
+   hash_table_foreach(pscreen->resources, entry)
+      FREE(entry->data);
+   _mesa_hash_table_destroy(pscreen->resources, NULL);
+   hash_table_foreach(pscreen->shaders, entry)
+      FREE(entry->data);
+   _mesa_hash_table_destroy(pscreen->shaders, NULL);
+
+   pscreen->destroy(screen);
+   FREE(pscreen);
+}
+
+struct pipe_screen *
+profile_screen_create(struct pipe_screen *screen)
+{
+   if (!debug_get_option_profile())
+      return screen;
+
+   struct pr_screen *pscreen = CALLOC_STRUCT(pr_screen);
+   if (!pscreen)
+      return screen;
+
+   pscreen->sample_interval = MAX2(debug_get_option_profile_sample(), 1);
+   pscreen->resources = _mesa_pointer_hash_table_create(NULL);
+   pscreen->shaders = _mesa_pointer_hash_table_create(NULL);
+   util_dynarray_init(&pscreen->retired, NULL);
+
+   pscreen->destroy = screen->destroy;
+   pscreen->context_create = screen->context_create;
+   pscreen->resource_destroy = screen->resource_destroy;
+   screen->destroy = pr_screen_destroy;
+   screen->context_create = pr_context_create;
+   screen->resource_destroy = pr_resource_destroy;
+
+   simple_mtx_lock(&pr_lock);
+   if (!pr_objects)
+      pr_objects = _mesa_pointer_hash_table_create(NULL);
+   _mesa_hash_table_insert(pr_objects, screen, pscreen);
+   simple_mtx_unlock(&pr_lock);
+
+   return screen;
+}
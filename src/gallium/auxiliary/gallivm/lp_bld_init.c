@@ -453,6 +453,11 @@ lp_build_init(void)
    }
 #endif
 
+   /*
+    * Stay at 256 even with avx512, lots of cpus lower their clocks when
+    * running 512bit instructions. LP_NATIVE_VECTOR_WIDTH=512 gets the 16
+    * wide paths.
+    */
    if (util_get_cpu_caps()->has_avx2 || util_get_cpu_caps()->has_avx) {
       lp_native_vector_width = 256;
    } else {
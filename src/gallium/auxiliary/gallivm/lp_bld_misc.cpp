@@ -63,6 +63,7 @@
 #include <llvm/Support/Host.h>
 #include <llvm/Support/PrettyStackTrace.h>
 #include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/Memory.h>
 #include <llvm/Support/TargetSelect.h>
 #if LLVM_VERSION_MAJOR >= 15
 #include <llvm/Support/MemoryBuffer.h>
@@ -90,9 +91,15 @@
 #include "pipe/p_config.h"
 #include "util/u_debug.h"
 #include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+
+extern "C" {
+#include "util/u_mm.h"
+}
 
 #include "lp_bld_misc.h"
 #include "lp_bld_debug.h"
+#include "lp_bld_type.h"
 
 namespace {
 
@@ -230,6 +237,151 @@ class DelegatingJITMemoryManager : public BaseMemoryManager {
 };
 
 
+/*
+ * Code memory shared by all the modules of the process, so that each shader
+ * doesn't take whole pages for its code and data sections.
+ *
+ * Chunks are mapped read/write/execute once, like rtasm_execmem does, so a
+ * module can be loaded next to code of another one which is running, and
+ * sections are suballocated with u_mm.  Sections are only freed along with
+ * the generated code, see ShaderMemoryManager.
+ */
+class CodePoolMemoryManager : public BaseMemoryManager {
+
+   static const size_t ChunkSize = 4 * 1024 * 1024;
+
+   struct Chunk {
+      llvm::sys::MemoryBlock Block;
+      uint8_t *Base;
+      size_t Size;
+      struct mem_block *Heap;
+      size_t Used;
+   };
+
+   std::vector<Chunk> Chunks;
+   mtx_t Mutex;
+
+   bool addChunk(size_t MinSize) {
+      Chunk C;
+      std::error_code EC;
+
+      C.Size = MAX2(ChunkSize, align64(MinSize, 64 * 1024));
+      C.Block = llvm::sys::Memory::allocateMappedMemory(
+         C.Size, nullptr,
+         llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE |
+         llvm::sys::Memory::MF_EXEC, EC);
+      if (EC)
+         return false;
+
+      C.Base = (uint8_t *)C.Block.base();
+      C.Heap = u_mmInit(0, C.Size);
+      C.Used = 0;
+      if (!C.Heap) {
+         llvm::sys::Memory::releaseMappedMemory(C.Block);
+         return false;
+      }
+
+      Chunks.push_back(C);
+      return true;
+   }
+
+   uint8_t *allocateFromChunk(Chunk &C, uintptr_t Size, int Align2) {
+      struct mem_block *B = u_mmAllocMem(C.Heap, Size, Align2, 0);
+      if (!B)
+         return NULL;
+      C.Used += B->size;
+      return C.Base + B->ofs;
+   }
+
+   public:
+
+      CodePoolMemoryManager() {
+         (void) mtx_init(&Mutex, mtx_plain);
+      }
+
+      virtual ~CodePoolMemoryManager() {
+         for (Chunk &C : Chunks) {
+            u_mmDestroy(C.Heap);
+            llvm::sys::Memory::releaseMappedMemory(C.Block);
+         }
+         mtx_destroy(&Mutex);
+      }
+
+      /* Map the first chunk, which fails where W+X mappings are denied. */
+      bool init() {
+         return addChunk(ChunkSize);
+      }
+
+      uint8_t *allocate(uintptr_t Size, unsigned Alignment) {
+         int Align2 = util_logbase2(MAX2(Alignment, 16));
+         uint8_t *Ptr = NULL;
+
+         Size = MAX2(Size, 1);
+
+         mtx_lock(&Mutex);
+         for (Chunk &C : Chunks) {
+            Ptr = allocateFromChunk(C, Size, Align2);
+            if (Ptr)
+               break;
+         }
+         if (!Ptr && addChunk(Size + (1 << Align2)))
+            Ptr = allocateFromChunk(Chunks.back(), Size, Align2);
+         mtx_unlock(&Mutex);
+
+         return Ptr;
+      }
+
+      void release(void *Ptr) {
+         mtx_lock(&Mutex);
+         for (auto C = Chunks.begin(); C != Chunks.end(); ++C) {
+            if ((uint8_t *)Ptr < C->Base || (uint8_t *)Ptr >= C->Base + C->Size)
+               continue;
+
+            struct mem_block *B = u_mmFindBlock(C->Heap, (uint8_t *)Ptr - C->Base);
+            if (B) {
+               C->Used -= B->size;
+               u_mmFreeMem(B);
+            }
+
+            /* Keep the first chunk around, drop any other once empty. */
+            if (!C->Used && C != Chunks.begin()) {
+               u_mmDestroy(C->Heap);
+               llvm::sys::Memory::releaseMappedMemory(C->Block);
+               Chunks.erase(C);
+            }
+            break;
+         }
+         mtx_unlock(&Mutex);
+      }
+
+      /*
+       * From RTDyldMemoryManager
+       */
+      virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName) {
+         return allocate(Size, Alignment);
+      }
+      virtual uint8_t *allocateDataSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName,
+                                           bool IsReadOnly) {
+         return allocate(Size, Alignment);
+      }
+      virtual bool finalizeMemory(std::string *ErrMsg = 0) {
+         /* Nothing to protect, the instruction cache is flushed per module. */
+         return false;
+      }
+};
+
+static mtx_t code_pool_mutex = _MTX_INITIALIZER_NP;
+static CodePoolMemoryManager *code_pool = NULL;
+static unsigned code_pool_refs = 0;
+static bool code_pool_failed = false;
+
+
 /*
  * Delegate memory management to one shared manager for more efficient use
  * of memory than creating a separate pool for each LLVM engine.
@@ -240,6 +392,11 @@ class DelegatingJITMemoryManager : public BaseMemoryManager {
  * All methods are delegated to the shared manager except destruction and
  * deallocating code.  For the latter we just remember what needs to be
  * deallocated later.  The shared manager is deleted once it is empty.
+ *
+ * With the shared code pool, the sections allocated for the module are
+ * remembered as well and returned to the pool by freeGeneratedCode(), and
+ * EH frames are registered here so that destroying the engine of one module
+ * doesn't deregister those of the others.
  */
 class ShaderMemoryManager : public DelegatingJITMemoryManager {
 
@@ -250,11 +407,23 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
       Vec FunctionBody, ExceptionTable;
       BaseMemoryManager *TheMM;
 
+      /* Sections allocated from the code pool, if TheMM is the pool */
+      std::vector<std::pair<uint8_t *, uintptr_t> > PoolCode, PoolData;
+      size_t FlushedCode;
+
       GeneratedCode(BaseMemoryManager *MM) {
          TheMM = MM;
+         FlushedCode = 0;
       }
 
       ~GeneratedCode() {
+         if (TheMM == code_pool) {
+            CodePoolMemoryManager *Pool = static_cast<CodePoolMemoryManager *>(TheMM);
+            for (auto &S : PoolCode)
+               Pool->release(S.first);
+            for (auto &S : PoolData)
+               Pool->release(S.first);
+         }
       }
    };
 
@@ -264,6 +433,10 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
       return TheMM;
    }
 
+   bool pooled() const {
+      return TheMM == code_pool;
+   }
+
    public:
 
       ShaderMemoryManager(BaseMemoryManager* MM) {
@@ -290,6 +463,59 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
          // remember for later deallocation
          code->FunctionBody.push_back(Body);
       }
+
+      virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName) {
+         uint8_t *Ptr = DelegatingJITMemoryManager::allocateCodeSection(
+            Size, Alignment, SectionID, SectionName);
+         if (Ptr && pooled())
+            code->PoolCode.push_back(std::make_pair(Ptr, Size));
+         return Ptr;
+      }
+      virtual uint8_t *allocateDataSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName,
+                                           bool IsReadOnly) {
+         uint8_t *Ptr = DelegatingJITMemoryManager::allocateDataSection(
+            Size, Alignment, SectionID, SectionName, IsReadOnly);
+         if (Ptr && pooled())
+            code->PoolData.push_back(std::make_pair(Ptr, Size));
+         return Ptr;
+      }
+      virtual void registerEHFrames(uint8_t *Addr, uint64_t LoadAddr, size_t Size) {
+         if (pooled())
+            BaseMemoryManager::registerEHFrames(Addr, LoadAddr, Size);
+         else
+            DelegatingJITMemoryManager::registerEHFrames(Addr, LoadAddr, Size);
+      }
+#if LLVM_VERSION_MAJOR >= 5
+      virtual void deregisterEHFrames() {
+         if (pooled())
+            BaseMemoryManager::deregisterEHFrames();
+         else
+            DelegatingJITMemoryManager::deregisterEHFrames();
+      }
+#else
+      virtual void deregisterEHFrames(uint8_t *Addr, uint64_t LoadAddr, size_t Size) {
+         if (pooled())
+            BaseMemoryManager::deregisterEHFrames(Addr, LoadAddr, Size);
+         else
+            DelegatingJITMemoryManager::deregisterEHFrames(Addr, LoadAddr, Size);
+      }
+#endif
+      virtual bool finalizeMemory(std::string *ErrMsg = 0) {
+         if (!pooled())
+            return DelegatingJITMemoryManager::finalizeMemory(ErrMsg);
+
+         for (; code->FlushedCode < code->PoolCode.size(); code->FlushedCode++) {
+            auto &S = code->PoolCode[code->FlushedCode];
+            llvm::sys::Memory::InvalidateInstructionCache(S.first, S.second);
+         }
+         return false;
+      }
 };
 
 class LPObjectCache : public llvm::ObjectCache {
@@ -393,6 +619,14 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
         ++f) {
       MAttrs.push_back(((*f).second ? "+" : "-") + (*f).first().str());
    }
+#if LLVM_VERSION_MAJOR >= 7 && (defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64))
+   /*
+    * The avx512 cpus prefer 256bit vectors, which makes llvm legalize
+    * 512bit vectors by splitting them. Don't when we asked for them.
+    */
+   if (lp_native_vector_width > 256)
+      MAttrs.push_back("-prefer-256-bit");
+#endif
 #elif defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64)
    /*
     * We need to unset attributes because sometimes LLVM mistakenly assumes
@@ -588,8 +822,28 @@ extern "C"
 LLVMMCJITMemoryManagerRef
 lp_get_default_memory_manager()
 {
-   BaseMemoryManager *mm;
-   mm = new llvm::SectionMemoryManager();
+   BaseMemoryManager *mm = NULL;
+
+   /* Share code pages between all modules unless W+X mappings are denied,
+    * in which case each module gets its own pages as before.
+    */
+   mtx_lock(&code_pool_mutex);
+   if (!code_pool && !code_pool_failed) {
+      code_pool = new CodePoolMemoryManager();
+      if (!code_pool->init()) {
+         delete code_pool;
+         code_pool = NULL;
+         code_pool_failed = true;
+      }
+   }
+   if (code_pool) {
+      code_pool_refs++;
+      mm = code_pool;
+   }
+   mtx_unlock(&code_pool_mutex);
+
+   if (!mm)
+      mm = new llvm::SectionMemoryManager();
    return reinterpret_cast<LLVMMCJITMemoryManagerRef>(mm);
 }
 
@@ -597,7 +851,19 @@ extern "C"
 void
 lp_free_memory_manager(LLVMMCJITMemoryManagerRef memorymgr)
 {
-   delete reinterpret_cast<BaseMemoryManager*>(memorymgr);
+   BaseMemoryManager *mm = reinterpret_cast<BaseMemoryManager*>(memorymgr);
+
+   mtx_lock(&code_pool_mutex);
+   if (mm && mm == code_pool) {
+      if (--code_pool_refs == 0) {
+         delete code_pool;
+         code_pool = NULL;
+      }
+      mm = NULL;
+   }
+   mtx_unlock(&code_pool_mutex);
+
+   delete mm;
 }
 
 extern "C" void
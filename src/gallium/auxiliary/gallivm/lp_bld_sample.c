@@ -2095,16 +2095,64 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
 }
 
 
+/**
+ * Compute the offset of a texel in an image stored in 4x4 micro-tiles.
+ *
+ * Tiles are laid out linearly with the same row stride as the linear layout
+ * (a row of tiles covers four rows of texels), and the texels of a tile are
+ * stored row by row. So the offset is still separable in x and y:
+ *
+ *   x: ((x & ~3) * 4 + (x & 3)) * bpp
+ *   y: (y & ~3) * y_stride + (y & 3) * 4 * bpp
+ */
+static LLVMValueRef
+lp_build_sample_tiled_offset(struct lp_build_context *bld,
+                             unsigned bpp,
+                             LLVMValueRef x,
+                             LLVMValueRef y,
+                             LLVMValueRef y_stride)
+{
+   struct gallivm_state *gallivm = bld->gallivm;
+   LLVMValueRef mask = lp_build_const_int_vec(gallivm, bld->type, 3);
+   LLVMValueRef two = lp_build_const_int_vec(gallivm, bld->type, 2);
+   LLVMValueRef x_stride = lp_build_const_int_vec(gallivm, bld->type, bpp);
+   LLVMValueRef x_lo, x_hi, offset;
+
+   x_lo = lp_build_and(bld, x, mask);
+   x_hi = lp_build_andnot(bld, x, mask);
+   offset = lp_build_add(bld, lp_build_shl(bld, x_hi, two), x_lo);
+
+   if (y && y_stride) {
+      LLVMValueRef y_lo = lp_build_and(bld, y, mask);
+      LLVMValueRef y_hi = lp_build_andnot(bld, y, mask);
+      LLVMValueRef y_offset;
+
+      offset = lp_build_add(bld, offset, lp_build_shl(bld, y_lo, two));
+      offset = lp_build_mul(bld, offset, x_stride);
+      y_offset = lp_build_mul(bld, y_hi, y_stride);
+      offset = lp_build_add(bld, offset, y_offset);
+   }
+   else {
+      offset = lp_build_mul(bld, offset, x_stride);
+   }
+
+   return offset;
+}
+
+
 /**
  * Compute the offset of a pixel block.
  *
  * x, y, z, y_stride, z_stride are vectors, and they refer to pixels.
+ * If tiled is set, the image is stored in 4x4 micro-tiles, which is only
+ * possible for formats with 1x1 pixel blocks.
  *
  * Returns the relative offset and i,j sub-block coordinates
  */
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
+                       boolean tiled,
                        LLVMValueRef x,
                        LLVMValueRef y,
                        LLVMValueRef z,
@@ -2114,27 +2162,37 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef *out_i,
                        LLVMValueRef *out_j)
 {
-   LLVMValueRef x_stride;
    LLVMValueRef offset;
 
-   x_stride = lp_build_const_vec(bld->gallivm, bld->type,
-                                 format_desc->block.bits/8);
+   if (tiled) {
+      assert(format_desc->block.width == 1 && format_desc->block.height == 1);
+      offset = lp_build_sample_tiled_offset(bld, format_desc->block.bits/8,
+                                            x, y, y_stride);
+      *out_i = bld->zero;
+      *out_j = bld->zero;
+   }
+   else {
+      LLVMValueRef x_stride;
 
-   lp_build_sample_partial_offset(bld,
-                                  format_desc->block.width,
-                                  x, x_stride,
-                                  &offset, out_i);
+      x_stride = lp_build_const_vec(bld->gallivm, bld->type,
+                                    format_desc->block.bits/8);
 
-   if (y && y_stride) {
-      LLVMValueRef y_offset;
       lp_build_sample_partial_offset(bld,
-                                     format_desc->block.height,
-                                     y, y_stride,
-                                     &y_offset, out_j);
-      offset = lp_build_add(bld, offset, y_offset);
-   }
-   else {
-      *out_j = bld->zero;
+                                     format_desc->block.width,
+                                     x, x_stride,
+                                     &offset, out_i);
+
+      if (y && y_stride) {
+         LLVMValueRef y_offset;
+         lp_build_sample_partial_offset(bld,
+                                        format_desc->block.height,
+                                        y, y_stride,
+                                        &y_offset, out_j);
+         offset = lp_build_add(bld, offset, y_offset);
+      }
+      else {
+         *out_j = bld->zero;
+      }
    }
 
    if (z && z_stride) {
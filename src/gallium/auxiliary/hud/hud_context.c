@@ -1272,6 +1272,42 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "main-thread-busy") == 0) {
          hud_thread_busy_install(pane, name, true);
       }
+      else if (strcmp(name, "tc-num-syncs") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_SYNCS);
+      }
+      else if (strcmp(name, "tc-map-syncs") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_MAP_SYNCS);
+      }
+      else if (strcmp(name, "tc-query-syncs") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_QUERY_SYNCS);
+      }
+      else if (strcmp(name, "tc-flush-syncs") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_FLUSH_SYNCS);
+      }
+      else if (strcmp(name, "tc-stalls") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_STALLS);
+      }
+      else if (strcmp(name, "tc-merged-draws") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_MERGED_DRAWS);
+      }
+      else if (strcmp(name, "tc-merged-subdata") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_MERGED_SUBDATA);
+      }
+      else if (strcmp(name, "tc-sync-time") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_SYNC_TIME);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_MICROSECONDS;
+      }
+      else if (strcmp(name, "tc-stall-time") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_TC_STALL_TIME);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_MICROSECONDS;
+      }
+      else if (strcmp(name, "upload-bytes") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_UPLOAD_BYTES);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_BYTES;
+      }
+      else if (strcmp(name, "cso-cache-misses") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_CSO_CACHE_MISSES);
+      }
 #ifdef HAVE_GALLIUM_EXTRA_HUD
       else if (sscanf(name, "nic-rx-%s", arg_name) == 1) {
          hud_nic_graph_install(pane, arg_name, NIC_DIRECTION_RX);
@@ -1568,6 +1604,18 @@ print_help(struct pipe_screen *screen)
    for (i = 0; i < num_cpus; i++)
       printf("    cpu%i\n", i);
 
+   puts("    tc-num-syncs");
+   puts("    tc-map-syncs");
+   puts("    tc-query-syncs");
+   puts("    tc-flush-syncs");
+   puts("    tc-stalls");
+   puts("    tc-merged-draws");
+   puts("    tc-merged-subdata");
+   puts("    tc-sync-time");
+   puts("    tc-stall-time");
+   puts("    upload-bytes");
+   puts("    cso-cache-misses");
+
    if (has_occlusion_query(screen))
       puts("    samples-passed");
    if (has_streamout(screen))
@@ -33,6 +33,8 @@
 #include "os/os_thread.h"
 #include "util/u_memory.h"
 #include "util/u_queue.h"
+#include "util/u_threaded_context.h"
+#include "util/u_upload_mgr.h"
 #include <stdio.h>
 #include <inttypes.h>
 #ifdef PIPE_OS_WINDOWS
@@ -399,10 +401,75 @@ struct counter_info {
    int64_t last_time;
 };
 
-static unsigned get_counter(struct hud_graph *gr, enum hud_counter counter)
+static unsigned get_tc_counter(struct pipe_context *pipe,
+                               enum hud_counter counter)
+{
+   /* Only a threaded context has these. */
+   if (!pipe || pipe->draw_vbo != tc_draw_vbo)
+      return 0;
+
+   struct threaded_context *tc = threaded_context(pipe);
+
+   switch (counter) {
+   case HUD_COUNTER_TC_SYNCS:
+      return p_atomic_read(&tc->num_syncs);
+   case HUD_COUNTER_TC_MAP_SYNCS:
+      return p_atomic_read(&tc->num_map_syncs);
+   case HUD_COUNTER_TC_QUERY_SYNCS:
+      return p_atomic_read(&tc->num_query_syncs);
+   case HUD_COUNTER_TC_FLUSH_SYNCS:
+      return p_atomic_read(&tc->num_flush_syncs);
+   case HUD_COUNTER_TC_STALLS:
+      return p_atomic_read(&tc->num_stalls);
+   case HUD_COUNTER_TC_MERGED_DRAWS:
+      return p_atomic_read(&tc->num_merged_draws);
+   case HUD_COUNTER_TC_MERGED_SUBDATA:
+      return p_atomic_read(&tc->num_merged_subdata);
+   case HUD_COUNTER_TC_SYNC_TIME:
+      return p_atomic_read(&tc->sync_time_us);
+   case HUD_COUNTER_TC_STALL_TIME:
+      return p_atomic_read(&tc->stall_time_us);
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+static unsigned get_context_counter(struct hud_graph *gr,
+                                    struct pipe_context *pipe,
+                                    enum hud_counter counter)
+{
+   switch (counter) {
+   case HUD_COUNTER_UPLOAD_BYTES: {
+      unsigned bytes = 0;
+
+      if (!pipe)
+         return 0;
+      if (pipe->stream_uploader)
+         bytes += u_upload_get_num_bytes(pipe->stream_uploader);
+      if (pipe->const_uploader &&
+          pipe->const_uploader != pipe->stream_uploader)
+         bytes += u_upload_get_num_bytes(pipe->const_uploader);
+      return bytes;
+   }
+   case HUD_COUNTER_CSO_CACHE_MISSES:
+      return cso_get_num_cache_misses(gr->pane->hud->cso);
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+static unsigned get_counter(struct hud_graph *gr, struct pipe_context *pipe,
+                            enum hud_counter counter)
 {
    struct util_queue_monitoring *mon = gr->pane->hud->monitored_queue;
 
+   if (counter >= HUD_COUNTER_UPLOAD_BYTES)
+      return get_context_counter(gr, pipe, counter);
+   if (counter >= HUD_COUNTER_TC_SYNCS)
+      return get_tc_counter(pipe, counter);
+
    if (!mon || !mon->queue)
       return 0;
 
@@ -427,7 +494,7 @@ query_thread_counter(struct hud_graph *gr, struct pipe_context *pipe)
 
    if (info->last_time) {
       if (info->last_time + gr->pane->period*1000 <= now) {
-         unsigned current_value = get_counter(gr, info->counter);
+         unsigned current_value = get_counter(gr, pipe, info->counter);
 
          hud_graph_add_value(gr, current_value - info->last_value);
          info->last_value = current_value;
@@ -435,7 +502,7 @@ query_thread_counter(struct hud_graph *gr, struct pipe_context *pipe)
       }
    } else {
       /* initialize */
-      info->last_value = get_counter(gr, info->counter);
+      info->last_value = get_counter(gr, pipe, info->counter);
       info->last_time = now;
    }
 }
@@ -38,6 +38,19 @@ enum hud_counter {
    HUD_COUNTER_OFFLOADED,
    HUD_COUNTER_DIRECT,
    HUD_COUNTER_SYNCS,
+   /* u_threaded_context counters */
+   HUD_COUNTER_TC_SYNCS,
+   HUD_COUNTER_TC_MAP_SYNCS,
+   HUD_COUNTER_TC_QUERY_SYNCS,
+   HUD_COUNTER_TC_FLUSH_SYNCS,
+   HUD_COUNTER_TC_STALLS,
+   HUD_COUNTER_TC_MERGED_DRAWS,
+   HUD_COUNTER_TC_MERGED_SUBDATA,
+   HUD_COUNTER_TC_SYNC_TIME,
+   HUD_COUNTER_TC_STALL_TIME,
+   /* counters of the recording context and its uploaders */
+   HUD_COUNTER_UPLOAD_BYTES,
+   HUD_COUNTER_CSO_CACHE_MISSES,
 };
 
 struct hud_context {
@@ -27,10 +27,36 @@
  **************************************************************************/
 
 #include "pb_cache.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/os_time.h"
 
 
+/* The lifetime of a bucket is adjusted after this many hits and expirations,
+ * and never drops below 1/PB_CACHE_MIN_USECS_DIVISOR of the cache's timeout.
+ */
+#define PB_CACHE_ADJUST_INTERVAL 32
+#define PB_CACHE_MIN_USECS_DIVISOR 8
+
+static void
+update_bucket_lifetime(struct pb_cache *mgr, struct pb_cache_bucket *bucket)
+{
+   if (bucket->num_hits + bucket->num_expired < PB_CACHE_ADJUST_INTERVAL)
+      return;
+
+   /* Buffers that mostly expire are wasted memory, so shorten the lifetime.
+    * Buffers that mostly get reused are worth keeping for longer.
+    */
+   if (bucket->num_expired > bucket->num_hits * 2)
+      bucket->usecs = MAX2(bucket->usecs / 2,
+                           mgr->usecs / PB_CACHE_MIN_USECS_DIVISOR);
+   else if (bucket->num_hits > bucket->num_expired)
+      bucket->usecs = MIN2(bucket->usecs * 2, mgr->usecs);
+
+   bucket->num_hits = 0;
+   bucket->num_expired = 0;
+}
+
 /**
  * Actually destroy the buffer.
  */
@@ -54,9 +80,11 @@ destroy_buffer_locked(struct pb_cache_entry *entry)
  * Free as many cache buffers from the list head as possible.
  */
 static void
-release_expired_buffers_locked(struct list_head *cache,
+release_expired_buffers_locked(struct pb_cache *mgr,
+                               struct pb_cache_bucket *bucket,
                                int64_t current_time)
 {
+   struct list_head *cache = &bucket->buffers;
    struct list_head *curr, *next;
    struct pb_cache_entry *entry;
 
@@ -69,10 +97,50 @@ release_expired_buffers_locked(struct list_head *cache,
          break;
 
       destroy_buffer_locked(entry);
+      bucket->num_expired++;
 
       curr = next;
       next = curr->next;
    }
+
+   update_bucket_lifetime(mgr, bucket);
+}
+
+/**
+ * Free the least recently added buffers until the cache holds at most
+ * target_size bytes.
+ */
+static uint64_t
+trim_locked(struct pb_cache *mgr, uint64_t target_size)
+{
+   uint64_t freed = 0;
+   unsigned i;
+
+   while (mgr->cache_size > target_size) {
+      struct pb_cache_entry *oldest = NULL;
+
+      /* Each bucket is sorted by age, so only the heads need checking. */
+      for (i = 0; i < mgr->num_heaps; i++) {
+         struct list_head *cache = &mgr->buckets[i].buffers;
+         struct pb_cache_entry *entry;
+
+         if (list_is_empty(cache))
+            continue;
+
+         entry = LIST_ENTRY(struct pb_cache_entry, cache->next, head);
+         if (!oldest || entry->start < oldest->start)
+            oldest = entry;
+      }
+
+      if (!oldest)
+         break;
+
+      freed += oldest->buffer->size;
+      mgr->buckets[oldest->bucket_index].num_expired++;
+      destroy_buffer_locked(oldest);
+   }
+
+   return freed;
 }
 
 /**
@@ -83,7 +151,7 @@ void
 pb_cache_add_buffer(struct pb_cache_entry *entry)
 {
    struct pb_cache *mgr = entry->mgr;
-   struct list_head *cache = &mgr->buckets[entry->bucket_index];
+   struct pb_cache_bucket *bucket = &mgr->buckets[entry->bucket_index];
    struct pb_buffer *buf = entry->buffer;
    unsigned i;
 
@@ -93,7 +161,7 @@ pb_cache_add_buffer(struct pb_cache_entry *entry)
    int64_t current_time = os_time_get();
 
    for (i = 0; i < mgr->num_heaps; i++)
-      release_expired_buffers_locked(&mgr->buckets[i], current_time);
+      release_expired_buffers_locked(mgr, &mgr->buckets[i], current_time);
 
    /* Directly release any buffer that exceeds the limit. */
    if (mgr->cache_size + buf->size > mgr->max_cache_size) {
@@ -103,8 +171,8 @@ pb_cache_add_buffer(struct pb_cache_entry *entry)
    }
 
    entry->start = os_time_get();
-   entry->end = entry->start + mgr->usecs;
-   list_addtail(&entry->head, cache);
+   entry->end = entry->start + bucket->usecs;
+   list_addtail(&entry->head, &bucket->buffers);
    ++mgr->num_buffers;
    mgr->cache_size += buf->size;
    simple_mtx_unlock(&mgr->mutex);
@@ -155,7 +223,8 @@ pb_cache_reclaim_buffer(struct pb_cache *mgr, pb_size size,
    int ret = 0;
 
    assert(bucket_index < mgr->num_heaps);
-   struct list_head *cache = &mgr->buckets[bucket_index];
+   struct pb_cache_bucket *bucket = &mgr->buckets[bucket_index];
+   struct list_head *cache = &bucket->buffers;
 
    simple_mtx_lock(&mgr->mutex);
 
@@ -171,9 +240,10 @@ pb_cache_reclaim_buffer(struct pb_cache *mgr, pb_size size,
       if (!entry && (ret = pb_cache_is_buffer_compat(cur_entry, size,
                                                      alignment, usage)) > 0)
          entry = cur_entry;
-      else if (os_time_timeout(cur_entry->start, cur_entry->end, now))
+      else if (os_time_timeout(cur_entry->start, cur_entry->end, now)) {
          destroy_buffer_locked(cur_entry);
-      else
+         bucket->num_expired++;
+      } else
          /* This buffer (and all hereafter) are still hot in cache */
          break;
 
@@ -210,6 +280,8 @@ pb_cache_reclaim_buffer(struct pb_cache *mgr, pb_size size,
       mgr->cache_size -= buf->size;
       list_del(&entry->head);
       --mgr->num_buffers;
+      bucket->num_hits++;
+      update_bucket_lifetime(mgr, bucket);
       simple_mtx_unlock(&mgr->mutex);
       /* Increase refcount */
       pipe_reference_init(&buf->reference, 1);
@@ -232,7 +304,7 @@ pb_cache_release_all_buffers(struct pb_cache *mgr)
 
    simple_mtx_lock(&mgr->mutex);
    for (i = 0; i < mgr->num_heaps; i++) {
-      struct list_head *cache = &mgr->buckets[i];
+      struct list_head *cache = &mgr->buckets[i].buffers;
 
       curr = cache->next;
       next = curr->next;
@@ -246,6 +318,37 @@ pb_cache_release_all_buffers(struct pb_cache *mgr)
    simple_mtx_unlock(&mgr->mutex);
 }
 
+/**
+ * Release the oldest cached buffers until at most target_size bytes remain
+ * cached. Meant to be called when the system is under memory pressure.
+ *
+ * \return the number of bytes released
+ */
+uint64_t
+pb_cache_trim(struct pb_cache *mgr, uint64_t target_size)
+{
+   uint64_t freed;
+
+   simple_mtx_lock(&mgr->mutex);
+   freed = trim_locked(mgr, target_size);
+   simple_mtx_unlock(&mgr->mutex);
+
+   return freed;
+}
+
+/**
+ * Change the memory budget of the cache, releasing buffers if the cache
+ * currently holds more than the new budget.
+ */
+void
+pb_cache_set_max_size(struct pb_cache *mgr, uint64_t max_cache_size)
+{
+   simple_mtx_lock(&mgr->mutex);
+   mgr->max_cache_size = max_cache_size;
+   trim_locked(mgr, max_cache_size);
+   simple_mtx_unlock(&mgr->mutex);
+}
+
 void
 pb_cache_init_entry(struct pb_cache *mgr, struct pb_cache_entry *entry,
                     struct pb_buffer *buf, unsigned bucket_index)
@@ -266,7 +369,8 @@ pb_cache_init_entry(struct pb_cache *mgr, struct pb_cache_entry *entry,
  *                   for faster buffer matching (alternative to slower
  *                   "usage"-based matching).
  * @param usecs   Unused buffers may be released from the cache after this
- *                time
+ *                time. Buckets whose buffers are rarely reused release
+ *                them sooner.
  * @param size_factor  Declare buffers that are size_factor times bigger than
  *                     the requested size as cache hits.
  * @param bypass_usage  Bitmask. If (requested usage & bypass_usage) != 0,
@@ -286,12 +390,14 @@ pb_cache_init(struct pb_cache *mgr, uint num_heaps,
 {
    unsigned i;
 
-   mgr->buckets = CALLOC(num_heaps, sizeof(struct list_head));
+   mgr->buckets = CALLOC(num_heaps, sizeof(struct pb_cache_bucket));
    if (!mgr->buckets)
       return;
 
-   for (i = 0; i < num_heaps; i++)
-      list_inithead(&mgr->buckets[i]);
+   for (i = 0; i < num_heaps; i++) {
+      list_inithead(&mgr->buckets[i].buffers);
+      mgr->buckets[i].usecs = usecs;
+   }
 
    (void) simple_mtx_init(&mgr->mutex, mtx_plain);
    mgr->winsys = winsys;
@@ -46,12 +46,28 @@ struct pb_cache_entry
    unsigned bucket_index;
 };
 
+/**
+ * Per-bucket state. The lifetime of cached buffers adapts to how often the
+ * bucket's buffers are actually reused before they expire, so buckets that
+ * only ever see one-off sizes stop holding on to memory for the full
+ * timeout.
+ */
+struct pb_cache_bucket
+{
+   struct list_head buffers;
+   unsigned usecs;          /**< Current lifetime of buffers in the bucket */
+
+   /* Statistics since the last lifetime adjustment. */
+   unsigned num_hits;       /**< Buffers reclaimed from the bucket */
+   unsigned num_expired;    /**< Buffers released without being reused */
+};
+
 struct pb_cache
 {
    /* The cache is divided into buckets for minimizing cache misses.
     * The driver controls which buffer goes into which bucket.
     */
-   struct list_head *buckets;
+   struct pb_cache_bucket *buckets;
 
    simple_mtx_t mutex;
    void *winsys;
@@ -72,6 +88,8 @@ struct pb_buffer *pb_cache_reclaim_buffer(struct pb_cache *mgr, pb_size size,
                                           unsigned alignment, unsigned usage,
                                           unsigned bucket_index);
 void pb_cache_release_all_buffers(struct pb_cache *mgr);
+uint64_t pb_cache_trim(struct pb_cache *mgr, uint64_t target_size);
+void pb_cache_set_max_size(struct pb_cache *mgr, uint64_t max_cache_size);
 void pb_cache_init_entry(struct pb_cache *mgr, struct pb_cache_entry *entry,
                          struct pb_buffer *buf, unsigned bucket_index);
 void pb_cache_init(struct pb_cache *mgr, uint num_heaps,
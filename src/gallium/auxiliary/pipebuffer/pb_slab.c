@@ -27,6 +27,7 @@
 
 #include "pb_slab.h"
 
+#include "util/u_atomic.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 
@@ -56,6 +57,8 @@ pb_slab_reclaim(struct pb_slabs *slabs, struct pb_slab_entry *entry)
    struct pb_slab *slab = entry->slab;
 
    list_del(&entry->head); /* remove from reclaim list */
+   assert(slabs->num_reclaim);
+   slabs->num_reclaim--;
    list_add(&entry->head, &slab->free);
    slab->num_free++;
 
@@ -71,8 +74,38 @@ pb_slab_reclaim(struct pb_slabs *slabs, struct pb_slab_entry *entry)
    }
 }
 
+/* Move everything that was freed since the last call to the reclaim list,
+ * oldest entry first, so that the list stays in the order in which the
+ * entries are likely to become idle.
+ */
+static void
+pb_slabs_drain_free_pending_locked(struct pb_slabs *slabs)
+{
+   struct pb_slab_entry *entry = p_atomic_xchg(&slabs->free_pending, NULL);
+   struct pb_slab_entry *oldest = NULL;
+
+   /* Reverse the stack. */
+   while (entry) {
+      struct pb_slab_entry *next = entry->next_free;
+      entry->next_free = oldest;
+      oldest = entry;
+      entry = next;
+   }
+
+   for (entry = oldest; entry; entry = entry->next_free) {
+      list_addtail(&entry->head, &slabs->reclaim);
+      slabs->num_reclaim++;
+   }
+}
+
 #define MAX_FAILED_RECLAIMS 2
 
+/* Every this many calls, pb_slab_free takes the mutex and tries to reclaim
+ * some entries itself, so that slabs which became empty are released even if
+ * no allocation comes along for their group. Must be a power of two.
+ */
+#define FREE_RECLAIM_THRESHOLD 256
+
 static void
 pb_slabs_reclaim_locked(struct pb_slabs *slabs)
 {
@@ -148,6 +181,7 @@ pb_slab_alloc_reclaimed(struct pb_slabs *slabs, unsigned size, unsigned heap, bo
     */
    if (list_is_empty(&group->slabs) ||
        list_is_empty(&LIST_ENTRY(struct pb_slab, group->slabs.next, head)->free)) {
+      pb_slabs_drain_free_pending_locked(slabs);
       if (reclaim_all)
          pb_slabs_reclaim_all_locked(slabs);
       else
@@ -204,9 +238,22 @@ pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
 void
 pb_slab_free(struct pb_slabs* slabs, struct pb_slab_entry *entry)
 {
-   simple_mtx_lock(&slabs->mutex);
-   list_addtail(&entry->head, &slabs->reclaim);
-   simple_mtx_unlock(&slabs->mutex);
+   struct pb_slab_entry *head;
+
+   /* This is a push-only stack that is drained as a whole, so there is no
+    * ABA problem.
+    */
+   do {
+      head = p_atomic_read(&slabs->free_pending);
+      entry->next_free = head;
+   } while (p_atomic_cmpxchg(&slabs->free_pending, head, entry) != head);
+
+   if ((p_atomic_inc_return(&slabs->num_frees) & (FREE_RECLAIM_THRESHOLD - 1)) == 0) {
+      simple_mtx_lock(&slabs->mutex);
+      pb_slabs_drain_free_pending_locked(slabs);
+      pb_slabs_reclaim_locked(slabs);
+      simple_mtx_unlock(&slabs->mutex);
+   }
 }
 
 /* Check if any of the entries handed to pb_slab_free are ready to be re-used.
@@ -219,10 +266,25 @@ void
 pb_slabs_reclaim(struct pb_slabs *slabs)
 {
    simple_mtx_lock(&slabs->mutex);
+   pb_slabs_drain_free_pending_locked(slabs);
    pb_slabs_reclaim_locked(slabs);
    simple_mtx_unlock(&slabs->mutex);
 }
 
+/* Reclaim every entry that is ready to be re-used, not just the oldest ones,
+ * which releases all slabs that have become empty.
+ *
+ * This is meant to be called when memory is short.
+ */
+void
+pb_slabs_trim(struct pb_slabs *slabs)
+{
+   simple_mtx_lock(&slabs->mutex);
+   pb_slabs_drain_free_pending_locked(slabs);
+   pb_slabs_reclaim_all_locked(slabs);
+   simple_mtx_unlock(&slabs->mutex);
+}
+
 /* Initialize the slabs manager.
  *
  * The minimum and maximum size of slab entries are 2^min_order and
@@ -256,6 +318,9 @@ pb_slabs_init(struct pb_slabs *slabs,
    slabs->slab_free = slab_free;
 
    list_inithead(&slabs->reclaim);
+   slabs->num_reclaim = 0;
+   slabs->free_pending = NULL;
+   slabs->num_frees = 0;
 
    num_groups = slabs->num_orders * slabs->num_heaps *
                 (1 + allow_three_fourth_allocations);
@@ -285,6 +350,7 @@ pb_slabs_deinit(struct pb_slabs *slabs)
    /* Reclaim all slab entries (even those that are still in flight). This
     * implicitly calls slab_free for everything.
     */
+   pb_slabs_drain_free_pending_locked(slabs);
    while (!list_is_empty(&slabs->reclaim)) {
       struct pb_slab_entry *entry =
          LIST_ENTRY(struct pb_slab_entry, slabs->reclaim.next, head);
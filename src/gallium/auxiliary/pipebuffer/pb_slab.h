@@ -61,6 +61,7 @@ struct pb_slab_group;
 struct pb_slab_entry
 {
    struct list_head head;
+   struct pb_slab_entry *next_free; /* link in pb_slabs::free_pending */
    struct pb_slab *slab; /* the slab that contains this buffer */
    unsigned group_index; /* index into pb_slabs::groups */
    unsigned entry_size;
@@ -127,6 +128,15 @@ struct pb_slabs
     * the most-recently freed entry.
     */
    struct list_head reclaim;
+   unsigned num_reclaim; /* number of entries in the reclaim list */
+
+   /* Lock-free stack of entries passed to pb_slab_free that haven't been
+    * moved to the reclaim list yet. The head is the most-recently freed
+    * entry. Frees only push to it, so destroying buffers doesn't contend on
+    * the mutex; the stack is drained whenever the mutex is taken anyway.
+    */
+   struct pb_slab_entry *free_pending;
+   unsigned num_frees; /* total number of pb_slab_free calls */
 
    void *priv;
    slab_can_reclaim_fn *can_reclaim;
@@ -146,6 +156,9 @@ pb_slab_free(struct pb_slabs* slabs, struct pb_slab_entry *entry);
 void
 pb_slabs_reclaim(struct pb_slabs *slabs);
 
+void
+pb_slabs_trim(struct pb_slabs *slabs);
+
 bool
 pb_slabs_init(struct pb_slabs *slabs,
               unsigned min_order, unsigned max_order,
@@ -1517,6 +1517,44 @@ void sse2_pcmpgtd(struct x86_function *p,
    emit_modrm(p, dst, src);
 }
 
+/***********************************************************************
+ * SSE4.1 instructions
+ */
+
+static void sse41_pmov( struct x86_function *p,
+                        struct x86_reg dst,
+                        struct x86_reg src,
+                        unsigned char op )
+{
+   emit_2ub(p, 0x66, X86_TWOB);
+   emit_2ub(p, 0x38, op);
+   emit_modrm( p, dst, src );
+}
+
+void sse41_pmovsxbd( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
+{
+   DUMP_RR( dst, src );
+   sse41_pmov(p, dst, src, 0x21);
+}
+
+void sse41_pmovsxwd( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
+{
+   DUMP_RR( dst, src );
+   sse41_pmov(p, dst, src, 0x23);
+}
+
+void sse41_pmovzxbd( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
+{
+   DUMP_RR( dst, src );
+   sse41_pmov(p, dst, src, 0x31);
+}
+
+void sse41_pmovzxwd( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
+{
+   DUMP_RR( dst, src );
+   sse41_pmov(p, dst, src, 0x33);
+}
+
 /***********************************************************************
  * x87 instructions
  */
@@ -272,6 +272,11 @@ void sse2_pshufd( struct x86_function *p, struct x86_reg dst, struct x86_reg src
 
 void sse2_pcmpgtd( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
 
+void sse41_pmovsxbd( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
+void sse41_pmovsxwd( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
+void sse41_pmovzxbd( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
+void sse41_pmovzxwd( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
+
 void sse_prefetchnta( struct x86_function *p, struct x86_reg ptr);
 void sse_prefetch0( struct x86_function *p, struct x86_reg ptr);
 void sse_prefetch1( struct x86_function *p, struct x86_reg ptr);
@@ -15,6 +15,7 @@
 #include "driver_trace/tr_public.h"
 #include "driver_rbug/rbug_public.h"
 #include "driver_noop/noop_public.h"
+#include "driver_profile/pr_public.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +28,7 @@ extern "C" {
 static inline struct pipe_screen *
 debug_screen_wrap(struct pipe_screen *screen)
 {
+   screen = profile_screen_create(screen);
    screen = ddebug_screen_create(screen);
    screen = rbug_screen_create(screen);
    screen = trace_screen_create(screen);
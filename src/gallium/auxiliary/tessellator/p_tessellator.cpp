@@ -43,6 +43,8 @@ namespace pipe_tessellator_wrap
       PIPE_ALIGN_VAR(32) float     domain_points_u[MAX_POINT_COUNT];
       PIPE_ALIGN_VAR(32) float     domain_points_v[MAX_POINT_COUNT];
       uint32_t               num_domain_points;
+      bool                   have_last_factors;
+      struct pipe_tessellation_factors last_factors;
 
    public:
       void Init(enum pipe_prim_type tes_prim_mode,
@@ -70,10 +72,43 @@ namespace pipe_tessellator_wrap
 
          prim_mode          = tes_prim_mode;
          num_domain_points = 0;
+         have_last_factors = false;
       }
 
       void Tessellate(const struct pipe_tessellation_factors *tess_factors,
                       struct pipe_tessellator_data *tess_data)
+      {
+         /* Most patches of a draw use the same factors, and the result of
+          * the last tessellation is still in our buffers.
+          */
+         if (!SameFactorsAsLast(tess_factors)) {
+            if (!TessellateDomain(tess_factors))
+               return;
+
+            last_factors = *tess_factors;
+            have_last_factors = true;
+         }
+
+         tess_data->num_domain_points = num_domain_points;
+         tess_data->domain_points_u = &domain_points_u[0];
+         tess_data->domain_points_v = &domain_points_v[0];
+
+         tess_data->num_indices = (uint32_t)SUPER::GetIndexCount();
+
+         tess_data->indices = (uint32_t*)SUPER::GetIndices();
+      }
+
+   private:
+      bool SameFactorsAsLast(const struct pipe_tessellation_factors *tess_factors)
+      {
+         return have_last_factors &&
+            memcmp(last_factors.outer_tf, tess_factors->outer_tf,
+                   sizeof(tess_factors->outer_tf)) == 0 &&
+            memcmp(last_factors.inner_tf, tess_factors->inner_tf,
+                   sizeof(tess_factors->inner_tf)) == 0;
+      }
+
+      bool TessellateDomain(const struct pipe_tessellation_factors *tess_factors)
       {
          switch (prim_mode)
             {
@@ -103,7 +138,7 @@ namespace pipe_tessellator_wrap
 
             default:
                assert(0);
-               return;
+               return false;
             }
 
          num_domain_points = (uint32_t)SUPER::GetPointCount();
@@ -113,13 +148,8 @@ namespace pipe_tessellator_wrap
             domain_points_u[i] = points[i].u;
             domain_points_v[i] = points[i].v;
          }
-         tess_data->num_domain_points = num_domain_points;
-         tess_data->domain_points_u = &domain_points_u[0];
-         tess_data->domain_points_v = &domain_points_v[0];
 
-         tess_data->num_indices = (uint32_t)SUPER::GetIndexCount();
-
-         tess_data->indices = (uint32_t*)SUPER::GetIndices();
+         return true;
       }
    };
 } // namespace Tessellator
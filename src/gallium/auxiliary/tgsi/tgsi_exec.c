@@ -63,6 +63,7 @@
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/rounding.h"
+#include "util/u_sse.h"
 
 
 #define DEBUG_EXECUTION 0
@@ -524,10 +525,16 @@ micro_mad(union tgsi_exec_channel *dst,
           const union tgsi_exec_channel *src1,
           const union tgsi_exec_channel *src2)
 {
+#if defined(PIPE_ARCH_SSE)
+   _mm_store_ps(dst->f, _mm_add_ps(_mm_mul_ps(_mm_load_ps(src0->f),
+                                              _mm_load_ps(src1->f)),
+                                   _mm_load_ps(src2->f)));
+#else
    dst->f[0] = src0->f[0] * src1->f[0] + src2->f[0];
    dst->f[1] = src0->f[1] * src1->f[1] + src2->f[1];
    dst->f[2] = src0->f[2] * src1->f[2] + src2->f[2];
    dst->f[3] = src0->f[3] * src1->f[3] + src2->f[3];
+#endif
 }
 
 static void
@@ -1276,10 +1283,14 @@ micro_add(union tgsi_exec_channel *dst,
           const union tgsi_exec_channel *src0,
           const union tgsi_exec_channel *src1)
 {
+#if defined(PIPE_ARCH_SSE)
+   _mm_store_ps(dst->f, _mm_add_ps(_mm_load_ps(src0->f), _mm_load_ps(src1->f)));
+#else
    dst->f[0] = src0->f[0] + src1->f[0];
    dst->f[1] = src0->f[1] + src1->f[1];
    dst->f[2] = src0->f[2] + src1->f[2];
    dst->f[3] = src0->f[3] + src1->f[3];
+#endif
 }
 
 static void
@@ -1343,10 +1354,14 @@ micro_mul(union tgsi_exec_channel *dst,
           const union tgsi_exec_channel *src0,
           const union tgsi_exec_channel *src1)
 {
+#if defined(PIPE_ARCH_SSE)
+   _mm_store_ps(dst->f, _mm_mul_ps(_mm_load_ps(src0->f), _mm_load_ps(src1->f)));
+#else
    dst->f[0] = src0->f[0] * src1->f[0];
    dst->f[1] = src0->f[1] * src1->f[1];
    dst->f[2] = src0->f[2] * src1->f[2];
    dst->f[3] = src0->f[3] * src1->f[3];
+#endif
 }
 
 static void
@@ -1388,10 +1403,14 @@ micro_sub(union tgsi_exec_channel *dst,
           const union tgsi_exec_channel *src0,
           const union tgsi_exec_channel *src1)
 {
+#if defined(PIPE_ARCH_SSE)
+   _mm_store_ps(dst->f, _mm_sub_ps(_mm_load_ps(src0->f), _mm_load_ps(src1->f)));
+#else
    dst->f[0] = src0->f[0] - src1->f[0];
    dst->f[1] = src0->f[1] - src1->f[1];
    dst->f[2] = src0->f[2] - src1->f[2];
    dst->f[3] = src0->f[3] - src1->f[3];
+#endif
 }
 
 static void
@@ -1765,6 +1784,29 @@ store_dest(struct tgsi_exec_machine *mach,
    if (!dst)
       return;
 
+   /* Outside of divergent control flow all lanes are live, so store the
+    * whole channel at once instead of testing the mask per lane.
+    */
+   if (execmask == TGSI_EXEC_MASK_FULL) {
+      if (!inst->Instruction.Saturate) {
+         *dst = *chan;
+      } else {
+#if defined(PIPE_ARCH_SSE)
+         /* maxps returns its second operand for NaN, which gives 0 like
+          * fmaxf does below.
+          */
+         _mm_store_ps(dst->f,
+                      _mm_min_ps(_mm_max_ps(_mm_load_ps(chan->f),
+                                            _mm_setzero_ps()),
+                                 _mm_set1_ps(1.0f)));
+#else
+         for (i = 0; i < TGSI_QUAD_SIZE; i++)
+            dst->f[i] = fminf(fmaxf(chan->f[i], 0.0f), 1.0f);
+#endif
+      }
+      return;
+   }
+
    if (!inst->Instruction.Saturate) {
       for (i = 0; i < TGSI_QUAD_SIZE; i++)
          if (execmask & (1 << i))
@@ -5981,7 +6023,7 @@ exec_instruction(
 static void
 tgsi_exec_machine_setup_masks(struct tgsi_exec_machine *mach)
 {
-   uint default_mask = 0xf;
+   uint default_mask = TGSI_EXEC_MASK_FULL;
 
    mach->KillMask = 0;
    mach->OutputVertexOffset = 0;
@@ -44,6 +44,7 @@ extern "C" {
 
 #define TGSI_NUM_CHANNELS 4  /* R,G,B,A */
 #define TGSI_QUAD_SIZE    4  /* 4 pixel/quad */
+#define TGSI_EXEC_MASK_FULL ((1 << TGSI_QUAD_SIZE) - 1)
 
 #define TGSI_FOR_EACH_CHANNEL( CHAN )\
    for (CHAN = 0; CHAN < TGSI_NUM_CHANNELS; CHAN++)
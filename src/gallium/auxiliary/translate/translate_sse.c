@@ -64,8 +64,8 @@ struct translate_buffer_variant
 
 #define ELEMENT_BUFFER_INSTANCE_ID  1001
 
-#define NUM_FLOAT_CONSTS 9
-#define NUM_UNSIGNED_CONSTS 1
+#define NUM_FLOAT_CONSTS 17
+#define NUM_UNSIGNED_CONSTS 7
 
 enum
 {
@@ -78,8 +78,22 @@ enum
    CONST_INV_4294967295,
    CONST_255,
    CONST_2147483648,
+   CONST_NEG_1,
+   CONST_HALF_MAGIC,
+   CONST_HALF_INFNAN,
+   CONST_1010102_UNORM_SCALE,
+   CONST_1010102_SNORM_SCALE,
+   CONST_1010102_SCALED_SCALE,
+   CONST_1010102_UBIAS,
+   CONST_1010102_SBIAS,
    /* float consts end */
    CONST_2147483647_INT,
+   CONST_HALF_ABS_INT,
+   CONST_HALF_SIGN_INT,
+   CONST_FLOAT_EXP_INT,
+   CONST_1010102_MASK_INT,
+   CONST_1010102_UXOR_INT,
+   CONST_1010102_SXOR_INT,
 };
 
 #define C(v) {(float)(v), (float)(v), (float)(v), (float)(v)}
@@ -93,12 +107,31 @@ static float consts[NUM_FLOAT_CONSTS][4] = {
    C(1.0 / 4294967295.0),
    C(255.0),
    C(2147483648.0),
+   C(-1.0),
+   C(5.192296858534828e+33), /* 2^112 */
+   C(65536.0),
+   /* The 10_10_10_2 channels stay at their bit offset when converted, so
+    * the scales include the offsets.
+    */
+   {1.0f / 1023.0f, 1.0f / 1023.0f / (1 << 10),
+    1.0f / 1023.0f / (1 << 20), 1.0f / 3.0f / (1 << 30)},
+   {1.0f / 511.0f, 1.0f / 511.0f / (1 << 10),
+    1.0f / 511.0f / (1 << 20), 1.0f / (1 << 30)},
+   {1.0f, 1.0f / (1 << 10), 1.0f / (1 << 20), 1.0f / (1 << 30)},
+   {0, 0, 0, 2147483648.0f},
+   {-(float)(1 << 9), -(float)(1 << 19), -(float)(1 << 29), 0},
 };
 
 #undef C
 
 static unsigned uconsts[NUM_UNSIGNED_CONSTS][4] = {
    {0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff},
+   {0x7fff, 0x7fff, 0x7fff, 0x7fff},
+   {0x8000, 0x8000, 0x8000, 0x8000},
+   {0x7f800000, 0x7f800000, 0x7f800000, 0x7f800000},
+   {0x3ff, 0x3ff << 10, 0x3ff << 20, 0x3u << 30},
+   {0, 0, 0, 0x80000000},
+   {1 << 9, 1 << 19, 1 << 29, 0},
 };
 
 struct translate_sse
@@ -471,6 +504,113 @@ emit_memcpy(struct translate_sse *p, struct x86_reg dst, struct x86_reg src,
    }
 }
 
+/* Convert the half floats in the low 16 bits of each channel to floats,
+ * including denormals, infinities and NaNs.
+ */
+static void
+emit_half_to_float(struct translate_sse *p, struct x86_reg data)
+{
+   struct x86_reg aux = x86_make_reg(file_XMM, 1);
+
+   /* aux = magnitude shifted into a float and rebiased */
+   sse_movaps(p->func, aux, data);
+   sse_andps(p->func, aux, get_const(p, CONST_HALF_ABS_INT));
+   sse2_pslld_imm(p->func, aux, 13);
+   sse_mulps(p->func, aux, get_const(p, CONST_HALF_MAGIC));
+
+   /* data = sign | magnitude */
+   sse_andps(p->func, data, get_const(p, CONST_HALF_SIGN_INT));
+   sse2_pslld_imm(p->func, data, 16);
+   sse_orps(p->func, data, aux);
+
+   /* Infinities and NaNs need the maximum exponent. */
+   sse_cmpps(p->func, aux, get_const(p, CONST_HALF_INFNAN), cc_NotLessThan);
+   sse_andps(p->func, aux, get_const(p, CONST_FLOAT_EXP_INT));
+   sse_orps(p->func, data, aux);
+}
+
+
+static boolean
+is_1010102_format(const struct util_format_description *desc)
+{
+   unsigned i;
+
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       desc->nr_channels != 4 ||
+       desc->channel[0].size != 10 ||
+       desc->channel[1].size != 10 ||
+       desc->channel[2].size != 10 ||
+       desc->channel[3].size != 2 ||
+       desc->channel[0].pure_integer ||
+       (desc->channel[0].type != UTIL_FORMAT_TYPE_UNSIGNED &&
+        desc->channel[0].type != UTIL_FORMAT_TYPE_SIGNED))
+      return FALSE;
+
+   for (i = 0; i < 4; i++) {
+      if (desc->channel[i].type != desc->channel[0].type ||
+          desc->channel[i].normalized != desc->channel[0].normalized ||
+          desc->swizzle[i] > PIPE_SWIZZLE_W)
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+/* Expand a 10_10_10_2 vertex to 4 floats. Each channel is masked in place
+ * and converted at its bit offset, which the scale then divides out.
+ */
+static boolean
+translate_attr_1010102(struct translate_sse *p,
+                       const struct util_format_description *input_desc,
+                       struct x86_reg src, struct x86_reg dst)
+{
+   struct x86_reg dataXMM = x86_make_reg(file_XMM, 0);
+   boolean is_signed = input_desc->channel[0].type == UTIL_FORMAT_TYPE_SIGNED;
+   boolean normalized = input_desc->channel[0].normalized;
+   unsigned i;
+
+   sse2_movd(p->func, dataXMM, src);
+   sse2_pshufd(p->func, dataXMM, dataXMM, SHUF(X, X, X, X));
+   sse_andps(p->func, dataXMM, get_const(p, CONST_1010102_MASK_INT));
+
+   /* Flip the sign bits and subtract them back after the conversion, which
+    * sign-extends signed channels. The unsigned 2-bit channel is the one
+    * that needs it the other way around, because cvtdq2ps is signed.
+    */
+   sse_xorps(p->func, dataXMM,
+             get_const(p, is_signed ? CONST_1010102_SXOR_INT :
+                                      CONST_1010102_UXOR_INT));
+   sse2_cvtdq2ps(p->func, dataXMM, dataXMM);
+   sse_addps(p->func, dataXMM,
+             get_const(p, is_signed ? CONST_1010102_SBIAS :
+                                      CONST_1010102_UBIAS));
+
+   if (!normalized)
+      sse_mulps(p->func, dataXMM, get_const(p, CONST_1010102_SCALED_SCALE));
+   else if (is_signed)
+      sse_mulps(p->func, dataXMM, get_const(p, CONST_1010102_SNORM_SCALE));
+   else
+      sse_mulps(p->func, dataXMM, get_const(p, CONST_1010102_UNORM_SCALE));
+
+   if (is_signed && normalized)
+      sse_maxps(p->func, dataXMM, get_const(p, CONST_NEG_1));
+
+   for (i = 0; i < 4; i++) {
+      if (input_desc->swizzle[i] != i)
+         break;
+   }
+   if (i < 4) {
+      sse_shufps(p->func, dataXMM, dataXMM,
+                 SHUF(input_desc->swizzle[0], input_desc->swizzle[1],
+                      input_desc->swizzle[2], input_desc->swizzle[3]));
+   }
+
+   sse_movups(p->func, dst, dataXMM);
+   return TRUE;
+}
+
+
 static boolean
 translate_attr_convert(struct translate_sse *p,
                        const struct translate_element *a,
@@ -492,6 +632,11 @@ translate_attr_convert(struct translate_sse *p,
        || a->input_format == PIPE_FORMAT_NONE)
       return FALSE;
 
+   if ((x86_target_caps(p->func) & X86_SSE2) &&
+       a->output_format == PIPE_FORMAT_R32G32B32A32_FLOAT &&
+       is_1010102_format(input_desc))
+      return translate_attr_1010102(p, input_desc, src, dst);
+
    if (input_desc->channel[0].size & 7)
       return FALSE;
 
@@ -548,9 +693,12 @@ translate_attr_convert(struct translate_sse *p,
                            input_desc->channel[0].size *
                            input_desc->nr_channels >> 3);
 
-            /* TODO: add support for SSE4.1 pmovzx */
             switch (input_desc->channel[0].size) {
             case 8:
+               if (x86_target_caps(p->func) & X86_SSE4_1) {
+                  sse41_pmovzxbd(p->func, dataXMM, dataXMM);
+                  break;
+               }
                /* TODO: this may be inefficient due to get_identity() being
                 *  used both as a float and integer register.
                 */
@@ -558,6 +706,10 @@ translate_attr_convert(struct translate_sse *p,
                sse2_punpcklbw(p->func, dataXMM, get_const(p, CONST_IDENTITY));
                break;
             case 16:
+               if (x86_target_caps(p->func) & X86_SSE4_1) {
+                  sse41_pmovzxwd(p->func, dataXMM, dataXMM);
+                  break;
+               }
                sse2_punpcklwd(p->func, dataXMM, get_const(p, CONST_IDENTITY));
                break;
             case 32:           /* we lose precision here */
@@ -611,14 +763,21 @@ translate_attr_convert(struct translate_sse *p,
                            input_desc->channel[0].size *
                            input_desc->nr_channels >> 3);
 
-            /* TODO: add support for SSE4.1 pmovsx */
             switch (input_desc->channel[0].size) {
             case 8:
+               if (x86_target_caps(p->func) & X86_SSE4_1) {
+                  sse41_pmovsxbd(p->func, dataXMM, dataXMM);
+                  break;
+               }
                sse2_punpcklbw(p->func, dataXMM, dataXMM);
                sse2_punpcklbw(p->func, dataXMM, dataXMM);
                sse2_psrad_imm(p->func, dataXMM, 24);
                break;
             case 16:
+               if (x86_target_caps(p->func) & X86_SSE4_1) {
+                  sse41_pmovsxwd(p->func, dataXMM, dataXMM);
+                  break;
+               }
                sse2_punpcklwd(p->func, dataXMM, dataXMM);
                sse2_psrad_imm(p->func, dataXMM, 16);
                break;
@@ -654,6 +813,19 @@ translate_attr_convert(struct translate_sse *p,
 
             break;
          case UTIL_FORMAT_TYPE_FLOAT:
+            if (input_desc->channel[0].size == 16) {
+               if (!(x86_target_caps(p->func) & X86_SSE2))
+                  return FALSE;
+               emit_load_sse2(p, dataXMM, src,
+                              input_desc->nr_channels * 2);
+               if (x86_target_caps(p->func) & X86_SSE4_1)
+                  sse41_pmovzxwd(p->func, dataXMM, dataXMM);
+               else
+                  sse2_punpcklwd(p->func, dataXMM,
+                                 get_const(p, CONST_IDENTITY));
+               emit_half_to_float(p, dataXMM);
+               break;
+            }
             if (input_desc->channel[0].size != 32
                 && input_desc->channel[0].size != 64) {
                return FALSE;
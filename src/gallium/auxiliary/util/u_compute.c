@@ -165,3 +165,251 @@ void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_inf
    ctx->delete_sampler_state(ctx, sampler_state_p);
    ctx->bind_compute_state(ctx, NULL);
 }
+
+/* Number of levels one dispatch of the mipmap shader can generate.  The
+ * first one is sampled with a bilinear filter, the other ones are reduced
+ * in shared memory by the 8x8 thread group.
+ */
+#define GEN_MIPMAP_MAX_LEVELS 4
+#define GEN_MIPMAP_BLOCK_SIZE 8
+
+static void *gen_mipmap_compute_shader(struct pipe_context *ctx)
+{
+   static const char swz[] = "xyzw";
+   /* Byte offset in shared memory of the texels written by each level, the
+    * last level doesn't need to be kept.
+    */
+   static const char *const region[GEN_MIPMAP_MAX_LEVELS] = {
+      "IMM[2].yyyy", "IMM[2].zzzz", "IMM[2].wwww", NULL,
+   };
+   char text[8192];
+   int n;
+
+   n = snprintf(text, sizeof(text),
+      "COMP\n"
+      "PROPERTY CS_FIXED_BLOCK_WIDTH 8\n"
+      "PROPERTY CS_FIXED_BLOCK_HEIGHT 8\n"
+      "PROPERTY CS_FIXED_BLOCK_DEPTH 1\n"
+      "DCL SV[0], THREAD_ID\n"
+      "DCL SV[1], BLOCK_ID\n"
+      "DCL SAMP[0]\n"
+      "DCL SVIEW[0], 2D_ARRAY, FLOAT\n"
+      "DCL IMAGE[0], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT, WR\n"
+      "DCL IMAGE[1], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT, WR\n"
+      "DCL IMAGE[2], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT, WR\n"
+      "DCL IMAGE[3], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT, WR\n"
+      "DCL MEMORY[0], SHARED\n"
+      "DCL CONST[0][0]\n" // xy: 1 / first dst size, z: first layer, w: levels
+      "DCL TEMP[0..9], LOCAL\n"
+      "IMM[0] UINT32 {8, 4, 2, 1}\n"
+      "IMM[1] FLT32 {0.5, 0.25, 0.0, 0.0}\n"
+      "IMM[2] UINT32 {16, 0, 1024, 1280}\n"
+      "IMM[3] UINT32 {1, 2, 3, 0}\n"
+
+      /* The first level is a plain bilinear downscale of the source. */
+      "UMAD TEMP[0].xy, SV[1].xyyy, IMM[0].xxxx, SV[0].xyyy\n"
+      "UADD TEMP[0].z, SV[1].zzzz, CONST[0][0].zzzz\n"
+      "U2F TEMP[1].xyz, TEMP[0].xyzz\n"
+      "ADD TEMP[1].xy, TEMP[1].xyyy, IMM[1].xxxx\n"
+      "MUL TEMP[1].xy, TEMP[1].xyyy, CONST[0][0].xyyy\n"
+      "TEX_LZ TEMP[2], TEMP[1], SAMP[0], 2D_ARRAY\n"
+      "STORE IMAGE[0], TEMP[0].xyzz, TEMP[2], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT\n"
+      "UMAD TEMP[3].x, SV[0].yyyy, IMM[0].xxxx, SV[0].xxxx\n"
+      "UMUL TEMP[3].x, TEMP[3].xxxx, IMM[2].xxxx\n"
+      "STORE MEMORY[0].xyzw, TEMP[3].xxxx, TEMP[2]\n");
+
+   /* Every following level averages 2x2 texels of the previous one, which
+    * the group left in shared memory.  Threads outside of the smaller grid
+    * only take part in the barriers, which must stay in uniform control
+    * flow.
+    */
+   for (unsigned l = 1; l < GEN_MIPMAP_MAX_LEVELS; l++) {
+      char size = swz[l];          /* IMM[0] component holding 8 >> l */
+      char prev_stride = swz[l - 1];
+
+      n += snprintf(text + n, sizeof(text) - n,
+         "BARRIER\n"
+         "USLT TEMP[4].xy, SV[0].xyyy, IMM[0].%c%c%c%c\n"
+         "AND TEMP[4].x, TEMP[4].xxxx, TEMP[4].yyyy\n"
+         "USLT TEMP[4].y, IMM[3].%c%c%c%c, CONST[0][0].wwww\n"
+         "AND TEMP[4].x, TEMP[4].xxxx, TEMP[4].yyyy\n"
+         "UIF TEMP[4].xxxx\n"
+         "SHL TEMP[5].xy, SV[0].xyyy, IMM[0].wwww\n"
+         "UMAD TEMP[5].x, TEMP[5].yyyy, IMM[0].%c%c%c%c, TEMP[5].xxxx\n"
+         "UADD TEMP[5].y, TEMP[5].xxxx, IMM[0].wwww\n"
+         "UADD TEMP[5].z, TEMP[5].xxxx, IMM[0].%c%c%c%c\n"
+         "UADD TEMP[5].w, TEMP[5].zzzz, IMM[0].wwww\n"
+         "UMAD TEMP[5], TEMP[5], IMM[2].xxxx, %s\n"
+         "LOAD TEMP[6], MEMORY[0], TEMP[5].xxxx\n"
+         "LOAD TEMP[7], MEMORY[0], TEMP[5].yyyy\n"
+         "ADD TEMP[6], TEMP[6], TEMP[7]\n"
+         "LOAD TEMP[7], MEMORY[0], TEMP[5].zzzz\n"
+         "ADD TEMP[6], TEMP[6], TEMP[7]\n"
+         "LOAD TEMP[7], MEMORY[0], TEMP[5].wwww\n"
+         "ADD TEMP[6], TEMP[6], TEMP[7]\n"
+         "MUL TEMP[6], TEMP[6], IMM[1].yyyy\n"
+         "UMAD TEMP[8].xy, SV[1].xyyy, IMM[0].%c%c%c%c, SV[0].xyyy\n"
+         "MOV TEMP[8].z, TEMP[0].zzzz\n"
+         "STORE IMAGE[%u], TEMP[8].xyzz, TEMP[6], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_FLOAT\n",
+         size, size, size, size,
+         swz[l - 1], swz[l - 1], swz[l - 1], swz[l - 1],
+         prev_stride, prev_stride, prev_stride, prev_stride,
+         prev_stride, prev_stride, prev_stride, prev_stride,
+         region[l - 1],
+         size, size, size, size,
+         l);
+
+      if (region[l]) {
+         n += snprintf(text + n, sizeof(text) - n,
+            "UMAD TEMP[9].x, SV[0].yyyy, IMM[0].%c%c%c%c, SV[0].xxxx\n"
+            "UMAD TEMP[9].x, TEMP[9].xxxx, IMM[2].xxxx, %s\n"
+            "STORE MEMORY[0].xyzw, TEMP[9].xxxx, TEMP[6]\n",
+            size, size, size, size, region[l]);
+      }
+
+      n += snprintf(text + n, sizeof(text) - n, "ENDIF\n");
+   }
+
+   n += snprintf(text + n, sizeof(text) - n, "END\n");
+   assert(n < (int)sizeof(text));
+
+   struct tgsi_token tokens[2048];
+   struct pipe_compute_state state = {0};
+
+   if (!tgsi_text_translate(text, tokens, ARRAY_SIZE(tokens))) {
+      assert(false);
+      return NULL;
+   }
+
+   state.ir_type = PIPE_SHADER_IR_TGSI;
+   state.prog = tokens;
+   /* 8x8 + 4x4 + 2x2 vec4s for the levels that are reduced further. */
+   state.req_local_mem = (64 + 16 + 4) * 16;
+
+   return ctx->create_compute_state(ctx, &state);
+}
+
+/* How many levels after src_level one dispatch can generate.  Levels after
+ * the first are reduced 2x2 in shared memory, so they must be exactly half
+ * of the previous one.
+ */
+static unsigned gen_mipmap_num_levels(const struct pipe_resource *pt,
+                                      unsigned src_level, unsigned last_level)
+{
+   unsigned count = 1;
+
+   while (count < GEN_MIPMAP_MAX_LEVELS && src_level + count < last_level) {
+      unsigned level = src_level + count;
+
+      if (u_minify(pt->width0, level) % 2 || u_minify(pt->height0, level) % 2)
+         break;
+      count++;
+   }
+
+   return count;
+}
+
+bool util_compute_gen_mipmap(struct pipe_context *ctx, struct pipe_resource *pt,
+                             enum pipe_format format, unsigned base_level,
+                             unsigned last_level, unsigned first_layer,
+                             unsigned last_layer, void **compute_state)
+{
+   struct pipe_screen *screen = ctx->screen;
+
+   assert(last_level > base_level && last_level <= pt->last_level);
+
+   if (pt->target != PIPE_TEXTURE_2D && pt->target != PIPE_TEXTURE_2D_ARRAY)
+      return false;
+
+   if (pt->nr_samples > 1 ||
+       util_format_is_depth_or_stencil(format) ||
+       util_format_is_pure_integer(format) ||
+       util_format_is_srgb(format) ||
+       util_format_is_compressed(format))
+      return false;
+
+   if (!screen->is_format_supported(screen, format, pt->target, 0, 0,
+                                    PIPE_BIND_SAMPLER_VIEW |
+                                    PIPE_BIND_SHADER_IMAGE))
+      return false;
+
+   if (!*compute_state)
+      *compute_state = gen_mipmap_compute_shader(ctx);
+   if (!*compute_state)
+      return false;
+
+   struct pipe_sampler_state sampler_state = {0};
+   sampler_state.wrap_s = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   sampler_state.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   sampler_state.wrap_r = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+   sampler_state.min_img_filter = PIPE_TEX_FILTER_LINEAR;
+   sampler_state.mag_img_filter = PIPE_TEX_FILTER_LINEAR;
+   sampler_state.normalized_coords = 1;
+
+   void *sampler_state_p = ctx->create_sampler_state(ctx, &sampler_state);
+   ctx->bind_sampler_states(ctx, PIPE_SHADER_COMPUTE, 0, 1, &sampler_state_p);
+   ctx->bind_compute_state(ctx, *compute_state);
+
+   for (unsigned src_level = base_level; src_level < last_level;) {
+      unsigned num_levels = gen_mipmap_num_levels(pt, src_level, last_level);
+      unsigned width = u_minify(pt->width0, src_level + 1);
+      unsigned height = u_minify(pt->height0, src_level + 1);
+
+      struct pipe_sampler_view src_templ, *src_view;
+      u_sampler_view_default_template(&src_templ, pt, format);
+      src_templ.u.tex.first_level = src_templ.u.tex.last_level = src_level;
+      src_view = ctx->create_sampler_view(ctx, pt, &src_templ);
+      ctx->set_sampler_views(ctx, PIPE_SHADER_COMPUTE, 0, 1, 0, false, &src_view);
+
+      /* Unused slots get the last generated level, the shader never
+       * writes to them.
+       */
+      struct pipe_image_view images[GEN_MIPMAP_MAX_LEVELS];
+      memset(images, 0, sizeof(images));
+      for (unsigned i = 0; i < GEN_MIPMAP_MAX_LEVELS; i++) {
+         images[i].resource = pt;
+         images[i].format = format;
+         images[i].shader_access = images[i].access = PIPE_IMAGE_ACCESS_WRITE;
+         images[i].u.tex.level = src_level + 1 + MIN2(i, num_levels - 1);
+         images[i].u.tex.first_layer = 0;
+         images[i].u.tex.last_layer = (unsigned)(pt->array_size - 1);
+      }
+      ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0,
+                             GEN_MIPMAP_MAX_LEVELS, 0, images);
+
+      unsigned data[] = {u_bitcast_f2u(1.0f / width),
+                         u_bitcast_f2u(1.0f / height),
+                         first_layer,
+                         num_levels};
+
+      struct pipe_constant_buffer cb = {0};
+      cb.buffer_size = sizeof(data);
+      cb.user_buffer = data;
+      ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, false, &cb);
+
+      struct pipe_grid_info grid_info = {0};
+      grid_info.block[0] = GEN_MIPMAP_BLOCK_SIZE;
+      grid_info.block[1] = GEN_MIPMAP_BLOCK_SIZE;
+      grid_info.block[2] = 1;
+      grid_info.grid[0] = DIV_ROUND_UP(width, GEN_MIPMAP_BLOCK_SIZE);
+      grid_info.grid[1] = DIV_ROUND_UP(height, GEN_MIPMAP_BLOCK_SIZE);
+      grid_info.grid[2] = last_layer + 1 - first_layer;
+
+      ctx->launch_grid(ctx, &grid_info);
+
+      /* The next dispatch samples the level this one wrote last. */
+      ctx->memory_barrier(ctx, PIPE_BARRIER_TEXTURE | PIPE_BARRIER_IMAGE);
+
+      pipe_sampler_view_reference(&src_view, NULL);
+      src_level += num_levels;
+   }
+
+   ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0, 0,
+                          GEN_MIPMAP_MAX_LEVELS, NULL);
+   ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, false, NULL);
+   ctx->set_sampler_views(ctx, PIPE_SHADER_COMPUTE, 0, 0, 1, false, NULL);
+   ctx->delete_sampler_state(ctx, sampler_state_p);
+   ctx->bind_compute_state(ctx, NULL);
+
+   return true;
+}
@@ -38,6 +38,20 @@ extern "C" {
 void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_info,
                        void **compute_state, bool half_texel_offset);
 
+/**
+ * Generate mipmap levels with compute dispatches instead of one blit per
+ * level.  Each dispatch writes up to four levels.
+ *
+ * Returns false without doing anything if the resource or format isn't
+ * supported, in which case the caller should fall back to util_gen_mipmap.
+ * Only the compute state is touched, and the slots it used are unbound on
+ * return.
+ */
+bool util_compute_gen_mipmap(struct pipe_context *ctx, struct pipe_resource *pt,
+                             enum pipe_format format, unsigned base_level,
+                             unsigned last_level, unsigned first_layer,
+                             unsigned last_layer, void **compute_state);
+
 #ifdef __cplusplus
 }
 #endif
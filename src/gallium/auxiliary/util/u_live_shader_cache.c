@@ -46,6 +46,47 @@ static bool key_equals(const void *a, const void *b)
    return memcmp(a, b, 20) == 0;
 }
 
+static void free_prehash_entry(struct hash_entry *entry)
+{
+   /* The key and the data share one allocation. */
+   free((void*)entry->key);
+}
+
+static struct util_live_shader *
+lookup_prehash_locked(struct util_live_shader_cache *cache,
+                      const unsigned char *prehash)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(cache->prehash_table,
+                                                      prehash);
+   if (!entry)
+      return NULL;
+
+   /* The shader may have been destroyed since the prehash was recorded. */
+   entry = _mesa_hash_table_search(cache->hashtable, entry->data);
+   return entry ? entry->data : NULL;
+}
+
+static void
+record_prehash_locked(struct util_live_shader_cache *cache,
+                      const unsigned char *prehash,
+                      const unsigned char *sha1)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(cache->prehash_table,
+                                                      prehash);
+   if (entry) {
+      memcpy(entry->data, sha1, 20);
+      return;
+   }
+
+   unsigned char *key = malloc(40);
+   if (!key)
+      return;
+
+   memcpy(key, prehash, 20);
+   memcpy(key + 20, sha1, 20);
+   _mesa_hash_table_insert(cache->prehash_table, key, key + 20);
+}
+
 void
 util_live_shader_cache_init(struct util_live_shader_cache *cache,
                             void *(*create_shader)(struct pipe_context *,
@@ -54,6 +95,7 @@ util_live_shader_cache_init(struct util_live_shader_cache *cache,
 {
    simple_mtx_init(&cache->lock, mtx_plain);
    cache->hashtable = _mesa_hash_table_create(NULL, key_hash, key_equals);
+   cache->prehash_table = _mesa_hash_table_create(NULL, key_hash, key_equals);
    cache->create_shader = create_shader;
    cache->destroy_shader = destroy_shader;
 }
@@ -64,6 +106,7 @@ util_live_shader_cache_deinit(struct util_live_shader_cache *cache)
    if (cache->hashtable) {
       /* The hash table should be empty at this point. */
       _mesa_hash_table_destroy(cache->hashtable, NULL);
+      _mesa_hash_table_destroy(cache->prehash_table, free_prehash_entry);
       simple_mtx_destroy(&cache->lock);
    }
 }
@@ -78,6 +121,28 @@ util_live_shader_cache_get(struct pipe_context *ctx,
    unsigned ir_size;
    const void *ir_binary;
    enum pipe_shader_type stage;
+   const unsigned char *prehash =
+      state->type == PIPE_SHADER_IR_NIR ? state->nir_prehash : NULL;
+
+   /* The frontend already hashed the inputs of this shader, so a hit
+    * doesn't need to serialize it.
+    */
+   if (prehash) {
+      simple_mtx_lock(&cache->lock);
+      struct util_live_shader *shader = lookup_prehash_locked(cache, prehash);
+      if (shader) {
+         pipe_reference(NULL, &shader->reference);
+         cache->hits++;
+      }
+      simple_mtx_unlock(&cache->lock);
+
+      if (shader) {
+         if (cache_hit)
+            *cache_hit = true;
+         ralloc_free(state->ir.nir);
+         return shader;
+      }
+   }
 
    /* Get the shader binary and shader stage. */
    if (state->type == PIPE_SHADER_IR_TGSI) {
@@ -122,6 +187,8 @@ util_live_shader_cache_get(struct pipe_context *ctx,
    if (shader) {
       pipe_reference(NULL, &shader->reference);
       cache->hits++;
+      if (prehash)
+         record_prehash_locked(cache, prehash, sha1);
    }
    simple_mtx_unlock(&cache->lock);
 
@@ -157,6 +224,8 @@ util_live_shader_cache_get(struct pipe_context *ctx,
    } else {
       _mesa_hash_table_insert(cache->hashtable, shader->sha1, shader);
    }
+   if (prehash)
+      record_prehash_locked(cache, prehash, sha1);
    cache->misses++;
    simple_mtx_unlock(&cache->lock);
 
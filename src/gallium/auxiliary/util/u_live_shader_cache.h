@@ -59,6 +59,8 @@ extern "C" {
 struct util_live_shader_cache {
    simple_mtx_t lock;
    struct hash_table *hashtable;
+   /* pipe_shader_state::nir_prehash -> SHA1 of the serialized IR */
+   struct hash_table *prehash_table;
 
    void *(*create_shader)(struct pipe_context *,
                           const struct pipe_shader_state *state);
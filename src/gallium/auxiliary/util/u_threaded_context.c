@@ -32,6 +32,7 @@
 #include "util/u_upload_mgr.h"
 #include "driver_trace/tr_context.h"
 #include "util/log.h"
+#include "util/os_time.h"
 #include "compiler/shader_info.h"
 
 #if TC_DEBUG >= 1
@@ -87,9 +88,9 @@ tc_batch_check(UNUSED struct tc_batch *batch)
 static void
 tc_debug_check(struct threaded_context *tc)
 {
-   for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
-      tc_batch_check(&tc->batch_slots[i]);
-      tc_assert(tc->batch_slots[i].tc == tc);
+   for (unsigned i = 0; i < tc->num_batches; i++) {
+      tc_batch_check(tc->batch_slots[i]);
+      tc_assert(tc->batch_slots[i]->tc == tc);
    }
 }
 
@@ -244,7 +245,7 @@ tc_begin_next_buffer_list(struct threaded_context *tc)
 {
    tc->next_buf_list = (tc->next_buf_list + 1) % TC_MAX_BUFFER_LISTS;
 
-   tc->batch_slots[tc->next].buffer_list_index = tc->next_buf_list;
+   tc->batch_slots[tc->next]->buffer_list_index = tc->next_buf_list;
 
    /* Clear the buffer list in the new empty batch. */
    struct tc_buffer_list *buf_list = &tc->buffer_lists[tc->next_buf_list];
@@ -256,10 +257,60 @@ tc_begin_next_buffer_list(struct threaded_context *tc)
    tc->add_all_compute_bindings_to_buffer_list = true;
 }
 
+static struct tc_batch *
+tc_batch_create(struct threaded_context *tc)
+{
+   struct tc_batch *batch = CALLOC_STRUCT(tc_batch);
+   if (!batch)
+      return NULL;
+
+#if !defined(NDEBUG) && TC_DEBUG >= 1
+   batch->sentinel = TC_SENTINEL;
+#endif
+   batch->tc = tc;
+   util_queue_fence_init(&batch->fence);
+   return batch;
+}
+
+static void
+tc_capture_calls(struct threaded_context *tc, struct tc_batch *batch);
+
+/* Make sure that the next batch is idle before recording into it. */
+static void
+tc_get_idle_batch(struct threaded_context *tc)
+{
+   struct tc_batch *next = tc->batch_slots[tc->next];
+
+   if (likely(util_queue_fence_is_signalled(&next->fence)))
+      return;
+
+   /* The driver thread is behind. Insert a new batch into the ring right
+    * after the last flushed one, so that the execution order is preserved.
+    */
+   if (tc->num_batches < TC_MAX_BATCHES) {
+      struct tc_batch *batch = tc_batch_create(tc);
+
+      if (batch) {
+         memmove(&tc->batch_slots[tc->next + 1], &tc->batch_slots[tc->next],
+                 (tc->num_batches - tc->next) * sizeof(tc->batch_slots[0]));
+         tc->batch_slots[tc->next] = batch;
+         if (tc->last >= tc->next)
+            tc->last++;
+         tc->num_batches++;
+         return;
+      }
+   }
+
+   int64_t start = os_time_get();
+   p_atomic_inc(&tc->num_stalls);
+   util_queue_fence_wait(&next->fence);
+   p_atomic_add(&tc->stall_time_us, (unsigned)(os_time_get() - start));
+}
+
 static void
 tc_batch_flush(struct threaded_context *tc)
 {
-   struct tc_batch *next = &tc->batch_slots[tc->next];
+   struct tc_batch *next = tc->batch_slots[tc->next];
 
    tc_assert(next->num_total_slots != 0);
    tc_batch_check(next);
@@ -272,10 +323,16 @@ tc_batch_flush(struct threaded_context *tc)
       tc_unflushed_batch_token_reference(&next->token, NULL);
    }
 
+   if (unlikely(tc->capture))
+      tc_capture_calls(tc, next);
+
    util_queue_add_job(&tc->queue, next, &next->fence, tc_batch_execute,
                       NULL, 0);
+   tc->last_mergeable_draw = NULL;
+   tc->last_mergeable_subdata = NULL;
    tc->last = tc->next;
-   tc->next = (tc->next + 1) % TC_MAX_BATCHES;
+   tc->next = (tc->next + 1) % tc->num_batches;
+   tc_get_idle_batch(tc);
    tc_begin_next_buffer_list(tc);
 }
 
@@ -287,13 +344,13 @@ static void *
 tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
                   unsigned num_slots)
 {
-   struct tc_batch *next = &tc->batch_slots[tc->next];
+   struct tc_batch *next = tc->batch_slots[tc->next];
    assert(num_slots <= TC_SLOTS_PER_BATCH);
    tc_debug_check(tc);
 
    if (unlikely(next->num_total_slots + num_slots > TC_SLOTS_PER_BATCH)) {
       tc_batch_flush(tc);
-      next = &tc->batch_slots[tc->next];
+      next = tc->batch_slots[tc->next];
       tc_assert(next->num_total_slots == 0);
    }
 
@@ -326,19 +383,23 @@ tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
 static bool
 tc_is_sync(struct threaded_context *tc)
 {
-   struct tc_batch *last = &tc->batch_slots[tc->last];
-   struct tc_batch *next = &tc->batch_slots[tc->next];
+   struct tc_batch *last = tc->batch_slots[tc->last];
+   struct tc_batch *next = tc->batch_slots[tc->next];
 
    return util_queue_fence_is_signalled(&last->fence) &&
           !next->num_total_slots;
 }
 
-static void
+/* Return true if the driver thread had to be waited for or the current batch
+ * had to be executed directly.
+ */
+static bool
 _tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char *func)
 {
-   struct tc_batch *last = &tc->batch_slots[tc->last];
-   struct tc_batch *next = &tc->batch_slots[tc->next];
+   struct tc_batch *last = tc->batch_slots[tc->last];
+   struct tc_batch *next = tc->batch_slots[tc->next];
    bool synced = false;
+   int64_t start = os_time_get();
 
    tc_debug_check(tc);
 
@@ -359,6 +420,10 @@ _tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char
    if (next->num_total_slots) {
       p_atomic_add(&tc->num_direct_slots, next->num_total_slots);
       tc->bytes_mapped_estimate = 0;
+      tc->last_mergeable_draw = NULL;
+      tc->last_mergeable_subdata = NULL;
+      if (unlikely(tc->capture))
+         tc_capture_calls(tc, next);
       tc_batch_execute(next, NULL, 0);
       tc_begin_next_buffer_list(tc);
       synced = true;
@@ -366,6 +431,7 @@ _tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char
 
    if (synced) {
       p_atomic_inc(&tc->num_syncs);
+      p_atomic_add(&tc->sync_time_us, (unsigned)(os_time_get() - start));
 
       if (tc_strcmp(func, "tc_destroy") != 0) {
          tc_printf("sync %s %s", func, info);
@@ -373,6 +439,7 @@ _tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char
    }
 
    tc_debug_check(tc);
+   return synced;
 }
 
 #define tc_sync(tc) _tc_sync(tc, "", __func__)
@@ -394,7 +461,7 @@ threaded_context_flush(struct pipe_context *_pipe,
 
    /* This is called from the gallium frontend / application thread. */
    if (token->tc && token->tc == tc) {
-      struct tc_batch *last = &tc->batch_slots[tc->last];
+      struct tc_batch *last = tc->batch_slots[tc->last];
 
       /* Prefer to do the flush in the driver thread if it is already
        * running. That should be better for cache locality.
@@ -874,7 +941,8 @@ tc_get_query_result(struct pipe_context *_pipe,
    bool flushed = tq->flushed;
 
    if (!flushed) {
-      tc_sync_msg(tc, wait ? "wait" : "nowait");
+      if (tc_sync_msg(tc, wait ? "wait" : "nowait"))
+         p_atomic_inc(&tc->num_query_syncs);
       tc_set_driver_thread(tc);
    }
 
@@ -2244,8 +2312,9 @@ tc_buffer_map(struct pipe_context *_pipe,
 
    /* Unsychronized buffer mappings don't have to synchronize the thread. */
    if (!(usage & TC_TRANSFER_MAP_THREADED_UNSYNC)) {
-      tc_sync_msg(tc, usage & PIPE_MAP_DISCARD_RANGE ? "  discard_range" :
-                      usage & PIPE_MAP_READ ? "  read" : "  staging conflict");
+      if (tc_sync_msg(tc, usage & PIPE_MAP_DISCARD_RANGE ? "  discard_range" :
+                          usage & PIPE_MAP_READ ? "  read" : "  staging conflict"))
+         p_atomic_inc(&tc->num_map_syncs);
       tc_set_driver_thread(tc);
    }
 
@@ -2272,7 +2341,8 @@ tc_texture_map(struct pipe_context *_pipe,
    struct threaded_resource *tres = threaded_resource(resource);
    struct pipe_context *pipe = tc->pipe;
 
-   tc_sync_msg(tc, "texture");
+   if (tc_sync_msg(tc, "texture"))
+      p_atomic_inc(&tc->num_map_syncs);
    tc_set_driver_thread(tc);
 
    tc->bytes_mapped_estimate += box->width;
@@ -2547,6 +2617,47 @@ tc_call_buffer_subdata(struct pipe_context *pipe, void *call, uint64_t *last)
    return p->base.num_slots;
 }
 
+/* Append the data to the last recorded call if it's a buffer_subdata that
+ * ends where this one starts. Apps streaming uniforms or vertices with many
+ * small glBufferSubData calls then cost the driver one upload instead of
+ * one per call. Anything recorded in between prevents the merge, so the
+ * ordering with draws is preserved.
+ */
+static bool
+tc_append_buffer_subdata(struct threaded_context *tc,
+                         struct pipe_resource *resource,
+                         unsigned usage, unsigned offset,
+                         unsigned size, const void *data)
+{
+   struct tc_call_base *call = tc->last_mergeable_subdata;
+   struct tc_batch *next = tc->batch_slots[tc->next];
+
+   /* It must still be the last call of the current batch. */
+   if (!call ||
+       (uint64_t*)call + call->num_slots != &next->slots[next->num_total_slots])
+      return false;
+
+   struct tc_buffer_subdata *p = (struct tc_buffer_subdata *)call;
+
+   if (p->resource != resource || p->usage != usage ||
+       p->offset + p->size != offset ||
+       p->size + size > TC_MAX_MERGED_SUBDATA_BYTES)
+      return false;
+
+   unsigned num_slots = call_size_with_slots(tc_buffer_subdata, p->size + size);
+
+   if (next->num_total_slots - call->num_slots + num_slots > TC_SLOTS_PER_BATCH)
+      return false;
+
+   memcpy(p->slot + p->size, data, size);
+   p->size += size;
+   next->num_total_slots += num_slots - call->num_slots;
+   call->num_slots = num_slots;
+
+   p_atomic_inc(&tc->num_merged_subdata);
+   return true;
+}
+
 static void
 tc_buffer_subdata(struct pipe_context *_pipe,
                   struct pipe_resource *resource,
@@ -2590,6 +2701,9 @@ tc_buffer_subdata(struct pipe_context *_pipe,
 
    util_range_add(&tres->b, &tres->valid_buffer_range, offset, offset + size);
 
+   if (tc_append_buffer_subdata(tc, resource, usage, offset, size, data))
+      return;
+
    /* The upload is small. Enqueue it. */
    struct tc_buffer_subdata *p =
       tc_add_slot_based_call(tc, TC_CALL_buffer_subdata, tc_buffer_subdata, size);
@@ -2603,6 +2717,7 @@ tc_buffer_subdata(struct pipe_context *_pipe,
    p->offset = offset;
    p->size = size;
    memcpy(p->slot, data, size);
+   tc->last_mergeable_subdata = &p->base;
 }
 
 struct tc_texture_subdata {
@@ -2976,7 +3091,7 @@ tc_flush(struct pipe_context *_pipe, struct pipe_fence_handle **fence,
 
    if (async && tc->options.create_fence) {
       if (fence) {
-         struct tc_batch *next = &tc->batch_slots[tc->next];
+         struct tc_batch *next = tc->batch_slots[tc->next];
 
          if (!next->token) {
             next->token = malloc(sizeof(*next->token));
@@ -3004,8 +3119,9 @@ tc_flush(struct pipe_context *_pipe, struct pipe_fence_handle **fence,
    }
 
 out_of_memory:
-   tc_sync_msg(tc, flags & PIPE_FLUSH_END_OF_FRAME ? "end of frame" :
-                   flags & PIPE_FLUSH_DEFERRED ? "deferred fence" : "normal");
+   if (tc_sync_msg(tc, flags & PIPE_FLUSH_END_OF_FRAME ? "end of frame" :
+                       flags & PIPE_FLUSH_DEFERRED ? "deferred fence" : "normal"))
+      p_atomic_inc(&tc->num_flush_syncs);
 
    if (!(flags & PIPE_FLUSH_DEFERRED))
       tc_flush_queries(tc);
@@ -3211,6 +3327,69 @@ tc_call_draw_multi(struct pipe_context *pipe, void *call, uint64_t *last)
    return info->base.num_slots;
 }
 
+/* Append a single draw to the last recorded call if it's a draw with
+ * the same state, turning it into a multi draw. This saves batch space and
+ * the draw merging in the driver thread.
+ */
+static bool
+tc_append_draw(struct threaded_context *tc, const struct pipe_draw_info *info,
+               const struct pipe_draw_start_count_bias *draw)
+{
+   struct tc_call_base *call = tc->last_mergeable_draw;
+   struct tc_batch *next = tc->batch_slots[tc->next];
+
+   /* It must still be the last call of the current batch. */
+   if (!call ||
+       (uint64_t*)call + call->num_slots != &next->slots[next->num_total_slots])
+      return false;
+
+   /* tc_draw_single converts to tc_draw_multi in place. */
+   STATIC_ASSERT(offsetof(struct tc_draw_single, info) ==
+                 offsetof(struct tc_draw_multi, info));
+   struct tc_draw_multi *multi = (struct tc_draw_multi*)call;
+   struct pipe_draw_info simplified;
+
+   memcpy(&simplified, info, DRAW_INFO_SIZE_WITHOUT_MIN_MAX_INDEX);
+   simplify_draw_info(&simplified);
+   simplified.index_bias_varies = multi->info.index_bias_varies;
+
+   if (memcmp(&simplified, &multi->info, DRAW_INFO_SIZE_WITHOUT_MIN_MAX_INDEX))
+      return false;
+
+   unsigned num_draws =
+      call->call_id == TC_CALL_draw_multi ? multi->num_draws : 1;
+   unsigned num_slots = call_size_with_slots(tc_draw_multi, num_draws + 1);
+
+   if (next->num_total_slots - call->num_slots + num_slots > TC_SLOTS_PER_BATCH)
+      return false;
+
+   if (call->call_id == TC_CALL_draw_single) {
+      struct tc_draw_single *single = (struct tc_draw_single*)call;
+      struct pipe_draw_start_count_bias first;
+
+      /* u_threaded_context stores start/count in min/max_index for single draws. */
+      first.start = single->info.min_index;
+      first.count = single->info.max_index;
+      first.index_bias = single->index_bias;
+
+      call->call_id = TC_CALL_draw_multi;
+      multi->slot[0] = first;
+   }
+
+   multi->slot[num_draws] = *draw;
+   multi->info.index_bias_varies |= multi->slot[0].index_bias != draw->index_bias;
+   multi->num_draws = num_draws + 1;
+   next->num_total_slots += num_slots - call->num_slots;
+   call->num_slots = num_slots;
+
+   /* All merged draws share the index buffer reference of the first one. */
+   if (info->index_size && info->take_index_buffer_ownership)
+      pipe_drop_resource_references(info->index.resource, 1);
+
+   p_atomic_inc(&tc->num_merged_draws);
+   return true;
+}
+
 #define DRAW_INFO_SIZE_WITHOUT_INDEXBUF_AND_MIN_MAX_INDEX \
    offsetof(struct pipe_draw_info, index)
 
@@ -3300,6 +3479,9 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
          p->index_bias = draws[0].index_bias;
       } else {
          /* Non-indexed call or indexed with a real index buffer. */
+         if (drawid_offset == 0 && tc_append_draw(tc, info, &draws[0]))
+            return;
+
          struct tc_draw_single *p = drawid_offset > 0 ?
             &tc_add_call(tc, TC_CALL_draw_single_drawid, tc_draw_single_drawid)->base :
             tc_add_call(tc, TC_CALL_draw_single, tc_draw_single);
@@ -3317,6 +3499,11 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
          p->info.min_index = draws[0].start;
          p->info.max_index = draws[0].count;
          p->index_bias = draws[0].index_bias;
+
+         if (drawid_offset == 0) {
+            simplify_draw_info(&p->info);
+            tc->last_mergeable_draw = &p->base;
+         }
       }
       return;
    }
@@ -3353,7 +3540,7 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
 
       int total_offset = 0;
       while (num_draws) {
-         struct tc_batch *next = &tc->batch_slots[tc->next];
+         struct tc_batch *next = tc->batch_slots[tc->next];
 
          int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
          /* If there isn't enough place for one draw, try to fill the next one */
@@ -3399,7 +3586,7 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
       int total_offset = 0;
       bool take_index_buffer_ownership = info->take_index_buffer_ownership;
       while (num_draws) {
-         struct tc_batch *next = &tc->batch_slots[tc->next];
+         struct tc_batch *next = tc->batch_slots[tc->next];
 
          int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
          /* If there isn't enough place for one draw, try to fill the next one */
@@ -3560,7 +3747,7 @@ tc_draw_vertex_state(struct pipe_context *_pipe,
    int total_offset = 0;
    bool take_vertex_state_ownership = info.take_vertex_state_ownership;
    while (num_draws) {
-      struct tc_batch *next = &tc->batch_slots[tc->next];
+      struct tc_batch *next = tc->batch_slots[tc->next];
 
       int nb_slots_left = TC_SLOTS_PER_BATCH - next->num_total_slots;
       /* If there isn't enough place for one draw, try to fill the next one */
@@ -4214,8 +4401,210 @@ tc_callback(struct pipe_context *_pipe, void (*fn)(void *), void *data,
 
 
 /********************************************************************
- * create & destroy
+ * captured batches
+ */
+
+struct tc_captured_batch {
+   uint64_t *slots;
+   unsigned num_slots;
+   unsigned max_slots;
+   bool invalid;
+};
+
+/* Calls that only reference CSOs or carry their state by value. Draws are
+ * included because their only reference is the index buffer, which the
+ * captured batch holds.
+ */
+static const bool tc_call_replayable[TC_NUM_CALLS] = {
+   [TC_CALL_set_tess_state] = true,
+   [TC_CALL_set_patch_vertices] = true,
+   [TC_CALL_set_sample_locations] = true,
+   [TC_CALL_set_scissor_states] = true,
+   [TC_CALL_set_viewport_states] = true,
+   [TC_CALL_set_window_rectangles] = true,
+   [TC_CALL_bind_sampler_states] = true,
+   [TC_CALL_draw_single] = true,
+   [TC_CALL_draw_single_drawid] = true,
+   [TC_CALL_draw_multi] = true,
+   [TC_CALL_set_blend_color] = true,
+   [TC_CALL_set_stencil_ref] = true,
+   [TC_CALL_set_clip_state] = true,
+   [TC_CALL_set_sample_mask] = true,
+   [TC_CALL_set_min_samples] = true,
+   [TC_CALL_set_polygon_stipple] = true,
+   [TC_CALL_texture_barrier] = true,
+   [TC_CALL_memory_barrier] = true,
+   [TC_CALL_emit_string_marker] = true,
+   [TC_CALL_bind_blend_state] = true,
+   [TC_CALL_bind_rasterizer_state] = true,
+   [TC_CALL_bind_depth_stencil_alpha_state] = true,
+   [TC_CALL_bind_fs_state] = true,
+   [TC_CALL_bind_vs_state] = true,
+   [TC_CALL_bind_gs_state] = true,
+   [TC_CALL_bind_tcs_state] = true,
+   [TC_CALL_bind_tes_state] = true,
+   [TC_CALL_bind_vertex_elements_state] = true,
+};
+
+static struct pipe_resource *
+tc_get_draw_index_buffer(struct tc_call_base *call)
+{
+   const struct pipe_draw_info *info;
+
+   switch (call->call_id) {
+   case TC_CALL_draw_single:
+   case TC_CALL_draw_single_drawid:
+      info = &((struct tc_draw_single*)call)->info;
+      break;
+   case TC_CALL_draw_multi:
+      info = &((struct tc_draw_multi*)call)->info;
+      break;
+   default:
+      return NULL;
+   }
+
+   return info->index_size ? info->index.resource : NULL;
+}
+
+/* Copy the calls of the batch recorded since the capture began. This must
+ * be done before the batch is executed, because execution modifies the
+ * calls and releases their references.
  */
+static void
+tc_capture_calls(struct threaded_context *tc, struct tc_batch *batch)
+{
+   struct tc_captured_batch *capture = tc->capture;
+   uint64_t *first = &batch->slots[tc->capture_start];
+   uint64_t *last = &batch->slots[batch->num_total_slots];
+
+   tc->capture_start = 0;
+
+   if (!capture || capture->invalid)
+      return;
+
+   for (uint64_t *iter = first; iter != last;
+        iter += ((struct tc_call_base*)iter)->num_slots) {
+      if (!tc_call_replayable[((struct tc_call_base*)iter)->call_id]) {
+         capture->invalid = true;
+         return;
+      }
+   }
+
+   unsigned num_slots = last - first;
+   if (capture->num_slots + num_slots > capture->max_slots) {
+      unsigned max_slots = MAX2(capture->max_slots * 2,
+                                capture->num_slots + num_slots);
+      uint64_t *slots = REALLOC(capture->slots,
+                                capture->max_slots * sizeof(uint64_t),
+                                max_slots * sizeof(uint64_t));
+      if (!slots) {
+         capture->invalid = true;
+         return;
+      }
+      capture->slots = slots;
+      capture->max_slots = max_slots;
+   }
+
+   uint64_t *dst = &capture->slots[capture->num_slots];
+   memcpy(dst, first, num_slots * sizeof(uint64_t));
+   capture->num_slots += num_slots;
+
+   /* The captured batch keeps its own reference to each index buffer. */
+   for (uint64_t *iter = dst; iter != &capture->slots[capture->num_slots];
+        iter += ((struct tc_call_base*)iter)->num_slots) {
+      struct pipe_resource *indexbuf =
+         tc_get_draw_index_buffer((struct tc_call_base*)iter);
+
+      if (indexbuf)
+         pipe_reference(NULL, &indexbuf->reference);
+   }
+}
+
+void
+tc_begin_capture(struct pipe_context *_pipe)
+{
+   struct threaded_context *tc = threaded_context(_pipe);
+
+   assert(!tc->capture);
+   tc->capture = CALLOC_STRUCT(tc_captured_batch);
+   tc->capture_start = tc->batch_slots[tc->next]->num_total_slots;
+
+   /* Draws recorded before the capture must not be extended. */
+   tc->last_mergeable_draw = NULL;
+   tc->last_mergeable_subdata = NULL;
+}
+
+struct tc_captured_batch *
+tc_end_capture(struct pipe_context *_pipe)
+{
+   struct threaded_context *tc = threaded_context(_pipe);
+   struct tc_captured_batch *capture = tc->capture;
+
+   tc_capture_calls(tc, tc->batch_slots[tc->next]);
+   tc->capture = NULL;
+
+   /* Draws recorded later must not be appended to the captured ones,
+    * because the copies wouldn't see that.
+    */
+   tc->last_mergeable_draw = NULL;
+   tc->last_mergeable_subdata = NULL;
+
+   if (capture && (capture->invalid || !capture->num_slots)) {
+      tc_captured_batch_destroy(capture);
+      return NULL;
+   }
+   return capture;
+}
+
+void
+tc_replay_capture(struct pipe_context *_pipe,
+                  const struct tc_captured_batch *capture)
+{
+   struct threaded_context *tc = threaded_context(_pipe);
+   const uint64_t *last = &capture->slots[capture->num_slots];
+
+   for (const uint64_t *iter = capture->slots; iter != last;) {
+      const struct tc_call_base *src = (const struct tc_call_base*)iter;
+      unsigned num_slots = src->num_slots;
+
+      if (unlikely(tc->add_all_gfx_bindings_to_buffer_list) &&
+          (src->call_id == TC_CALL_draw_single ||
+           src->call_id == TC_CALL_draw_single_drawid ||
+           src->call_id == TC_CALL_draw_multi))
+         tc_add_all_gfx_bindings_to_buffer_list(tc);
+
+      struct tc_call_base *call = tc_add_sized_call(tc, src->call_id, num_slots);
+      memcpy(call, src, num_slots * sizeof(uint64_t));
+
+      struct pipe_resource *indexbuf = tc_get_draw_index_buffer(call);
+      if (indexbuf) {
+         pipe_reference(NULL, &indexbuf->reference);
+         tc_add_to_buffer_list(&tc->buffer_lists[tc->next_buf_list], indexbuf);
+      }
+
+      iter += num_slots;
+   }
+}
+
+void
+tc_captured_batch_destroy(struct tc_captured_batch *capture)
+{
+   if (!capture)
+      return;
+
+   for (uint64_t *iter = capture->slots;
+        iter != &capture->slots[capture->num_slots];
+        iter += ((struct tc_call_base*)iter)->num_slots) {
+      struct pipe_resource *indexbuf =
+         tc_get_draw_index_buffer((struct tc_call_base*)iter);
+
+      if (indexbuf)
+         pipe_resource_reference(&indexbuf, NULL);
+   }
+
+   FREE(capture->slots);
+   FREE(capture);
+}
 
 static void
 tc_destroy(struct pipe_context *_pipe)
@@ -4230,21 +4619,27 @@ tc_destroy(struct pipe_context *_pipe)
    if (tc->base.stream_uploader)
       u_upload_destroy(tc->base.stream_uploader);
 
-   tc_sync(tc);
+   if (tc->num_batches)
+      tc_sync(tc);
+
+   tc_captured_batch_destroy(tc->capture);
 
    if (util_queue_is_initialized(&tc->queue)) {
       util_queue_destroy(&tc->queue);
 
-      for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
-         util_queue_fence_destroy(&tc->batch_slots[i].fence);
-         assert(!tc->batch_slots[i].token);
-      }
    }
 
    slab_destroy_child(&tc->pool_transfers);
-   assert(tc->batch_slots[tc->next].num_total_slots == 0);
+   assert(!tc->num_batches ||
+          tc->batch_slots[tc->next]->num_total_slots == 0);
    pipe->destroy(pipe);
 
+   for (unsigned i = 0; i < tc->num_batches; i++) {
+      util_queue_fence_destroy(&tc->batch_slots[i]->fence);
+      assert(!tc->batch_slots[i]->token);
+      FREE(tc->batch_slots[i]);
+   }
+
    for (unsigned i = 0; i < TC_MAX_BUFFER_LISTS; i++) {
       if (!util_queue_fence_is_signalled(&tc->buffer_lists[i].driver_flushed_fence))
          util_queue_fence_signal(&tc->buffer_lists[i].driver_flushed_fence);
@@ -4337,21 +4732,32 @@ threaded_context_create(struct pipe_context *pipe,
    if (!tc->base.stream_uploader || !tc->base.const_uploader)
       goto fail;
 
+   /* Reuse upload buffers that the GPU is done with. The uploaders get
+    * a deferred fence when a buffer fills up, which doesn't sync with
+    * the driver thread if the driver can create fences asynchronously.
+    */
+   if (tc->options.create_fence) {
+      u_upload_enable_ring(tc->base.stream_uploader);
+      u_upload_enable_ring(tc->base.const_uploader);
+   }
+
    tc->use_forced_staging_uploads = true;
 
    /* The queue size is the number of batches "waiting". Batches are removed
     * from the queue before being executed, so keep one tc_batch slot for that
     * execution. Also, keep one unused slot for an unflushed batch.
+    *
+    * The ring never has more batches in flight than that, so adding a job
+    * doesn't block. Stalls happen in tc_get_idle_batch instead.
     */
    if (!util_queue_init(&tc->queue, "gdrv", TC_MAX_BATCHES - 2, 1, 0, NULL))
       goto fail;
 
-   for (unsigned i = 0; i < TC_MAX_BATCHES; i++) {
-#if !defined(NDEBUG) && TC_DEBUG >= 1
-      tc->batch_slots[i].sentinel = TC_SENTINEL;
-#endif
-      tc->batch_slots[i].tc = tc;
-      util_queue_fence_init(&tc->batch_slots[i].fence);
+   for (unsigned i = 0; i < TC_INITIAL_BATCHES; i++) {
+      tc->batch_slots[i] = tc_batch_create(tc);
+      if (!tc->batch_slots[i])
+         goto fail;
+      tc->num_batches++;
    }
    for (unsigned i = 0; i < TC_MAX_BUFFER_LISTS; i++)
       util_queue_fence_init(&tc->buffer_lists[i].driver_flushed_fence);
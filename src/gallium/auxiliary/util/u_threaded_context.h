@@ -211,6 +211,7 @@ extern "C" {
 
 struct threaded_context;
 struct tc_unflushed_batch_token;
+struct tc_captured_batch;
 
 /* 0 = disabled, 1 = assertions, 2 = printfs, 3 = logging */
 #define TC_DEBUG 0
@@ -229,16 +230,19 @@ struct tc_unflushed_batch_token;
 /* fence is pre-populated with a fence created by the create_fence callback */
 #define TC_FLUSH_ASYNC        (1u << 31)
 
-/* Size of the queue = number of batch slots in memory.
+/* Number of batch slots in memory = length of the batch ring.
  * - 1 batch is always idle and records new commands
  * - 1 batch is being executed
- * so the queue size is TC_MAX_BATCHES - 2 = number of waiting batches.
+ * - the rest are waiting in the queue.
  *
- * Use a size as small as possible for low CPU L2 cache usage but large enough
- * so that the queue isn't stalled too often for not having enough idle batch
- * slots.
+ * The ring starts with TC_INITIAL_BATCHES slots, which is as small as
+ * possible for low CPU L2 cache usage. If the batch after the one just
+ * flushed is still busy, i.e. the driver thread can't keep up, a new slot is
+ * inserted into the ring instead of waiting for the driver thread, up to
+ * TC_MAX_BATCHES slots. Only then does the producer stall.
  */
-#define TC_MAX_BATCHES        10
+#define TC_INITIAL_BATCHES    10
+#define TC_MAX_BATCHES        32
 
 /* The size of one batch. Non-trivial calls (i.e. not setting a CSO pointer)
  * can occupy multiple call slots.
@@ -271,6 +275,11 @@ struct tc_unflushed_batch_token;
  */
 #define TC_MAX_SUBDATA_BYTES        320
 
+/* Consecutive small buffer_subdata calls that write adjacent ranges of the
+ * same buffer are merged into one call up to this size.
+ */
+#define TC_MAX_MERGED_SUBDATA_BYTES 4096
+
 enum tc_binding_type {
    TC_BINDING_VERTEX_BUFFER,
    TC_BINDING_STREAMOUT_BUFFER,
@@ -459,6 +468,14 @@ struct threaded_context {
    unsigned num_offloaded_slots;
    unsigned num_direct_slots;
    unsigned num_syncs;
+   unsigned num_map_syncs;     /* syncs caused by transfer_map */
+   unsigned num_query_syncs;   /* syncs caused by get_query_result */
+   unsigned num_flush_syncs;   /* syncs caused by flush */
+   unsigned num_stalls;        /* waits for an idle batch with a full ring */
+   unsigned num_merged_draws;  /* draws appended to the previous draw call */
+   unsigned num_merged_subdata; /* buffer_subdata appended to the previous one */
+   unsigned sync_time_us;      /* time spent in syncs, in microseconds */
+   unsigned stall_time_us;     /* time spent in stalls, in microseconds */
 
    bool use_forced_staging_uploads;
    bool add_all_gfx_bindings_to_buffer_list;
@@ -497,7 +514,22 @@ struct threaded_context {
    unsigned max_images;
    unsigned max_samplers;
 
-   unsigned last, next, next_buf_list;
+   unsigned last, next, next_buf_list, num_batches;
+
+   /* The last recorded call if it's a draw that the next draw can be
+    * appended to. It's only valid while it's the last call of the current
+    * batch.
+    */
+   struct tc_call_base *last_mergeable_draw;
+
+   /* The same for buffer_subdata calls. */
+   struct tc_call_base *last_mergeable_subdata;
+
+   /* Calls are copied here between tc_begin_capture and tc_end_capture.
+    * capture_start is the first slot of the current batch to copy.
+    */
+   struct tc_captured_batch *capture;
+   unsigned capture_start;
 
    /* The list fences that the driver should signal after the next flush.
     * If this is empty, all driver command buffers have been flushed.
@@ -518,7 +550,7 @@ struct threaded_context {
    /* Don't use PIPE_MAX_SHADER_SAMPLER_VIEWS because it's too large. */
    uint32_t sampler_buffers[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_SAMPLER_VIEWS];
 
-   struct tc_batch batch_slots[TC_MAX_BATCHES];
+   struct tc_batch *batch_slots[TC_MAX_BATCHES];
    struct tc_buffer_list buffer_lists[TC_MAX_BUFFER_LISTS];
 };
 
@@ -549,6 +581,28 @@ tc_draw_vbo(struct pipe_context *_pipe, const struct pipe_draw_info *info,
             const struct pipe_draw_start_count_bias *draws,
             unsigned num_draws);
 
+/* A tc_captured_batch is a recorded sequence of calls that can be replayed
+ * without marshalling the calls again. Only CSO binds, simple state changes,
+ * barriers and direct draws can be captured. The objects the calls use,
+ * except index buffers, aren't referenced, so the captured batch must be
+ * destroyed before they are deleted.
+ */
+void
+tc_begin_capture(struct pipe_context *_pipe);
+
+/* Return NULL if nothing was captured or if a call that can't be replayed
+ * was recorded. The recorded calls are executed normally in any case.
+ */
+struct tc_captured_batch *
+tc_end_capture(struct pipe_context *_pipe);
+
+void
+tc_replay_capture(struct pipe_context *_pipe,
+                  const struct tc_captured_batch *capture);
+
+void
+tc_captured_batch_destroy(struct tc_captured_batch *capture);
+
 static inline struct threaded_context *
 threaded_context(struct pipe_context *pipe)
 {
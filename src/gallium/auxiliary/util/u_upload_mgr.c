@@ -37,6 +37,16 @@
 
 #include "u_upload_mgr.h"
 
+/* The number of full buffers kept around for reuse in ring mode. */
+#define U_UPLOAD_MAX_RETIRED 4
+
+struct u_upload_retired {
+   struct pipe_resource *buffer;
+   struct pipe_transfer *transfer;
+   uint8_t *map;
+   struct pipe_fence_handle *fence; /* Signalled when the GPU is done. */
+};
+
 
 struct u_upload_mgr {
    struct pipe_context *pipe;
@@ -55,6 +65,12 @@ struct u_upload_mgr {
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
    int buffer_private_refcount;
+
+   boolean ring;    /* Reuse full buffers, see u_upload_enable_ring. */
+   unsigned num_retired;
+   struct u_upload_retired retired[U_UPLOAD_MAX_RETIRED]; /* oldest first */
+
+   unsigned num_bytes;  /* Total bytes suballocated, wraps around. */
 };
 
 
@@ -109,6 +125,8 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload)
                                                  upload->flags);
    if (!upload->map_persistent && result->map_persistent)
       u_upload_disable_persistent(result);
+   if (upload->ring)
+      u_upload_enable_ring(result);
 
    return result;
 }
@@ -119,6 +137,19 @@ u_upload_disable_persistent(struct u_upload_mgr *upload)
    upload->map_persistent = FALSE;
    upload->map_flags &= ~(PIPE_MAP_COHERENT | PIPE_MAP_PERSISTENT);
    upload->map_flags |= PIPE_MAP_FLUSH_EXPLICIT;
+   upload->ring = FALSE;
+}
+
+unsigned
+u_upload_get_num_bytes(struct u_upload_mgr *upload)
+{
+   return upload->num_bytes;
+}
+
+void
+u_upload_enable_ring(struct u_upload_mgr *upload)
+{
+   upload->ring = upload->map_persistent;
 }
 
 static void
@@ -148,10 +179,8 @@ u_upload_unmap(struct u_upload_mgr *upload)
 
 
 static void
-u_upload_release_buffer(struct u_upload_mgr *upload)
+u_upload_drop_private_refs(struct u_upload_mgr *upload)
 {
-   /* Unmap and unreference the upload buffer. */
-   upload_unmap_internal(upload, TRUE);
    if (upload->buffer_private_refcount) {
       /* Subtract the remaining private references before unreferencing
        * the buffer. The mega comment below explains it.
@@ -161,15 +190,108 @@ u_upload_release_buffer(struct u_upload_mgr *upload)
                    -upload->buffer_private_refcount);
       upload->buffer_private_refcount = 0;
    }
+}
+
+static void
+u_upload_release_buffer(struct u_upload_mgr *upload)
+{
+   /* Unmap and unreference the upload buffer. */
+   upload_unmap_internal(upload, TRUE);
+   u_upload_drop_private_refs(upload);
    pipe_resource_reference(&upload->buffer, NULL);
    upload->buffer_size = 0;
 }
 
+static void
+u_upload_release_retired(struct u_upload_mgr *upload, unsigned i)
+{
+   struct u_upload_retired *retired = &upload->retired[i];
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   pipe_buffer_unmap(upload->pipe, retired->transfer);
+   screen->fence_reference(screen, &retired->fence, NULL);
+   pipe_resource_reference(&retired->buffer, NULL);
+
+   upload->num_retired--;
+   memmove(retired, retired + 1,
+           (upload->num_retired - i) * sizeof(*retired));
+}
+
+/* Keep the full upload buffer mapped, together with a fence for the work
+ * that has used it so far.
+ */
+static void
+u_upload_retire_buffer(struct u_upload_mgr *upload)
+{
+   if (!upload->buffer)
+      return;
+
+   if (!upload->map) {
+      u_upload_release_buffer(upload);
+      return;
+   }
+
+   if (upload->num_retired == U_UPLOAD_MAX_RETIRED)
+      u_upload_release_retired(upload, 0);
+
+   u_upload_drop_private_refs(upload);
+
+   struct u_upload_retired *retired = &upload->retired[upload->num_retired++];
+   retired->buffer = upload->buffer;
+   retired->transfer = upload->transfer;
+   retired->map = upload->map;
+   retired->fence = NULL;
+   upload->pipe->flush(upload->pipe, &retired->fence, PIPE_FLUSH_DEFERRED);
+
+   upload->buffer = NULL;
+   upload->transfer = NULL;
+   upload->map = NULL;
+   upload->buffer_size = 0;
+}
+
+/* Make an idle retired buffer that nobody else references current. */
+static bool
+u_upload_reuse_buffer(struct u_upload_mgr *upload, unsigned min_size)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   for (unsigned i = 0; i < upload->num_retired; i++) {
+      struct u_upload_retired *retired = &upload->retired[i];
+      struct pipe_resource *buffer = retired->buffer;
+
+      if (buffer->width0 < min_size ||
+          p_atomic_read(&buffer->reference.count) != 1 ||
+          !retired->fence ||
+          !screen->fence_finish(screen, NULL, retired->fence, 0))
+         continue;
+
+      screen->fence_reference(screen, &retired->fence, NULL);
+      upload->buffer = buffer;
+      upload->transfer = retired->transfer;
+      upload->map = retired->map;
+      upload->buffer_size = buffer->width0;
+      upload->offset = 0;
+
+      upload->num_retired--;
+      memmove(retired, retired + 1,
+              (upload->num_retired - i) * sizeof(*retired));
+
+      /* See u_upload_alloc_buffer. */
+      upload->buffer_private_refcount = 1 + (upload->buffer_size - min_size);
+      p_atomic_add(&buffer->reference.count, upload->buffer_private_refcount);
+      return true;
+   }
+
+   return false;
+}
+
 
 void
 u_upload_destroy(struct u_upload_mgr *upload)
 {
    u_upload_release_buffer(upload);
+   while (upload->num_retired)
+      u_upload_release_retired(upload, 0);
    FREE(upload);
 }
 
@@ -181,9 +303,15 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
    struct pipe_resource buffer;
    unsigned size;
 
-   /* Release the old buffer, if present:
+   /* Release the old buffer, if present, or reuse an idle one in ring mode:
     */
-   u_upload_release_buffer(upload);
+   if (upload->ring) {
+      u_upload_retire_buffer(upload);
+      if (u_upload_reuse_buffer(upload, min_size))
+         return upload->buffer_size;
+   } else {
+      u_upload_release_buffer(upload);
+   }
 
    /* Allocate a new one:
     */
@@ -313,6 +441,7 @@ u_upload_alloc(struct u_upload_mgr *upload,
    }
 
    upload->offset = offset + size;
+   upload->num_bytes += size;
 }
 
 void
@@ -73,6 +73,24 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload);
 void
 u_upload_disable_persistent(struct u_upload_mgr *upload);
 
+/**
+ * Keep full upload buffers with a deferred fence and reuse them once the
+ * GPU is done with them, instead of creating a new buffer every time.
+ * This only has an effect with persistent mappings.
+ *
+ * The uploader calls pipe_context::flush with PIPE_FLUSH_DEFERRED when
+ * a buffer fills up, so it must not be used from inside the driver.
+ */
+void
+u_upload_enable_ring(struct u_upload_mgr *upload);
+
+/**
+ * Return the number of bytes that have been suballocated so far. The counter
+ * wraps around, so only differences between two calls are meaningful.
+ */
+unsigned
+u_upload_get_num_bytes(struct u_upload_mgr *upload);
+
 /**
  * Destroy the upload manager.
  */
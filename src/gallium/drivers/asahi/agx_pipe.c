@@ -558,10 +558,9 @@ agx_flush(struct pipe_context *pctx,
    }
 
    memset(batch->bo_list, 0, sizeof(batch->bo_list));
-   agx_pool_cleanup(&ctx->batch->pool);
-   agx_pool_cleanup(&ctx->batch->pipeline_pool);
-   agx_pool_init(&ctx->batch->pool, dev, AGX_MEMORY_TYPE_FRAMEBUFFER, true);
-   agx_pool_init(&ctx->batch->pipeline_pool, dev, AGX_MEMORY_TYPE_CMDBUF_32, true);
+   agx_pool_reset(&ctx->batch->pool);
+   agx_pool_reset(&ctx->batch->pipeline_pool);
+   memset(ctx->batch->records, 0, sizeof(ctx->batch->records));
    ctx->batch->clear = 0;
    ctx->batch->draw = 0;
    ctx->batch->encoder_current = ctx->batch->encoder->ptr.cpu;
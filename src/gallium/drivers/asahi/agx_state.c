@@ -1348,12 +1348,32 @@ agx_build_store_pipeline(struct agx_context *ctx, uint32_t code,
    return ptr.gpu;
 }
 
+/* Uploads a packed state record unless the batch already has an identical copy
+ * of it, in which case that copy is referenced again */
 static uint64_t
-demo_launch_fragment(struct agx_context *ctx, struct agx_pool *pool, uint32_t pipeline, uint32_t varyings, unsigned input_count)
+agx_upload_state_record(struct agx_batch *batch, enum agx_state_record record,
+                        const void *data, unsigned size)
 {
-   struct agx_ptr t = agx_pool_alloc_aligned(pool, AGX_BIND_PIPELINE_LENGTH, 64);
+   struct agx_state_record_cache *cache = &batch->records[record];
 
-   agx_pack(t.cpu, BIND_PIPELINE, cfg) {
+   assert(size <= sizeof(cache->data));
+
+   if (cache->gpu && cache->size == size && !memcmp(cache->data, data, size))
+      return cache->gpu;
+
+   cache->gpu = agx_pool_upload_aligned(&batch->pool, data, size, 64);
+   cache->size = size;
+   memcpy(cache->data, data, size);
+
+   return cache->gpu;
+}
+
+static uint64_t
+demo_launch_fragment(struct agx_context *ctx, struct agx_batch *batch, uint32_t pipeline, uint32_t varyings, unsigned input_count)
+{
+   struct agx_bind_pipeline_packed out;
+
+   agx_pack(&out, BIND_PIPELINE, cfg) {
       cfg.tag = AGX_BIND_PIPELINE_FRAGMENT;
       cfg.sampler_count = ctx->stage[PIPE_SHADER_FRAGMENT].texture_count;
       cfg.texture_count = ctx->stage[PIPE_SHADER_FRAGMENT].texture_count;
@@ -1362,38 +1382,41 @@ demo_launch_fragment(struct agx_context *ctx, struct agx_pool *pool, uint32_t pi
       cfg.fs_varyings = varyings;
    };
 
-   return t.gpu;
+   return agx_upload_state_record(batch, AGX_RECORD_LAUNCH_FRAGMENT,
+                                  &out, sizeof(out));
 }
 
 static uint64_t
-demo_interpolation(struct agx_compiled_shader *fs, struct agx_pool *pool)
+demo_interpolation(struct agx_compiled_shader *fs, struct agx_batch *batch)
 {
-   struct agx_ptr t = agx_pool_alloc_aligned(pool, AGX_INTERPOLATION_LENGTH, 64);
+   struct agx_interpolation_packed out;
 
-   agx_pack(t.cpu, INTERPOLATION, cfg) {
+   agx_pack(&out, INTERPOLATION, cfg) {
       cfg.varying_count = fs->info.varyings.nr_slots;
    };
 
-   return t.gpu;
+   return agx_upload_state_record(batch, AGX_RECORD_INTERPOLATION,
+                                  &out, sizeof(out));
 }
 
 static uint64_t
-demo_linkage(struct agx_compiled_shader *vs, struct agx_pool *pool)
+demo_linkage(struct agx_compiled_shader *vs, struct agx_batch *batch)
 {
-   struct agx_ptr t = agx_pool_alloc_aligned(pool, AGX_LINKAGE_LENGTH, 64);
+   struct agx_linkage_packed out;
 
-   agx_pack(t.cpu, LINKAGE, cfg) {
+   agx_pack(&out, LINKAGE, cfg) {
       cfg.varying_count = vs->info.varyings.nr_slots;
 
       // 0x2 for fragcoordz, 0x1 for varyings at all
       cfg.unk_1 = 0x210000 | (vs->info.writes_psiz ? 0x40000 : 0);
    };
 
-   return t.gpu;
+   return agx_upload_state_record(batch, AGX_RECORD_LINKAGE,
+                                  &out, sizeof(out));
 }
 
 static uint64_t
-demo_rasterizer(struct agx_context *ctx, struct agx_pool *pool, bool is_points)
+demo_rasterizer(struct agx_context *ctx, struct agx_batch *batch, bool is_points)
 {
    struct agx_rasterizer *rast = ctx->rast;
    struct agx_rasterizer_packed out;
@@ -1424,15 +1447,16 @@ demo_rasterizer(struct agx_context *ctx, struct agx_pool *pool, bool is_points)
    out.opaque[4] |= ctx->zs.back.opaque[0];
    out.opaque[5] |= ctx->zs.back.opaque[1];
 
-   return agx_pool_upload_aligned(pool, &out, sizeof(out), 64);
+   return agx_upload_state_record(batch, AGX_RECORD_RASTERIZER,
+                                  &out, sizeof(out));
 }
 
 static uint64_t
-demo_unk11(struct agx_pool *pool, bool prim_lines, bool prim_points, bool reads_tib, bool sample_mask_from_shader)
+demo_unk11(struct agx_batch *batch, bool prim_lines, bool prim_points, bool reads_tib, bool sample_mask_from_shader)
 {
-   struct agx_ptr T = agx_pool_alloc_aligned(pool, AGX_UNKNOWN_4A_LENGTH, 64);
+   struct agx_unknown_4a_packed out;
 
-   agx_pack(T.cpu, UNKNOWN_4A, cfg) {
+   agx_pack(&out, UNKNOWN_4A, cfg) {
       cfg.lines_or_points = (prim_lines || prim_points);
       cfg.reads_tilebuffer = reads_tib;
       cfg.sample_mask_from_shader = sample_mask_from_shader;
@@ -1441,11 +1465,12 @@ demo_unk11(struct agx_pool *pool, bool prim_lines, bool prim_points, bool reads_
       cfg.front.points = cfg.back.points = prim_points;
    };
 
-   return T.gpu;
+   return agx_upload_state_record(batch, AGX_RECORD_UNK11,
+                                  &out, sizeof(out));
 }
 
 static uint64_t
-demo_unk12(struct agx_pool *pool)
+demo_unk12(struct agx_batch *batch)
 {
    uint32_t unk[] = {
       0x410000,
@@ -1453,7 +1478,7 @@ demo_unk12(struct agx_pool *pool)
       0xa0
    };
 
-   return agx_pool_upload(pool, unk, sizeof(unk));
+   return agx_upload_state_record(batch, AGX_RECORD_UNK12, unk, sizeof(unk));
 }
 
 static uint64_t
@@ -1503,11 +1528,11 @@ agx_encode_state(struct agx_context *ctx, uint8_t *out,
    bool reads_tib = ctx->fs->info.reads_tib;
    bool sample_mask_from_shader = ctx->fs->info.writes_sample_mask;
 
-   agx_push_record(&out, 5, demo_interpolation(ctx->fs, pool));
-   agx_push_record(&out, 5, demo_launch_fragment(ctx, pool, pipeline_fragment, varyings, ctx->fs->info.varyings.nr_descs));
-   agx_push_record(&out, 4, demo_linkage(ctx->vs, pool));
-   agx_push_record(&out, 7, demo_rasterizer(ctx, pool, is_points));
-   agx_push_record(&out, 5, demo_unk11(pool, is_lines, is_points, reads_tib, sample_mask_from_shader));
+   agx_push_record(&out, 5, demo_interpolation(ctx->fs, ctx->batch));
+   agx_push_record(&out, 5, demo_launch_fragment(ctx, ctx->batch, pipeline_fragment, varyings, ctx->fs->info.varyings.nr_descs));
+   agx_push_record(&out, 4, demo_linkage(ctx->vs, ctx->batch));
+   agx_push_record(&out, 7, demo_rasterizer(ctx, ctx->batch, is_points));
+   agx_push_record(&out, 5, demo_unk11(ctx->batch, is_lines, is_points, reads_tib, sample_mask_from_shader));
 
    if (ctx->dirty & (AGX_DIRTY_VIEWPORT | AGX_DIRTY_SCISSOR)) {
       struct agx_viewport_scissor vps = agx_upload_viewport_scissor(pool,
@@ -1518,8 +1543,10 @@ agx_encode_state(struct agx_context *ctx, uint8_t *out,
       agx_push_record(&out, 2, agx_set_scissor_index(pool, vps.scissor));
    }
 
-   agx_push_record(&out, 3, demo_unk12(pool));
-   agx_push_record(&out, 2, agx_pool_upload(pool, ctx->rast->cull, sizeof(ctx->rast->cull)));
+   agx_push_record(&out, 3, demo_unk12(ctx->batch));
+   agx_push_record(&out, 2, agx_upload_state_record(ctx->batch, AGX_RECORD_CULL,
+                                                    ctx->rast->cull,
+                                                    sizeof(ctx->rast->cull)));
 
    return out;
 }
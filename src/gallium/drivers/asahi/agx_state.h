@@ -94,6 +94,28 @@ struct agx_scissors {
       unsigned count;
 };
 
+/* State records referenced from the encoder, in the order they are emitted */
+enum agx_state_record {
+   AGX_RECORD_INTERPOLATION,
+   AGX_RECORD_LAUNCH_FRAGMENT,
+   AGX_RECORD_LINKAGE,
+   AGX_RECORD_RASTERIZER,
+   AGX_RECORD_UNK11,
+   AGX_RECORD_UNK12,
+   AGX_RECORD_CULL,
+   AGX_NUM_STATE_RECORDS
+};
+
+#define AGX_MAX_STATE_RECORD_SIZE 32
+
+/* Last upload of a state record within a batch. Draws that pack identical
+ * state point at the same copy instead of uploading it again */
+struct agx_state_record_cache {
+   uint64_t gpu;
+   unsigned size;
+   uint8_t data[AGX_MAX_STATE_RECORD_SIZE];
+};
+
 struct agx_batch {
    unsigned width, height, nr_cbufs;
    struct pipe_surface *cbufs[8];
@@ -113,6 +135,8 @@ struct agx_batch {
    uint8_t *encoder_current;
 
    struct agx_scissors scissor;
+
+   struct agx_state_record_cache records[AGX_NUM_STATE_RECORDS];
 };
 
 struct agx_zsa {
@@ -38,6 +38,10 @@
 #include "tgsi/tgsi_from_mesa.h"
 #include "tgsi/tgsi_ureg.h"
 
+#include "compiler/nir/nir_serialize.h"
+
+#include "util/blob.h"
+#include "util/disk_cache.h"
 #include "util/hash_table.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
@@ -89,6 +93,80 @@ can_remove_dead_sampler(nir_variable *var, void *data)
    return glsl_type_is_sampler(base_type) && !glsl_type_is_bare_sampler(base_type);
 }
 
+static void
+compute_dxil_cache_key(struct disk_cache *cache, nir_shader *nir,
+                       const struct nir_to_dxil_options *opts,
+                       bool validated, cache_key key)
+{
+   struct blob blob;
+   blob_init(&blob);
+
+   /* Hash the options one by one, the struct has padding. */
+   blob_write_uint8(&blob, opts->interpolate_at_vertex);
+   blob_write_uint8(&blob, opts->lower_int16);
+   blob_write_uint8(&blob, opts->disable_math_refactoring);
+   blob_write_uint8(&blob, opts->no_ubo0);
+   blob_write_uint8(&blob, opts->last_ubo_is_not_arrayed);
+   blob_write_uint32(&blob, opts->provoking_vertex);
+   blob_write_uint32(&blob, opts->num_kernel_globals);
+   blob_write_uint32(&blob, opts->input_clip_size);
+   blob_write_uint32(&blob, opts->environment);
+   /* The validator signs the module, unsigned ones can't be reused once
+    * it is available.
+    */
+   blob_write_uint8(&blob, validated);
+   nir_serialize(&blob, nir, false);
+
+   disk_cache_compute_key(cache, blob.data, blob.size, key);
+   blob_finish(&blob);
+}
+
+/* An entry is the DXIL followed by the NIR as nir_to_dxil left it, which is
+ * what the binding information of the variant is gathered from.
+ */
+static bool
+load_cached_dxil(struct disk_cache *cache, const cache_key key,
+                 nir_shader *nir, struct blob *dxil)
+{
+   size_t size;
+   void *data = disk_cache_get(cache, key, &size);
+   if (!data)
+      return false;
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, data, size);
+   uint32_t dxil_size = blob_read_uint32(&reader);
+   const void *dxil_data = blob_read_bytes(&reader, dxil_size);
+   nir_shader *cached_nir = NULL;
+   if (!reader.overrun)
+      cached_nir = nir_deserialize(NULL, nir->options, &reader);
+   if (!cached_nir || reader.overrun) {
+      ralloc_free(cached_nir);
+      free(data);
+      return false;
+   }
+
+   blob_init(dxil);
+   blob_write_bytes(dxil, dxil_data, dxil_size);
+   nir_shader_replace(nir, cached_nir);
+   free(data);
+   return true;
+}
+
+static void
+store_cached_dxil(struct disk_cache *cache, const cache_key key,
+                  nir_shader *nir, const struct blob *dxil)
+{
+   struct blob blob;
+   blob_init(&blob);
+   blob_write_uint32(&blob, dxil->size);
+   blob_write_bytes(&blob, dxil->data, dxil->size);
+   nir_serialize(&blob, nir, false);
+   if (!blob.out_of_memory)
+      disk_cache_put(cache, key, blob.data, blob.size, NULL);
+   blob_finish(&blob);
+}
+
 static struct d3d12_shader *
 compile_nir(struct d3d12_context *ctx, struct d3d12_shader_selector *sel,
             struct d3d12_shader_key *key, struct nir_shader *nir)
@@ -148,8 +226,25 @@ compile_nir(struct d3d12_context *ctx, struct d3d12_shader_selector *sel,
    opts.input_clip_size = key->input_clip_size;
    opts.environment = DXIL_ENVIRONMENT_GL;
 
+   bool validate = false;
+#ifdef _WIN32
+   validate = ctx->dxil_validator && !(d3d12_debug & D3D12_DEBUG_EXPERIMENTAL);
+#endif
+
+   /* Skip the cache when the disassembly was asked for. */
+   struct disk_cache *cache = screen->disk_cache;
+   if (d3d12_debug & D3D12_DEBUG_DISASS)
+      cache = NULL;
+
+   cache_key dxil_key;
+   bool cached = false;
    struct blob tmp;
-   if (!nir_to_dxil(nir, &opts, &tmp)) {
+   if (cache) {
+      compute_dxil_cache_key(cache, nir, &opts, validate, dxil_key);
+      cached = load_cached_dxil(cache, dxil_key, nir, &tmp);
+   }
+
+   if (!cached && !nir_to_dxil(nir, &opts, &tmp)) {
       debug_printf("D3D12: nir_to_dxil failed\n");
       return NULL;
    }
@@ -187,8 +282,8 @@ compile_nir(struct d3d12_context *ctx, struct d3d12_shader_selector *sel,
    }
 
 #ifdef _WIN32
-   if (ctx->dxil_validator) {
-      if (!(d3d12_debug & D3D12_DEBUG_EXPERIMENTAL)) {
+   if (ctx->dxil_validator && !cached) {
+      if (validate) {
          char *err;
          if (!dxil_validate_module(ctx->dxil_validator, tmp.data,
                                    tmp.size, &err) && err) {
@@ -214,6 +309,9 @@ compile_nir(struct d3d12_context *ctx, struct d3d12_shader_selector *sel,
    }
 #endif
 
+   if (cache && !cached)
+      store_cached_dxil(cache, dxil_key, nir, &tmp);
+
    blob_finish_get_buffer(&tmp, &shader->bytecode, &shader->bytecode_length);
 
    if (d3d12_debug & D3D12_DEBUG_DXIL) {
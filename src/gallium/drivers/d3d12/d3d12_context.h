@@ -149,8 +149,21 @@ struct d3d12_shader_state {
    unsigned state_dirty;
 };
 
+/* The descriptors last copied into a GPU-visible table of the current batch.
+ * Descriptor table contents are never overwritten before the batch is reset,
+ * so a table with the same source descriptors can be bound again instead of
+ * copied.
+ */
+struct d3d12_descriptor_table_cache {
+   uint64_t submit_id;
+   D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle;
+   unsigned num_descs;
+   D3D12_CPU_DESCRIPTOR_HANDLE descs[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+};
+
 struct blitter_context;
 struct primconvert_context;
+struct d3d12_root_signature;
 
 #ifdef _WIN32
 struct dxil_validator;
@@ -172,6 +185,7 @@ struct d3d12_context {
    struct hash_table *pso_cache;
    struct hash_table *compute_pso_cache;
    struct hash_table *root_signature_cache;
+   struct d3d12_root_signature *last_root_signature[2];
    struct hash_table *cmd_signature_cache;
    struct hash_table *gs_variant_cache;
    struct hash_table *tcs_variant_cache;
@@ -233,6 +247,8 @@ struct d3d12_context {
    struct d3d12_gfx_pipeline_state gfx_pipeline_state;
    struct d3d12_compute_pipeline_state compute_pipeline_state;
    unsigned shader_dirty[PIPE_SHADER_TYPES];
+   struct d3d12_descriptor_table_cache srv_tables[PIPE_SHADER_TYPES];
+   struct d3d12_descriptor_table_cache sampler_tables[PIPE_SHADER_TYPES];
    unsigned state_dirty;
    unsigned cmdlist_dirty;
    ID3D12PipelineState *current_gfx_pso;
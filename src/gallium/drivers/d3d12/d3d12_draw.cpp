@@ -88,6 +88,30 @@ fill_cbv_descriptors(struct d3d12_context *ctx,
    return table_start.gpu_handle;
 }
 
+static bool
+descriptor_table_cache_matches(const struct d3d12_descriptor_table_cache *cache,
+                               const struct d3d12_batch *batch,
+                               const D3D12_CPU_DESCRIPTOR_HANDLE *descs,
+                               unsigned num_descs)
+{
+   return cache->submit_id == batch->submit_id &&
+          cache->num_descs == num_descs &&
+          memcmp(cache->descs, descs, num_descs * sizeof(*descs)) == 0;
+}
+
+static void
+descriptor_table_cache_store(struct d3d12_descriptor_table_cache *cache,
+                             const struct d3d12_batch *batch,
+                             D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle,
+                             const D3D12_CPU_DESCRIPTOR_HANDLE *descs,
+                             unsigned num_descs)
+{
+   cache->submit_id = batch->submit_id;
+   cache->gpu_handle = gpu_handle;
+   cache->num_descs = num_descs;
+   memcpy(cache->descs, descs, num_descs * sizeof(*descs));
+}
+
 static D3D12_GPU_DESCRIPTOR_HANDLE
 fill_srv_descriptors(struct d3d12_context *ctx,
                      struct d3d12_shader *shader,
@@ -97,6 +121,7 @@ fill_srv_descriptors(struct d3d12_context *ctx,
    struct d3d12_screen *screen = d3d12_screen(ctx->base.screen);
    D3D12_CPU_DESCRIPTOR_HANDLE descs[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    struct d3d12_descriptor_handle table_start;
+   bool descs_changed = false;
 
    d2d12_descriptor_heap_get_next_handle(batch->view_heap, &table_start);
 
@@ -120,6 +145,7 @@ fill_srv_descriptors(struct d3d12_context *ctx,
          if (view->texture_generation_id != res->generation_id) {
             d3d12_init_sampler_view_descriptor(view);
             view->texture_generation_id = res->generation_id;
+            descs_changed = true;
          }
 
          D3D12_RESOURCE_STATES state = (stage == PIPE_SHADER_FRAGMENT) ?
@@ -143,7 +169,14 @@ fill_srv_descriptors(struct d3d12_context *ctx,
       }
    }
 
-   d3d12_descriptor_heap_append_handles(batch->view_heap, descs, shader->end_srv_binding - shader->begin_srv_binding);
+   unsigned num_descs = shader->end_srv_binding - shader->begin_srv_binding;
+   struct d3d12_descriptor_table_cache *cache = &ctx->srv_tables[stage];
+   if (!descs_changed &&
+       descriptor_table_cache_matches(cache, batch, descs, num_descs))
+      return cache->gpu_handle;
+
+   d3d12_descriptor_heap_append_handles(batch->view_heap, descs, num_descs);
+   descriptor_table_cache_store(cache, batch, table_start.gpu_handle, descs, num_descs);
 
    return table_start.gpu_handle;
 }
@@ -219,7 +252,13 @@ fill_sampler_descriptors(struct d3d12_context *ctx,
          descs[desc_idx] = ctx->null_sampler.cpu_handle;
    }
 
-   d3d12_descriptor_heap_append_handles(batch->sampler_heap, descs, shader->end_srv_binding - shader->begin_srv_binding);
+   unsigned num_descs = shader->end_srv_binding - shader->begin_srv_binding;
+   struct d3d12_descriptor_table_cache *cache = &ctx->sampler_tables[stage];
+   if (descriptor_table_cache_matches(cache, batch, descs, num_descs))
+      return cache->gpu_handle;
+
+   d3d12_descriptor_heap_append_handles(batch->sampler_heap, descs, num_descs);
+   descriptor_table_cache_store(cache, batch, table_start.gpu_handle, descs, num_descs);
    return table_start.gpu_handle;
 }
 
@@ -258,7 +258,17 @@ d3d12_get_root_signature(struct d3d12_context *ctx, bool compute)
    struct d3d12_root_signature_key key;
 
    fill_key(ctx, &key, compute);
-   struct hash_entry *entry = _mesa_hash_table_search(ctx->root_signature_cache, &key);
+
+   /* Most shader changes keep the same resource layout, so check the
+    * signature that was bound last before hashing the key.
+    */
+   struct d3d12_root_signature *last = ctx->last_root_signature[compute];
+   if (last && memcmp(&last->key, &key, sizeof(key)) == 0)
+      return last->sig;
+
+   uint32_t hash = _mesa_hash_data(&key, sizeof(key));
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(ctx->root_signature_cache, hash, &key);
    if (!entry) {
       struct d3d12_root_signature *data =
          (struct d3d12_root_signature *)MALLOC(sizeof(struct d3d12_root_signature));
@@ -272,11 +282,14 @@ d3d12_get_root_signature(struct d3d12_context *ctx, bool compute)
          return NULL;
       }
 
-      entry = _mesa_hash_table_insert(ctx->root_signature_cache, &data->key, data);
+      entry = _mesa_hash_table_insert_pre_hashed(ctx->root_signature_cache, hash,
+                                                 &data->key, data);
       assert(entry);
    }
 
-   return ((struct d3d12_root_signature *)entry->data)->sig;
+   last = (struct d3d12_root_signature *)entry->data;
+   ctx->last_root_signature[compute] = last;
+   return last->sig;
 }
 
 static uint32_t
@@ -36,6 +36,8 @@
 
 #include "pipebuffer/pb_bufmgr.h"
 #include "util/debug.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_screen.h"
@@ -737,6 +739,7 @@ d3d12_destroy_screen(struct d3d12_screen *screen)
    slab_destroy_parent(&screen->transfer_pool);
    mtx_destroy(&screen->submit_mutex);
    mtx_destroy(&screen->descriptor_pool_mutex);
+   disk_cache_destroy(screen->disk_cache);
    glsl_type_singleton_decref();
    FREE(screen);
 }
@@ -1089,6 +1092,28 @@ d3d12_init_null_rtv(struct d3d12_screen *screen)
    screen->dev->CreateRenderTargetView(NULL, &rtv, screen->null_rtv.cpu_handle);
 }
 
+static void
+d3d12_init_disk_cache(struct d3d12_screen *screen)
+{
+#ifdef ENABLE_SHADER_CACHE
+   struct mesa_sha1 ctx;
+   unsigned char sha1[20];
+   char cache_id[20 * 2 + 1];
+
+   /* DXIL doesn't depend on the adapter, everything that feeds into it is
+    * either part of the NIR or of the nir_to_dxil options that are hashed
+    * into the key of each entry.
+    */
+   _mesa_sha1_init(&ctx);
+   if (!disk_cache_get_function_identifier((void *)d3d12_init_disk_cache, &ctx))
+      return;
+   _mesa_sha1_final(&ctx, sha1);
+
+   disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
+   screen->disk_cache = disk_cache_create("d3d12", cache_id, 0);
+#endif
+}
+
 void
 d3d12_init_screen_base(struct d3d12_screen *screen, struct sw_winsys *winsys, LUID *adapter_luid)
 {
@@ -1309,6 +1334,8 @@ d3d12_init_screen(struct d3d12_screen *screen, IUnknown *adapter)
    if (!screen->opts.DoublePrecisionFloatShaderOps)
       screen->nir_options.lower_doubles_options = (nir_lower_doubles_options)~0;
 
+   d3d12_init_disk_cache(screen);
+
    glsl_type_singleton_init_or_ref();
    return true;
 }
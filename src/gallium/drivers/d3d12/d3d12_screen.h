@@ -108,6 +108,9 @@ struct d3d12_screen {
 
    nir_shader_compiler_options nir_options;
 
+   /* DXIL of compiled shader variants, keyed by the NIR they came from */
+   struct disk_cache *disk_cache;
+
    /* description */
    uint32_t vendor_id;
    uint64_t driver_version;
@@ -39,6 +39,7 @@
 #include "util/u_memory.h"
 #include "util/register_allocate.h"
 #include "compiler/nir/nir_builder.h"
+#include "compiler/nir/nir_schedule.h"
 
 #include "tgsi/tgsi_strings.h"
 #include "util/compiler.h"
@@ -874,6 +875,23 @@ lower_alu(struct etna_compile *c, nir_alu_instr *alu)
    }
 }
 
+/* Rough latencies for nir_schedule to hide behind independent ALU work */
+static unsigned
+etna_instr_delay_cb(nir_instr *instr, void *data)
+{
+   switch (instr->type) {
+   case nir_instr_type_tex:
+      return 20;
+   case nir_instr_type_intrinsic:
+      /* UBO loads are LOAD instructions reading from memory */
+      if (nir_instr_as_intrinsic(instr)->intrinsic == nir_intrinsic_load_ubo)
+         return 10;
+      return 1;
+   default:
+      return 1;
+   }
+}
+
 static bool
 emit_shader(struct etna_compile *c, unsigned *num_temps, unsigned *num_consts)
 {
@@ -975,6 +993,17 @@ emit_shader(struct etna_compile *c, unsigned *num_temps, unsigned *num_consts)
    nir_convert_from_ssa(shader, true);
    nir_opt_dce(shader);
 
+   if (!DBG_ENABLED(ETNA_DBG_NO_SCHED)) {
+      const struct nir_schedule_options schedule_options = {
+         /* The fewer temps a shader uses, the more threads the hardware runs
+          * it with, so start reducing pressure long before RA would fail.
+          */
+         .threshold = c->specs->max_registers,
+         .instr_delay_cb = etna_instr_delay_cb,
+      };
+      nir_schedule(shader, &schedule_options);
+   }
+
    etna_ra_assign(c, shader);
 
    emit_cf_list(c, &nir_shader_get_entrypoint(shader)->body);
@@ -56,6 +56,7 @@
 #define ETNA_DBG_NO_SINGLEBUF    0x1000000 /* disable single buffer feature */
 #define ETNA_DBG_DEQP            0x2000000 /* Hacks to run dEQP GLES3 tests */
 #define ETNA_DBG_NOCACHE         0x4000000 /* Disable shader cache */
+#define ETNA_DBG_NO_SCHED        0x8000000 /* Disable NIR instruction scheduling */
 
 extern int etna_mesa_debug; /* set in etnaviv_screen.c from ETNA_MESA_DEBUG */
 
@@ -242,6 +242,16 @@ emit_zs(struct fd_ringbuffer *ring, struct pipe_surface *zsbuf,
    }
 }
 
+/* Note that the visibility stream is rebuilt for every batch, even when the
+ * same draws are rendered frame after frame. Reusing it would need a
+ * guarantee that nothing the binning pass reads changed, but the draw
+ * cmdstream only references state objects, constants and vertex/index
+ * buffers by address. Those are suballocated and get new addresses each
+ * frame, and buffers mapped unsynchronized can change without any of the
+ * cmdstream changing, so there is no cheap key that is both stable across
+ * frames and safe (and skipping the binning pass would also skip the LRZ
+ * writes that happen in it).
+ */
 static bool
 use_hw_binning(struct fd_batch *batch)
 {
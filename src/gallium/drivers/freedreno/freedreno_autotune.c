@@ -21,8 +21,12 @@
  * SOFTWARE.
  */
 
+#include "util/disk_cache.h"
+#include "util/format/u_format.h"
+
 #include "freedreno_autotune.h"
 #include "freedreno_batch.h"
+#include "freedreno_gmem.h"
 #include "freedreno_util.h"
 
 /**
@@ -43,8 +47,83 @@ struct fd_batch_history {
     */
    struct list_head results;
 #define MAX_RESULTS 5
+
+   /* Key of the history in the disk cache, derived from the parts of the
+    * batch key that are the same between processes:
+    */
+   cache_key cache_key;
+
+   /**
+    * History loaded from the disk cache, used until there are results from
+    * this process.
+    */
+   unsigned stored_results;
+   float stored_avg_samples;
 };
 
+/**
+ * What is stored in the disk cache for a render target.
+ */
+struct fd_autotune_disk_entry {
+   uint32_t num_results;
+   float avg_samples;
+};
+
+static void
+load_history(struct fd_autotune *at, struct fd_batch_history *history)
+{
+   unsigned char sha1[20];
+   fd_batch_key_stable_sha1(history->key, sha1);
+
+   char data[sizeof("freedreno_autotune") + sizeof(sha1)] = "freedreno_autotune";
+   memcpy(&data[sizeof("freedreno_autotune")], sha1, sizeof(sha1));
+   disk_cache_compute_key(at->disk_cache, data, sizeof(data),
+                          history->cache_key);
+
+   size_t size;
+   struct fd_autotune_disk_entry *entry =
+      disk_cache_get(at->disk_cache, history->cache_key, &size);
+   if (!entry)
+      return;
+
+   if (size == sizeof(*entry)) {
+      history->stored_results = MIN2(entry->num_results, MAX_RESULTS);
+      history->stored_avg_samples = entry->avg_samples;
+   }
+
+   free(entry);
+}
+
+static void
+store_history(struct fd_autotune *at, struct fd_batch_history *history)
+{
+   if (!at->disk_cache || !history->num_results)
+      return;
+
+   uint64_t total_samples = 0;
+   list_for_each_entry (struct fd_batch_result, result, &history->results,
+                        node) {
+      total_samples += result->samples_passed;
+   }
+
+   /* Blend in what was loaded, if this process didn't see enough batches to
+    * replace it.
+    */
+   unsigned stored_results =
+      MIN2(history->stored_results, MAX_RESULTS - history->num_results);
+   unsigned num_results = history->num_results + stored_results;
+
+   struct fd_autotune_disk_entry entry = {
+      .num_results = num_results,
+      .avg_samples = (total_samples +
+                      history->stored_avg_samples * stored_results) /
+                     num_results,
+   };
+
+   disk_cache_put(at->disk_cache, history->cache_key, &entry, sizeof(entry),
+                  NULL);
+}
+
 static struct fd_batch_history *
 get_history(struct fd_autotune *at, struct fd_batch *batch)
 {
@@ -69,6 +148,9 @@ get_history(struct fd_autotune *at, struct fd_batch *batch)
    list_inithead(&history->node);
    list_inithead(&history->results);
 
+   if (at->disk_cache)
+      load_history(at, history);
+
    /* Note: We cap # of cached GMEM states at 20.. so assuming double-
     * buffering, 40 should be a good place to cap cached autotune state
     */
@@ -77,6 +159,7 @@ get_history(struct fd_autotune *at, struct fd_batch *batch)
          list_last_entry(&at->lru, struct fd_batch_history, node);
       _mesa_hash_table_remove_key(at->ht, last->key);
       list_del(&last->node);
+      store_history(at, last);
       ralloc_free(last);
    }
 
@@ -166,6 +249,43 @@ fallback_use_bypass(struct fd_batch *batch)
    return true;
 }
 
+/* The cost of replaying a draw's state in one more bin, in bytes of memory
+ * traffic that it is assumed to take as long as.
+ */
+#define BIN_DRAW_COST 64
+
+/* The number of bytes of framebuffer that the GMEM path has to restore
+ * before and resolve after rendering each bin.
+ */
+static uint64_t
+gmem_restore_resolve_bytes(struct fd_batch *batch)
+{
+   struct pipe_framebuffer_state *pfb = &batch->framebuffer;
+   uint64_t pixels = (uint64_t)pfb->width * pfb->height * MAX2(pfb->samples, 1);
+   uint64_t bytes = 0;
+
+   for (unsigned i = 0; i < pfb->nr_cbufs; i++) {
+      if (!pfb->cbufs[i])
+         continue;
+
+      unsigned cpp = util_format_get_blocksize(pfb->cbufs[i]->format);
+      if (batch->restore & (PIPE_CLEAR_COLOR0 << i))
+         bytes += pixels * cpp;
+      if (batch->resolve & (PIPE_CLEAR_COLOR0 << i))
+         bytes += pixels * cpp;
+   }
+
+   if (pfb->zsbuf) {
+      unsigned cpp = util_format_get_blocksize(pfb->zsbuf->format);
+      if (batch->restore & (FD_BUFFER_DEPTH | FD_BUFFER_STENCIL))
+         bytes += pixels * cpp;
+      if (batch->resolve & (FD_BUFFER_DEPTH | FD_BUFFER_STENCIL))
+         bytes += pixels * cpp;
+   }
+
+   return bytes;
+}
+
 /**
  * A magic 8-ball that tells the gmem code whether we should do bypass mode
  * for moar fps.
@@ -207,18 +327,26 @@ fd_autotune_use_bypass(struct fd_autotune *at, struct fd_batch *batch)
    if (use_bypass)
       return true;
 
-   if (history->num_results > 0) {
-      uint32_t total_samples = 0;
+   if (history->num_results > 0 || history->stored_results > 0) {
+      uint64_t total_samples = 0;
+      float avg_samples;
 
       // TODO we should account for clears somehow
       // TODO should we try to notice if there is a drastic change from
       // frame to frame?
-      list_for_each_entry (struct fd_batch_result, result, &history->results,
-                           node) {
-         total_samples += result->samples_passed;
-      }
+      if (history->num_results > 0) {
+         list_for_each_entry (struct fd_batch_result, result,
+                              &history->results, node) {
+            total_samples += result->samples_passed;
+         }
 
-      float avg_samples = (float)total_samples / (float)history->num_results;
+         avg_samples = (float)total_samples / (float)history->num_results;
+      } else {
+         /* Nothing measured in this process yet, go with what a previous
+          * one measured for the same render target.
+          */
+         avg_samples = history->stored_avg_samples;
+      }
 
       /* Low sample count could mean there was only a clear.. or there was
        * a clear plus draws that touch no or few samples
@@ -233,21 +361,38 @@ fd_autotune_use_bypass(struct fd_autotune *at, struct fd_batch *batch)
       sample_cost /= batch->num_draws;
 
       float total_draw_cost = (avg_samples * sample_cost) / batch->num_draws;
-      DBG("%08x:%u\ttotal_samples=%u, avg_samples=%f, sample_cost=%f, "
-          "total_draw_cost=%f\n",
+      DBG("%08x:%u\ttotal_samples=%" PRIu64 ", avg_samples=%f, "
+          "sample_cost=%f, total_draw_cost=%f\n",
           batch->hash, batch->num_draws, total_samples, avg_samples,
           sample_cost, total_draw_cost);
 
       if (total_draw_cost < 3000.0f)
          return true;
+
+      /* GMEM saves the framebuffer traffic of the draws themselves, assumed
+       * to be 4 bytes per access, but it has to restore and resolve the
+       * framebuffer and replays every draw once per bin.
+       */
+      unsigned nbins = fd_gmem_estimate_nbins(batch);
+      float gmem_bytes = gmem_restore_resolve_bytes(batch) +
+                         (float)nbins * batch->num_draws * BIN_DRAW_COST;
+      float sysmem_bytes = avg_samples * sample_cost * 4.0f;
+      DBG("%08x:%u\tnbins=%u, gmem_bytes=%f, sysmem_bytes=%f\n", batch->hash,
+          batch->num_draws, nbins, gmem_bytes, sysmem_bytes);
+
+      if (gmem_bytes > sysmem_bytes)
+         return true;
    }
 
    return use_bypass;
 }
 
 void
-fd_autotune_init(struct fd_autotune *at, struct fd_device *dev)
+fd_autotune_init(struct fd_autotune *at, struct fd_device *dev,
+                 struct disk_cache *disk_cache)
 {
+   at->disk_cache = disk_cache;
+
    at->ht =
       _mesa_hash_table_create(NULL, fd_batch_key_hash, fd_batch_key_equals);
    list_inithead(&at->lru);
@@ -262,6 +407,9 @@ fd_autotune_init(struct fd_autotune *at, struct fd_device *dev)
 void
 fd_autotune_fini(struct fd_autotune *at)
 {
+   hash_table_foreach (at->ht, entry)
+      store_history(at, entry->data);
+
    _mesa_hash_table_destroy(at->ht, NULL);
    fd_bo_del(at->results_mem);
 }
@@ -29,6 +29,7 @@
 
 #include "freedreno_util.h"
 
+struct disk_cache;
 struct fd_autotune_results;
 
 /**
@@ -82,6 +83,11 @@ struct fd_autotune {
     */
    struct list_head lru;
 
+   /**
+    * Where the history is kept between processes, may be NULL
+    */
+   struct disk_cache *disk_cache;
+
    /**
     * GPU buffer used to communicate back results to the CPU
     */
@@ -168,7 +174,8 @@ struct fd_batch_result {
    uint64_t samples_passed;
 };
 
-void fd_autotune_init(struct fd_autotune *at, struct fd_device *dev);
+void fd_autotune_init(struct fd_autotune *at, struct fd_device *dev,
+                      struct disk_cache *disk_cache);
 void fd_autotune_fini(struct fd_autotune *at);
 
 struct fd_batch;
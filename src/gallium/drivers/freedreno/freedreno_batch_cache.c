@@ -26,6 +26,7 @@
 
 #include "util/hash_table.h"
 #include "util/list.h"
+#include "util/mesa-sha1.h"
 #include "util/set.h"
 #include "util/u_string.h"
 #define XXH_INLINE_ALL
@@ -118,6 +119,33 @@ fd_batch_key_equals(const void *_a, const void *_b)
           (memcmp(a->surf, b->surf, sizeof(a->surf[0]) * a->num_surfs) == 0);
 }
 
+/* Hash the parts of the key that describe the render target, but not the
+ * resources or context that are rendered to, so that the result can be used
+ * to recognize the same render target in another context or process.
+ */
+void
+fd_batch_key_stable_sha1(const struct fd_batch_key *key,
+                         unsigned char sha1[SHA1_DIGEST_LENGTH])
+{
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &key->width, sizeof(key->width));
+   _mesa_sha1_update(&ctx, &key->height, sizeof(key->height));
+   _mesa_sha1_update(&ctx, &key->layers, sizeof(key->layers));
+   _mesa_sha1_update(&ctx, &key->samples, sizeof(key->samples));
+   _mesa_sha1_update(&ctx, &key->num_surfs, sizeof(key->num_surfs));
+   for (unsigned i = 0; i < key->num_surfs; i++) {
+      _mesa_sha1_update(&ctx, &key->surf[i].u, sizeof(key->surf[i].u));
+      _mesa_sha1_update(&ctx, &key->surf[i].pos, sizeof(key->surf[i].pos));
+      _mesa_sha1_update(&ctx, &key->surf[i].samples,
+                        sizeof(key->surf[i].samples));
+      _mesa_sha1_update(&ctx, &key->surf[i].format,
+                        sizeof(key->surf[i].format));
+   }
+   _mesa_sha1_final(&ctx, sha1);
+}
+
 struct fd_batch_key *
 fd_batch_key_clone(void *mem_ctx, const struct fd_batch_key *key)
 {
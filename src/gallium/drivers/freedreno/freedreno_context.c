@@ -668,7 +668,8 @@ fd_context_init(struct fd_context *ctx, struct pipe_screen *pscreen,
                              fd_trace_read_ts,
                              fd_trace_delete_flush_data);
 
-   fd_autotune_init(&ctx->autotune, screen->dev);
+   fd_autotune_init(&ctx->autotune, screen->dev,
+                    pscreen->get_disk_shader_cache(pscreen));
 
    return pctx;
 
@@ -786,6 +786,23 @@ fd_gmem_estimate_bins_per_pipe(struct fd_batch *batch)
    return nbins;
 }
 
+/* The number of bins the batch will be rendered with if it takes the GMEM
+ * path.
+ */
+unsigned
+fd_gmem_estimate_nbins(struct fd_batch *batch)
+{
+   struct fd_screen *screen = batch->ctx->screen;
+   struct fd_gmem_stateobj *gmem = lookup_gmem_state(batch, false, false);
+   unsigned nbins = gmem->nbins_x * gmem->nbins_y;
+
+   fd_screen_lock(screen);
+   fd_gmem_reference(&gmem, NULL);
+   fd_screen_unlock(screen);
+
+   return nbins;
+}
+
 /* When deciding whether a tile needs mem2gmem, we need to take into
  * account the scissor rect(s) that were cleared.  To simplify we only
  * consider the last scissor rect for each buffer, since the common
@@ -11,4 +11,6 @@ DRI_CONF_SECTION_END
 DRI_CONF_SECTION_PERFORMANCE
    DRI_CONF_ADAPTIVE_SYNC(true)
    DRI_CONF_OPT_E(bo_reuse, 1, 0, 1, "Buffer object reuse",)
+   DRI_CONF_OPT_I(tiered_compile_draws, 0, 0, 1000000,
+                  "Compile fragment shaders without SIMD32 first, and recompile them in the background after this many draws (0 = disabled)")
 DRI_CONF_SECTION_END
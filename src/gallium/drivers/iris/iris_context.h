@@ -491,6 +491,21 @@ struct iris_compiled_shader {
    /** Variant is ready, but compilation failed. */
    bool compilation_failed;
 
+   /**
+    * Quick compile (no SIMD32) of a fragment shader, meant to be replaced
+    * by a full compile once it has been used for enough draws.
+    */
+   bool quick;
+
+   /** Number of draws using this quick variant. */
+   unsigned draw_count;
+
+   /**
+    * Full compile of a quick variant, scheduled on the compiler queue.
+    * Used instead of this variant once its \c ready fence is signalled.
+    */
+   struct iris_compiled_shader *replacement;
+
    /** Reference to the uploaded assembly. */
    struct iris_state_ref assembly;
 
@@ -2001,6 +2001,7 @@ iris_compile_fs(struct iris_screen *screen,
 
       .allow_spilling = true,
       .vue_map = vue_map,
+      .skip_simd32 = shader->quick,
 
       .log_data = dbg,
    };
@@ -2026,7 +2027,11 @@ iris_compile_fs(struct iris_screen *screen,
    iris_upload_shader(screen, ish, shader, NULL, uploader, IRIS_CACHE_FS,
                       sizeof(*key), key, program);
 
-   iris_disk_cache_store(screen->disk_cache, ish, shader, key, sizeof(*key));
+   /* Only fully optimized variants go to the disk cache, so the next run
+    * starts with them.
+    */
+   if (!shader->quick)
+      iris_disk_cache_store(screen->disk_cache, ish, shader, key, sizeof(*key));
 
    ralloc_free(mem_ctx);
 }
@@ -2061,9 +2066,17 @@ iris_update_compiled_fs(struct iris_context *ice)
 
    if (added && !iris_disk_cache_retrieve(screen, uploader, ish, shader,
                                           &key, sizeof(key))) {
+      shader->quick = screen->driconf.tiered_compile_draws > 0 &&
+                      !screen->driconf.sync_compile;
       iris_compile_fs(screen, uploader, &ice->dbg, ish, shader, last_vue_map);
    }
 
+   /* Switch to the full compile of a quick variant once it's done. */
+   struct iris_compiled_shader *replacement = shader->replacement;
+   if (replacement && util_queue_fence_is_signalled(&replacement->ready) &&
+       !replacement->compilation_failed)
+      shader = replacement;
+
    if (shader->compilation_failed)
       shader = NULL;
 
@@ -2082,6 +2095,67 @@ iris_update_compiled_fs(struct iris_context *ice)
    }
 }
 
+static void iris_compile_shader(void *_job, void *_gdata, int thread_index);
+
+static void
+iris_tier_up_job_delete(void *_job, UNUSED void *_gdata,
+                        UNUSED int thread_index)
+{
+   struct iris_threaded_compile_job *job = _job;
+
+   iris_uncompiled_shader_reference(NULL, &job->ish, NULL);
+   free(job);
+}
+
+/**
+ * Count the draws made with a quick fragment shader variant, and schedule
+ * its full compile on the compiler queue once it has proven to be hot.
+ *
+ * The quick variant owns the replacement, and keeps being found in the
+ * variant list, so every context switches over on its own once the
+ * replacement is ready.
+ */
+static void
+iris_tier_up_fs(struct iris_context *ice, struct iris_compiled_shader *shader)
+{
+   struct iris_screen *screen = (struct iris_screen *)ice->ctx.screen;
+   struct iris_compiled_shader *replacement = shader->replacement;
+
+   if (replacement) {
+      if (util_queue_fence_is_signalled(&replacement->ready) &&
+          !replacement->compilation_failed)
+         ice->state.stage_dirty |= IRIS_STAGE_DIRTY_UNCOMPILED_FS;
+      return;
+   }
+
+   /* Not atomic, several contexts drawing with the same variant may only
+    * delay the recompile a little.
+    */
+   if (++shader->draw_count < screen->driconf.tiered_compile_draws)
+      return;
+
+   replacement =
+      iris_create_shader_variant(screen, NULL, IRIS_CACHE_FS,
+                                 sizeof(shader->key.fs), &shader->key.fs);
+
+   if (p_atomic_cmpxchg(&shader->replacement, NULL, replacement) != NULL) {
+      /* Another context got there first. */
+      iris_shader_variant_reference(&replacement, NULL);
+      return;
+   }
+
+   struct iris_threaded_compile_job *job = calloc(1, sizeof(*job));
+
+   job->screen = screen;
+   job->uploader = ice->shaders.uploader_unsync;
+   job->shader = replacement;
+   iris_uncompiled_shader_reference(NULL, &job->ish,
+                                    ice->shaders.uncompiled[MESA_SHADER_FRAGMENT]);
+
+   util_queue_add_job(&screen->shader_compiler_queue, job, NULL,
+                      iris_compile_shader, iris_tier_up_job_delete, 0);
+}
+
 /**
  * Update the last enabled stage's VUE map.
  *
@@ -2157,6 +2231,11 @@ iris_update_pull_constant_descriptors(struct iris_context *ice,
 void
 iris_update_compiled_shaders(struct iris_context *ice)
 {
+   struct iris_compiled_shader *fs = ice->shaders.prog[MESA_SHADER_FRAGMENT];
+   if (unlikely(fs && fs->quick) &&
+       !(ice->state.stage_dirty & IRIS_STAGE_DIRTY_UNCOMPILED_FS))
+      iris_tier_up_fs(ice, fs);
+
    const uint64_t stage_dirty = ice->state.stage_dirty;
 
    if (stage_dirty & (IRIS_STAGE_DIRTY_UNCOMPILED_TCS |
@@ -102,6 +102,7 @@ iris_find_cached_shader(struct iris_context *ice,
 void
 iris_delete_shader_variant(struct iris_compiled_shader *shader)
 {
+   iris_shader_variant_reference(&shader->replacement, NULL);
    pipe_resource_reference(&shader->assembly.res, NULL);
    util_queue_fence_destroy(&shader->ready);
    ralloc_free(shader);
@@ -845,6 +845,8 @@ iris_screen_create(int fd, const struct pipe_screen_config *config)
       driQueryOptionb(config->options, "sync_compile");
    screen->driconf.limit_trig_input_range =
       driQueryOptionb(config->options, "limit_trig_input_range");
+   screen->driconf.tiered_compile_draws =
+      driQueryOptioni(config->options, "tiered_compile_draws");
 
    screen->precompile = env_var_as_boolean("shader_precompile", true);
 
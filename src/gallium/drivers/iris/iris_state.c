@@ -6850,6 +6850,15 @@ flush_vbos(struct iris_context *ice, struct iris_batch *batch)
    }
 }
 
+/**
+ * Identifier of a compiled shader for the draw and dispatch tracepoints.
+ */
+static uint32_t
+iris_shader_trace_id(const struct iris_compiled_shader *shader)
+{
+   return shader ? shader->key.base.program_string_id : 0;
+}
+
 static void
 iris_upload_render_state(struct iris_context *ice,
                          struct iris_batch *batch,
@@ -7074,7 +7083,9 @@ iris_upload_render_state(struct iris_context *ice,
 
    iris_batch_sync_region_end(batch);
 
-   trace_intel_end_draw(&batch->trace, batch, 0);
+   trace_intel_end_draw(&batch->trace, batch, 0,
+                        iris_shader_trace_id(ice->shaders.prog[MESA_SHADER_VERTEX]),
+                        iris_shader_trace_id(ice->shaders.prog[MESA_SHADER_FRAGMENT]));
 }
 
 static void
@@ -7160,7 +7171,9 @@ iris_upload_compute_walker(struct iris_context *ice,
       assert(brw_cs_push_const_total_size(cs_prog_data, dispatch.threads) == 0);
    }
 
-   trace_intel_end_compute(&batch->trace, batch, grid->grid[0], grid->grid[1], grid->grid[2]);
+   trace_intel_end_compute(&batch->trace, batch,
+                           grid->grid[0], grid->grid[1], grid->grid[2],
+                           iris_shader_trace_id(shader));
 }
 
 #else /* #if GFX_VERx10 >= 125 */
@@ -7312,7 +7325,9 @@ iris_upload_gpgpu_walker(struct iris_context *ice,
 
    iris_emit_cmd(batch, GENX(MEDIA_STATE_FLUSH), msf);
 
-   trace_intel_end_compute(&batch->trace, batch, grid->grid[0], grid->grid[1], grid->grid[2]);
+   trace_intel_end_compute(&batch->trace, batch,
+                           grid->grid[0], grid->grid[1], grid->grid[2],
+                           iris_shader_trace_id(shader));
 }
 
 #endif /* #if GFX_VERx10 >= 125 */
@@ -307,16 +307,18 @@ lima_fb_cbuf_needs_reload(struct lima_job *job)
 
    struct lima_surface *surf = lima_surface(job->key.cbuf);
    struct lima_resource *res = lima_resource(surf->base.texture);
-   if (res->damage.region) {
-      /* for EGL_KHR_partial_update, when EGL_EXT_buffer_age is enabled,
-       * we need to reload damage region, otherwise just want to reload
-       * the region not aligned to tile boundary */
-      //if (!res->damage.aligned)
-      //   return true;
+
+   /* For EGL_KHR_partial_update only the tiles in the damage region are
+    * rendered, so the rest of the buffer is preserved without a reload.
+    * Tiles that are only partially damaged must be restored first, but if
+    * the region is tile aligned the usual rule applies: nothing to reload
+    * when the job clears the whole buffer.
+    */
+   if (res->damage.region && !res->damage.aligned)
+      return true;
+
+   if (surf->reload & PIPE_CLEAR_COLOR0)
       return true;
-   }
-   else if (surf->reload & PIPE_CLEAR_COLOR0)
-         return true;
 
    return false;
 }
@@ -458,6 +458,21 @@ lp_build_occlusion_count(struct gallivm_state *gallivm,
                                        LLVMInt32TypeInContext(context), bits);
       count = LLVMBuildZExt(builder, count, LLVMIntTypeInContext(context, 64), "");
    }
+   else if(util_get_cpu_caps()->has_avx512f && type.length == 16) {
+      /*
+       * Turn the mask into a <16 x i1> vector, which lives in a mask
+       * register with avx512 and can be moved to a gpr with a single kmov.
+       */
+      const char *popcntintr = "llvm.ctpop.i16";
+      LLVMTypeRef i16t = LLVMInt16TypeInContext(context);
+      LLVMValueRef bits = LLVMBuildBitCast(builder, maskvalue,
+                                           lp_build_int_vec_type(gallivm, type), "");
+      bits = LLVMBuildICmp(builder, LLVMIntNE, bits,
+                           LLVMConstNull(LLVMTypeOf(bits)), "");
+      bits = LLVMBuildBitCast(builder, bits, i16t, "");
+      count = lp_build_intrinsic_unary(builder, popcntintr, i16t, bits);
+      count = LLVMBuildZExt(builder, count, LLVMIntTypeInContext(context, 64), "");
+   }
    else {
       unsigned i;
       LLVMValueRef countv = LLVMBuildAnd(builder, maskvalue, countmask, "countv");
@@ -516,6 +531,82 @@ lp_build_occlusion_count(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * Load num_rows rows of depth/stencil values starting at offset, and
+ * concatenate them into a single vector of load_type.
+ */
+static LLVMValueRef
+lp_build_depth_stencil_load_rows(struct gallivm_state *gallivm,
+                                 struct lp_type load_type,
+                                 unsigned num_rows,
+                                 LLVMValueRef depth_ptr,
+                                 LLVMValueRef offset,
+                                 LLVMValueRef depth_stride)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef rows[2];
+   struct lp_type row_type = load_type;
+   LLVMTypeRef row_vec_type;
+   unsigned i;
+
+   assert(num_rows <= ARRAY_SIZE(rows));
+   row_type.length /= num_rows;
+   row_vec_type = lp_build_vec_type(gallivm, row_type);
+
+   for (i = 0; i < num_rows; i++) {
+      LLVMValueRef ptr;
+      if (i > 0) {
+         offset = LLVMBuildAdd(builder, offset, depth_stride, "");
+      }
+      ptr = LLVMBuildGEP(builder, depth_ptr, &offset, 1, "");
+      ptr = LLVMBuildBitCast(builder, ptr, LLVMPointerType(row_vec_type, 0), "");
+      rows[i] = LLVMBuildLoad2(builder, row_vec_type, ptr, "");
+   }
+
+   if (num_rows == 1) {
+      return rows[0];
+   }
+   return lp_build_concat(gallivm, rows, row_type, num_rows);
+}
+
+
+/**
+ * Store a vector of load_type as num_rows rows of depth/stencil values
+ * starting at offset.
+ */
+static void
+lp_build_depth_stencil_store_rows(struct gallivm_state *gallivm,
+                                  struct lp_type load_type,
+                                  unsigned num_rows,
+                                  LLVMValueRef value,
+                                  LLVMValueRef depth_ptr,
+                                  LLVMValueRef offset,
+                                  LLVMValueRef depth_stride)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_type row_type = load_type;
+   LLVMTypeRef row_ptr_type;
+   unsigned i;
+
+   row_type.length /= num_rows;
+   row_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, row_type), 0);
+
+   for (i = 0; i < num_rows; i++) {
+      LLVMValueRef ptr, row = value;
+      if (i > 0) {
+         offset = LLVMBuildAdd(builder, offset, depth_stride, "");
+      }
+      if (num_rows > 1) {
+         row = lp_build_extract_range(gallivm, value, i * row_type.length,
+                                      row_type.length);
+      }
+      ptr = LLVMBuildGEP(builder, depth_ptr, &offset, 1, "");
+      ptr = LLVMBuildBitCast(builder, ptr, row_ptr_type, "");
+      LLVMBuildStore(builder, row, ptr);
+   }
+}
+
+
 /**
  * Load depth/stencil values.
  * The stored values are linear, swizzle them.
@@ -543,16 +634,14 @@ lp_build_depth_stencil_load_swizzled(struct gallivm_state *gallivm,
    LLVMBuilderRef builder = gallivm->builder;
    LLVMValueRef shuffles[LP_MAX_VECTOR_LENGTH / 4];
    LLVMValueRef zs_dst1, zs_dst2;
-   LLVMValueRef zs_dst_ptr;
    LLVMValueRef depth_offset1, depth_offset2;
-   LLVMTypeRef load_ptr_type;
    unsigned depth_bytes = format_desc->block.bits / 8;
    struct lp_type zs_type = lp_depth_type(format_desc, z_src_type.length);
    struct lp_type zs_load_type = zs_type;
+   /* 16 wide covers the whole stamp, so each half is two rows */
+   unsigned rows_per_load = z_src_type.length == 16 ? 2 : 1;
 
    zs_load_type.length = zs_load_type.length / 2;
-   LLVMTypeRef zs_dst_type = lp_build_vec_type(gallivm, zs_load_type);
-   load_ptr_type = LLVMPointerType(zs_dst_type, 0);
 
    if (z_src_type.length == 4) {
       unsigned i;
@@ -575,30 +664,34 @@ lp_build_depth_stencil_load_swizzled(struct gallivm_state *gallivm,
       unsigned i;
       LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
                                          lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
+      assert(z_src_type.length == 8 || z_src_type.length == 16);
       depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
       /*
-       * We load 2x4 values, and need to swizzle them (order
-       * 0,1,4,5,2,3,6,7) - not so hot with avx unfortunately.
+       * We load 2x4 (or 4x4) values, and need to swizzle them (order
+       * 0,1,4,5,2,3,6,7 and the same again 8 higher for the bottom
+       * quads) - not so hot with avx unfortunately.
        */
-      for (i = 0; i < 8; i++) {
-         shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
+      for (i = 0; i < z_src_type.length; i++) {
+         shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2 + (i&8));
       }
    }
 
-   depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
+   depth_offset2 = depth_offset1;
+   for (unsigned r = 0; r < rows_per_load; r++) {
+      depth_offset2 = LLVMBuildAdd(builder, depth_offset2, depth_stride, "");
+   }
 
    /* Load current z/stencil values from z/stencil buffer */
-   zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
-   zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-   zs_dst1 = LLVMBuildLoad2(builder, zs_dst_type, zs_dst_ptr, "");
+   zs_dst1 = lp_build_depth_stencil_load_rows(gallivm, zs_load_type,
+                                              rows_per_load, depth_ptr,
+                                              depth_offset1, depth_stride);
    if (is_1d) {
       zs_dst2 = lp_build_undef(gallivm, zs_load_type);
    }
    else {
-      zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
-      zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-      zs_dst2 = LLVMBuildLoad2(builder, zs_dst_type, zs_dst_ptr, "");
+      zs_dst2 = lp_build_depth_stencil_load_rows(gallivm, zs_load_type,
+                                                 rows_per_load, depth_ptr,
+                                                 depth_offset2, depth_stride);
    }
 
    *z_fb = LLVMBuildShuffleVector(builder, zs_dst1, zs_dst2,
@@ -687,16 +780,14 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
    LLVMValueRef shuffles[LP_MAX_VECTOR_LENGTH / 4];
    LLVMBuilderRef builder = gallivm->builder;
    LLVMValueRef zs_dst1, zs_dst2;
-   LLVMValueRef zs_dst_ptr1, zs_dst_ptr2;
    LLVMValueRef depth_offset1, depth_offset2;
-   LLVMTypeRef load_ptr_type;
    unsigned depth_bytes = format_desc->block.bits / 8;
    struct lp_type zs_type = lp_depth_type(format_desc, z_src_type.length);
    struct lp_type z_type = zs_type;
    struct lp_type zs_load_type = zs_type;
+   unsigned rows_per_load = z_src_type.length == 16 ? 2 : 1;
 
    zs_load_type.length = zs_load_type.length / 2;
-   load_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, zs_load_type), 0);
 
    z_type.width = z_src_type.width;
 
@@ -721,23 +812,22 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
       unsigned i;
       LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
                                          lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
+      assert(z_src_type.length == 8 || z_src_type.length == 16);
       depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
       /*
-       * We load 2x4 values, and need to swizzle them (order
-       * 0,1,4,5,2,3,6,7) - not so hot with avx unfortunately.
+       * We load 2x4 (or 4x4) values, and need to swizzle them (order
+       * 0,1,4,5,2,3,6,7 and the same again 8 higher for the bottom
+       * quads) - not so hot with avx unfortunately.
        */
-      for (i = 0; i < 8; i++) {
-         shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
+      for (i = 0; i < z_src_type.length; i++) {
+         shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2 + (i&8));
       }
    }
 
-   depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
-
-   zs_dst_ptr1 = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
-   zs_dst_ptr1 = LLVMBuildBitCast(builder, zs_dst_ptr1, load_ptr_type, "");
-   zs_dst_ptr2 = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
-   zs_dst_ptr2 = LLVMBuildBitCast(builder, zs_dst_ptr2, load_ptr_type, "");
+   depth_offset2 = depth_offset1;
+   for (unsigned r = 0; r < rows_per_load; r++) {
+      depth_offset2 = LLVMBuildAdd(builder, depth_offset2, depth_stride, "");
+   }
 
    if (format_desc->block.bits > 32) {
       s_value = LLVMBuildBitCast(builder, s_value, z_bld.vec_type, "");
@@ -763,12 +853,12 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
          zs_dst2 = lp_build_extract_range(gallivm, z_value, 2, 2);
       }
       else {
-         assert(z_src_type.length == 8);
+         assert(z_src_type.length == 8 || z_src_type.length == 16);
          zs_dst1 = LLVMBuildShuffleVector(builder, z_value, z_value,
                                           LLVMConstVector(&shuffles[0],
                                                           zs_load_type.length), "");
          zs_dst2 = LLVMBuildShuffleVector(builder, z_value, z_value,
-                                          LLVMConstVector(&shuffles[4],
+                                          LLVMConstVector(&shuffles[zs_load_type.length],
                                                           zs_load_type.length), "");
       }
    }
@@ -782,17 +872,17 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
       else {
          unsigned i;
          LLVMValueRef shuffles[LP_MAX_VECTOR_LENGTH / 2];
-         assert(z_src_type.length == 8);
-         for (i = 0; i < 8; i++) {
-            shuffles[i*2] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
-            shuffles[i*2+1] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2 +
+         assert(z_src_type.length == 8 || z_src_type.length == 16);
+         for (i = 0; i < z_src_type.length; i++) {
+            shuffles[i*2] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2 + (i&8));
+            shuffles[i*2+1] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2 + (i&8) +
                                                    z_src_type.length);
          }
          zs_dst1 = LLVMBuildShuffleVector(builder, z_value, s_value,
                                           LLVMConstVector(&shuffles[0],
                                                           z_src_type.length), "");
          zs_dst2 = LLVMBuildShuffleVector(builder, z_value, s_value,
-                                          LLVMConstVector(&shuffles[8],
+                                          LLVMConstVector(&shuffles[z_src_type.length],
                                                           z_src_type.length), "");
       }
       zs_dst1 = LLVMBuildBitCast(builder, zs_dst1,
@@ -801,9 +891,13 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
                                  lp_build_vec_type(gallivm, zs_load_type), "");
    }
 
-   LLVMBuildStore(builder, zs_dst1, zs_dst_ptr1);
+   lp_build_depth_stencil_store_rows(gallivm, zs_load_type, rows_per_load,
+                                     zs_dst1, depth_ptr, depth_offset1,
+                                     depth_stride);
    if (!is_1d) {
-      LLVMBuildStore(builder, zs_dst2, zs_dst_ptr2);
+      lp_build_depth_stencil_store_rows(gallivm, zs_load_type, rows_per_load,
+                                        zs_dst2, depth_ptr, depth_offset2,
+                                        depth_stride);
    }
 }
 
@@ -61,6 +61,11 @@ static void llvmpipe_destroy( struct pipe_context *pipe )
 
    lp_print_counters();
 
+   if (llvmpipe->async_fs_compile) {
+      util_queue_finish(&llvmpipe->fs_compile_queue);
+      util_queue_destroy(&llvmpipe->fs_compile_queue);
+   }
+
    if (llvmpipe->csctx) {
       lp_csctx_destroy(llvmpipe->csctx);
    }
@@ -245,6 +250,16 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
    if (!llvmpipe->context)
       goto fail;
 
+#ifndef USE_GLOBAL_LLVM_CONTEXT
+   /* Variants compiled off-thread get an LLVM context of their own, which
+    * isn't possible with the global one.
+    */
+   if (debug_get_bool_option("LP_ASYNC_COMPILE", FALSE) &&
+       util_queue_init(&llvmpipe->fs_compile_queue, "lpfs", 64, 1,
+                       UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL))
+      llvmpipe->async_fs_compile = TRUE;
+#endif
+
    /*
     * Create drawing context and plug our rendering stage into it.
     */
@@ -260,6 +275,10 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
 
    draw_set_constant_buffer_stride(llvmpipe->draw, lp_get_constant_buffer_stride(screen));
 
+   draw_set_vs_threads(llvmpipe->draw,
+                       debug_get_num_option("LP_VS_THREADS",
+                                            llvmpipe_screen(screen)->num_threads));
+
    /* FIXME: devise alternative to draw_texture_samplers */
 
    llvmpipe->setup = lp_setup_create( &llvmpipe->pipe,
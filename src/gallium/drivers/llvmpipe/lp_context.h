@@ -35,6 +35,7 @@
 
 #include "draw/draw_vertex.h"
 #include "util/u_blitter.h"
+#include "util/u_queue.h"
 
 #include "lp_tex_sample.h"
 #include "lp_jit.h"
@@ -182,6 +183,10 @@ struct llvmpipe_context {
    /** The LLVMContext to use for LLVM related work */
    LLVMContextRef context;
 
+   /** Compiles fragment shader variants off-thread, see LP_ASYNC_COMPILE */
+   struct util_queue fs_compile_queue;
+   boolean async_fs_compile;
+
    int max_global_buffers;
    struct pipe_resource **global_buffers;
 
@@ -28,14 +28,101 @@
  * based on threadpool.c but modified heavily to be compute shader tuned.
  */
 
+#include "util/u_atomic.h"
 #include "util/u_thread.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 #include "lp_cs_tpool.h"
+#include "lp_thread_topology.h"
+
+static inline uint64_t
+pack_range(unsigned begin, unsigned end)
+{
+   return (uint64_t)begin | (uint64_t)end << 32;
+}
+
+/**
+ * Claim the next batch of iterations from the front of our own range.
+ */
+static bool
+claim_iters(struct lp_cs_tpool_task *task, unsigned slot,
+            unsigned *start, unsigned *end)
+{
+   uint64_t *iters = &task->ranges[slot].iters;
+   uint64_t old = p_atomic_read(iters);
+
+   for (;;) {
+      unsigned begin = (uint32_t)old, range_end = old >> 32;
+
+      if (begin >= range_end)
+         return false;
+
+      unsigned count = MIN2(task->batch, range_end - begin);
+      uint64_t prev = p_atomic_cmpxchg(iters, old,
+                                       pack_range(begin + count, range_end));
+      if (prev == old) {
+         *start = begin;
+         *end = begin + count;
+         return true;
+      }
+      old = prev;
+   }
+}
+
+/**
+ * Move the back half of another thread's range into our own, empty range.
+ */
+static bool
+steal_iters(struct lp_cs_tpool_task *task, unsigned slot, unsigned num_slots)
+{
+   for (unsigned i = 1; i < num_slots; i++) {
+      unsigned victim = (slot + i) % num_slots;
+      uint64_t *iters = &task->ranges[victim].iters;
+      uint64_t old = p_atomic_read(iters);
+
+      for (;;) {
+         unsigned begin = (uint32_t)old, end = old >> 32;
+
+         if (begin >= end)
+            break;
+
+         unsigned count = DIV_ROUND_UP(end - begin, 2);
+         uint64_t prev = p_atomic_cmpxchg(iters, old,
+                                          pack_range(begin, end - count));
+         if (prev == old) {
+            /* Nobody else writes a non-empty range into ours. */
+            p_atomic_set(&task->ranges[slot].iters,
+                         pack_range(end - count, end));
+            return true;
+         }
+         old = prev;
+      }
+   }
+   return false;
+}
+
+/**
+ * Run iterations of the task until none are left to claim.
+ */
+static void
+run_task(struct lp_cs_tpool_task *task, unsigned slot, unsigned num_slots,
+         struct lp_cs_local_mem *lmem)
+{
+   do {
+      unsigned start, end;
+
+      while (claim_iters(task, slot, &start, &end)) {
+         for (unsigned i = start; i < end; i++)
+            task->work(task->data, i, lmem);
+      }
+   } while (steal_iters(task, slot, num_slots));
+}
 
 static int
 lp_cs_tpool_worker(void *data)
 {
-   struct lp_cs_tpool *pool = data;
+   struct lp_cs_tpool_worker *worker = data;
+   struct lp_cs_tpool *pool = worker->pool;
    struct lp_cs_local_mem lmem;
 
    memset(&lmem, 0, sizeof(lmem));
@@ -43,7 +130,6 @@ lp_cs_tpool_worker(void *data)
 
    while (!pool->shutdown) {
       struct lp_cs_tpool_task *task;
-      unsigned iter_per_thread;
 
       while (list_is_empty(&pool->workqueue) && !pool->shutdown)
          cnd_wait(&pool->new_work, &pool->m);
@@ -53,29 +139,18 @@ lp_cs_tpool_worker(void *data)
 
       task = list_first_entry(&pool->workqueue, struct lp_cs_tpool_task,
                               list);
-
-      unsigned this_iter = task->iter_start;
-
-      iter_per_thread = task->iter_per_thread;
-
-      if (task->iter_remainder &&
-          task->iter_start + task->iter_remainder == task->iter_total) {
-         task->iter_remainder--;
-         iter_per_thread = 1;
-      }
-
-      task->iter_start += iter_per_thread;
-
-      if (task->iter_start == task->iter_total)
-         list_del(&task->list);
-
+      task->active++;
       mtx_unlock(&pool->m);
-      for (unsigned i = 0; i < iter_per_thread; i++)
-         task->work(task->data, this_iter + i, &lmem);
+
+      run_task(task, worker->index, pool->num_threads + 1, &lmem);
 
       mtx_lock(&pool->m);
-      task->iter_finished += iter_per_thread;
-      if (task->iter_finished == task->iter_total)
+      /* Everything has been claimed, stop handing the task out. */
+      if (task->queued) {
+         list_del(&task->list);
+         task->queued = false;
+      }
+      if (--task->active == 0)
          cnd_broadcast(&task->finish);
    }
    mtx_unlock(&pool->m);
@@ -97,8 +172,18 @@ lp_cs_tpool_create(unsigned num_threads)
    list_inithead(&pool->workqueue);
    assert (num_threads <= LP_MAX_THREADS);
    pool->num_threads = num_threads;
-   for (unsigned i = 0; i < num_threads; i++)
-      pool->threads[i] = u_thread_create(lp_cs_tpool_worker, pool);
+
+   /* Compute threads follow the same placement as the rasterizer threads. */
+   const unsigned num_domains = lp_thread_num_domains(num_threads);
+   for (unsigned i = 0; i < num_threads; i++) {
+      pool->workers[i].pool = pool;
+      pool->workers[i].index = i;
+      pool->threads[i] = u_thread_create(lp_cs_tpool_worker, &pool->workers[i]);
+      if (num_domains > 1) {
+         lp_thread_pin(pool->threads[i],
+                       lp_thread_domain(i, num_threads, num_domains));
+      }
+   }
    return pool;
 }
 
@@ -127,8 +212,9 @@ lp_cs_tpool_queue_task(struct lp_cs_tpool *pool,
                        lp_cs_tpool_task_func work, void *data, int num_iters)
 {
    struct lp_cs_tpool_task *task;
+   unsigned num_slots = pool->num_threads + 1;
 
-   if (pool->num_threads == 0) {
+   if (pool->num_threads == 0 || num_iters == 1) {
       struct lp_cs_local_mem lmem;
 
       memset(&lmem, 0, sizeof(lmem));
@@ -147,16 +233,29 @@ lp_cs_tpool_queue_task(struct lp_cs_tpool *pool,
    task->data = data;
    task->iter_total = num_iters;
 
-   task->iter_per_thread = num_iters / pool->num_threads;
-   task->iter_remainder = num_iters % pool->num_threads;
+   /* Claim in batches small enough to leave something for thieves. */
+   task->batch = CLAMP(num_iters / (num_slots * 8), 1, 32);
+
+   for (unsigned i = 0; i < num_slots; i++) {
+      task->ranges[i].iters =
+         pack_range((uint64_t)num_iters * i / num_slots,
+                    (uint64_t)num_iters * (i + 1) / num_slots);
+   }
 
    cnd_init(&task->finish);
 
    mtx_lock(&pool->m);
 
    list_addtail(&task->list, &pool->workqueue);
-
-   cnd_broadcast(&pool->new_work);
+   task->queued = true;
+
+   /* The waiting thread takes a share too, only wake as many as needed. */
+   if (num_iters > pool->num_threads) {
+      cnd_broadcast(&pool->new_work);
+   } else {
+      for (unsigned i = 1; i < num_iters; i++)
+         cnd_signal(&pool->new_work);
+   }
    mtx_unlock(&pool->m);
    return task;
 }
@@ -166,12 +265,23 @@ lp_cs_tpool_wait_for_task(struct lp_cs_tpool *pool,
                           struct lp_cs_tpool_task **task_handle)
 {
    struct lp_cs_tpool_task *task = *task_handle;
+   struct lp_cs_local_mem lmem;
 
    if (!pool || !task)
       return;
 
+   /* Run iterations here rather than sleeping through the dispatch. */
+   memset(&lmem, 0, sizeof(lmem));
+   run_task(task, pool->num_threads, pool->num_threads + 1, &lmem);
+   FREE(lmem.local_mem_ptr);
+
    mtx_lock(&pool->m);
-   while (task->iter_finished < task->iter_total)
+   if (task->queued) {
+      list_del(&task->list);
+      task->queued = false;
+   }
+   /* Once all is claimed, the iterations left run on active workers. */
+   while (task->active)
       cnd_wait(&task->finish, &pool->m);
    mtx_unlock(&pool->m);
 
@@ -30,6 +30,11 @@
  * structs with just unique indexes in them.
  * It also supports a local memory support struct to be passed from
  * outside the thread exec function.
+ *
+ * The iterations of a task are split into one range per worker thread
+ * plus one for the thread waiting on the task, which runs work itself.
+ * Each thread claims batches from the front of its own range and steals
+ * half of another thread's range once its own is empty.
  */
 #ifndef LP_CS_QUEUE
 #define LP_CS_QUEUE
@@ -41,11 +46,19 @@
 
 #include "lp_limits.h"
 
+struct lp_cs_tpool;
+
+struct lp_cs_tpool_worker {
+   struct lp_cs_tpool *pool;
+   unsigned index;
+};
+
 struct lp_cs_tpool {
    mtx_t m;
    cnd_t new_work;
 
    thrd_t threads[LP_MAX_THREADS];
+   struct lp_cs_tpool_worker workers[LP_MAX_THREADS];
    unsigned num_threads;
    struct list_head workqueue;
    bool shutdown;
@@ -58,16 +71,25 @@ struct lp_cs_local_mem {
 
 typedef void (*lp_cs_tpool_task_func)(void *data, int iter_idx, struct lp_cs_local_mem *lmem);
 
+/* Iterations [begin, end) still to be claimed, packed as begin | end << 32
+ * so owner and thieves can update them with a single compare and swap.
+ * Padded to keep the ranges of different threads on different cachelines.
+ */
+struct lp_cs_tpool_range {
+   uint64_t iters;
+   uint8_t pad[56];
+};
+
 struct lp_cs_tpool_task {
    lp_cs_tpool_task_func work;
    void *data;
    struct list_head list;
    cnd_t finish;
    unsigned iter_total;
-   unsigned iter_start;
-   unsigned iter_finished;
-   unsigned iter_per_thread;
-   unsigned iter_remainder;
+   unsigned batch;
+   unsigned active;  /**< worker threads running iterations, under pool->m */
+   bool queued;
+   struct lp_cs_tpool_range ranges[LP_MAX_THREADS + 1];
 };
 
 struct lp_cs_tpool *lp_cs_tpool_create(unsigned num_threads);
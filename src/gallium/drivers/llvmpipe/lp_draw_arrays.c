@@ -39,6 +39,7 @@
 #include "lp_context.h"
 #include "lp_state.h"
 #include "lp_query.h"
+#include "lp_perf.h"
 
 #include "draw/draw_context.h"
 
@@ -146,10 +147,34 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
                                      lp->active_primgen_queries &&
                                      !lp->queries_disabled);
 
+#ifdef DEBUG
+   uint64_t vcache_indices, vcache_shaded;
+   draw_get_vertex_cache_stats(draw, &vcache_indices, &vcache_shaded);
+#endif
+
    /* draw! */
    draw_vbo(draw, info, drawid_offset, indirect, draws, num_draws,
             lp->patch_vertices);
 
+#ifdef DEBUG
+   if (info->index_size) {
+      uint64_t indices, shaded;
+      draw_get_vertex_cache_stats(draw, &indices, &shaded);
+      indices -= vcache_indices;
+      shaded -= vcache_shaded;
+
+      LP_COUNT(nr_vcache_draws);
+      LP_COUNT_ADD(nr_vcache_indices, indices);
+      LP_COUNT_ADD(nr_vcache_shaded, shaded);
+      /* A well-formed indexed triangle mesh shades about one vertex per two
+       * triangles, so in a triangle list shading more than every other
+       * index means the cache isn't catching the mesh's reuse.
+       */
+      if (info->mode == PIPE_PRIM_TRIANGLES && shaded * 2 > indices)
+         LP_COUNT(nr_vcache_poor_draws);
+   }
+#endif
+
    /*
     * unmap vertex/index buffers
     */
@@ -66,7 +66,13 @@
 
 #define LP_MAX_SAMPLES 4
 
-#define LP_MAX_THREADS 16
+#define LP_MAX_THREADS 128
+
+/**
+ * Max number of threads used by default, more can be requested with
+ * LP_NUM_THREADS.
+ */
+#define LP_DEFAULT_MAX_THREADS 16
 
 
 /**
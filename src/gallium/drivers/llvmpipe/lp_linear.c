@@ -183,17 +183,16 @@ lp_fs_linear_run(const struct lp_rast_state *state,
    for (i = 0; i < nr_tex; i++) {
       const struct lp_tgsi_texture_info *tex_info = &info->tex[i];
       unsigned unit = tex_info->sampler_unit;
-
-      /* XXX: some texture coordinates are linear!
-       */
-      //boolean perspective = (info->base.input_interpolate[i] ==
-      //                       TGSI_INTERPOLATE_PERSPECTIVE);
+      boolean perspective =
+            info->base.input_interpolate[tex_info->coord[0].u.index] ==
+            TGSI_INTERPOLATE_PERSPECTIVE;
 
       if (!lp_linear_init_sampler(&samp[i],
                                   tex_info,
                                   lp_fs_variant_key_sampler_idx(&variant->key, unit),
                                   &state->jit_context.textures[unit],
                                   x, y, width, height,
+                                  perspective,
                                   a0, dadx, dady)) {
          if (LP_DEBUG & DEBUG_LINEAR2)
             debug_printf("  -- init_sampler(%d) failed\n", i);
@@ -323,12 +322,19 @@ lp_linear_check_variant(struct lp_fragment_shader_variant *variant)
       const struct lp_tgsi_texture_info *tex_info = &info->tex[i];
       unsigned unit = tex_info->sampler_unit;
 
-      /* XXX: Relax this once setup premultiplies by oow:
+      /* Blit shaders typically use linear texcoords, which the sampler
+       * handles as w is constant across linear rectangles anyway.
        */
-      if (info->base.input_interpolate[unit] != TGSI_INTERPOLATE_PERSPECTIVE) {
-         if (LP_DEBUG & DEBUG_LINEAR)
-            debug_printf(" -- samp[%d]: texcoord not perspective\n", i);
-         goto fail;
+      if (tex_info->coord[0].file == TGSI_FILE_INPUT) {
+         unsigned interp =
+            info->base.input_interpolate[tex_info->coord[0].u.index];
+
+         if (interp != TGSI_INTERPOLATE_PERSPECTIVE &&
+             interp != TGSI_INTERPOLATE_LINEAR) {
+            if (LP_DEBUG & DEBUG_LINEAR)
+               debug_printf(" -- samp[%d]: texcoord not interpolated\n", i);
+            goto fail;
+         }
       }
 
       struct lp_sampler_static_state *samp = lp_fs_variant_key_sampler_idx(key, unit);
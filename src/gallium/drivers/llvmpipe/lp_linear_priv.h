@@ -142,6 +142,7 @@ lp_linear_init_sampler(struct lp_linear_sampler *samp,
                        const struct lp_sampler_static_state *sampler_state,
                        const struct lp_jit_texture *texture,
                        int x0, int y0, int width, int height,
+                       boolean perspective,
                        const float (*a0)[4],
                        const float (*dadx)[4],
                        const float (*dady)[4]);
@@ -672,6 +672,118 @@ fetch_bgrx_linear(struct lp_linear_elem *elem)
 }
 
 
+/*
+ * Expand a b5g6r5 texel to bgrx8888, replicating the top bits.
+ */
+static inline uint32_t
+b5g6r5_to_bgrx(uint16_t texel)
+{
+   uint32_t b = texel & 0x1f;
+   uint32_t g = (texel >> 5) & 0x3f;
+   uint32_t r = texel >> 11;
+
+   b = (b << 3) | (b >> 2);
+   g = (g << 2) | (g >> 4);
+   r = (r << 3) | (r >> 2);
+
+   return 0xff000000 | (r << 16) | (g << 8) | b;
+}
+
+static inline uint32_t
+fetch_b5g6r5_texel(const struct lp_jit_texture *texture, int s, int t)
+{
+   const uint8_t *src = texture->base;
+   const int cs = CLAMP(s, 0, (int)texture->width - 1);
+   const int ct = CLAMP(t, 0, (int)texture->height - 1);
+
+   return b5g6r5_to_bgrx(*(const uint16_t *)(src +
+                                             ct * texture->row_stride[0] +
+                                             cs * 2));
+}
+
+/* Nearest filtered b5g6r5 lookup, any orientation, clamped.  Compositors
+ * mostly hit this for 1:1 copies, so the texel conversion dominates and
+ * there is little to gain from the specialized bgra variants.
+ */
+static const uint32_t *
+fetch_b5g6r5_clamp(struct lp_linear_elem *elem)
+{
+   struct lp_linear_sampler *samp = (struct lp_linear_sampler *)elem;
+   const struct lp_jit_texture *texture = samp->texture;
+   const int dsdx  = samp->dsdx;
+   const int dtdx  = samp->dtdx;
+   const int width = samp->width;
+   uint32_t *row   = samp->row;
+   int s = samp->s;
+   int t = samp->t;
+   int i;
+
+   for (i = 0; i < width; i++) {
+      row[i] = fetch_b5g6r5_texel(texture,
+                                  s >> FIXED16_SHIFT, t >> FIXED16_SHIFT);
+      s += dsdx;
+      t += dtdx;
+   }
+
+   samp->s += samp->dsdy;
+   samp->t += samp->dtdy;
+   return row;
+}
+
+/* Linear filtered b5g6r5 lookup, any orientation, clamped.  Texels are
+ * expanded to bgrx8888 and then filtered like fetch_bgra_linear().
+ */
+static const uint32_t *
+fetch_b5g6r5_clamp_linear(struct lp_linear_elem *elem)
+{
+   struct lp_linear_sampler *samp = (struct lp_linear_sampler *)elem;
+   const struct lp_jit_texture *texture = samp->texture;
+   const int dsdx  = samp->dsdx;
+   const int dtdx  = samp->dtdx;
+   const int width = samp->width;
+   uint32_t *row   = samp->row;
+   int s = samp->s;
+   int t = samp->t;
+   int i, j;
+
+   for (i = 0; i < width; i += 4) {
+      union m128i si0, si1, si2, si3, ws, wt;
+      __m128i si02, si13;
+
+      for (j = 0; j < 4; j++) {
+         const int s0 = s >> FIXED16_SHIFT;
+         const int t0 = t >> FIXED16_SHIFT;
+
+         si0.ui[j] = fetch_b5g6r5_texel(texture, s0,     t0);
+         si1.ui[j] = fetch_b5g6r5_texel(texture, s0 + 1, t0);
+         si2.ui[j] = fetch_b5g6r5_texel(texture, s0,     t0 + 1);
+         si3.ui[j] = fetch_b5g6r5_texel(texture, s0 + 1, t0 + 1);
+
+         ws.ui[j] = (s>>8) & 0xff;
+         wt.ui[j] = (t>>8) & 0xff;
+
+         s += dsdx;
+         t += dtdx;
+      }
+
+      ws.m = _mm_or_si128(ws.m, _mm_slli_epi32(ws.m, 16));
+      ws.m = _mm_or_si128(ws.m, _mm_slli_epi32(ws.m, 8));
+
+      wt.m = _mm_or_si128(wt.m, _mm_slli_epi32(wt.m, 16));
+      wt.m = _mm_or_si128(wt.m, _mm_slli_epi32(wt.m, 8));
+
+      si02 = util_sse2_lerp_epi8_fixed08(si0.m, si2.m, wt.m);
+      si13 = util_sse2_lerp_epi8_fixed08(si1.m, si3.m, wt.m);
+
+      *(__m128i *)&row[i] = util_sse2_lerp_epi8_fixed08(si02, si13, ws.m);
+   }
+
+   samp->s += samp->dsdy;
+   samp->t += samp->dtdy;
+   return row;
+}
+
+
 static boolean
 sampler_is_nearest(const struct lp_linear_sampler *samp,
                    const struct lp_sampler_static_state *sampler_state,
@@ -740,6 +852,7 @@ lp_linear_init_sampler(struct lp_linear_sampler *samp,
                        const struct lp_sampler_static_state *sampler_state,
                        const struct lp_jit_texture *texture,
                        int x0, int y0, int width, int height,
+                       boolean perspective,
                        const float (*a0)[4],
                        const float (*dadx)[4],
                        const float (*dady)[4])
@@ -758,7 +871,8 @@ lp_linear_init_sampler(struct lp_linear_sampler *samp,
    float dtdy = dady[tchan->u.index+1][tchan->swizzle];
 
    int mins, mint, maxs, maxt;
-   float oow = 1.0f / w0;
+   /* Setup only divides perspective inputs by w, and w is constant here. */
+   float oow = perspective ? 1.0f / w0 : 1.0f;
    float width_oow = texture->width * oow;
    float height_oow = texture->height * oow;
    float fdsdx = dsdx * width_oow;
@@ -910,6 +1024,10 @@ lp_linear_init_sampler(struct lp_linear_sampler *samp,
 
          return TRUE;
 
+      case PIPE_FORMAT_B5G6R5_UNORM:
+         samp->base.fetch = fetch_b5g6r5_clamp;
+         return TRUE;
+
       default:
          break;
       }
@@ -941,6 +1059,10 @@ lp_linear_init_sampler(struct lp_linear_sampler *samp,
             samp->base.fetch = fetch_bgrx_axis_aligned_linear;
          return TRUE;
 
+      case PIPE_FORMAT_B5G6R5_UNORM:
+         samp->base.fetch = fetch_b5g6r5_clamp_linear;
+         return TRUE;
+
       default:
          break;
       }
@@ -993,7 +1115,8 @@ lp_linear_check_sampler(const struct lp_sampler_static_state *sampler,
    /* These are the only texture formats we support at the moment
     */
    if (sampler->texture_state.format != PIPE_FORMAT_B8G8R8A8_UNORM &&
-       sampler->texture_state.format != PIPE_FORMAT_B8G8R8X8_UNORM)
+       sampler->texture_state.format != PIPE_FORMAT_B8G8R8X8_UNORM &&
+       sampler->texture_state.format != PIPE_FORMAT_B5G6R5_UNORM)
       return FALSE;
 
    return TRUE;
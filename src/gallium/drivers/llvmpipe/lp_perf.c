@@ -25,6 +25,8 @@
  *
  **************************************************************************/
 
+#include <inttypes.h>
+
 #include "util/u_debug.h"
 #include "lp_debug.h"
 #include "lp_perf.h"
@@ -114,10 +116,30 @@ lp_print_counters(void)
       debug_printf("llvmpipe:   nr_rect_part_4x4:           %9u (%3.0f%% of %u)\n", lp_count.nr_rect_partially_covered_4, p2, total_4);
 
 
+      debug_printf("llvmpipe: nr_draws_linear_blit:         %9u\n", lp_count.nr_draws_linear_blit);
+      debug_printf("llvmpipe: nr_draws_linear:              %9u\n", lp_count.nr_draws_linear);
+      debug_printf("llvmpipe: nr_draws_tri:                 %9u\n", lp_count.nr_draws_tri);
+      debug_printf("llvmpipe: nr_linear_blit:               %9u\n", lp_count.nr_linear_blit);
+      debug_printf("llvmpipe: nr_linear_shade:              %9u\n", lp_count.nr_linear_shade);
+      debug_printf("llvmpipe: nr_linear_fallback:           %9u\n", lp_count.nr_linear_fallback);
+
+      debug_printf("llvmpipe: nr_vcache_draws:              %9u\n", lp_count.nr_vcache_draws);
+      debug_printf("llvmpipe:   nr_vcache_poor_draws:       %9u\n", lp_count.nr_vcache_poor_draws);
+      debug_printf("llvmpipe:   nr_vcache_indices:          %9" PRIu64 "\n", lp_count.nr_vcache_indices);
+      debug_printf("llvmpipe:   nr_vcache_shaded:           %9" PRIu64 " (%.2f per index)\n",
+                   lp_count.nr_vcache_shaded,
+                   lp_count.nr_vcache_indices ?
+                   (double) lp_count.nr_vcache_shaded / lp_count.nr_vcache_indices : 0.0);
+
       debug_printf("llvmpipe: nr_color_tile_clear:          %9u\n", lp_count.nr_color_tile_clear);
       debug_printf("llvmpipe: nr_color_tile_load:           %9u\n", lp_count.nr_color_tile_load);
       debug_printf("llvmpipe: nr_color_tile_store:          %9u\n", lp_count.nr_color_tile_store);
 
+      debug_printf("llvmpipe: total setup/binning time:     %.2f sec\n", lp_count.setup_time / 1000000.0);
+      debug_printf("llvmpipe: nr_scene_stalls:              %9u\n", lp_count.nr_scene_stalls);
+      debug_printf("llvmpipe: total scene stall time:       %.2f sec\n", lp_count.scene_stall_time / 1000000.0);
+      debug_printf("llvmpipe: nr_scene_full_flushes:        %9u\n", lp_count.nr_scene_full_flushes);
+
       debug_printf("llvmpipe: nr_llvm_compiles:             %u\n", lp_count.nr_llvm_compiles);
       debug_printf("llvmpipe: total LLVM compile time:      %.2f sec\n", lp_count.llvm_compile_time / 1000000.0);
       debug_printf("llvmpipe: average LLVM compile time:    %.2f sec\n", lp_count.llvm_compile_time / 1000000.0 / lp_count.nr_llvm_compiles);
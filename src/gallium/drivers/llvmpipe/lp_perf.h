@@ -65,9 +65,27 @@ struct lp_counters
    unsigned nr_llvm_compiles;
    int64_t llvm_compile_time;  /**< total, in microseconds */
 
+   unsigned nr_draws_linear_blit;   /**< linear rasterizer, blit shader */
+   unsigned nr_draws_linear;        /**< linear rasterizer, linear shader */
+   unsigned nr_draws_tri;           /**< full JIT fragment shader path */
+   unsigned nr_linear_blit;         /**< linear tiles/rects done by blit */
+   unsigned nr_linear_shade;        /**< ... by the linear shader */
+   unsigned nr_linear_fallback;     /**< ... by the JIT shader fallback */
+
+   unsigned nr_vcache_draws;        /**< indexed draws */
+   unsigned nr_vcache_poor_draws;   /**< ... shading most of their indices */
+   uint64_t nr_vcache_indices;      /**< indices of indexed draws */
+   uint64_t nr_vcache_shaded;       /**< vertices shaded for them */
+
    unsigned nr_color_tile_clear;
    unsigned nr_color_tile_load;
    unsigned nr_color_tile_store;
+
+   int64_t setup_time;              /**< binning on the context thread, in microseconds */
+
+   unsigned nr_scene_stalls;        /**< setup waited for a free scene */
+   int64_t scene_stall_time;        /**< total, in microseconds */
+   unsigned nr_scene_full_flushes;  /**< scene ran out of memory mid-frame */
 };
 
 
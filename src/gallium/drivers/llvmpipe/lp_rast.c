@@ -48,6 +48,7 @@
 #include "gallivm/lp_bld_debug.h"
 #include "lp_scene.h"
 #include "lp_tex_sample.h"
+#include "lp_thread_topology.h"
 
 
 #ifdef DEBUG
@@ -74,7 +75,7 @@ lp_rast_begin( struct lp_rasterizer *rast,
    LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
    lp_scene_begin_rasterization( scene );
-   lp_scene_bin_iter_begin( scene );
+   lp_scene_bin_iter_begin( scene, rast->num_domains );
 }
 
 
@@ -1089,7 +1090,7 @@ rasterize_scene(struct lp_rasterizer_task *task,
          int i, j;
 
          assert(scene);
-         while ((bin = lp_scene_bin_iter_next(scene, &i, &j))) {
+         while ((bin = lp_scene_bin_iter_next(scene, task->domain, &i, &j))) {
             if (!is_empty_bin( bin ))
                rasterize_bin(task, bin, i, j);
          }
@@ -1277,6 +1278,8 @@ create_rast_threads(struct lp_rasterizer *rast)
          rast->num_threads = i; /* previous thread is max */
          break;
       }
+      if (rast->num_domains > 1)
+         lp_thread_pin(rast->threads[i], rast->tasks[i].domain);
    }
 }
 
@@ -1303,10 +1306,13 @@ lp_rast_create( unsigned num_threads )
       goto no_full_scenes;
    }
 
+   rast->num_domains = lp_thread_num_domains(num_threads);
+
    for (i = 0; i < MAX2(1, num_threads); i++) {
       struct lp_rasterizer_task *task = &rast->tasks[i];
       task->rast = rast;
       task->thread_index = i;
+      task->domain = lp_thread_domain(i, num_threads, rast->num_domains);
       task->thread_data.cache = align_malloc(sizeof(struct lp_build_format_cache),
                                              16);
       if (!task->thread_data.cache) {
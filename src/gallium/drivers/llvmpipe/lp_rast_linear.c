@@ -96,8 +96,10 @@ lp_rast_linear_tile(struct lp_rasterizer_task *task,
                                    (const float (*)[4])GET_DADX(inputs),
                                    (const float (*)[4])GET_DADY(inputs),
                                    scene->cbufs[0].map,
-                                   scene->cbufs[0].stride))
+                                   scene->cbufs[0].stride)) {
+         LP_COUNT(nr_linear_blit);
          return;
+      }
    }
 
 
@@ -111,8 +113,10 @@ lp_rast_linear_tile(struct lp_rasterizer_task *task,
                               (const float (*)[4])GET_DADX(inputs),
                               (const float (*)[4])GET_DADY(inputs),
                               scene->cbufs[0].map,
-                              scene->cbufs[0].stride))
+                              scene->cbufs[0].stride)) {
+         LP_COUNT(nr_linear_shade);
          return;
+      }
    }
 
    {
@@ -121,6 +125,7 @@ lp_rast_linear_tile(struct lp_rasterizer_task *task,
       box.x1 = task->x + task->width - 1;
       box.y0 = task->y;
       box.y1 = task->y + task->height - 1;
+      LP_COUNT(nr_linear_fallback);
       lp_rast_linear_rect_fallback(task, inputs, &box);
    }
 }
@@ -168,8 +173,10 @@ lp_rast_linear_rect(struct lp_rasterizer_task *task,
                                    (const float (*)[4])GET_DADX(inputs),
                                    (const float (*)[4])GET_DADY(inputs),
                                    scene->cbufs[0].map,
-                                   scene->cbufs[0].stride))
+                                   scene->cbufs[0].stride)) {
+         LP_COUNT(nr_linear_blit);
          return;
+      }
    }
 
    if (variant->jit_linear)
@@ -181,10 +188,13 @@ lp_rast_linear_rect(struct lp_rasterizer_task *task,
                               (const float (*)[4])GET_DADX(inputs),
                               (const float (*)[4])GET_DADY(inputs),
                               scene->cbufs[0].map,
-                              scene->cbufs[0].stride))
+                              scene->cbufs[0].stride)) {
+         LP_COUNT(nr_linear_shade);
          return;
+      }
    }
 
+   LP_COUNT(nr_linear_fallback);
    lp_rast_linear_rect_fallback(task, inputs, &box);
 }
 
@@ -97,6 +97,9 @@ struct lp_rasterizer_task
    /** "my" index */
    unsigned thread_index;
 
+   /** Locality domain of the thread, see lp_thread_topology.h */
+   unsigned domain;
+
    /** Non-interpolated passthru state and occlude counter for visible pixels */
    struct lp_jit_thread_data thread_data;
 
@@ -127,6 +130,9 @@ struct lp_rasterizer
    unsigned num_threads;
    thrd_t threads[LP_MAX_THREADS];
 
+   /** Number of locality domains the threads are split into */
+   unsigned num_domains;
+
    /** For synchronizing the rasterization threads */
    util_barrier barrier;
 };
@@ -25,6 +25,7 @@
  *
  **************************************************************************/
 
+#include "util/u_atomic.h"
 #include "util/u_framebuffer.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
@@ -71,8 +72,8 @@ lp_scene_create( struct lp_setup_context *setup )
    scene->pipe = setup->pipe;
    scene->setup = setup;
    scene->data.head = &scene->data.first;
+   scene->max_size = LP_SCENE_MIN_SIZE;
 
-   (void) mtx_init(&scene->mutex, mtx_plain);
 
 #ifdef DEBUG
    /* Do some scene limit sanity checks here */
@@ -81,11 +82,11 @@ lp_scene_create( struct lp_setup_context *setup )
       size_t maxCommandBytes = sizeof(struct cmd_block) * maxBins;
       size_t maxCommandPlusData = maxCommandBytes + DATA_BLOCK_SIZE;
       /* We'll need at least one command block per bin.  Make sure that's
-       * less than the max allowed scene size.
+       * less than the smallest allowed scene size.
        */
-      assert(maxCommandBytes < LP_SCENE_MAX_SIZE);
+      assert(maxCommandBytes < LP_SCENE_MIN_SIZE);
       /* We'll also need space for at least one other data block */
-      assert(maxCommandPlusData <= LP_SCENE_MAX_SIZE);
+      assert(maxCommandPlusData <= LP_SCENE_MIN_SIZE);
    }
 #endif
 
@@ -100,7 +101,6 @@ void
 lp_scene_destroy(struct lp_scene *scene)
 {
    lp_scene_end_rasterization(scene);
-   mtx_destroy(&scene->mutex);
    assert(scene->data.head == &scene->data.first);
    slab_free_st(&scene->setup->scene_slab, scene);
 }
@@ -147,6 +147,7 @@ lp_scene_bin_reset(struct lp_scene *scene, unsigned x, unsigned y)
    struct cmd_bin *bin = lp_scene_get_bin(scene, x, y);
 
    bin->last_state = NULL;
+   bin->cost = 0;
    bin->head = bin->tail;
    if (bin->tail) {
       bin->tail->next = NULL;
@@ -201,6 +202,12 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
 
    //LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
+   /* Wait for any shader variant still being compiled off-thread. */
+   for (struct shader_ref *ref = scene->frag_shaders; ref; ref = ref->next) {
+      for (i = 0; i < ref->count; i++)
+         util_queue_fence_wait(&ref->variant[i]->ready);
+   }
+
    for (i = 0; i < scene->fb.nr_cbufs; i++) {
       struct pipe_surface *cbuf = scene->fb.cbufs[i];
       init_scene_texture(&scene->cbufs[i], cbuf);
@@ -365,7 +372,7 @@ lp_scene_new_cmd_block( struct lp_scene *scene,
 struct data_block *
 lp_scene_new_data_block( struct lp_scene *scene )
 {
-   if (scene->scene_size + DATA_BLOCK_SIZE > LP_SCENE_MAX_SIZE) {
+   if (scene->scene_size + DATA_BLOCK_SIZE > scene->max_size) {
       if (0) debug_printf("%s: failed\n", __FUNCTION__);
       scene->alloc_failed = TRUE;
       return NULL;
@@ -546,61 +553,96 @@ lp_scene_is_resource_referenced(const struct lp_scene *scene,
 
 
 
-/** advance curr_x,y to the next bin */
-static boolean
-next_bin(struct lp_scene *scene)
+/**
+ * Fill bin_order[start..] with the non-empty bins among indices
+ * [start, end), sorted by decreasing cost.  The cost is bucketed by its
+ * log2, which is all the precision the estimate has, so this is a linear
+ * counting sort.  Returns the number of bins written.
+ */
+static unsigned
+sort_bins_by_cost(struct lp_scene *scene, unsigned start, unsigned end)
 {
-   scene->curr_x++;
-   if (scene->curr_x >= scene->tiles_x) {
-      scene->curr_x = 0;
-      scene->curr_y++;
+   unsigned buckets[33] = {0};
+
+   for (unsigned index = start; index < end; index++) {
+      const struct cmd_bin *bin =
+         lp_scene_get_bin(scene, index % scene->tiles_x,
+                          index / scene->tiles_x);
+      if (bin->head)
+         buckets[bin->cost ? util_logbase2(bin->cost) + 1 : 0]++;
    }
-   if (scene->curr_y >= scene->tiles_y) {
-      /* no more bins */
-      return FALSE;
+
+   /* Turn the counts into output offsets, most expensive bucket first. */
+   unsigned count = 0;
+   for (int b = ARRAY_SIZE(buckets) - 1; b >= 0; b--) {
+      unsigned n = buckets[b];
+      buckets[b] = start + count;
+      count += n;
    }
-   return TRUE;
+
+   for (unsigned index = start; index < end; index++) {
+      const struct cmd_bin *bin =
+         lp_scene_get_bin(scene, index % scene->tiles_x,
+                          index / scene->tiles_x);
+      if (bin->head) {
+         unsigned b = bin->cost ? util_logbase2(bin->cost) + 1 : 0;
+         scene->bin_order[buckets[b]++] = index;
+      }
+   }
+
+   return count;
 }
 
 
 void
-lp_scene_bin_iter_begin( struct lp_scene *scene )
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_domains )
 {
-   scene->curr_x = scene->curr_y = -1;
+   const unsigned num_bins = scene->tiles_x * scene->tiles_y;
+
+   assert(num_domains >= 1 && num_domains <= ARRAY_SIZE(scene->bin_iter));
+   scene->num_bin_domains = num_domains;
+
+   for (unsigned i = 0; i < num_domains; i++) {
+      const unsigned start = i * num_bins / num_domains;
+      const unsigned end = (i + 1) * num_bins / num_domains;
+
+      scene->bin_iter[i].next = start;
+      scene->bin_iter[i].end = start + sort_bins_by_cost(scene, start, end);
+   }
 }
 
 
 /**
  * Return pointer to next bin to be rendered.
- * The lp_scene::curr_x and ::curr_y fields will be advanced.
  * Multiple rendering threads will call this function to get a chunk
- * of work (a bin) to work on.
+ * of work (a bin) to work on.  Bins of the thread's own domain are handed
+ * out first, then the remaining bins of the other domains.  Empty bins are
+ * never returned.
  */
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene , int *x, int *y)
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned domain,
+                        int *x, int *y )
 {
-   struct cmd_bin *bin = NULL;
+   const unsigned num_domains = scene->num_bin_domains;
 
-   mtx_lock(&scene->mutex);
+   for (unsigned i = 0; i < num_domains; i++) {
+      unsigned d = (domain + i) % num_domains;
 
-   if (scene->curr_x < 0) {
-      /* first bin */
-      scene->curr_x = 0;
-      scene->curr_y = 0;
-   }
-   else if (!next_bin(scene)) {
-      /* no more bins left */
-      goto end;
-   }
+      /* Cheap check first, so drained domains aren't hammered with atomics. */
+      if (p_atomic_read(&scene->bin_iter[d].next) >= scene->bin_iter[d].end)
+         continue;
 
-   bin = lp_scene_get_bin(scene, scene->curr_x, scene->curr_y);
-   *x = scene->curr_x;
-   *y = scene->curr_y;
+      unsigned index = p_atomic_inc_return(&scene->bin_iter[d].next) - 1;
+      if (index >= scene->bin_iter[d].end)
+         continue;
 
-end:
-   /*printf("return bin %p at %d, %d\n", (void *) bin, *bin_x, *bin_y);*/
-   mtx_unlock(&scene->mutex);
-   return bin;
+      index = scene->bin_order[index];
+      *x = index % scene->tiles_x;
+      *y = index / scene->tiles_x;
+      return lp_scene_get_bin(scene, *x, *y);
+   }
+
+   return NULL;
 }
 
 
@@ -619,6 +661,20 @@ void lp_scene_begin_binning(struct lp_scene *scene,
    assert(scene->tiles_x <= TILES_X);
    assert(scene->tiles_y <= TILES_Y);
 
+   /*
+    * Budget the scene's temporary storage from the number of bins, which
+    * bounds how much binning a frame needs, and from the number of threads
+    * that have to be kept fed.  Small framebuffers keep the old fixed
+    * limit, very large ones with many threads are allowed to bin more
+    * before a flush is forced.
+    */
+   {
+      const uint64_t size =
+         (uint64_t)scene->tiles_x * scene->tiles_y * LP_SCENE_BIN_SIZE +
+         (uint64_t)MAX2(1, scene->setup->num_threads) * LP_SCENE_THREAD_SIZE;
+      scene->max_size = CLAMP(size, LP_SCENE_MIN_SIZE, LP_SCENE_MAX_SIZE);
+   }
+
    /*
     * Determine how many layers the fb has (used for clamping layer value).
     * OpenGL (but not d3d10) permits different amount of layers per rt, however
@@ -656,8 +712,8 @@ void lp_scene_end_binning( struct lp_scene *scene )
 {
    if (LP_DEBUG & DEBUG_SCENE) {
       debug_printf("rasterize scene:\n");
-      debug_printf("  scene_size: %u\n",
-                   scene->scene_size);
+      debug_printf("  scene_size: %u / %u\n",
+                   scene->scene_size, scene->max_size);
       debug_printf("  data size: %u\n",
                    lp_scene_data_size(scene));
 
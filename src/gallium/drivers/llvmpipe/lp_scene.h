@@ -59,9 +59,17 @@ struct lp_rast_state;
  */
 #define DATA_BLOCK_SIZE (64 * 1024)
 
-/* Scene temporary storage is clamped to this size:
+/* Scene temporary storage is clamped to a per-scene budget derived from
+ * the number of bins and rasterizer threads (see lp_scene_begin_binning),
+ * which always lies within these limits:
  */
-#define LP_SCENE_MAX_SIZE (36*1024*1024)
+#define LP_SCENE_MIN_SIZE (36*1024*1024)
+#define LP_SCENE_MAX_SIZE (256*1024*1024)
+
+/* Budget contributions per bin and per rasterizer thread:
+ */
+#define LP_SCENE_BIN_SIZE (8*1024)
+#define LP_SCENE_THREAD_SIZE (1024*1024)
 
 /* The maximum amount of texture storage referenced by a scene is
  * clamped to this size:
@@ -98,6 +106,7 @@ struct cmd_bin {
    const struct lp_rast_state *last_state;       /* most recent state set in bin */
    struct cmd_block *head;
    struct cmd_block *tail;
+   unsigned cost;                                /* estimated raster cost */
 };
    
 
@@ -180,6 +189,9 @@ struct lp_scene {
     */
    unsigned scene_size;
 
+   /** Limit for scene_size, set up in lp_scene_begin_binning() */
+   unsigned max_size;
+
    /** Sum of sizes of all resources referenced by the scene.  Sums
     * all the textures read by the scene:
     */
@@ -194,8 +206,18 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
-   int curr_x, curr_y;  /**< for iterating over bins */
-   mtx_t mutex;
+   /**
+    * For iterating over bins.  Bins are split into one contiguous range of
+    * bin indices (row-major) per locality domain of the rasterizer threads.
+    * Within each range, bin_order lists the non-empty bins by decreasing
+    * estimated cost so that the expensive tiles are started first and the
+    * cheap ones fill in the gaps at the end of the scene.
+    */
+   struct {
+      unsigned next, end;
+   } bin_iter[LP_MAX_THREADS];
+   unsigned num_bin_domains;
+   uint16_t bin_order[TILES_X * TILES_Y];
 
    struct cmd_bin tile[TILES_X][TILES_Y];
    struct data_block_list data;
@@ -245,7 +267,7 @@ lp_scene_alloc( struct lp_scene *scene, unsigned size)
    if (LP_DEBUG & DEBUG_MEM)
       debug_printf("alloc %u block %u/%u tot %u/%u\n",
 		   size, block->used, (unsigned)DATA_BLOCK_SIZE,
-		   scene->scene_size, LP_SCENE_MAX_SIZE);
+		   scene->scene_size, scene->max_size);
 
    if (block->used + size > DATA_BLOCK_SIZE) {
       block = lp_scene_new_data_block( scene );
@@ -279,7 +301,7 @@ lp_scene_alloc_aligned( struct lp_scene *scene, unsigned size,
       debug_printf("alloc %u block %u/%u tot %u/%u\n",
 		   size + alignment - 1,
 		   block->used, (unsigned)DATA_BLOCK_SIZE,
-		   scene->scene_size, LP_SCENE_MAX_SIZE);
+		   scene->scene_size, scene->max_size);
        
    if (block->used + size + alignment - 1 > DATA_BLOCK_SIZE) {
       block = lp_scene_new_data_block( scene );
@@ -309,6 +331,32 @@ void
 lp_scene_bin_reset(struct lp_scene *scene, unsigned x, unsigned y);
 
 
+/**
+ * Rough estimate of the cost of rasterizing a command, used to order the
+ * bins.  Full tile shading is the most expensive thing a bin can contain,
+ * partial tile triangles come next, everything else is close to free.
+ */
+static inline unsigned
+lp_scene_cmd_cost(unsigned cmd)
+{
+   switch (cmd) {
+   case LP_RAST_OP_SHADE_TILE:
+   case LP_RAST_OP_SHADE_TILE_OPAQUE:
+   case LP_RAST_OP_BLIT:
+      return 16;
+   case LP_RAST_OP_CLEAR_COLOR:
+   case LP_RAST_OP_CLEAR_ZSTENCIL:
+      return 2;
+   case LP_RAST_OP_SET_STATE:
+   case LP_RAST_OP_BEGIN_QUERY:
+   case LP_RAST_OP_END_QUERY:
+      return 0;
+   default:
+      return 4;
+   }
+}
+
+
 /* Add a command to bin[x][y].
  */
 static inline boolean
@@ -338,7 +386,9 @@ lp_scene_bin_command( struct lp_scene *scene,
       tail->arg[i] = arg;
       tail->count++;
    }
-   
+
+   bin->cost += lp_scene_cmd_cost(cmd & LP_RAST_OP_MASK);
+
    return TRUE;
 }
 
@@ -394,10 +444,11 @@ lp_scene_get_num_bins( const struct lp_scene *scene )
 
 
 void
-lp_scene_bin_iter_begin( struct lp_scene *scene );
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_domains );
 
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene, int *x, int *y );
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned domain,
+                        int *x, int *y );
 
 
 
@@ -30,9 +30,16 @@
  * Scene queue.  We'll use two queues.  One contains "full" scenes which
  * are produced by the "setup" code.  The other contains "empty" scenes
  * which are produced by the "rast" code when it finishes rendering a scene.
+ *
+ * There is exactly one producer (the context thread binning scenes) and
+ * one consumer (rasterizer thread 0), so head and tail are each only
+ * written by one side and the common case needs no lock.  The mutex and
+ * condition variable are only used when one side has to sleep, and the
+ * other side only takes them if it sees a sleeper.
  */
 
 #include "os/os_thread.h"
+#include "util/u_atomic.h"
 #include "util/u_memory.h"
 #include "lp_scene_queue.h"
 #include "util/u_math.h"
@@ -53,9 +60,14 @@ struct lp_scene_queue
    mtx_t mutex;
    cnd_t change;
 
+   /* Number of threads sleeping on the condition variable. */
+   unsigned waiters;
+
    /* These values wrap around, so that head == tail means empty.  When used
     * to index the array, we use them modulo the queue size.  This scheme
     * works because the queue size is a power of two.
+    *
+    * head is only written by the consumer and tail only by the producer.
     */
    unsigned head;
    unsigned tail;
@@ -93,27 +105,46 @@ lp_scene_queue_destroy(struct lp_scene_queue *queue)
 }
 
 
+/**
+ * Wake up the other side if it is sleeping.  The read-modify-write on
+ * waiters orders the head/tail update before it against the increment a
+ * sleeper does before re-checking the queue, so a wakeup can't be lost.
+ */
+static void
+wake_waiters(struct lp_scene_queue *queue)
+{
+   if (p_atomic_add_return(&queue->waiters, 0)) {
+      mtx_lock(&queue->mutex);
+      cnd_broadcast(&queue->change);
+      mtx_unlock(&queue->mutex);
+   }
+}
+
+
 /** Remove first lp_scene from head of queue */
 struct lp_scene *
 lp_scene_dequeue(struct lp_scene_queue *queue, boolean wait)
 {
-   mtx_lock(&queue->mutex);
+   const unsigned head = queue->head;
+
+   if (p_atomic_read(&queue->tail) == head) {
+      if (!wait)
+         return NULL;
 
-   if (wait) {
       /* Wait for queue to be not empty. */
-      while (queue->head == queue->tail)
+      mtx_lock(&queue->mutex);
+      p_atomic_inc(&queue->waiters);
+      while (p_atomic_read(&queue->tail) == head)
          cnd_wait(&queue->change, &queue->mutex);
-   } else {
-      if (queue->head == queue->tail) {
-         mtx_unlock(&queue->mutex);
-         return NULL;
-      }
+      p_atomic_dec(&queue->waiters);
+      mtx_unlock(&queue->mutex);
    }
 
-   struct lp_scene *scene = queue->scenes[queue->head++ % SCENE_QUEUE_SIZE];
+   struct lp_scene *scene = queue->scenes[head % SCENE_QUEUE_SIZE];
 
-   cnd_signal(&queue->change);
-   mtx_unlock(&queue->mutex);
+   /* Publish the free slot only after the scene has been read from it. */
+   p_atomic_set(&queue->head, head + 1);
+   wake_waiters(queue);
 
    return scene;
 }
@@ -123,14 +154,21 @@ lp_scene_dequeue(struct lp_scene_queue *queue, boolean wait)
 void
 lp_scene_enqueue(struct lp_scene_queue *queue, struct lp_scene *scene)
 {
-   mtx_lock(&queue->mutex);
+   const unsigned tail = queue->tail;
 
    /* Wait for free space. */
-   while (queue->tail - queue->head >= SCENE_QUEUE_SIZE)
-      cnd_wait(&queue->change, &queue->mutex);
+   if (tail - p_atomic_read(&queue->head) >= SCENE_QUEUE_SIZE) {
+      mtx_lock(&queue->mutex);
+      p_atomic_inc(&queue->waiters);
+      while (tail - p_atomic_read(&queue->head) >= SCENE_QUEUE_SIZE)
+         cnd_wait(&queue->change, &queue->mutex);
+      p_atomic_dec(&queue->waiters);
+      mtx_unlock(&queue->mutex);
+   }
 
-   queue->scenes[queue->tail++ % SCENE_QUEUE_SIZE] = scene;
+   queue->scenes[tail % SCENE_QUEUE_SIZE] = scene;
 
-   cnd_signal(&queue->change);
-   mtx_unlock(&queue->mutex);
+   /* Publish the scene only after the slot has been written. */
+   p_atomic_set(&queue->tail, tail + 1);
+   wake_waiters(queue);
 }
@@ -95,6 +95,7 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
    { "no_rast_linear", PERF_NO_RAST_LINEAR, NULL },
    { "no_shade",       PERF_NO_SHADE, NULL },
+   { "no_tri_batch",   PERF_NO_TRI_BATCH, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -937,6 +938,8 @@ static void lp_disk_cache_create(struct llvmpipe_screen *screen)
       return;
 
    _mesa_sha1_update(&ctx, &gallivm_perf, sizeof(gallivm_perf));
+   /* LP_NATIVE_VECTOR_WIDTH changes the generated code too */
+   _mesa_sha1_update(&ctx, &lp_native_vector_width, sizeof(lp_native_vector_width));
    update_cache_sha1_cpu(&ctx);
    _mesa_sha1_final(&ctx, sha1);
    disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
@@ -1072,12 +1075,15 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->allow_cl = !!getenv("LP_CL");
    screen->use_tgsi = (LP_DEBUG & DEBUG_TGSI_IR);
    screen->num_threads = util_get_cpu_caps()->nr_cpus > 1 ? util_get_cpu_caps()->nr_cpus : 0;
+   screen->num_threads = MIN2(screen->num_threads, LP_DEFAULT_MAX_THREADS);
 #ifdef EMBEDDED_DEVICE
    screen->num_threads = MIN2(screen->num_threads, 2);
 #endif
    screen->num_threads = debug_get_num_option("LP_NUM_THREADS", screen->num_threads);
    screen->num_threads = MIN2(screen->num_threads, LP_MAX_THREADS);
 
+   screen->tiled_textures = debug_get_bool_option("LP_TILED_TEXTURES", false);
+
    lp_build_init(); /* get lp_native_vector_width initialised */
 
    snprintf(screen->renderer_string, sizeof(screen->renderer_string), "llvmpipe (LLVM " MESA_LLVM_VERSION_STRING ", %u bits)", lp_native_vector_width );
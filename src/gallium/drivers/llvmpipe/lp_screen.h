@@ -63,6 +63,7 @@ struct llvmpipe_screen
 
    bool use_tgsi;
    bool allow_cl;
+   bool tiled_textures;
 
    mtx_t late_mutex;
    bool late_init_done;
@@ -49,6 +49,7 @@
 #include "lp_texture.h"
 #include "lp_debug.h"
 #include "lp_fence.h"
+#include "lp_perf.h"
 #include "lp_query.h"
 #include "lp_rast.h"
 #include "lp_setup_context.h"
@@ -65,17 +66,38 @@ static boolean set_scene_state( struct lp_setup_context *, enum setup_state,
                              const char *reason);
 static boolean try_update_scene_state( struct lp_setup_context *setup );
 
+/**
+ * All scenes are in flight: block until the oldest one has been
+ * rasterized and reuse it.  Waiting on the oldest fence rather than an
+ * arbitrary scene keeps the rasterizer fed with the scenes queued after
+ * it while we wait for the shortest time.
+ */
 static unsigned
 lp_setup_wait_empty_scene(struct lp_setup_context *setup)
 {
-   /* just use the first scene if we run out */
-   if (setup->scenes[0]->fence) {
-      debug_printf("%s: wait for scene %d\n",
-                   __FUNCTION__, setup->scenes[0]->fence->id);
-      lp_fence_wait(setup->scenes[0]->fence);
-      lp_scene_end_rasterization(setup->scenes[0]);
-   }
-   return 0;
+   unsigned oldest = 0;
+   int i;
+
+   for (i = 1; i < setup->num_active_scenes; i++) {
+      struct lp_fence *fence = setup->scenes[i]->fence;
+      struct lp_fence *oldest_fence = setup->scenes[oldest]->fence;
+
+      if (!fence)
+         continue;
+      if (!oldest_fence || (int)(fence->id - oldest_fence->id) < 0)
+         oldest = i;
+   }
+
+   if (setup->scenes[oldest]->fence) {
+      LP_DBG(DEBUG_SETUP, "%s: wait for scene %d\n",
+             __FUNCTION__, setup->scenes[oldest]->fence->id);
+      int64_t start = os_time_get();
+      lp_fence_wait(setup->scenes[oldest]->fence);
+      LP_COUNT(nr_scene_stalls);
+      LP_COUNT_ADD(scene_stall_time, os_time_get() - start);
+      lp_scene_end_rasterization(setup->scenes[oldest]);
+   }
+   return oldest;
 }
 
 static void
@@ -128,6 +150,21 @@ first_triangle( struct lp_setup_context *setup,
    setup->triangle( setup, v0, v1, v2 );
 }
 
+static void
+first_triangles( struct lp_setup_context *setup,
+                 const float (*const *v)[4],
+                 unsigned nr )
+{
+   assert(setup->state == SETUP_ACTIVE);
+   lp_setup_choose_triangle( setup );
+   if (setup->triangles) {
+      setup->triangles( setup, v, nr );
+   } else {
+      for (unsigned i = 0; i < nr; i++)
+         setup->triangle( setup, v[i*3 + 0], v[i*3 + 1], v[i*3 + 2] );
+   }
+}
+
 static boolean
 first_rectangle( struct lp_setup_context *setup,
                  const float (*v0)[4],
@@ -190,6 +227,7 @@ lp_setup_reset( struct lp_setup_context *setup )
    setup->line = first_line;
    setup->point = first_point;
    setup->triangle = first_triangle;
+   setup->triangles = first_triangles;
    setup->rect = first_rectangle;
 }
 
@@ -609,6 +647,7 @@ lp_setup_set_triangle_state( struct lp_setup_context *setup,
    setup->ccw_is_frontface = ccw_is_frontface;
    setup->cullmode = cull_mode;
    setup->triangle = first_triangle;
+   setup->triangles = first_triangles;
    setup->rect = first_rectangle;
    setup->multisample = multisample;
    setup->pixel_offset = half_pixel_center ? 0.5f : 0.0f;
@@ -875,6 +914,7 @@ lp_setup_set_rasterizer_discard(struct lp_setup_context *setup,
       setup->line = first_line;
       setup->point = first_point;
       setup->triangle = first_triangle;
+      setup->triangles = first_triangles;
       setup->rect = first_rectangle;
    }
 }
@@ -1640,6 +1680,7 @@ lp_setup_create( struct pipe_context *pipe,
    setup->num_active_scenes++;
 
    setup->triangle = first_triangle;
+   setup->triangles = first_triangles;
    setup->line     = first_line;
    setup->point    = first_point;
    
@@ -1794,6 +1835,8 @@ lp_setup_flush_and_restart(struct lp_setup_context *setup)
 
    assert(setup->state == SETUP_ACTIVE);
 
+   LP_COUNT(nr_scene_full_flushes);
+
    if (!set_scene_state(setup, SETUP_FLUSHED, __FUNCTION__))
       return FALSE;
    
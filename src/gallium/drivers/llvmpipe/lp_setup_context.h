@@ -59,6 +59,9 @@ struct lp_setup_variant;
 #define INITIAL_SCENES 4
 #define MAX_SCENES 64
 
+/** Max number of triangles handed to lp_setup_context::triangles at once */
+#define LP_SETUP_TRI_BATCH 16
+
 
 
 /**
@@ -188,6 +191,11 @@ struct lp_setup_context
                      const float (*v1)[4],
                      const float (*v2)[4]);
 
+   /** Optional, set up \p nr triangles from three vertices each */
+   void (*triangles)( struct lp_setup_context *,
+                      const float (*const *v)[4],
+                      unsigned nr );
+
    boolean
    (*rect)( struct lp_setup_context *,
             const float (*v0)[4],
@@ -1147,6 +1147,65 @@ rotate_fixed_position_12( struct fixed_position* position )
 }
 
 
+/**
+ * Bin a triangle whose position has been computed if it's CW, cull
+ * otherwise.
+ */
+static inline void
+setup_triangle_cw(struct lp_setup_context *setup,
+                  struct fixed_position *position,
+                  int8_t area_sign,
+                  const float (*v0)[4],
+                  const float (*v1)[4],
+                  const float (*v2)[4])
+{
+   if (area_sign < 0) {
+      if (setup->flatshade_first) {
+         rotate_fixed_position_12(position);
+         retry_triangle_ccw(setup, position, v0, v2, v1, !setup->ccw_is_frontface);
+      } else {
+         rotate_fixed_position_01(position);
+         retry_triangle_ccw(setup, position, v1, v0, v2, !setup->ccw_is_frontface);
+      }
+   }
+}
+
+
+static inline void
+setup_triangle_ccw(struct lp_setup_context *setup,
+                   struct fixed_position *position,
+                   int8_t area_sign,
+                   const float (*v0)[4],
+                   const float (*v1)[4],
+                   const float (*v2)[4])
+{
+   if (area_sign > 0)
+      retry_triangle_ccw(setup, position, v0, v1, v2, setup->ccw_is_frontface);
+}
+
+
+static inline void
+setup_triangle_both(struct lp_setup_context *setup,
+                    struct fixed_position *position,
+                    int8_t area_sign,
+                    const float (*v0)[4],
+                    const float (*v1)[4],
+                    const float (*v2)[4])
+{
+   if (area_sign > 0)
+      retry_triangle_ccw( setup, position, v0, v1, v2, setup->ccw_is_frontface );
+   else if (area_sign < 0) {
+      if (setup->flatshade_first) {
+         rotate_fixed_position_12( position );
+         retry_triangle_ccw( setup, position, v0, v2, v1, !setup->ccw_is_frontface );
+      } else {
+         rotate_fixed_position_01( position );
+         retry_triangle_ccw( setup, position, v1, v0, v2, !setup->ccw_is_frontface );
+      }
+   }
+}
+
+
 /**
  * Draw triangle if it's CW, cull otherwise.
  */
@@ -1164,15 +1223,7 @@ static void triangle_cw(struct lp_setup_context *setup,
 
    int8_t area_sign = calc_fixed_position(setup, &position, v0, v1, v2);
 
-   if (area_sign < 0) {
-      if (setup->flatshade_first) {
-         rotate_fixed_position_12(&position);
-         retry_triangle_ccw(setup, &position, v0, v2, v1, !setup->ccw_is_frontface);
-      } else {
-         rotate_fixed_position_01(&position);
-         retry_triangle_ccw(setup, &position, v1, v0, v2, !setup->ccw_is_frontface);
-      }
-   }
+   setup_triangle_cw(setup, &position, area_sign, v0, v1, v2);
 }
 
 
@@ -1190,8 +1241,7 @@ static void triangle_ccw(struct lp_setup_context *setup,
 
    int8_t area_sign = calc_fixed_position(setup, &position, v0, v1, v2);
 
-   if (area_sign > 0)
-      retry_triangle_ccw(setup, &position, v0, v1, v2, setup->ccw_is_frontface);
+   setup_triangle_ccw(setup, &position, area_sign, v0, v1, v2);
 }
 
 /**
@@ -1220,19 +1270,158 @@ static void triangle_both(struct lp_setup_context *setup,
       assert(!util_is_inf_or_nan(v2[0][1]));
    }
 
-   if (area_sign > 0)
-      retry_triangle_ccw( setup, &position, v0, v1, v2, setup->ccw_is_frontface );
-   else if (area_sign < 0) {
-      if (setup->flatshade_first) {
-         rotate_fixed_position_12( &position );
-         retry_triangle_ccw( setup, &position, v0, v2, v1, !setup->ccw_is_frontface );
-      } else {
-         rotate_fixed_position_01( &position );
-         retry_triangle_ccw( setup, &position, v1, v0, v2, !setup->ccw_is_frontface );
+   setup_triangle_both(setup, &position, area_sign, v0, v1, v2);
+}
+
+
+#if defined(PIPE_ARCH_SSE)
+
+static inline __m128i
+min_epi32(__m128i a, __m128i b)
+{
+   __m128i lt = _mm_cmplt_epi32(a, b);
+   return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+}
+
+static inline __m128i
+max_epi32(__m128i a, __m128i b)
+{
+   __m128i gt = _mm_cmpgt_epi32(a, b);
+   return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+/**
+ * Set up independent triangles four at a time.
+ *
+ * Snapping to fixed point and the bounding box test against the draw
+ * region are done for four triangles at once, which is most of the work
+ * for the many small triangles that end up outside the scissor or are
+ * degenerate.  The survivors are binned one by one as usual, and
+ * lp_setup_bin_triangle() still tells single tile triangles apart.
+ *
+ * \param v  three vertex pointers per triangle
+ */
+static void
+triangles_sse2(struct lp_setup_context *setup,
+               const float (*const *v)[4],
+               unsigned nr)
+{
+   struct llvmpipe_context *lp_context = (struct llvmpipe_context *)setup->pipe;
+   const struct u_rect *region = &setup->draw_regions[0];
+   const float pixel_offset = setup->multisample ? 0.0 : setup->pixel_offset;
+   const __m128 pix_offset = _mm_set1_ps(pixel_offset);
+   const __m128 fixed_one = _mm_set1_ps((float)FIXED_ONE);
+   const __m128i adj = _mm_set1_epi32(setup->bottom_edge_rule != 0 ? 1 : 0);
+   const __m128i one = _mm_set1_epi32(1);
+   const __m128i region_x0 = _mm_set1_epi32(region->x0);
+   const __m128i region_x1 = _mm_set1_epi32(region->x1);
+   const __m128i region_y0 = _mm_set1_epi32(region->y0);
+   const __m128i region_y1 = _mm_set1_epi32(region->y1);
+   const bool region_empty = region->x1 < region->x0 ||
+                             region->y1 < region->y0;
+   unsigned i, j, k;
+
+   /* Triangles pick their own viewport, hence draw region. */
+   if (setup->viewport_index_slot > 0) {
+      for (i = 0; i < nr; i++)
+         setup->triangle(setup, v[i*3 + 0], v[i*3 + 1], v[i*3 + 2]);
+      return;
+   }
+
+   if (lp_context->active_statistics_queries) {
+      lp_context->pipeline_statistics.c_primitives += nr;
+   }
+
+   for (i = 0; i < nr; i += 4) {
+      const unsigned count = MIN2(4, nr - i);
+      const float (*const *tri)[4] = &v[i * 3];
+      union m128i x[3], y[3];
+      __m128i minx, maxx, miny, maxy, x0, x1, y0, y1, reject;
+      unsigned reject_mask;
+
+      /* Snap the vertices to fixed point, exactly as
+       * calc_fixed_position() does.  Unused lanes repeat the last
+       * triangle.
+       */
+      for (k = 0; k < 3; k++) {
+         __m128 fx, fy;
+
+         fx = _mm_setr_ps(tri[MIN2(0, count - 1)*3 + k][0][0],
+                          tri[MIN2(1, count - 1)*3 + k][0][0],
+                          tri[MIN2(2, count - 1)*3 + k][0][0],
+                          tri[MIN2(3, count - 1)*3 + k][0][0]);
+         fy = _mm_setr_ps(tri[MIN2(0, count - 1)*3 + k][0][1],
+                          tri[MIN2(1, count - 1)*3 + k][0][1],
+                          tri[MIN2(2, count - 1)*3 + k][0][1],
+                          tri[MIN2(3, count - 1)*3 + k][0][1]);
+         x[k].m = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(fx, pix_offset),
+                                             fixed_one));
+         y[k].m = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(fy, pix_offset),
+                                             fixed_one));
+      }
+
+      /* Bounding boxes, as in do_triangle_ccw() */
+      minx = min_epi32(min_epi32(x[0].m, x[1].m), x[2].m);
+      maxx = max_epi32(max_epi32(x[0].m, x[1].m), x[2].m);
+      miny = min_epi32(min_epi32(y[0].m, y[1].m), y[2].m);
+      maxy = max_epi32(max_epi32(y[0].m, y[1].m), y[2].m);
+
+      x0 = _mm_srai_epi32(minx, FIXED_ORDER);
+      x1 = _mm_srai_epi32(_mm_sub_epi32(maxx, one), FIXED_ORDER);
+      y0 = _mm_srai_epi32(_mm_add_epi32(miny, adj), FIXED_ORDER);
+      y1 = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(maxy, one), adj),
+                          FIXED_ORDER);
+
+      /* !u_rect_test_intersection(region, bbox) */
+      reject = _mm_or_si128(_mm_cmplt_epi32(x1, region_x0),
+                            _mm_cmplt_epi32(region_x1, x0));
+      reject = _mm_or_si128(reject, _mm_cmplt_epi32(y1, region_y0));
+      reject = _mm_or_si128(reject, _mm_cmplt_epi32(region_y1, y0));
+      reject = _mm_or_si128(reject, _mm_cmplt_epi32(x1, x0));
+      reject = _mm_or_si128(reject, _mm_cmplt_epi32(y1, y0));
+      reject_mask = region_empty ? 0xf :
+         _mm_movemask_ps(_mm_castsi128_ps(reject));
+
+      for (j = 0; j < count; j++) {
+         PIPE_ALIGN_VAR(16) struct fixed_position position;
+         const float (*v0)[4] = tri[j*3 + 0];
+         const float (*v1)[4] = tri[j*3 + 1];
+         const float (*v2)[4] = tri[j*3 + 2];
+
+         if (reject_mask & (1 << j)) {
+            LP_COUNT(nr_culled_tris);
+            continue;
+         }
+
+         position.x[0] = x[0].ui[j];
+         position.x[1] = x[1].ui[j];
+         position.x[2] = x[2].ui[j];
+         position.x[3] = 0;
+         position.y[0] = y[0].ui[j];
+         position.y[1] = y[1].ui[j];
+         position.y[2] = y[2].ui[j];
+         position.y[3] = 0;
+         position.dx01 = position.x[0] - position.x[1];
+         position.dy01 = position.y[0] - position.y[1];
+         position.dx20 = position.x[2] - position.x[0];
+         position.dy20 = position.y[2] - position.y[0];
+
+         uint64_t area = IMUL64(position.dx01, position.dy20) -
+            IMUL64(position.dx20, position.dy01);
+         int8_t area_sign = area == 0 ? 0 : (area & (1ULL << 63)) ? -1 : 1;
+
+         if (setup->triangle == triangle_ccw)
+            setup_triangle_ccw(setup, &position, area_sign, v0, v1, v2);
+         else if (setup->triangle == triangle_cw)
+            setup_triangle_cw(setup, &position, area_sign, v0, v1, v2);
+         else
+            setup_triangle_both(setup, &position, area_sign, v0, v1, v2);
       }
    }
 }
 
+#endif
+
 
 static void triangle_noop(struct lp_setup_context *setup,
                           const float (*v0)[4],
@@ -1245,6 +1434,8 @@ static void triangle_noop(struct lp_setup_context *setup,
 void 
 lp_setup_choose_triangle(struct lp_setup_context *setup)
 {
+   setup->triangles = NULL;
+
    if (setup->rasterizer_discard) {
       setup->triangle = triangle_noop;
       return;
@@ -1261,6 +1452,11 @@ lp_setup_choose_triangle(struct lp_setup_context *setup)
       break;
    default:
       setup->triangle = triangle_noop;
-      break;
+      return;
    }
+
+#if defined(PIPE_ARCH_SSE)
+   if (!(LP_PERF & PERF_NO_TRI_BATCH))
+      setup->triangles = triangles_sse2;
+#endif
 }
@@ -42,6 +42,7 @@
 #include "draw/draw_vertex.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
+#include "util/os_time.h"
 #include "lp_state_fs.h"
 #include "lp_perf.h"
 
@@ -142,6 +143,27 @@ static inline const_float4_ptr get_vert( const void *vertex_buffer,
    return (const_float4_ptr)((char *)vertex_buffer + index * stride);
 }
 
+/**
+ * Count which rasterization path the fragment shader allows this draw.
+ */
+static inline void
+count_draw_path(const struct lp_setup_context *setup)
+{
+#ifdef DEBUG
+   const struct lp_fragment_shader_variant *variant =
+      setup->fs.current.variant;
+
+   if (!setup->permit_linear_rasterizer || !variant)
+      LP_COUNT(nr_draws_tri);
+   else if (variant->jit_linear_blit)
+      LP_COUNT(nr_draws_linear_blit);
+   else if (variant->jit_linear)
+      LP_COUNT(nr_draws_linear);
+   else
+      LP_COUNT(nr_draws_tri);
+#endif
+}
+
 static inline void
 rect(struct lp_setup_context *setup,
      const float (*v0)[4],
@@ -176,6 +198,12 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    if (!lp_setup_update_state(setup, TRUE))
       return;
 
+   count_draw_path(setup);
+
+#ifdef DEBUG
+   int64_t start_time = os_time_get();
+#endif
+
    uses_constant_interp = setup->setup.variant->key.uses_constant_interp;
 
    switch (setup->prim) {
@@ -227,6 +255,19 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
                           get_vert(vertex_buffer, indices[i-0], stride) );
          }
       }
+      else if (setup->triangles) {
+         const float (*batch[LP_SETUP_TRI_BATCH * 3])[4];
+
+         for (i = 0; i + 3 <= nr; ) {
+            unsigned count = MIN2((nr - i) / 3, LP_SETUP_TRI_BATCH);
+            unsigned j;
+
+            for (j = 0; j < count * 3; j++)
+               batch[j] = get_vert(vertex_buffer, indices[i + j], stride);
+            setup->triangles(setup, batch, count);
+            i += count * 3;
+         }
+      }
       else {
          for (i = 2; i < nr; i += 3) {
             setup->triangle( setup,
@@ -369,6 +410,10 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    default:
       assert(0);
    }
+
+#ifdef DEBUG
+   LP_COUNT_ADD(setup_time, os_time_get() - start_time);
+#endif
 }
 
 
@@ -390,6 +435,12 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    if (!lp_setup_update_state(setup, TRUE))
       return;
 
+   count_draw_path(setup);
+
+#ifdef DEBUG
+   int64_t start_time = os_time_get();
+#endif
+
    uses_constant_interp = setup->setup.variant->key.uses_constant_interp;
 
    switch (setup->prim) {
@@ -447,6 +498,19 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
           * emitted (setup) the rect or triangles.
           */
       }
+      else if (setup->triangles) {
+         const float (*batch[LP_SETUP_TRI_BATCH * 3])[4];
+
+         for (i = 0; i + 3 <= nr; ) {
+            unsigned count = MIN2((nr - i) / 3, LP_SETUP_TRI_BATCH);
+            unsigned j;
+
+            for (j = 0; j < count * 3; j++)
+               batch[j] = get_vert(vertex_buffer, i + j, stride);
+            setup->triangles(setup, batch, count);
+            i += count * 3;
+         }
+      }
       else {
          for (i = 2; i < nr; i += 3) {
             setup->triangle( setup,
@@ -641,6 +705,10 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    default:
       assert(0);
    }
+
+#ifdef DEBUG
+   LP_COUNT_ADD(setup_time, os_time_get() - start_time);
+#endif
 }
 
 
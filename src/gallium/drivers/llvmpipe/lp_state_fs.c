@@ -68,6 +68,7 @@
 #include "util/u_dual_blend.h"
 #include "util/u_upload_mgr.h"
 #include "util/os_time.h"
+#include "util/u_atomic.h"
 #include "pipe/p_shader_tokens.h"
 #include "draw/draw_context.h"
 #include "tgsi/tgsi_dump.h"
@@ -103,6 +104,7 @@
 #include "lp_tex_sample.h"
 #include "lp_flush.h"
 #include "lp_state_fs.h"
+#include "lp_texture.h"
 #include "lp_rast.h"
 #include "nir/nir_to_tgsi_info.h"
 
@@ -209,7 +211,7 @@ lp_mem_type_from_format_desc(const struct util_format_description *format_desc,
  * n*four pixels in n 2x2 quads.  This will set the n*four elements of the
  * quad mask vector to 0 or ~0.
  * Grouping is 01, 23 for 2 quad mode hence only 0 and 2 are valid
- * quad arguments with fs length 8.
+ * quad arguments with fs length 8, and only 0 with fs length 16.
  *
  * \param first_quad  which quad(s) of the quad group to test, in [0,3]
  * \param mask_input  bitwise mask for the whole 4x4 stamp
@@ -508,6 +510,10 @@ static void fs_fb_fetch(const struct lp_build_fs_iface *iface,
          x = (i & 1) + ((i >> 2) << 1);
          if (!key->resource_1d)
             y = (i & 2) >> 1;
+      } else if (block_size == 16) {
+         /* 16 wide covers the whole stamp as four 2x2 quads in order. */
+         x = (i & 1) + ((i >> 2) & 1) * 2;
+         y = ((i & 2) >> 1) + ((i >> 3) << 1);
       }
 
       LLVMValueRef x_val;
@@ -3060,6 +3066,13 @@ generate_fragment(struct llvmpipe_context *lp,
    fs_type.width = 32;           /* 32-bit float */
    fs_type.length = MIN2(lp_native_vector_width / 32, 16); /* n*4 elements per vector */
 
+   /*
+    * 1d resources only run the upper half of the stamp, which 16 wide
+    * vectors can't express.
+    */
+   if (key->resource_1d)
+      fs_type.length = MIN2(fs_type.length, 8);
+
    memset(&blend_type, 0, sizeof blend_type);
    blend_type.floating = FALSE; /* values are integers */
    blend_type.sign = FALSE;     /* values are unsigned */
@@ -3330,6 +3343,45 @@ generate_fragment(struct llvmpipe_context *lp,
 
    sampler->destroy(sampler);
    image->destroy(image);
+
+   /*
+    * Blending only knows about 4 and 8 wide vectors.  A 16 wide vector holds
+    * the quads of both 8 wide iterations in the same order, so just split
+    * the masks and colors in halves.
+    */
+   if (fs_type.length == 16) {
+      struct lp_type half_type = fs_type;
+      LLVMTypeRef half_ptr_type;
+      LLVMValueRef one = lp_build_const_int32(gallivm, 1);
+      unsigned nr_color_outputs = MAX2(key->nr_cbufs, dual_source_blend ? 2 : 0);
+
+      assert(num_fs == 1);
+      half_type.length = 8;
+      half_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, half_type), 0);
+
+      for (int s = key->coverage_samples - 1; s >= 0; s--) {
+         LLVMValueRef mask = fs_mask[s];
+         fs_mask[s * 2 + 0] = lp_build_extract_range(gallivm, mask, 0, 8);
+         fs_mask[s * 2 + 1] = lp_build_extract_range(gallivm, mask, 8, 8);
+      }
+
+      for (unsigned s = 0; s < key->min_samples; s++) {
+         for (cbuf = 0; cbuf < nr_color_outputs; cbuf++) {
+            for (chan = 0; chan < TGSI_NUM_CHANNELS; ++chan) {
+               LLVMValueRef ptr = LLVMBuildBitCast(builder,
+                                                   fs_out_color[s][cbuf][chan][0],
+                                                   half_ptr_type, "");
+               fs_out_color[s][cbuf][chan][0] = ptr;
+               fs_out_color[s][cbuf][chan][1] = LLVMBuildGEP(builder, ptr,
+                                                             &one, 1, "");
+            }
+         }
+      }
+
+      fs_type = half_type;
+      num_fs = 2;
+   }
+
    /* Loop over color outputs / color buffers to do blending.
     */
    for(cbuf = 0; cbuf < key->nr_cbufs; cbuf++) {
@@ -3485,6 +3537,8 @@ dump_fs_variant_key(struct lp_fragment_shader_variant_key *key)
                    util_str_tex_target(texture->target, TRUE));
       debug_printf("  .level_zero_only = %u\n",
                    texture->level_zero_only);
+      debug_printf("  .tiled = %u\n",
+                   texture->tiled);
       debug_printf("  .pot = %u %u %u\n",
                    texture->pot_width,
                    texture->pot_height,
@@ -3552,9 +3606,18 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
    void *ir_binary;
 
    blob_init(&blob);
-   nir_serialize(&blob, variant->shader->base.ir.nir, true);
-   ir_binary = blob.data;
-   ir_size = blob.size;
+   if (variant->shader->base.type == PIPE_SHADER_IR_TGSI) {
+      /* TGSI shaders (blits and other internal shaders, mostly) are cached
+       * too, keyed on their tokens.
+       */
+      ir_binary = (void *)variant->shader->base.tokens;
+      ir_size = tgsi_num_tokens(variant->shader->base.tokens) *
+                sizeof(struct tgsi_token);
+   } else {
+      nir_serialize(&blob, variant->shader->base.ir.nir, true);
+      ir_binary = blob.data;
+      ir_size = blob.size;
+   }
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
@@ -3565,25 +3628,168 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
    blob_finish(&blob);
 }
 
+/**
+ * State needed to generate and compile the code of a fragment shader
+ * variant, either right away or on lp->fs_compile_queue.
+ */
+struct lp_fs_variant_compile_job {
+   struct llvmpipe_context *lp;
+   struct lp_fragment_shader_variant *variant;
+   struct lp_cached_code cached;
+   unsigned char ir_sha1_cache_key[20];
+   bool needs_caching;
+   boolean fullcolormask;
+   boolean linear;
+};
+
+
+/**
+ * Generate the LLVM IR of a fragment shader variant and JIT it.
+ *
+ * Only the rasterizer looks at the results, so this can run on another
+ * thread as long as the variant has its own LLVM context.
+ */
+static void
+generate_variant_code(struct lp_fs_variant_compile_job *job)
+{
+   struct llvmpipe_context *lp = job->lp;
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   struct lp_fragment_shader_variant *variant = job->variant;
+   struct lp_fragment_shader *shader = variant->shader;
+   const struct lp_fragment_shader_variant_key *key = &variant->key;
+   const boolean fullcolormask = job->fullcolormask;
+   const boolean linear = job->linear;
+
+   llvmpipe_fs_variant_fastpath(variant);
+
+   lp_jit_init_types(variant);
+
+   if (variant->jit_function[RAST_EDGE_TEST] == NULL)
+      generate_fragment(lp, shader, variant, RAST_EDGE_TEST);
+
+   if (variant->jit_function[RAST_WHOLE] == NULL) {
+      if (variant->opaque) {
+         /* Specialized shader, which doesn't need to read the color buffer. */
+         generate_fragment(lp, shader, variant, RAST_WHOLE);
+      }
+   }
+
+   if (linear) {
+      /* Currently keeping both the old fastpaths and new linear path
+       * active.  The older code is still somewhat faster for the cases
+       * it covers.
+       *
+       * XXX: consider restricting this to aero-mode only.
+       */
+      if (fullcolormask &&
+          !key->alpha.enabled &&
+          !key->blend.alpha_to_coverage) {
+         llvmpipe_fs_variant_linear_fastpath(variant);
+      }
+
+      /* If the original fastpath doesn't cover this variant, try the new
+       * code:
+       */
+      if (variant->jit_linear == NULL) {
+         if (shader->kind == LP_FS_KIND_BLIT_RGBA ||
+             shader->kind == LP_FS_KIND_BLIT_RGB1 ||
+             shader->kind == LP_FS_KIND_LLVM_LINEAR) {
+            llvmpipe_fs_variant_linear_llvm(lp, shader, variant);
+         }
+      }
+   } else {
+      if (LP_DEBUG & DEBUG_LINEAR) {
+         lp_debug_fs_variant(variant);
+         debug_printf("    ----> no linear path for this variant\n");
+      }
+   }
+
+   /*
+    * Compile everything
+    */
+
+   gallivm_compile_module(variant->gallivm);
+
+   variant->nr_instrs += lp_build_count_ir_module(variant->gallivm->module);
+
+   if (variant->function[RAST_EDGE_TEST]) {
+      variant->jit_function[RAST_EDGE_TEST] = (lp_jit_frag_func)
+            gallivm_jit_function(variant->gallivm,
+                                 variant->function[RAST_EDGE_TEST]);
+   }
+
+   if (variant->function[RAST_WHOLE]) {
+         variant->jit_function[RAST_WHOLE] = (lp_jit_frag_func)
+               gallivm_jit_function(variant->gallivm,
+                                    variant->function[RAST_WHOLE]);
+   } else if (!variant->jit_function[RAST_WHOLE]) {
+      variant->jit_function[RAST_WHOLE] = variant->jit_function[RAST_EDGE_TEST];
+   }
+
+   if (linear) {
+      if (variant->linear_function) {
+         variant->jit_linear_llvm = (lp_jit_linear_llvm_func)
+               gallivm_jit_function(variant->gallivm, variant->linear_function);
+      }
+
+      /*
+       * This must be done after LLVM compilation, as it will call the JIT'ed
+       * code to determine active inputs.
+       */
+      lp_linear_check_variant(variant);
+   }
+
+   if (job->needs_caching) {
+      lp_disk_cache_insert_shader(screen, &job->cached, job->ir_sha1_cache_key);
+   }
+
+   gallivm_free_ir(variant->gallivm);
+}
+
+
+static void
+lp_fs_variant_compile_execute(void *data, void *gdata, int thread_index)
+{
+   struct lp_fs_variant_compile_job *job = data;
+   int64_t t0 = os_time_get();
+
+   generate_variant_code(job);
+
+   LP_COUNT_ADD(llvm_compile_time, os_time_get() - t0);
+   p_atomic_add(&job->lp->nr_fs_instrs, job->variant->nr_instrs);
+}
+
+
+static void
+lp_fs_variant_compile_cleanup(void *data, void *gdata, int thread_index)
+{
+   FREE(data);
+}
+
+
 /**
  * Generate a new fragment shader variant from the shader code and
  * other state indicated by the key.
+ *
+ * With LP_ASYNC_COMPILE, only the state setup depends on is computed
+ * here and the code is compiled on lp->fs_compile_queue.  The scene
+ * waits for variant->ready before rasterizing, so the draw can be binned
+ * meanwhile.
  */
 static struct lp_fragment_shader_variant *
 generate_variant(struct llvmpipe_context *lp,
                  struct lp_fragment_shader *shader,
                  const struct lp_fragment_shader_variant_key *key)
 {
-   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
+   struct lp_fs_variant_compile_job sync_job, *job = &sync_job;
    const struct util_format_description *cbuf0_format_desc = NULL;
    boolean fullcolormask;
    boolean no_kill;
    boolean linear;
    char module_name[64];
-   unsigned char ir_sha1_cache_key[20];
-   struct lp_cached_code cached = { 0 };
-   bool needs_caching = false;
+   LLVMContextRef context = lp->context;
+
    variant = MALLOC(sizeof *variant + shader->variant_key_size - sizeof variant->key);
    if (!variant)
       return NULL;
@@ -3592,20 +3798,42 @@ generate_variant(struct llvmpipe_context *lp,
    snprintf(module_name, sizeof(module_name), "fs%u_variant%u",
             shader->no, shader->variants_created);
 
+   if (lp->async_fs_compile) {
+      job = CALLOC_STRUCT(lp_fs_variant_compile_job);
+      variant->context = LLVMContextCreate();
+      if (!job || !variant->context) {
+         if (variant->context)
+            LLVMContextDispose(variant->context);
+         FREE(job);
+         FREE(variant);
+         return NULL;
+      }
+      context = variant->context;
+   } else {
+      memset(job, 0, sizeof(*job));
+   }
+
    pipe_reference_init(&variant->reference, 1);
+   util_queue_fence_init(&variant->ready);
    lp_fs_reference(lp, &variant->shader, shader);
 
    memcpy(&variant->key, key, shader->variant_key_size);
 
-   if (shader->base.ir.nir) {
-      lp_fs_get_ir_cache_key(variant, ir_sha1_cache_key);
+   if (shader->base.ir.nir || shader->base.tokens) {
+      lp_fs_get_ir_cache_key(variant, job->ir_sha1_cache_key);
 
-      lp_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
-      if (!cached.data_size)
-         needs_caching = true;
+      lp_disk_cache_find_shader(llvmpipe_screen(lp->pipe.screen),
+                                &job->cached, job->ir_sha1_cache_key);
+      if (!job->cached.data_size)
+         job->needs_caching = true;
    }
-   variant->gallivm = gallivm_create(module_name, lp->context, &cached);
+   variant->gallivm = gallivm_create(module_name, context, &job->cached);
    if (!variant->gallivm) {
+      lp_fs_reference(lp, &variant->shader, NULL);
+      if (variant->context)
+         LLVMContextDispose(variant->context);
+      if (job != &sync_job)
+         FREE(job);
       FREE(variant);
       return NULL;
    }
@@ -3681,6 +3909,7 @@ generate_variant(struct llvmpipe_context *lp,
       }
 
       if (target == PIPE_TEXTURE_2D &&
+          !samp0->texture_state.tiled &&
           min_img_filter == PIPE_TEX_FILTER_NEAREST &&
           mag_img_filter == PIPE_TEX_FILTER_NEAREST &&
           min_mip_filter == PIPE_TEX_MIPFILTER_NONE &&
@@ -3705,97 +3934,31 @@ generate_variant(struct llvmpipe_context *lp,
          (key->cbuf_format[0] == PIPE_FORMAT_B8G8R8A8_UNORM ||
           key->cbuf_format[0] == PIPE_FORMAT_B8G8R8X8_UNORM);
 
+   /* The linear path samples textures through plain row pointers. */
+   for (unsigned i = 0; i < key->nr_sampler_views; ++i) {
+      if (lp_fs_variant_key_samplers(key)[i].texture_state.tiled)
+         linear = FALSE;
+   }
+
    memcpy(&variant->key, key, sizeof *key);
 
    if ((LP_DEBUG & DEBUG_FS) || (gallivm_debug & GALLIVM_DEBUG_IR)) {
       lp_debug_fs_variant(variant);
    }
 
-   llvmpipe_fs_variant_fastpath(variant);
+   job->lp = lp;
+   job->variant = variant;
+   job->fullcolormask = fullcolormask;
+   job->linear = linear;
 
-   lp_jit_init_types(variant);
-
-   if (variant->jit_function[RAST_EDGE_TEST] == NULL)
-      generate_fragment(lp, shader, variant, RAST_EDGE_TEST);
-
-   if (variant->jit_function[RAST_WHOLE] == NULL) {
-      if (variant->opaque) {
-         /* Specialized shader, which doesn't need to read the color buffer. */
-         generate_fragment(lp, shader, variant, RAST_WHOLE);
-      }
-   }
-
-   if (linear) {
-      /* Currently keeping both the old fastpaths and new linear path
-       * active.  The older code is still somewhat faster for the cases
-       * it covers.
-       *
-       * XXX: consider restricting this to aero-mode only.
-       */
-      if (fullcolormask &&
-          !key->alpha.enabled &&
-          !key->blend.alpha_to_coverage) {
-         llvmpipe_fs_variant_linear_fastpath(variant);
-      }
-
-      /* If the original fastpath doesn't cover this variant, try the new
-       * code:
-       */
-      if (variant->jit_linear == NULL) {
-         if (shader->kind == LP_FS_KIND_BLIT_RGBA ||
-             shader->kind == LP_FS_KIND_BLIT_RGB1 ||
-             shader->kind == LP_FS_KIND_LLVM_LINEAR) {
-            llvmpipe_fs_variant_linear_llvm(lp, shader, variant);
-         }
-      }
+   if (job != &sync_job) {
+      util_queue_add_job(&lp->fs_compile_queue, job, &variant->ready,
+                         lp_fs_variant_compile_execute,
+                         lp_fs_variant_compile_cleanup, 0);
    } else {
-      if (LP_DEBUG & DEBUG_LINEAR) {
-         lp_debug_fs_variant(variant);
-         debug_printf("    ----> no linear path for this variant\n");
-      }
-   }
-
-   /*
-    * Compile everything
-    */
-
-   gallivm_compile_module(variant->gallivm);
-
-   variant->nr_instrs += lp_build_count_ir_module(variant->gallivm->module);
-
-   if (variant->function[RAST_EDGE_TEST]) {
-      variant->jit_function[RAST_EDGE_TEST] = (lp_jit_frag_func)
-            gallivm_jit_function(variant->gallivm,
-                                 variant->function[RAST_EDGE_TEST]);
-   }
-
-   if (variant->function[RAST_WHOLE]) {
-         variant->jit_function[RAST_WHOLE] = (lp_jit_frag_func)
-               gallivm_jit_function(variant->gallivm,
-                                    variant->function[RAST_WHOLE]);
-   } else if (!variant->jit_function[RAST_WHOLE]) {
-      variant->jit_function[RAST_WHOLE] = variant->jit_function[RAST_EDGE_TEST];
-   }
-
-   if (linear) {
-      if (variant->linear_function) {
-         variant->jit_linear_llvm = (lp_jit_linear_llvm_func)
-               gallivm_jit_function(variant->gallivm, variant->linear_function);
-      }
-
-      /*
-       * This must be done after LLVM compilation, as it will call the JIT'ed
-       * code to determine active inputs.
-       */
-      lp_linear_check_variant(variant);
+      generate_variant_code(job);
    }
 
-   if (needs_caching) {
-      lp_disk_cache_insert_shader(screen, &cached, ir_sha1_cache_key);
-   }
-
-   gallivm_free_ir(variant->gallivm);
-
    return variant;
 }
 
@@ -3953,14 +4116,22 @@ void llvmpipe_remove_shader_variant(struct llvmpipe_context *lp,
    /* remove from context's list */
    list_del(&variant->list_item_global.list);
    lp->nr_fs_variants--;
-   lp->nr_fs_instrs -= variant->nr_instrs;
+
+   /* An off-thread compile adds its instructions when it finishes. */
+   util_queue_fence_wait(&variant->ready);
+   p_atomic_add(&lp->nr_fs_instrs, -(int)variant->nr_instrs);
 }
 
 void
 llvmpipe_destroy_shader_variant(struct llvmpipe_context *lp,
                                struct lp_fragment_shader_variant *variant)
 {
+   util_queue_fence_wait(&variant->ready);
+   util_queue_fence_destroy(&variant->ready);
+
    gallivm_destroy(variant->gallivm);
+   if (variant->context)
+      LLVMContextDispose(variant->context);
 
    lp_fs_reference(lp, &variant->shader, NULL);
 
@@ -4111,6 +4282,7 @@ llvmpipe_set_shader_images(struct pipe_context *pipe,
          bool read_only = !(image->access & PIPE_IMAGE_ACCESS_WRITE);
          llvmpipe_flush_resource(pipe, image->resource, 0, read_only, false,
                                  false, "image");
+         llvmpipe_resource_untile(pipe, image->resource);
       }
    }
 
@@ -4360,6 +4532,15 @@ make_variant_key(struct llvmpipe_context *lp,
       }
    }
 
+   for (i = 0; i < key->nr_sampler_views; ++i) {
+      struct pipe_sampler_view *view =
+         lp->sampler_views[PIPE_SHADER_FRAGMENT][i];
+
+      if (fs_sampler[i].texture_state.format && view && view->texture)
+         fs_sampler[i].texture_state.tiled =
+            llvmpipe_resource(view->texture)->tiled;
+   }
+
    struct lp_image_static_state *lp_image;
    lp_image = lp_fs_variant_key_images(key);
    key->nr_images = shader->info.base.file_max[TGSI_FILE_IMAGE] + 1;
@@ -4474,7 +4655,8 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
          list_add(&variant->list_item_local.list, &shader->variants.list);
          list_add(&variant->list_item_global.list, &lp->fs_variants_list.list);
          lp->nr_fs_variants++;
-         lp->nr_fs_instrs += variant->nr_instrs;
+         if (!lp->async_fs_compile)
+            p_atomic_add(&lp->nr_fs_instrs, variant->nr_instrs);
          shader->variants_cached++;
       }
    }
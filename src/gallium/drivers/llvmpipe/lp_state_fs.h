@@ -31,6 +31,7 @@
 
 
 #include "util/list.h"
+#include "util/u_queue.h"
 #include "pipe/p_compiler.h"
 #include "pipe/p_state.h"
 #include "tgsi/tgsi_scan.h" /* for tgsi_shader_info */
@@ -193,6 +194,14 @@ struct lp_fragment_shader_variant
    /* Total number of LLVM instructions generated */
    unsigned nr_instrs;
 
+   /* Signalled once the code above has been compiled.  Fields other than
+    * the JIT functions, linear_* and nr_instrs are valid before that.
+    */
+   struct util_queue_fence ready;
+
+   /* Private LLVM context when the variant is compiled off-thread */
+   LLVMContextRef context;
+
    struct lp_fs_variant_list_item list_item_global, list_item_local;
    struct lp_fragment_shader *shader;
 
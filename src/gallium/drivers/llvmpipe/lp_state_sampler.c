@@ -40,6 +40,7 @@
 #include "lp_debug.h"
 #include "frontend/sw_winsys.h"
 #include "lp_flush.h"
+#include "lp_texture.h"
 
 
 static void *
@@ -152,6 +153,10 @@ llvmpipe_set_sampler_views(struct pipe_context *pipe,
       if (view)
          llvmpipe_flush_resource(pipe, view->texture, 0, true, false, false, "sampler_view");
 
+      /* Only the fragment shader samplers know about the tiled layout. */
+      if (view && shader != PIPE_SHADER_FRAGMENT)
+         llvmpipe_resource_untile(pipe, view->texture);
+
       if (take_ownership) {
          pipe_sampler_view_reference(&llvmpipe->sampler_views[shader][start + i],
                                      NULL);
@@ -194,6 +194,9 @@ llvmpipe_create_surface(struct pipe_context *pipe,
       }
    }
 
+   /* The rasterizer only renders to linear textures. */
+   llvmpipe_resource_untile(pipe, pt);
+
    ps = CALLOC_STRUCT(pipe_surface);
    if (ps) {
       pipe_reference_init(&ps->reference, 1);
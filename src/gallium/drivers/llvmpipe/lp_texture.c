@@ -182,6 +182,151 @@ fail:
 }
 
 
+/**
+ * Whether a texture can use the tiled layout: plain single level layer 2D
+ * images which nothing but the samplers is expected to touch directly.
+ */
+static bool
+llvmpipe_resource_can_tile(const struct pipe_resource *pt)
+{
+   const struct util_format_description *desc =
+      util_format_description(pt->format);
+
+   if (pt->target != PIPE_TEXTURE_2D && pt->target != PIPE_TEXTURE_RECT)
+      return false;
+
+   if (pt->array_size > 1 || pt->nr_samples > 1)
+      return false;
+
+   if (desc->block.width != 1 || desc->block.height != 1 ||
+       desc->block.bits % 8 != 0 ||
+       desc->layout == UTIL_FORMAT_LAYOUT_PLANAR2 ||
+       desc->layout == UTIL_FORMAT_LAYOUT_PLANAR3 ||
+       util_format_is_depth_or_stencil(pt->format))
+      return false;
+
+   if (pt->bind & (PIPE_BIND_DISPLAY_TARGET |
+                   PIPE_BIND_SCANOUT |
+                   PIPE_BIND_SHARED |
+                   PIPE_BIND_LINEAR))
+      return false;
+
+   if (pt->usage == PIPE_USAGE_STAGING ||
+       pt->flags & (PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
+                    PIPE_RESOURCE_FLAG_MAP_COHERENT))
+      return false;
+
+   return true;
+}
+
+
+/**
+ * Offset of texel (x, y) in a tiled image.  The 4x4 tiles of a row of tiles
+ * are stored one after another, 16 texels each, so a row of tiles takes
+ * exactly four rows of the linear layout (see lp_build_sample_offset()).
+ */
+static inline unsigned
+tiled_texel_offset(unsigned x, unsigned y, unsigned row_stride, unsigned bpp)
+{
+   return (y & ~3) * row_stride + ((x & ~3) * 4 + (y & 3) * 4 + (x & 3)) * bpp;
+}
+
+
+/**
+ * Copy a box of a tiled image level from or to linear memory.
+ */
+static void
+copy_tiled_box(struct llvmpipe_resource *lpr,
+               unsigned level,
+               const struct pipe_box *box,
+               uint8_t *linear,
+               unsigned linear_stride,
+               bool to_tiled)
+{
+   uint8_t *tiled = llvmpipe_get_texture_image_address(lpr, 0, level);
+   unsigned row_stride = lpr->row_stride[level];
+   unsigned bpp = util_format_get_blocksize(lpr->base.format);
+
+   for (unsigned y = 0; y < box->height; y++) {
+      uint8_t *row = linear + y * linear_stride;
+      unsigned ty = box->y + y;
+      unsigned x = 0;
+
+      while (x < box->width) {
+         unsigned tx = box->x + x;
+         /* texels are only contiguous up to the end of the tile row */
+         unsigned count = MIN2(4 - (tx & 3), box->width - x);
+         uint8_t *texel = tiled + tiled_texel_offset(tx, ty, row_stride, bpp);
+
+         if (to_tiled)
+            memcpy(texel, row + x * bpp, count * bpp);
+         else
+            memcpy(row + x * bpp, texel, count * bpp);
+
+         x += count;
+      }
+   }
+}
+
+
+/**
+ * Convert a tiled texture back to the linear layout, for anything but the
+ * fragment shader samplers which wants to access it.  This is permanent.
+ */
+void
+llvmpipe_resource_untile(struct pipe_context *pipe,
+                         struct pipe_resource *resource)
+{
+   struct llvmpipe_resource *lpr = llvmpipe_resource(resource);
+   unsigned bpp, level;
+   uint8_t *band;
+
+   if (!lpr->tiled)
+      return;
+
+   /* Wait for scenes still sampling from the tiled layout. */
+   llvmpipe_flush_resource(pipe, resource, 0, FALSE, TRUE, FALSE,
+                           __FUNCTION__);
+
+   bpp = util_format_get_blocksize(resource->format);
+
+   /*
+    * A row of tiles occupies the same four rows of memory in both layouts,
+    * so convert in place one row of tiles at a time.
+    */
+   band = MALLOC(4 * lpr->row_stride[0]);
+   if (!band)
+      return;
+
+   for (level = 0; level <= resource->last_level; level++) {
+      unsigned row_stride = lpr->row_stride[level];
+      unsigned width = align(u_minify(resource->width0, level), 4);
+      unsigned height = align(u_minify(resource->height0, level), 4);
+      uint8_t *image = llvmpipe_get_texture_image_address(lpr, 0, level);
+
+      for (unsigned y = 0; y < height; y += 4) {
+         uint8_t *dst = image + y * row_stride;
+
+         memcpy(band, dst, 4 * row_stride);
+         for (unsigned i = 0; i < 4; i++) {
+            for (unsigned x = 0; x < width; x += 4) {
+               memcpy(dst + i * row_stride + x * bpp,
+                      band + tiled_texel_offset(x, i, row_stride, bpp),
+                      4 * bpp);
+            }
+         }
+      }
+   }
+
+   FREE(band);
+
+   lpr->tiled = false;
+
+   /* Make all contexts rebuild the fragment shader keys of this texture. */
+   lpr->screen->timestamp++;
+}
+
+
 /**
  * Check the size of the texture specified by 'res'.
  * \return TRUE if OK, FALSE if too large.
@@ -254,6 +399,9 @@ llvmpipe_resource_create_all(struct pipe_screen *_screen,
          /* texture map */
          if (!llvmpipe_texture_layout(screen, lpr, alloc_backing))
             goto fail;
+
+         lpr->tiled = alloc_backing && screen->tiled_textures &&
+                      llvmpipe_resource_can_tile(&lpr->base);
       }
    }
    else {
@@ -775,6 +923,30 @@ llvmpipe_transfer_map_ms( struct pipe_context *pipe,
       screen->timestamp++;
    }
 
+   if (lpr->tiled) {
+      /* Map a linear copy of the box, written back on unmap. */
+      assert(box->depth == 1 && sample == 0);
+
+      pt->stride = align(box->width * util_format_get_blocksize(format), 16);
+      pt->layer_stride = pt->stride * box->height;
+
+      lpt->staging = align_malloc(pt->layer_stride, 64);
+      if (!lpt->staging) {
+         llvmpipe_resource_unmap(resource, level, box->z);
+         pipe_resource_reference(&pt->resource, NULL);
+         FREE(lpt);
+         *transfer = NULL;
+         return NULL;
+      }
+
+      if (!(usage & (PIPE_MAP_DISCARD_RANGE |
+                     PIPE_MAP_DISCARD_WHOLE_RESOURCE))) {
+         copy_tiled_box(lpr, level, box, lpt->staging, pt->stride, false);
+      }
+
+      return lpt->staging;
+   }
+
    map +=
       box->y / util_format_get_blockheight(format) * pt->stride +
       box->x / util_format_get_blockwidth(format) * util_format_get_blocksize(format);
@@ -798,16 +970,24 @@ static void
 llvmpipe_transfer_unmap(struct pipe_context *pipe,
                         struct pipe_transfer *transfer)
 {
+   struct llvmpipe_transfer *lpt = llvmpipe_transfer(transfer);
+
    assert(transfer->resource);
 
+   /* Put the staging copy of tiled textures back into their layout. */
+   if (lpt->staging) {
+      if (transfer->usage & PIPE_MAP_WRITE) {
+         copy_tiled_box(llvmpipe_resource(transfer->resource),
+                        transfer->level, &transfer->box,
+                        lpt->staging, transfer->stride, true);
+      }
+      align_free(lpt->staging);
+   }
+
    llvmpipe_resource_unmap(transfer->resource,
                            transfer->level,
                            transfer->box.z);
 
-   /* Effectively do the texture_update work here - if texture images
-    * needed post-processing to put them into hardware layout, this is
-    * where it would happen.  For llvmpipe, nothing to do.
-    */
    assert (transfer->resource);
    pipe_resource_reference(&transfer->resource, NULL);
    FREE(transfer);
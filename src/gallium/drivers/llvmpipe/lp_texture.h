@@ -103,6 +103,14 @@ struct llvmpipe_resource
    uint64_t backing_offset;
    bool backable;
    bool imported_memory;
+
+   /**
+    * Texels are stored in 4x4 micro-tiles (see LP_TILED_TEXTURES), which
+    * only the fragment shader samplers know about.  Transfers go through
+    * a linear staging copy, and anything else converts the texture back
+    * to linear for good first, with llvmpipe_resource_untile().
+    */
+   bool tiled;
 #ifdef DEBUG
    struct list_head list;
 #endif
@@ -112,6 +120,9 @@ struct llvmpipe_resource
 struct llvmpipe_transfer
 {
    struct pipe_transfer base;
+
+   /** linear copy of the mapped box of a tiled texture */
+   void *staging;
 };
 
 struct llvmpipe_memory_object
@@ -265,6 +276,10 @@ llvmpipe_is_resource_referenced( struct pipe_context *pipe,
 unsigned
 llvmpipe_get_format_alignment(enum pipe_format format);
 
+void
+llvmpipe_resource_untile(struct pipe_context *pipe,
+                         struct pipe_resource *resource);
+
 void *
 llvmpipe_transfer_map_ms( struct pipe_context *pipe,
 			  struct pipe_resource *resource,
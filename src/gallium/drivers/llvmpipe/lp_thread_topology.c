@@ -0,0 +1,57 @@
+/**************************************************************************
+ *
+ * Copyright 2022 Red Hat.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
+#include "util/u_math.h"
+#include "lp_thread_topology.h"
+
+DEBUG_GET_ONCE_BOOL_OPTION(lp_pin_threads, "LP_PIN_THREADS", false)
+
+/**
+ * Number of locality domains to split num_threads threads into, 1 if
+ * pinning is disabled or the topology is unknown.
+ */
+unsigned
+lp_thread_num_domains(unsigned num_threads)
+{
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+
+   if (!debug_get_option_lp_pin_threads() || !caps->L3_affinity_mask ||
+       caps->num_L3_caches < 2)
+      return 1;
+
+   return CLAMP(num_threads, 1, caps->num_L3_caches);
+}
+
+void
+lp_thread_pin(thrd_t thread, unsigned domain)
+{
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+
+   assert(domain < caps->num_L3_caches);
+   util_set_thread_affinity(thread, caps->L3_affinity_mask[domain], NULL,
+                            caps->num_cpu_mask_bits);
+}
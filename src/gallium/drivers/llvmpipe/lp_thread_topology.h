@@ -0,0 +1,51 @@
+/**************************************************************************
+ *
+ * Copyright 2022 Red Hat.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **************************************************************************/
+
+/* Placement of the rasterizer and compute threads on the CPU topology.
+ *
+ * With LP_PIN_THREADS=true, threads are split into locality domains, one
+ * per L3 cache (which is also one per NUMA node, or finer), and pinned to
+ * the CPUs of their domain.  Threads of a domain rasterize a contiguous
+ * range of tiles first, so the pages backing that part of the framebuffer
+ * get first-touched by, and stay local to, the same domain.
+ */
+#ifndef LP_THREAD_TOPOLOGY_H
+#define LP_THREAD_TOPOLOGY_H
+
+#include "util/u_thread.h"
+
+unsigned
+lp_thread_num_domains(unsigned num_threads);
+
+static inline unsigned
+lp_thread_domain(unsigned thread, unsigned num_threads, unsigned num_domains)
+{
+   return num_threads ? thread * num_domains / num_threads : 0;
+}
+
+void
+lp_thread_pin(thrd_t thread, unsigned domain);
+
+#endif /* LP_THREAD_TOPOLOGY_H */
@@ -4432,6 +4432,230 @@ SchedDataCalculatorGM107::visit(BasicBlock *bb)
    return true;
 }
 
+/*******************************************************************************
+ * list scheduler
+ ******************************************************************************/
+
+// Upper bound on the number of instructions reordered together, building the
+// dependency graph is quadratic.
+#define GM107_SCHED_MAX_REGION 256
+
+// Instructions which are kept in place, the instructions between two of them
+// are scheduled independently.
+bool
+SchedulerGM107::isSchedBarrier(const Instruction *insn) const
+{
+   if (insn->fixed || insn->join || insn->exit || insn->asFlow())
+      return true;
+
+   switch (Target::getOpClass(insn->op)) {
+   case OPCLASS_MOVE:
+   case OPCLASS_LOAD:
+   case OPCLASS_STORE:
+   case OPCLASS_ARITH:
+   case OPCLASS_SHIFT:
+   case OPCLASS_SFU:
+   case OPCLASS_LOGIC:
+   case OPCLASS_COMPARE:
+   case OPCLASS_CONVERT:
+   case OPCLASS_ATOMIC:
+   case OPCLASS_TEXTURE:
+   case OPCLASS_SURFACE:
+   case OPCLASS_BITFIELD:
+      return false;
+   default:
+      return true;
+   }
+}
+
+bool
+SchedulerGM107::writesMemory(const Instruction *insn) const
+{
+   switch (Target::getOpClass(insn->op)) {
+   case OPCLASS_STORE:
+   case OPCLASS_ATOMIC:
+      return true;
+   case OPCLASS_SURFACE:
+      return insn->op != OP_SULDB && insn->op != OP_SULDP;
+   default:
+      return false;
+   }
+}
+
+bool
+SchedulerGM107::readsMemory(const Instruction *insn) const
+{
+   switch (Target::getOpClass(insn->op)) {
+   case OPCLASS_LOAD:
+   case OPCLASS_TEXTURE:
+   case OPCLASS_ATOMIC:
+   case OPCLASS_SURFACE:
+      return true;
+   default:
+      return false;
+   }
+}
+
+// Variable latency instructions are waited on with a barrier, so their real
+// latency is unknown. Use a rough estimate to leave room for other work
+// between them and their first use.
+int
+SchedulerGM107::getResultLatency(const Instruction *insn) const
+{
+   if (!targ->isBarrierRequired(insn))
+      return targ->getLatency(insn);
+
+   switch (Target::getOpClass(insn->op)) {
+   case OPCLASS_LOAD:
+   case OPCLASS_TEXTURE:
+   case OPCLASS_SURFACE:
+   case OPCLASS_ATOMIC:
+      return 40;
+   default:
+      return 20;
+   }
+}
+
+// Top-down list scheduling of a run of instructions which doesn't contain any
+// schedule barrier. Instructions ready to issue are picked by the length of
+// their critical path, the others by the cycle they become ready at.
+void
+SchedulerGM107::scheduleRegion(BasicBlock *bb,
+                               std::vector<Instruction *> &insns,
+                               Instruction *next)
+{
+   const int n = insns.size();
+
+   if (n < 3)
+      return;
+
+   std::vector<Node> nodes(n);
+
+   for (int j = 0; j < n; ++j) {
+      Instruction *b = insns[j];
+
+      nodes[j].insn = b;
+      nodes[j].ready = 0;
+      nodes[j].numPreds = 0;
+
+      for (int i = 0; i < j; ++i) {
+         const Instruction *a = insns[i];
+         int lat;
+
+         if (!a->canCommuteDefSrc(b))
+            lat = getResultLatency(a);
+         else
+         if (!a->canCommuteDefDef(b) || !b->canCommuteDefSrc(a) ||
+             (writesMemory(a) && (readsMemory(b) || writesMemory(b))) ||
+             (readsMemory(a) && writesMemory(b)))
+            lat = 1;
+         else
+            continue;
+
+         nodes[i].succs.push_back(std::make_pair(j, lat));
+         nodes[j].numPreds++;
+      }
+   }
+
+   for (int i = n - 1; i >= 0; --i) {
+      nodes[i].height = 0;
+      for (size_t s = 0; s < nodes[i].succs.size(); ++s) {
+         const std::pair<int, int> &e = nodes[i].succs[s];
+         nodes[i].height = MAX2(nodes[i].height, e.second + nodes[e.first].height);
+      }
+   }
+
+   std::vector<int> ready, order;
+   bool changed = false;
+   int cycle = 0;
+
+   for (int i = 0; i < n; ++i)
+      if (!nodes[i].numPreds)
+         ready.push_back(i);
+
+   while (!ready.empty()) {
+      size_t best = 0;
+
+      for (size_t r = 1; r < ready.size(); ++r) {
+         const Node &x = nodes[ready[r]];
+         const Node &y = nodes[ready[best]];
+         const bool xReady = x.ready <= cycle;
+         const bool yReady = y.ready <= cycle;
+
+         if (xReady != yReady) {
+            if (xReady)
+               best = r;
+         } else
+         if (!xReady && x.ready != y.ready) {
+            if (x.ready < y.ready)
+               best = r;
+         } else
+         if (x.height != y.height) {
+            if (x.height > y.height)
+               best = r;
+         } else
+         if (ready[r] < ready[best]) {
+            best = r;
+         }
+      }
+
+      const int k = ready[best];
+      ready.erase(ready.begin() + best);
+
+      changed |= k != (int)order.size();
+      order.push_back(k);
+
+      const int issue = MAX2(cycle, nodes[k].ready);
+      cycle = issue + 1;
+
+      for (size_t s = 0; s < nodes[k].succs.size(); ++s) {
+         Node &succ = nodes[nodes[k].succs[s].first];
+         succ.ready = MAX2(succ.ready, issue + nodes[k].succs[s].second);
+         if (!--succ.numPreds)
+            ready.push_back(nodes[k].succs[s].first);
+      }
+   }
+   assert((int)order.size() == n);
+
+   if (!changed)
+      return;
+
+   for (int i = 0; i < n; ++i)
+      bb->remove(insns[i]);
+   for (int i = 0; i < n; ++i) {
+      if (next)
+         bb->insertBefore(next, insns[order[i]]);
+      else
+         bb->insertTail(insns[order[i]]);
+   }
+}
+
+bool
+SchedulerGM107::visit(BasicBlock *bb)
+{
+   std::vector<Instruction *> region;
+   Instruction *insn, *next;
+
+   for (insn = bb->getEntry(); insn; insn = next) {
+      next = insn->next;
+
+      if (isSchedBarrier(insn)) {
+         scheduleRegion(bb, region, insn);
+         region.clear();
+         continue;
+      }
+
+      region.push_back(insn);
+      if (region.size() == GM107_SCHED_MAX_REGION) {
+         scheduleRegion(bb, region, next);
+         region.clear();
+      }
+   }
+   scheduleRegion(bb, region, NULL);
+
+   return true;
+}
+
 /*******************************************************************************
  * main
  ******************************************************************************/
@@ -4440,6 +4664,12 @@ void
 CodeEmitterGM107::prepareEmission(Function *func)
 {
    SchedDataCalculatorGM107 sched(targGM107);
+
+   if (debug_get_bool_option("NV50_PROG_SCHED", true)) {
+      SchedulerGM107 list(targGM107);
+      list.run(func, true, true);
+   }
+
    CodeEmitter::prepareEmission(func);
    sched.run(func, true, true);
 }
@@ -152,5 +152,34 @@ private:
    bool needWrDepBar(const Instruction *) const;
 };
 
+// Reorders the instructions of each basic block after RA so that the issue
+// delays computed by SchedDataCalculatorGM107 are filled with independent work.
+class SchedulerGM107 : public Pass
+{
+public:
+   SchedulerGM107(const TargetGM107 *targ) : targ(targ) {}
+
+private:
+   struct Node
+   {
+      Instruction *insn;
+      int height;   // latency weighted length of the longest path to the end
+      int ready;    // earliest cycle the instruction can issue at
+      int numPreds; // number of predecessors not yet scheduled
+      std::vector<std::pair<int, int> > succs; // (node, latency)
+   };
+
+   const TargetGM107 *targ;
+   bool visit(BasicBlock *);
+
+   void scheduleRegion(BasicBlock *, std::vector<Instruction *>&,
+                       Instruction *);
+
+   bool isSchedBarrier(const Instruction *) const;
+   bool readsMemory(const Instruction *) const;
+   bool writesMemory(const Instruction *) const;
+   int getResultLatency(const Instruction *) const;
+};
+
 }; // namespace nv50_ir
 #endif
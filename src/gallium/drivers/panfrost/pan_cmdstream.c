@@ -3483,11 +3483,23 @@ panfrost_direct_draw(struct panfrost_batch *batch,
                 panfrost_update_shader_variant(ctx, PIPE_SHADER_FRAGMENT);
         }
 
+        /* Only dirty the draw parameters when they change, so that the
+         * uniforms of shaders reading them aren't uploaded again for every
+         * draw of a run with identical parameters. An indirect draw patches
+         * the uniforms it emitted, so the ones after it must be new.
+         */
+        unsigned base_vertex = info->index_size ? draw->index_bias : 0;
+        if (ctx->indirect_draw || ctx->base_vertex != base_vertex ||
+            ctx->base_instance != info->start_instance)
+                ctx->dirty |= PAN_DIRTY_PARAMS;
+        if (ctx->indirect_draw || ctx->drawid != drawid_offset)
+                ctx->dirty |= PAN_DIRTY_DRAWID;
+
         /* Take into account a negative bias */
         ctx->indirect_draw = false;
         ctx->vertex_count = draw->count + (info->index_size ? abs(draw->index_bias) : 0);
         ctx->instance_count = info->instance_count;
-        ctx->base_vertex = info->index_size ? draw->index_bias : 0;
+        ctx->base_vertex = base_vertex;
         ctx->base_instance = info->start_instance;
         ctx->active_prim = info->mode;
         ctx->drawid = drawid_offset;
@@ -3515,6 +3527,7 @@ panfrost_direct_draw(struct panfrost_batch *batch,
         unsigned vertex_count = ctx->vertex_count;
 
         unsigned min_index = 0, max_index = 0;
+        unsigned offset_start;
         mali_ptr indices = 0;
 
         if (info->index_size) {
@@ -3524,11 +3537,15 @@ panfrost_direct_draw(struct panfrost_batch *batch,
 
                 /* Use the corresponding values */
                 vertex_count = max_index - min_index + 1;
-                ctx->offset_start = min_index + draw->index_bias;
+                offset_start = min_index + draw->index_bias;
         } else {
-                ctx->offset_start = draw->start;
+                offset_start = draw->start;
         }
 
+        if (ctx->offset_start != offset_start)
+                ctx->dirty |= PAN_DIRTY_PARAMS;
+        ctx->offset_start = offset_start;
+
         if (info->instance_count > 1) {
                 unsigned count = vertex_count;
 
@@ -3858,13 +3875,13 @@ panfrost_draw_vbo(struct pipe_context *pipe,
         if (unlikely(dev->debug & PAN_DBG_DIRTY))
                 panfrost_dirty_state_all(ctx);
 
-        /* Conservatively assume draw parameters always change */
-        ctx->dirty |= PAN_DIRTY_PARAMS | PAN_DIRTY_DRAWID;
-
         if (indirect) {
                 assert(num_draws == 1);
                 assert(PAN_GPU_INDIRECTS);
 
+                /* The parameters come from the GPU, assume they change */
+                ctx->dirty |= PAN_DIRTY_PARAMS | PAN_DIRTY_DRAWID;
+
 #if PAN_GPU_INDIRECTS
                 if (indirect->count_from_stream_output) {
                         struct pipe_draw_start_count_bias tmp_draw = *draws;
@@ -3889,10 +3906,8 @@ panfrost_draw_vbo(struct pipe_context *pipe,
         for (unsigned i = 0; i < num_draws; i++) {
                 panfrost_direct_draw(batch, &tmp_info, drawid, &draws[i]);
 
-                if (tmp_info.increment_draw_id) {
-                        ctx->dirty |= PAN_DIRTY_DRAWID;
+                if (tmp_info.increment_draw_id)
                         drawid++;
-                }
         }
 
 }
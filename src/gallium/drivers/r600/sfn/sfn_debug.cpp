@@ -59,6 +59,7 @@ static const struct debug_named_value sfn_debug_options[] = {
    {"flow", SfnLog::flow, "Log Flow instructions"},
    {"merge", SfnLog::merge, "Log register merge operations"},
    {"nomerge", SfnLog::nomerge, "Skip register merge step"},
+   {"nopack", SfnLog::nopack, "Skip reordering ALU groups for packing"},
    {"tex", SfnLog::tex, "Log texture ops"},
    {"trans", SfnLog::trans, "Log generic translation messages"},
    DEBUG_NAMED_VALUE_END
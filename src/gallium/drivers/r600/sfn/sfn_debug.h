@@ -66,6 +66,7 @@ public:
       trans = 1 << 12,
       all = (1 << 13) - 1,
       nomerge = 1 << 16,
+      nopack = 1 << 17,
    };
 
    SfnLog();
@@ -1,4 +1,7 @@
 #include "sfn_instruction_block.h"
+#include "sfn_instruction_alu.h"
+
+#include <set>
 
 namespace r600 {
 
@@ -21,6 +24,216 @@ void InstructionBlock::remap_registers(ValueRemapper& map)
       i->remap_registers(map);
 }
 
+namespace {
+
+/* A run of ALU instructions closed by one with the last flag set, or any
+ * other instruction, which is never moved */
+struct AluGroupInfo {
+   std::vector<PInstruction> instr;
+   std::set<std::pair<uint32_t, uint32_t>> reads;
+   std::set<std::pair<uint32_t, uint32_t>> writes;
+   unsigned chan_mask = 0;
+   bool movable = false;
+};
+
+bool alu_op_is_movable(EAluOp opcode)
+{
+   if (opcode >= op2_pred_setgt_uint && opcode <= op2_pred_setle_push_int &&
+       (opcode <= op2_killne || opcode >= op2_killgt_uint))
+      return false;
+
+   switch (opcode) {
+   case op0_group_barrier:
+   case op0_group_seq_begin:
+   case op0_group_seq_end:
+   case op2_set_mode:
+   case op1_set_cf_idx0:
+   case op1_set_cf_idx1:
+   case op2_set_lds_size:
+   case op2_pred_setgt_64:
+   case op2_pred_sete_64:
+   case op2_pred_setge_64:
+   case op1_mova_int:
+   case op1_bcnt_accum_prev_int:
+   case op1_mbcnt_32lo_accum_prev_int:
+   case op2_sad_accum_prev_uint:
+   case op2_mul_prev:
+   case op2_mul_ieee_prev:
+   case op2_add_prev:
+   case op2_muladd_prev:
+   case op2_muladd_ieee_prev:
+   case op2_interp_xy:
+   case op2_interp_zw:
+   case op2_interp_x:
+   case op2_interp_z:
+   case op0_store_flags:
+   case op1_load_store_flags:
+   case op0_lds_1a:
+   case op0_lds_1a1d:
+   case op0_lds_2a:
+   case op3_lds_idx_op:
+      return false;
+   default:
+      return true;
+   }
+}
+
+bool alu_src_is_movable(const Value& v)
+{
+   switch (v.type()) {
+   case Value::gpr:
+   case Value::literal:
+      return true;
+   case Value::kconst:
+      return !static_cast<const UniformValue&>(v).addr();
+   case Value::cinline:
+      /* Only the real constants, the others read hardware state or the
+       * results of the previous group */
+      return v.sel() >= ALU_SRC_1_DBL_L && v.sel() <= ALU_SRC_0_5;
+   default:
+      return false;
+   }
+}
+
+void add_alu_to_group(AluGroupInfo& group, const AluInstruction& alu)
+{
+   if (!alu_op_is_movable(alu.opcode()) ||
+       alu.cf_type() != cf_alu ||
+       alu.flag(alu_update_exec) || alu.flag(alu_update_pred) ||
+       alu.flag(alu_dst_rel))
+      group.movable = false;
+
+   for (unsigned i = 0; i < alu.n_sources(); ++i) {
+      auto& s = alu.src(i);
+      if (!alu_src_is_movable(s))
+         group.movable = false;
+      else if (s.type() == Value::gpr)
+         group.reads.insert(std::make_pair(s.sel(), s.chan()));
+   }
+
+   auto dst = alu.dest();
+   if (dst) {
+      if (dst->type() != Value::gpr) {
+         group.movable = false;
+      } else {
+         /* Only groups that fill one vector slot per instruction are
+          * packed, so that the merged group is known to fit */
+         unsigned chan_bit = 1 << dst->chan();
+         if ((group.chan_mask & chan_bit) ||
+             !alu_ops.at(alu.opcode()).can_channel(chan_bit))
+            group.movable = false;
+         group.chan_mask |= chan_bit;
+         if (alu.flag(alu_write))
+            group.writes.insert(std::make_pair(dst->sel(), dst->chan()));
+      }
+   } else {
+      group.movable = false;
+   }
+}
+
+template <typename T>
+bool intersects(const std::set<T>& a, const std::set<T>& b)
+{
+   for (auto& x : a)
+      if (b.find(x) != b.end())
+         return true;
+   return false;
+}
+
+/* Whether b can be moved in front of a, or be issued in the same group */
+bool groups_independent(const AluGroupInfo& a, const AluGroupInfo& b)
+{
+   return !intersects(a.writes, b.reads) &&
+         !intersects(a.reads, b.writes) &&
+         !intersects(a.writes, b.writes);
+}
+
+}
+
+void InstructionBlock::pack_alu_groups(unsigned max_slots)
+{
+   /* How many groups to look ahead for a partner of a group */
+   const unsigned window = 8;
+
+   std::vector<AluGroupInfo> groups;
+   bool in_group = false;
+
+   for (auto& i : m_block) {
+      if (i->type() != Instruction::alu) {
+         groups.emplace_back();
+         groups.back().instr.push_back(i);
+         in_group = false;
+         continue;
+      }
+
+      if (!in_group) {
+         groups.emplace_back();
+         groups.back().movable = true;
+         in_group = true;
+      }
+
+      auto& alu = static_cast<const AluInstruction&>(*i);
+      groups.back().instr.push_back(i);
+      add_alu_to_group(groups.back(), alu);
+      if (alu.flag(alu_last_instr))
+         in_group = false;
+   }
+
+   /* An ALU instruction without the last flag at the end of the block would
+    * be merged with whatever follows it, keep it in place */
+   if (in_group)
+      groups.back().movable = false;
+
+   bool progress = false;
+
+   for (unsigned i = 0; i < groups.size(); ++i) {
+      if (!groups[i].movable)
+         continue;
+
+      /* The groups i..last will end up merged into one */
+      AluGroupInfo packed = groups[i];
+      unsigned last = i;
+
+      for (unsigned j = i + 1; j < groups.size() && j <= last + window; ++j) {
+         if (!groups[j].movable)
+            break;
+
+         if (packed.instr.size() + groups[j].instr.size() > max_slots ||
+             (packed.chan_mask & groups[j].chan_mask) ||
+             !groups_independent(packed, groups[j]))
+            continue;
+
+         /* The groups in between must not depend on the candidate */
+         bool blocked = false;
+         for (unsigned k = last + 1; k < j && !blocked; ++k)
+            blocked = !groups_independent(groups[k], groups[j]);
+         if (blocked)
+            continue;
+
+         AluGroupInfo moved = groups[j];
+         groups.erase(groups.begin() + j);
+         groups.insert(groups.begin() + last + 1, moved);
+         ++last;
+
+         packed.chan_mask |= moved.chan_mask;
+         packed.instr.insert(packed.instr.end(), moved.instr.begin(),
+                             moved.instr.end());
+         packed.reads.insert(moved.reads.begin(), moved.reads.end());
+         packed.writes.insert(moved.writes.begin(), moved.writes.end());
+         progress = true;
+      }
+
+      i = last;
+   }
+
+   if (!progress)
+      return;
+
+   m_block.clear();
+   for (auto& g : groups)
+      m_block.insert(m_block.end(), g.instr.begin(), g.instr.end());
+}
+
 void InstructionBlock::do_evalue_liveness(LiverangeEvaluator& eval) const
 {
    for(auto& i: m_block)
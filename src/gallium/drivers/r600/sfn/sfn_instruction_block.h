@@ -49,6 +49,10 @@ public:
 
         void remap_registers(ValueRemapper& map);
 
+        /* Move independent ALU groups next to each other so that the
+         * assembler can merge them into one instruction group */
+        void pack_alu_groups(unsigned max_slots);
+
         size_t size() const {
            return m_block.size();
         }
@@ -179,6 +179,9 @@ bool ShaderFromNir::lower(const nir_shader *shader, r600_pipe_shader *pipe_shade
       impl->remap_registers();
    }
 
+   if (!sfn_log.has_debug_flag(SfnLog::nopack))
+      impl->pack_alu_groups();
+
    sfn_log << SfnLog::trans << "Finished translating to R600 IR\n";
    return true;
 }
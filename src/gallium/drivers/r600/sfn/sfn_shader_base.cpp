@@ -244,6 +244,13 @@ void ShaderFromNirProcessor::remap_registers()
    remap_shader_info(m_sh_info, register_map, temp_register_map);
 }
 
+void ShaderFromNirProcessor::pack_alu_groups()
+{
+   unsigned max_slots = m_chip_class == CAYMAN ? 4 : 5;
+   for (auto& block: m_output)
+      block.pack_alu_groups(max_slots);
+}
+
 bool ShaderFromNirProcessor::process_uniforms(nir_variable *uniform)
 {
    // m_uniform_type_map
@@ -75,6 +75,7 @@ public:
 
    void split_constants(nir_alu_instr* instr);
    void remap_registers();
+   void pack_alu_groups();
 
    const nir_variable *get_deref_location(const nir_src& src) const;
 
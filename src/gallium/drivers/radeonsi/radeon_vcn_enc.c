@@ -409,11 +409,15 @@ static void radeon_enc_encode_bitstream(struct pipe_video_codec *encoder,
    enc->get_buffer(destination, &enc->bs_handle, NULL);
    enc->bs_size = destination->width0;
 
-   *fb = enc->fb = CALLOC_STRUCT(rvid_buffer);
-
-   if (!si_vid_create_buffer(enc->screen, enc->fb, 4096, PIPE_USAGE_STAGING)) {
-      RVID_ERR("Can't create feedback buffer.\n");
-      return;
+   if (enc->num_fb_cache) {
+      *fb = enc->fb = enc->fb_cache[--enc->num_fb_cache];
+   } else {
+      *fb = enc->fb = CALLOC_STRUCT(rvid_buffer);
+
+      if (!si_vid_create_buffer(enc->screen, enc->fb, 4096, PIPE_USAGE_STAGING)) {
+         RVID_ERR("Can't create feedback buffer.\n");
+         return;
+      }
    }
 
    enc->need_feedback = true;
@@ -451,6 +455,11 @@ static void radeon_enc_destroy(struct pipe_video_codec *encoder)
       FREE(enc->efc);
       enc->efc = NULL;
    }
+   while (enc->num_fb_cache) {
+      struct rvid_buffer *fb = enc->fb_cache[--enc->num_fb_cache];
+      si_vid_destroy_buffer(fb);
+      FREE(fb);
+   }
    si_vid_destroy_buffer(&enc->cpb);
    enc->ws->cs_destroy(&enc->cs);
    FREE(enc);
@@ -469,6 +478,17 @@ static void radeon_enc_get_feedback(struct pipe_video_codec *encoder, void *feed
          *size = ptr[6];
       else
          *size = 0;
+
+      /* The map waited for the encode to finish, so the buffer is idle and
+       * can be reused once the status from this frame is cleared.
+       */
+      if (enc->num_fb_cache < ARRAY_SIZE(enc->fb_cache)) {
+         memset(ptr, 0, fb->res->buf->size);
+         enc->ws->buffer_unmap(enc->ws, fb->res->buf);
+         enc->fb_cache[enc->num_fb_cache++] = fb;
+         return;
+      }
+
       enc->ws->buffer_unmap(enc->ws, fb->res->buf);
    }
 
@@ -30,6 +30,8 @@
 
 #include "radeon_video.h"
 
+#define RADEON_ENC_FB_CACHE_SIZE                                                    4
+
 #define RENCODE_IB_OP_INITIALIZE                                                    0x01000001
 #define RENCODE_IB_OP_CLOSE_SESSION                                                 0x01000002
 #define RENCODE_IB_OP_ENCODE                                                        0x01000003
@@ -615,6 +617,9 @@ struct radeon_encoder {
 
    struct rvid_buffer *si;
    struct rvid_buffer *fb;
+   /* Idle feedback buffers kept around for the next frames */
+   struct rvid_buffer *fb_cache[RADEON_ENC_FB_CACHE_SIZE];
+   unsigned num_fb_cache;
    struct rvid_buffer cpb;
    struct radeon_enc_pic enc_pic;
    rvcn_enc_cmd_t cmd;
@@ -80,6 +80,7 @@ static const struct debug_named_value radeonsi_debug_options[] = {
    {"compute", DBG(COMPUTE), "Print compute info"},
    {"vm", DBG(VM), "Print virtual addresses when creating resources"},
    {"cache_stats", DBG(CACHE_STATS), "Print shader cache statistics."},
+   {"tier_stats", DBG(TIER_STATS), "Print how long split and monolithic shader variants were used."},
    {"ib", DBG(IB), "Print command buffers."},
 
    /* Driver options: */
@@ -905,6 +906,12 @@ static void si_destroy_screen(struct pipe_screen *pscreen)
              sscreen->num_disk_shader_cache_misses);
    }
 
+   if (sscreen->debug_flags & DBG(TIER_STATS)) {
+      printf("shader tiers: split = %.1f ms, monolithic = %.1f ms, promoted shaders = %u\n",
+             sscreen->split_shader_time / 1000000.0, sscreen->mono_shader_time / 1000000.0,
+             sscreen->num_promoted_shaders);
+   }
+
    si_resource_reference(&sscreen->attribute_ring, NULL);
 
    simple_mtx_destroy(&sscreen->aux_context_lock);
@@ -230,6 +230,7 @@ enum
    DBG_COMPUTE,
    DBG_VM,
    DBG_CACHE_STATS,
+   DBG_TIER_STATS,
    DBG_IB,
 
    /* Driver options: */
@@ -628,6 +629,13 @@ struct si_screen {
    unsigned num_disk_shader_cache_hits;
    unsigned num_disk_shader_cache_misses;
 
+   /* Time that split shaders (main part + prolog/epilog) were in use before and after
+    * their monolithic variant replaced them, in nanoseconds. See si_shader_select_with_key.
+    */
+   uint64_t split_shader_time;
+   uint64_t mono_shader_time;
+   unsigned num_promoted_shaders;
+
    /* GPU load thread. */
    simple_mtx_t gpu_load_mutex;
    thrd_t gpu_load_thread;
@@ -91,6 +91,10 @@ static enum radeon_value_id winsys_id_from_type(unsigned type)
       return RADEON_GFX_BO_LIST_COUNTER;
    case SI_QUERY_GFX_IB_SIZE:
       return RADEON_GFX_IB_SIZE_COUNTER;
+   case SI_QUERY_CS_BO_LIST_TIME:
+      return RADEON_CS_BO_LIST_TIME_NS;
+   case SI_QUERY_CS_IOCTL_TIME:
+      return RADEON_CS_IOCTL_TIME_NS;
    case SI_QUERY_NUM_BYTES_MOVED:
       return RADEON_NUM_BYTES_MOVED;
    case SI_QUERY_NUM_EVICTIONS:
@@ -190,6 +194,8 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
       query->begin_result = 0;
       break;
    case SI_QUERY_BUFFER_WAIT_TIME:
+   case SI_QUERY_CS_BO_LIST_TIME:
+   case SI_QUERY_CS_IOCTL_TIME:
    case SI_QUERY_GFX_IB_SIZE:
    case SI_QUERY_NUM_GFX_IBS:
    case SI_QUERY_NUM_BYTES_MOVED:
@@ -345,6 +351,8 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_CURRENT_GPU_SCLK:
    case SI_QUERY_CURRENT_GPU_MCLK:
    case SI_QUERY_BUFFER_WAIT_TIME:
+   case SI_QUERY_CS_BO_LIST_TIME:
+   case SI_QUERY_CS_IOCTL_TIME:
    case SI_QUERY_GFX_IB_SIZE:
    case SI_QUERY_NUM_MAPPED_BUFFERS:
    case SI_QUERY_NUM_GFX_IBS:
@@ -482,6 +490,8 @@ static bool si_query_sw_get_result(struct si_context *sctx, struct si_query *squ
 
    switch (query->b.type) {
    case SI_QUERY_BUFFER_WAIT_TIME:
+   case SI_QUERY_CS_BO_LIST_TIME:
+   case SI_QUERY_CS_IOCTL_TIME:
    case SI_QUERY_GPU_TEMPERATURE:
       result->u64 /= 1000;
       break;
@@ -1771,6 +1781,8 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("num-GFX-IBs", NUM_GFX_IBS, UINT64, AVERAGE),
    X("GFX-BO-list-size", GFX_BO_LIST_SIZE, UINT64, AVERAGE),
    X("GFX-IB-size", GFX_IB_SIZE, UINT64, AVERAGE),
+   X("CS-BO-list-time", CS_BO_LIST_TIME, MICROSECONDS, CUMULATIVE),
+   X("CS-ioctl-time", CS_IOCTL_TIME, MICROSECONDS, CUMULATIVE),
    X("num-bytes-moved", NUM_BYTES_MOVED, BYTES, CUMULATIVE),
    X("num-evictions", NUM_EVICTIONS, UINT64, CUMULATIVE),
    X("VRAM-CPU-page-faults", NUM_VRAM_CPU_PAGE_FAULTS, UINT64, CUMULATIVE),
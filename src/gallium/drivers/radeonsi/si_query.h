@@ -73,6 +73,8 @@ enum
    SI_QUERY_NUM_GFX_IBS,
    SI_QUERY_GFX_BO_LIST_SIZE,
    SI_QUERY_GFX_IB_SIZE,
+   SI_QUERY_CS_BO_LIST_TIME,
+   SI_QUERY_CS_IOCTL_TIME,
    SI_QUERY_NUM_BYTES_MOVED,
    SI_QUERY_NUM_EVICTIONS,
    SI_QUERY_NUM_VRAM_CPU_PAGE_FAULTS,
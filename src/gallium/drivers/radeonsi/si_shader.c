@@ -34,6 +34,7 @@
 #include "sid.h"
 #include "tgsi/tgsi_from_mesa.h"
 #include "tgsi/tgsi_strings.h"
+#include "util/os_time.h"
 #include "util/u_memory.h"
 #include "util/mesa-sha1.h"
 
@@ -1080,6 +1081,13 @@ void si_shader_dump_stats_for_shader_db(struct si_screen *screen, struct si_shad
                       shader->selector->info.base.num_inlinable_uniforms,
                       shader->info.nr_param_exports,
                       stages[shader->selector->stage], shader->wave_size);
+
+   /* Reported separately so that the stats above stay deterministic across runs. */
+   if (shader->compile_time_us) {
+      util_debug_message(debug, SHADER_INFO, "Shader Compile Time: %u us (%s, W%u)",
+                         shader->compile_time_us, stages[shader->selector->stage],
+                         shader->wave_size);
+   }
 }
 
 static void si_shader_dump_stats(struct si_screen *sscreen, struct si_shader *shader, FILE *file,
@@ -1680,6 +1688,7 @@ bool si_compile_shader(struct si_screen *sscreen, struct ac_llvm_compiler *compi
                        struct si_shader *shader, struct util_debug_callback *debug)
 {
    struct si_shader_selector *sel = shader->selector;
+   int64_t start_time = os_time_get_nano();
    bool free_nir;
    struct nir_shader *nir = si_get_nir_shader(sel, &shader->key, &free_nir);
 
@@ -1837,6 +1846,7 @@ bool si_compile_shader(struct si_screen *sscreen, struct ac_llvm_compiler *compi
    }
 
    si_calculate_max_simd_waves(shader);
+   shader->compile_time_us = (os_time_get_nano() - start_time) / 1000;
    si_shader_dump_stats_for_shader_db(sscreen, shader, debug);
    return true;
 }
@@ -831,6 +831,18 @@ struct si_shader {
    bool is_gs_copy_shader;
    uint8_t wave_size;
 
+   /* Tiered compilation of split shaders: after options.mono_variant_uses selections,
+    * a monolithic variant with the same key is compiled in the background and replaces
+    * this shader once it's ready.
+    */
+   struct si_shader *mono_variant;
+   unsigned num_uses;
+   int64_t time_created;
+   int64_t time_promoted;
+
+   /* Time spent in si_compile_shader, 0 if the binary came from a cache. */
+   unsigned compile_time_us;
+
    /* The following data is all that's needed for binary shaders. */
    struct si_shader_binary binary;
    struct ac_shader_config config;
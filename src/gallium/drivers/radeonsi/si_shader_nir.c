@@ -46,44 +46,45 @@ static bool si_alu_to_scalar_filter(const nir_instr *instr, const void *data)
 void si_nir_opts(struct si_screen *sscreen, struct nir_shader *nir, bool first)
 {
    bool progress;
+   struct set *skip = _mesa_pointer_set_create(NULL);
 
    do {
       progress = false;
       bool lower_alu_to_scalar = false;
       bool lower_phis_to_scalar = false;
 
-      NIR_PASS(progress, nir, nir_lower_vars_to_ssa);
-      NIR_PASS(progress, nir, nir_lower_alu_to_scalar, si_alu_to_scalar_filter, sscreen);
-      NIR_PASS(progress, nir, nir_lower_phis_to_scalar, false);
+      NIR_LOOP_PASS(progress, skip, nir, nir_lower_vars_to_ssa);
+      NIR_LOOP_PASS(progress, skip, nir, nir_lower_alu_to_scalar, si_alu_to_scalar_filter, sscreen);
+      NIR_LOOP_PASS(progress, skip, nir, nir_lower_phis_to_scalar, false);
 
       if (first) {
-         NIR_PASS(progress, nir, nir_split_array_vars, nir_var_function_temp);
-         NIR_PASS(lower_alu_to_scalar, nir, nir_shrink_vec_array_vars, nir_var_function_temp);
-         NIR_PASS(progress, nir, nir_opt_find_array_copies);
+         NIR_LOOP_PASS(progress, skip, nir, nir_split_array_vars, nir_var_function_temp);
+         NIR_LOOP_PASS(lower_alu_to_scalar, skip, nir, nir_shrink_vec_array_vars, nir_var_function_temp);
+         NIR_LOOP_PASS(progress, skip, nir, nir_opt_find_array_copies);
       }
-      NIR_PASS(progress, nir, nir_opt_copy_prop_vars);
-      NIR_PASS(progress, nir, nir_opt_dead_write_vars);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_copy_prop_vars);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_dead_write_vars);
 
-      NIR_PASS(lower_alu_to_scalar, nir, nir_opt_trivial_continues);
+      NIR_LOOP_PASS(lower_alu_to_scalar, skip, nir, nir_opt_trivial_continues);
       /* (Constant) copy propagation is needed for txf with offsets. */
-      NIR_PASS(progress, nir, nir_copy_prop);
-      NIR_PASS(progress, nir, nir_opt_remove_phis);
-      NIR_PASS(progress, nir, nir_opt_dce);
-      NIR_PASS(lower_phis_to_scalar, nir, nir_opt_if, true);
-      NIR_PASS(progress, nir, nir_opt_dead_cf);
+      NIR_LOOP_PASS(progress, skip, nir, nir_copy_prop);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_remove_phis);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_dce);
+      NIR_LOOP_PASS(lower_phis_to_scalar, skip, nir, nir_opt_if, true);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_dead_cf);
 
       if (lower_alu_to_scalar)
-         NIR_PASS_V(nir, nir_lower_alu_to_scalar, si_alu_to_scalar_filter, sscreen);
+         NIR_LOOP_PASS(progress, skip, nir, nir_lower_alu_to_scalar, si_alu_to_scalar_filter, sscreen);
       if (lower_phis_to_scalar)
-         NIR_PASS_V(nir, nir_lower_phis_to_scalar, false);
+         NIR_LOOP_PASS(progress, skip, nir, nir_lower_phis_to_scalar, false);
       progress |= lower_alu_to_scalar | lower_phis_to_scalar;
 
-      NIR_PASS(progress, nir, nir_opt_cse);
-      NIR_PASS(progress, nir, nir_opt_peephole_select, 8, true, true);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_cse);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_peephole_select, 8, true, true);
 
       /* Needed for algebraic lowering */
-      NIR_PASS(progress, nir, nir_opt_algebraic);
-      NIR_PASS(progress, nir, nir_opt_constant_folding);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_algebraic);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_constant_folding);
 
       if (!nir->info.flrp_lowered) {
          unsigned lower_flrp = (nir->options->lower_flrp16 ? 16 : 0) |
@@ -92,9 +93,9 @@ void si_nir_opts(struct si_screen *sscreen, struct nir_shader *nir, bool first)
          assert(lower_flrp);
          bool lower_flrp_progress = false;
 
-         NIR_PASS(lower_flrp_progress, nir, nir_lower_flrp, lower_flrp, false /* always_precise */);
+         NIR_LOOP_PASS(lower_flrp_progress, skip, nir, nir_lower_flrp, lower_flrp, false /* always_precise */);
          if (lower_flrp_progress) {
-            NIR_PASS(progress, nir, nir_opt_constant_folding);
+            NIR_LOOP_PASS(progress, skip, nir, nir_opt_constant_folding);
             progress = true;
          }
 
@@ -104,18 +105,21 @@ void si_nir_opts(struct si_screen *sscreen, struct nir_shader *nir, bool first)
          nir->info.flrp_lowered = true;
       }
 
-      NIR_PASS(progress, nir, nir_opt_undef);
-      NIR_PASS(progress, nir, nir_opt_conditional_discard);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_undef);
+      NIR_LOOP_PASS(progress, skip, nir, nir_opt_conditional_discard);
       if (nir->options->max_unroll_iterations) {
-         NIR_PASS(progress, nir, nir_opt_loop_unroll);
+         NIR_LOOP_PASS(progress, skip, nir, nir_opt_loop_unroll);
       }
 
-      if (nir->info.stage == MESA_SHADER_FRAGMENT)
-         NIR_PASS_V(nir, nir_opt_move_discards_to_top);
+      if (nir->info.stage == MESA_SHADER_FRAGMENT) {
+         UNUSED bool move_discards_progress = false;
+         NIR_LOOP_PASS(move_discards_progress, skip, nir, nir_opt_move_discards_to_top);
+      }
 
       if (sscreen->options.fp16)
-         NIR_PASS(progress, nir, nir_opt_vectorize, NULL, NULL);
+         NIR_LOOP_PASS(progress, skip, nir, nir_opt_vectorize, NULL, NULL);
    } while (progress);
+   _mesa_set_destroy(skip, NULL);
 
    NIR_PASS_V(nir, nir_lower_var_copies);
 }
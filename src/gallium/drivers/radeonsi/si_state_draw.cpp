@@ -51,6 +51,9 @@
 /* special primitive types */
 #define SI_PRIM_RECTANGLE_LIST PIPE_PRIM_MAX
 
+/* Direct multi-draws with at least this many draws are packed into an indirect multi-draw. */
+#define SI_MIN_PACKED_MULTI_DRAWS 16
+
 template<int NUM_INTERP>
 static void si_emit_spi_map(struct si_context *sctx)
 {
@@ -1440,6 +1443,54 @@ static void si_emit_draw_registers(struct si_context *sctx,
       }                                                                  \
    } while (0)
 
+/**
+ * Write the parameters of a direct multi-draw into an upload buffer in the layout of
+ * indirect draws, so that all of them can be executed by one DRAW_(INDEX_)INDIRECT_MULTI
+ * packet instead of one draw packet and user SGPR update per draw.
+ *
+ * Returns NULL if the allocation failed, in which case the draws should be emitted directly.
+ */
+static const struct pipe_draw_indirect_info *
+si_pack_multi_draw(struct si_context *sctx, const struct pipe_draw_info *info,
+                   const struct pipe_draw_start_count_bias *draws, unsigned num_draws,
+                   unsigned index_size, unsigned instance_count,
+                   struct pipe_draw_indirect_info *indirect, struct pipe_resource **buf)
+{
+   unsigned stride = (index_size ? 5 : 4) * sizeof(uint32_t);
+   unsigned offset;
+   uint32_t *ptr;
+
+   u_upload_alloc(sctx->b.stream_uploader, 0, num_draws * stride, 4, &offset, buf, (void **)&ptr);
+   if (unlikely(!*buf))
+      return NULL;
+
+   if (index_size) {
+      bool index_bias_varies = info->index_bias_varies;
+
+      for (unsigned i = 0; i < num_draws; i++) {
+         *ptr++ = draws[i].count;
+         *ptr++ = instance_count;
+         *ptr++ = draws[i].start;
+         *ptr++ = index_bias_varies ? draws[i].index_bias : draws[0].index_bias;
+         *ptr++ = info->start_instance;
+      }
+   } else {
+      for (unsigned i = 0; i < num_draws; i++) {
+         *ptr++ = draws[i].count;
+         *ptr++ = instance_count;
+         *ptr++ = draws[i].start;
+         *ptr++ = info->start_instance;
+      }
+   }
+
+   memset(indirect, 0, sizeof(*indirect));
+   indirect->buffer = *buf;
+   indirect->offset = offset;
+   indirect->stride = stride;
+   indirect->draw_count = num_draws;
+   return indirect;
+}
+
 template <amd_gfx_level GFX_VERSION, si_has_ngg NGG, si_is_draw_vertex_state IS_DRAW_VERTEX_STATE>
 ALWAYS_INLINE
 static void si_emit_draw_packets(struct si_context *sctx, const struct pipe_draw_info *info,
@@ -1560,8 +1611,25 @@ static void si_emit_draw_packets(struct si_context *sctx, const struct pipe_draw
    unsigned sh_base_reg = sctx->shader_pointers.sh_base[PIPE_SHADER_VERTEX];
    bool render_cond_bit = sctx->render_cond_enabled;
 
+   /* Long multi-draws whose draws differ in more than the index range are cheaper for both
+    * the CPU and the CP as one indirect multi-draw. The CP can only count DrawID from 0, so
+    * that must be what the shader expects if it reads it. GFX10+ only, because IA_MULTI_VGT_PARAM
+    * on older chips was already computed for a direct draw.
+    */
+   struct pipe_draw_indirect_info packed_indirect;
+   struct pipe_resource *packed_buf = NULL;
+
+   if (GFX_VERSION >= GFX10 && !IS_DRAW_VERTEX_STATE && !indirect && !use_opaque &&
+       num_draws >= SI_MIN_PACKED_MULTI_DRAWS && sctx->screen->has_draw_indirect_multi &&
+       !sctx->num_vs_blit_sgprs &&
+       (!sctx->vs_uses_draw_id || (info->increment_draw_id && !drawid_base)) &&
+       (!index_size || info->index_bias_varies || sctx->vs_uses_draw_id)) {
+      indirect = si_pack_multi_draw(sctx, info, draws, num_draws, index_size, instance_count,
+                                    &packed_indirect, &packed_buf);
+   }
+
    if (!IS_DRAW_VERTEX_STATE && indirect) {
-      assert(num_draws == 1);
+      assert(num_draws == 1 || packed_buf);
       uint64_t indirect_va = si_resource(indirect->buffer)->gpu_address;
 
       assert(indirect_va % 8 == 0);
@@ -1808,6 +1876,9 @@ static void si_emit_draw_packets(struct si_context *sctx, const struct pipe_draw
    }
    radeon_end();
 
+   /* The buffer list holds the reference now. */
+   pipe_resource_reference(&packed_buf, NULL);
+
    EMIT_SQTT_END_DRAW;
 }
 
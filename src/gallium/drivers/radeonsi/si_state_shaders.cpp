@@ -32,6 +32,7 @@
 #include "util/disk_cache.h"
 #include "util/hash_table.h"
 #include "util/mesa-sha1.h"
+#include "util/os_time.h"
 #include "util/u_async_debug.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
@@ -2543,6 +2544,68 @@ use_local_key_copy(const SHADER_KEY_TYPE *key, SHADER_KEY_TYPE *local_key, unsig
    return local_key;
 }
 
+/**
+ * Tiered compilation: split shaders (main part + prolog/epilog) are quick to build, but
+ * a monolithic shader compiled with the same key can be optimized across the parts.
+ * Once a split shader has been selected often enough, build its monolithic variant on
+ * the low priority queue and switch to it when it's ready.
+ */
+static void si_shader_check_mono_variant(struct si_context *sctx, struct si_shader_ctx_state *state,
+                                         struct si_shader *shader)
+{
+   struct si_screen *sscreen = sctx->screen;
+   struct si_shader_selector *sel = shader->selector;
+   struct si_shader *mono = (struct si_shader *)p_atomic_read(&shader->mono_variant);
+
+   if (mono) {
+      if (util_queue_fence_is_signalled(&mono->ready) && !mono->compilation_failed) {
+         state->current = mono;
+         if (p_atomic_cmpxchg(&shader->time_promoted, 0, os_time_get_nano()) == 0)
+            p_atomic_inc(&sscreen->num_promoted_shaders);
+      }
+      return;
+   }
+
+   if (p_atomic_inc_return(&shader->num_uses) != (unsigned)sscreen->options.mono_variant_uses)
+      return;
+
+   mono = CALLOC_STRUCT(si_shader);
+   if (!mono)
+      return;
+
+   util_queue_fence_init(&mono->ready);
+   mono->selector = sel;
+   mono->key = shader->key;
+   mono->wave_size = shader->wave_size;
+   mono->compiler_ctx_state = shader->compiler_ctx_state;
+   mono->is_monolithic = true;
+   /* This is what makes si_delete_shader drop the job if it's still queued. */
+   mono->is_optimized = true;
+   si_shader_selector_reference(NULL, &mono->previous_stage_sel, shader->previous_stage_sel);
+
+   simple_mtx_lock(&sel->mutex);
+   if (sel->variants_count == sel->variants_max_count) {
+      sel->variants_max_count += 2;
+      sel->variants = (struct si_shader**)
+         realloc(sel->variants, sel->variants_max_count * sizeof(struct si_shader*));
+      sel->keys = (union si_shader_key*)
+         realloc(sel->keys, sel->variants_max_count * sizeof(union si_shader_key));
+   }
+
+   util_queue_add_job(&sscreen->shader_compiler_queue_low_priority, mono, &mono->ready,
+                      si_build_shader_variant_low_priority, NULL, 0);
+
+   /* It has the same key as the split shader, which is earlier in the list, so the
+    * variant search never returns it directly. It's only in the list to be freed with
+    * the selector.
+    */
+   sel->variants[sel->variants_count] = mono;
+   sel->keys[sel->variants_count] = mono->key;
+   sel->variants_count++;
+   p_atomic_set(&shader->mono_variant, mono);
+   simple_mtx_unlock(&sel->mutex);
+}
+
 #define NO_INLINE_UNIFORMS false
 
 /**
@@ -2605,7 +2668,12 @@ again:
          util_queue_fence_wait(&current->ready);
       }
 
-      return current->compilation_failed ? -1 : 0;
+      if (current->compilation_failed)
+         return -1;
+
+      if (unlikely(!current->is_monolithic && sscreen->options.mono_variant_uses > 0))
+         si_shader_check_mono_variant(sctx, state, current);
+      return 0;
    }
 current_not_ready:
 
@@ -2667,6 +2735,8 @@ current_not_ready:
          }
 
          state->current = sel->variants[i];
+         if (!iter->is_monolithic && sscreen->options.mono_variant_uses > 0)
+            si_shader_check_mono_variant(sctx, state, iter);
          return 0;
       }
    }
@@ -2801,6 +2871,9 @@ current_not_ready:
    /* Reset the fence before adding to the variant list. */
    util_queue_fence_reset(&shader->ready);
 
+   if (!shader->is_monolithic)
+      shader->time_created = os_time_get_nano();
+
    sel->variants[sel->variants_count] = shader;
    sel->keys[sel->variants_count] = shader->key;
    sel->variants_count++;
@@ -3563,6 +3636,14 @@ static void si_delete_shader(struct si_context *sctx, struct si_shader *shader)
       util_queue_drop_job(&sctx->screen->shader_compiler_queue_low_priority, &shader->ready);
    }
 
+   if (shader->time_created) {
+      int64_t now = os_time_get_nano();
+      int64_t promoted = shader->time_promoted ? shader->time_promoted : now;
+
+      p_atomic_add(&sctx->screen->split_shader_time, promoted - shader->time_created);
+      p_atomic_add(&sctx->screen->mono_shader_time, now - promoted);
+   }
+
    util_queue_fence_destroy(&shader->ready);
 
    /* If destroyed shaders were not unbound, the next compiled
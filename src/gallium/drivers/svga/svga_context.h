@@ -67,6 +67,7 @@ enum svga_hud {
    SVGA_QUERY_NUM_BUFFER_UPLOADS,
    SVGA_QUERY_NUM_CONST_BUF_UPDATES,
    SVGA_QUERY_NUM_CONST_UPDATES,
+   SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS,
    SVGA_QUERY_NUM_SHADER_RELOCATIONS,
    SVGA_QUERY_NUM_SURFACE_RELOCATIONS,
 
@@ -283,6 +284,7 @@ struct svga_velems_state {
 
 struct svga_constant_buffer {
    struct svga_winsys_surface *handle;
+   unsigned offset;
    unsigned size;
 };
 
@@ -717,6 +719,7 @@ struct svga_context
       uint64_t num_buffer_uploads;      /**< SVGA_QUERY_NUM_BUFFER_UPLOADS */
       uint64_t num_const_buf_updates;   /**< SVGA_QUERY_NUM_CONST_BUF_UPDATES */
       uint64_t num_const_updates;       /**< SVGA_QUERY_NUM_CONST_UPDATES */
+      uint64_t num_redundant_state_cmds; /**< SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS */
       uint64_t num_shaders;             /**< SVGA_QUERY_NUM_SHADERS */
 
       /** The following are summed for SVGA_QUERY_NUM_STATE_OBJECTS */
@@ -733,6 +733,7 @@ svga_create_query(struct pipe_context *pipe,
    case SVGA_QUERY_NUM_BUFFER_UPLOADS:
    case SVGA_QUERY_NUM_CONST_BUF_UPDATES:
    case SVGA_QUERY_NUM_CONST_UPDATES:
+   case SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS:
    case SVGA_QUERY_NUM_FAILED_ALLOCATIONS:
    case SVGA_QUERY_NUM_COMMANDS_PER_DRAW:
    case SVGA_QUERY_NUM_SHADER_RELOCATIONS:
@@ -820,6 +821,7 @@ svga_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
    case SVGA_QUERY_NUM_BUFFER_UPLOADS:
    case SVGA_QUERY_NUM_CONST_BUF_UPDATES:
    case SVGA_QUERY_NUM_CONST_UPDATES:
+   case SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS:
    case SVGA_QUERY_NUM_FAILED_ALLOCATIONS:
    case SVGA_QUERY_NUM_COMMANDS_PER_DRAW:
    case SVGA_QUERY_NUM_SHADER_RELOCATIONS:
@@ -931,6 +933,9 @@ svga_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    case SVGA_QUERY_NUM_CONST_UPDATES:
       sq->begin_count = svga->hud.num_const_updates;
       break;
+   case SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS:
+      sq->begin_count = svga->hud.num_redundant_state_cmds;
+      break;
    case SVGA_QUERY_NUM_SHADER_RELOCATIONS:
       sq->begin_count = svga->swc->num_shader_reloc;
       break;
@@ -1055,6 +1060,9 @@ svga_end_query(struct pipe_context *pipe, struct pipe_query *q)
    case SVGA_QUERY_NUM_CONST_UPDATES:
       sq->end_count = svga->hud.num_const_updates;
       break;
+   case SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS:
+      sq->end_count = svga->hud.num_redundant_state_cmds;
+      break;
    case SVGA_QUERY_NUM_SHADER_RELOCATIONS:
       sq->end_count = svga->swc->num_shader_reloc;
       break;
@@ -1179,6 +1187,7 @@ svga_get_query_result(struct pipe_context *pipe,
    case SVGA_QUERY_NUM_BUFFER_UPLOADS:
    case SVGA_QUERY_NUM_CONST_BUF_UPDATES:
    case SVGA_QUERY_NUM_CONST_UPDATES:
+   case SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS:
    case SVGA_QUERY_NUM_SHADER_RELOCATIONS:
    case SVGA_QUERY_NUM_SURFACE_RELOCATIONS:
       vresult->u64 = sq->end_count - sq->begin_count;
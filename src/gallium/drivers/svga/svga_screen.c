@@ -955,6 +955,8 @@ svga_get_driver_query_info(struct pipe_screen *screen,
             PIPE_DRIVER_QUERY_TYPE_UINT64),
       QUERY("num-const-updates", SVGA_QUERY_NUM_CONST_UPDATES,
             PIPE_DRIVER_QUERY_TYPE_UINT64),
+      QUERY("num-redundant-state-cmds", SVGA_QUERY_NUM_REDUNDANT_STATE_CMDS,
+            PIPE_DRIVER_QUERY_TYPE_UINT64),
       QUERY("num-shader-relocations", SVGA_QUERY_NUM_SHADER_RELOCATIONS,
             PIPE_DRIVER_QUERY_TYPE_UINT64),
       QUERY("num-surface-relocations", SVGA_QUERY_NUM_SURFACE_RELOCATIONS,
@@ -845,8 +845,17 @@ emit_constbuf(struct svga_context *svga,
    const struct svga_screen *screen = svga_screen(svga->pipe.screen);
    const struct svga_winsys_screen *sws = screen->sws;
 
+   /* Nothing to send if the device already has this exact binding, which
+    * is common for the non-default constant buffers since all enabled ones
+    * are re-emitted whenever any of them changes.
+    */
+   if (svga->state.hw_draw.constbufoffsets[shader][slot].handle == dst_handle &&
+       svga->state.hw_draw.constbufoffsets[shader][slot].offset == offset &&
+       svga->state.hw_draw.constbufoffsets[shader][slot].size == new_buf_size) {
+      svga->hud.num_redundant_state_cmds++;
+   }
    /* Issue the SetSingleConstantBuffer command */
-   if (!sws->have_constant_buffer_offset_cmd ||
+   else if (!sws->have_constant_buffer_offset_cmd ||
        svga->state.hw_draw.constbufoffsets[shader][slot].handle != dst_handle ||
        svga->state.hw_draw.constbufoffsets[shader][slot].size != new_buf_size) {
       ret = SVGA3D_vgpu10_SetSingleConstantBuffer(svga->swc,
@@ -882,6 +891,7 @@ emit_constbuf(struct svga_context *svga,
     */
    pipe_resource_reference(&svga->state.hw_draw.constbuf[shader][slot], dst_buffer);
    svga->state.hw_draw.constbufoffsets[shader][slot].handle = dst_handle;
+   svga->state.hw_draw.constbufoffsets[shader][slot].offset = offset;
    svga->state.hw_draw.constbufoffsets[shader][slot].size = new_buf_size;
 
    pipe_resource_reference(&dst_buffer, NULL);
@@ -477,22 +477,30 @@ update_samplers(struct svga_context *svga, uint64_t dirty )
             nsamplers = SVGA3D_DX_MAX_SAMPLERS;
          }
 
-         if (nsamplers != svga->state.hw_draw.num_samplers[shader] ||
-             memcmp(ids, svga->state.hw_draw.samplers[shader],
-                    nsamplerIds * sizeof(ids[0])) != 0) {
-
+         /* Only send the range of ids that really changed. */
+         const SVGA3dSamplerId *hw_ids = svga->state.hw_draw.samplers[shader];
+         unsigned first = 0, last = nsamplerIds;
+         while (first < nsamplerIds && ids[first] == hw_ids[first])
+            first++;
+         while (last > first && ids[last - 1] == hw_ids[last - 1])
+            last--;
+
+         if (first < last) {
             /* HW state is really changing */
             ret = SVGA3D_vgpu10_SetSamplers(svga->swc,
-                                            nsamplerIds,
-                                            0,                       /* start */
+                                            last - first,
+                                            first,                   /* start */
                                             svga_shader_type(shader), /* type */
-                                            ids);
+                                            ids + first);
             if (ret != PIPE_OK)
                return ret;
             memcpy(svga->state.hw_draw.samplers[shader], ids,
                    nsamplerIds * sizeof(ids[0]));
-            svga->state.hw_draw.num_samplers[shader] = nsamplers;
          }
+         else if (nsamplers == svga->state.hw_draw.num_samplers[shader]) {
+            svga->hud.num_redundant_state_cmds++;
+         }
+         svga->state.hw_draw.num_samplers[shader] = nsamplers;
       }
    }
 
@@ -222,6 +222,35 @@ TEST_F(VirglStagingMgr,
    release_resources(out_resource, 2);
 }
 
+TEST_F(VirglStagingMgr,
+       repeatedly_non_fitting_allocations_grow_resource)
+{
+   struct virgl_hw_res *out_resource[6] = {0};
+   unsigned out_offset;
+   void *map_ptr;
+   bool alloc_succeeded;
+
+   for (unsigned i = 0; i < 6; ++i) {
+      alloc_succeeded =
+         virgl_staging_alloc(&staging, staging_size - 1, 1, &out_offset,
+                             &out_resource[i], &map_ptr);
+
+      EXPECT_TRUE(alloc_succeeded);
+      EXPECT_EQ(out_offset, i == 5 ? staging_size - 1 : 0);
+      ASSERT_NE(out_resource[i], nullptr);
+   }
+
+   /* The first few buffers keep the default size. */
+   for (unsigned i = 1; i < 4; ++i)
+      EXPECT_EQ(out_resource[i]->size, out_resource[0]->size);
+
+   /* Then the buffer doubles, and allocations fit twice in it. */
+   EXPECT_EQ(out_resource[4]->size, 2 * out_resource[0]->size);
+   EXPECT_EQ(out_resource[5], out_resource[4]);
+
+   release_resources(out_resource, 6);
+}
+
 TEST_F(VirglStagingMgr,
        non_fitting_aligned_allocation_reallocates_resource)
 {
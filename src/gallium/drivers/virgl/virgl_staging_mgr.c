@@ -31,6 +31,12 @@
 #include "virgl_staging_mgr.h"
 #include "virgl_resource.h"
 
+/* Double the size of the staging buffer after it ran out of space this many
+ * times, up to VIRGL_STAGING_MAX_GROWTH times the default size.
+ */
+#define VIRGL_STAGING_GROW_THRESHOLD 4
+#define VIRGL_STAGING_MAX_GROWTH 16
+
 static bool
 virgl_staging_alloc_buffer(struct virgl_staging_mgr *staging, unsigned min_size)
 {
@@ -43,7 +49,7 @@ virgl_staging_alloc_buffer(struct virgl_staging_mgr *staging, unsigned min_size)
 
    /* Allocate a new one:
     */
-   size = align(MAX2(staging->default_size, min_size), 4096);
+   size = align(MAX2(staging->grow_size, min_size), 4096);
 
    staging->hw_res = vws->resource_create(vws,
                                           PIPE_BUFFER,
@@ -81,6 +87,7 @@ virgl_staging_init(struct virgl_staging_mgr *staging, struct pipe_context *pipe,
 
    staging->vws = virgl_screen(pipe->screen)->vws;
    staging->default_size = default_size;
+   staging->grow_size = default_size;
 }
 
 void
@@ -110,6 +117,17 @@ virgl_staging_alloc(struct virgl_staging_mgr *staging,
     * for the sub-allocation.
     */
    if (offset + size > staging->size) {
+      /* Streaming uploads that keep filling the buffer up cost a new
+       * resource each time, so give them more room.
+       */
+      if (staging->hw_res &&
+          ++staging->num_exhausted >= VIRGL_STAGING_GROW_THRESHOLD &&
+          staging->grow_size <
+          staging->default_size * VIRGL_STAGING_MAX_GROWTH) {
+         staging->grow_size *= 2;
+         staging->num_exhausted = 0;
+      }
+
       if (unlikely(!virgl_staging_alloc_buffer(staging, size))) {
          *out_offset = ~0;
          vws->resource_reference(vws, outbuf, NULL);
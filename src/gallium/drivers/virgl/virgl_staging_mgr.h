@@ -42,11 +42,16 @@ struct virgl_staging_mgr {
    unsigned size;   /* Current staging buffer size. */
    uint8_t *map;    /* Pointer to the mapped staging buffer. */
    unsigned offset; /* Offset pointing at the first unused buffer byte. */
+   unsigned grow_size;     /* Size of the next staging buffer, in bytes. */
+   unsigned num_exhausted; /* Times a buffer of grow_size ran out of space. */
 };
 
 /**
  * Init the staging manager.
  *
+ * The staging buffer starts out at default_size and grows, up to 16 times
+ * that, when streaming uploads keep running out of space in it.
+ *
  * \param staging       Pointer to the staging manager to initialize.
  * \param pipe          Pipe driver.
  * \param default_size  Minimum size of the staging buffer, in bytes.
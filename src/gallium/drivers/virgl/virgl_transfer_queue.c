@@ -159,6 +159,39 @@ static bool transfers_intersect(struct virgl_transfer *queued,
          &current->base.box, true);
 }
 
+/* Whether the union of two 2D transfers covers nothing but the two boxes,
+ * so that uploading it doesn't overwrite host data the guest never touched.
+ */
+static bool transfers_merge_exactly_2d(struct virgl_transfer *queued,
+                                       struct virgl_transfer *current)
+{
+   const struct pipe_box *a = &queued->base.box;
+   const struct pipe_box *b = &current->base.box;
+   struct pipe_box merged, inter;
+
+   if (transfer_dim(current) != 2 || !transfers_intersect(queued, current))
+      return false;
+
+   if (a->width <= 0 || a->height <= 0 || b->width <= 0 || b->height <= 0 ||
+       a->z != b->z || a->depth != b->depth)
+      return false;
+
+   u_box_union_2d(&merged, a, b);
+
+   /* The merged transfer starts at the offset of one of the two. */
+   if ((merged.x != a->x || merged.y != a->y) &&
+       (merged.x != b->x || merged.y != b->y))
+      return false;
+
+   int x1 = MAX2(a->x, b->x), x2 = MIN2(a->x + a->width, b->x + b->width);
+   int y1 = MAX2(a->y, b->y), y2 = MIN2(a->y + a->height, b->y + b->height);
+   u_box_2d(x1, y1, MAX2(x2 - x1, 0), MAX2(y2 - y1, 0), &inter);
+
+   return merged.width * merged.height ==
+          a->width * a->height + b->width * b->height -
+          inter.width * inter.height;
+}
+
 static void remove_transfer(struct virgl_transfer_queue *queue,
                             struct virgl_transfer *queued)
 {
@@ -179,6 +212,22 @@ static void replace_unmapped_transfer(struct virgl_transfer_queue *queue,
    queue->num_dwords -= (VIRGL_TRANSFER3D_SIZE + 1);
 }
 
+static void replace_unmapped_transfer_2d(struct virgl_transfer_queue *queue,
+                                         struct list_action_args *args)
+{
+   struct virgl_transfer *current = args->current;
+   struct virgl_transfer *queued = args->queued;
+
+   if (queued->base.box.x <= current->base.box.x &&
+       queued->base.box.y <= current->base.box.y)
+      current->offset = queued->offset;
+
+   u_box_union_2d(&current->base.box, &current->base.box, &queued->base.box);
+
+   remove_transfer(queue, queued);
+   queue->num_dwords -= (VIRGL_TRANSFER3D_SIZE + 1);
+}
+
 static void transfer_put(struct virgl_transfer_queue *queue,
                          struct list_action_args *args)
 {
@@ -313,6 +362,15 @@ int virgl_transfer_queue_unmap(struct virgl_transfer_queue *queue,
       iter.compare = transfers_intersect;
       iter.action = replace_unmapped_transfer;
       compare_and_perform_action(queue, &iter);
+   } else if (transfer_dim(transfer) == 2) {
+      /* Uploads of neighbouring rectangles, e.g. glyphs or tiles of a
+       * texture atlas, can go out as a single transfer too.
+       */
+      memset(&iter, 0, sizeof(iter));
+      iter.current = transfer;
+      iter.compare = transfers_merge_exactly_2d;
+      iter.action = replace_unmapped_transfer_2d;
+      compare_and_perform_action(queue, &iter);
    }
 
    add_internal(queue, transfer);
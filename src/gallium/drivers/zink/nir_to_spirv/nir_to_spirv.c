@@ -4245,6 +4245,8 @@ nir_to_spirv(struct nir_shader *s, const struct zink_shader_info *sinfo, uint32_
          goto fail;
    }
    ctx.num_defs = entry->ssa_alloc;
+   /* most SSA defs become a single instruction of a handful of words */
+   spirv_builder_reserve_instructions(&ctx.builder, entry->ssa_alloc * 5);
 
    nir_index_local_regs(entry);
    ctx.regs = ralloc_array_size(ctx.mem_ctx,
@@ -29,6 +29,7 @@
 #include "util/u_bitcast.h"
 #include "util/u_memory.h"
 #include "util/half_float.h"
+#include "util/u_math.h"
 #include "util/hash_table.h"
 #define XXH_INLINE_ALL
 #include "util/xxhash.h"
@@ -56,7 +57,7 @@ static inline bool
 spirv_buffer_prepare(struct spirv_buffer *b, void *mem_ctx, size_t needed)
 {
    needed += b->num_words;
-   if (b->room >= b->num_words + needed)
+   if (b->room >= needed)
       return true;
 
    return spirv_buffer_grow(b, mem_ctx, needed);
@@ -91,6 +92,12 @@ spirv_buffer_emit_string(struct spirv_buffer *b, void *mem_ctx,
    return 1 + pos / 4;
 }
 
+void
+spirv_builder_reserve_instructions(struct spirv_builder *b, size_t num_words)
+{
+   spirv_buffer_prepare(&b->instructions, b->mem_ctx, num_words);
+}
+
 void
 spirv_builder_emit_cap(struct spirv_builder *b, SpvCapability cap)
 {
@@ -1187,9 +1194,10 @@ get_type_def(struct spirv_builder *b, SpvOp op, const uint32_t args[],
    memcpy(&key.args, args, sizeof(uint32_t) * num_args);
    key.num_args = num_args;
 
+   const uint32_t hash = non_aggregate_type_hash(&key);
    struct hash_entry *entry;
    if (b->types) {
-      entry = _mesa_hash_table_search(b->types, &key);
+      entry = _mesa_hash_table_search_pre_hashed(b->types, hash, &key);
       if (entry)
          return ((struct spirv_type *)entry->data)->type;
    } else {
@@ -1214,7 +1222,7 @@ get_type_def(struct spirv_builder *b, SpvOp op, const uint32_t args[],
    for (int i = 0; i < num_args; ++i)
       spirv_buffer_emit_word(&b->types_const_defs, args[i]);
 
-   entry = _mesa_hash_table_insert(b->types, type, type);
+   entry = _mesa_hash_table_insert_pre_hashed(b->types, hash, type, type);
    assert(entry);
 
    return ((struct spirv_type *)entry->data)->type;
@@ -1226,41 +1234,63 @@ spirv_builder_type_void(struct spirv_builder *b)
    return get_type_def(b, SpvOpTypeVoid, NULL, 0);
 }
 
+/* index into the scalar type caches for 8, 16, 32 and 64 bit */
+static inline unsigned
+scalar_type_idx(unsigned width)
+{
+   assert(width >= 8 && width <= 64 && util_is_power_of_two_nonzero(width));
+   return ffs(width) - 4;
+}
+
 SpvId
 spirv_builder_type_bool(struct spirv_builder *b)
 {
-   return get_type_def(b, SpvOpTypeBool, NULL, 0);
+   if (!b->bool_type)
+      b->bool_type = get_type_def(b, SpvOpTypeBool, NULL, 0);
+   return b->bool_type;
 }
 
 SpvId
 spirv_builder_type_int(struct spirv_builder *b, unsigned width)
 {
-   uint32_t args[] = { width, 1 };
-   return get_type_def(b, SpvOpTypeInt, args, ARRAY_SIZE(args));
+   SpvId *type = &b->int_types[scalar_type_idx(width)];
+   if (!*type) {
+      uint32_t args[] = { width, 1 };
+      *type = get_type_def(b, SpvOpTypeInt, args, ARRAY_SIZE(args));
+   }
+   return *type;
 }
 
 SpvId
 spirv_builder_type_uint(struct spirv_builder *b, unsigned width)
 {
-   uint32_t args[] = { width, 0 };
-   if (width == 8)
-      spirv_builder_emit_cap(b, SpvCapabilityInt8);
-   else if (width == 16)
-      spirv_builder_emit_cap(b, SpvCapabilityInt16);
-   else if (width == 64)
-      spirv_builder_emit_cap(b, SpvCapabilityInt64);
-   return get_type_def(b, SpvOpTypeInt, args, ARRAY_SIZE(args));
+   SpvId *type = &b->uint_types[scalar_type_idx(width)];
+   if (!*type) {
+      uint32_t args[] = { width, 0 };
+      if (width == 8)
+         spirv_builder_emit_cap(b, SpvCapabilityInt8);
+      else if (width == 16)
+         spirv_builder_emit_cap(b, SpvCapabilityInt16);
+      else if (width == 64)
+         spirv_builder_emit_cap(b, SpvCapabilityInt64);
+      *type = get_type_def(b, SpvOpTypeInt, args, ARRAY_SIZE(args));
+   }
+   return *type;
 }
 
 SpvId
 spirv_builder_type_float(struct spirv_builder *b, unsigned width)
 {
-   uint32_t args[] = { width };
-   if (width == 16)
-      spirv_builder_emit_cap(b, SpvCapabilityFloat16);
-   else if (width == 64)
-      spirv_builder_emit_cap(b, SpvCapabilityFloat64);
-   return get_type_def(b, SpvOpTypeFloat, args, ARRAY_SIZE(args));
+   SpvId *type = &b->float_types[scalar_type_idx(width)];
+   if (!*type) {
+      uint32_t args[] = { width };
+      if (width == 16)
+         spirv_builder_emit_cap(b, SpvCapabilityFloat16);
+      else if (width == 64)
+         spirv_builder_emit_cap(b, SpvCapabilityFloat64);
+      *type = get_type_def(b, SpvOpTypeFloat, args, ARRAY_SIZE(args));
+   }
+   return *type;
 }
 
 SpvId
@@ -1409,9 +1439,10 @@ get_const_def(struct spirv_builder *b, SpvOp op, SpvId type,
    memcpy(&key.args, args, sizeof(uint32_t) * num_args);
    key.num_args = num_args;
 
+   const uint32_t hash = const_hash(&key);
    struct hash_entry *entry;
    if (b->consts) {
-      entry = _mesa_hash_table_search(b->consts, &key);
+      entry = _mesa_hash_table_search_pre_hashed(b->consts, hash, &key);
       if (entry)
          return ((struct spirv_const *)entry->data)->result;
    } else {
@@ -1437,7 +1468,7 @@ get_const_def(struct spirv_builder *b, SpvOp op, SpvId type,
    for (int i = 0; i < num_args; ++i)
       spirv_buffer_emit_word(&b->types_const_defs, args[i]);
 
-   entry = _mesa_hash_table_insert(b->consts, cnst, cnst);
+   entry = _mesa_hash_table_insert_pre_hashed(b->consts, hash, cnst, cnst);
    assert(entry);
 
    return ((struct spirv_const *)entry->data)->result;
@@ -1648,13 +1679,14 @@ spirv_builder_get_words(struct spirv_builder *b, uint32_t *words,
    bool find_tcs_vertices_out = *tcs_vertices_out_word > 0;
    for (int i = 0; i < ARRAY_SIZE(buffers); ++i) {
       const struct spirv_buffer *buffer = buffers[i];
-      for (int j = 0; j < buffer->num_words; ++j) {
-         if (find_tcs_vertices_out && buffer == &b->exec_modes && *tcs_vertices_out_word == j) {
-            *tcs_vertices_out_word = written;
-            find_tcs_vertices_out = false;
-         }
-         words[written++] = buffer->words[j];
+      if (find_tcs_vertices_out && buffer == &b->exec_modes &&
+          *tcs_vertices_out_word < buffer->num_words) {
+         *tcs_vertices_out_word += written;
+         find_tcs_vertices_out = false;
       }
+      if (buffer->num_words)
+         memcpy(words + written, buffer->words, buffer->num_words * sizeof(uint32_t));
+      written += buffer->num_words;
    }
 
    assert(written == spirv_builder_get_num_words(b));
@@ -56,6 +56,14 @@ struct spirv_builder {
    struct hash_table *types;
    struct hash_table *consts;
 
+   /* scalar types are requested all the time, so skip the hash lookup for
+    * them; indexed by bit size, 8 to 64
+    */
+   SpvId bool_type;
+   SpvId int_types[4];
+   SpvId uint_types[4];
+   SpvId float_types[4];
+
    struct spirv_buffer instructions;
    SpvId prev_id;
 };
@@ -66,6 +74,10 @@ spirv_builder_new_id(struct spirv_builder *b)
    return ++b->prev_id;
 }
 
+/* Reserves room for num_words of instructions up front */
+void
+spirv_builder_reserve_instructions(struct spirv_builder *b, size_t num_words);
+
 void
 spirv_builder_emit_cap(struct spirv_builder *b, SpvCapability cap);
 
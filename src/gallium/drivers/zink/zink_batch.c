@@ -20,6 +20,13 @@
 #endif
 #include "wsi_common.h"
 
+static inline unsigned
+batch_resource_hash(const struct zink_resource_object *obj)
+{
+   const uintptr_t p = (uintptr_t)obj;
+   return ((p >> 6) ^ (p >> 18)) & (ZINK_BATCH_RESOURCE_HASHLIST_SIZE - 1);
+}
+
 void
 debug_describe_zink_batch_state(char *buf, const struct zink_batch_state *ptr)
 {
@@ -35,15 +42,18 @@ zink_reset_batch_state(struct zink_context *ctx, struct zink_batch_state *bs)
       mesa_loge("ZINK: vkResetCommandPool failed");
 
    /* unref all used resources */
-   set_foreach_remove(bs->resources, entry) {
-      struct zink_resource_object *obj = (struct zink_resource_object *)entry->key;
+   util_dynarray_foreach(&bs->resources, struct zink_resource_object*, pobj) {
+      struct zink_resource_object *obj = *pobj;
       if (!zink_resource_object_usage_unset(obj, bs)) {
          obj->unordered_barrier = false;
          obj->access = 0;
          obj->access_stage = 0;
       }
+      bs->resource_hashlist[batch_resource_hash(obj)] = -1;
       util_dynarray_append(&bs->unref_resources, struct zink_resource_object*, obj);
    }
+   util_dynarray_clear(&bs->resources);
+   _mesa_set_clear(bs->resources_overflow, NULL);
 
    for (unsigned i = 0; i < 2; i++) {
       while (util_dynarray_contains(&bs->bindless_releases[i], uint32_t)) {
@@ -178,6 +188,8 @@ zink_batch_state_destroy(struct zink_screen *screen, struct zink_batch_state *bs
    util_dynarray_fini(&bs->bindless_releases[1]);
    util_dynarray_fini(&bs->acquires);
    util_dynarray_fini(&bs->dead_swapchains);
+   util_dynarray_fini(&bs->resources);
+   _mesa_set_destroy(bs->resources_overflow, NULL);
    _mesa_set_destroy(bs->surfaces, NULL);
    _mesa_set_destroy(bs->bufferviews, NULL);
    _mesa_set_destroy(bs->programs, NULL);
@@ -216,7 +228,9 @@ create_batch_state(struct zink_context *ctx)
 
    bs->ctx = ctx;
 
-   SET_CREATE_OR_FAIL(bs->resources);
+   SET_CREATE_OR_FAIL(bs->resources_overflow);
+   util_dynarray_init(&bs->resources, NULL);
+   memset(bs->resource_hashlist, -1, sizeof(bs->resource_hashlist));
    SET_CREATE_OR_FAIL(bs->surfaces);
    SET_CREATE_OR_FAIL(bs->bufferviews);
    SET_CREATE_OR_FAIL(bs->programs);
@@ -530,6 +544,27 @@ batch_ptr_add_usage(struct zink_batch *batch, struct set *s, void *ptr)
    return !found;
 }
 
+/* returns true if the object was newly added to the batch */
+static bool
+batch_add_resource(struct zink_batch_state *bs, struct zink_resource_object *obj)
+{
+   const unsigned hash = batch_resource_hash(obj);
+   const int32_t idx = bs->resource_hashlist[hash];
+   if (likely(idx < 0)) {
+      bs->resource_hashlist[hash] = util_dynarray_num_elements(&bs->resources, struct zink_resource_object*);
+   } else {
+      if (*util_dynarray_element(&bs->resources, struct zink_resource_object*, idx) == obj)
+         return false;
+      /* slot is owned by another object */
+      bool found = false;
+      _mesa_set_search_or_add(bs->resources_overflow, obj, &found);
+      if (found)
+         return false;
+   }
+   util_dynarray_append(&bs->resources, struct zink_resource_object*, obj);
+   return true;
+}
+
 ALWAYS_INLINE static void
 check_oom_flush(struct zink_context *ctx, const struct zink_batch *batch)
 {
@@ -543,7 +578,7 @@ check_oom_flush(struct zink_context *ctx, const struct zink_batch *batch)
 void
 zink_batch_reference_resource(struct zink_batch *batch, struct zink_resource *res)
 {
-   if (!batch_ptr_add_usage(batch, batch->state->resources, res->obj))
+   if (!batch_add_resource(batch->state, res->obj))
       return;
    pipe_reference(NULL, &res->obj->reference);
    batch->state->resource_size += res->obj->size;
@@ -554,7 +589,7 @@ zink_batch_reference_resource(struct zink_batch *batch, struct zink_resource *re
 void
 zink_batch_reference_resource_move(struct zink_batch *batch, struct zink_resource *res)
 {
-   if (!batch_ptr_add_usage(batch, batch->state->resources, res->obj))
+   if (!batch_add_resource(batch->state, res->obj))
       return;
    batch->state->resource_size += res->obj->size;
    check_oom_flush(batch->state->ctx, batch);
@@ -85,6 +85,9 @@ struct zink_batch_usage {
    bool unflushed;
 };
 
+/* must be a power of two */
+#define ZINK_BATCH_RESOURCE_HASHLIST_SIZE 4096
+
 /* not real api don't use */
 bool
 batch_ptr_add_usage(struct zink_batch *batch, struct set *s, void *ptr);
@@ -112,7 +115,13 @@ struct zink_batch_state {
 
    struct set *programs;
 
-   struct set *resources;
+   /* resource objects referenced by the batch:
+    * each object is tracked in resource_hashlist at the slot its pointer hashes to, which holds its
+    * index in resources; objects whose slot is already owned by another object go in resources_overflow
+    */
+   struct util_dynarray resources;
+   struct set *resources_overflow;
+   int32_t resource_hashlist[ZINK_BATCH_RESOURCE_HASHLIST_SIZE];
    struct set *surfaces;
    struct set *bufferviews;
 
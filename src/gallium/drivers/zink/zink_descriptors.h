@@ -146,6 +146,8 @@ struct zink_program_descriptor_data {
    bool bindless;
    bool fbfetch;
    uint8_t binding_usage;
+   uint8_t push_set_usage; //binding_usage bit of a set using push descriptors in place of set 0
+
    struct zink_descriptor_pool_key *pool_key[ZINK_DESCRIPTOR_TYPES]; //push set doesn't need one
    struct zink_descriptor_layout *layouts[ZINK_DESCRIPTOR_TYPES + 1];
    VkDescriptorUpdateTemplateKHR templates[ZINK_DESCRIPTOR_TYPES + 1];
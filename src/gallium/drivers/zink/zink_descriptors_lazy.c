@@ -151,6 +151,7 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
    uint8_t has_bindings = 0;
    unsigned push_count = 0;
    uint16_t num_type_sizes[ZINK_DESCRIPTOR_TYPES];
+   unsigned num_descriptors[ZINK_DESCRIPTOR_TYPES] = {0};
    VkDescriptorPoolSize sizes[6] = {0}; //zink_descriptor_size_index
 
    struct zink_shader **stages;
@@ -203,6 +204,7 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
             sizes[idx].descriptorCount += shader->bindings[j][k].size;
             sizes[idx].type = shader->bindings[j][k].type;
             init_template_entry(shader, j, k, &entries[j][entry_idx[j]], &entry_idx[j], screen->descriptor_mode == ZINK_DESCRIPTOR_MODE_LAZY);
+            num_descriptors[j] += shader->bindings[j][k].size;
             num_bindings[j]++;
             has_bindings |= BITFIELD_BIT(j);
          }
@@ -221,6 +223,18 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
       return !!pg->layout;
    }
 
+   /* if set 0 isn't needed for dynamic ubos, one of the other sets can be pushed instead:
+    * this skips the pool allocation and the separate update+bind for the set that is most
+    * likely to change between draws
+    */
+   if (!push_count && have_push && screen->descriptor_mode == ZINK_DESCRIPTOR_MODE_LAZY &&
+       screen->info.have_KHR_descriptor_update_template) {
+      enum zink_descriptor_type push_type = has_bindings & BITFIELD_BIT(ZINK_DESCRIPTOR_TYPE_SAMPLER_VIEW) ?
+                                            ZINK_DESCRIPTOR_TYPE_SAMPLER_VIEW : ffs(has_bindings) - 1;
+      if (has_bindings && num_descriptors[push_type] <= screen->info.push_props.maxPushDescriptors)
+         pg->dd->push_set_usage = BITFIELD_BIT(push_type);
+   }
+
    pg->dsl[pg->num_dsl++] = push_count ? ctx->dd->push_dsl[pg->is_compute]->layout : ctx->dd->dummy_dsl->layout;
    if (has_bindings) {
       for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++)
@@ -235,6 +249,16 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
             }
          }
          struct zink_descriptor_layout_key *key;
+         if (pg->dd->push_set_usage & BITFIELD_BIT(type)) {
+            /* push layouts aren't cached, so this one belongs to the program */
+            pg->dd->layouts[pg->num_dsl] = zink_descriptor_util_layout_get(ctx, ZINK_DESCRIPTOR_TYPES, bindings[type], num_bindings[type], &key);
+            if (!pg->dd->layouts[pg->num_dsl])
+               return false;
+            ralloc_free(key);
+            pg->dsl[pg->num_dsl] = pg->dd->layouts[pg->num_dsl]->layout;
+            pg->num_dsl++;
+            continue;
+         }
          pg->dd->layouts[pg->num_dsl] = zink_descriptor_util_layout_get(ctx, type, bindings[type], num_bindings[type], &key);
          enum zink_descriptor_size_index idx = zink_descriptor_type_to_size_idx(type);
          VkDescriptorPoolSize *sz = &sizes[idx];
@@ -271,6 +295,8 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
    VkDescriptorUpdateTemplateType types[ZINK_DESCRIPTOR_TYPES + 1] = {VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET};
    if (have_push && screen->descriptor_mode == ZINK_DESCRIPTOR_MODE_LAZY)
       types[0] = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+   u_foreach_bit(type, pg->dd->push_set_usage)
+      types[type + 1] = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
 
    /* number of descriptors in template */
    unsigned wd_count[ZINK_DESCRIPTOR_TYPES + 1];
@@ -278,6 +304,8 @@ zink_descriptor_program_init_lazy(struct zink_context *ctx, struct zink_program
       wd_count[0] = pg->is_compute ? 1 : (ZINK_SHADER_COUNT + !!ctx->dd->has_fbfetch);
    for (unsigned i = 0; i < ZINK_DESCRIPTOR_TYPES; i++)
       wd_count[i + 1] = pg->dd->pool_key[i] ? pg->dd->pool_key[i]->layout->num_bindings : 0;
+   u_foreach_bit(type, pg->dd->push_set_usage)
+      wd_count[type + 1] = num_bindings[type];
 
    VkDescriptorUpdateTemplateEntry *push_entries[2] = {
       dd_lazy(ctx)->push_entries,
@@ -322,6 +350,12 @@ zink_descriptor_program_deinit_lazy(struct zink_context *ctx, struct zink_progra
       if (pg->dd->templates[i])
          VKSCR(DestroyDescriptorUpdateTemplate)(screen->dev, pg->dd->templates[i], NULL);
    }
+   u_foreach_bit(type, pg->dd->push_set_usage) {
+      if (pg->dd->layouts[type + 1]) {
+         VKSCR(DestroyDescriptorSetLayout)(screen->dev, pg->dd->layouts[type + 1]->layout, NULL);
+         ralloc_free(pg->dd->layouts[type + 1]);
+      }
+   }
    ralloc_free(pg->dd);
 }
 
@@ -495,6 +529,12 @@ zink_descriptors_update_lazy_masked(struct zink_context *ctx, bool is_compute, u
          bdd->sets[is_compute][type + 1] = desc_sets[type];
       }
    }
+   /* push sets are invalidated by incompatible layouts too, so rebinding means repushing */
+   u_foreach_bit(type, pg->dd->push_set_usage & (changed_sets | bind_sets)) {
+      assert(type + 1 < pg->num_dsl);
+      VKCTX(CmdPushDescriptorSetWithTemplateKHR)(bs->cmdbuf, pg->dd->templates[type + 1],
+                                                 pg->layout, type + 1, ctx);
+   }
    u_foreach_bit(type, bind_sets & ~changed_sets) {
       if (!pg->dd->pool_key[type])
          continue;
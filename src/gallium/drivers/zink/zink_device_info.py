@@ -179,6 +179,12 @@ EXTENSIONS = [
         alias="pipeline_cache_control",
         features=True,
         conditions=["$feats.pipelineCreationCacheControl"]),
+    Extension("VK_KHR_pipeline_library"),
+    Extension("VK_EXT_graphics_pipeline_library",
+        alias="gpl",
+        features=True,
+        properties=True,
+        conditions=["$feats.graphicsPipelineLibrary", "$props.graphicsPipelineLibraryFastLinking"]),
     Extension("VK_EXT_shader_stencil_export",
         alias="stencil_export"),
     Extension("VK_EXTX_portability_subset",
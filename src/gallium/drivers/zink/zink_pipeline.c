@@ -45,16 +45,25 @@ clamp_void_blend_factor(VkBlendFactor f)
    return f;
 }
 
-VkPipeline
-zink_create_gfx_pipeline(struct zink_screen *screen,
-                         struct zink_gfx_program *prog,
-                         struct zink_gfx_pipeline_state *state,
-                         const uint8_t *binding_map,
-                         VkPrimitiveTopology primitive_topology)
+/* gpl is the set of VK_EXT_graphics_pipeline_library parts to build a
+ * library of, or 0 for a complete pipeline
+ */
+static VkPipeline
+create_gfx_pipeline(struct zink_screen *screen,
+                    struct zink_gfx_program *prog,
+                    struct zink_gfx_pipeline_state *state,
+                    const uint8_t *binding_map,
+                    VkPrimitiveTopology primitive_topology,
+                    VkGraphicsPipelineLibraryFlagsEXT gpl)
 {
+   const bool has_input = !gpl || (gpl & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+   const bool has_shaders = !gpl || (gpl & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+   assert(has_input || has_shaders);
+
    struct zink_rasterizer_hw_state *hw_rast_state = (void*)state;
    VkPipelineVertexInputStateCreateInfo vertex_input_state;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs) {
+   if (has_input &&
+       (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs)) {
       memset(&vertex_input_state, 0, sizeof(vertex_input_state));
       vertex_input_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
       vertex_input_state.pVertexBindingDescriptions = state->element_state->b.bindings;
@@ -71,7 +80,8 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
    }
 
    VkPipelineVertexInputDivisorStateCreateInfoEXT vdiv_state;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state && state->element_state->b.divisors_present) {
+   if (has_input && !screen->info.have_EXT_vertex_input_dynamic_state &&
+       state->element_state->b.divisors_present) {
        memset(&vdiv_state, 0, sizeof(vdiv_state));
        vertex_input_state.pNext = &vdiv_state;
        vdiv_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT;
@@ -314,20 +324,39 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
 
    VkGraphicsPipelineCreateInfo pci = {0};
    pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pDynamicState = &pipelineDynamicStateCreateInfo;
+
+   VkGraphicsPipelineLibraryCreateInfoEXT gplci = {
+      VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+      NULL,
+      gpl
+   };
+   if (gpl) {
+      pci.pNext = &gplci;
+      pci.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                  VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+   }
+
+   if (has_input) {
+      if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs)
+         pci.pVertexInputState = &vertex_input_state;
+      pci.pInputAssemblyState = &primitive_state;
+   }
+
+   VkPipelineShaderStageCreateInfo shader_stages[ZINK_SHADER_COUNT];
+   VkPipelineTessellationStateCreateInfo tci = {0};
+   VkPipelineTessellationDomainOriginStateCreateInfo tdci = {0};
+   if (!has_shaders)
+      goto create;
+
    pci.layout = prog->base.layout;
    pci.renderPass = state->render_pass->render_pass;
-   if (!screen->info.have_EXT_vertex_input_dynamic_state || !state->element_state->num_attribs)
-      pci.pVertexInputState = &vertex_input_state;
-   pci.pInputAssemblyState = &primitive_state;
    pci.pRasterizationState = &rast_state;
    pci.pColorBlendState = &blend_state;
    pci.pMultisampleState = &ms_state;
    pci.pViewportState = &viewport_state;
    pci.pDepthStencilState = &depth_stencil_state;
-   pci.pDynamicState = &pipelineDynamicStateCreateInfo;
 
-   VkPipelineTessellationStateCreateInfo tci = {0};
-   VkPipelineTessellationDomainOriginStateCreateInfo tdci = {0};
    if (prog->shaders[PIPE_SHADER_TESS_CTRL] && prog->shaders[PIPE_SHADER_TESS_EVAL]) {
       tci.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
       tci.patchControlPoints = state->vertices_per_patch + 1;
@@ -337,7 +366,6 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
       tdci.domainOrigin = VK_TESSELLATION_DOMAIN_ORIGIN_LOWER_LEFT;
    }
 
-   VkPipelineShaderStageCreateInfo shader_stages[ZINK_SHADER_COUNT];
    uint32_t num_stages = 0;
    for (int i = 0; i < ZINK_SHADER_COUNT; ++i) {
       if (!prog->modules[i])
@@ -355,6 +383,7 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
    pci.pStages = shader_stages;
    pci.stageCount = num_stages;
 
+create:;
    VkPipeline pipeline;
    if (VKSCR(CreateGraphicsPipelines)(screen->dev, prog->base.pipeline_cache,
                                       1, &pci, NULL, &pipeline) != VK_SUCCESS) {
@@ -365,6 +394,70 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
    return pipeline;
 }
 
+VkPipeline
+zink_create_gfx_pipeline(struct zink_screen *screen,
+                         struct zink_gfx_program *prog,
+                         struct zink_gfx_pipeline_state *state,
+                         const uint8_t *binding_map,
+                         VkPrimitiveTopology primitive_topology)
+{
+   return create_gfx_pipeline(screen, prog, state, binding_map, primitive_topology, 0);
+}
+
+VkPipeline
+zink_create_gfx_pipeline_input(struct zink_screen *screen,
+                               struct zink_gfx_program *prog,
+                               struct zink_gfx_pipeline_state *state,
+                               const uint8_t *binding_map,
+                               VkPrimitiveTopology primitive_topology)
+{
+   return create_gfx_pipeline(screen, prog, state, binding_map, primitive_topology,
+                              VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+}
+
+VkPipeline
+zink_create_gfx_pipeline_library(struct zink_screen *screen,
+                                 struct zink_gfx_program *prog,
+                                 struct zink_gfx_pipeline_state *state,
+                                 VkPrimitiveTopology primitive_topology)
+{
+   return create_gfx_pipeline(screen, prog, state, NULL, primitive_topology,
+                              VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                              VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+                              VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+}
+
+VkPipeline
+zink_create_gfx_pipeline_combined(struct zink_screen *screen,
+                                  struct zink_gfx_program *prog,
+                                  VkPipeline input,
+                                  VkPipeline library,
+                                  VkPipelineCache pipeline_cache,
+                                  bool optimized)
+{
+   VkPipeline libraries[] = {input, library};
+   VkPipelineLibraryCreateInfoKHR libstate = {0};
+   libstate.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+   libstate.libraryCount = ARRAY_SIZE(libraries);
+   libstate.pLibraries = libraries;
+
+   VkGraphicsPipelineCreateInfo pci = {0};
+   pci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   pci.pNext = &libstate;
+   pci.layout = prog->base.layout;
+   if (optimized)
+      pci.flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+
+   VkPipeline pipeline;
+   if (VKSCR(CreateGraphicsPipelines)(screen->dev, pipeline_cache,
+                                      1, &pci, NULL, &pipeline) != VK_SUCCESS) {
+      mesa_loge("ZINK: vkCreateGraphicsPipelines failed");
+      return VK_NULL_HANDLE;
+   }
+
+   return pipeline;
+}
+
 VkPipeline
 zink_create_compute_pipeline(struct zink_screen *screen, struct zink_compute_program *comp, struct zink_compute_pipeline_state *state)
 {
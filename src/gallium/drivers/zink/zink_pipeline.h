@@ -87,6 +87,7 @@ struct zink_gfx_pipeline_state {
    struct zink_blend_state *blend_state;
    struct zink_render_pass *render_pass;
    VkPipeline pipeline;
+   bool pipeline_optimized; //false while a fast-linked pipeline is bound
    unsigned idx : 8;
    enum pipe_prim_type gfx_prim_mode; //pending mode
 };
@@ -116,6 +117,29 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
                          const uint8_t *binding_map,
                          VkPrimitiveTopology primitive_topology);
 
+/* VK_EXT_graphics_pipeline_library: the vertex input interface library */
+VkPipeline
+zink_create_gfx_pipeline_input(struct zink_screen *screen,
+                               struct zink_gfx_program *prog,
+                               struct zink_gfx_pipeline_state *state,
+                               const uint8_t *binding_map,
+                               VkPrimitiveTopology primitive_topology);
+
+/* VK_EXT_graphics_pipeline_library: a library with all other parts */
+VkPipeline
+zink_create_gfx_pipeline_library(struct zink_screen *screen,
+                                 struct zink_gfx_program *prog,
+                                 struct zink_gfx_pipeline_state *state,
+                                 VkPrimitiveTopology primitive_topology);
+
+VkPipeline
+zink_create_gfx_pipeline_combined(struct zink_screen *screen,
+                                  struct zink_gfx_program *prog,
+                                  VkPipeline input,
+                                  VkPipeline library,
+                                  VkPipelineCache pipeline_cache,
+                                  bool optimized);
+
 VkPipeline
 zink_create_compute_pipeline(struct zink_screen *screen, struct zink_compute_program *comp, struct zink_compute_pipeline_state *state);
 #endif
@@ -47,6 +47,34 @@
 struct gfx_pipeline_cache_entry {
    struct zink_gfx_pipeline_state state;
    VkPipeline pipeline;
+
+   /* With VK_EXT_graphics_pipeline_library, pipeline starts out as the
+    * fast-linked unoptimized_pipeline and is replaced by optimized_pipeline
+    * once that is compiled on the screen's optimize_queue.
+    */
+   bool optimized;
+   struct zink_gfx_program *prog;
+   VkPipeline input;
+   VkPipeline library;
+   VkPipeline unoptimized_pipeline;
+   VkPipeline optimized_pipeline;
+   struct util_queue_fence fence;
+};
+
+struct gfx_library_cache_entry {
+   struct zink_gfx_pipeline_state state;
+   VkPipeline pipeline;
+};
+
+struct gfx_input_key {
+   uint32_t vertex_hash;
+   bool uses_dynamic_stride;
+   bool primitive_restart;
+};
+
+struct gfx_input_cache_entry {
+   struct gfx_input_key key;
+   VkPipeline pipeline;
 };
 
 struct compute_pipeline_cache_entry {
@@ -235,6 +263,35 @@ hash_gfx_pipeline_state(const void *key)
    return XXH32(&state->dyn_state1, sizeof(state->dyn_state1), hash);
 }
 
+/* everything but the vertex input state */
+static bool
+equals_gfx_library_state(const void *a, const void *b)
+{
+   const struct zink_gfx_pipeline_state *sa = a;
+   const struct zink_gfx_pipeline_state *sb = b;
+   if (!sa->have_EXT_extended_dynamic_state) {
+      if (sa->dyn_state1.front_face != sb->dyn_state1.front_face)
+         return false;
+      if (!!sa->dyn_state1.depth_stencil_alpha_state != !!sb->dyn_state1.depth_stencil_alpha_state ||
+          (sa->dyn_state1.depth_stencil_alpha_state &&
+           memcmp(sa->dyn_state1.depth_stencil_alpha_state, sb->dyn_state1.depth_stencil_alpha_state,
+                  sizeof(struct zink_depth_stencil_alpha_hw_state))))
+         return false;
+   }
+   if (!sa->have_EXT_extended_dynamic_state2) {
+      if (sa->dyn_state2.primitive_restart != sb->dyn_state2.primitive_restart)
+         return false;
+   }
+   return !memcmp(sa->modules, sb->modules, sizeof(sa->modules)) &&
+          !memcmp(a, b, offsetof(struct zink_gfx_pipeline_state, hash));
+}
+
+static bool
+equals_gfx_input_key(const void *a, const void *b)
+{
+   return !memcmp(a, b, sizeof(struct gfx_input_key));
+}
+
 static bool
 equals_gfx_pipeline_state(const void *a, const void *b)
 {
@@ -255,21 +312,7 @@ equals_gfx_pipeline_state(const void *a, const void *b)
             return false;
       }
    }
-   if (!sa->have_EXT_extended_dynamic_state) {
-      if (sa->dyn_state1.front_face != sb->dyn_state1.front_face)
-         return false;
-      if (!!sa->dyn_state1.depth_stencil_alpha_state != !!sb->dyn_state1.depth_stencil_alpha_state ||
-          (sa->dyn_state1.depth_stencil_alpha_state &&
-           memcmp(sa->dyn_state1.depth_stencil_alpha_state, sb->dyn_state1.depth_stencil_alpha_state,
-                  sizeof(struct zink_depth_stencil_alpha_hw_state))))
-         return false;
-   }
-   if (!sa->have_EXT_extended_dynamic_state2) {
-      if (sa->dyn_state2.primitive_restart != sb->dyn_state2.primitive_restart)
-         return false;
-   }
-   return !memcmp(sa->modules, sb->modules, sizeof(sa->modules)) &&
-          !memcmp(a, b, offsetof(struct zink_gfx_pipeline_state, hash));
+   return equals_gfx_library_state(a, b);
 }
 
 void
@@ -458,6 +501,10 @@ zink_create_gfx_program(struct zink_context *ctx,
 
    for (int i = 0; i < ARRAY_SIZE(prog->pipelines); ++i) {
       _mesa_hash_table_init(&prog->pipelines[i], prog, NULL, equals_gfx_pipeline_state);
+      if (screen->info.have_EXT_graphics_pipeline_library) {
+         _mesa_hash_table_init(&prog->libs[i], prog, NULL, equals_gfx_library_state);
+         _mesa_hash_table_init(&prog->inputs[i], prog, NULL, equals_gfx_input_key);
+      }
       /* only need first 3/4 for point/line/tri/patch */
       if (screen->info.have_EXT_extended_dynamic_state &&
           i == (prog->last_vertex_stage->nir->info.stage == MESA_SHADER_TESS_EVAL ? 4 : 3))
@@ -706,9 +753,30 @@ zink_destroy_gfx_program(struct zink_context *ctx,
       hash_table_foreach(&prog->pipelines[i], entry) {
          struct gfx_pipeline_cache_entry *pc_entry = entry->data;
 
-         VKSCR(DestroyPipeline)(screen->dev, pc_entry->pipeline, NULL);
+         util_queue_fence_wait(&pc_entry->fence);
+         if (pc_entry->unoptimized_pipeline) {
+            VKSCR(DestroyPipeline)(screen->dev, pc_entry->unoptimized_pipeline, NULL);
+            VKSCR(DestroyPipeline)(screen->dev, pc_entry->optimized_pipeline, NULL);
+         } else {
+            VKSCR(DestroyPipeline)(screen->dev, pc_entry->pipeline, NULL);
+         }
+         util_queue_fence_destroy(&pc_entry->fence);
          free(pc_entry);
       }
+      if (!screen->info.have_EXT_graphics_pipeline_library)
+         continue;
+      hash_table_foreach(&prog->libs[i], entry) {
+         struct gfx_library_cache_entry *lib_entry = entry->data;
+
+         VKSCR(DestroyPipeline)(screen->dev, lib_entry->pipeline, NULL);
+         free(lib_entry);
+      }
+      hash_table_foreach(&prog->inputs[i], entry) {
+         struct gfx_input_cache_entry *input_entry = entry->data;
+
+         VKSCR(DestroyPipeline)(screen->dev, input_entry->pipeline, NULL);
+         free(input_entry);
+      }
    }
    if (prog->base.pipeline_cache)
       VKSCR(DestroyPipelineCache)(screen->dev, prog->base.pipeline_cache, NULL);
@@ -793,6 +861,124 @@ check_vertex_strides(struct zink_context *ctx)
    return true;
 }
 
+static VkPipeline
+get_gfx_pipeline_library(struct zink_screen *screen,
+                         struct zink_gfx_program *prog,
+                         struct zink_gfx_pipeline_state *state,
+                         unsigned idx, VkPrimitiveTopology vkmode)
+{
+   const uint32_t hash = state->hash ^ prog->last_variant_hash;
+   struct hash_entry *entry = _mesa_hash_table_search_pre_hashed(&prog->libs[idx], hash, state);
+   if (entry) {
+      struct gfx_library_cache_entry *lib_entry = entry->data;
+      return lib_entry->pipeline;
+   }
+
+   VkPipeline pipeline = zink_create_gfx_pipeline_library(screen, prog, state, vkmode);
+   if (pipeline == VK_NULL_HANDLE)
+      return VK_NULL_HANDLE;
+
+   struct gfx_library_cache_entry *lib_entry = CALLOC_STRUCT(gfx_library_cache_entry);
+   if (!lib_entry) {
+      VKSCR(DestroyPipeline)(screen->dev, pipeline, NULL);
+      return VK_NULL_HANDLE;
+   }
+   memcpy(&lib_entry->state, state, sizeof(*state));
+   lib_entry->pipeline = pipeline;
+   _mesa_hash_table_insert_pre_hashed(&prog->libs[idx], hash, lib_entry, lib_entry);
+   return pipeline;
+}
+
+static VkPipeline
+get_gfx_pipeline_input(struct zink_context *ctx,
+                       struct zink_gfx_program *prog,
+                       struct zink_gfx_pipeline_state *state,
+                       unsigned idx, VkPrimitiveTopology vkmode)
+{
+   struct zink_screen *screen = zink_screen(ctx->base.screen);
+   struct gfx_input_key key;
+   memset(&key, 0, sizeof(key));
+   /* with dynamic vertex input, only attribute-less pipelines have static state */
+   if (screen->info.have_EXT_vertex_input_dynamic_state)
+      key.vertex_hash = !state->element_state->num_attribs;
+   else
+      key.vertex_hash = state->vertex_hash;
+   key.uses_dynamic_stride = state->uses_dynamic_stride;
+   if (!screen->info.have_EXT_extended_dynamic_state2)
+      key.primitive_restart = state->dyn_state2.primitive_restart;
+
+   const uint32_t hash = _mesa_hash_data(&key, sizeof(key));
+   struct hash_entry *entry = _mesa_hash_table_search_pre_hashed(&prog->inputs[idx], hash, &key);
+   if (entry) {
+      struct gfx_input_cache_entry *input_entry = entry->data;
+      return input_entry->pipeline;
+   }
+
+   VkPipeline pipeline = zink_create_gfx_pipeline_input(screen, prog, state,
+                                                        ctx->element_state->binding_map,
+                                                        vkmode);
+   if (pipeline == VK_NULL_HANDLE)
+      return VK_NULL_HANDLE;
+
+   struct gfx_input_cache_entry *input_entry = CALLOC_STRUCT(gfx_input_cache_entry);
+   if (!input_entry) {
+      VKSCR(DestroyPipeline)(screen->dev, pipeline, NULL);
+      return VK_NULL_HANDLE;
+   }
+   input_entry->key = key;
+   input_entry->pipeline = pipeline;
+   _mesa_hash_table_insert_pre_hashed(&prog->inputs[idx], hash, input_entry, input_entry);
+   return pipeline;
+}
+
+static void
+optimized_compile_job(void *data, void *gdata, int thread_index)
+{
+   struct gfx_pipeline_cache_entry *pc_entry = data;
+   struct zink_screen *screen = gdata;
+   /* the program's cache may be externally synchronized with the context thread */
+   VkPipelineCache pipeline_cache = screen->info.have_EXT_pipeline_creation_cache_control ?
+                                    VK_NULL_HANDLE : pc_entry->prog->base.pipeline_cache;
+
+   pc_entry->optimized_pipeline = zink_create_gfx_pipeline_combined(screen, pc_entry->prog,
+                                                                    pc_entry->input,
+                                                                    pc_entry->library,
+                                                                    pipeline_cache, true);
+}
+
+/* Fast-link a pipeline from libraries, which are much cheaper to get than a
+ * full pipeline whenever only the vertex input or only the other state
+ * changed, and compile the optimized pipeline in the background.
+ */
+static bool
+create_gfx_pipeline_from_libraries(struct zink_context *ctx,
+                                   struct zink_gfx_program *prog,
+                                   struct zink_gfx_pipeline_state *state,
+                                   struct gfx_pipeline_cache_entry *pc_entry,
+                                   unsigned idx, VkPrimitiveTopology vkmode)
+{
+   struct zink_screen *screen = zink_screen(ctx->base.screen);
+
+   pc_entry->input = get_gfx_pipeline_input(ctx, prog, state, idx, vkmode);
+   pc_entry->library = get_gfx_pipeline_library(screen, prog, state, idx, vkmode);
+   if (pc_entry->input == VK_NULL_HANDLE || pc_entry->library == VK_NULL_HANDLE)
+      return false;
+
+   pc_entry->unoptimized_pipeline = zink_create_gfx_pipeline_combined(screen, prog,
+                                                                      pc_entry->input,
+                                                                      pc_entry->library,
+                                                                      prog->base.pipeline_cache,
+                                                                      false);
+   if (pc_entry->unoptimized_pipeline == VK_NULL_HANDLE)
+      return false;
+
+   pc_entry->pipeline = pc_entry->unoptimized_pipeline;
+   pc_entry->prog = prog;
+   util_queue_add_job(&screen->optimize_queue, pc_entry, &pc_entry->fence,
+                      optimized_compile_job, NULL, 0);
+   return true;
+}
+
 VkPipeline
 zink_get_gfx_pipeline(struct zink_context *ctx,
                       struct zink_gfx_program *prog,
@@ -809,7 +995,7 @@ zink_get_gfx_pipeline(struct zink_context *ctx,
    assert(idx <= ARRAY_SIZE(prog->pipelines));
    if (!state->dirty && !state->modules_changed &&
        (have_EXT_vertex_input_dynamic_state || !ctx->vertex_state_changed) &&
-       idx == state->idx)
+       idx == state->idx && state->pipeline_optimized)
       return state->pipeline;
 
    struct hash_entry *entry = NULL;
@@ -851,26 +1037,45 @@ zink_get_gfx_pipeline(struct zink_context *ctx,
 
    if (!entry) {
       util_queue_fence_wait(&prog->base.cache_fence);
-      VkPipeline pipeline = zink_create_gfx_pipeline(screen, prog, state,
-                                                     ctx->element_state->binding_map,
-                                                     vkmode);
-      if (pipeline == VK_NULL_HANDLE)
-         return VK_NULL_HANDLE;
-
-      zink_screen_update_pipeline_cache(screen, &prog->base);
       struct gfx_pipeline_cache_entry *pc_entry = CALLOC_STRUCT(gfx_pipeline_cache_entry);
       if (!pc_entry)
          return VK_NULL_HANDLE;
 
       memcpy(&pc_entry->state, state, sizeof(*state));
-      pc_entry->pipeline = pipeline;
+      util_queue_fence_init(&pc_entry->fence);
 
+      if (screen->info.have_EXT_graphics_pipeline_library) {
+         if (!create_gfx_pipeline_from_libraries(ctx, prog, state, pc_entry, idx, vkmode)) {
+            util_queue_fence_destroy(&pc_entry->fence);
+            free(pc_entry);
+            return VK_NULL_HANDLE;
+         }
+      } else {
+         pc_entry->pipeline = zink_create_gfx_pipeline(screen, prog, state,
+                                                       ctx->element_state->binding_map,
+                                                       vkmode);
+         if (pc_entry->pipeline == VK_NULL_HANDLE) {
+            util_queue_fence_destroy(&pc_entry->fence);
+            free(pc_entry);
+            return VK_NULL_HANDLE;
+         }
+         pc_entry->optimized = true;
+      }
+
+      zink_screen_update_pipeline_cache(screen, &prog->base);
       entry = _mesa_hash_table_insert_pre_hashed(&prog->pipelines[idx], state->final_hash, pc_entry, pc_entry);
       assert(entry);
    }
 
    struct gfx_pipeline_cache_entry *cache_entry = entry->data;
+   if (!cache_entry->optimized && util_queue_fence_is_signalled(&cache_entry->fence)) {
+      /* keep using the fast-linked pipeline if the optimized one failed */
+      if (cache_entry->optimized_pipeline)
+         cache_entry->pipeline = cache_entry->optimized_pipeline;
+      cache_entry->optimized = true;
+   }
    state->pipeline = cache_entry->pipeline;
+   state->pipeline_optimized = cache_entry->optimized;
    state->idx = idx;
    return state->pipeline;
 }
@@ -110,6 +110,9 @@ struct zink_gfx_program {
 
    struct zink_shader *shaders[ZINK_SHADER_COUNT];
    struct hash_table pipelines[11]; // number of draw modes we support
+   /* VK_EXT_graphics_pipeline_library parts, per draw mode like pipelines */
+   struct hash_table libs[11]; //everything but the vertex input interface
+   struct hash_table inputs[11]; //vertex input interface
    uint32_t default_variant_hash;
    uint32_t last_variant_hash;
 };
@@ -1265,6 +1265,8 @@ zink_destroy_screen(struct pipe_screen *pscreen)
 
    if (screen->threaded)
       util_queue_destroy(&screen->flush_queue);
+   if (util_queue_is_initialized(&screen->optimize_queue))
+      util_queue_destroy(&screen->optimize_queue);
 
    simple_mtx_destroy(&screen->queue_lock);
    VKSCR(DestroyDevice)(screen->dev, NULL);
@@ -2157,6 +2159,12 @@ zink_internal_create_screen(const struct pipe_screen_config *config)
       goto fail;
    }
 
+   if (screen->info.have_EXT_graphics_pipeline_library &&
+       !util_queue_init(&screen->optimize_queue, "zoq", 8, 1, UTIL_QUEUE_INIT_RESIZE_IF_FULL, screen)) {
+      mesa_loge("zink: Failed to create pipeline optimization queue, not using graphics pipeline libraries\n");
+      screen->info.have_EXT_graphics_pipeline_library = false;
+   }
+
    zink_internal_setup_moltenvk(screen);
    if (!screen->info.have_KHR_timeline_semaphore) {
       mesa_loge("zink: KHR_timeline_semaphore is required");
@@ -2322,6 +2330,8 @@ fail:
       util_dl_close(screen->loader_lib);
    if (screen->threaded)
       util_queue_destroy(&screen->flush_queue);
+   if (util_queue_is_initialized(&screen->optimize_queue))
+      util_queue_destroy(&screen->optimize_queue);
 
    ralloc_free(screen);
    return NULL;
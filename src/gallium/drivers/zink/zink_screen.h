@@ -114,6 +114,8 @@ struct zink_screen {
    struct disk_cache *disk_cache;
    struct util_queue cache_put_thread;
    struct util_queue cache_get_thread;
+   /* compiles link-time optimized VK_EXT_graphics_pipeline_library pipelines */
+   struct util_queue optimize_queue;
 
    struct util_live_shader_cache shaders;
 
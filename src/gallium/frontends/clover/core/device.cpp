@@ -27,6 +27,7 @@
 #include "pipe/p_state.h"
 #include "spirv/invocation.hpp"
 #include "util/bitscan.h"
+#include "util/disk_cache.h"
 #include "util/u_debug.h"
 #include "spirv/invocation.hpp"
 #include "nir/invocation.hpp"
@@ -134,10 +135,37 @@ namespace {
 
       return version;
    }
+
+   disk_cache *
+   create_binary_cache(const device &dev, pipe_screen *pipe) {
+      struct mesa_sha1 ctx;
+      unsigned char sha1[20];
+      char cache_id[20 * 2 + 1];
+      _mesa_sha1_init(&ctx);
+
+      if (!disk_cache_get_function_identifier((void *)create_binary_cache,
+                                              &ctx))
+         return NULL;
+
+      // Native binaries come from the LLVM backend clover is linked
+      // against, NIR ones depend on the driver's compiler options.
+      const std::string name = dev.device_name();
+      _mesa_sha1_update(&ctx, name.data(), name.size());
+      if (pipe->get_driver_uuid) {
+         char uuid[PIPE_UUID_SIZE];
+         pipe->get_driver_uuid(pipe, uuid);
+         _mesa_sha1_update(&ctx, uuid, sizeof(uuid));
+      }
+
+      _mesa_sha1_final(&ctx, sha1);
+
+      disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
+      return disk_cache_create("clover", cache_id, 0);
+   }
 }
 
 device::device(clover::platform &platform, pipe_loader_device *ldev) :
-   platform(platform), clc_cache(NULL), ldev(ldev) {
+   platform(platform), clc_cache(NULL), binary_cache(NULL), ldev(ldev) {
    pipe = pipe_loader_create_screen(ldev);
    if (pipe && pipe->get_param(pipe, PIPE_CAP_COMPUTE)) {
       const bool has_supported_ir = supports_ir(PIPE_SHADER_IR_NATIVE) ||
@@ -155,6 +183,7 @@ device::device(clover::platform &platform, pipe_loader_device *ldev) :
                                   &minor);
          version = CL_MAKE_VERSION(major, minor, 0);
 
+         binary_cache = create_binary_cache(*this, pipe);
       }
 
       if (supports_ir(PIPE_SHADER_IR_NATIVE))
@@ -176,6 +205,8 @@ device::device(clover::platform &platform, pipe_loader_device *ldev) :
 device::~device() {
    if (clc_cache)
       disk_cache_destroy(clc_cache);
+   if (binary_cache)
+      disk_cache_destroy(binary_cache);
    if (pipe)
       pipe->destroy(pipe);
    if (ldev)
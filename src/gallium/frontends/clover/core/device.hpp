@@ -118,6 +118,7 @@ namespace clover {
 
       lazy<std::shared_ptr<nir_shader>> clc_nir;
       disk_cache *clc_cache;
+      disk_cache *binary_cache;
       cl_version version;
       cl_version clc_version;
    private:
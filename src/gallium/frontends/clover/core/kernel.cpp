@@ -64,7 +64,7 @@ kernel::launch(command_queue &q,
                const std::vector<size_t> &grid_offset,
                const std::vector<size_t> &grid_size,
                const std::vector<size_t> &block_size) {
-   const auto b = program().build(q.device()).bin;
+   const auto &b = program().build(q.device()).bin;
    const auto reduced_grid_size =
       map(divides(), grid_size, block_size);
 
@@ -195,9 +195,9 @@ kernel::exec_context::bind(intrusive_ptr<command_queue> _q,
 
    // Bind kernel arguments.
    auto &b = kern.program().build(q->device()).bin;
-   auto bsym = find(name_equals(kern.name()), b.syms);
-   auto bargs = bsym.args;
-   auto msec = find(id_type_equals(bsym.section, binary::section::text_executable), b.secs);
+   auto &bsym = find(name_equals(kern.name()), b.syms);
+   auto &bargs = bsym.args;
+   auto &msec = find(id_type_equals(bsym.section, binary::section::text_executable), b.secs);
    auto explicit_arg = kern._args.begin();
 
    for (auto &barg : bargs) {
@@ -22,9 +22,79 @@
 
 #include "core/compiler.hpp"
 #include "core/program.hpp"
+#include "util/disk_cache.h"
+
+#include <sstream>
 
 using namespace clover;
 
+namespace {
+   ///
+   /// Accumulates everything a build depends on into a cache key.
+   ///
+   class build_key {
+   public:
+      build_key(const device &dev, const char *step) {
+         add(step);
+         add(std::to_string(dev.ir_format()));
+         add(dev.ir_target());
+         add(std::to_string(dev.address_bits()));
+         add(std::to_string(dev.version));
+         add(std::to_string(dev.clc_version));
+      }
+
+      void
+      add(const std::string &s) {
+         const uint64_t size = s.size();
+         blob.append((const char *)&size, sizeof(size));
+         blob.append(s);
+      }
+
+      void
+      compute(disk_cache *cache, cache_key key) const {
+         disk_cache_compute_key(cache, blob.data(), blob.size(), key);
+      }
+
+   private:
+      std::string blob;
+   };
+
+   std::string
+   serialize_binary(const binary &b) {
+      std::stringbuf bin;
+      std::ostream s(&bin);
+      b.serialize(s);
+      return bin.str();
+   }
+
+   bool
+   load_cached_binary(disk_cache *cache, const cache_key key, binary &b) {
+      size_t size;
+      void *data = disk_cache_get(cache, key, &size);
+      if (!data)
+         return false;
+
+      std::stringbuf bin(std::string{ (char *)data, size });
+      free(data);
+
+      try {
+         std::istream s(&bin);
+         b = binary::deserialize(s);
+      } catch (std::istream::failure &) {
+         return false;
+      }
+
+      return !b.secs.empty();
+   }
+
+   void
+   store_cached_binary(disk_cache *cache, const cache_key key,
+                       const binary &b) {
+      const std::string data = serialize_binary(b);
+      disk_cache_put(cache, key, data.data(), data.size(), NULL);
+   }
+}
+
 program::program(clover::context &ctx, std::string &&source,
                  enum il_type il_type) :
    context(ctx), _devices(ctx.devices()), _source(std::move(source)),
@@ -52,8 +122,28 @@ program::compile(const ref_vector<device> &devs, const std::string &opts,
          std::string log;
 
          try {
-            const binary b =
-               compiler::compile_program(*this, headers, dev, opts, log);
+            disk_cache *cache = dev.binary_cache;
+            cache_key key;
+            binary b;
+
+            if (cache) {
+               build_key k(dev, "compile");
+               k.add(std::to_string((int)_il_type));
+               k.add(_source);
+               k.add(opts);
+               for (auto &h : headers) {
+                  k.add(h.first);
+                  k.add(h.second);
+               }
+               k.compute(cache, key);
+            }
+
+            if (!cache || !load_cached_binary(cache, key, b)) {
+               b = compiler::compile_program(*this, headers, dev, opts, log);
+               if (cache)
+                  store_cached_binary(cache, key, b);
+            }
+
             _builds[&dev] = { b, opts, log };
          } catch (...) {
             _builds[&dev] = { binary(), opts, log };
@@ -75,7 +165,27 @@ program::link(const ref_vector<device> &devs, const std::string &opts,
       std::string log = _builds[&dev].log;
 
       try {
-         const binary b = compiler::link_program(bs, dev, opts, log);
+         // The final NIR binary has libclc linked in, which isn't part of
+         // the key, so only native binaries are cached here.
+         disk_cache *cache = dev.ir_format() == PIPE_SHADER_IR_NATIVE ?
+                             dev.binary_cache : NULL;
+         cache_key key;
+         binary b;
+
+         if (cache) {
+            build_key k(dev, "link");
+            k.add(opts);
+            for (auto &lb : bs)
+               k.add(serialize_binary(lb));
+            k.compute(cache, key);
+         }
+
+         if (!cache || !load_cached_binary(cache, key, b)) {
+            b = compiler::link_program(bs, dev, opts, log);
+            if (cache)
+               store_cached_binary(cache, key, b);
+         }
+
          _builds[&dev] = { b, opts, log };
       } catch (...) {
          _builds[&dev] = { binary(), opts, log };
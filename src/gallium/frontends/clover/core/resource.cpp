@@ -26,7 +26,9 @@
 #include "util/u_sampler.h"
 #include "util/format/u_format.h"
 #include "util/u_inlines.h"
+#include "util/u_memory.h"
 #include "util/u_resource.h"
+#include "util/os_misc.h"
 
 using namespace clover;
 
@@ -156,7 +158,7 @@ resource::unbind_surface(command_queue &q, pipe_surface *st) {
 
 root_resource::root_resource(clover::device &dev, memory_obj &obj,
                              command_queue &q, const void *data_ptr) :
-   resource(dev, obj) {
+   resource(dev, obj), host_storage(NULL) {
    pipe_resource info {};
 
    if (image *img = dynamic_cast<image *>(&obj)) {
@@ -185,6 +187,28 @@ root_resource::root_resource(clover::device &dev, memory_obj &obj,
          return;
    }
 
+   // Back host accessible buffers by page aligned host memory when
+   // possible, so that mapping them doesn't need a staging copy.
+   if (obj.flags() & CL_MEM_ALLOC_HOST_PTR && info.target == PIPE_BUFFER &&
+       dev.allows_user_pointers()) {
+      uint64_t page_size = 4096;
+      os_get_page_size(&page_size);
+
+      host_storage = align_malloc(align64(info.width0, page_size), page_size);
+      if (host_storage) {
+         pipe = dev.pipe->resource_from_user_memory(dev.pipe, &info,
+                                                    host_storage);
+         if (pipe) {
+            if (data_ptr)
+               memcpy(host_storage, data_ptr, info.width0);
+            return;
+         }
+
+         align_free(host_storage);
+         host_storage = NULL;
+      }
+   }
+
    if (obj.flags() & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR)) {
       info.usage = PIPE_USAGE_STAGING;
    }
@@ -209,12 +233,13 @@ root_resource::root_resource(clover::device &dev, memory_obj &obj,
 
 root_resource::root_resource(clover::device &dev, memory_obj &obj,
                              root_resource &r) :
-   resource(dev, obj) {
+   resource(dev, obj), host_storage(NULL) {
    assert(0); // XXX -- resource shared among dev and r.dev
 }
 
 root_resource::~root_resource() {
    pipe_resource_reference(&this->pipe, NULL);
+   align_free(host_storage);
 }
 
 sub_resource::sub_resource(resource &r, const vector &offset) :
@@ -94,6 +94,11 @@ namespace clover {
                     command_queue &q, const void *data_ptr);
       root_resource(clover::device &dev, memory_obj &obj, root_resource &r);
       virtual ~root_resource();
+
+   private:
+      // Host memory backing the resource for CL_MEM_ALLOC_HOST_PTR
+      // buffers created from user memory.
+      void *host_storage;
    };
 
    ///
@@ -58,6 +58,7 @@ driOptionDescription __dri2ConfigOptions[] = {
 
       DRI_CONF_SECTION_PERFORMANCE
          DRI_CONF_VBLANK_MODE(DRI_CONF_VBLANK_DEF_INTERVAL_1)
+         DRI_CONF_DRI3_MAX_BACK(0)
       DRI_CONF_SECTION_END
 };
 
@@ -520,7 +520,7 @@ get_viewport_xform(struct rendering_state *state,
 
     VK_DYNAMIC_STATE_COLOR_WRITE_ENABLE_EXT
 */
-static int conv_dynamic_state_idx(VkDynamicState dyn_state)
+int lvp_conv_dynamic_state_idx(VkDynamicState dyn_state)
 {
    if (dyn_state <= VK_DYNAMIC_STATE_STENCIL_REFERENCE)
       return dyn_state;
@@ -549,23 +549,10 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
                                      struct rendering_state *state)
 {
    LVP_FROM_HANDLE(lvp_pipeline, pipeline, cmd->u.bind_pipeline.pipeline);
-   bool dynamic_states[VK_DYNAMIC_STATE_STENCIL_REFERENCE+32];
+   const bool *dynamic_states = pipeline->dynamic_states;
    unsigned fb_samples = 0;
    bool clip_halfz = state->rs_state.clip_halfz;
-
-   memset(dynamic_states, 0, sizeof(dynamic_states));
-   if (pipeline->graphics_create_info.pDynamicState)
-   {
-      const VkPipelineDynamicStateCreateInfo *dyn = pipeline->graphics_create_info.pDynamicState;
-      int i;
-      for (i = 0; i < dyn->dynamicStateCount; i++) {
-         int idx = conv_dynamic_state_idx(dyn->pDynamicStates[i]);
-         if (idx == -1)
-            continue;
-         dynamic_states[idx] = true;
-      }
-   }
-   state->has_color_write_disables = dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_COLOR_WRITE_ENABLE_EXT)];
+   state->has_color_write_disables = dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_COLOR_WRITE_ENABLE_EXT)];
 
    for (enum pipe_shader_type sh = PIPE_SHADER_VERTEX; sh < PIPE_SHADER_COMPUTE; sh++)
       state->has_pcbuf[sh] = false;
@@ -645,7 +632,7 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
       else
          state->rs_state.depth_clip_near = state->rs_state.depth_clip_far = depth_clip_state->depthClipEnable;
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT)])
          state->rs_state.rasterizer_discard = rsc->rasterizerDiscardEnable;
 
       state->rs_state.line_smooth = pipeline->line_smooth;
@@ -662,12 +649,12 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
 
       if (!dynamic_states[VK_DYNAMIC_STATE_LINE_WIDTH])
          state->rs_state.line_width = rsc->lineWidth;
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_LINE_STIPPLE_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_LINE_STIPPLE_EXT)]) {
          state->rs_state.line_stipple_factor = pipeline->line_stipple_factor;
          state->rs_state.line_stipple_pattern = pipeline->line_stipple_pattern;
       }
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT)])
          state->depth_bias.enabled = pipeline->graphics_create_info.pRasterizationState->depthBiasEnable;
       if (!dynamic_states[VK_DYNAMIC_STATE_DEPTH_BIAS]) {
          state->depth_bias.offset_units = rsc->depthBiasConstantFactor;
@@ -675,10 +662,10 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
          state->depth_bias.offset_clamp = rsc->depthBiasClamp;
       }
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_CULL_MODE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_CULL_MODE_EXT)])
          state->rs_state.cull_face = vk_cull_to_pipe(rsc->cullMode);
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_FRONT_FACE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_FRONT_FACE_EXT)])
          state->rs_state.front_ccw = (rsc->frontFace == VK_FRONT_FACE_COUNTER_CLOCKWISE);
       state->rs_dirty = true;
    }
@@ -686,13 +673,13 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
    if (pipeline->graphics_create_info.pDepthStencilState) {
       const VkPipelineDepthStencilStateCreateInfo *dsa = pipeline->graphics_create_info.pDepthStencilState;
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)])
          state->dsa_state.depth_enabled = dsa->depthTestEnable;
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)])
          state->dsa_state.depth_writemask = dsa->depthWriteEnable;
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT)])
          state->dsa_state.depth_func = dsa->depthCompareOp;
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT)])
          state->dsa_state.depth_bounds_test = dsa->depthBoundsTestEnable;
 
       if (!dynamic_states[VK_DYNAMIC_STATE_DEPTH_BOUNDS]) {
@@ -700,12 +687,12 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
          state->dsa_state.depth_bounds_max = dsa->maxDepthBounds;
       }
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT)]) {
          state->dsa_state.stencil[0].enabled = dsa->stencilTestEnable;
          state->dsa_state.stencil[1].enabled = dsa->stencilTestEnable;
       }
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_STENCIL_OP_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_STENCIL_OP_EXT)]) {
          state->dsa_state.stencil[0].func = dsa->front.compareOp;
          state->dsa_state.stencil[0].fail_op = vk_conv_stencil_op(dsa->front.failOp);
          state->dsa_state.stencil[0].zpass_op = vk_conv_stencil_op(dsa->front.passOp);
@@ -744,7 +731,7 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
 
       if (cb->logicOpEnable) {
          state->blend_state.logicop_enable = VK_TRUE;
-         if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_LOGIC_OP_EXT)])
+         if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_LOGIC_OP_EXT)])
             state->blend_state.logicop_func = vk_conv_logic_op(cb->logicOp);
       }
 
@@ -820,14 +807,14 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
       state->rs_dirty = true;
    }
 
-   if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_VERTEX_INPUT_EXT)]) {
+   if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_VERTEX_INPUT_EXT)]) {
       const VkPipelineVertexInputStateCreateInfo *vi = pipeline->graphics_create_info.pVertexInputState;
       int i;
       const VkPipelineVertexInputDivisorStateCreateInfoEXT *div_state =
          vk_find_struct_const(vi->pNext,
                               PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT);
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT)]) {
          for (i = 0; i < vi->vertexBindingDescriptionCount; i++) {
             state->vb[vi->pVertexBindingDescriptions[i].binding].stride = vi->pVertexBindingDescriptions[i].stride;
          }
@@ -884,16 +871,16 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
    {
       const VkPipelineInputAssemblyStateCreateInfo *ia = pipeline->graphics_create_info.pInputAssemblyState;
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT)]) {
          state->info.mode = vk_conv_topology(ia->topology);
          state->rs_dirty = true;
       }
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT)])
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT)])
          state->info.primitive_restart = ia->primitiveRestartEnable;
    }
 
    if (pipeline->graphics_create_info.pTessellationState) {
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_PATCH_CONTROL_POINTS_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_PATCH_CONTROL_POINTS_EXT)]) {
          const VkPipelineTessellationStateCreateInfo *ts = pipeline->graphics_create_info.pTessellationState;
          state->patch_vertices = ts->patchControlPoints;
       }
@@ -910,17 +897,17 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
       const VkPipelineViewportStateCreateInfo *vpi= pipeline->graphics_create_info.pViewportState;
       int i;
 
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT)]) {
          state->num_viewports = vpi->viewportCount;
          state->vp_dirty = true;
       }
-      if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT)]) {
+      if (!dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT)]) {
          state->num_scissors = vpi->scissorCount;
          state->scissor_dirty = true;
       }
 
       if (!dynamic_states[VK_DYNAMIC_STATE_VIEWPORT] &&
-          !dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT)]) {
+          !dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT)]) {
          for (i = 0; i < vpi->viewportCount; i++) {
             get_viewport_xform(state, &vpi->pViewports[i], i);
             set_viewport_depth_xform(state, i);
@@ -934,7 +921,7 @@ static void handle_graphics_pipeline(struct vk_cmd_queue_entry *cmd,
          state->vp_dirty = true;
       }
       if (!dynamic_states[VK_DYNAMIC_STATE_SCISSOR] &&
-          !dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT)]) {
+          !dynamic_states[lvp_conv_dynamic_state_idx(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT)]) {
          for (i = 0; i < vpi->scissorCount; i++) {
             const VkRect2D *ss = &vpi->pScissors[i];
             state->scissors[i].minx = ss->offset.x;
@@ -1097,7 +1084,10 @@ static void fill_sampler_view_stage(struct rendering_state *state,
    sv_idx += dyn_info->stage[stage].sampler_view_count;
    struct lvp_image_view *iv = descriptor->iview;
 
-   if (iv) {
+   /* Views are immutable, so the sampler view is only created the first
+    * time the view is bound and reused after that.
+    */
+   if (iv && !iv->sv) {
       struct pipe_sampler_view templ;
       enum pipe_format pformat;
       if (iv->vk.aspects == VK_IMAGE_ASPECT_DEPTH_BIT)
@@ -1140,12 +1130,10 @@ static void fill_sampler_view_stage(struct rendering_state *state,
          fix_depth_swizzle_a(templ.swizzle_a);
       }
 
-      if (state->sv[p_stage][sv_idx])
-         pipe_sampler_view_reference(&state->sv[p_stage][sv_idx], NULL);
-      state->sv[p_stage][sv_idx] = state->pctx->create_sampler_view(state->pctx, iv->image->bo, &templ);
-   } else {
-      state->sv[p_stage][sv_idx] = NULL;
+      iv->sv = state->pctx->create_sampler_view(state->pctx, iv->image->bo, &templ);
    }
+
+   pipe_sampler_view_reference(&state->sv[p_stage][sv_idx], iv ? iv->sv : NULL);
    if (state->num_sampler_views[p_stage] <= sv_idx)
       state->num_sampler_views[p_stage] = sv_idx + 1;
    state->sv_dirty[p_stage] = true;
@@ -1166,10 +1154,7 @@ static void fill_sampler_buffer_view_stage(struct rendering_state *state,
    sv_idx += dyn_info->stage[stage].sampler_view_count;
    struct lvp_buffer_view *bv = descriptor->buffer_view;
 
-   if (state->sv[p_stage][sv_idx])
-      pipe_sampler_view_reference(&state->sv[p_stage][sv_idx], NULL);
-
-   if (bv) {
+   if (bv && !bv->sv) {
       struct pipe_sampler_view templ;
       memset(&templ, 0, sizeof(templ));
       templ.target = PIPE_BUFFER;
@@ -1182,9 +1167,11 @@ static void fill_sampler_buffer_view_stage(struct rendering_state *state,
       templ.u.buf.size = bv->range == VK_WHOLE_SIZE ? (bv->buffer->size - bv->offset) : bv->range;
       templ.texture = bv->buffer->bo;
       templ.context = state->pctx;
-      state->sv[p_stage][sv_idx] = state->pctx->create_sampler_view(state->pctx, bv->buffer->bo, &templ);
+      bv->sv = state->pctx->create_sampler_view(state->pctx, bv->buffer->bo, &templ);
    }
 
+   pipe_sampler_view_reference(&state->sv[p_stage][sv_idx], bv ? bv->sv : NULL);
+
    if (state->num_sampler_views[p_stage] <= sv_idx)
       state->num_sampler_views[p_stage] = sv_idx + 1;
    state->sv_dirty[p_stage] = true;
@@ -186,6 +186,7 @@ lvp_CreateImageView(VkDevice _device,
    view->pformat = lvp_vk_format_to_pipe_format(view->vk.format);
    view->image = image;
    view->surface = NULL;
+   view->sv = NULL;
    *pView = lvp_image_view_to_handle(view);
 
    return VK_SUCCESS;
@@ -202,6 +203,7 @@ lvp_DestroyImageView(VkDevice _device, VkImageView _iview,
      return;
 
    pipe_surface_reference(&iview->surface, NULL);
+   pipe_sampler_view_reference(&iview->sv, NULL);
    vk_image_view_destroy(&device->vk, pAllocator, &iview->vk);
 }
 
@@ -386,6 +388,7 @@ lvp_CreateBufferView(VkDevice _device,
    view->pformat = lvp_vk_format_to_pipe_format(pCreateInfo->format);
    view->offset = pCreateInfo->offset;
    view->range = pCreateInfo->range;
+   view->sv = NULL;
    *pView = lvp_buffer_view_to_handle(view);
 
    return VK_SUCCESS;
@@ -400,6 +403,7 @@ lvp_DestroyBufferView(VkDevice _device, VkBufferView bufferView,
 
    if (!bufferView)
      return;
+   pipe_sampler_view_reference(&view->sv, NULL);
    vk_object_base_finish(&view->base);
    vk_free2(&device->vk.alloc, pAllocator, view);
 }
@@ -1445,6 +1445,16 @@ lvp_graphics_pipeline_init(struct lvp_pipeline *pipeline,
          pipeline->shader_cso[PIPE_SHADER_FRAGMENT] = device->queue.ctx->create_fs_state(device->queue.ctx, &shstate);
       }
    }
+
+   const VkPipelineDynamicStateCreateInfo *dyn = pipeline->graphics_create_info.pDynamicState;
+   if (dyn) {
+      for (uint32_t i = 0; i < dyn->dynamicStateCount; i++) {
+         int idx = lvp_conv_dynamic_state_idx(dyn->pDynamicStates[i]);
+         if (idx == -1)
+            continue;
+         pipeline->dynamic_states[idx] = true;
+      }
+   }
    return VK_SUCCESS;
 }
 
@@ -253,6 +253,7 @@ struct lvp_image_view {
    enum pipe_format pformat;
 
    struct pipe_surface *surface; /* have we created a pipe surface for this? */
+   struct pipe_sampler_view *sv; /* and a sampler view, for sampling it? */
 };
 
 struct lvp_sampler {
@@ -490,6 +491,12 @@ struct lvp_pipeline {
    bool provoking_vertex_last;
    bool negative_one_to_one;
    bool library;
+
+   /* Which states of graphics_create_info are dynamic, indexed with
+    * lvp_conv_dynamic_state_idx().  Worked out once here instead of every
+    * time the pipeline is bound.
+    */
+   bool dynamic_states[VK_DYNAMIC_STATE_STENCIL_REFERENCE + 32];
 };
 
 struct lvp_event {
@@ -517,6 +524,7 @@ struct lvp_buffer_view {
    struct lvp_buffer *buffer;
    uint32_t offset;
    uint64_t range;
+   struct pipe_sampler_view *sv; /* have we created a pipe sampler view for this? */
 };
 
 struct lvp_query_pool {
@@ -621,6 +629,8 @@ VkResult lvp_execute_cmds(struct lvp_device *device,
                           struct lvp_cmd_buffer *cmd_buffer);
 size_t
 lvp_get_rendering_state_size(void);
+int
+lvp_conv_dynamic_state_idx(VkDynamicState dyn_state);
 struct lvp_image *lvp_swapchain_get_image(VkSwapchainKHR swapchain,
 					  uint32_t index);
 
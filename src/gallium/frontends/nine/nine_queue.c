@@ -23,10 +23,15 @@
 #include "nine_queue.h"
 #include "os/os_thread.h"
 #include "util/macros.h"
+#include "util/u_atomic.h"
 #include "nine_helpers.h"
 
 #define NINE_CMD_BUF_INSTR (256)
 
+/* Number of instructions after which a cmdbuf is handed over early
+ * when the worker is idle. */
+#define NINE_CMD_BUF_INSTR_IDLE (32)
+
 #define NINE_CMD_BUFS (32)
 #define NINE_CMD_BUFS_MASK (NINE_CMD_BUFS - 1)
 
@@ -41,7 +46,10 @@
  * Calls nine_queue_alloc to get a slice of memory in current cmdbuf.
  * Calls nine_queue_flush to flush the queue by request.
  * The queue is flushed automatically on insufficient space or once the
- * cmdbuf contains NINE_CMD_BUF_INSTR instructions.
+ * cmdbuf contains NINE_CMD_BUF_INSTR instructions. While the consumer is
+ * idle it is already flushed after NINE_CMD_BUF_INSTR_IDLE instructions,
+ * so that the consumer starts earlier and a later synchronous flush has
+ * less work to wait for. A busy consumer gets full cmdbufs.
  *
  * nine_queue_flush does block, while nine_queue_alloc doesn't block.
  *
@@ -89,8 +97,10 @@ nine_queue_wait_flush(struct nine_queue_pool* ctx)
     while (!cmdbuf->full)
     {
         DBG("waiting for full cmdbuf\n");
+        p_atomic_set(&ctx->worker_wait, TRUE);
         cnd_wait(&ctx->event_push, &ctx->mutex_push);
     }
+    p_atomic_set(&ctx->worker_wait, FALSE);
     DBG("got cmdbuf=%p\n", cmdbuf);
     mtx_unlock(&ctx->mutex_push);
 
@@ -185,7 +195,9 @@ nine_queue_alloc(struct nine_queue_pool* ctx, unsigned space)
     /* at this pointer there's always a free queue available */
 
     if ((cmdbuf->offset + space > NINE_QUEUE_SIZE) ||
-        (cmdbuf->num_instr == NINE_CMD_BUF_INSTR)) {
+        (cmdbuf->num_instr == NINE_CMD_BUF_INSTR) ||
+        (cmdbuf->num_instr >= NINE_CMD_BUF_INSTR_IDLE &&
+         p_atomic_read(&ctx->worker_wait))) {
 
         nine_queue_flush(ctx);
 
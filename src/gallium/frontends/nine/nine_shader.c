@@ -3875,6 +3875,7 @@ nine_pipe_nir_shader_state_from_tgsi(struct pipe_shader_state *state, const stru
     state->tokens = NULL;
     state->ir.nir = nir;
     memset(&state->stream_output, 0, sizeof(state->stream_output));
+    state->nir_prehash = NULL;
 }
 
 static void *
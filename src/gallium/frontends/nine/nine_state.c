@@ -1551,6 +1551,31 @@ CSMT_ITEM_NO_WAIT(nine_context_set_sampler_state,
     context->changed.sampler[Sampler] |= 1 << Type;
 }
 
+/* Stateblock versions of the two above: pStates holds (state, value) pairs,
+ * so that a whole stateblock is sent to the worker as one instruction
+ * instead of one per state. For sampler states the state is
+ * (Sampler << 16) | Type. */
+CSMT_ITEM_NO_WAIT(nine_context_set_render_states,
+                  ARG_MEM(DWORD, pStates),
+                  ARG_MEM_SIZE(unsigned, size))
+{
+    unsigned i;
+
+    for (i = 0; i < size / sizeof(DWORD); i += 2)
+        nine_context_set_render_state_priv(device, pStates[i], pStates[i + 1]);
+}
+
+CSMT_ITEM_NO_WAIT(nine_context_set_sampler_states,
+                  ARG_MEM(DWORD, pStates),
+                  ARG_MEM_SIZE(unsigned, size))
+{
+    unsigned i;
+
+    for (i = 0; i < size / sizeof(DWORD); i += 2)
+        nine_context_set_sampler_state_priv(device, pStates[i] >> 16,
+                                            pStates[i] & 0xffff, pStates[i + 1]);
+}
+
 CSMT_ITEM_NO_WAIT(nine_context_set_stream_source_apply,
                   ARG_VAL(UINT, StreamNumber),
                   ARG_BIND_RES(struct pipe_resource, res),
@@ -2022,14 +2047,15 @@ CSMT_ITEM_NO_WAIT(nine_context_set_swvp,
 }
 
 /* Do not write to nine_context directly. Slower,
- * but works with csmt. TODO: write a special csmt version that
- * would record the list of commands as much as possible,
- * and use the version above else.
+ * but works with csmt. Render and sampler states, which make up most
+ * of a stateblock, are each sent as a single batch.
  */
 void
 nine_context_apply_stateblock(struct NineDevice9 *device,
                               const struct nine_state *src)
 {
+    DWORD states[2 * MAX2(NINED3DRS_COUNT, NINE_MAX_SAMPLERS * D3DSAMP_COUNT)];
+    unsigned n = 0;
     int i;
 
     /* No need to apply src->changed.group, since all calls do
@@ -2040,9 +2066,12 @@ nine_context_apply_stateblock(struct NineDevice9 *device,
         while (m) {
             const int r = ffs(m) - 1;
             m &= ~(1 << r);
-            nine_context_set_render_state(device, i * 32 + r, src->rs_advertised[i * 32 + r]);
+            states[n++] = i * 32 + r;
+            states[n++] = src->rs_advertised[i * 32 + r];
         }
     }
+    if (n)
+        nine_context_set_render_states(device, states, n * sizeof(DWORD));
 
     /* Textures */
     if (src->changed.texture) {
@@ -2061,14 +2090,18 @@ nine_context_apply_stateblock(struct NineDevice9 *device,
     if (src->changed.group & NINE_STATE_SAMPLER) {
         unsigned s;
 
+        n = 0;
         for (s = 0; s < NINE_MAX_SAMPLERS; ++s) {
             uint32_t m = src->changed.sampler[s];
             while (m) {
                 const int i = ffs(m) - 1;
                 m &= ~(1 << i);
-                nine_context_set_sampler_state(device, s, i, src->samp_advertised[s][i]);
+                states[n++] = (s << 16) | i;
+                states[n++] = src->samp_advertised[s][i];
             }
         }
+        if (n)
+            nine_context_set_sampler_states(device, states, n * sizeof(DWORD));
     }
 
     /* Vertex buffers */
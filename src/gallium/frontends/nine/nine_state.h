@@ -386,6 +386,16 @@ nine_context_set_sampler_state(struct NineDevice9 *device,
                                D3DSAMPLERSTATETYPE Type,
                                DWORD Value);
 
+void
+nine_context_set_render_states(struct NineDevice9 *device,
+                               const DWORD *pStates,
+                               unsigned size);
+
+void
+nine_context_set_sampler_states(struct NineDevice9 *device,
+                                const DWORD *pStates,
+                                unsigned size);
+
 void
 nine_context_set_stream_source(struct NineDevice9 *device,
                                UINT StreamNumber,
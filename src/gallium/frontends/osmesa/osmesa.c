@@ -89,6 +89,9 @@ struct osmesa_buffer
 
    void *map;
 
+   /** The color buffer renders straight into map, see osmesa_create_direct() */
+   bool direct;
+
    struct osmesa_buffer *next;  /**< next in linked list */
 };
 
@@ -351,6 +354,75 @@ stfbi_to_osbuffer(struct st_framebuffer_iface *stfbi)
 }
 
 
+/**
+ * Return the row stride of the user's color buffer.
+ */
+static int
+osmesa_color_stride(OSMesaContext osmesa, struct osmesa_buffer *osbuffer)
+{
+   unsigned bpp = util_format_get_blocksize(osbuffer->visual.color_format);
+
+   if (osmesa->user_row_length)
+      return bpp * osmesa->user_row_length;
+   else
+      return bpp * osbuffer->width;
+}
+
+
+/**
+ * Try to create the color buffer on top of the user's buffer, so that
+ * nothing needs to be copied on flush.  This only works if the user's
+ * buffer is laid out exactly like the driver would lay out the texture,
+ * which needs Y to increase downward and a matching row stride.
+ * Returns NULL if that isn't the case.
+ */
+static struct pipe_resource *
+osmesa_create_direct(struct pipe_screen *screen, OSMesaContext osmesa,
+                     struct osmesa_buffer *osbuffer,
+                     const struct pipe_resource *templat)
+{
+   struct pipe_resource *res;
+   uint64_t stride, layer_stride;
+   int dst_stride;
+
+   if (osmesa->y_up ||
+       !screen->resource_from_user_memory || !screen->resource_get_param ||
+       !screen->get_param(screen, PIPE_CAP_RESOURCE_FROM_USER_MEMORY))
+      return NULL;
+
+   res = screen->resource_from_user_memory(screen, templat, osbuffer->map);
+   if (!res)
+      return NULL;
+
+   /* The driver may pad the texture beyond the user's rows, e.g. to a
+    * multiple of the rasterizer block size. */
+   dst_stride = osmesa_color_stride(osmesa, osbuffer);
+   if (!screen->resource_get_param(screen, NULL, res, 0, 0, 0,
+                                   PIPE_RESOURCE_PARAM_STRIDE, 0, &stride) ||
+       !screen->resource_get_param(screen, NULL, res, 0, 0, 0,
+                                   PIPE_RESOURCE_PARAM_LAYER_STRIDE, 0,
+                                   &layer_stride) ||
+       stride != (uint64_t)dst_stride ||
+       layer_stride > (uint64_t)dst_stride * osbuffer->height) {
+      pipe_resource_reference(&res, NULL);
+      return NULL;
+   }
+
+   return res;
+}
+
+
+/**
+ * Force the framebuffer to be validated again, e.g. because the user's
+ * buffer or its layout changed under a direct color buffer.
+ */
+static void
+osmesa_invalidate_buffer(struct osmesa_buffer *osbuffer)
+{
+   p_atomic_inc(&osbuffer->stfb->stamp);
+}
+
+
 /**
  * Called via glFlush/glFinish.  This is where we copy the contents
  * of the driver's color buffer into the user-specified buffer.
@@ -363,8 +435,6 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
    OSMesaContext osmesa = OSMesaGetCurrentContext();
    struct osmesa_buffer *osbuffer = stfbi_to_osbuffer(stfbi);
    struct pipe_resource *res = osbuffer->textures[statt];
-   unsigned bpp;
-   int dst_stride;
 
    if (statt != ST_ATTACHMENT_FRONT_LEFT)
       return false;
@@ -391,14 +461,22 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
       pp_run(osmesa->pp, res, res, zsbuf);
    }
 
-   /* Snapshot the color buffer to the user's buffer. */
-   bpp = util_format_get_blocksize(osbuffer->visual.color_format);
-   if (osmesa->user_row_length)
-      dst_stride = bpp * osmesa->user_row_length;
-   else
-      dst_stride = bpp * osbuffer->width;
+   if (osbuffer->direct) {
+      /* The image is already in the user's buffer, just wait for it. */
+      struct pipe_context *pipe = osmesa->stctx->pipe;
+      struct pipe_screen *screen = pipe->screen;
+      struct pipe_fence_handle *fence = NULL;
 
-   osmesa_read_buffer(osmesa, res, osbuffer->map, dst_stride, osmesa->y_up);
+      pipe->flush(pipe, &fence, 0);
+      if (fence) {
+         screen->fence_finish(screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+         screen->fence_reference(screen, &fence, NULL);
+      }
+   } else {
+      /* Snapshot the color buffer to the user's buffer. */
+      osmesa_read_buffer(osmesa, res, osbuffer->map,
+                         osmesa_color_stride(osmesa, osbuffer), osmesa->y_up);
+   }
 
    /* If the user has requested the Z/S buffer, then snapshot that one too. */
    if (osmesa->zs) {
@@ -422,6 +500,7 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
                                struct pipe_resource **out)
 {
    struct pipe_screen *screen = get_st_manager()->screen;
+   OSMesaContext osmesa = (OSMesaContext) stctx->st_manager_private;
    enum st_attachment_type i;
    struct osmesa_buffer *osbuffer = stfbi_to_osbuffer(stfbi);
    struct pipe_resource templat;
@@ -467,6 +546,16 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
       templat.format = format;
       templat.bind = bind;
       pipe_resource_reference(&out[i], NULL);
+
+      if (statts[i] == ST_ATTACHMENT_FRONT_LEFT) {
+         out[i] = osmesa_create_direct(screen, osmesa, osbuffer, &templat);
+         osbuffer->direct = out[i] != NULL;
+         if (out[i]) {
+            osbuffer->textures[statts[i]] = out[i];
+            continue;
+         }
+      }
+
       out[i] = osbuffer->textures[statts[i]] =
          screen->resource_create(screen, &templat);
    }
@@ -796,6 +885,9 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
 
    struct osmesa_buffer *osbuffer = osmesa->current_buffer;
 
+   if (osbuffer->direct && osbuffer->map != buffer)
+      osmesa_invalidate_buffer(osbuffer);
+
    osbuffer->width = width;
    osbuffer->height = height;
    osbuffer->map = buffer;
@@ -852,6 +944,8 @@ GLAPI void GLAPIENTRY
 OSMesaPixelStore(GLint pname, GLint value)
 {
    OSMesaContext osmesa = OSMesaGetCurrentContext();
+   GLint row_length = osmesa->user_row_length;
+   GLboolean y_up = osmesa->y_up;
 
    switch (pname) {
    case OSMESA_ROW_LENGTH:
@@ -864,6 +958,12 @@ OSMesaPixelStore(GLint pname, GLint value)
       fprintf(stderr, "Invalid pname in OSMesaPixelStore()\n");
       return;
    }
+
+   /* The layout decides whether the color buffer can be rendered to
+    * directly, so pick it again. */
+   if (osmesa->current_buffer &&
+       (osmesa->user_row_length != row_length || osmesa->y_up != y_up))
+      osmesa_invalidate_buffer(osmesa->current_buffer);
 }
 
 
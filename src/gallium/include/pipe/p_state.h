@@ -299,6 +299,13 @@ struct pipe_shader_state
       void *nir;
    } ir;
    struct pipe_stream_output_info stream_output;
+
+   /**
+    * Optional SHA1 of everything the frontend derived ir.nir from, or NULL.
+    * Shaders with the same prehash must have identical IR, so that
+    * util_live_shader_cache can find them without serializing the NIR.
+    */
+   const unsigned char *nir_prehash;
 };
 
 static inline void
@@ -308,6 +315,7 @@ pipe_shader_state_from_tgsi(struct pipe_shader_state *state,
    state->type = PIPE_SHADER_IR_TGSI;
    state->tokens = tokens;
    memset(&state->stream_output, 0, sizeof(state->stream_output));
+   state->nir_prehash = NULL;
 }
 
 
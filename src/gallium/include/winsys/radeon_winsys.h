@@ -120,6 +120,8 @@ enum radeon_value_id
    RADEON_CURRENT_SCLK,
    RADEON_CURRENT_MCLK,
    RADEON_CS_THREAD_TIME,
+   RADEON_CS_BO_LIST_TIME_NS, /* time the submit thread spent building BO lists */
+   RADEON_CS_IOCTL_TIME_NS, /* time the submit thread spent in the CS ioctl */
 };
 
 /* Each group of two has the same priority. */
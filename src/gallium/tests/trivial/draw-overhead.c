@@ -0,0 +1,318 @@
+/**************************************************************************
+ *
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Measures the CPU overhead of common driver entrypoints in ns/call.
+ *
+ * Nothing is read back, so this can run on drm-shim to time a driver
+ * without its hardware, e.g.
+ *
+ *    LD_PRELOAD=libiris_noop_drm_shim.so ./draw-overhead 100000
+ *
+ * or with GALLIUM_NOOP=1 to get the cost of the frontend-facing layers only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WIDTH 256
+#define HEIGHT 256
+
+/* pipe_*_state structs */
+#include "pipe/p_state.h"
+/* pipe_context */
+#include "pipe/p_context.h"
+/* pipe_screen */
+#include "pipe/p_screen.h"
+/* PIPE_* */
+#include "pipe/p_defines.h"
+/* TGSI_SEMANTIC_{POSITION|GENERIC} */
+#include "pipe/p_shader_tokens.h"
+/* pipe_buffer_* helpers */
+#include "util/u_inlines.h"
+
+/* constant state object helper */
+#include "cso_cache/cso_context.h"
+
+/* util_draw_arrays helper */
+#include "util/u_draw.h"
+/* FREE & CALLOC_STRUCT */
+#include "util/u_memory.h"
+/* util_make_[fragment|vertex]_passthrough_shader */
+#include "util/u_simple_shaders.h"
+/* os_time_get_nano */
+#include "util/os_time.h"
+/* to get a hardware pipe driver */
+#include "pipe-loader/pipe_loader.h"
+
+struct program
+{
+	struct pipe_loader_device *dev;
+	struct pipe_screen *screen;
+	struct pipe_context *pipe;
+	struct cso_context *cso;
+
+	struct pipe_blend_state blend[2];
+	struct pipe_depth_stencil_alpha_state depthstencil;
+	struct pipe_rasterizer_state rasterizer;
+	struct pipe_viewport_state viewport;
+	struct pipe_framebuffer_state framebuffer;
+	struct cso_velems_state velem;
+
+	void *vs;
+	void *fs;
+
+	struct pipe_resource *vbuf;
+	struct pipe_resource *target;
+};
+
+static void init_prog(struct program *p)
+{
+	struct pipe_surface surf_tmpl;
+	ASSERTED int ret;
+
+	/* find a hardware device */
+	ret = pipe_loader_probe(&p->dev, 1);
+	assert(ret);
+
+	/* init a pipe screen */
+	p->screen = pipe_loader_create_screen(p->dev);
+	assert(p->screen);
+
+	/* create the pipe driver context and cso context */
+	p->pipe = p->screen->context_create(p->screen, NULL, 0);
+	p->cso = cso_create_context(p->pipe, 0);
+
+	/* vertex buffer */
+	{
+		float vertices[3][4] = {
+			{ 0.0f, -0.9f, 0.0f, 1.0f },
+			{ -0.9f, 0.9f, 0.0f, 1.0f },
+			{ 0.9f, 0.9f, 0.0f, 1.0f },
+		};
+
+		p->vbuf = pipe_buffer_create(p->screen, PIPE_BIND_VERTEX_BUFFER,
+					     PIPE_USAGE_DEFAULT, sizeof(vertices));
+		pipe_buffer_write(p->pipe, p->vbuf, 0, sizeof(vertices), vertices);
+	}
+
+	/* render target texture */
+	{
+		struct pipe_resource tmplt;
+		memset(&tmplt, 0, sizeof(tmplt));
+		tmplt.target = PIPE_TEXTURE_2D;
+		tmplt.format = PIPE_FORMAT_B8G8R8A8_UNORM; /* All drivers support this */
+		tmplt.width0 = WIDTH;
+		tmplt.height0 = HEIGHT;
+		tmplt.depth0 = 1;
+		tmplt.array_size = 1;
+		tmplt.last_level = 0;
+		tmplt.bind = PIPE_BIND_RENDER_TARGET;
+
+		p->target = p->screen->resource_create(p->screen, &tmplt);
+	}
+
+	/* two blend states to switch between, one with blending disabled */
+	memset(p->blend, 0, sizeof(p->blend));
+	p->blend[0].rt[0].colormask = PIPE_MASK_RGBA;
+	p->blend[1].rt[0].colormask = PIPE_MASK_RGBA;
+	p->blend[1].rt[0].blend_enable = 1;
+	p->blend[1].rt[0].rgb_func = PIPE_BLEND_ADD;
+	p->blend[1].rt[0].rgb_src_factor = PIPE_BLENDFACTOR_SRC_ALPHA;
+	p->blend[1].rt[0].rgb_dst_factor = PIPE_BLENDFACTOR_INV_SRC_ALPHA;
+	p->blend[1].rt[0].alpha_func = PIPE_BLEND_ADD;
+	p->blend[1].rt[0].alpha_src_factor = PIPE_BLENDFACTOR_ONE;
+	p->blend[1].rt[0].alpha_dst_factor = PIPE_BLENDFACTOR_ZERO;
+
+	/* no-op depth/stencil/alpha */
+	memset(&p->depthstencil, 0, sizeof(p->depthstencil));
+
+	/* rasterizer */
+	memset(&p->rasterizer, 0, sizeof(p->rasterizer));
+	p->rasterizer.cull_face = PIPE_FACE_NONE;
+	p->rasterizer.half_pixel_center = 1;
+	p->rasterizer.bottom_edge_rule = 1;
+	p->rasterizer.depth_clip_near = 1;
+	p->rasterizer.depth_clip_far = 1;
+
+	surf_tmpl.format = PIPE_FORMAT_B8G8R8A8_UNORM;
+	surf_tmpl.u.tex.level = 0;
+	surf_tmpl.u.tex.first_layer = 0;
+	surf_tmpl.u.tex.last_layer = 0;
+	/* drawing destination */
+	memset(&p->framebuffer, 0, sizeof(p->framebuffer));
+	p->framebuffer.width = WIDTH;
+	p->framebuffer.height = HEIGHT;
+	p->framebuffer.nr_cbufs = 1;
+	p->framebuffer.cbufs[0] = p->pipe->create_surface(p->pipe, p->target, &surf_tmpl);
+
+	/* viewport */
+	memset(&p->viewport, 0, sizeof(p->viewport));
+	p->viewport.scale[0] = WIDTH / 2.0f;
+	p->viewport.scale[1] = HEIGHT / 2.0f;
+	p->viewport.scale[2] = 0.5f;
+	p->viewport.translate[0] = WIDTH / 2.0f;
+	p->viewport.translate[1] = HEIGHT / 2.0f;
+	p->viewport.translate[2] = 0.5f;
+	p->viewport.swizzle_x = PIPE_VIEWPORT_SWIZZLE_POSITIVE_X;
+	p->viewport.swizzle_y = PIPE_VIEWPORT_SWIZZLE_POSITIVE_Y;
+	p->viewport.swizzle_z = PIPE_VIEWPORT_SWIZZLE_POSITIVE_Z;
+	p->viewport.swizzle_w = PIPE_VIEWPORT_SWIZZLE_POSITIVE_W;
+
+	/* vertex elements state */
+	memset(&p->velem, 0, sizeof(p->velem));
+	p->velem.count = 1;
+	p->velem.velems[0].src_offset = 0;
+	p->velem.velems[0].instance_divisor = 0;
+	p->velem.velems[0].vertex_buffer_index = 0;
+	p->velem.velems[0].src_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+
+	/* vertex shader */
+	{
+		const enum tgsi_semantic semantic_names[] = { TGSI_SEMANTIC_POSITION };
+		const uint semantic_indexes[] = { 0 };
+		p->vs = util_make_vertex_passthrough_shader(p->pipe, 1, semantic_names, semantic_indexes, FALSE);
+	}
+
+	/* fragment shader */
+	p->fs = util_make_fragment_passthrough_shader(p->pipe,
+                    TGSI_SEMANTIC_POSITION, TGSI_INTERPOLATE_LINEAR, TRUE);
+
+	/* bind everything once, the benchmarks only change what they measure */
+	cso_set_framebuffer(p->cso, &p->framebuffer);
+	cso_set_blend(p->cso, &p->blend[0]);
+	cso_set_depth_stencil_alpha(p->cso, &p->depthstencil);
+	cso_set_rasterizer(p->cso, &p->rasterizer);
+	cso_set_viewport(p->cso, &p->viewport);
+	cso_set_fragment_shader_handle(p->cso, p->fs);
+	cso_set_vertex_shader_handle(p->cso, p->vs);
+	cso_set_vertex_elements(p->cso, &p->velem);
+
+	{
+		struct pipe_vertex_buffer vbuf;
+		memset(&vbuf, 0, sizeof(vbuf));
+		vbuf.stride = 4 * sizeof(float);
+		vbuf.buffer.resource = p->vbuf;
+		cso_set_vertex_buffers(p->cso, 0, 1, 0, false, &vbuf);
+	}
+}
+
+static void close_prog(struct program *p)
+{
+	cso_destroy_context(p->cso);
+
+	p->pipe->delete_vs_state(p->pipe, p->vs);
+	p->pipe->delete_fs_state(p->pipe, p->fs);
+
+	pipe_surface_reference(&p->framebuffer.cbufs[0], NULL);
+	pipe_resource_reference(&p->target, NULL);
+	pipe_resource_reference(&p->vbuf, NULL);
+
+	p->pipe->destroy(p->pipe);
+	p->screen->destroy(p->screen);
+	pipe_loader_release(&p->dev, 1);
+
+	FREE(p);
+}
+
+static void bench_draw(struct program *p, unsigned i)
+{
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+}
+
+static void bench_blend_draw(struct program *p, unsigned i)
+{
+	cso_set_blend(p->cso, &p->blend[i & 1]);
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+}
+
+static void bench_constants_draw(struct program *p, unsigned i)
+{
+	float consts[4] = { (float)i, 0.0f, 0.0f, 1.0f };
+	struct pipe_constant_buffer cb;
+
+	memset(&cb, 0, sizeof(cb));
+	cb.buffer_size = sizeof(consts);
+	cb.user_buffer = consts;
+	p->pipe->set_constant_buffer(p->pipe, PIPE_SHADER_FRAGMENT, 0, false, &cb);
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+}
+
+static void bench_framebuffer_draw(struct program *p, unsigned i)
+{
+	/* cso filters out redundant framebuffer changes, so go around it */
+	p->pipe->set_framebuffer_state(p->pipe, &p->framebuffer);
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+}
+
+static void bench_draw_flush(struct program *p, unsigned i)
+{
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+	p->pipe->flush(p->pipe, NULL, 0);
+}
+
+static const struct {
+	const char *name;
+	void (*run)(struct program *p, unsigned i);
+} benchmarks[] = {
+	{ "draw", bench_draw },
+	{ "blend change + draw", bench_blend_draw },
+	{ "constant update + draw", bench_constants_draw },
+	{ "framebuffer change + draw", bench_framebuffer_draw },
+	{ "draw + flush", bench_draw_flush },
+};
+
+int main(int argc, char** argv)
+{
+	struct program *p = CALLOC_STRUCT(program);
+	unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 100000;
+
+	if (iterations == 0) {
+		fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	init_prog(p);
+
+	for (unsigned b = 0; b < ARRAY_SIZE(benchmarks); b++) {
+		/* warm up caches and any lazily created driver state */
+		for (unsigned i = 0; i < 100; i++)
+			benchmarks[b].run(p, i);
+		p->pipe->flush(p->pipe, NULL, 0);
+
+		int64_t start = os_time_get_nano();
+		for (unsigned i = 0; i < iterations; i++)
+			benchmarks[b].run(p, i);
+		p->pipe->flush(p->pipe, NULL, 0);
+		int64_t elapsed = os_time_get_nano() - start;
+
+		printf("%-28s %10.1f ns/call\n", benchmarks[b].name,
+		       (double)elapsed / iterations);
+	}
+
+	close_prog(p);
+
+	return 0;
+}
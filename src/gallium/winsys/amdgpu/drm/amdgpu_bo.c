@@ -240,7 +240,7 @@ static void amdgpu_bo_destroy_or_cache(struct radeon_winsys *rws, struct pb_buff
 static void amdgpu_clean_up_buffer_managers(struct amdgpu_winsys *ws)
 {
    for (unsigned i = 0; i < NUM_SLAB_ALLOCATORS; i++)
-      pb_slabs_reclaim(&ws->bo_slabs[i]);
+      pb_slabs_trim(&ws->bo_slabs[i]);
 
    pb_cache_release_all_buffers(&ws->bo_cache);
 }
@@ -925,6 +925,7 @@ static void amdgpu_destroy_cs_context(struct amdgpu_winsys *ws, struct amdgpu_cs
 {
    amdgpu_cs_context_cleanup(ws, cs);
    FREE(cs->real_buffers);
+   FREE(cs->bo_list_entries);
    FREE(cs->slab_buffers);
    FREE(cs->sparse_buffers);
    FREE(cs->fence_dependencies.list);
@@ -1397,6 +1398,7 @@ static void amdgpu_cs_submit_ib(void *job, void *gdata, int thread_index)
    bool use_bo_list_create = ws->info.drm_minor < 27;
    struct drm_amdgpu_bo_list_in bo_list_in;
    unsigned initial_num_real_buffers = cs->num_real_buffers;
+   int64_t start_time = os_time_get_nano();
 
    simple_mtx_lock(&ws->bo_fence_lock);
    amdgpu_add_fence_dependencies_bo_lists(acs, cs);
@@ -1435,9 +1437,25 @@ static void amdgpu_cs_submit_ib(void *job, void *gdata, int thread_index)
          goto cleanup;
       }
 
-      struct drm_amdgpu_bo_list_entry *list =
-         alloca((cs->num_real_buffers + 2) * sizeof(struct drm_amdgpu_bo_list_entry));
+      /* A CS can reference thousands of buffers, so don't put the list on the stack. Its
+       * storage is owned by the CS context and reused by later submissions.
+       */
+      if (cs->num_real_buffers > cs->max_bo_list_entries) {
+         unsigned new_max = MAX2(cs->num_real_buffers, cs->max_bo_list_entries * 2);
+         struct drm_amdgpu_bo_list_entry *new_list =
+            REALLOC(cs->bo_list_entries,
+                    cs->max_bo_list_entries * sizeof(struct drm_amdgpu_bo_list_entry),
+                    new_max * sizeof(struct drm_amdgpu_bo_list_entry));
+         if (!new_list) {
+            fprintf(stderr, "amdgpu: failed to allocate the buffer list\n");
+            r = -ENOMEM;
+            goto cleanup;
+         }
+         cs->bo_list_entries = new_list;
+         cs->max_bo_list_entries = new_max;
+      }
 
+      struct drm_amdgpu_bo_list_entry *list = cs->bo_list_entries;
       unsigned num_handles = 0;
       for (i = 0; i < cs->num_real_buffers; ++i) {
          struct amdgpu_cs_buffer *buffer = &cs->real_buffers[i];
@@ -1468,6 +1486,9 @@ static void amdgpu_cs_submit_ib(void *job, void *gdata, int thread_index)
    if (acs->ip_type == AMD_IP_GFX)
       ws->gfx_bo_list_counter += cs->num_real_buffers;
 
+   int64_t bo_list_done_time = os_time_get_nano();
+   ws->cs_bo_list_time += bo_list_done_time - start_time;
+
    bool noop = false;
 
    if (acs->stop_exec_on_failure && acs->ctx->num_rejected_cs) {
@@ -1598,6 +1619,8 @@ static void amdgpu_cs_submit_ib(void *job, void *gdata, int thread_index)
                                            num_chunks, chunks, &seq_no);
    }
 
+   ws->cs_ioctl_time += os_time_get_nano() - bo_list_done_time;
+
    if (r) {
       if (r == -ENOMEM)
          fprintf(stderr, "amdgpu: Not enough memory for command submission.\n");
@@ -97,6 +97,10 @@ struct amdgpu_cs_context {
    unsigned                    num_real_buffers;
    struct amdgpu_cs_buffer     *real_buffers;
 
+   /* Kernel BO list built at submission, kept to be reused by the next one. */
+   unsigned                    max_bo_list_entries;
+   struct drm_amdgpu_bo_list_entry *bo_list_entries;
+
    unsigned                    num_slab_buffers;
    unsigned                    max_slab_buffers;
    struct amdgpu_cs_buffer     *slab_buffers;
@@ -282,6 +282,10 @@ static uint64_t amdgpu_query_value(struct radeon_winsys *rws,
       return retval;
    case RADEON_CS_THREAD_TIME:
       return util_queue_get_thread_time_nano(&ws->cs_queue, 0);
+   case RADEON_CS_BO_LIST_TIME_NS:
+      return ws->cs_bo_list_time;
+   case RADEON_CS_IOCTL_TIME_NS:
+      return ws->cs_ioctl_time;
    }
    return 0;
 }
@@ -86,6 +86,8 @@ struct amdgpu_winsys {
    uint64_t num_mapped_buffers;
    uint64_t gfx_bo_list_counter;
    uint64_t gfx_ib_size_counter;
+   uint64_t cs_bo_list_time; /* time spent building BO lists in ns */
+   uint64_t cs_ioctl_time; /* time spent in the CS ioctl in ns */
 
    struct radeon_info info;
 
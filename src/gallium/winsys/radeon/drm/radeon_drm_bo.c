@@ -1072,7 +1072,7 @@ radeon_winsys_bo_create(struct radeon_winsys *rws,
    if (!bo) {
       /* Clear the cache and try again. */
       if (ws->info.r600_has_virtual_memory)
-         pb_slabs_reclaim(&ws->bo_slabs);
+         pb_slabs_trim(&ws->bo_slabs);
       pb_cache_release_all_buffers(&ws->bo_cache);
       bo = radeon_create_bo(ws, size, alignment, domain, flags, heap);
       if (!bo)
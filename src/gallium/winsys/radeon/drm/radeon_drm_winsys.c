@@ -735,6 +735,8 @@ static uint64_t radeon_query_value(struct radeon_winsys *rws,
    case RADEON_GFX_IB_SIZE_COUNTER:
    case RADEON_SLAB_WASTED_VRAM:
    case RADEON_SLAB_WASTED_GTT:
+   case RADEON_CS_BO_LIST_TIME_NS:
+   case RADEON_CS_IOCTL_TIME_NS:
       return 0; /* unimplemented */
    case RADEON_VRAM_USAGE:
       radeon_get_drm_value(ws->fd, RADEON_INFO_VRAM_USAGE,
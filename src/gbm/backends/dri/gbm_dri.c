@@ -52,6 +52,8 @@
 #include "loader.h"
 #include "util/debug.h"
 #include "util/macros.h"
+#include "util/os_time.h"
+#include "util/u_debug.h"
 
 /* For importing wl_buffer */
 #if HAVE_WAYLAND_PLATFORM
@@ -953,10 +955,8 @@ gbm_dri_bo_get_modifier(struct gbm_bo *_bo)
 }
 
 static void
-gbm_dri_bo_destroy(struct gbm_bo *_bo)
+gbm_dri_bo_free(struct gbm_dri_device *dri, struct gbm_dri_bo *bo)
 {
-   struct gbm_dri_device *dri = gbm_dri_device(_bo->gbm);
-   struct gbm_dri_bo *bo = gbm_dri_bo(_bo);
    struct drm_mode_destroy_dumb arg;
 
    if (bo->image != NULL) {
@@ -968,9 +968,88 @@ gbm_dri_bo_destroy(struct gbm_bo *_bo)
       drmIoctl(dri->base.v0.fd, DRM_IOCTL_MODE_DESTROY_DUMB, &arg);
    }
 
+   free(bo->modifiers);
    free(bo);
 }
 
+/* BOs that sat in the cache for this long are freed */
+#define BO_CACHE_MAX_IDLE_NS (2 * 1000000000ll)
+
+/* Frees cached BOs from the least recently released one on until the cache
+ * is within max_size and holds nothing idle for longer than the limit.
+ * Called with dri->mutex held.
+ */
+static void
+gbm_dri_bo_cache_trim(struct gbm_dri_device *dri, uint64_t max_size)
+{
+   int64_t now = os_time_get_nano();
+
+   list_for_each_entry_safe_rev(struct gbm_dri_bo, bo, &dri->bo_cache,
+                                cache_link) {
+      if (dri->bo_cache_size <= max_size &&
+          now - bo->release_time < BO_CACHE_MAX_IDLE_NS)
+         break;
+
+      list_del(&bo->cache_link);
+      dri->bo_cache_size -= bo->cache_size;
+      gbm_dri_bo_free(dri, bo);
+   }
+}
+
+static struct gbm_dri_bo *
+gbm_dri_bo_cache_get(struct gbm_dri_device *dri,
+                     uint32_t width, uint32_t height,
+                     uint32_t format, uint32_t usage,
+                     const uint64_t *modifiers, unsigned count)
+{
+   struct gbm_dri_bo *found = NULL;
+
+   if (!dri->bo_cache_max_size)
+      return NULL;
+
+   mtx_lock(&dri->mutex);
+   gbm_dri_bo_cache_trim(dri, dri->bo_cache_max_size);
+   list_for_each_entry(struct gbm_dri_bo, bo, &dri->bo_cache, cache_link) {
+      if (bo->base.v0.width == width && bo->base.v0.height == height &&
+          bo->base.v0.format == format && bo->usage == usage &&
+          bo->count == count &&
+          (!count || !memcmp(bo->modifiers, modifiers,
+                             count * sizeof(*modifiers)))) {
+         list_del(&bo->cache_link);
+         dri->bo_cache_size -= bo->cache_size;
+         found = bo;
+         break;
+      }
+   }
+   mtx_unlock(&dri->mutex);
+
+   if (found) {
+      found->base.v0.user_data = NULL;
+      found->base.v0.destroy_user_data = NULL;
+   }
+
+   return found;
+}
+
+static void
+gbm_dri_bo_destroy(struct gbm_bo *_bo)
+{
+   struct gbm_dri_device *dri = gbm_dri_device(_bo->gbm);
+   struct gbm_dri_bo *bo = gbm_dri_bo(_bo);
+
+   if (bo->cacheable && bo->cache_size <= dri->bo_cache_max_size) {
+      mtx_lock(&dri->mutex);
+      bo->release_time = os_time_get_nano();
+      list_add(&bo->cache_link, &dri->bo_cache);
+      dri->bo_cache_size += bo->cache_size;
+      gbm_dri_bo_cache_trim(dri, dri->bo_cache_max_size);
+      mtx_unlock(&dri->mutex);
+      return;
+   }
+
+   gbm_dri_bo_free(dri, bo);
+}
+
 static struct gbm_bo *
 gbm_dri_bo_import(struct gbm_device *gbm,
                   uint32_t type, void *buffer, uint32_t usage)
@@ -1211,6 +1290,11 @@ gbm_dri_bo_create(struct gbm_device *gbm,
    if (usage & GBM_BO_USE_WRITE || dri->image == NULL)
       return create_dumb(gbm, width, height, format, usage);
 
+   bo = gbm_dri_bo_cache_get(dri, width, height, format, usage,
+                             modifiers, count);
+   if (bo)
+      return &bo->base;
+
    bo = calloc(1, sizeof *bo);
    if (bo == NULL)
       return NULL;
@@ -1258,6 +1342,19 @@ gbm_dri_bo_create(struct gbm_device *gbm,
    dri->image->queryImage(bo->image, __DRI_IMAGE_ATTRIB_STRIDE,
                           (int *) &bo->base.v0.stride);
 
+   /* Protected content must not be handed to another user of the device. */
+   if (dri->bo_cache_max_size && !(usage & GBM_BO_USE_PROTECTED)) {
+      bo->modifiers = count ? malloc(count * sizeof(*modifiers)) : NULL;
+      if (!count || bo->modifiers) {
+         if (count)
+            memcpy(bo->modifiers, modifiers, count * sizeof(*modifiers));
+         bo->count = count;
+         bo->usage = usage;
+         bo->cache_size = (uint64_t)bo->base.v0.stride * height;
+         bo->cacheable = true;
+      }
+   }
+
    return &bo->base;
 
 failed:
@@ -1406,6 +1503,13 @@ dri_destroy(struct gbm_device *gbm)
    struct gbm_dri_device *dri = gbm_dri_device(gbm);
    unsigned i;
 
+   mtx_lock(&dri->mutex);
+   list_for_each_entry_safe(struct gbm_dri_bo, bo, &dri->bo_cache, cache_link) {
+      list_del(&bo->cache_link);
+      gbm_dri_bo_free(dri, bo);
+   }
+   mtx_unlock(&dri->mutex);
+
    if (dri->context)
       dri->core->destroyContext(dri->context);
 
@@ -1466,6 +1570,14 @@ dri_device_create(int fd, uint32_t gbm_backend_version)
 
    mtx_init(&dri->mutex, mtx_plain);
 
+   /* Reusing destroyed BOs is only safe when the application knows that
+    * nothing, like KMS or a client holding a dma-buf of it, still uses a BO
+    * it destroys, so this is opt-in.  The size is in MiB.
+    */
+   list_inithead(&dri->bo_cache);
+   long cache_size_mb = debug_get_num_option("GBM_BO_CACHE_SIZE", 0);
+   dri->bo_cache_max_size = cache_size_mb > 0 ? (uint64_t)cache_size_mb << 20 : 0;
+
    force_sw = env_var_as_boolean("GBM_ALWAYS_SOFTWARE", false);
    if (!force_sw) {
       ret = dri_screen_create(dri);
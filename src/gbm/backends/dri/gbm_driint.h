@@ -33,6 +33,7 @@
 #include <sys/mman.h>
 #include "gbmint.h"
 #include "c11/threads.h"
+#include "util/list.h"
 
 #include <GL/gl.h> /* dri_interface needs GL types */
 #include "GL/internal/dri_interface.h"
@@ -70,6 +71,13 @@ struct gbm_dri_device {
    __DRIcontext *context;
    mtx_t mutex;
 
+   /* Destroyed BOs kept for reuse, most recently released first, protected
+    * by mutex.  Disabled unless GBM_BO_CACHE_SIZE is set.
+    */
+   struct list_head bo_cache;
+   uint64_t bo_cache_size;
+   uint64_t bo_cache_max_size;
+
    const __DRIcoreExtension   *core;
    const __DRIdri2Extension   *dri2;
    const __DRI2fenceExtension *fence;
@@ -133,6 +141,15 @@ struct gbm_dri_bo {
    /* Used for cursors and the swrast front BO */
    uint32_t handle, size;
    void *map;
+
+   /* What the BO was created with, for BOs that may go to bo_cache */
+   bool cacheable;
+   uint32_t usage;
+   uint64_t *modifiers;
+   unsigned count;
+   uint64_t cache_size;
+   int64_t release_time;
+   struct list_head cache_link;
 };
 
 struct gbm_dri_surface {
@@ -94,6 +94,8 @@ intel_measure_init(struct intel_measure_device *device)
       const char *interval_s = strstr(env, "interval=");
       const char *batch_size_s = strstr(env, "batch_size=");
       const char *buffer_size_s = strstr(env, "buffer_size=");
+      const char *continuous_s = strstr(env, "continuous");
+      const char *spike_s = strstr(env, "spike=");
       while (true) {
          char *sep = strrchr(env, ',');
          if (sep == NULL)
@@ -203,6 +205,27 @@ intel_measure_init(struct intel_measure_device *device)
          config.buffer_size = buffer_size;
       }
 
+      if (spike_s) {
+         spike_s += 6;
+         const int spike_us = atoi(spike_s);
+         if (spike_us <= 0) {
+            fprintf(stderr, "INTEL_MEASURE spike threshold must be positive: "
+                    "%d\n", spike_us);
+            abort();
+         }
+         config.spike_us = spike_us;
+         config.continuous = true;
+      }
+
+      if (continuous_s)
+         config.continuous = true;
+
+      /* a continuous capture is always collecting, and only writes out its
+       * results when requested
+       */
+      if (config.continuous)
+         config.enabled = true;
+
       fputs("draw_start,draw_end,frame,batch,"
             "event_index,event_count,type,count,vs,tcs,tes,"
             "gs,fs,cs,framebuffer,idle_us,time_us\n",
@@ -211,6 +234,8 @@ intel_measure_init(struct intel_measure_device *device)
 
    device->config = NULL;
    device->frame = 0;
+   device->spike_frame = 0;
+   device->spike_frame_ns = 0;
    pthread_mutex_init(&device->mutex, NULL);
    list_inithead(&device->queued_snapshots);
 
@@ -321,7 +346,7 @@ intel_measure_frame_transition(unsigned frame)
 {
    if (frame == config.start_frame)
       config.enabled = true;
-   else if (frame == config.end_frame)
+   else if (frame == config.end_frame && !config.continuous)
       config.enabled = false;
 
    /* user commands to the control fifo will override any start/count
@@ -343,6 +368,16 @@ intel_measure_frame_transition(unsigned frame)
          buf[bytes] = '\0';
          char *nptr = buf, *endptr = buf;
          while (*nptr != '\0' && *endptr != '\0') {
+            if (strncmp(nptr, "dump", 4) == 0) {
+               /* write out the results buffered by a continuous capture */
+               config.dump_requested = true;
+               endptr = nptr + 4;
+               if (*endptr == '\0')
+                  break;
+               nptr = endptr + 1;
+               continue;
+            }
+
             long fcount = strtol(nptr, &endptr, 10);
             if (nptr == endptr) {
                config.enabled = false;
@@ -351,7 +386,7 @@ intel_measure_frame_transition(unsigned frame)
                lseek(config.control_fh, 0, SEEK_END);
                break;
             } else if (fcount == 0) {
-               config.enabled = false;
+               config.enabled = config.continuous;
             } else {
                config.enabled = true;
                config.end_frame = frame + fcount;
@@ -387,6 +422,31 @@ intel_measure_ready(struct intel_measure_batch *batch)
    return (batch->timestamps[batch->index - 1] != 0);
 }
 
+/**
+ * Accumulate the GPU time of each frame, and request that the buffered
+ * results be written when a frame exceeds the configured threshold.
+ */
+static void
+check_spike(struct intel_measure_device *device,
+            const struct intel_measure_buffered_result *result,
+            struct intel_device_info *info)
+{
+   if (result->frame != device->spike_frame) {
+      if (device->spike_frame_ns > config.spike_us * 1000ull) {
+         fprintf(config.file, "INTEL_MEASURE frame %u took %.3lf us\n",
+                 device->spike_frame, device->spike_frame_ns / 1000.0);
+         config.dump_requested = true;
+      }
+      device->spike_frame = result->frame;
+      device->spike_frame_ns = 0;
+   }
+
+   device->spike_frame_ns +=
+      intel_device_info_timebase_scale(info,
+                                       raw_timestamp_delta(result->start_ts,
+                                                           result->end_ts));
+}
+
 /**
  * Submit completed snapshots for buffering.
  *
@@ -396,7 +456,8 @@ intel_measure_ready(struct intel_measure_batch *batch)
  */
 static void
 intel_measure_push_result(struct intel_measure_device *device,
-                          struct intel_measure_batch *batch)
+                          struct intel_measure_batch *batch,
+                          struct intel_device_info *info)
 {
    struct intel_measure_ringbuffer *rb = device->ringbuffer;
 
@@ -413,7 +474,7 @@ intel_measure_push_result(struct intel_measure_device *device,
       if (begin->type == INTEL_SNAPSHOT_SECONDARY_BATCH) {
          assert(begin->secondary != NULL);
          begin->secondary->batch_count = batch->batch_count;
-         intel_measure_push_result(device, begin->secondary);
+         intel_measure_push_result(device, begin->secondary, info);
          continue;
       }
 
@@ -422,7 +483,11 @@ intel_measure_push_result(struct intel_measure_device *device,
       /* advance ring buffer */
       if (++rb->head == config.buffer_size)
          rb->head = 0;
-      if (rb->head == rb->tail) {
+      if (rb->head == rb->tail && config.continuous) {
+         /* drop the oldest result */
+         if (++rb->tail == config.buffer_size)
+            rb->tail = 0;
+      } else if (rb->head == rb->tail) {
          static bool warned = false;
          if (unlikely(!warned)) {
             fprintf(config.file,
@@ -449,6 +514,9 @@ intel_measure_push_result(struct intel_measure_device *device,
       buffered_result->batch_count = batch->batch_count;
       buffered_result->event_index = i / 2;
       buffered_result->snapshot.event_count = end->event_count;
+
+      if (config.spike_us)
+         check_spike(device, buffered_result, info);
    }
 }
 
@@ -653,13 +721,20 @@ intel_measure_gather(struct intel_measure_device *measure_device,
       list_del(&batch->link);
       assert(batch->index % 2 == 0);
 
-      intel_measure_push_result(measure_device, batch);
+      intel_measure_push_result(measure_device, batch, info);
 
       batch->index = 0;
       batch->frame = 0;
    }
 
-   intel_measure_print(measure_device, info);
+   /* a continuous capture only writes out its results when asked to */
+   if (!config.continuous || config.dump_requested) {
+      intel_measure_print(measure_device, info);
+      if (config.dump_requested) {
+         config.dump_requested = false;
+         fflush(config.file);
+      }
+   }
    pthread_mutex_unlock(&measure_device->mutex);
 }
 
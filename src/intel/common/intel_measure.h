@@ -100,6 +100,22 @@ struct intel_measure_config {
 
    /* true when snapshots are currently being collected */
    bool                       enabled;
+
+   /* Keep collecting into the ringbuffer without writing anything out,
+    * overwriting the oldest results.  Set with INTEL_MEASURE=continuous.
+    * The buffered results are written when `echo dump > {control path}` is
+    * received, or when a frame exceeds the spike threshold.
+    */
+   bool                       continuous;
+
+   /* GPU time of a frame, in microseconds, above which the buffered results
+    * are written out in continuous mode.  Set with INTEL_MEASURE=spike={us},
+    * which implies continuous.
+    */
+   unsigned                   spike_us;
+
+   /* true when the buffered results of a continuous capture must be written */
+   bool                       dump_requested;
 };
 
 struct intel_measure_batch;
@@ -138,6 +154,12 @@ struct intel_measure_device {
     * written out
     */
    struct intel_measure_ringbuffer *ringbuffer;
+
+   /* Accumulated GPU time of the frame that is currently being pushed into
+    * the ringbuffer, used to detect spikes in continuous mode.
+    */
+   unsigned spike_frame;
+   uint64_t spike_frame_ns;
 };
 
 struct intel_measure_batch {
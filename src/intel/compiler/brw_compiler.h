@@ -1756,6 +1756,11 @@ struct brw_compile_fs_params {
    bool allow_spilling;
    bool use_rep_send;
 
+   /* Don't try a SIMD32 compile.  Useful for a quick first compile of a
+    * shader that will be recompiled with full optimization later.
+    */
+   bool skip_simd32;
+
    struct brw_compile_stats *stats;
 
    void *log_data;
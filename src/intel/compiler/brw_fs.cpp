@@ -42,6 +42,7 @@
 #include "compiler/nir/nir_builder.h"
 #include "program/prog_parameter.h"
 #include "util/u_math.h"
+#include "util/u_thread.h"
 
 using namespace brw;
 
@@ -8905,6 +8906,22 @@ fs_visitor::fixup_nomask_control_flow()
    return progress;
 }
 
+void
+fs_visitor::restore_instruction_order(fs_inst **inst_arr)
+{
+   int ip = 0;
+   foreach_block (block, cfg) {
+      block->instructions.make_empty();
+
+      assert(ip == block->start_ip);
+      for (; ip <= block->end_ip; ip++)
+         block->instructions.push_tail(inst_arr[ip]);
+   }
+   assert(ip == cfg->last_block()->end_ip + 1);
+
+   invalidate_analysis(DEPENDENCY_INSTRUCTIONS);
+}
+
 void
 fs_visitor::allocate_registers(bool allow_spilling)
 {
@@ -8940,28 +8957,64 @@ fs_visitor::allocate_registers(bool allow_spilling)
    }
    assert(ip == num_insts);
 
-   /* Try each scheduling heuristic to see if it can successfully register
-    * allocate without spilling.  They should be ordered by decreasing
-    * performance but increasing likelihood of allocating.
+   /* Run every scheduling heuristic up front and record the instruction
+    * order it produced, along with a cheap estimate of its register pressure
+    * and runtime.  Scheduling doesn't add or remove instructions, so each
+    * order can be restored later with the block boundaries left untouched.
     */
-   for (unsigned i = 0; i < ARRAY_SIZE(pre_modes); i++) {
-      if (i > 0) {
-         /* Unless we're the first pass, reset back to the original order */
-         ip = 0;
-         foreach_block (block, cfg) {
-            block->instructions.make_empty();
-
-            assert(ip == block->start_ip);
-            for (; ip <= block->end_ip; ip++)
-               block->instructions.push_tail(inst_arr[ip]);
-         }
-         assert(ip == num_insts);
+   const unsigned num_modes = ARRAY_SIZE(pre_modes);
+   fs_inst **sched_arr[ARRAY_SIZE(pre_modes)];
+   unsigned sched_pressure[ARRAY_SIZE(pre_modes)];
+   unsigned sched_latency[ARRAY_SIZE(pre_modes)];
 
-         invalidate_analysis(DEPENDENCY_INSTRUCTIONS);
-      }
+   for (unsigned i = 0; i < num_modes; i++) {
+      if (i > 0)
+         restore_instruction_order(inst_arr);
 
       if (pre_modes[i] != SCHEDULE_NONE)
          schedule_instructions(pre_modes[i]);
+
+      /* The number of VGRF registers live at any single IP is a lower bound
+       * on the number of GRFs the allocator needs, so a schedule exceeding
+       * the register file there is known to fail without spilling.
+       */
+      const brw::register_pressure &rp = regpressure_analysis.require();
+      sched_pressure[i] = 0;
+      for (int j = 0; j < num_insts; j++)
+         sched_pressure[i] = MAX2(sched_pressure[i], rp.regs_live_at_ip[j]);
+
+      sched_latency[i] = sched_pressure[i] <= BRW_MAX_GRF ?
+                         performance_analysis.require().latency : UINT_MAX;
+
+      sched_arr[i] = ralloc_array(mem_ctx, fs_inst *, num_insts);
+      ip = 0;
+      foreach_block_and_inst(block, fs_inst, inst, cfg)
+         sched_arr[i][ip++] = inst;
+      assert(ip == num_insts);
+   }
+
+   /* Try the schedules that might fit in order of increasing estimated
+    * runtime, falling back to the list order for ties.  The last mode is the
+    * one most likely to allocate, so it's always tried last and is the only
+    * one allowed to spill.
+    */
+   unsigned order[ARRAY_SIZE(pre_modes)];
+   unsigned num_tries = 0;
+   for (unsigned i = 0; i < num_modes - 1; i++) {
+      if (sched_pressure[i] > BRW_MAX_GRF)
+         continue;
+
+      unsigned j = num_tries++;
+      for (; j > 0 && sched_latency[order[j - 1]] > sched_latency[i]; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+   }
+   order[num_tries++] = num_modes - 1;
+
+   for (unsigned t = 0; t < num_tries; t++) {
+      const unsigned i = order[t];
+
+      restore_instruction_order(sched_arr[i]);
       this->shader_stats.scheduler_mode = scheduler_mode_name[i];
 
       if (0) {
@@ -8970,8 +9023,7 @@ fs_visitor::allocate_registers(bool allow_spilling)
          break;
       }
 
-      bool can_spill = allow_spilling &&
-                       (i == ARRAY_SIZE(pre_modes) - 1);
+      bool can_spill = allow_spilling && (i == num_modes - 1);
 
       /* We should only spill registers on the last scheduling. */
       assert(!spilled_any_registers);
@@ -8981,6 +9033,10 @@ fs_visitor::allocate_registers(bool allow_spilling)
          break;
    }
 
+   for (unsigned i = 0; i < num_modes; i++)
+      ralloc_free(sched_arr[i]);
+   ralloc_free(inst_arr);
+
    if (!allocated) {
       fail("Failure to register allocate.  Reduce number of "
            "live scalar values to avoid this.");
@@ -9966,6 +10022,7 @@ brw_compile_fs(const struct brw_compiler *compiler,
    /* Currently, the compiler only supports SIMD32 on SNB+ */
    if (!has_spilled &&
        v8->max_dispatch_width >= 32 && !params->use_rep_send &&
+       !params->skip_simd32 &&
        devinfo->ver >= 6 && !simd16_failed &&
        !INTEL_DEBUG(DEBUG_NO32)) {
       /* Try a SIMD32 compile */
@@ -10219,6 +10276,91 @@ brw_nir_lower_simd(nir_shader *nir, unsigned dispatch_width)
                                  (void *)(uintptr_t)dispatch_width);
 }
 
+struct brw_cs_nir_job {
+   const struct brw_compiler *compiler;
+   const nir_shader *nir;
+   const struct brw_cs_prog_key *key;
+   unsigned dispatch_width;
+   bool debug_enabled;
+
+   nir_shader *shader;
+};
+
+static int
+brw_prepare_cs_nir(void *data)
+{
+   struct brw_cs_nir_job *job = (struct brw_cs_nir_job *)data;
+   const unsigned dispatch_width = job->dispatch_width;
+
+   /* Uses its own ralloc context so that this can run on another thread. */
+   nir_shader *shader = nir_shader_clone(NULL, job->nir);
+   brw_nir_apply_key(shader, job->compiler, &job->key->base,
+                     dispatch_width, true /* is_scalar */);
+
+   NIR_PASS_V(shader, brw_nir_lower_simd, dispatch_width);
+
+   /* Clean up after the local index and ID calculations. */
+   NIR_PASS_V(shader, nir_opt_constant_folding);
+   NIR_PASS_V(shader, nir_opt_dce);
+
+   brw_postprocess_nir(shader, job->compiler, true, job->debug_enabled,
+                       job->key->base.robust_buffer_access);
+
+   job->shader = shader;
+   return 0;
+}
+
+/* The lowered NIR of a SIMD variant only depends on its dispatch width, so
+ * prepare it for all the variants which are expected to be compiled at the
+ * same time, on worker threads.  Whether a variant is actually compiled
+ * still depends on the results of the smaller ones.
+ */
+static void
+brw_prepare_cs_nir_jobs(const struct brw_compiler *compiler,
+                        const struct brw_cs_prog_data *prog_data,
+                        unsigned required_dispatch_width,
+                        struct brw_cs_nir_job *jobs)
+{
+   void *mem_ctx = ralloc_context(NULL);
+
+   /* Assume that every variant compiles without spilling. */
+   struct brw_cs_prog_data predicted = *prog_data;
+   predicted.prog_mask = 0;
+   predicted.prog_spilled = 0;
+
+   thrd_t threads[3];
+   bool started[3] = {false, false, false};
+   int first = -1;
+
+   for (unsigned simd = 0; simd < 3; simd++) {
+      const char *error = NULL;
+      if (!brw_simd_should_compile(mem_ctx, simd, compiler->devinfo, &predicted,
+                                   required_dispatch_width, &error))
+         continue;
+
+      brw_simd_mark_compiled(simd, &predicted, false);
+
+      /* The calling thread prepares the first variant itself. */
+      if (first < 0) {
+         first = simd;
+         continue;
+      }
+
+      threads[simd] = u_thread_create(brw_prepare_cs_nir, &jobs[simd]);
+      started[simd] = threads[simd] != 0;
+   }
+
+   if (first >= 0)
+      brw_prepare_cs_nir(&jobs[first]);
+
+   for (unsigned simd = 0; simd < 3; simd++) {
+      if (started[simd])
+         thrd_join(threads[simd], NULL);
+   }
+
+   ralloc_free(mem_ctx);
+}
+
 const unsigned *
 brw_compile_cs(const struct brw_compiler *compiler,
                void *mem_ctx,
@@ -10248,6 +10390,20 @@ brw_compile_cs(const struct brw_compiler *compiler,
    fs_visitor *v[3]     = {0};
    const char *error[3] = {0};
 
+   struct brw_cs_nir_job jobs[3];
+   for (unsigned simd = 0; simd < 3; simd++) {
+      jobs[simd].compiler = compiler;
+      jobs[simd].nir = nir;
+      jobs[simd].key = key;
+      jobs[simd].dispatch_width = 8u << simd;
+      jobs[simd].debug_enabled = debug_enabled;
+      jobs[simd].shader = NULL;
+   }
+
+   /* Keep the NIR dumps of the variants apart. */
+   if (!debug_enabled)
+      brw_prepare_cs_nir_jobs(compiler, prog_data, required_dispatch_width, jobs);
+
    for (unsigned simd = 0; simd < 3; simd++) {
       if (!brw_simd_should_compile(mem_ctx, simd, compiler->devinfo, prog_data,
                                    required_dispatch_width, &error[simd]))
@@ -10255,18 +10411,12 @@ brw_compile_cs(const struct brw_compiler *compiler,
 
       const unsigned dispatch_width = 8u << simd;
 
-      nir_shader *shader = nir_shader_clone(mem_ctx, nir);
-      brw_nir_apply_key(shader, compiler, &key->base,
-                        dispatch_width, true /* is_scalar */);
-
-      NIR_PASS_V(shader, brw_nir_lower_simd, dispatch_width);
+      if (!jobs[simd].shader)
+         brw_prepare_cs_nir(&jobs[simd]);
 
-      /* Clean up after the local index and ID calculations. */
-      NIR_PASS_V(shader, nir_opt_constant_folding);
-      NIR_PASS_V(shader, nir_opt_dce);
-
-      brw_postprocess_nir(shader, compiler, true, debug_enabled,
-                          key->base.robust_buffer_access);
+      nir_shader *shader = jobs[simd].shader;
+      ralloc_steal(mem_ctx, shader);
+      jobs[simd].shader = NULL;
 
       v[simd] = new fs_visitor(compiler, params->log_data, mem_ctx, &key->base,
                                &prog_data->base, shader, dispatch_width,
@@ -10297,6 +10447,10 @@ brw_compile_cs(const struct brw_compiler *compiler,
       }
    }
 
+   /* Variants which were prepared but turned out not to be needed. */
+   for (unsigned simd = 0; simd < 3; simd++)
+      ralloc_free(jobs[simd].shader);
+
    const int selected_simd = brw_simd_select(prog_data);
    if (selected_simd < 0) {
       params->error_str = ralloc_asprintf(mem_ctx, "Can't compile shader: %s, %s and %s.\n",
@@ -129,6 +129,7 @@ public:
    bool run_mesh(bool allow_spilling);
    void optimize();
    void allocate_registers(bool allow_spilling);
+   void restore_instruction_order(fs_inst **inst_arr);
    void setup_fs_payload_gfx4();
    void setup_fs_payload_gfx6();
    void setup_vs_payload();
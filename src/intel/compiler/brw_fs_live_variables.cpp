@@ -150,54 +150,62 @@ fs_live_variables::setup_def_use()
  * propagating it through control flow.  It will eventually terminate
  * because it only ever adds bits, and stops when no bits are added in
  * a pass.
+ *
+ * Only blocks with a successor whose livein changed are revisited, and the
+ * bitset updates are free of branches so that they can be vectorized.
  */
 void
 fs_live_variables::compute_live_variables()
 {
+   bool *pending = rzalloc_array(mem_ctx, bool, cfg->num_blocks);
+   for (int i = 0; i < cfg->num_blocks; i++)
+      pending[i] = true;
+
    bool cont = true;
 
    while (cont) {
       cont = false;
 
       foreach_block_reverse (block, cfg) {
+         if (!pending[block->num])
+            continue;
+         pending[block->num] = false;
+
          struct block_data *bd = &block_data[block->num];
 
-	 /* Update liveout */
-	 foreach_list_typed(bblock_link, child_link, link, &block->children) {
-       struct block_data *child_bd = &block_data[child_link->block->num];
-
-	    for (int i = 0; i < bitset_words; i++) {
-               BITSET_WORD new_liveout = (child_bd->livein[i] &
-                                          ~bd->liveout[i]);
-               if (new_liveout) {
-                  bd->liveout[i] |= new_liveout;
-                  cont = true;
-               }
-	    }
-            BITSET_WORD new_liveout = (child_bd->flag_livein[0] &
-                                       ~bd->flag_liveout[0]);
-            if (new_liveout) {
-               bd->flag_liveout[0] |= new_liveout;
-               cont = true;
-            }
-	 }
+         /* Update liveout */
+         foreach_list_typed(bblock_link, child_link, link, &block->children) {
+            const struct block_data *child_bd = &block_data[child_link->block->num];
+
+            for (int i = 0; i < bitset_words; i++)
+               bd->liveout[i] |= child_bd->livein[i];
+            bd->flag_liveout[0] |= child_bd->flag_livein[0];
+         }
 
          /* Update livein */
+         BITSET_WORD changed = 0;
          for (int i = 0; i < bitset_words; i++) {
-            BITSET_WORD new_livein = (bd->use[i] |
-                                      (bd->liveout[i] &
-                                       ~bd->def[i]));
-            if (new_livein & ~bd->livein[i]) {
-               bd->livein[i] |= new_livein;
-               cont = true;
-            }
+            const BITSET_WORD new_livein = (bd->use[i] |
+                                            (bd->liveout[i] &
+                                             ~bd->def[i]));
+            changed |= new_livein & ~bd->livein[i];
+            bd->livein[i] |= new_livein;
          }
-         BITSET_WORD new_livein = (bd->flag_use[0] |
-                                   (bd->flag_liveout[0] &
-                                    ~bd->flag_def[0]));
-         if (new_livein & ~bd->flag_livein[0]) {
-            bd->flag_livein[0] |= new_livein;
-            cont = true;
+         const BITSET_WORD new_livein = (bd->flag_use[0] |
+                                         (bd->flag_liveout[0] &
+                                          ~bd->flag_def[0]));
+         changed |= new_livein & ~bd->flag_livein[0];
+         bd->flag_livein[0] |= new_livein;
+
+         if (!changed)
+            continue;
+
+         /* Parents later in the reverse order are handled by this pass, the
+          * others (loop back-edges) by the next one.
+          */
+         foreach_list_typed(bblock_link, parent_link, link, &block->parents) {
+            pending[parent_link->block->num] = true;
+            cont |= parent_link->block->num >= block->num;
          }
       }
    }
@@ -205,24 +213,39 @@ fs_live_variables::compute_live_variables()
    /* Propagate defin and defout down the CFG to calculate the union of live
     * variables potentially defined along any possible control flow path.
     */
+   for (int i = 0; i < cfg->num_blocks; i++)
+      pending[i] = true;
+
    do {
       cont = false;
 
       foreach_block (block, cfg) {
+         if (!pending[block->num])
+            continue;
+         pending[block->num] = false;
+
          const struct block_data *bd = &block_data[block->num];
 
-	 foreach_list_typed(bblock_link, child_link, link, &block->children) {
-       struct block_data *child_bd = &block_data[child_link->block->num];
+         foreach_list_typed(bblock_link, child_link, link, &block->children) {
+            struct block_data *child_bd = &block_data[child_link->block->num];
 
-	    for (int i = 0; i < bitset_words; i++) {
+            BITSET_WORD changed = 0;
+            for (int i = 0; i < bitset_words; i++) {
                const BITSET_WORD new_def = bd->defout[i] & ~child_bd->defin[i];
                child_bd->defin[i] |= new_def;
                child_bd->defout[i] |= new_def;
-               cont |= new_def;
-	    }
-	 }
+               changed |= new_def;
+            }
+
+            if (changed) {
+               pending[child_link->block->num] = true;
+               cont |= child_link->block->num <= block->num;
+            }
+         }
       }
    } while (cont);
+
+   ralloc_free(pending);
 }
 
 /**
@@ -292,13 +315,18 @@ fs_live_variables::fs_live_variables(const backend_shader *s)
    block_data = rzalloc_array(mem_ctx, struct block_data, cfg->num_blocks);
 
    bitset_words = BITSET_WORDS(num_vars);
+
+   /* Allocate the bitsets of all blocks at once, this is recomputed often. */
+   BITSET_WORD *words = rzalloc_array(mem_ctx, BITSET_WORD,
+                                      6 * bitset_words * cfg->num_blocks);
    for (int i = 0; i < cfg->num_blocks; i++) {
-      block_data[i].def = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
-      block_data[i].use = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
-      block_data[i].livein = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
-      block_data[i].liveout = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
-      block_data[i].defin = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
-      block_data[i].defout = rzalloc_array(mem_ctx, BITSET_WORD, bitset_words);
+      block_data[i].def = words;
+      block_data[i].use = words + bitset_words;
+      block_data[i].livein = words + 2 * bitset_words;
+      block_data[i].liveout = words + 3 * bitset_words;
+      block_data[i].defin = words + 4 * bitset_words;
+      block_data[i].defout = words + 5 * bitset_words;
+      words += 6 * bitset_words;
 
       block_data[i].flag_def[0] = 0;
       block_data[i].flag_use[0] = 0;
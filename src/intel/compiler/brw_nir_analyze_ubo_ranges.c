@@ -42,6 +42,12 @@
  * of registers required) and "benefit" (number of pull loads eliminated
  * by pushing the range).  We then sort the list to obtain the four best
  * ranges (most benefit for the least cost).
+ *
+ * Loads inside loops are weighted by their loop depth, so a range that is
+ * pulled in a hot loop wins over one that is read a few times outside of
+ * it.  When there are more ranges than push slots, nearby ranges of the
+ * same block are merged, trading a few wasted registers for the holes
+ * against pull loads that would otherwise not be eliminated at all.
  */
 
 struct ubo_range_entry
@@ -88,7 +94,7 @@ struct ubo_block_info
     * not, there's a "hole" - padding between data - or just nothing at all.
     */
    uint64_t offsets;
-   uint8_t uses[64];
+   uint32_t uses[64];
 };
 
 struct ubo_analysis_state
@@ -116,8 +122,14 @@ get_block_info(struct ubo_analysis_state *state, int block)
    return info;
 }
 
+/* Weight of a use at each loop depth.  Deeper loops saturate at the last
+ * entry, we have no idea about trip counts anyway.
+ */
+static const unsigned loop_depth_weight[] = { 1, 8, 32, 64 };
+
 static void
-analyze_ubos_block(struct ubo_analysis_state *state, nir_block *block)
+analyze_ubos_block(struct ubo_analysis_state *state, nir_block *block,
+                   unsigned loop_depth)
 {
    nir_foreach_instr(instr, block) {
       if (instr->type != nir_instr_type_intrinsic)
@@ -171,13 +183,89 @@ analyze_ubos_block(struct ubo_analysis_state *state, nir_block *block)
          const int end = ALIGN(byte_offset + bytes, 32);
          const int chunks = (end - start) / 32;
 
-         /* TODO: should we count uses in loops as higher benefit? */
-
          struct ubo_block_info *info = get_block_info(state, block);
          info->offsets |= ((1ull << chunks) - 1) << offset;
-         info->uses[offset]++;
+         info->uses[offset] +=
+            loop_depth_weight[MIN2(loop_depth,
+                                   ARRAY_SIZE(loop_depth_weight) - 1)];
+      }
+   }
+}
+
+static void
+analyze_ubos_cf_list(struct ubo_analysis_state *state,
+                     struct exec_list *cf_list, unsigned loop_depth)
+{
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         analyze_ubos_block(state, nir_cf_node_as_block(node), loop_depth);
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(node);
+         analyze_ubos_cf_list(state, &nif->then_list, loop_depth);
+         analyze_ubos_cf_list(state, &nif->else_list, loop_depth);
+         break;
+      }
+
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(node);
+         analyze_ubos_cf_list(state, &loop->body, loop_depth + 1);
+         break;
+      }
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+}
+
+/**
+ * Merge the two closest ranges of the same block, if the hole between them
+ * is small enough to be worth pushing.  Returns false if there is no such
+ * pair.
+ *
+ * Ranges of a block are created in increasing offset order, and next to
+ * each other in the array, so only neighbours need to be considered.
+ */
+static bool
+merge_closest_ranges(struct util_dynarray *ranges)
+{
+   /* Largest hole, in 32-byte units, that we're willing to push. */
+   const int max_hole = 4;
+
+   struct ubo_range_entry *entries = ranges->data;
+   const int nr_entries = ranges->size / sizeof(struct ubo_range_entry);
+   int best = -1, best_hole = max_hole + 1;
+
+   for (int i = 0; i + 1 < nr_entries; i++) {
+      const struct brw_ubo_range *a = &entries[i].range;
+      const struct brw_ubo_range *b = &entries[i + 1].range;
+      if (a->block != b->block)
+         continue;
+
+      const int hole = b->start - (a->start + a->length);
+      assert(hole > 0);
+      if (hole < best_hole) {
+         best = i;
+         best_hole = hole;
       }
    }
+
+   if (best < 0)
+      return false;
+
+   struct ubo_range_entry *a = &entries[best];
+   const struct ubo_range_entry *b = &entries[best + 1];
+   a->range.length = b->range.start + b->range.length - a->range.start;
+   a->benefit += b->benefit;
+
+   memmove(&entries[best + 1], &entries[best + 2],
+           (nr_entries - best - 2) * sizeof(struct ubo_range_entry));
+   ranges->size -= sizeof(struct ubo_range_entry);
+
+   return true;
 }
 
 static void
@@ -227,11 +315,8 @@ brw_nir_analyze_ubo_ranges(const struct brw_compiler *compiler,
 
    /* Walk the IR, recording how many times each UBO block/offset is used. */
    nir_foreach_function(function, nir) {
-      if (function->impl) {
-         nir_foreach_block(block, function->impl) {
-            analyze_ubos_block(&state, block);
-         }
-      }
+      if (function->impl)
+         analyze_ubos_cf_list(&state, &function->impl->body, 0);
    }
 
    /* Find ranges: a block, starting 32-byte offset, and length. */
@@ -288,6 +373,28 @@ brw_nir_analyze_ubo_ranges(const struct brw_compiler *compiler,
       }
    }
 
+   /* Return the top 4 or so.  We drop by one if regular uniforms are in
+    * use, assuming one push buffer will be dedicated to those.  We may
+    * also only get 3 on Haswell if we can't write INSTPM.
+    *
+    * The backend may need to shrink these ranges to ensure that they
+    * don't exceed the maximum push constant limits.  It can simply drop
+    * the tail of the list, as that's the least valuable portion.  We
+    * unfortunately can't truncate it here, because we don't know what
+    * the backend is planning to do with regular uniforms.
+    */
+   const int max_ubos = (compiler->constant_buffer_0_is_relative ? 3 : 4) -
+                        state.uses_regular_uniforms;
+
+   /* We can only push 3-4 ranges via 3DSTATE_CONSTANT_XS.  If there are
+    * more ranges, and two are close by with only a small hole, combine
+    * them.  The holes waste register space, but the benefit of removing
+    * pulls outweighs that cost.
+    */
+   while ((int)(ranges.size / sizeof(struct ubo_range_entry)) > max_ubos &&
+          merge_closest_ranges(&ranges))
+      ;
+
    int nr_entries = ranges.size / sizeof(struct ubo_range_entry);
 
    if (0) {
@@ -296,14 +403,6 @@ brw_nir_analyze_ubo_ranges(const struct brw_compiler *compiler,
       }
    }
 
-   /* TODO: Consider combining ranges.
-    *
-    * We can only push 3-4 ranges via 3DSTATE_CONSTANT_XS.  If there are
-    * more ranges, and two are close by with only a small hole, it may be
-    * worth combining them.  The holes will waste register space, but the
-    * benefit of removing pulls may outweigh that cost.
-    */
-
    /* Sort the list so the most beneficial ranges are at the front. */
    if (nr_entries > 0) {
       qsort(ranges.data, nr_entries, sizeof(struct ubo_range_entry),
@@ -312,18 +411,6 @@ brw_nir_analyze_ubo_ranges(const struct brw_compiler *compiler,
 
    struct ubo_range_entry *entries = ranges.data;
 
-   /* Return the top 4 or so.  We drop by one if regular uniforms are in
-    * use, assuming one push buffer will be dedicated to those.  We may
-    * also only get 3 on Haswell if we can't write INSTPM.
-    *
-    * The backend may need to shrink these ranges to ensure that they
-    * don't exceed the maximum push constant limits.  It can simply drop
-    * the tail of the list, as that's the least valuable portion.  We
-    * unfortunately can't truncate it here, because we don't know what
-    * the backend is planning to do with regular uniforms.
-    */
-   const int max_ubos = (compiler->constant_buffer_0_is_relative ? 3 : 4) -
-                        state.uses_regular_uniforms;
    nr_entries = MIN2(nr_entries, max_ubos);
 
    for (int i = 0; i < nr_entries; i++) {
@@ -80,30 +80,36 @@ def define_tracepoints(args):
                           Arg(type='enum blorp_shader_type', name='blorp_type', var='shader_type', c_format='%s', to_prim_type='blorp_shader_type_to_name({})'),
                           Arg(type='enum blorp_shader_pipeline', name='blorp_pipe', var='shader_pipe', c_format='%s', to_prim_type='blorp_shader_pipeline_to_name({})'),])
 
+    # Hashes identifying the shaders bound for the draw or dispatch, so the
+    # GPU events can be matched against shader dumps and pipeline stats.
+    draw_hashes = [Arg(type='uint32_t', var='vs_hash', c_format='0x%08x'),
+                   Arg(type='uint32_t', var='fs_hash', c_format='0x%08x'),]
+
     begin_end_tp('draw',
-                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u')])
+                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_multi',
-                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indexed',
-                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indexed_multi',
-                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indirect_byte_count',
-                 tp_args=[Arg(type='uint32_t', var='instance_count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='instance_count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indirect',
-                 tp_args=[Arg(type='uint32_t', var='draw_count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='draw_count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indexed_indirect',
-                 tp_args=[Arg(type='uint32_t', var='draw_count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='draw_count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indirect_count',
-                 tp_args=[Arg(type='uint32_t', var='max_draw_count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='max_draw_count', c_format='%u'),] + draw_hashes)
     begin_end_tp('draw_indexed_indirect_count',
-                 tp_args=[Arg(type='uint32_t', var='max_draw_count', c_format='%u'),])
+                 tp_args=[Arg(type='uint32_t', var='max_draw_count', c_format='%u'),] + draw_hashes)
 
     begin_end_tp('compute',
                  tp_args=[Arg(type='uint32_t', var='group_x', c_format='%u'),
                           Arg(type='uint32_t', var='group_y', c_format='%u'),
-                          Arg(type='uint32_t', var='group_z', c_format='%u'),],
-                 tp_print=['group=%ux%ux%u', '__entry->group_x', '__entry->group_y', '__entry->group_z'])
+                          Arg(type='uint32_t', var='group_z', c_format='%u'),
+                          Arg(type='uint32_t', var='cs_hash', c_format='0x%08x'),],
+                 tp_print=['group=%ux%ux%u cs_hash=0x%08x', '__entry->group_x', '__entry->group_y', '__entry->group_z', '__entry->cs_hash'])
 
     def flag_bits(args):
         bits = [Arg(type='enum intel_ds_stall_flag', name='flags', var='decode_cb(flags)', c_format='0x%x')]
@@ -36,7 +36,9 @@
 #include "util/rounding.h"
 #include "isl_priv.h"
 
-#if defined(__SSSE3__)
+#if defined(INLINE_AVX2)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
 #include <tmmintrin.h>
 #elif defined(__SSE2__)
 #include <emmintrin.h>
@@ -57,6 +59,9 @@ static const uint32_t xtile_span = 64;
 static const uint32_t ytile_width = 128;
 static const uint32_t ytile_height = 32;
 static const uint32_t ytile_span = 16;
+static const uint32_t tile4_width = 128;
+static const uint32_t tile4_height = 32;
+static const uint32_t tile4_span = 16;
 
 static inline uint32_t
 ror(uint32_t n, uint32_t d)
@@ -156,6 +161,21 @@ rgba8_copy_16_aligned_src(void *dst, const void *src)
 }
 #endif
 
+#if defined(INLINE_AVX2)
+/* Only 16-byte alignment is guaranteed on the tiled side, so these use
+ * unaligned accesses on both sides.
+ */
+static inline void
+rgba8_copy_32(void *dst, const void *src)
+{
+   const __m256i perm =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i *)rgba8_permutation));
+
+   _mm256_storeu_si256(dst, _mm256_shuffle_epi8(_mm256_loadu_si256(src),
+                                                perm));
+}
+#endif
+
 /**
  * Copy RGBA to BGRA - swap R and B, with the destination 16-byte aligned.
  */
@@ -164,6 +184,14 @@ rgba8_copy_aligned_dst(void *dst, const void *src, size_t bytes)
 {
    assert(bytes == 0 || !(((uintptr_t)dst) & 0xf));
 
+#if defined(INLINE_AVX2)
+   if (bytes == 64) {
+      rgba8_copy_32(dst +  0, src +  0);
+      rgba8_copy_32(dst + 32, src + 32);
+      return dst;
+   }
+#endif
+
 #if defined(__SSSE3__) || defined(__SSE2__)
    if (bytes == 64) {
       rgba8_copy_16_aligned_dst(dst +  0, src +  0);
@@ -194,6 +222,14 @@ rgba8_copy_aligned_src(void *dst, const void *src, size_t bytes)
 {
    assert(bytes == 0 || !(((uintptr_t)src) & 0xf));
 
+#if defined(INLINE_AVX2)
+   if (bytes == 64) {
+      rgba8_copy_32(dst +  0, src +  0);
+      rgba8_copy_32(dst + 32, src + 32);
+      return dst;
+   }
+#endif
+
 #if defined(__SSSE3__) || defined(__SSE2__)
    if (bytes == 64) {
       rgba8_copy_16_aligned_src(dst +  0, src +  0);
@@ -569,6 +605,97 @@ ytiled_to_linear(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
    }
 }
 
+/* Tile4 is made of 64B cells of 4 rows of 16 bytes, which are themselves
+ * arranged in Y-major order within 512B blocks:
+ *
+ *   offset[3:0]   = x[3:0]
+ *   offset[5:4]   = y[1:0]
+ *   offset[7:6]   = x[5:4]
+ *   offset[8]     = y[2]
+ *   offset[9]     = x[6]
+ *   offset[11:10] = y[4:3]
+ *
+ * A 'tile4_span' of bytes starting at a 16-byte aligned X is contiguous, and
+ * the X and Y contributions to the offset can be computed separately.
+ */
+static inline uint32_t
+tile4_x_offset(uint32_t x)
+{
+   return (x & 0xf) | ((x & 0x30) << 2) | ((x & 0x40) << 3);
+}
+
+static inline uint32_t
+tile4_y_offset(uint32_t y)
+{
+   return ((y & 0x3) << 4) | ((y & 0x4) << 6) | ((y & 0x18) << 7);
+}
+
+/**
+ * Copy texture data from linear to Tile4 layout.
+ *
+ * \copydoc tile_copy_fn
+ */
+static inline void
+linear_to_tile4(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                uint32_t y0, uint32_t y1,
+                char *dst, const char *src,
+                int32_t src_pitch,
+                uint32_t swizzle_bit,
+                isl_mem_copy_fn mem_copy,
+                isl_mem_copy_fn mem_copy_align16)
+{
+   /* Tile4 only exists on platforms without address swizzling. */
+   assert(swizzle_bit == 0);
+
+   src += (ptrdiff_t)y0 * src_pitch;
+
+   for (uint32_t y = y0; y < y1; y++) {
+      const uint32_t yo = tile4_y_offset(y);
+
+      mem_copy(dst + tile4_x_offset(x0) + yo, src + x0, x1 - x0);
+
+      for (uint32_t x = x1; x < x2; x += tile4_span)
+         mem_copy_align16(dst + tile4_x_offset(x) + yo, src + x, tile4_span);
+
+      mem_copy_align16(dst + tile4_x_offset(x2) + yo, src + x2, x3 - x2);
+
+      src += src_pitch;
+   }
+}
+
+/**
+ * Copy texture data from Tile4 layout to linear.
+ *
+ * \copydoc tile_copy_fn
+ */
+static inline void
+tile4_to_linear(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                uint32_t y0, uint32_t y1,
+                char *dst, const char *src,
+                int32_t dst_pitch,
+                uint32_t swizzle_bit,
+                isl_mem_copy_fn mem_copy,
+                isl_mem_copy_fn mem_copy_align16)
+{
+   /* Tile4 only exists on platforms without address swizzling. */
+   assert(swizzle_bit == 0);
+
+   dst += (ptrdiff_t)y0 * dst_pitch;
+
+   for (uint32_t y = y0; y < y1; y++) {
+      const uint32_t yo = tile4_y_offset(y);
+
+      mem_copy(dst + x0, src + tile4_x_offset(x0) + yo, x1 - x0);
+
+      for (uint32_t x = x1; x < x2; x += tile4_span)
+         mem_copy_align16(dst + x, src + tile4_x_offset(x) + yo, tile4_span);
+
+      mem_copy_align16(dst + x2, src + tile4_x_offset(x2) + yo, x3 - x2);
+
+      dst += dst_pitch;
+   }
+}
+
 #if defined(INLINE_SSE41)
 static ALWAYS_INLINE void *
 _memcpy_streaming_load(void *dest, const void *src, size_t count)
@@ -578,6 +705,18 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128((__m128i *)dest, val);
       return dest;
    } else if (count == 64) {
+#if defined(INLINE_AVX2)
+      /* Only X-tiled spans are this long, and they are 64-byte aligned as
+       * long as the mapping of the tiled surface is.
+       */
+      if (((uintptr_t)src & 0x1f) == 0) {
+         __m256i val0 = _mm256_stream_load_si256(((__m256i *)src) + 0);
+         __m256i val1 = _mm256_stream_load_si256(((__m256i *)src) + 1);
+         _mm256_storeu_si256(((__m256i *)dest) + 0, val0);
+         _mm256_storeu_si256(((__m256i *)dest) + 1, val1);
+         return dest;
+      }
+#endif
       __m128i val0 = _mm_stream_load_si128(((__m128i *)src) + 0);
       __m128i val1 = _mm_stream_load_si128(((__m128i *)src) + 1);
       __m128i val2 = _mm_stream_load_si128(((__m128i *)src) + 2);
@@ -704,6 +843,48 @@ linear_to_ytiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
                     dst, src, src_pitch, swizzle_bit, mem_copy, mem_copy);
 }
 
+/**
+ * Copy texture data from linear to Tile4 layout, faster.
+ *
+ * Same as \ref linear_to_tile4 but faster, because it passes constant
+ * parameters for common cases, allowing the compiler to inline code
+ * optimized for those cases.
+ *
+ * \copydoc tile_copy_fn
+ */
+static FLATTEN void
+linear_to_tile4_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                       uint32_t y0, uint32_t y1,
+                       char *dst, const char *src,
+                       int32_t src_pitch,
+                       uint32_t swizzle_bit,
+                       isl_memcpy_type copy_type)
+{
+   isl_mem_copy_fn mem_copy = choose_copy_function(copy_type);
+
+   if (x0 == 0 && x3 == tile4_width && y0 == 0 && y1 == tile4_height) {
+      if (mem_copy == memcpy)
+         return linear_to_tile4(0, 0, tile4_width, tile4_width, 0, tile4_height,
+                                dst, src, src_pitch, swizzle_bit, memcpy, memcpy);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_tile4(0, 0, tile4_width, tile4_width, 0, tile4_height,
+                                dst, src, src_pitch, swizzle_bit,
+                                rgba8_copy, rgba8_copy_aligned_dst);
+      else
+         unreachable("not reached");
+   } else {
+      if (mem_copy == memcpy)
+         return linear_to_tile4(x0, x1, x2, x3, y0, y1,
+                                dst, src, src_pitch, swizzle_bit, memcpy, memcpy);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_tile4(x0, x1, x2, x3, y0, y1,
+                                dst, src, src_pitch, swizzle_bit,
+                                rgba8_copy, rgba8_copy_aligned_dst);
+      else
+         unreachable("not reached");
+   }
+}
+
 /**
  * Copy texture data from X tile layout to linear, faster.
  *
@@ -816,6 +997,60 @@ ytiled_to_linear_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
                     dst, src, dst_pitch, swizzle_bit, mem_copy, mem_copy);
 }
 
+/**
+ * Copy texture data from Tile4 layout to linear, faster.
+ *
+ * Same as \ref tile4_to_linear but faster, because it passes constant
+ * parameters for common cases, allowing the compiler to inline code
+ * optimized for those cases.
+ *
+ * \copydoc tile_copy_fn
+ */
+static FLATTEN void
+tile4_to_linear_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                       uint32_t y0, uint32_t y1,
+                       char *dst, const char *src,
+                       int32_t dst_pitch,
+                       uint32_t swizzle_bit,
+                       isl_memcpy_type copy_type)
+{
+   isl_mem_copy_fn mem_copy = choose_copy_function(copy_type);
+
+   if (x0 == 0 && x3 == tile4_width && y0 == 0 && y1 == tile4_height) {
+      if (mem_copy == memcpy)
+         return tile4_to_linear(0, 0, tile4_width, tile4_width, 0, tile4_height,
+                                dst, src, dst_pitch, swizzle_bit, memcpy, memcpy);
+      else if (mem_copy == rgba8_copy)
+         return tile4_to_linear(0, 0, tile4_width, tile4_width, 0, tile4_height,
+                                dst, src, dst_pitch, swizzle_bit,
+                                rgba8_copy, rgba8_copy_aligned_src);
+#if defined(INLINE_SSE41)
+      else if (copy_type == ISL_MEMCPY_STREAMING_LOAD)
+         return tile4_to_linear(0, 0, tile4_width, tile4_width, 0, tile4_height,
+                                dst, src, dst_pitch, swizzle_bit,
+                                memcpy, _memcpy_streaming_load);
+#endif
+      else
+         unreachable("not reached");
+   } else {
+      if (mem_copy == memcpy)
+         return tile4_to_linear(x0, x1, x2, x3, y0, y1,
+                                dst, src, dst_pitch, swizzle_bit, memcpy, memcpy);
+      else if (mem_copy == rgba8_copy)
+         return tile4_to_linear(x0, x1, x2, x3, y0, y1,
+                                dst, src, dst_pitch, swizzle_bit,
+                                rgba8_copy, rgba8_copy_aligned_src);
+#if defined(INLINE_SSE41)
+      else if (copy_type == ISL_MEMCPY_STREAMING_LOAD)
+         return tile4_to_linear(x0, x1, x2, x3, y0, y1,
+                                dst, src, dst_pitch, swizzle_bit,
+                                memcpy, _memcpy_streaming_load);
+#endif
+      else
+         unreachable("not reached");
+   }
+}
+
 /**
  * Copy from linear to tiled texture.
  *
@@ -853,6 +1088,11 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
       th = ytile_height;
       span = ytile_span;
       tile_copy = linear_to_ytiled_faster;
+   } else if (tiling == ISL_TILING_4) {
+      tw = tile4_width;
+      th = tile4_height;
+      span = tile4_span;
+      tile_copy = linear_to_tile4_faster;
    } else {
       unreachable("unsupported tiling");
    }
@@ -944,6 +1184,11 @@ tiled_to_linear(uint32_t xt1, uint32_t xt2,
       th = ytile_height;
       span = ytile_span;
       tile_copy = ytiled_to_linear_faster;
+   } else if (tiling == ISL_TILING_4) {
+      tw = tile4_width;
+      th = tile4_height;
+      span = tile4_span;
+      tile_copy = tile4_to_linear_faster;
    } else {
       unreachable("unsupported tiling");
    }
@@ -0,0 +1,315 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "isl/isl.h"
+#include "util/os_time.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+
+extern "C" {
+#include "isl/isl_priv.h"
+}
+
+/* Run with --gtest_also_run_disabled_tests to get the throughput numbers. */
+
+namespace {
+
+typedef void (*linear_to_tiled_fn)(uint32_t xt1, uint32_t xt2,
+                                   uint32_t yt1, uint32_t yt2,
+                                   char *dst, const char *src,
+                                   uint32_t dst_pitch, int32_t src_pitch,
+                                   bool has_swizzling,
+                                   enum isl_tiling tiling,
+                                   isl_memcpy_type copy_type);
+
+typedef void (*tiled_to_linear_fn)(uint32_t xt1, uint32_t xt2,
+                                   uint32_t yt1, uint32_t yt2,
+                                   char *dst, const char *src,
+                                   int32_t dst_pitch, uint32_t src_pitch,
+                                   bool has_swizzling,
+                                   enum isl_tiling tiling,
+                                   isl_memcpy_type copy_type);
+
+struct variant {
+   const char *name;
+   linear_to_tiled_fn linear_to_tiled;
+   tiled_to_linear_fn tiled_to_linear;
+   bool streaming_load;
+};
+
+std::vector<variant>
+get_variants()
+{
+   std::vector<variant> variants;
+
+   variants.push_back({"normal", _isl_memcpy_linear_to_tiled,
+                       _isl_memcpy_tiled_to_linear, false});
+#ifdef USE_SSE41
+   if (util_get_cpu_caps()->has_sse4_1) {
+      variants.push_back({"sse41", _isl_memcpy_linear_to_tiled_sse41,
+                          _isl_memcpy_tiled_to_linear_sse41, true});
+   }
+#endif
+#ifdef USE_AVX2
+   if (util_get_cpu_caps()->has_avx2) {
+      variants.push_back({"avx2", _isl_memcpy_linear_to_tiled_avx2,
+                          _isl_memcpy_tiled_to_linear_avx2, true});
+   }
+#endif
+
+   return variants;
+}
+
+const uint32_t tiles_x = 3;
+const uint32_t tiles_y = 3;
+
+void
+get_tile_size(enum isl_tiling tiling, uint32_t *tw, uint32_t *th)
+{
+   if (tiling == ISL_TILING_X) {
+      *tw = 512;
+      *th = 8;
+   } else {
+      *tw = 128;
+      *th = 32;
+   }
+}
+
+/* Byte offset of (x, y) in a tiled surface without swizzling. */
+uint32_t
+tiled_offset(enum isl_tiling tiling, uint32_t pitch, uint32_t x, uint32_t y)
+{
+   uint32_t tw, th;
+   get_tile_size(tiling, &tw, &th);
+
+   const uint32_t tile = (y / th) * pitch * th + (x / tw) * 4096;
+   x %= tw;
+   y %= th;
+
+   switch (tiling) {
+   case ISL_TILING_X:
+      return tile + y * 512 + x;
+   case ISL_TILING_Y0:
+      return tile + (x / 16) * 512 + y * 16 + x % 16;
+   case ISL_TILING_4:
+      return tile + (x & 0xf) + ((y & 0x3) << 4) + ((x & 0x30) << 2) +
+             ((y & 0x4) << 6) + ((x & 0x40) << 3) + ((y & 0x18) << 7);
+   default:
+      abort();
+   }
+}
+
+const char *
+tiling_name(enum isl_tiling tiling)
+{
+   switch (tiling) {
+   case ISL_TILING_X:  return "X";
+   case ISL_TILING_Y0: return "Y0";
+   case ISL_TILING_4:  return "4";
+   default:            return "?";
+   }
+}
+
+uint8_t
+pattern(uint32_t x, uint32_t y)
+{
+   return (x * 7 + y * 13 + (x >> 8)) & 0xff;
+}
+
+/* Expected byte of a BGRA8 copy at linear position x of pattern row y. */
+uint8_t
+expected(isl_memcpy_type copy_type, uint32_t x, uint32_t y)
+{
+   if (copy_type == ISL_MEMCPY_BGRA8 && (x % 4) != 1 && (x % 4) != 3)
+      x ^= 2;
+   return pattern(x, y);
+}
+
+class tiled_memcpy_test : public ::testing::TestWithParam<enum isl_tiling> {
+protected:
+   void
+   SetUp() override
+   {
+      tiling = GetParam();
+      get_tile_size(tiling, &tw, &th);
+      pitch = tiles_x * tw;
+      height = tiles_y * th;
+      size = pitch * height;
+      linear_size = ALIGN((pitch + 3) * height, 4096);
+      tiled = (char *)aligned_alloc(4096, size);
+      linear = (char *)aligned_alloc(4096, linear_size);
+   }
+
+   void
+   TearDown() override
+   {
+      free(tiled);
+      free(linear);
+   }
+
+   void
+   check(const variant &v, uint32_t x1, uint32_t x2, uint32_t y1, uint32_t y2,
+         isl_memcpy_type copy_type)
+   {
+      SCOPED_TRACE(testing::Message() << v.name << " copy_type " << copy_type
+                   << " [" << x1 << ", " << x2 << ") x [" << y1 << ", "
+                   << y2 << ")");
+
+      /* The linear side of the API points at (x1, y1) and uses its own
+       * pitch, which doesn't have to match the tiled one.
+       */
+      const uint32_t linear_pitch = x2 - x1 + 3;
+
+      for (uint32_t y = y1; y < y2; y++) {
+         for (uint32_t x = x1; x < x2; x++)
+            linear[(y - y1) * linear_pitch + (x - x1)] = pattern(x, y);
+      }
+
+      memset(tiled, 0, size);
+      v.linear_to_tiled(x1, x2, y1, y2, tiled, linear, pitch, linear_pitch,
+                        false, tiling, copy_type);
+
+      uint32_t copied = 0;
+      for (uint32_t y = y1; y < y2; y++) {
+         for (uint32_t x = x1; x < x2; x++) {
+            ASSERT_EQ((uint8_t)tiled[tiled_offset(tiling, pitch, x, y)],
+                      expected(copy_type, x, y))
+               << "at (" << x << ", " << y << ")";
+            copied++;
+         }
+      }
+
+      /* Nothing outside of the rectangle may be written. */
+      uint32_t nonzero = 0;
+      for (uint32_t i = 0; i < size; i++)
+         nonzero += tiled[i] != 0;
+      uint32_t zero_in_pattern = 0;
+      for (uint32_t y = y1; y < y2; y++) {
+         for (uint32_t x = x1; x < x2; x++)
+            zero_in_pattern += expected(copy_type, x, y) == 0;
+      }
+      ASSERT_EQ(nonzero, copied - zero_in_pattern);
+
+      /* Now read it back. */
+      const isl_memcpy_type read_types[] = {
+         ISL_MEMCPY, ISL_MEMCPY_STREAMING_LOAD,
+      };
+      for (isl_memcpy_type read_type : read_types) {
+         if (copy_type != ISL_MEMCPY)
+            break;
+         if (read_type == ISL_MEMCPY_STREAMING_LOAD && !v.streaming_load)
+            continue;
+
+         memset(linear, 0, linear_size);
+         v.tiled_to_linear(x1, x2, y1, y2, linear, tiled, linear_pitch, pitch,
+                           false, tiling, read_type);
+
+         for (uint32_t y = y1; y < y2; y++) {
+            for (uint32_t x = x1; x < x2; x++) {
+               ASSERT_EQ((uint8_t)linear[(y - y1) * linear_pitch + (x - x1)],
+                         pattern(x, y))
+                  << "read type " << read_type << " at (" << x << ", " << y
+                  << ")";
+            }
+         }
+      }
+   }
+
+   enum isl_tiling tiling;
+   uint32_t tw, th;
+   uint32_t pitch, height, size, linear_size;
+   char *tiled, *linear;
+};
+
+} /* anonymous namespace */
+
+TEST_P(tiled_memcpy_test, full_surface)
+{
+   for (const variant &v : get_variants()) {
+      check(v, 0, pitch, 0, height, ISL_MEMCPY);
+      check(v, 0, pitch, 0, height, ISL_MEMCPY_BGRA8);
+   }
+}
+
+TEST_P(tiled_memcpy_test, unaligned_rectangles)
+{
+   const uint32_t rects[][4] = {
+      { 1, 2, 0, 1 },
+      { 3, 29, 5, 7 },
+      { 15, 17, 1, 33 },
+      { 60, 200, 3, 40 },
+      { 17, 3 * 128 - 5, 31, 65 },
+      { 100, 700, 2, 20 },
+      { tw - 1, tw + 1, th - 1, th + 1 },
+   };
+
+   for (const variant &v : get_variants()) {
+      for (const auto &r : rects) {
+         const uint32_t x2 = MIN2(r[1], pitch), y2 = MIN2(r[3], height);
+         if (r[0] >= x2 || r[2] >= y2)
+            continue;
+
+         check(v, r[0], x2, r[2], y2, ISL_MEMCPY);
+
+         /* BGRA8 copies operate on whole pixels. */
+         const uint32_t bx1 = ALIGN(r[0], 4), bx2 = x2 & ~3u;
+         if (bx1 < bx2)
+            check(v, bx1, bx2, r[2], y2, ISL_MEMCPY_BGRA8);
+      }
+   }
+}
+
+TEST_P(tiled_memcpy_test, DISABLED_throughput)
+{
+   const unsigned iterations = 2000;
+
+   for (const variant &v : get_variants()) {
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         v.linear_to_tiled(0, pitch, 0, height, tiled, linear, pitch, pitch,
+                           false, tiling, ISL_MEMCPY);
+      }
+      int64_t upload = os_time_get_nano() - start;
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < iterations; i++) {
+         v.tiled_to_linear(0, pitch, 0, height, linear, tiled, pitch, pitch,
+                           false, tiling, v.streaming_load ?
+                           ISL_MEMCPY_STREAMING_LOAD : ISL_MEMCPY);
+      }
+      int64_t download = os_time_get_nano() - start;
+
+      const double bytes = (double)size * iterations;
+      printf("%-8s %-6s linear_to_tiled %8.1f MB/s, tiled_to_linear %8.1f MB/s\n",
+             tiling_name(tiling), v.name,
+             bytes / upload * 1000.0, bytes / download * 1000.0);
+   }
+}
+
+INSTANTIATE_TEST_CASE_P(isl_tiled_memcpy, tiled_memcpy_test,
+                        testing::Values(ISL_TILING_X, ISL_TILING_Y0,
+                                        ISL_TILING_4));
@@ -409,10 +409,15 @@ anv_block_pool_init(struct anv_block_pool *pool,
       pool->bo = &pool->wrapper_bo;
    }
 
+   if (pthread_mutex_init(&pool->grow_mutex, NULL) != 0) {
+      result = vk_error(device, VK_ERROR_INITIALIZATION_FAILED);
+      goto fail_fd;
+   }
+
    if (!u_vector_init(&pool->mmap_cleanups, 8,
                       sizeof(struct anv_mmap_cleanup))) {
       result = vk_error(device, VK_ERROR_INITIALIZATION_FAILED);
-      goto fail_fd;
+      goto fail_mutex;
    }
 
    pool->state.next = 0;
@@ -433,6 +438,8 @@ anv_block_pool_init(struct anv_block_pool *pool,
 
  fail_mmap_cleanups:
    u_vector_finish(&pool->mmap_cleanups);
+ fail_mutex:
+   pthread_mutex_destroy(&pool->grow_mutex);
  fail_fd:
    if (pool->fd >= 0)
       close(pool->fd);
@@ -453,6 +460,8 @@ anv_block_pool_finish(struct anv_block_pool *pool)
       munmap(cleanup->map, cleanup->size);
    u_vector_finish(&pool->mmap_cleanups);
 
+   pthread_mutex_destroy(&pool->grow_mutex);
+
    if (pool->fd >= 0)
       close(pool->fd);
 }
@@ -518,7 +527,11 @@ anv_block_pool_expand_range(struct anv_block_pool *pool,
       if (result != VK_SUCCESS)
          return result;
 
-      pool->bos[pool->nbos++] = new_bo;
+      /* Execbuf walks the list of BOs without taking grow_mutex, so only
+       * make the new one visible once it's in the array.
+       */
+      pool->bos[pool->nbos] = new_bo;
+      p_atomic_inc(&pool->nbos);
 
       /* This pointer will always point to the first BO in the list */
       pool->bo = pool->bos[0];
@@ -630,7 +643,14 @@ anv_block_pool_grow(struct anv_block_pool *pool, struct anv_block_state *state,
 {
    VkResult result = VK_SUCCESS;
 
-   pthread_mutex_lock(&pool->device->mutex);
+   /* With softpin, growing only appends BOs and never moves existing
+    * contents, so there's no reason to wait for (or block) submissions
+    * holding the device mutex.  Other allocating threads still wait on the
+    * futex in anv_block_pool_alloc_new() until we publish the new end.
+    */
+   pthread_mutex_t *mutex = pool->use_relocations ?
+                            &pool->device->mutex : &pool->grow_mutex;
+   pthread_mutex_lock(mutex);
 
    assert(state == &pool->state || state == &pool->back_state);
 
@@ -726,7 +746,7 @@ anv_block_pool_grow(struct anv_block_pool *pool, struct anv_block_state *state,
    result = anv_block_pool_expand_range(pool, center_bo_offset, size);
 
 done:
-   pthread_mutex_unlock(&pool->device->mutex);
+   pthread_mutex_unlock(mutex);
 
    if (result == VK_SUCCESS) {
       /* Return the appropriate new size.  This function never actually
@@ -1261,6 +1281,13 @@ anv_state_stream_alloc(struct anv_state_stream *stream,
                            struct anv_state, stream->block);
       VG(VALGRIND_MAKE_MEM_NOACCESS(stream->block.map, block_size));
 
+      /* Grab bigger blocks as the stream grows, so that recording a large
+       * command buffer only goes back to the shared state pool a logarithmic
+       * number of times.
+       */
+      if (stream->block_size < ANV_STATE_STREAM_MAX_BLOCK_SIZE)
+         stream->block_size *= 2;
+
       /* Reset back to the start */
       stream->next = offset = 0;
       assert(offset + size <= stream->block.alloc_size);
@@ -890,6 +890,8 @@ anv_cmd_buffer_init_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
       goto fail_bt_blocks;
    cmd_buffer->last_ss_pool_center = 0;
 
+   util_dynarray_init(&cmd_buffer->called_secondaries, NULL);
+
    result = anv_cmd_buffer_new_binding_table_block(cmd_buffer);
    if (result != VK_SUCCESS)
       goto fail_bt_blocks;
@@ -915,6 +917,7 @@ anv_cmd_buffer_fini_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
    u_vector_finish(&cmd_buffer->bt_block_states);
 
    anv_reloc_list_finish(&cmd_buffer->surface_relocs, &cmd_buffer->vk.pool->alloc);
+   util_dynarray_fini(&cmd_buffer->called_secondaries);
 
    u_vector_finish(&cmd_buffer->seen_bbos);
 
@@ -952,6 +955,7 @@ anv_cmd_buffer_reset_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
 
    anv_reloc_list_clear(&cmd_buffer->surface_relocs);
    cmd_buffer->last_ss_pool_center = 0;
+   util_dynarray_clear(&cmd_buffer->called_secondaries);
 
    /* Reset the list of seen buffers */
    cmd_buffer->seen_bbos.head = 0;
@@ -1169,7 +1173,21 @@ anv_cmd_buffer_add_secondary(struct anv_cmd_buffer *primary,
                                                 primary->batch.next));
 
       anv_cmd_buffer_add_seen_bbos(primary, &secondary->batch_bos);
-      break;
+
+      /* The secondary is left untouched, so rather than merging its surface
+       * dependency bitset into ours (which costs as many words as there are
+       * GEM handles), remember it and add its dependencies at submit time.
+       * Executing the same secondary several times in a row is common, so
+       * only record it once in that case.
+       */
+      if (util_dynarray_num_elements(&primary->called_secondaries,
+                                     struct anv_cmd_buffer *) == 0 ||
+          *util_dynarray_top_ptr(&primary->called_secondaries,
+                                 struct anv_cmd_buffer *) != secondary) {
+         util_dynarray_append(&primary->called_secondaries,
+                              struct anv_cmd_buffer *, secondary);
+      }
+      return;
    }
    default:
       assert(!"Invalid execution mode");
@@ -1701,6 +1719,13 @@ setup_execbuf_for_cmd_buffer(struct anv_execbuf *execbuf,
       anv_execbuf_add_bo_bitset(cmd_buffer->device, execbuf,
                                 cmd_buffer->surface_relocs.dep_words,
                                 cmd_buffer->surface_relocs.deps, 0);
+
+      util_dynarray_foreach(&cmd_buffer->called_secondaries,
+                            struct anv_cmd_buffer *, secondary) {
+         anv_execbuf_add_bo_bitset(cmd_buffer->device, execbuf,
+                                   (*secondary)->surface_relocs.dep_words,
+                                   (*secondary)->surface_relocs.deps, 0);
+      }
    }
 
    /* First, we walk over all of the bos we've seen and add them and their
@@ -102,6 +102,7 @@ anv_shader_bin_create(struct anv_device *device,
                                  &anv_shader_bin_ops, obj_key_data, key_size);
 
    shader->stage = stage;
+   shader->hash = _mesa_hash_data(key_data, key_size);
 
    shader->kernel =
       anv_state_pool_alloc(&device->instruction_state_pool, kernel_size, 64);
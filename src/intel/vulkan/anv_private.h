@@ -719,6 +719,13 @@ struct anv_block_pool {
     */
    struct u_vector mmap_cleanups;
 
+   /**
+    * Serializes growth of the pool when softpin is used.  With relocations,
+    * execbuf reads center_bo_offset, so growth takes the device mutex
+    * instead.
+    */
+   pthread_mutex_t grow_mutex;
+
    struct anv_block_state state;
 
    struct anv_block_state back_state;
@@ -796,10 +803,14 @@ struct anv_state_reserved_pool {
    uint32_t count;
 };
 
+#define ANV_STATE_STREAM_MAX_BLOCK_SIZE (256 * 1024)
+
 struct anv_state_stream {
    struct anv_state_pool *state_pool;
 
-   /* The size of blocks to allocate from the state pool */
+   /* The size of blocks to allocate from the state pool.  This doubles with
+    * each new block, up to ANV_STATE_STREAM_MAX_BLOCK_SIZE.
+    */
    uint32_t block_size;
 
    /* Current block we're allocating from */
@@ -3064,6 +3075,14 @@ struct anv_cmd_buffer {
    /** Last seen surface state block pool center bo offset */
    uint32_t                                     last_ss_pool_center;
 
+   /* Secondaries executed with ANV_CMD_BUFFER_EXEC_MODE_CALL_AND_RETURN.
+    * Their surface dependencies are added to the execbuf at submit time
+    * rather than being merged into surface_relocs by vkCmdExecuteCommands.
+    *
+    * initialized by anv_cmd_buffer_init_batch_bo_chain()
+    */
+   struct util_dynarray                         called_secondaries;
+
    /* Serial for tracking buffer completion */
    uint32_t                                     serial;
 
@@ -3245,6 +3264,9 @@ struct anv_shader_bin {
 
    gl_shader_stage stage;
 
+   /* Hash of the cache key, used to identify the shader in traces. */
+   uint32_t hash;
+
    struct anv_state kernel;
    uint32_t kernel_size;
 
@@ -3270,6 +3292,12 @@ anv_shader_bin_create(struct anv_device *device,
                       const struct nir_xfb_info *xfb_info,
                       const struct anv_pipeline_bind_map *bind_map);
 
+static inline uint32_t
+anv_shader_bin_hash(const struct anv_shader_bin *shader)
+{
+   return shader ? shader->hash : 0;
+}
+
 static inline void
 anv_shader_bin_ref(struct anv_shader_bin *shader)
 {
@@ -4252,7 +4252,9 @@ void genX(CmdDraw)(
 
    update_dirty_vbs_for_gfx8_vb_flush(cmd_buffer, SEQUENTIAL);
 
-   trace_intel_end_draw(&cmd_buffer->trace, cmd_buffer, count);
+   trace_intel_end_draw(&cmd_buffer->trace, cmd_buffer, count,
+                        anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                        anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 void genX(CmdDrawMultiEXT)(
@@ -4310,7 +4312,9 @@ void genX(CmdDrawMultiEXT)(
 
    update_dirty_vbs_for_gfx8_vb_flush(cmd_buffer, SEQUENTIAL);
 
-   trace_intel_end_draw_multi(&cmd_buffer->trace, cmd_buffer, count);
+   trace_intel_end_draw_multi(&cmd_buffer->trace, cmd_buffer, count,
+                              anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                              anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 void genX(CmdDrawIndexed)(
@@ -4364,7 +4368,9 @@ void genX(CmdDrawIndexed)(
 
    update_dirty_vbs_for_gfx8_vb_flush(cmd_buffer, RANDOM);
 
-   trace_intel_end_draw_indexed(&cmd_buffer->trace, cmd_buffer, count);
+   trace_intel_end_draw_indexed(&cmd_buffer->trace, cmd_buffer, count,
+                                anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 void genX(CmdDrawMultiIndexedEXT)(
@@ -4479,7 +4485,9 @@ void genX(CmdDrawMultiIndexedEXT)(
 
    update_dirty_vbs_for_gfx8_vb_flush(cmd_buffer, RANDOM);
 
-   trace_intel_end_draw_indexed_multi(&cmd_buffer->trace, cmd_buffer, count);
+   trace_intel_end_draw_indexed_multi(&cmd_buffer->trace, cmd_buffer, count,
+                                      anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                      anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 /* Auto-Draw / Indirect Registers */
@@ -4564,7 +4572,9 @@ void genX(CmdDrawIndirectByteCountEXT)(
    update_dirty_vbs_for_gfx8_vb_flush(cmd_buffer, SEQUENTIAL);
 
    trace_intel_end_draw_indirect_byte_count(&cmd_buffer->trace, cmd_buffer,
-                                            instanceCount);
+                                            instanceCount,
+                                            anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                            anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 #endif /* GFX_VERx10 >= 75 */
 }
 
@@ -4660,7 +4670,9 @@ void genX(CmdDrawIndirect)(
       offset += stride;
    }
 
-   trace_intel_end_draw_indirect(&cmd_buffer->trace, cmd_buffer, drawCount);
+   trace_intel_end_draw_indirect(&cmd_buffer->trace, cmd_buffer, drawCount,
+                                 anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                 anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 void genX(CmdDrawIndexedIndirect)(
@@ -4718,7 +4730,9 @@ void genX(CmdDrawIndexedIndirect)(
       offset += stride;
    }
 
-   trace_intel_end_draw_indexed_indirect(&cmd_buffer->trace, cmd_buffer, drawCount);
+   trace_intel_end_draw_indexed_indirect(&cmd_buffer->trace, cmd_buffer, drawCount,
+                                         anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                         anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 static struct mi_value
@@ -4891,7 +4905,9 @@ void genX(CmdDrawIndirectCount)(
 
    mi_value_unref(&b, max);
 
-   trace_intel_end_draw_indirect_count(&cmd_buffer->trace, cmd_buffer, maxDrawCount);
+   trace_intel_end_draw_indirect_count(&cmd_buffer->trace, cmd_buffer, maxDrawCount,
+                                       anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                       anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 }
 
 void genX(CmdDrawIndexedIndirectCount)(
@@ -4961,7 +4977,9 @@ void genX(CmdDrawIndexedIndirectCount)(
    mi_value_unref(&b, max);
 
    trace_intel_end_draw_indexed_indirect_count(&cmd_buffer->trace,
-                                               cmd_buffer, maxDrawCount);
+                                               cmd_buffer, maxDrawCount,
+                                               anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_VERTEX]),
+                                               anv_shader_bin_hash(pipeline->shaders[MESA_SHADER_FRAGMENT]));
 
 }
 
@@ -5519,7 +5537,8 @@ void genX(CmdDispatchBase)(
                   groupCountY, groupCountZ);
 
    trace_intel_end_compute(&cmd_buffer->trace, cmd_buffer,
-                           groupCountX, groupCountY, groupCountZ);
+                           groupCountX, groupCountY, groupCountZ,
+                           anv_shader_bin_hash(pipeline->cs));
 }
 
 #define GPGPU_DISPATCHDIMX 0x2500
@@ -5628,7 +5647,8 @@ void genX(CmdDispatchIndirect)(
 
    emit_cs_walker(cmd_buffer, pipeline, true, prog_data, 0, 0, 0);
 
-   trace_intel_end_compute(&cmd_buffer->trace, cmd_buffer, 0, 0, 0);
+   trace_intel_end_compute(&cmd_buffer->trace, cmd_buffer, 0, 0, 0,
+                           anv_shader_bin_hash(pipeline->cs));
 }
 
 struct anv_state
@@ -284,6 +284,10 @@ dri3_update_max_num_back(struct loader_dri3_drawable *draw)
       else
          new_max = 3;
 
+      /* Flipping needs at least two buffers to not stall on every frame */
+      if (draw->max_num_back_override)
+         new_max = MAX2(draw->max_num_back_override, 2);
+
       assert(new_max <= LOADER_DRI3_MAX_BACK);
 
       if (new_max != draw->max_num_back) {
@@ -422,8 +426,10 @@ loader_dri3_drawable_init(xcb_connection_t *conn,
    mtx_init(&draw->mtx, mtx_plain);
    cnd_init(&draw->event_cnd);
 
+   draw->max_num_back_override = 0;
    if (draw->ext->config) {
       unsigned char adaptive_sync = 0;
+      int max_back = 0;
 
       draw->ext->config->configQueryi(draw->dri_screen,
                                       "vblank_mode", &vblank_mode);
@@ -433,6 +439,10 @@ loader_dri3_drawable_init(xcb_connection_t *conn,
                                       &adaptive_sync);
 
       draw->adaptive_sync = adaptive_sync;
+
+      if (draw->ext->config->configQueryi(draw->dri_screen,
+                                          "dri3_max_back", &max_back) == 0)
+         draw->max_num_back_override = MIN2(max_back, LOADER_DRI3_MAX_BACK);
    }
 
    if (!draw->adaptive_sync)
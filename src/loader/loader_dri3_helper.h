@@ -162,6 +162,8 @@ struct loader_dri3_drawable {
    int cur_back;
    int cur_num_back;
    int max_num_back;
+   /* dri3_max_back driconf value, 0 to pick max_num_back automatically */
+   int max_num_back_override;
    int cur_blit_source;
 
    uint32_t *stamp;
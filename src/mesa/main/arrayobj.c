@@ -398,6 +398,7 @@ _mesa_initialize_vao(struct gl_context *ctx,
 {
    memcpy(vao, &ctx->Array.DefaultVAOState, sizeof(*vao));
    vao->Name = name;
+   vao->_VertexElementsCache.Valid = false;
 }
 
 
@@ -1217,6 +1217,7 @@ copy_array_object(struct gl_context *ctx,
    dest->_AttributeMapMode = src->_AttributeMapMode;
    dest->NewVertexBuffers = src->NewVertexBuffers;
    dest->NewVertexElements = src->NewVertexElements;
+   dest->_VertexElementsCache.Valid = false;
    /* skip NumUpdates and IsDynamic because they can only increase, not decrease */
 }
 
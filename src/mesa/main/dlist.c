@@ -1560,6 +1560,49 @@ _mesa_dlist_alloc_vertex_list(struct gl_context *ctx, bool copy_to_current)
 }
 
 
+/**
+ * Return the last instruction of the display list being compiled if it's
+ * a vertex list, or NULL otherwise.
+ */
+void *
+_mesa_dlist_get_last_vertex_list(struct gl_context *ctx)
+{
+   if (!ctx->ListState.CurrentBlock || !ctx->ListState.LastInstSize)
+      return NULL;
+
+   Node *n = ctx->ListState.CurrentBlock + ctx->ListState.CurrentPos -
+             ctx->ListState.LastInstSize;
+
+   if (n[0].opcode != OPCODE_VERTEX_LIST &&
+       n[0].opcode != OPCODE_VERTEX_LIST_COPY_CURRENT)
+      return NULL;
+
+   return n;
+}
+
+
+/**
+ * Remove the vertex list "node", which must be the last instruction of the
+ * display list being compiled and directly follow "prev" in the same block.
+ * This is used after the contents of "node" have been merged into "prev".
+ */
+void
+_mesa_dlist_free_last_vertex_list(struct gl_context *ctx, void *node,
+                                  void *prev)
+{
+   Node *n = (Node *) node;
+   Node *p = (Node *) prev;
+
+   assert(n == _mesa_dlist_get_last_vertex_list(ctx));
+   assert(p + p[0].InstSize == n);
+
+   vbo_destroy_vertex_list(ctx, (struct vbo_save_vertex_list *) n);
+
+   ctx->ListState.CurrentPos -= n[0].InstSize;
+   ctx->ListState.LastInstSize = p[0].InstSize;
+}
+
+
 /**
  * Allocate space for a display list instruction.  The space is basically
  * an array of Nodes where node[0] holds the opcode, node[1] is the first
@@ -14346,6 +14389,15 @@ _mesa_glthread_execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_ENABLE:
             _mesa_glthread_Enable(ctx, n[1].e);
             break;
+         /* save_Enablei/Disablei store the target in n[1] and the index
+          * in n[2].
+          */
+         case OPCODE_DISABLE_INDEXED:
+            _mesa_glthread_Disablei(ctx, n[1].ui, n[2].e);
+            break;
+         case OPCODE_ENABLE_INDEXED:
+            _mesa_glthread_Enablei(ctx, n[1].ui, n[2].e);
+            break;
          case OPCODE_LIST_BASE:
             _mesa_glthread_ListBase(ctx, n[1].ui);
             break;
@@ -14373,6 +14425,14 @@ _mesa_glthread_execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_MATRIX_POP:
             _mesa_glthread_MatrixPopEXT(ctx, n[1].e);
             break;
+         case OPCODE_VIEWPORT:
+            _mesa_glthread_Viewport(ctx, n[1].i, n[2].i, n[3].i, n[4].i);
+            break;
+         case OPCODE_VIEWPORT_ARRAY_V:
+         case OPCODE_VIEWPORT_INDEXED_F:
+         case OPCODE_VIEWPORT_INDEXED_FV:
+            _mesa_glthread_ViewportArray(ctx, n[1].ui);
+            break;
          case OPCODE_CONTINUE:
             n = (Node *)get_pointer(&n[1]);
             continue;
@@ -14403,7 +14463,9 @@ _mesa_glthread_should_execute_list(struct gl_context *ctx,
       case OPCODE_CALL_LIST:
       case OPCODE_CALL_LISTS:
       case OPCODE_DISABLE:
+      case OPCODE_DISABLE_INDEXED:
       case OPCODE_ENABLE:
+      case OPCODE_ENABLE_INDEXED:
       case OPCODE_LIST_BASE:
       case OPCODE_MATRIX_MODE:
       case OPCODE_POP_ATTRIB:
@@ -14413,6 +14475,10 @@ _mesa_glthread_should_execute_list(struct gl_context *ctx,
       case OPCODE_ACTIVE_TEXTURE:   /* GL_ARB_multitexture */
       case OPCODE_MATRIX_PUSH:
       case OPCODE_MATRIX_POP:
+      case OPCODE_VIEWPORT:
+      case OPCODE_VIEWPORT_ARRAY_V:
+      case OPCODE_VIEWPORT_INDEXED_F:
+      case OPCODE_VIEWPORT_INDEXED_FV:
          return true;
       case OPCODE_CONTINUE:
          n = (Node *)get_pointer(&n[1]);
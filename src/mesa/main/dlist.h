@@ -117,6 +117,13 @@ void *
 _mesa_dlist_alloc_vertex_list(struct gl_context *ctx,
                               bool copy_to_current);
 
+void *
+_mesa_dlist_get_last_vertex_list(struct gl_context *ctx);
+
+void
+_mesa_dlist_free_last_vertex_list(struct gl_context *ctx, void *node,
+                                  void *prev);
+
 void
 _mesa_delete_list(struct gl_context *ctx, struct gl_display_list *dlist);
 
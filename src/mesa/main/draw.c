@@ -120,6 +120,8 @@ _mesa_set_draw_vao(struct gl_context *ctx, struct gl_vertex_array_object *vao,
       _mesa_update_vao_derived_arrays(ctx, vao);
       new_vertex_buffers |= vao->NewVertexBuffers;
       new_vertex_elements |= vao->NewVertexElements;
+      if (vao->NewVertexElements)
+         vao->_VertexElementsCache.Valid = false;
       vao->NewVertexBuffers = false;
       vao->NewVertexElements = false;
    }
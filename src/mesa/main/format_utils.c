@@ -38,6 +38,12 @@ const mesa_array_format RGBA8_UBYTE =
    MESA_ARRAY_FORMAT(MESA_ARRAY_FORMAT_BASE_FORMAT_RGBA_VARIANTS,
                      1, 0, 0, 1, 4, 0, 1, 2, 3);
 
+/* When _mesa_format_convert has to go through an intermediate RGBA format it
+ * converts this many bytes of it at a time, so that the temporary stays in
+ * cache between unpacking the source and packing the destination.
+ */
+#define CONVERT_BLOCK_BYTES (64 * 1024)
+
 const mesa_array_format BGRA8_UBYTE =
    MESA_ARRAY_FORMAT(MESA_ARRAY_FORMAT_BASE_FORMAT_RGBA_VARIANTS,
                      1, 0, 0, 1, 4, 2, 1, 0, 3);
@@ -292,7 +298,10 @@ _mesa_format_convert(void *void_dst, uint32_t dst_format, size_t dst_stride,
    float (*tmp_float)[4];
    uint32_t (*tmp_uint)[4];
    int bits;
-   size_t row;
+   size_t row, y, block_rows;
+
+   if (width == 0 || height == 0)
+      return;
 
    if (_mesa_format_is_mesa_array_format(src_format)) {
       src_format_is_mesa_array_format = true;
@@ -515,7 +524,9 @@ _mesa_format_convert(void *void_dst, uint32_t dst_format, size_t dst_stride,
    assert(src_integer == dst_integer);
 
    if (src_integer && dst_integer) {
-      tmp_uint = malloc(width * height * sizeof(*tmp_uint));
+      block_rows = MIN2(height, MAX2(1, CONVERT_BLOCK_BYTES /
+                                           (width * sizeof(*tmp_uint))));
+      tmp_uint = malloc(width * block_rows * sizeof(*tmp_uint));
 
       /* The [un]packing functions for unsigned datatypes treat the 32-bit
        * integer array as signed for signed formats and as unsigned for
@@ -529,131 +540,148 @@ _mesa_format_convert(void *void_dst, uint32_t dst_format, size_t dst_stride,
        */
       common_type = is_signed ? MESA_ARRAY_FORMAT_TYPE_INT :
                                 MESA_ARRAY_FORMAT_TYPE_UINT;
-      if (src_array_format) {
-         compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
-                                                rebased_src2rgba);
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(tmp_uint + row * width, common_type, 4,
-                                      src, src_type, src_num_channels,
-                                      rebased_src2rgba, normalized, width);
-            src += src_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_unpack_uint_rgba_row(src_format, width,
-                                       src, tmp_uint + row * width);
-            if (rebase_swizzle)
+
+      for (y = 0; y < height; y += block_rows) {
+         const size_t rows = MIN2(block_rows, height - y);
+
+         if (src_array_format) {
+            compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
+                                                   rebased_src2rgba);
+            for (row = 0; row < rows; ++row) {
                _mesa_swizzle_and_convert(tmp_uint + row * width, common_type, 4,
-                                         tmp_uint + row * width, common_type, 4,
-                                         rebase_swizzle, false, width);
-            src += src_stride;
+                                         src, src_type, src_num_channels,
+                                         rebased_src2rgba, normalized, width);
+               src += src_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_unpack_uint_rgba_row(src_format, width,
+                                          src, tmp_uint + row * width);
+               if (rebase_swizzle)
+                  _mesa_swizzle_and_convert(tmp_uint + row * width, common_type, 4,
+                                            tmp_uint + row * width, common_type, 4,
+                                            rebase_swizzle, false, width);
+               src += src_stride;
+            }
          }
-      }
 
-      /* At this point, we have already done the truncation if the source is
-       * signed but the destination is unsigned, so no need to force the
-       * _mesa_swizzle_and_convert path.
-       */
-      if (dst_format_is_mesa_array_format) {
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
-                                      tmp_uint + row * width, common_type, 4,
-                                      rgba2dst, normalized, width);
-            dst += dst_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_pack_uint_rgba_row(dst_format, width,
-                                     (const uint32_t (*)[4])tmp_uint + row * width, dst);
-            dst += dst_stride;
+         /* At this point, we have already done the truncation if the source is
+          * signed but the destination is unsigned, so no need to force the
+          * _mesa_swizzle_and_convert path.
+          */
+         if (dst_format_is_mesa_array_format) {
+            for (row = 0; row < rows; ++row) {
+               _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
+                                         tmp_uint + row * width, common_type, 4,
+                                         rgba2dst, normalized, width);
+               dst += dst_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_pack_uint_rgba_row(dst_format, width,
+                                        (const uint32_t (*)[4])tmp_uint + row * width, dst);
+               dst += dst_stride;
+            }
          }
       }
 
       free(tmp_uint);
    } else if (is_signed || bits > 8) {
-      tmp_float = malloc(width * height * sizeof(*tmp_float));
-
-      if (src_format_is_mesa_array_format) {
-         compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
-                                                rebased_src2rgba);
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(tmp_float + row * width,
-                                      MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
-                                      src, src_type, src_num_channels,
-                                      rebased_src2rgba, normalized, width);
-            src += src_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_unpack_rgba_row(src_format, width,
-                                  src, tmp_float + row * width);
-            if (rebase_swizzle)
+      block_rows = MIN2(height, MAX2(1, CONVERT_BLOCK_BYTES /
+                                           (width * sizeof(*tmp_float))));
+      tmp_float = malloc(width * block_rows * sizeof(*tmp_float));
+
+      for (y = 0; y < height; y += block_rows) {
+         const size_t rows = MIN2(block_rows, height - y);
+
+         if (src_format_is_mesa_array_format) {
+            compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
+                                                   rebased_src2rgba);
+            for (row = 0; row < rows; ++row) {
                _mesa_swizzle_and_convert(tmp_float + row * width,
                                          MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
-                                         tmp_float + row * width,
-                                         MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
-                                         rebase_swizzle, normalized, width);
-            src += src_stride;
+                                         src, src_type, src_num_channels,
+                                         rebased_src2rgba, normalized, width);
+               src += src_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_unpack_rgba_row(src_format, width,
+                                     src, tmp_float + row * width);
+               if (rebase_swizzle)
+                  _mesa_swizzle_and_convert(tmp_float + row * width,
+                                            MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
+                                            tmp_float + row * width,
+                                            MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
+                                            rebase_swizzle, normalized, width);
+               src += src_stride;
+            }
          }
-      }
 
-      if (dst_format_is_mesa_array_format) {
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
-                                      tmp_float + row * width,
-                                      MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
-                                      rgba2dst, normalized, width);
-            dst += dst_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_pack_float_rgba_row(dst_format, width,
-                                      (const float (*)[4])tmp_float + row * width, dst);
-            dst += dst_stride;
+         if (dst_format_is_mesa_array_format) {
+            for (row = 0; row < rows; ++row) {
+               _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
+                                         tmp_float + row * width,
+                                         MESA_ARRAY_FORMAT_TYPE_FLOAT, 4,
+                                         rgba2dst, normalized, width);
+               dst += dst_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_pack_float_rgba_row(dst_format, width,
+                                         (const float (*)[4])tmp_float + row * width, dst);
+               dst += dst_stride;
+            }
          }
       }
 
       free(tmp_float);
    } else {
-      tmp_ubyte = malloc(width * height * sizeof(*tmp_ubyte));
-
-      if (src_format_is_mesa_array_format) {
-         compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
-                                                rebased_src2rgba);
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(tmp_ubyte + row * width,
-                                      MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
-                                      src, src_type, src_num_channels,
-                                      rebased_src2rgba, normalized, width);
-            src += src_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_unpack_ubyte_rgba_row(src_format, width,
-                                        src, tmp_ubyte + row * width);
-            if (rebase_swizzle)
+      block_rows = MIN2(height, MAX2(1, CONVERT_BLOCK_BYTES /
+                                           (width * sizeof(*tmp_ubyte))));
+      tmp_ubyte = malloc(width * block_rows * sizeof(*tmp_ubyte));
+
+      for (y = 0; y < height; y += block_rows) {
+         const size_t rows = MIN2(block_rows, height - y);
+
+         if (src_format_is_mesa_array_format) {
+            compute_rebased_rgba_component_mapping(src2rgba, rebase_swizzle,
+                                                   rebased_src2rgba);
+            for (row = 0; row < rows; ++row) {
                _mesa_swizzle_and_convert(tmp_ubyte + row * width,
                                          MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
-                                         tmp_ubyte + row * width,
-                                         MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
-                                         rebase_swizzle, normalized, width);
-            src += src_stride;
+                                         src, src_type, src_num_channels,
+                                         rebased_src2rgba, normalized, width);
+               src += src_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_unpack_ubyte_rgba_row(src_format, width,
+                                           src, tmp_ubyte + row * width);
+               if (rebase_swizzle)
+                  _mesa_swizzle_and_convert(tmp_ubyte + row * width,
+                                            MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                                            tmp_ubyte + row * width,
+                                            MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                                            rebase_swizzle, normalized, width);
+               src += src_stride;
+            }
          }
-      }
 
-      if (dst_format_is_mesa_array_format) {
-         for (row = 0; row < height; ++row) {
-            _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
-                                      tmp_ubyte + row * width,
-                                      MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
-                                      rgba2dst, normalized, width);
-            dst += dst_stride;
-         }
-      } else {
-         for (row = 0; row < height; ++row) {
-            _mesa_pack_ubyte_rgba_row(dst_format, width,
-                                      (const uint8_t *)(tmp_ubyte + row * width), dst);
-            dst += dst_stride;
+         if (dst_format_is_mesa_array_format) {
+            for (row = 0; row < rows; ++row) {
+               _mesa_swizzle_and_convert(dst, dst_type, dst_num_channels,
+                                         tmp_ubyte + row * width,
+                                         MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                                         rgba2dst, normalized, width);
+               dst += dst_stride;
+            }
+         } else {
+            for (row = 0; row < rows; ++row) {
+               _mesa_pack_ubyte_rgba_row(dst_format, width,
+                                         (const uint8_t *)(tmp_ubyte + row * width), dst);
+               dst += dst_stride;
+            }
          }
       }
 
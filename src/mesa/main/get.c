@@ -1985,15 +1985,76 @@ _mesa_GetFloatv(GLenum pname, GLfloat *params)
    }
 }
 
+/**
+ * Return the value of binding queries that apps issue very often, without
+ * the hash table walk of find_value() and the generic type conversion.
+ *
+ * Only pnames that exist in every API without an extension check, or with
+ * a trivial API check, may be handled here; everything else returns false
+ * and goes through find_value() as usual.
+ */
+static inline bool
+get_binding_fast(struct gl_context *ctx, GLenum pname, GLint *value)
+{
+   const struct gl_buffer_object *buf;
+
+   switch (pname) {
+   case GL_ARRAY_BUFFER_BINDING:
+      buf = ctx->Array.ArrayBufferObj;
+      *value = buf ? buf->Name : 0;
+      return true;
+   case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+      buf = ctx->Array.VAO->IndexBufferObj;
+      *value = buf ? buf->Name : 0;
+      return true;
+   case GL_VERTEX_ARRAY_BINDING:
+      *value = ctx->Array.VAO->Name;
+      return true;
+   case GL_TEXTURE_BINDING_2D:
+      *value = ctx->Texture.Unit[ctx->Texture.CurrentUnit]
+                  .CurrentTex[TEXTURE_2D_INDEX]->Name;
+      return true;
+   case GL_TEXTURE_BINDING_CUBE_MAP:
+      *value = ctx->Texture.Unit[ctx->Texture.CurrentUnit]
+                  .CurrentTex[TEXTURE_CUBE_INDEX]->Name;
+      return true;
+   case GL_ACTIVE_TEXTURE:
+      *value = GL_TEXTURE0 + ctx->Texture.CurrentUnit;
+      return true;
+   case GL_DRAW_FRAMEBUFFER_BINDING:
+      *value = ctx->DrawBuffer->Name;
+      return true;
+   case GL_READ_FRAMEBUFFER_BINDING:
+      if (!_mesa_is_desktop_gl(ctx) && !_mesa_is_gles3(ctx))
+         return false;
+      *value = ctx->ReadBuffer->Name;
+      return true;
+   case GL_RENDERBUFFER_BINDING:
+      *value = ctx->CurrentRenderbuffer ? ctx->CurrentRenderbuffer->Name : 0;
+      return true;
+   case GL_CURRENT_PROGRAM:
+      if (ctx->API == API_OPENGLES)
+         return false;
+      *value = ctx->Shader.ActiveProgram ? ctx->Shader.ActiveProgram->Name : 0;
+      return true;
+   default:
+      return false;
+   }
+}
+
 void GLAPIENTRY
 _mesa_GetIntegerv(GLenum pname, GLint *params)
 {
+   GET_CURRENT_CONTEXT(ctx);
    const struct value_desc *d;
    union value v;
    GLmatrix *m;
    int shift, i;
    void *p;
 
+   if (get_binding_fast(ctx, pname, params))
+      return;
+
    d = find_value("glGetIntegerv", pname, &p, &v);
    switch (d->type) {
    case TYPE_INVALID:
@@ -2114,11 +2175,18 @@ _mesa_GetIntegerv(GLenum pname, GLint *params)
 void GLAPIENTRY
 _mesa_GetInteger64v(GLenum pname, GLint64 *params)
 {
+   GET_CURRENT_CONTEXT(ctx);
    const struct value_desc *d;
    union value v;
    GLmatrix *m;
    int shift, i;
    void *p;
+   GLint value;
+
+   if (get_binding_fast(ctx, pname, &value)) {
+      params[0] = value;
+      return;
+   }
 
    d = find_value("glGetInteger64v", pname, &p, &v);
    switch (d->type) {
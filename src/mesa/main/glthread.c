@@ -36,6 +36,8 @@
 #include "main/glthread.h"
 #include "main/glthread_marshal.h"
 #include "main/hash.h"
+#include "util/debug.h"
+#include "util/hash_table.h"
 #include "util/u_atomic.h"
 #include "util/u_thread.h"
 #include "util/u_cpu_detect.h"
@@ -122,6 +124,12 @@ _mesa_glthread_init(struct gl_context *ctx)
    }
    glthread->next_batch = &glthread->batches[glthread->next];
    glthread->used = 0;
+   glthread->batch_limit = MARSHAL_MAX_CMD_SIZE / 8;
+
+   if (env_var_as_boolean("MESA_GLTHREAD_SYNC_STATS", false)) {
+      glthread->sync_stats = _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                                     _mesa_key_string_equal);
+   }
 
    glthread->enabled = true;
    glthread->stats.queue = &glthread->queue;
@@ -141,6 +149,12 @@ _mesa_glthread_init(struct gl_context *ctx)
 
    glthread->LastDListChangeBatchIndex = -1;
 
+#define GLTHREAD_ENABLE(cap, attrib_mask, default_value) \
+   if (default_value) \
+      glthread->Enabled |= BITFIELD_BIT(GLTHREAD_ENABLE_INDEX_##cap);
+#include "glthread_enables.h"
+#undef GLTHREAD_ENABLE
+
    /* Execute the thread initialization function in the thread. */
    struct util_queue_fence fence;
    util_queue_fence_init(&fence);
@@ -156,6 +170,43 @@ free_vao(void *data, UNUSED void *userData)
    free(data);
 }
 
+static int
+compare_sync_stats(const void *a, const void *b)
+{
+   const struct hash_entry *ea = *(const struct hash_entry **)a;
+   const struct hash_entry *eb = *(const struct hash_entry **)b;
+   uintptr_t ca = (uintptr_t)ea->data, cb = (uintptr_t)eb->data;
+
+   if (ca != cb)
+      return ca < cb ? 1 : -1;
+   return strcmp(ea->key, eb->key);
+}
+
+static void
+print_sync_stats(struct glthread_state *glthread)
+{
+   struct hash_table *ht = glthread->sync_stats;
+   unsigned count = ht->entries, i = 0;
+   struct hash_entry **entries = malloc(count * sizeof(*entries));
+
+   if (entries) {
+      hash_table_foreach(ht, entry)
+         entries[i++] = entry;
+      qsort(entries, count, sizeof(*entries), compare_sync_stats);
+
+      fprintf(stderr, "glthread syncs by function (%u total):\n",
+              glthread->stats.num_syncs);
+      for (i = 0; i < count; i++) {
+         fprintf(stderr, "  %8"PRIuPTR" %s\n", (uintptr_t)entries[i]->data,
+                 (const char *)entries[i]->key);
+      }
+      free(entries);
+   }
+
+   _mesa_hash_table_destroy(ht, NULL);
+   glthread->sync_stats = NULL;
+}
+
 void
 _mesa_glthread_destroy(struct gl_context *ctx, const char *reason)
 {
@@ -170,6 +221,9 @@ _mesa_glthread_destroy(struct gl_context *ctx, const char *reason)
    _mesa_glthread_finish(ctx);
    util_queue_destroy(&glthread->queue);
 
+   if (glthread->sync_stats)
+      print_sync_stats(glthread);
+
    for (unsigned i = 0; i < MARSHAL_MAX_BATCHES; i++)
       util_queue_fence_destroy(&glthread->batches[i].fence);
 
@@ -235,6 +289,18 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
       return;
    }
 
+   /* If the worker has already finished the previous batch, it is waiting
+    * for us, so give it work sooner. If it hasn't, fewer and larger batches
+    * cost less.
+    */
+   if (util_queue_fence_is_signalled(&glthread->batches[glthread->last].fence)) {
+      glthread->batch_limit = MAX2(glthread->batch_limit - 128,
+                                   MARSHAL_MIN_BATCH_SIZE / 8);
+   } else {
+      glthread->batch_limit = MIN2(glthread->batch_limit + 128,
+                                   MARSHAL_MAX_CMD_SIZE / 8);
+   }
+
    p_atomic_add(&glthread->stats.num_offloaded_items, glthread->used);
    next->used = glthread->used;
 
@@ -301,8 +367,22 @@ _mesa_glthread_finish(struct gl_context *ctx)
 void
 _mesa_glthread_finish_before(struct gl_context *ctx, const char *func)
 {
+   struct glthread_state *glthread = &ctx->GLThread;
+   unsigned num_syncs = glthread->stats.num_syncs;
+
    _mesa_glthread_finish(ctx);
 
+   if (unlikely(glthread->sync_stats) &&
+       glthread->stats.num_syncs != num_syncs) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search(glthread->sync_stats, func);
+
+      if (entry)
+         entry->data = (void *)((uintptr_t)entry->data + 1);
+      else
+         _mesa_hash_table_insert(glthread->sync_stats, func, (void *)1);
+   }
+
    /* Uncomment this if you want to know where glthread syncs. */
    /*printf("fallback to sync: %s\n", func);*/
 }
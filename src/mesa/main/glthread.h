@@ -35,6 +35,14 @@
  */
 #define MARSHAL_MAX_CMD_SIZE (8 * 1024)
 
+/* The smallest size at which batches are flushed.
+ *
+ * Batches are flushed earlier than MARSHAL_MAX_CMD_SIZE when the worker
+ * thread keeps running out of work, so that it gets commands sooner. See
+ * glthread_state::batch_limit.
+ */
+#define MARSHAL_MIN_BATCH_SIZE (1 * 1024)
+
 /* The number of batch slots in memory.
  *
  * One batch is being executed, one batch is being filled, the rest are
@@ -60,6 +68,7 @@ extern "C" {
 struct gl_context;
 struct gl_buffer_object;
 struct _mesa_HashTable;
+struct hash_table;
 
 struct glthread_attrib_binding {
    struct gl_buffer_object *buffer; /**< where non-VBO data was uploaded */
@@ -129,6 +138,19 @@ struct glthread_attrib_node {
    GLbitfield Mask;
    int ActiveTexture;
    GLenum MatrixMode;
+   GLbitfield Enabled;
+   unsigned ListBase;
+   bool ViewportKnown;
+   GLint Viewport[4];
+};
+
+/* Bits of glthread_state::Enabled, one per entry of glthread_enables.h. */
+enum {
+#define GLTHREAD_ENABLE(cap, attrib_mask, default_value) \
+   GLTHREAD_ENABLE_INDEX_##cap,
+#include "glthread_enables.h"
+#undef GLTHREAD_ENABLE
+   GLTHREAD_NUM_ENABLES,
 };
 
 typedef enum {
@@ -176,6 +198,16 @@ struct glthread_state
    /** Number of uint64_t elements filled already. */
    unsigned used;
 
+   /**
+    * Number of uint64_t elements after which the batch is flushed. It shrinks
+    * while the worker thread is idle at flush time and grows while it is
+    * still busy.
+    */
+   unsigned batch_limit;
+
+   /** Syncs per function name, if MESA_GLTHREAD_SYNC_STATS is set. */
+   struct hash_table *sync_stats;
+
    /** Upload buffer. */
    struct gl_buffer_object *upload_buffer;
    uint8_t *upload_ptr;
@@ -229,10 +261,19 @@ struct glthread_state
    int AttribStackDepth;
    int MatrixStackDepth[M_NUM_MATRIX_STACKS];
 
-   /** Enable states. */
-   bool CullFace;
+   /** Enable states, a bit per GLTHREAD_ENABLE_INDEX_*. */
+   GLbitfield Enabled;
+
+   /**
+    * Viewport 0 as set by glViewport. It's unknown until the first
+    * glViewport call because the driver sets the initial viewport at
+    * MakeCurrent, and after glViewportArrayv / glViewportIndexed*.
+    */
+   bool ViewportKnown;
+   GLint Viewport[4];
 
    GLuint CurrentDrawFramebuffer;
+   GLuint CurrentReadFramebuffer;
    GLuint CurrentProgram;
 };
 
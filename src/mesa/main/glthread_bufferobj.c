@@ -423,9 +423,12 @@ _mesa_marshal_BufferSubData_merged(GLuint target_or_name, GLintptr offset,
    /* TODO: Handle offset == 0 && size < buffer_size.
     *       If offset == 0 and size == buffer_size, it's better to discard
     *       the buffer storage, but we don't know the buffer size in glthread.
+    *       That only matters while the data fits in a batch though. Larger
+    *       uploads at offset 0 would sync otherwise, which is worse.
     */
    if (ctx->GLThread.SupportsBufferUploads &&
-       data && offset > 0 && size > 0) {
+       data && size > 0 &&
+       (offset > 0 || cmd_size > MARSHAL_MAX_CMD_SIZE)) {
       struct gl_buffer_object *upload_buffer = NULL;
       unsigned upload_offset = 0;
 
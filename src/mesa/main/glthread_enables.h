@@ -0,0 +1,42 @@
+/*
+ * Copyright © 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Enable states that glthread shadows, so that glIsEnabled and glGet* for
+ * them don't have to sync.
+ *
+ * Only caps that exist in every API glthread runs with may be listed,
+ * because setting them in glthread doesn't check for errors.
+ *
+ * Columns: the cap, the glPushAttrib groups that save it, and its initial
+ * value.
+ */
+
+GLTHREAD_ENABLE(GL_BLEND,                    GL_COLOR_BUFFER_BIT,   false)
+GLTHREAD_ENABLE(GL_CULL_FACE,                GL_POLYGON_BIT,        false)
+GLTHREAD_ENABLE(GL_DEPTH_TEST,               GL_DEPTH_BUFFER_BIT,   false)
+GLTHREAD_ENABLE(GL_DITHER,                   GL_COLOR_BUFFER_BIT,   true)
+GLTHREAD_ENABLE(GL_POLYGON_OFFSET_FILL,      GL_POLYGON_BIT,        false)
+GLTHREAD_ENABLE(GL_SAMPLE_ALPHA_TO_COVERAGE, GL_MULTISAMPLE_BIT,    false)
+GLTHREAD_ENABLE(GL_SAMPLE_COVERAGE,          GL_MULTISAMPLE_BIT,    false)
+GLTHREAD_ENABLE(GL_SCISSOR_TEST,             GL_SCISSOR_BIT,        false)
+GLTHREAD_ENABLE(GL_STENCIL_TEST,             GL_STENCIL_BUFFER_BIT, false)
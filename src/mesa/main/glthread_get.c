@@ -68,6 +68,30 @@ _mesa_marshal_GetIntegerv(GLenum pname, GLint *p)
    case GL_DRAW_FRAMEBUFFER_BINDING: /* == GL_FRAMEBUFFER_BINDING */
       *p = ctx->GLThread.CurrentDrawFramebuffer;
       return;
+   case GL_READ_FRAMEBUFFER_BINDING:
+      *p = ctx->GLThread.CurrentReadFramebuffer;
+      return;
+   case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+      *p = ctx->GLThread.CurrentVAO->CurrentElementBufferName;
+      return;
+   case GL_VERTEX_ARRAY_BINDING:
+      *p = ctx->GLThread.CurrentVAO->Name;
+      return;
+   case GL_LIST_BASE:
+      if (ctx->API != API_OPENGL_COMPAT)
+         break;
+      *p = ctx->GLThread.ListBase;
+      return;
+   case GL_PRIMITIVE_RESTART_INDEX:
+      if (!_mesa_is_desktop_gl(ctx))
+         break;
+      *p = ctx->GLThread.RestartIndex;
+      return;
+   case GL_VIEWPORT:
+      if (!ctx->GLThread.ViewportKnown)
+         break;
+      memcpy(p, ctx->GLThread.Viewport, sizeof(ctx->GLThread.Viewport));
+      return;
    case GL_PIXEL_PACK_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentPixelPackBufferName;
       return;
@@ -122,6 +146,13 @@ _mesa_marshal_GetIntegerv(GLenum pname, GLint *p)
    case GL_POINT_SIZE_ARRAY_OES:
       *p = (ctx->GLThread.CurrentVAO->UserEnabled & (1 << VERT_ATTRIB_POINT_SIZE)) != 0;
       return;
+
+#define GLTHREAD_ENABLE(cap, attrib_mask, default_value) \
+   case cap:
+#include "glthread_enables.h"
+#undef GLTHREAD_ENABLE
+      *p = _mesa_glthread_IsEnabled(ctx, pname);
+      return;
    }
 
    _mesa_glthread_finish_before(ctx, "GetIntegerv");
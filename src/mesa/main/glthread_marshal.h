@@ -61,7 +61,8 @@ _mesa_glthread_allocate_command(struct gl_context *ctx,
 
    assert (num_elements <= MARSHAL_MAX_CMD_SIZE / 8);
 
-   if (unlikely(glthread->used + num_elements > MARSHAL_MAX_CMD_SIZE / 8))
+   /* A command larger than batch_limit still gets a batch on its own. */
+   if (unlikely(glthread->used + num_elements > glthread->batch_limit))
       _mesa_glthread_flush_batch(ctx);
 
    struct glthread_batch *next = glthread->next_batch;
@@ -438,6 +439,48 @@ _mesa_get_matrix_index(struct gl_context *ctx, GLenum mode)
    return M_DUMMY;
 }
 
+/* Return the GLTHREAD_ENABLE_INDEX_* of a cap or -1 if it's not shadowed. */
+static inline int
+_mesa_glthread_enable_index(GLenum cap)
+{
+   switch (cap) {
+#define GLTHREAD_ENABLE(cap, attrib_mask, default_value) \
+   case cap: return GLTHREAD_ENABLE_INDEX_##cap;
+#include "glthread_enables.h"
+#undef GLTHREAD_ENABLE
+   default:
+      return -1;
+   }
+}
+
+/* Return the glPushAttrib groups that save the given enable. */
+static inline GLbitfield
+_mesa_glthread_enable_attrib_mask(unsigned index)
+{
+   static const GLbitfield masks[GLTHREAD_NUM_ENABLES] = {
+#define GLTHREAD_ENABLE(cap, attrib_mask, default_value) \
+   [GLTHREAD_ENABLE_INDEX_##cap] = (attrib_mask) | GL_ENABLE_BIT,
+#include "glthread_enables.h"
+#undef GLTHREAD_ENABLE
+   };
+
+   return masks[index];
+}
+
+static inline void
+_mesa_glthread_set_enable(struct gl_context *ctx, GLenum cap, bool value)
+{
+   int index = _mesa_glthread_enable_index(cap);
+
+   if (index < 0)
+      return;
+
+   if (value)
+      ctx->GLThread.Enabled |= BITFIELD_BIT(index);
+   else
+      ctx->GLThread.Enabled &= ~BITFIELD_BIT(index);
+}
+
 static inline void
 _mesa_glthread_Enable(struct gl_context *ctx, GLenum cap)
 {
@@ -452,8 +495,8 @@ _mesa_glthread_Enable(struct gl_context *ctx, GLenum cap)
    case GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB:
       _mesa_glthread_destroy(ctx, "Enable(DEBUG_OUTPUT_SYNCHRONOUS)");
       break;
-   case GL_CULL_FACE:
-      ctx->GLThread.CullFace = true;
+   default:
+      _mesa_glthread_set_enable(ctx, cap, true);
       break;
    }
 }
@@ -469,18 +512,44 @@ _mesa_glthread_Disable(struct gl_context *ctx, GLenum cap)
    case GL_PRIMITIVE_RESTART_FIXED_INDEX:
       _mesa_glthread_set_prim_restart(ctx, cap, false);
       break;
-   case GL_CULL_FACE:
-      ctx->GLThread.CullFace = false;
+   default:
+      _mesa_glthread_set_enable(ctx, cap, false);
       break;
    }
 }
 
+/* Only index 0 of the indexed enables is shadowed. That's what the
+ * non-indexed queries return.
+ */
+static inline void
+_mesa_glthread_Enablei(struct gl_context *ctx, GLenum cap, GLuint index)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   if (index == 0 && (cap == GL_BLEND || cap == GL_SCISSOR_TEST))
+      _mesa_glthread_set_enable(ctx, cap, true);
+}
+
+static inline void
+_mesa_glthread_Disablei(struct gl_context *ctx, GLenum cap, GLuint index)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   if (index == 0 && (cap == GL_BLEND || cap == GL_SCISSOR_TEST))
+      _mesa_glthread_set_enable(ctx, cap, false);
+}
+
 static inline int
 _mesa_glthread_IsEnabled(struct gl_context *ctx, GLenum cap)
 {
+   int index = _mesa_glthread_enable_index(cap);
+
+   if (index >= 0)
+      return !!(ctx->GLThread.Enabled & BITFIELD_BIT(index));
+
    switch (cap) {
-   case GL_CULL_FACE:
-      return ctx->GLThread.CullFace;
    case GL_VERTEX_ARRAY:
       return !!(ctx->GLThread.CurrentVAO->UserEnabled & VERT_BIT_POS);
    case GL_NORMAL_ARRAY:
@@ -511,6 +580,16 @@ _mesa_glthread_PushAttrib(struct gl_context *ctx, GLbitfield mask)
 
    if (mask & GL_TRANSFORM_BIT)
       attr->MatrixMode = ctx->GLThread.MatrixMode;
+
+   attr->Enabled = ctx->GLThread.Enabled;
+
+   if (mask & GL_LIST_BIT)
+      attr->ListBase = ctx->GLThread.ListBase;
+
+   if (mask & GL_VIEWPORT_BIT) {
+      attr->ViewportKnown = ctx->GLThread.ViewportKnown;
+      memcpy(attr->Viewport, ctx->GLThread.Viewport, sizeof(attr->Viewport));
+   }
 }
 
 static inline void
@@ -530,6 +609,82 @@ _mesa_glthread_PopAttrib(struct gl_context *ctx)
       ctx->GLThread.MatrixMode = attr->MatrixMode;
       ctx->GLThread.MatrixIndex = _mesa_get_matrix_index(ctx, attr->MatrixMode);
    }
+
+   for (unsigned i = 0; i < GLTHREAD_NUM_ENABLES; i++) {
+      if (mask & _mesa_glthread_enable_attrib_mask(i)) {
+         ctx->GLThread.Enabled &= ~BITFIELD_BIT(i);
+         ctx->GLThread.Enabled |= attr->Enabled & BITFIELD_BIT(i);
+      }
+   }
+
+   if (mask & GL_LIST_BIT)
+      ctx->GLThread.ListBase = attr->ListBase;
+
+   if (mask & GL_VIEWPORT_BIT) {
+      ctx->GLThread.ViewportKnown = attr->ViewportKnown;
+      memcpy(ctx->GLThread.Viewport, attr->Viewport, sizeof(attr->Viewport));
+   }
+}
+
+static inline void
+_mesa_glthread_Viewport(struct gl_context *ctx, GLint x, GLint y,
+                        GLsizei width, GLsizei height)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   /* This is an error and doesn't change the viewport. */
+   if (width < 0 || height < 0)
+      return;
+
+   /* Clamping of x and y depends on the viewport bounds, which only
+    * ARB_viewport_array and OES_viewport_array define. Only shadow the values
+    * that don't need it.
+    */
+   if (ctx->Const.ViewportBounds.Min < ctx->Const.ViewportBounds.Max &&
+       (x < ctx->Const.ViewportBounds.Min || x > ctx->Const.ViewportBounds.Max ||
+        y < ctx->Const.ViewportBounds.Min || y > ctx->Const.ViewportBounds.Max)) {
+      ctx->GLThread.ViewportKnown = false;
+      return;
+   }
+
+   ctx->GLThread.ViewportKnown = true;
+   ctx->GLThread.Viewport[0] = x;
+   ctx->GLThread.Viewport[1] = y;
+   ctx->GLThread.Viewport[2] = MIN2(width, (GLsizei)ctx->Const.MaxViewportWidth);
+   ctx->GLThread.Viewport[3] = MIN2(height, (GLsizei)ctx->Const.MaxViewportHeight);
+}
+
+/* Called by glViewportArrayv and glViewportIndexed*, which set viewport 0
+ * with float values if the first index is 0. Stop answering GL_VIEWPORT
+ * queries until the next glViewport then.
+ */
+static inline void
+_mesa_glthread_ViewportArray(struct gl_context *ctx, GLuint first)
+{
+   if (ctx->GLThread.ListMode == GL_COMPILE)
+      return;
+
+   if (first == 0)
+      ctx->GLThread.ViewportKnown = false;
+}
+
+static inline void
+_mesa_glthread_BindFramebuffer(struct gl_context *ctx, GLenum target,
+                               GLuint id)
+{
+   switch (target) {
+   case GL_FRAMEBUFFER:
+      ctx->GLThread.CurrentDrawFramebuffer = id;
+      ctx->GLThread.CurrentReadFramebuffer = id;
+      break;
+   case GL_DRAW_FRAMEBUFFER:
+      ctx->GLThread.CurrentDrawFramebuffer = id;
+      break;
+   case GL_READ_FRAMEBUFFER:
+      ctx->GLThread.CurrentReadFramebuffer = id;
+      break;
+   }
 }
 
 static inline void
@@ -139,6 +139,12 @@ _mesa_MaxShaderCompilerThreadsKHR(GLuint count)
 
    ctx->Hint.MaxShaderCompilerThreads = count;
 
+   /* 0 makes glCompileShader synchronous, but keep a thread for the
+    * compiles that are already queued.
+    */
+   if (ctx->ShaderCompileQueueInited)
+      util_queue_adjust_num_threads(&ctx->ShaderCompileQueue, count);
+
    struct pipe_screen *screen = ctx->screen;
    if (screen->set_max_shader_compiler_threads)
       screen->set_max_shader_compiler_threads(screen, count);
@@ -1675,6 +1675,20 @@ struct gl_vertex_array_object
    bool NewVertexBuffers;
    bool NewVertexElements;
 
+   /**
+    * Vertex elements of the enabled arrays translated by st/mesa for the
+    * vertex shader inputs below. Rebinding the VAO with the same inputs
+    * reuses them. It's invalidated when NewVertexElements is consumed.
+    * Shared VAOs don't use it.
+    */
+   struct {
+      bool Valid;
+      GLbitfield InputsRead;
+      GLbitfield DualSlotInputs;
+      GLbitfield EnabledAttribs;
+      struct pipe_vertex_element Elements[PIPE_MAX_ATTRIBS];
+   } _VertexElementsCache;
+
    /** The index buffer (also known as the element array buffer in OpenGL). */
    struct gl_buffer_object *IndexBufferObj;
 };
@@ -3629,6 +3643,13 @@ struct gl_context
    /*@}*/
 
    bool shader_builtin_ref;
+
+   /**
+    * Threads running glCompileShader, created on first use.  See
+    * GL_KHR_parallel_shader_compile.
+    */
+   struct util_queue ShaderCompileQueue;
+   bool ShaderCompileQueueInited;
 };
 
 #ifndef NDEBUG
@@ -35,6 +35,7 @@
 #include "main/glheader.h"
 #include "main/menums.h"
 #include "util/mesa-sha1.h"
+#include "util/u_queue.h"
 #include "compiler/shader_info.h"
 #include "compiler/glsl/list.h"
 #include "compiler/glsl/ir_uniform.h"
@@ -154,6 +155,13 @@ struct gl_shader
 
    enum gl_compile_status CompileStatus;
 
+   /**
+    * Signalled when a glCompileShader that runs on the context's compile
+    * queue has finished.  Everything below but Source may only be accessed
+    * after waiting for it, see _mesa_wait_shader_compile().
+    */
+   struct util_queue_fence CompileFence;
+
    /** SHA1 of the pre-processed source used by the disk cache. */
    uint8_t disk_cache_sha1[SHA1_DIGEST_LENGTH];
    /** SHA1 of the original source before replacement, set by glShaderSource. */
@@ -570,10 +578,14 @@ struct gl_program
 
    void *serialized_nir;
    unsigned serialized_nir_size;
+   /** SHA1 of serialized_nir, the base of the shader variant prehashes */
+   uint8_t serialized_nir_sha1[SHA1_DIGEST_LENGTH];
 
    struct gl_shader_program *shader_program;
 
    struct st_variant *variants;
+   /** The variant st_get_*_variant returned last, checked before the list */
+   struct st_variant *last_variant;
 
    union {
       /** Fields used by GLSL programs */
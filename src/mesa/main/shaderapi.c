@@ -38,6 +38,7 @@
 
 #include "main/glheader.h"
 #include "main/context.h"
+#include "main/debug_output.h"
 #include "draw_validate.h"
 #include "main/enums.h"
 #include "main/glspirv.h"
@@ -63,6 +64,7 @@
 #include "util/crc32.h"
 #include "util/os_file.h"
 #include "util/list.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_process.h"
 #include "util/u_string.h"
 #include "api_exec_decl.h"
@@ -230,6 +232,12 @@ _mesa_init_shader_state(struct gl_context *ctx)
 void
 _mesa_free_shader_state(struct gl_context *ctx)
 {
+   /* Queued compiles use the context. */
+   if (ctx->ShaderCompileQueueInited) {
+      util_queue_destroy(&ctx->ShaderCompileQueue);
+      ctx->ShaderCompileQueueInited = false;
+   }
+
    for (int i = 0; i < MESA_SHADER_STAGES; i++) {
       _mesa_reference_program(ctx, &ctx->Shader.CurrentProgram[i], NULL);
       _mesa_reference_shader_program(ctx,
@@ -1039,6 +1047,13 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       return;
    }
 
+   if (pname == GL_COMPLETION_STATUS_ARB) {
+      *params = util_queue_fence_is_signalled(&shader->CompileFence);
+      return;
+   }
+
+   _mesa_wait_shader_compile(shader);
+
    switch (pname) {
    case GL_SHADER_TYPE:
       *params = shader->Type;
@@ -1046,10 +1061,6 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
    case GL_DELETE_STATUS:
       *params = shader->DeletePending;
       break;
-   case GL_COMPLETION_STATUS_ARB:
-      /* _mesa_glsl_compile_shader is not offloaded to other threads. */
-      *params = GL_TRUE;
-      return;
    case GL_COMPILE_STATUS:
       *params = shader->CompileStatus ? GL_TRUE : GL_FALSE;
       break;
@@ -1119,6 +1130,7 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   _mesa_wait_shader_compile(sh);
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -1155,6 +1167,9 @@ set_shader_source(struct gl_shader *sh, const GLchar *source,
 {
    assert(sh);
 
+   /* A queued compile may still be reading the old source. */
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec adds the following to the end of the description
     * of ShaderSource:
     *
@@ -1190,6 +1205,55 @@ ensure_builtin_types(struct gl_context *ctx)
    }
 }
 
+#define MAX_SHADER_COMPILER_THREADS 8
+
+static void
+compile_shader_job(void *job, void *gdata, int thread_index)
+{
+   struct gl_context *ctx = gdata;
+   struct gl_shader *sh = job;
+
+   _mesa_glsl_compile_shader(ctx, sh, false, false, false);
+}
+
+/**
+ * Whether glCompileShader may return before \p sh is compiled.
+ *
+ * Shaders with #include read the current include paths, which are only
+ * set for the duration of glCompileShaderIncludeARB, and the debug flags
+ * want their output next to the compile.  Synchronous debug output must
+ * be delivered on the application's thread.
+ */
+static bool
+can_compile_shader_async(struct gl_context *ctx, struct gl_shader *sh)
+{
+   if (!ctx->Hint.MaxShaderCompilerThreads || ctx->_Shader->Flags)
+      return false;
+
+   if (strstr(sh->Source, "#include"))
+      return false;
+
+   if (ctx->Debug &&
+       _mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB))
+      return false;
+
+   if (!ctx->ShaderCompileQueueInited) {
+      unsigned num_threads = MIN2(util_get_cpu_caps()->nr_cpus,
+                                  MAX_SHADER_COMPILER_THREADS);
+
+      if (num_threads < 2 ||
+          !util_queue_init(&ctx->ShaderCompileQueue, "glsl", 64, num_threads,
+                           UTIL_QUEUE_INIT_RESIZE_IF_FULL, ctx))
+         return false;
+
+      ctx->ShaderCompileQueueInited = true;
+      util_queue_adjust_num_threads(&ctx->ShaderCompileQueue,
+                                    ctx->Hint.MaxShaderCompilerThreads);
+   }
+
+   return true;
+}
+
 /**
  * Compile a shader.
  */
@@ -1199,6 +1263,8 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
    if (!sh)
       return;
 
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec says:
     *
     *    "Add a new error for the CompileShader command:
@@ -1225,6 +1291,15 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
 
       ensure_builtin_types(ctx);
 
+      /* The result is only looked at after waiting for CompileFence, and
+       * none of the logging below is enabled.
+       */
+      if (can_compile_shader_async(ctx, sh)) {
+         util_queue_add_job(&ctx->ShaderCompileQueue, sh, &sh->CompileFence,
+                            compile_shader_job, NULL, 0);
+         return;
+      }
+
       /* this call will set the shader->CompileStatus field to indicate if
        * compilation was successful.
        */
@@ -1327,6 +1402,10 @@ link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
 
    ensure_builtin_types(ctx);
 
+   /* Linking itself stays on this thread, it uses the pipe context. */
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader_compile(shProg->Shaders[i]);
+
    FLUSH_VERTICES(ctx, 0, 0);
    _mesa_glsl_link_shader(ctx, shProg);
 
@@ -2390,6 +2469,9 @@ _mesa_ShaderBinary(GLint n, const GLuint* shaders, GLenum binaryformat,
          return;
    }
 
+   for (int i = 0; i < n; ++i)
+      _mesa_wait_shader_compile(sh[i]);
+
    if (binaryformat == GL_SHADER_BINARY_FORMAT_SPIR_V_ARB) {
       if (!ctx->Extensions.ARB_gl_spirv) {
          _mesa_error(ctx, GL_INVALID_OPERATION, "glShaderBinary(SPIR-V)");
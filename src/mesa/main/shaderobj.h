@@ -86,6 +86,9 @@ _mesa_reference_shader_program(struct gl_context *ctx,
 extern struct gl_shader *
 _mesa_new_shader(GLuint name, gl_shader_stage type);
 
+extern void
+_mesa_wait_shader_compile(struct gl_shader *sh);
+
 extern void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh);
 
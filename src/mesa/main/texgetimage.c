@@ -511,7 +511,7 @@ get_tex_rgba_uncompressed(struct gl_context *ctx, GLuint dimensions,
                rgba = malloc(height * rgba_stride);
                if (!rgba) {
                   _mesa_error(ctx, GL_OUT_OF_MEMORY, "glGetTexImage()");
-                  st_UnmapTextureImage(ctx, texImage, img);
+                  st_UnmapTextureImage(ctx, texImage, zoffset + img);
                   return;
                }
             }
@@ -654,6 +654,23 @@ update_texgen(struct gl_context *ctx)
    }
 }
 
+/**
+ * Set the _Current texture of a unit, flagging _NEW_TEXTURE_OBJECT only if
+ * it actually changed, so that revalidating the same bindings doesn't make
+ * the driver rebind all sampler views.
+ */
+static inline void
+set_current_texture(struct gl_context *ctx, unsigned unit,
+                    struct gl_texture_object *texObj)
+{
+   struct gl_texture_unit *texUnit = &ctx->Texture.Unit[unit];
+
+   if (texUnit->_Current != texObj) {
+      _mesa_reference_texobj(&texUnit->_Current, texObj);
+      ctx->NewState |= _NEW_TEXTURE_OBJECT;
+   }
+}
+
 static struct gl_texture_object *
 update_single_program_texture(struct gl_context *ctx, struct gl_program *prog,
                               int unit)
@@ -720,7 +737,7 @@ update_single_program_texture_state(struct gl_context *ctx,
 
    texObj = update_single_program_texture(ctx, prog, unit);
 
-   _mesa_reference_texobj(&ctx->Texture.Unit[unit]._Current, texObj);
+   set_current_texture(ctx, unit, texObj);
    BITSET_SET(enabled_texture_units, unit);
    ctx->Texture._MaxEnabledTexImageUnit =
       MAX2(ctx->Texture._MaxEnabledTexImageUnit, (int)unit);
@@ -836,7 +853,7 @@ update_ff_texture_state(struct gl_context *ctx,
          }
          if (_mesa_is_texture_complete(texObj, sampler,
                                        ctx->Const.ForceIntegerTexNearest)) {
-            _mesa_reference_texobj(&texUnit->_Current, texObj);
+            set_current_texture(ctx, unit, texObj);
             complete = true;
             break;
          }
@@ -871,7 +888,7 @@ fix_missing_textures_for_atifs(struct gl_context *ctx,
       if (!ctx->Texture.Unit[unit]._Current) {
          struct gl_texture_object *texObj =
             _mesa_get_fallback_texture(ctx, target_index);
-         _mesa_reference_texobj(&ctx->Texture.Unit[unit]._Current, texObj);
+         set_current_texture(ctx, unit, texObj);
          BITSET_SET(enabled_texture_units, unit);
          ctx->Texture._MaxEnabledTexImageUnit =
             MAX2(ctx->Texture._MaxEnabledTexImageUnit, (int)unit);
@@ -903,8 +920,10 @@ _mesa_update_texture_state(struct gl_context *ctx)
       prog[MESA_SHADER_FRAGMENT] = ctx->FragmentProgram.Current;
    }
 
-   /* TODO: only set this if there are actual changes */
-   ctx->NewState |= _NEW_TEXTURE_OBJECT | _NEW_TEXTURE_STATE;
+   /* _NEW_TEXTURE_OBJECT is only added by set_current_texture() when a
+    * unit's _Current changes.
+    */
+   ctx->NewState |= _NEW_TEXTURE_STATE;
 
    GLbitfield old_genflags = ctx->Texture._GenFlags;
    GLbitfield old_enabled_coord_units = ctx->Texture._EnabledCoordUnits;
@@ -934,10 +953,10 @@ _mesa_update_texture_state(struct gl_context *ctx)
    /* Now, clear out the _Current of any disabled texture units. */
    for (i = 0; i <= ctx->Texture._MaxEnabledTexImageUnit; i++) {
       if (!BITSET_TEST(enabled_texture_units, i))
-         _mesa_reference_texobj(&ctx->Texture.Unit[i]._Current, NULL);
+         set_current_texture(ctx, i, NULL);
    }
    for (i = ctx->Texture._MaxEnabledTexImageUnit + 1; i <= old_max_unit; i++) {
-      _mesa_reference_texobj(&ctx->Texture.Unit[i]._Current, NULL);
+      set_current_texture(ctx, i, NULL);
    }
 
    /* add fallback texture for SampleMapATI if there is nothing */
@@ -311,19 +311,58 @@ st_update_array_templ(struct st_context *st)
    struct cso_velems_state velements;
    bool uses_user_vertex_buffers;
 
+   struct gl_vertex_array_object *vao = ctx->Array._DrawVAO;
+   const GLbitfield inputs_read = vp_variant->vert_attrib_mask;
+   const GLbitfield dual_slot_inputs = vp->Base.DualSlotInputs;
+   const GLbitfield enabled_attribs = _mesa_draw_array_bits(ctx);
+   const unsigned num_elements = util_bitcount_fast<POPCNT>(inputs_read);
+
+   /* The vertex elements of the arrays only depend on the VAO and these
+    * masks, so reuse them if the VAO was translated for the same inputs
+    * before. They are interleaved with the current attribs, which are
+    * always translated below.
+    */
+   const bool use_cache = UPDATE == UPDATE_ALL && !vao->SharedAndImmutable;
+   const bool cached = use_cache && vao->_VertexElementsCache.Valid &&
+      vao->_VertexElementsCache.InputsRead == inputs_read &&
+      vao->_VertexElementsCache.DualSlotInputs == dual_slot_inputs &&
+      vao->_VertexElementsCache.EnabledAttribs == enabled_attribs;
+
    /* ST_NEW_VERTEX_ARRAYS */
    /* Setup arrays */
-   setup_arrays<POPCNT, UPDATE>
-      (st, ctx->Array._DrawVAO, vp->Base.DualSlotInputs,
-       vp_variant->vert_attrib_mask, _mesa_draw_nonzero_divisor_bits(ctx),
-       _mesa_draw_array_bits(ctx), _mesa_draw_user_array_bits(ctx),
-       &velements, vbuffer, &num_vbuffers, &uses_user_vertex_buffers);
+   if (cached) {
+      memcpy(velements.velems, vao->_VertexElementsCache.Elements,
+             num_elements * sizeof(velements.velems[0]));
+      setup_arrays<POPCNT, UPDATE_BUFFERS_ONLY>
+         (st, vao, dual_slot_inputs, inputs_read,
+          _mesa_draw_nonzero_divisor_bits(ctx), enabled_attribs,
+          _mesa_draw_user_array_bits(ctx),
+          &velements, vbuffer, &num_vbuffers, &uses_user_vertex_buffers);
+   } else {
+      setup_arrays<POPCNT, UPDATE>
+         (st, vao, dual_slot_inputs, inputs_read,
+          _mesa_draw_nonzero_divisor_bits(ctx), enabled_attribs,
+          _mesa_draw_user_array_bits(ctx),
+          &velements, vbuffer, &num_vbuffers, &uses_user_vertex_buffers);
+   }
 
    /* _NEW_CURRENT_ATTRIB */
    /* Setup zero-stride attribs. */
    st_setup_current<POPCNT, UPDATE>(st, vp, vp_variant, &velements, vbuffer,
                                     &num_vbuffers);
 
+   /* Store the elements after the current attribs have been set up, so that
+    * all of them are initialized. The current ones are overwritten on reuse.
+    */
+   if (use_cache && !cached) {
+      memcpy(vao->_VertexElementsCache.Elements, velements.velems,
+             num_elements * sizeof(velements.velems[0]));
+      vao->_VertexElementsCache.InputsRead = inputs_read;
+      vao->_VertexElementsCache.DualSlotInputs = dual_slot_inputs;
+      vao->_VertexElementsCache.EnabledAttribs = enabled_attribs;
+      vao->_VertexElementsCache.Valid = true;
+   }
+
    unsigned unbind_trailing_vbuffers =
       st->last_num_vbuffers > num_vbuffers ?
          st->last_num_vbuffers - num_vbuffers : 0;
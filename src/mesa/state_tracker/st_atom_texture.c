@@ -268,9 +268,26 @@ update_textures(struct st_context *st,
    unsigned num_unbind = old_num_textures > num_textures ?
                             old_num_textures - num_textures : 0;
 
+   /* Re-validating the same bindings is common (e.g. an unrelated texture
+    * parameter changed), so don't make the driver rebind identical views.
+    * Only the references st_get_sampler_views() took need to be dropped.
+    */
+   if (st->state.sampler_views_valid & BITFIELD_BIT(shader_stage) &&
+       num_textures == old_num_textures &&
+       !memcmp(sampler_views, st->state.sampler_views[shader_stage],
+               num_textures * sizeof(sampler_views[0]))) {
+      for (unsigned i = 0; i < num_textures; i++)
+         pipe_sampler_view_reference(&sampler_views[i], NULL);
+      return;
+   }
+
    pipe->set_sampler_views(pipe, shader_stage, 0, num_textures, num_unbind,
                            true, sampler_views);
    st->state.num_sampler_views[shader_stage] = num_textures;
+
+   memcpy(st->state.sampler_views[shader_stage], sampler_views,
+          num_textures * sizeof(sampler_views[0]));
+   st->state.sampler_views_valid |= BITFIELD_BIT(shader_stage);
 }
 
 void
@@ -75,6 +75,7 @@
 #include "util/u_sampler.h"
 #include "util/u_math.h"
 #include "util/u_box.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_memory.h"
 #include "util/u_simple_shaders.h"
 #include "cso_cache/cso_context.h"
@@ -532,6 +533,108 @@ st_MapTextureImage(struct gl_context *ctx,
 }
 
 
+/* Maximum number of threads, including the calling one, and minimum
+ * number of pixel rows per thread for decompressing fallback uploads.
+ */
+#define ST_MAX_DECOMPRESS_THREADS 8
+#define ST_DECOMPRESS_MIN_JOB_ROWS 64
+
+struct st_decompress_job {
+   struct util_queue_fence fence;
+   mesa_format format;
+   bool bgra;
+   uint8_t *dst;
+   unsigned dst_stride;
+   const uint8_t *src;
+   unsigned src_stride;
+   unsigned width, height;
+};
+
+static void
+decompress_rows(const struct st_decompress_job *job)
+{
+   if (job->format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(job->dst, job->dst_stride,
+                                 job->src, job->src_stride,
+                                 job->width, job->height);
+   } else if (_mesa_is_format_etc2(job->format)) {
+      _mesa_unpack_etc2_format(job->dst, job->dst_stride,
+                               job->src, job->src_stride,
+                               job->width, job->height,
+                               job->format, job->bgra);
+   } else if (_mesa_is_format_astc_2d(job->format)) {
+      _mesa_unpack_astc_2d_ldr(job->dst, job->dst_stride,
+                               job->src, job->src_stride,
+                               job->width, job->height,
+                               job->format);
+   } else {
+      unreachable("unexpected format for a compressed format fallback");
+   }
+}
+
+static void
+decompress_job_execute(void *data, void *gdata, int thread_index)
+{
+   decompress_rows((struct st_decompress_job *)data);
+}
+
+/**
+ * Decompress an ETC or ASTC image into RGBA8.  Large images are split into
+ * horizontal bands of whole block rows that are decoded in parallel, with
+ * the calling thread decoding the first band.
+ */
+static void
+decompress_fallback_image(struct st_context *st, mesa_format format,
+                          bool bgra, uint8_t *dst, unsigned dst_stride,
+                          const uint8_t *src, unsigned src_stride,
+                          unsigned width, unsigned height)
+{
+   unsigned bw, bh;
+   _mesa_get_format_block_size(format, &bw, &bh);
+
+   const unsigned max_jobs = MIN2(util_get_cpu_caps()->nr_cpus,
+                                  ST_MAX_DECOMPRESS_THREADS);
+   unsigned num_jobs = MIN2(max_jobs, height / ST_DECOMPRESS_MIN_JOB_ROWS);
+
+   if (num_jobs > 1 && !st->num_decompress_threads) {
+      if (util_queue_init(&st->decompress_queue, "st_decomp",
+                          ST_MAX_DECOMPRESS_THREADS, max_jobs - 1, 0, NULL))
+         st->num_decompress_threads = max_jobs - 1;
+   }
+   num_jobs = MIN2(num_jobs, st->num_decompress_threads + 1);
+
+   const unsigned slice = align(DIV_ROUND_UP(height, MAX2(num_jobs, 1)), bh);
+   struct st_decompress_job jobs[ST_MAX_DECOMPRESS_THREADS];
+   unsigned num_queued = 0;
+
+   for (unsigned y = 0; y < height; y += slice) {
+      struct st_decompress_job *job = &jobs[num_queued++];
+
+      job->format = format;
+      job->bgra = bgra;
+      job->dst = dst + y * dst_stride;
+      job->dst_stride = dst_stride;
+      job->src = src + (y / bh) * src_stride;
+      job->src_stride = src_stride;
+      job->width = width;
+      job->height = MIN2(slice, height - y);
+
+      if (y) {
+         util_queue_fence_init(&job->fence);
+         util_queue_add_job(&st->decompress_queue, job, &job->fence,
+                            decompress_job_execute, NULL, 0);
+      }
+   }
+
+   decompress_rows(&jobs[0]);
+
+   for (unsigned i = 1; i < num_queued; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
+
+
 void
 st_UnmapTextureImage(struct gl_context *ctx,
                      struct gl_texture_image *texImage,
@@ -558,32 +661,12 @@ st_UnmapTextureImage(struct gl_context *ctx,
             void *tmp = malloc(size);
 
             /* Decompress to tmp. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(tmp, transfer->box.width * 4,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(tmp, transfer->box.width * 4,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width,
-                                        transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-               _mesa_unpack_astc_2d_ldr(tmp, transfer->box.width * 4,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width,
-                                        transfer->box.height,
-                                        texImage->TexFormat);
-            } else {
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            decompress_fallback_image(st, texImage->TexFormat, false,
+                                      tmp, transfer->box.width * 4,
+                                      itransfer->temp_data,
+                                      itransfer->temp_stride,
+                                      transfer->box.width,
+                                      transfer->box.height);
 
             /* Compress it to the target format. */
             struct gl_pixelstore_attrib pack = {0};
@@ -597,30 +680,14 @@ st_UnmapTextureImage(struct gl_context *ctx,
             free(tmp);
          } else {
             /* Decompress into an uncompressed format. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(itransfer->map, transfer->stride,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-               _mesa_unpack_astc_2d_ldr(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat);
-            } else {
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            bool bgra = texImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
+
+            decompress_fallback_image(st, texImage->TexFormat, bgra,
+                                      itransfer->map, transfer->stride,
+                                      itransfer->temp_data,
+                                      itransfer->temp_stride,
+                                      transfer->box.width,
+                                      transfer->box.height);
          }
       }
 
@@ -1573,6 +1640,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
 
    ctx->Array.NewVertexElements = true;
    st->dirty |= ST_NEW_VERTEX_ARRAYS |
@@ -1863,6 +1931,7 @@ fail:
     */
    cso_restore_state(cso, CSO_UNBIND_FS_SAMPLERVIEWS | CSO_UNBIND_FS_IMAGE0);
    st->state.num_sampler_views[PIPE_SHADER_FRAGMENT] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_FRAGMENT);
 
    st->ctx->Array.NewVertexElements = true;
    st->dirty |= ST_NEW_FS_CONSTANTS |
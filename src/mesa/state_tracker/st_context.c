@@ -59,6 +59,7 @@
 #include "st_texture.h"
 #include "st_util.h"
 #include "pipe/p_context.h"
+#include "util/u_atomic.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_inlines.h"
 #include "util/u_upload_mgr.h"
@@ -387,6 +388,9 @@ st_destroy_context_priv(struct st_context *st, bool destroy_pipe)
    st_invalidate_readpix_cache(st);
    util_throttle_deinit(st->screen, &st->throttle);
 
+   if (util_queue_is_initialized(&st->decompress_queue))
+      util_queue_destroy(&st->decompress_queue);
+
    cso_destroy_context(st->cso_context);
 
    if (st->pipe && destroy_pipe)
@@ -476,11 +480,13 @@ static struct st_context *
 st_create_context_priv(struct gl_context *ctx, struct pipe_context *pipe,
                        const struct st_config_options *options)
 {
+   static uint32_t next_variant_prehash_id;
    struct pipe_screen *screen = pipe->screen;
    uint i;
    struct st_context *st = CALLOC_STRUCT( st_context);
 
    st->options = *options;
+   st->variant_prehash_id = p_atomic_inc_return(&next_variant_prehash_id);
 
    ctx->st_opts = &st->options;
    ctx->st = st;
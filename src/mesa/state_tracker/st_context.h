@@ -36,6 +36,7 @@
 #include "util/u_helpers.h"
 #include "util/u_inlines.h"
 #include "util/list.h"
+#include "util/u_queue.h"
 #include "vbo/vbo.h"
 #include "util/list.h"
 #include "cso_cache/cso_context.h"
@@ -175,6 +176,12 @@ struct st_context
     */
    boolean allow_st_finalize_nir_twice;
 
+   /**
+    * Unique for every context created in the process.  Variants depend on
+    * the context, so this goes into their pipe_shader_state::nir_prehash.
+    */
+   uint32_t variant_prehash_id;
+
    /**
     * If a shader can be created when we get its source.
     * This means it has only 1 variant, not counting glBitmap and
@@ -206,6 +213,13 @@ struct st_context
       GLuint num_vert_samplers;
       GLuint num_frag_samplers;
       GLuint num_sampler_views[PIPE_SHADER_TYPES];
+      /* The views last bound by update_textures(), without references.
+       * They are only compared against, to skip rebinding the same views.
+       * A stage's bit in sampler_views_valid is cleared when anything else
+       * may have bound views to it behind st_atom_texture.c's back.
+       */
+      struct pipe_sampler_view *sampler_views[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
+      unsigned sampler_views_valid;
       unsigned num_images[PIPE_SHADER_TYPES];
       struct pipe_clip_state clip;
       unsigned constbuf0_enabled_shader_mask;
@@ -374,6 +388,12 @@ struct st_context
     */
    struct util_throttle throttle;
 
+   /* Helper threads that decompress ETC/ASTC uploads in parallel when the
+    * driver doesn't support the format.  Created on first use.
+    */
+   struct util_queue decompress_queue;
+   unsigned num_decompress_threads;
+
    struct {
       struct st_zombie_sampler_view_node list;
       simple_mtx_t mutex;
@@ -588,39 +588,7 @@ st_nir_vectorize_io(nir_shader *producer, nir_shader *consumer)
 static void
 st_nir_link_shaders(nir_shader *producer, nir_shader *consumer)
 {
-   if (producer->options->lower_to_scalar) {
-      NIR_PASS_V(producer, nir_lower_io_to_scalar_early, nir_var_shader_out);
-      NIR_PASS_V(consumer, nir_lower_io_to_scalar_early, nir_var_shader_in);
-   }
-
-   nir_lower_io_arrays_to_elements(producer, consumer);
-
-   gl_nir_opts(producer);
-   gl_nir_opts(consumer);
-
-   if (nir_link_opt_varyings(producer, consumer))
-      gl_nir_opts(consumer);
-
-   NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out, NULL);
-   NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in, NULL);
-
-   if (nir_remove_unused_varyings(producer, consumer)) {
-      NIR_PASS_V(producer, nir_lower_global_vars_to_local);
-      NIR_PASS_V(consumer, nir_lower_global_vars_to_local);
-
-      gl_nir_opts(producer);
-      gl_nir_opts(consumer);
-
-      /* Optimizations can cause varyings to become unused.
-       * nir_compact_varyings() depends on all dead varyings being removed so
-       * we need to call nir_remove_dead_variables() again here.
-       */
-      NIR_PASS_V(producer, nir_remove_dead_variables, nir_var_shader_out,
-                 NULL);
-      NIR_PASS_V(consumer, nir_remove_dead_variables, nir_var_shader_in,
-                 NULL);
-   }
-
+   nir_link_shader_varyings(producer, consumer, gl_nir_opts);
    nir_link_varying_precision(producer, consumer);
 }
 
@@ -689,6 +657,23 @@ st_nir_lower_wpos_ytransform(struct nir_shader *nir,
    }
 }
 
+struct st_glsl_to_nir_state {
+   struct st_context *st;
+   struct gl_shader_program *shader_program;
+};
+
+static void
+st_glsl_to_nir_stage(struct gl_linked_shader *shader, void *data)
+{
+   struct st_glsl_to_nir_state *state = (struct st_glsl_to_nir_state *)data;
+   const nir_shader_compiler_options *options =
+      state->st->ctx->Const.ShaderCompilerOptions[shader->Stage].NirOptions;
+
+   shader->Program->nir = glsl_to_nir(&state->st->ctx->Const,
+                                      state->shader_program, shader->Stage,
+                                      options);
+}
+
 bool
 st_link_nir(struct gl_context *ctx,
             struct gl_shader_program *shader_program)
@@ -730,9 +715,23 @@ st_link_nir(struct gl_context *ctx,
             _mesa_print_ir(_mesa_get_log_file(), shader->ir, NULL);
             _mesa_log("\n\n");
          }
-
-         prog->nir = glsl_to_nir(&st->ctx->Const, shader_program, shader->Stage, options);
       }
+   }
+
+   /* Converting to NIR only reads the program and writes the stage's own
+    * gl_program, so the stages are converted in parallel.
+    */
+   if (!shader_program->data->spirv) {
+      struct st_glsl_to_nir_state state = { st, shader_program };
+      link_util_run_stages_parallel(shader_program, st_glsl_to_nir_stage,
+                                    &state);
+   }
+
+   for (unsigned i = 0; i < num_shaders; i++) {
+      struct gl_linked_shader *shader = linked_shader[i];
+      const nir_shader_compiler_options *options =
+         st->ctx->Const.ShaderCompilerOptions[shader->Stage].NirOptions;
+      struct gl_program *prog = shader->Program;
 
       memcpy(prog->nir->info.source_sha1, shader->linked_source_sha1,
              SHA1_DIGEST_LENGTH);
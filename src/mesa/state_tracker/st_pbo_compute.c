@@ -36,6 +36,7 @@
 #include "compiler/nir/nir_format_convert.h"
 #include "compiler/glsl/gl_nir.h"
 #include "compiler/glsl/gl_nir_linker.h"
+#include "util/u_box.h"
 #include "util/u_sampler.h"
 
 #define BGR_FORMAT(NAME) \
@@ -755,7 +756,8 @@ download_texture_compute(struct st_context *st,
                          enum pipe_texture_target view_target,
                          struct pipe_resource *src,
                          enum pipe_format dst_format,
-                         enum swizzle_clamp swizzle_clamp)
+                         enum swizzle_clamp swizzle_clamp,
+                         enum pipe_resource_usage dst_usage)
 {
    struct pipe_context *pipe = st->pipe;
    struct pipe_screen *screen = st->screen;
@@ -922,7 +924,7 @@ download_texture_compute(struct st_context *st,
    unsigned img_stride = _mesa_image_image_stride(pack, width, height, format, type);
    unsigned buffer_size = (depth + (dim == 3 ? pack->SkipImages : 0)) * img_stride;
    {
-      dst = pipe_buffer_create(screen, PIPE_BIND_SHADER_BUFFER, PIPE_USAGE_STAGING, buffer_size);
+      dst = pipe_buffer_create(screen, PIPE_BIND_SHADER_BUFFER, dst_usage, buffer_size);
       if (!dst)
          goto fail;
 
@@ -956,6 +958,7 @@ fail:
                            st->state.num_sampler_views[PIPE_SHADER_COMPUTE],
                            NULL);
    st->state.num_sampler_views[PIPE_SHADER_COMPUTE] = 0;
+   st->state.sampler_views_valid &= ~BITFIELD_BIT(PIPE_SHADER_COMPUTE);
    pipe->set_shader_buffers(pipe, PIPE_SHADER_COMPUTE, 0, 1, NULL, 0);
 
    st->dirty |= ST_NEW_CS_CONSTANTS |
@@ -1017,6 +1020,38 @@ copy_converted_buffer(struct gl_context * ctx,
    pipe_buffer_unmap(st->pipe, xfer);
 }
 
+/* Whether the converted pixels can be copied into the pack PBO on the GPU,
+ * i.e. the PBO layout is the tightly packed one the shader writes.
+ */
+static bool
+can_copy_converted_buffer_gpu(const struct gl_pixelstore_attrib *pack)
+{
+   return pack->BufferObj &&
+          !pack->RowLength && !pack->SkipPixels && !pack->SkipRows &&
+          !pack->ImageHeight && !pack->SkipImages;
+}
+
+static void
+copy_converted_buffer_gpu(struct gl_context *ctx,
+                          const struct gl_pixelstore_attrib *pack,
+                          struct pipe_resource *dst, void *pixels)
+{
+   struct st_context *st = st_context(ctx);
+   struct pipe_resource *pbo = pack->BufferObj->buffer;
+   unsigned offset = (uintptr_t)pixels;
+
+   if (!pbo || offset >= pbo->width0)
+      return;
+
+   /* The staging buffer is padded to whole rows; the PBO only has to hold
+    * the pixels themselves.
+    */
+   struct pipe_box box;
+   u_box_1d(0, MIN2(dst->width0, pbo->width0 - offset), &box);
+   st->pipe->resource_copy_region(st->pipe, pbo, 0, offset, 0, 0,
+                                  dst, 0, &box);
+}
+
 bool
 st_GetTexSubImage_shader(struct gl_context * ctx,
                          GLint xoffset, GLint yoffset, GLint zoffset,
@@ -1097,12 +1132,22 @@ st_GetTexSubImage_shader(struct gl_context * ctx,
        (!util_format_is_float(src_format) && dst_format == PIPE_FORMAT_L32_FLOAT))
       return false;
 
+   /* Packing into a PBO stays on the GPU, without waiting for the shader. */
+   const bool gpu_copy = can_copy_converted_buffer_gpu(&ctx->Pack);
+
    dst = download_texture_compute(st, &ctx->Pack, xoffset, yoffset, zoffset, width, height, depth,
                                   level, layer, format, type, src_format, view_target, src, dst_format,
-                                  swizzle_clamp);
+                                  swizzle_clamp,
+                                  gpu_copy ? PIPE_USAGE_DEFAULT : PIPE_USAGE_STAGING);
+
+   if (!dst)
+      return false;
 
-   copy_converted_buffer(ctx, &ctx->Pack, view_target, dst, dst_format, xoffset, yoffset, zoffset,
-                       width, height, depth, format, type, pixels);
+   if (gpu_copy)
+      copy_converted_buffer_gpu(ctx, &ctx->Pack, dst, pixels);
+   else
+      copy_converted_buffer(ctx, &ctx->Pack, view_target, dst, dst_format, xoffset, yoffset, zoffset,
+                            width, height, depth, format, type, pixels);
 
    pipe_resource_reference(&dst, NULL);
 
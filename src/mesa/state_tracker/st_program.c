@@ -321,6 +321,7 @@ st_release_variants(struct st_context *st, struct gl_program *p)
    }
 
    p->variants = NULL;
+   p->last_variant = NULL;
 
    if (p->state.tokens) {
       ureg_free_tokens(p->state.tokens);
@@ -624,6 +625,47 @@ get_nir_shader(struct st_context *st, struct gl_program *prog)
    return nir_deserialize(NULL, options, &blob_reader);
 }
 
+/**
+ * Hash everything a shader variant is derived from: the serialized base
+ * NIR, the variant key, and the parameter list that the variant lowering
+ * looks up and appends state references to.  This is a lot cheaper than
+ * serializing the variant, and lets the driver's live shader cache find an
+ * existing CSO without doing that.
+ */
+static void
+st_variant_prehash(struct st_context *st, const struct gl_program *prog,
+                   const struct pipe_stream_output_info *so,
+                   const void *key, size_t key_size,
+                   unsigned char prehash[SHA1_DIGEST_LENGTH])
+{
+   const struct gl_program_parameter_list *params = prog->Parameters;
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &st->variant_prehash_id,
+                     sizeof(st->variant_prehash_id));
+   _mesa_sha1_update(&ctx, prog->serialized_nir_sha1, SHA1_DIGEST_LENGTH);
+   _mesa_sha1_update(&ctx, key, key_size);
+   _mesa_sha1_update(&ctx, so, sizeof(*so));
+
+   _mesa_sha1_update(&ctx, &params->NumParameters,
+                     sizeof(params->NumParameters));
+   for (unsigned i = 0; i < params->NumParameters; i++) {
+      const struct gl_program_parameter *p = &params->Parameters[i];
+      unsigned type = p->Type;
+
+      if (p->Name)
+         _mesa_sha1_update(&ctx, p->Name, strlen(p->Name) + 1);
+      _mesa_sha1_update(&ctx, &type, sizeof(type));
+      _mesa_sha1_update(&ctx, &p->DataType, sizeof(p->DataType));
+      _mesa_sha1_update(&ctx, &p->Size, sizeof(p->Size));
+      _mesa_sha1_update(&ctx, p->StateIndexes, sizeof(p->StateIndexes));
+      _mesa_sha1_update(&ctx, &p->ValueOffset, sizeof(p->ValueOffset));
+   }
+
+   _mesa_sha1_final(&ctx, prehash);
+}
+
 static void
 lower_ucp(struct st_context *st,
           struct nir_shader *nir,
@@ -672,6 +714,7 @@ st_create_common_variant(struct st_context *st,
 {
    struct st_common_variant *v = CALLOC_STRUCT(st_common_variant);
    struct pipe_shader_state state = {0};
+   unsigned char prehash[SHA1_DIGEST_LENGTH];
 
    static const gl_state_index16 point_size_state[STATE_LENGTH] =
       { STATE_POINT_SIZE_CLAMPED, 0 };
@@ -683,6 +726,11 @@ st_create_common_variant(struct st_context *st,
 
    bool finalize = false;
 
+   /* This must be computed before the lowering below changes params. */
+   st_variant_prehash(st, prog, &state.stream_output, key, sizeof(*key),
+                      prehash);
+   state.nir_prehash = prehash;
+
    state.type = PIPE_SHADER_IR_NIR;
    state.ir.nir = get_nir_shader(st, prog);
    const nir_shader_compiler_options *options = ((nir_shader *)state.ir.nir)->options;
@@ -771,13 +819,21 @@ st_get_common_variant(struct st_context *st,
                       struct gl_program *prog,
                       const struct st_common_variant_key *key)
 {
-   struct st_common_variant *v;
+   struct st_common_variant *v = st_common_variant(prog->last_variant);
+   uint32_t hash = 0;
 
-   /* Search for existing variant */
-   for (v = st_common_variant(prog->variants); v;
-        v = st_common_variant(v->base.next)) {
-      if (memcmp(&v->key, key, sizeof(*key)) == 0) {
-         break;
+   /* The key usually doesn't change between lookups.  Otherwise search for
+    * an existing variant, comparing the hashes of the keys first.
+    */
+   if (!v || memcmp(&v->key, key, sizeof(*key)) != 0) {
+      hash = _mesa_hash_data(key, sizeof(*key));
+
+      for (v = st_common_variant(prog->variants); v;
+           v = st_common_variant(v->base.next)) {
+         if (v->base.key_hash == hash &&
+             memcmp(&v->key, key, sizeof(*key)) == 0) {
+            break;
+         }
       }
    }
 
@@ -798,6 +854,7 @@ st_get_common_variant(struct st_context *st,
       v = st_create_common_variant(st, prog, key);
       if (v) {
          v->base.st = key->st;
+         v->base.key_hash = hash;
 
          if (prog->info.stage == MESA_SHADER_VERTEX) {
             struct gl_vertex_program *vp = (struct gl_vertex_program *)prog;
@@ -811,6 +868,9 @@ st_get_common_variant(struct st_context *st,
       }
    }
 
+   if (v)
+      prog->last_variant = &v->base;
+
    return v;
 }
 
@@ -872,6 +932,7 @@ st_create_fp_variant(struct st_context *st,
 {
    struct st_fp_variant *variant = CALLOC_STRUCT(st_fp_variant);
    struct pipe_shader_state state = {0};
+   unsigned char prehash[SHA1_DIGEST_LENGTH];
    struct gl_program_parameter_list *params = fp->Parameters;
    static const gl_state_index16 texcoord_state[STATE_LENGTH] =
       { STATE_CURRENT_ATTRIB, VERT_ATTRIB_TEX0 };
@@ -898,6 +959,11 @@ st_create_fp_variant(struct st_context *st,
 
       state.ir.nir = s;
    } else {
+      /* This must be computed before the lowering below changes params. */
+      st_variant_prehash(st, fp, &state.stream_output, key, sizeof(*key),
+                         prehash);
+      state.nir_prehash = prehash;
+
       state.ir.nir = get_nir_shader(st, fp);
    }
    state.type = PIPE_SHADER_IR_NIR;
@@ -1067,13 +1133,19 @@ st_get_fp_variant(struct st_context *st,
                   struct gl_program *fp,
                   const struct st_fp_variant_key *key)
 {
-   struct st_fp_variant *fpv;
+   struct st_fp_variant *fpv = st_fp_variant(fp->last_variant);
+   uint32_t hash = 0;
 
-   /* Search for existing variant */
-   for (fpv = st_fp_variant(fp->variants); fpv;
-        fpv = st_fp_variant(fpv->base.next)) {
-      if (memcmp(&fpv->key, key, sizeof(*key)) == 0) {
-         break;
+   /* See st_get_common_variant. */
+   if (!fpv || memcmp(&fpv->key, key, sizeof(*key)) != 0) {
+      hash = _mesa_hash_data(key, sizeof(*key));
+
+      for (fpv = st_fp_variant(fp->variants); fpv;
+           fpv = st_fp_variant(fpv->base.next)) {
+         if (fpv->base.key_hash == hash &&
+             memcmp(&fpv->key, key, sizeof(*key)) == 0) {
+            break;
+         }
       }
    }
 
@@ -1102,11 +1174,15 @@ st_get_fp_variant(struct st_context *st,
       fpv = st_create_fp_variant(st, fp, key);
       if (fpv) {
          fpv->base.st = key->st;
+         fpv->base.key_hash = hash;
 
          st_add_variant(&fp->variants, &fpv->base);
       }
    }
 
+   if (fpv)
+      fp->last_variant = &fpv->base;
+
    return fpv;
 }
 
@@ -1133,6 +1209,8 @@ destroy_program_variants(struct st_context *st, struct gl_program *p)
 
          /* unlink from list */
          *prevPtr = next;
+         if (p->last_variant == v)
+            p->last_variant = NULL;
          /* destroy this variant */
          delete_variant(st, v, p->Target);
       }
@@ -1304,6 +1382,8 @@ st_serialize_nir(struct gl_program *prog)
       nir_serialize(&blob, prog->nir, false);
       blob_finish_get_buffer(&blob, &prog->serialized_nir, &size);
       prog->serialized_nir_size = size;
+      _mesa_sha1_compute(prog->serialized_nir, size,
+                         prog->serialized_nir_sha1);
    }
 }
 
@@ -182,6 +182,9 @@ struct st_variant
    /** st_context from the shader key */
    struct st_context *st;
 
+   /** _mesa_hash_data of the key, compared before the whole key */
+   uint32_t key_hash;
+
    void *driver_shader;
 };
 
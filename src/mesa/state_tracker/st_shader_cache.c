@@ -68,6 +68,12 @@ write_nir_to_cache(struct blob *blob, struct gl_program *prog)
    blob_write_intptr(blob, prog->serialized_nir_size);
    blob_write_bytes(blob, prog->serialized_nir, prog->serialized_nir_size);
 
+   /* Store the hash too, so that loading doesn't have to hash the whole
+    * NIR again just to compute variant keys.
+    */
+   blob_write_bytes(blob, prog->serialized_nir_sha1,
+                    sizeof(prog->serialized_nir_sha1));
+
    copy_blob_to_driver_cache_blob(blob, prog);
 }
 
@@ -181,6 +187,8 @@ st_deserialise_nir_program(struct gl_context *ctx,
    prog->serialized_nir_size = blob_read_intptr(&blob_reader);
    prog->serialized_nir = malloc(prog->serialized_nir_size);
    blob_copy_bytes(&blob_reader, prog->serialized_nir, prog->serialized_nir_size);
+   blob_copy_bytes(&blob_reader, prog->serialized_nir_sha1,
+                   sizeof(prog->serialized_nir_sha1));
    prog->shader_program = shProg;
 
    /* Make sure we don't try to read more data than we wrote. This should
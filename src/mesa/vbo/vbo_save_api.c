@@ -78,6 +78,9 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
  * with 3 vertices can be merged in a single GL_TRIANGLES with 6 vertices).
  *   - an index buffer is built.
  *   - identical vertices are detected and only one is kept.
+ *   - the draws are appended to the previous vertex list if nothing else
+ *     was compiled in between and it uses the same VAO (see
+ *     merge_vertex_lists).
  * At the end of this transformation, the index buffer and the vertex buffer
  * are uploaded in vRAM in the same buffer object.
  * This buffer object is shared between multiple display list to allow
@@ -504,6 +507,115 @@ get_vertex_count(struct vbo_save_context *save)
 }
 
 
+static inline const struct pipe_draw_start_count_bias *
+get_start_counts(const struct vbo_save_vertex_list *node)
+{
+   return node->modes || node->num_draws > 1 ? node->start_counts :
+                                                &node->start_count;
+}
+
+
+/**
+ * Append the draws of "node" to "prev" if no other instruction was compiled
+ * between them and both use the same VAO, i.e. the same buffer, offset and
+ * vertex format. This happens when vertices are flushed without compiling
+ * anything else, e.g. by state queries or glFlush while compiling, or when
+ * the vertex store fills up between two primitives. Execution then does one
+ * multi-draw instead of validating and drawing each node separately.
+ *
+ * Return true if the draws were merged. The caller must free "node" then.
+ */
+static bool
+merge_vertex_lists(struct gl_context *ctx, struct vbo_save_vertex_list *prev,
+                   struct vbo_save_vertex_list *node)
+{
+   if (!prev ||
+       (union gl_dlist_node *)prev + prev->header.InstSize !=
+       (union gl_dlist_node *)node ||
+       prev->header.opcode != node->header.opcode ||
+       ctx->ListState.Current.UseLoopback ||
+       !prev->num_draws || !node->num_draws ||
+       prev->cold->ib.obj != node->cold->ib.obj)
+      return false;
+
+   for (unsigned i = 0; i < VP_MODE_MAX; i++) {
+      if (prev->cold->VAO[i] != node->cold->VAO[i])
+         return false;
+   }
+
+   /* Wrapped primitives continue in the next node and must stay there. */
+   if (!prev->cold->prims[prev->cold->prim_count - 1].end ||
+       !node->cold->prims[0].begin)
+      return false;
+
+   const unsigned num_draws = prev->num_draws + node->num_draws;
+   struct pipe_draw_start_count_bias *start_counts =
+      malloc(num_draws * sizeof(*start_counts));
+   uint8_t *modes = malloc(num_draws);
+   struct _mesa_prim *prims =
+      malloc((prev->cold->prim_count + node->cold->prim_count) *
+             sizeof(*prims));
+
+   if (!start_counts || !modes || !prims) {
+      free(start_counts);
+      free(modes);
+      free(prims);
+      return false;
+   }
+
+   memcpy(start_counts, get_start_counts(prev),
+          prev->num_draws * sizeof(*start_counts));
+   memcpy(start_counts + prev->num_draws, get_start_counts(node),
+          node->num_draws * sizeof(*start_counts));
+
+   bool same_mode = true;
+   for (unsigned i = 0; i < num_draws; i++) {
+      const struct vbo_save_vertex_list *src =
+         i < prev->num_draws ? prev : node;
+      const unsigned j = i < prev->num_draws ? i : i - prev->num_draws;
+
+      modes[i] = src->modes ? src->modes[j] : src->cold->info.mode;
+      same_mode &= modes[i] == modes[0];
+   }
+
+   /* The primitives and the vertex range are only used by the loopback
+    * path and by glCallList inside glBegin/End.
+    */
+   memcpy(prims, prev->cold->prims, prev->cold->prim_count * sizeof(*prims));
+   memcpy(prims + prev->cold->prim_count, node->cold->prims,
+          node->cold->prim_count * sizeof(*prims));
+   free(prev->cold->prims);
+   prev->cold->prims = prims;
+   prev->cold->prim_count += node->cold->prim_count;
+   prev->cold->vertex_count += node->cold->vertex_count;
+   prev->cold->min_index = MIN2(prev->cold->min_index, node->cold->min_index);
+   prev->cold->max_index = MAX2(prev->cold->max_index, node->cold->max_index);
+
+   if (prev->modes || prev->num_draws > 1) {
+      free(prev->modes);
+      free(prev->start_counts);
+   }
+
+   prev->start_counts = start_counts;
+   prev->num_draws = num_draws;
+   if (same_mode) {
+      prev->cold->info.mode = modes[0];
+      prev->modes = NULL;
+      free(modes);
+   } else {
+      prev->modes = modes;
+   }
+   prev->mode = prev->cold->info.mode;
+
+   /* The current values are those of the last vertex. */
+   fi_type *current_data = prev->cold->current_data;
+   prev->cold->current_data = node->cold->current_data;
+   node->cold->current_data = current_data;
+
+   return true;
+}
+
+
 /**
  * Insert the active immediate struct onto the display list currently
  * being built.
@@ -514,6 +626,9 @@ compile_vertex_list(struct gl_context *ctx)
    struct vbo_save_context *save = &vbo_context(ctx)->save;
    struct vbo_save_vertex_list *node;
 
+   /* The previous vertex list, if nothing else was compiled since. */
+   struct vbo_save_vertex_list *prev = _mesa_dlist_get_last_vertex_list(ctx);
+
    /* Allocate space for this structure in the display list currently
     * being compiled.
     */
@@ -992,6 +1107,9 @@ end:
       _glapi_set_dispatch(dispatch);
    }
 
+   if (merge_vertex_lists(ctx, prev, node))
+      _mesa_dlist_free_last_vertex_list(ctx, node, prev);
+
    /* Reset our structures for the next run of vertices:
     */
    reset_counters(ctx);
@@ -24,6 +24,7 @@
 #include "dxil_module.h"
 #include "dxil_internal.h"
 
+#include "util/hash_table.h"
 #include "util/macros.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
@@ -32,6 +33,67 @@
 #include <assert.h>
 #include <stdio.h>
 
+/* Scalar constants and undefs are looked up by type and the raw bits of the
+ * value, so that e.g. 0.0 and -0.0 stay distinct.
+ */
+static uint32_t
+hash_const(const void *key)
+{
+   const struct dxil_const *c = key;
+   uint32_t hash = _mesa_hash_pointer(c->value.type);
+   hash = _mesa_hash_data_with_seed(&c->undef, sizeof(c->undef), hash);
+   return _mesa_hash_data_with_seed(&c->int_value, sizeof(c->int_value), hash);
+}
+
+static bool
+consts_equal(const void *a, const void *b)
+{
+   const struct dxil_const *ca = a, *cb = b;
+   return ca->value.type == cb->value.type &&
+          ca->undef == cb->undef &&
+          ca->int_value == cb->int_value;
+}
+
+static uint32_t
+hash_mdnode(const void *key)
+{
+   const struct dxil_mdnode *n = key;
+   uint32_t hash = n->type;
+   switch (n->type) {
+   case MD_STRING:
+      return hash ^ _mesa_hash_string(n->string);
+   case MD_VALUE:
+      hash = _mesa_hash_data_with_seed(&n->value.type, sizeof(n->value.type), hash);
+      return _mesa_hash_data_with_seed(&n->value.value, sizeof(n->value.value), hash);
+   case MD_NODE:
+      return _mesa_hash_data_with_seed(n->node.subnodes,
+                                       sizeof(*n->node.subnodes) * n->node.num_subnodes,
+                                       hash);
+   }
+   unreachable("unknown metadata node type");
+}
+
+static bool
+mdnodes_equal(const void *a, const void *b)
+{
+   const struct dxil_mdnode *na = a, *nb = b;
+   if (na->type != nb->type)
+      return false;
+
+   switch (na->type) {
+   case MD_STRING:
+      return !strcmp(na->string, nb->string);
+   case MD_VALUE:
+      return na->value.type == nb->value.type &&
+             na->value.value == nb->value.value;
+   case MD_NODE:
+      return na->node.num_subnodes == nb->node.num_subnodes &&
+             !memcmp(na->node.subnodes, nb->node.subnodes,
+                     sizeof(*na->node.subnodes) * na->node.num_subnodes);
+   }
+   unreachable("unknown metadata node type");
+}
+
 void
 dxil_module_init(struct dxil_module *m, void *ralloc_ctx)
 {
@@ -54,6 +116,11 @@ dxil_module_init(struct dxil_module *m, void *ralloc_ctx)
 
    m->functions = rzalloc(ralloc_ctx, struct rb_tree);
    rb_tree_init(m->functions);
+
+   m->const_table = _mesa_hash_table_create(ralloc_ctx, hash_const,
+                                            consts_equal);
+   m->mdnode_table = _mesa_hash_table_create(ralloc_ctx, hash_mdnode,
+                                             mdnodes_equal);
 }
 
 void
@@ -340,7 +407,7 @@ create_type(struct dxil_module *m, enum type_type type)
                                         sizeof(struct dxil_type));
    if (ret) {
       ret->type = type;
-      ret->id = list_length(&m->type_list);
+      ret->id = m->num_types++;
       list_addtail(&ret->head, &m->type_list);
    }
    return ret;
@@ -1511,7 +1578,7 @@ emit_type_table(struct dxil_module *m)
 {
    if (!enter_subblock(m, DXIL_TYPE_BLOCK, 4) ||
        !emit_type_table_abbrevs(m) ||
-       !emit_record_int(m, 1, 1 + list_length(&m->type_list)))
+       !emit_record_int(m, 1, 1 + m->num_types))
       return false;
 
    list_for_each_entry(struct dxil_type, type, &m->type_list, head) {
@@ -1538,28 +1605,48 @@ create_const(struct dxil_module *m, const struct dxil_type *type, bool undef)
 }
 
 static const struct dxil_value *
-get_int_const(struct dxil_module *m, const struct dxil_type *type,
-              intmax_t value)
+get_scalar_const(struct dxil_module *m, const struct dxil_type *type,
+                 bool undef, intmax_t bits)
 {
-   assert(type && type->type == TYPE_INTEGER);
+   struct dxil_const key;
+   key.value.type = type;
+   key.undef = undef;
+   key.int_value = bits;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->int_value == value)
-         return &c->value;
-   }
+   uint32_t hash = hash_const(&key);
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(m->const_table, hash, &key);
+   if (entry)
+      return &((struct dxil_const *)entry->data)->value;
 
-   c = create_const(m, type, false);
+   struct dxil_const *c = create_const(m, type, undef);
    if (!c)
       return NULL;
 
-   c->int_value = value;
+   c->int_value = bits;
+   if (!_mesa_hash_table_insert_pre_hashed(m->const_table, hash, c, c))
+      return NULL;
    return &c->value;
 }
 
+static const struct dxil_value *
+get_int_const(struct dxil_module *m, const struct dxil_type *type,
+              intmax_t value)
+{
+   assert(type && type->type == TYPE_INTEGER);
+   return get_scalar_const(m, type, false, value);
+}
+
+static const struct dxil_value *
+get_float_const(struct dxil_module *m, const struct dxil_type *type,
+                double value)
+{
+   intmax_t bits;
+   STATIC_ASSERT(sizeof(bits) == sizeof(value));
+   memcpy(&bits, &value, sizeof(bits));
+   return get_scalar_const(m, type, false, bits);
+}
+
 const struct dxil_value *
 dxil_module_get_int1_const(struct dxil_module *m, bool value)
 {
@@ -1647,21 +1734,7 @@ dxil_module_get_float16_const(struct dxil_module *m, uint16_t value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->int_value == (uintmax_t)value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->int_value = (uintmax_t)value;
-   return &c->value;
+   return get_scalar_const(m, type, false, (uintmax_t)value);
 }
 
 const struct dxil_value *
@@ -1671,21 +1744,7 @@ dxil_module_get_float_const(struct dxil_module *m, float value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->float_value == value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->float_value = value;
-   return &c->value;
+   return get_float_const(m, type, value);
 }
 
 const struct dxil_value *
@@ -1695,21 +1754,7 @@ dxil_module_get_double_const(struct dxil_module *m, double value)
    if (!type)
       return NULL;
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type || c->undef)
-         continue;
-
-      if (c->float_value == value)
-         return &c->value;
-   }
-
-   c = create_const(m, type, false);
-   if (!c)
-      return NULL;
-
-   c->float_value = value;
-   return &c->value;
+   return get_float_const(m, type, value);
 }
 
 const struct dxil_value *
@@ -1744,17 +1789,7 @@ dxil_module_get_undef(struct dxil_module *m, const struct dxil_type *type)
 {
    assert(type != NULL);
 
-   struct dxil_const *c;
-   LIST_FOR_EACH_ENTRY(c, &m->const_list, head) {
-      if (c->value.type != type)
-         continue;
-
-      if (c->undef)
-         return &c->value;
-   }
-
-   c = create_const(m, type, true);
-   return c ? &c->value : NULL;
+   return get_scalar_const(m, type, true, 0);
 }
 
 enum dxil_module_code {
@@ -2288,7 +2323,7 @@ create_mdnode(struct dxil_module *m, enum mdnode_type type)
                                           sizeof(struct dxil_mdnode));
    if (ret) {
       ret->type = type;
-      ret->id = list_length(&m->mdnode_list) + 1; /* zero is reserved for NULL nodes */
+      ret->id = ++m->num_mdnodes; /* zero is reserved for NULL nodes */
       list_addtail(&ret->head, &m->mdnode_list);
    }
    return ret;
@@ -2299,17 +2334,21 @@ dxil_get_metadata_string(struct dxil_module *m, const char *str)
 {
    assert(str);
 
-   struct dxil_mdnode *n;
-   LIST_FOR_EACH_ENTRY(n, &m->mdnode_list, head) {
-      if (n->type == MD_STRING &&
-          !strcmp(n->string, str))
-         return n;
-   }
+   struct dxil_mdnode key;
+   key.type = MD_STRING;
+   key.string = (char *)str;
+
+   uint32_t hash = hash_mdnode(&key);
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(m->mdnode_table, hash, &key);
+   if (entry)
+      return entry->data;
 
-   n = create_mdnode(m, MD_STRING);
+   struct dxil_mdnode *n = create_mdnode(m, MD_STRING);
    if (n) {
       n->string = ralloc_strdup(n, str);
-      if (!n->string)
+      if (!n->string ||
+          !_mesa_hash_table_insert_pre_hashed(m->mdnode_table, hash, n, n))
          return NULL;
    }
    return n;
@@ -2319,18 +2358,23 @@ const struct dxil_mdnode *
 dxil_get_metadata_value(struct dxil_module *m, const struct dxil_type *type,
                         const struct dxil_value *value)
 {
-   struct dxil_mdnode *n;
-   LIST_FOR_EACH_ENTRY(n, &m->mdnode_list, head) {
-      if (n->type == MD_VALUE &&
-          n->value.type == type &&
-          n->value.value == value)
-         return n;
-   }
+   struct dxil_mdnode key;
+   key.type = MD_VALUE;
+   key.value.type = type;
+   key.value.value = value;
+
+   uint32_t hash = hash_mdnode(&key);
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(m->mdnode_table, hash, &key);
+   if (entry)
+      return entry->data;
 
-   n = create_mdnode(m, MD_VALUE);
+   struct dxil_mdnode *n = create_mdnode(m, MD_VALUE);
    if (n) {
       n->value.type = type;
       n->value.value = value;
+      if (!_mesa_hash_table_insert_pre_hashed(m->mdnode_table, hash, n, n))
+         return NULL;
    }
    return n;
 }
@@ -2348,16 +2392,18 @@ dxil_get_metadata_node(struct dxil_module *m,
                        const struct dxil_mdnode *subnodes[],
                        size_t num_subnodes)
 {
-   struct dxil_mdnode *n;
-   LIST_FOR_EACH_ENTRY(n, &m->mdnode_list, head) {
-      if (n->type == MD_NODE &&
-          n->node.num_subnodes == num_subnodes &&
-          !memcmp(n->node.subnodes, subnodes, sizeof(struct dxil_mdnode *) *
-                  num_subnodes))
-         return n;
-   }
+   struct dxil_mdnode key;
+   key.type = MD_NODE;
+   key.node.subnodes = subnodes;
+   key.node.num_subnodes = num_subnodes;
+
+   uint32_t hash = hash_mdnode(&key);
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(m->mdnode_table, hash, &key);
+   if (entry)
+      return entry->data;
 
-   n = create_mdnode(m, MD_NODE);
+   struct dxil_mdnode *n = create_mdnode(m, MD_NODE);
    if (n) {
       void *tmp = ralloc_array(n, struct dxil_mdnode *, num_subnodes);
       if (!tmp)
@@ -2366,6 +2412,8 @@ dxil_get_metadata_node(struct dxil_module *m,
       memcpy(tmp, subnodes, sizeof(struct dxil_mdnode *) * num_subnodes);
       n->node.subnodes = tmp;
       n->node.num_subnodes = num_subnodes;
+      if (!_mesa_hash_table_insert_pre_hashed(m->mdnode_table, hash, n, n))
+         return NULL;
    }
    return n;
 }
@@ -220,6 +220,15 @@ struct dxil_module {
    struct list_head const_list;
    struct list_head mdnode_list;
    struct list_head md_named_node_list;
+   unsigned num_types;
+   unsigned num_mdnodes;
+
+   /* Lookup tables for the constants and metadata nodes that get
+    * deduplicated, the lists above keep their emission order.
+    */
+   struct hash_table *const_table;
+   struct hash_table *mdnode_table;
+
    const struct dxil_type *void_type;
    const struct dxil_type *int1_type, *int8_type, *int16_type,
                           *int32_type, *int64_type;
@@ -45,6 +45,12 @@ struct bi_worklist {
          * scheduled before (after) this instruction. */
         unsigned *dep_counts;
         BITSET_WORD **dependents;
+
+        /* Bitset of instructions reading the result of a message-passing
+         * instruction earlier in the block. The scoreboard stalls them until
+         * the message returns, so they want as many clauses as possible
+         * between them and their producer. */
+        BITSET_WORD *message_consumers;
 };
 
 /* State of a single tuple and clause under construction */
@@ -438,6 +444,44 @@ bi_flatten_block(bi_block *block, unsigned *len)
  * debug, force in-order scheduling (no dependency graph is constructed).
  */
 
+/* Find the instructions that read a register last written by a message in
+ * the same block. Registers written by messages in other blocks are assumed to
+ * have landed by the time the block runs. */
+
+static void
+bi_find_message_consumers(struct bi_worklist st)
+{
+        uint64_t message_regs = 0;
+
+        for (unsigned i = 0; i < st.count; ++i) {
+                bi_instr *ins = st.instructions[i];
+
+                bi_foreach_src(ins, s) {
+                        if (ins->src[s].type != BI_INDEX_REGISTER) continue;
+
+                        unsigned count = bi_count_read_registers(ins, s);
+                        uint64_t mask = BITFIELD64_MASK(count) << ins->src[s].value;
+
+                        if (message_regs & mask)
+                                BITSET_SET(st.message_consumers, i);
+                }
+
+                bool message = bi_message_type_for_instr(ins);
+
+                bi_foreach_dest(ins, d) {
+                        if (ins->dest[d].type != BI_INDEX_REGISTER) continue;
+
+                        unsigned count = bi_count_write_registers(ins, d);
+                        uint64_t mask = BITFIELD64_MASK(count) << ins->dest[d].value;
+
+                        if (message)
+                                message_regs |= mask;
+                        else
+                                message_regs &= ~mask;
+                }
+        }
+}
+
 static struct bi_worklist
 bi_initialize_worklist(bi_block *block, bool inorder, bool is_blend)
 {
@@ -453,6 +497,9 @@ bi_initialize_worklist(bi_block *block, bool inorder, bool is_blend)
         bi_create_dependency_graph(st, inorder, is_blend);
         st.worklist = calloc(BITSET_WORDS(st.count), sizeof(BITSET_WORD));
 
+        st.message_consumers = calloc(BITSET_WORDS(st.count), sizeof(BITSET_WORD));
+        bi_find_message_consumers(st);
+
         for (unsigned i = 0; i < st.count; ++i) {
                 if (st.dep_counts[i] == 0)
                         BITSET_SET(st.worklist, i);
@@ -468,6 +515,7 @@ bi_free_worklist(struct bi_worklist st)
         free(st.dependents);
         free(st.instructions);
         free(st.worklist);
+        free(st.message_consumers);
 }
 
 static void
@@ -1187,8 +1235,9 @@ bi_instr_schedulable(bi_instr *instr,
 }
 
 static signed
-bi_instr_cost(bi_instr *instr, struct bi_tuple_state *tuple)
+bi_instr_cost(struct bi_worklist st, unsigned idx, struct bi_tuple_state *tuple)
 {
+        bi_instr *instr = st.instructions[idx];
         signed cost = 0;
 
         /* Instructions that can schedule to either FMA or to ADD should be
@@ -1207,6 +1256,14 @@ bi_instr_cost(bi_instr *instr, struct bi_tuple_state *tuple)
         if (bi_opcode_props[instr->op].last)
                 cost -= 2;
 
+        /* Consumers of a message result stall until the message returns.
+         * Scheduling them early (backwards) pushes them to later clauses,
+         * leaving independent arithmetic between them and their message to
+         * hide the latency. It also frees the other instructions to fill the
+         * tuples around the message itself. */
+        if (BITSET_TEST(st.message_consumers, idx))
+                cost--;
+
         return cost;
 }
 
@@ -1226,7 +1283,7 @@ bi_choose_index(struct bi_worklist st,
                 if (!bi_instr_schedulable(instr, clause, tuple, live_after_temp, fma))
                         continue;
 
-                signed cost = bi_instr_cost(instr, tuple);
+                signed cost = bi_instr_cost(st, i, tuple);
 
                 /* Tie break in favour of later instructions, under the
                  * assumption this promotes temporary usage (reducing pressure
@@ -3942,6 +3942,12 @@ bi_print_stats(bi_context *ctx, unsigned size, FILE *fp)
                 ralloc_asprintf_append(&str, ", %u preloads", bi_count_preload_cost(ctx));
         }
 
+        /* Fraction of FMA and ADD slots scheduled with an instruction */
+        float tuple_fill = stats.nr_tuples ?
+                ((float) stats.nr_ins) / (2.0 * stats.nr_tuples) : 0.0;
+
+        ralloc_asprintf_append(&str, ", %f tuple fill", tuple_fill);
+
         ralloc_asprintf_append(&str, ", %u loops, %u:%u spills:fills\n",
                         ctx->loop_count, ctx->spills, ctx->fills);
 
@@ -291,6 +291,14 @@ blob_read_bytes(struct blob_reader *blob, size_t size)
    return ret;
 }
 
+const void *
+blob_read_aligned_bytes(struct blob_reader *blob, size_t alignment,
+                        size_t size)
+{
+   blob_reader_align(blob, alignment);
+   return blob_read_bytes(blob, size);
+}
+
 void
 blob_copy_bytes(struct blob_reader *blob, void *dest, size_t size)
 {
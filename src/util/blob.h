@@ -350,6 +350,21 @@ blob_reader_align(struct blob_reader *blob, size_t alignment);
 const void *
 blob_read_bytes(struct blob_reader *blob, size_t size);
 
+/**
+ * Align the current location to \alignment, then read some unstructured,
+ * fixed-size data like blob_read_bytes().
+ *
+ * This lets readers use arrays in the data underlying the blob reader in
+ * place instead of copying them, when that data outlives what they read,
+ * e.g. a buffer mapped from a read-only cache.  The data underlying the blob
+ * reader must itself be aligned to \alignment.
+ *
+ * \return The bytes read (see the note of blob_read_bytes()).
+ */
+const void *
+blob_read_aligned_bytes(struct blob_reader *blob, size_t alignment,
+                        size_t size);
+
 /**
  * Read some unstructured, fixed-size data from the current location, copying
  * it to \dest (and update the current location to just past this data)
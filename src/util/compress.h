@@ -37,4 +37,34 @@ size_t
 util_compress_deflate(const uint8_t *in_data, size_t in_data_size,
                       uint8_t *out_data, size_t out_buff_size);
 
+/* A compression dictionary, only supported with zstd. Dictionaries can be
+ * shared between threads.
+ */
+struct util_compress_dict;
+
+struct util_compress_dict *
+util_compress_dict_create(const void *dict_data, size_t dict_size);
+
+void
+util_compress_dict_destroy(struct util_compress_dict *dict);
+
+size_t
+util_compress_train_dict(const void *samples, const size_t *sample_sizes,
+                         unsigned num_samples, void *dict_data,
+                         size_t dict_capacity);
+
+/* Like util_compress_deflate()/util_compress_inflate() but using \p dict,
+ * which may be NULL. Data compressed without a dictionary can always be
+ * decompressed, with or without one.
+ */
+size_t
+util_compress_deflate_dict(const struct util_compress_dict *dict,
+                           const uint8_t *in_data, size_t in_data_size,
+                           uint8_t *out_data, size_t out_buff_size);
+
+bool
+util_compress_inflate_dict(const struct util_compress_dict *dict,
+                           const uint8_t *in_data, size_t in_data_size,
+                           uint8_t *out_data, size_t out_data_size);
+
 #endif
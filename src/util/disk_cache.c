@@ -37,8 +37,10 @@
 #include <dirent.h>
 #include <inttypes.h>
 
+#include "util/compress.h"
 #include "util/crc32.h"
 #include "util/debug.h"
+#include "util/hash_table.h"
 #include "util/rand_xor.h"
 #include "util/u_atomic.h"
 #include "util/mesa-sha1.h"
@@ -68,6 +70,236 @@ do {                                       \
    _dst += _src_size;                      \
 } while (0);
 
+/* Parse a size given as a number optionally followed by K, M or G. Sizes
+ * without a unit are in gigabytes. Returns 0 if the string isn't a number.
+ */
+static uint64_t
+parse_cache_size(const char *size_str)
+{
+   char *end;
+   uint64_t size = strtoul(size_str, &end, 10);
+   if (end == size_str)
+      return 0;
+
+   switch (*end) {
+   case 'K':
+   case 'k':
+      size *= 1024;
+      break;
+   case 'M':
+   case 'm':
+      size *= 1024*1024;
+      break;
+   case '\0':
+   case 'G':
+   case 'g':
+   default:
+      size *= 1024*1024*1024;
+      break;
+   }
+
+   return size;
+}
+
+/* Cache keys are SHA-1 hashes already, so any 32 bits of them make a good
+ * hash table hash.
+ */
+static uint32_t
+mem_item_key_hash(const void *key)
+{
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+mem_item_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, CACHE_KEY_SIZE) == 0;
+}
+
+static void
+mem_cache_init(struct disk_cache *cache, uint64_t max_size)
+{
+   if (max_size == 0)
+      return;
+
+   cache->mem.items = _mesa_hash_table_create(NULL, mem_item_key_hash,
+                                              mem_item_key_equal);
+   if (!cache->mem.items)
+      return;
+
+   simple_mtx_init(&cache->mem.mtx, mtx_plain);
+   list_inithead(&cache->mem.lru);
+   cache->mem.max_size = max_size;
+}
+
+static void
+mem_cache_finish(struct disk_cache *cache)
+{
+   if (!cache->mem.items)
+      return;
+
+   list_for_each_entry_safe(struct disk_cache_mem_item, item,
+                            &cache->mem.lru, link)
+      free(item);
+
+   _mesa_hash_table_destroy(cache->mem.items, NULL);
+   simple_mtx_destroy(&cache->mem.mtx);
+}
+
+/* Must be called with mem.mtx held. */
+static void
+mem_cache_remove_item(struct disk_cache *cache,
+                      struct disk_cache_mem_item *item)
+{
+   _mesa_hash_table_remove_key(cache->mem.items, item->key);
+   list_del(&item->link);
+   cache->mem.size -= item->size;
+   free(item);
+}
+
+static void
+mem_cache_put(struct disk_cache *cache, const cache_key key,
+              const void *data, size_t size)
+{
+   if (!cache->mem.items || size > cache->mem.max_size)
+      return;
+
+   /* Copy the data before taking the lock, we only need it to link the item
+    * in.
+    */
+   struct disk_cache_mem_item *item =
+      malloc(sizeof(struct disk_cache_mem_item) + size);
+   if (!item)
+      return;
+
+   memcpy(item->key, key, CACHE_KEY_SIZE);
+   memcpy(item->data, data, size);
+   item->size = size;
+
+   simple_mtx_lock(&cache->mem.mtx);
+
+   struct hash_entry *entry = _mesa_hash_table_search(cache->mem.items, key);
+   if (entry) {
+      /* Someone beat us to it, just mark the existing copy as used. */
+      struct disk_cache_mem_item *old = entry->data;
+      list_move_to(&old->link, &cache->mem.lru);
+      simple_mtx_unlock(&cache->mem.mtx);
+      free(item);
+      return;
+   }
+
+   _mesa_hash_table_insert(cache->mem.items, item->key, item);
+   list_add(&item->link, &cache->mem.lru);
+   cache->mem.size += size;
+
+   /* Evict the least recently used items until we fit again. */
+   while (cache->mem.size > cache->mem.max_size) {
+      struct disk_cache_mem_item *lru =
+         list_last_entry(&cache->mem.lru, struct disk_cache_mem_item, link);
+      mem_cache_remove_item(cache, lru);
+   }
+
+   simple_mtx_unlock(&cache->mem.mtx);
+}
+
+static void *
+mem_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
+{
+   void *data = NULL;
+
+   if (!cache->mem.items)
+      return NULL;
+
+   simple_mtx_lock(&cache->mem.mtx);
+
+   struct hash_entry *entry = _mesa_hash_table_search(cache->mem.items, key);
+   if (entry) {
+      struct disk_cache_mem_item *item = entry->data;
+      list_move_to(&item->link, &cache->mem.lru);
+
+      /* Callers own and free what disk_cache_get() returns. */
+      data = malloc(item->size);
+      if (data) {
+         memcpy(data, item->data, item->size);
+         if (size)
+            *size = item->size;
+      }
+      cache->mem.hits++;
+   } else {
+      cache->mem.misses++;
+   }
+
+   simple_mtx_unlock(&cache->mem.mtx);
+
+   return data;
+}
+
+static void
+mem_cache_remove(struct disk_cache *cache, const cache_key key)
+{
+   if (!cache->mem.items)
+      return;
+
+   simple_mtx_lock(&cache->mem.mtx);
+
+   struct hash_entry *entry = _mesa_hash_table_search(cache->mem.items, key);
+   if (entry)
+      mem_cache_remove_item(cache, entry->data);
+
+   simple_mtx_unlock(&cache->mem.mtx);
+}
+
+static void
+cache_evict(void *job, void *gdata, int thread_index)
+{
+   struct disk_cache *cache = (struct disk_cache *) job;
+
+   /* Clear these first so that puts racing with us schedule another run. */
+   uint64_t room = p_atomic_xchg(&cache->evict_room, 0);
+   p_atomic_set(&cache->evict_pending, 0);
+
+   /* Make room for another item like the one that triggered eviction, and
+    * leave some headroom so that the next few puts don't immediately need
+    * another eviction.
+    */
+   room = MIN2(MAX2(room, cache->max_size / 10), cache->max_size);
+   uint64_t target_size = cache->max_size - room;
+
+   if (*cache->size <= target_size)
+      return;
+
+   if (disk_cache_evict_from_journal(cache, target_size))
+      return;
+
+   for (unsigned i = 0; i < 8 && *cache->size > target_size; i++)
+      disk_cache_evict_lru_item(cache);
+}
+
+static void
+cache_compact_journal(void *job, void *gdata, int thread_index)
+{
+   disk_cache_evict_from_journal((struct disk_cache *) job, UINT64_MAX);
+}
+
+static void
+disk_cache_schedule_eviction(struct disk_cache *cache, uint64_t room)
+{
+   p_atomic_set(&cache->evict_room, room);
+
+   if (p_atomic_cmpxchg(&cache->evict_pending, 0, 1) == 0) {
+      util_queue_add_job(&cache->evict_queue, cache, NULL, cache_evict,
+                         NULL, 0);
+   }
+}
+
+static void
+cache_train_dict(void *job, void *gdata, int thread_index)
+{
+   disk_cache_train_dict((struct disk_cache *) job);
+}
+
 struct disk_cache *
 disk_cache_create(const char *gpu_name, const char *driver_id,
                   uint64_t driver_flags)
@@ -76,6 +308,7 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    struct disk_cache *cache = NULL;
    char *max_size_str;
    uint64_t max_size;
+   char *mem_max_size_str;
 
    uint8_t cache_version = CACHE_VERSION;
    size_t cv_size = sizeof(cache_version);
@@ -94,6 +327,7 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
 
    /* Assume failure. */
    cache->path_init_failed = true;
+   cache->journal_fd = -1;
 
 #ifdef ANDROID
    /* Android needs the "disk cache" to be enabled for
@@ -137,30 +371,8 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    }
    #endif
 
-   if (max_size_str) {
-      char *end;
-      max_size = strtoul(max_size_str, &end, 10);
-      if (end == max_size_str) {
-         max_size = 0;
-      } else {
-         switch (*end) {
-         case 'K':
-         case 'k':
-            max_size *= 1024;
-            break;
-         case 'M':
-         case 'm':
-            max_size *= 1024*1024;
-            break;
-         case '\0':
-         case 'G':
-         case 'g':
-         default:
-            max_size *= 1024*1024*1024;
-            break;
-         }
-      }
-   }
+   if (max_size_str)
+      max_size = parse_cache_size(max_size_str);
 
    /* Default to 1GB for maximum cache size. */
    if (max_size == 0) {
@@ -186,6 +398,41 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
                         UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY, NULL))
       goto fail;
 
+   /* Eviction only runs once the cache is full, and a single thread keeps
+    * it from competing with the cache threads above.
+    */
+   if (!env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
+      if (!util_queue_init(&cache->evict_queue, "disk_evict", 1, 1,
+                           UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY |
+                           UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY, NULL)) {
+         util_queue_destroy(&cache->cache_queue);
+         goto fail;
+      }
+
+      if (disk_cache_open_journal(cache)) {
+         util_queue_add_job(&cache->evict_queue, cache, NULL,
+                            cache_compact_journal, NULL, 0);
+      }
+   }
+
+   /* The in-memory tier is disabled unless a size is requested. */
+   mem_max_size_str = getenv("MESA_SHADER_CACHE_MEM_MAX_SIZE");
+   if (mem_max_size_str)
+      mem_cache_init(cache, parse_cache_size(mem_max_size_str));
+
+   disk_cache_load_dict(cache);
+
+   /* Training reads back every item, so do it on the cache thread. The
+    * dictionary is picked up by the next cache created for this directory.
+    */
+   util_queue_fence_init(&cache->train_dict_fence);
+   if (!cache->dict &&
+       env_var_as_boolean("MESA_SHADER_CACHE_TRAIN_DICT", false)) {
+      util_queue_add_job(&cache->cache_queue, cache,
+                         &cache->train_dict_fence, cache_train_dict,
+                         NULL, 0);
+   }
+
    cache->path_init_failed = false;
 
  path_fail:
@@ -241,11 +488,21 @@ disk_cache_destroy(struct disk_cache *cache)
    if (cache && !cache->path_init_failed) {
       util_queue_finish(&cache->cache_queue);
       util_queue_destroy(&cache->cache_queue);
+      util_queue_fence_destroy(&cache->train_dict_fence);
 
-      if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
          foz_destroy(&cache->foz_db);
+      } else {
+         util_queue_finish(&cache->evict_queue);
+         util_queue_destroy(&cache->evict_queue);
+         disk_cache_close_journal(cache);
+      }
 
       disk_cache_destroy_mmap(cache);
+
+      mem_cache_finish(cache);
+
+      util_compress_dict_destroy(cache->dict);
    }
 
    ralloc_free(cache);
@@ -255,11 +512,17 @@ void
 disk_cache_wait_for_idle(struct disk_cache *cache)
 {
    util_queue_finish(&cache->cache_queue);
+
+   /* Puts may have scheduled an eviction while the queue drained. */
+   if (!env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      util_queue_finish(&cache->evict_queue);
 }
 
 void
 disk_cache_remove(struct disk_cache *cache, const cache_key key)
 {
+   mem_cache_remove(cache, key);
+
    char *filename = disk_cache_get_cache_filename(cache, key);
    if (filename == NULL) {
       return;
@@ -341,7 +604,6 @@ cache_put(void *job, void *gdata, int thread_index)
 {
    assert(job);
 
-   unsigned i = 0;
    char *filename = NULL;
    struct disk_cache_put_job *dc_job = (struct disk_cache_put_job *) job;
 
@@ -352,15 +614,17 @@ cache_put(void *job, void *gdata, int thread_index)
       if (filename == NULL)
          goto done;
 
-      /* If the cache is too large, evict something else first. */
-      while (*dc_job->cache->size + dc_job->size > dc_job->cache->max_size &&
-             i < 8) {
-         disk_cache_evict_lru_item(dc_job->cache);
-         i++;
-      }
+      /* If the cache is too large, let the eviction thread trim it instead
+       * of waiting for that here.
+       */
+      bool evict =
+         *dc_job->cache->size + dc_job->size > dc_job->cache->max_size;
 
       disk_cache_write_item_to_disk(dc_job, filename);
 
+      if (evict)
+         disk_cache_schedule_eviction(dc_job->cache, dc_job->size);
+
 done:
       free(filename);
    }
@@ -379,6 +643,8 @@ disk_cache_put(struct disk_cache *cache, const cache_key key,
    if (cache->path_init_failed)
       return;
 
+   mem_cache_put(cache, key, data, size);
+
    struct disk_cache_put_job *dc_job =
       create_put_job(cache, key, (void*)data, size, cache_item_metadata, false);
 
@@ -405,6 +671,8 @@ disk_cache_put_nocopy(struct disk_cache *cache, const cache_key key,
       return;
    }
 
+   mem_cache_put(cache, key, data, size);
+
    struct disk_cache_put_job *dc_job =
       create_put_job(cache, key, data, size, cache_item_metadata, true);
 
@@ -443,15 +711,30 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
       return blob;
    }
 
+   void *data = mem_cache_get(cache, key, size);
+   if (data)
+      return data;
+
+   size_t data_size = 0;
    if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
-      return disk_cache_load_item_foz(cache, key, size);
+      data = disk_cache_load_item_foz(cache, key, &data_size);
    } else {
       char *filename = disk_cache_get_cache_filename(cache, key);
       if (filename == NULL)
          return NULL;
 
-      return disk_cache_load_item(cache, filename, size);
+      data = disk_cache_load_item(cache, filename, &data_size);
+      if (data)
+         disk_cache_journal_append(cache, key, 0);
    }
+
+   if (data) {
+      mem_cache_put(cache, key, data, data_size);
+      if (size)
+         *size = data_size;
+   }
+
+   return data;
 }
 
 void
@@ -522,4 +805,30 @@ disk_cache_set_callbacks(struct disk_cache *cache, disk_cache_put_cb put,
    cache->blob_get_cb = get;
 }
 
+bool
+disk_cache_train_dictionary(struct disk_cache *cache)
+{
+   if (cache->path_init_failed)
+      return false;
+
+   return disk_cache_train_dict(cache);
+}
+
+void
+disk_cache_get_mem_stats(struct disk_cache *cache,
+                         struct disk_cache_mem_stats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+
+   if (!cache || !cache->mem.items)
+      return;
+
+   simple_mtx_lock(&cache->mem.mtx);
+   stats->hits = cache->mem.hits;
+   stats->misses = cache->mem.misses;
+   stats->size = cache->mem.size;
+   stats->max_size = cache->mem.max_size;
+   simple_mtx_unlock(&cache->mem.mtx);
+}
+
 #endif /* ENABLE_SHADER_CACHE */
@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <sys/stat.h>
 #include "util/mesa-sha1.h"
 
@@ -77,6 +78,16 @@ struct cache_item_metadata {
 
 struct disk_cache;
 
+/* Statistics of the in-memory tier of the cache, see
+ * MESA_SHADER_CACHE_MEM_MAX_SIZE.
+ */
+struct disk_cache_mem_stats {
+   uint64_t hits;
+   uint64_t misses;
+   uint64_t size;       /* bytes currently held */
+   uint64_t max_size;   /* 0 if the in-memory tier is disabled */
+};
+
 static inline char *
 disk_cache_format_hex_id(char *buf, const uint8_t *hex_id, unsigned size)
 {
@@ -275,6 +286,23 @@ void
 disk_cache_set_callbacks(struct disk_cache *cache, disk_cache_put_cb put,
                          disk_cache_get_cb get);
 
+/**
+ * Train a compression dictionary from the items currently in the cache and
+ * store it in the cache directory, unless one already exists. The
+ * dictionary is used by caches created for the same directory afterwards.
+ *
+ * \return true if a dictionary was stored.
+ */
+bool
+disk_cache_train_dictionary(struct disk_cache *cache);
+
+/**
+ * Return the hit/miss counters and current size of the in-memory tier.
+ */
+void
+disk_cache_get_mem_stats(struct disk_cache *cache,
+                         struct disk_cache_mem_stats *stats);
+
 #else
 
 static inline struct disk_cache *
@@ -343,6 +371,19 @@ disk_cache_set_callbacks(struct disk_cache *cache, disk_cache_put_cb put,
    return;
 }
 
+static inline bool
+disk_cache_train_dictionary(struct disk_cache *cache)
+{
+   return false;
+}
+
+static inline void
+disk_cache_get_mem_stats(struct disk_cache *cache,
+                         struct disk_cache_mem_stats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+}
+
 #endif /* ENABLE_SHADER_CACHE */
 
 #ifdef __cplusplus
@@ -62,8 +62,10 @@ struct cache_entry_file_data {
 #include "util/debug.h"
 #include "util/disk_cache.h"
 #include "util/disk_cache_os.h"
+#include "util/hash_table.h"
 #include "util/ralloc.h"
 #include "util/rand_xor.h"
+#include "util/u_dynarray.h"
 
 /* Create a directory named 'path' if it does not already exist.
  *
@@ -454,8 +456,308 @@ disk_cache_evict_item(struct disk_cache *cache, char *filename)
       p_atomic_add(cache->size, - (uint64_t)sb.st_blocks * 512);
 }
 
+/* A record in the LRU journal. Records are appended in access order so the
+ * last record of a key tells how recently it was used.
+ */
+struct journal_record {
+   cache_key key;
+   /* Size of the cache file in 512 byte blocks, or 0 for a record that only
+    * updates the access time of the key.
+    */
+   uint32_t blocks;
+};
+
+/* A key found in the journal, along with its most recent record. */
+struct journal_item {
+   const uint8_t *key;
+   uint32_t last;
+   uint32_t blocks;
+};
+
+static int
+journal_lock(int fd, bool exclusive)
+{
+#ifdef HAVE_FLOCK
+   return flock(fd, exclusive ? LOCK_EX : LOCK_SH);
+#else
+   struct flock lock = {
+      .l_start = 0,
+      .l_len = 0, /* entire file */
+      .l_type = exclusive ? F_WRLCK : F_RDLCK,
+      .l_whence = SEEK_SET
+   };
+   return fcntl(fd, F_SETLKW, &lock);
+#endif
+}
+
+static void
+journal_unlock(int fd)
+{
+#ifdef HAVE_FLOCK
+   flock(fd, LOCK_UN);
+#else
+   struct flock lock = {
+      .l_start = 0,
+      .l_len = 0, /* entire file */
+      .l_type = F_UNLCK,
+      .l_whence = SEEK_SET
+   };
+   fcntl(fd, F_SETLK, &lock);
+#endif
+}
+
+static uint32_t
+journal_key_hash(const void *key)
+{
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+journal_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, CACHE_KEY_SIZE) == 0;
+}
+
+static int
+journal_item_compare(const void *a, const void *b)
+{
+   const struct journal_item *ia = a, *ib = b;
+   return ia->last < ib->last ? -1 : ia->last > ib->last;
+}
+
+/* Open the journal. Returns true if the journal should be compacted. */
+bool
+disk_cache_open_journal(struct disk_cache *cache)
+{
+   char *path;
+   if (asprintf(&path, "%s/%s", cache->path, CACHE_JOURNAL_NAME) == -1)
+      return false;
+
+   /* Every process appends to the same file, O_APPEND keeps the small
+    * records from interleaving.
+    */
+   cache->journal_fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC,
+                            0644);
+   free(path);
+
+   if (cache->journal_fd == -1)
+      return false;
+
+   simple_mtx_init(&cache->journal_mtx, mtx_plain);
+
+   /* Hits keep appending records, so trim the journal once it has grown
+    * well beyond one record per item.
+    */
+   struct stat sb;
+   return fstat(cache->journal_fd, &sb) == 0 &&
+          sb.st_size > CACHE_JOURNAL_COMPACT_SIZE;
+}
+
+void
+disk_cache_close_journal(struct disk_cache *cache)
+{
+   if (cache->journal_fd == -1)
+      return;
+
+   simple_mtx_destroy(&cache->journal_mtx);
+   close(cache->journal_fd);
+   cache->journal_fd = -1;
+}
+
+void
+disk_cache_journal_append(struct disk_cache *cache, const cache_key key,
+                          uint32_t blocks)
+{
+   if (cache->journal_fd == -1)
+      return;
+
+   struct journal_record record = { .blocks = blocks };
+   memcpy(record.key, key, CACHE_KEY_SIZE);
+
+   /* Appending takes a shared lock so that it can't land in the middle of
+    * a compaction by another process. The file lock doesn't exclude threads
+    * sharing the fd, so compaction within the process is excluded by the
+    * mutex.
+    */
+   simple_mtx_lock(&cache->journal_mtx);
+   if (journal_lock(cache->journal_fd, false) == 0) {
+      write_all(cache->journal_fd, &record, sizeof(record));
+      journal_unlock(cache->journal_fd);
+   }
+   simple_mtx_unlock(&cache->journal_mtx);
+}
+
+/* Pick the least recently used keys from the journal until evicting them
+ * brings the cache down to target_size, and rewrite the journal with one
+ * record for each remaining key.  The most recently used key is never
+ * picked.
+ *
+ * Returns a malloc'ed array of the picked records, or NULL if there is
+ * nothing to evict.  On success, *count is the number of records.
+ */
+static struct journal_record *
+compact_journal(struct disk_cache *cache, uint64_t target_size,
+                unsigned *count, bool *tracks_cache)
+{
+   struct journal_record *records = NULL, *evict = NULL;
+   struct journal_item *items = NULL;
+   struct hash_table *ht = NULL;
+   int fd = cache->journal_fd;
+
+   *count = 0;
+   *tracks_cache = false;
+
+   simple_mtx_lock(&cache->journal_mtx);
+   if (journal_lock(fd, true) == -1) {
+      simple_mtx_unlock(&cache->journal_mtx);
+      return NULL;
+   }
+
+   struct stat sb;
+   if (fstat(fd, &sb) == -1)
+      goto done;
+
+   unsigned num_records = sb.st_size / sizeof(*records);
+   if (num_records == 0)
+      goto done;
+
+   records = malloc(num_records * sizeof(*records));
+   items = malloc(num_records * sizeof(*items));
+   ht = _mesa_hash_table_create(NULL, journal_key_hash, journal_key_equal);
+   if (!records || !items || !ht)
+      goto done;
+
+   if (pread(fd, records, num_records * sizeof(*records), 0) !=
+       (ssize_t)(num_records * sizeof(*records)))
+      goto done;
+
+   unsigned num_items = 0;
+   for (unsigned i = 0; i < num_records; i++) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search(ht, records[i].key);
+      struct journal_item *item;
+
+      if (entry) {
+         item = entry->data;
+      } else {
+         item = &items[num_items++];
+         item->key = records[i].key;
+         item->blocks = 0;
+         _mesa_hash_table_insert(ht, item->key, item);
+      }
+
+      item->last = i;
+      if (records[i].blocks)
+         item->blocks = records[i].blocks;
+   }
+
+   /* Keys without a known size got accessed but were put before the
+    * journal existed; look their size up now.
+    */
+   uint64_t tracked_size = 0;
+   for (unsigned i = 0; i < num_items; i++) {
+      if (!items[i].blocks) {
+         char *filename = disk_cache_get_cache_filename(cache, items[i].key);
+         if (filename && stat(filename, &sb) == 0)
+            items[i].blocks = sb.st_blocks;
+         free(filename);
+      }
+      tracked_size += (uint64_t)items[i].blocks * 512;
+   }
+
+   /* A journal that doesn't know about most of the cache, e.g. because
+    * the cache predates it, can't give a useful LRU order.
+    */
+   uint64_t cache_size = p_atomic_read(cache->size);
+   *tracks_cache = tracked_size >= cache_size / 2;
+
+   qsort(items, num_items, sizeof(*items), journal_item_compare);
+
+   evict = malloc(num_items * sizeof(*evict));
+   if (!evict)
+      goto done;
+
+   unsigned num_evict = 0;
+   while (*tracks_cache && num_evict + 1 < num_items &&
+          cache_size > target_size) {
+      const struct journal_item *item = &items[num_evict];
+
+      memcpy(evict[num_evict].key, item->key, CACHE_KEY_SIZE);
+      evict[num_evict].blocks = item->blocks;
+      cache_size -= MIN2(cache_size, (uint64_t)item->blocks * 512);
+      num_evict++;
+   }
+
+   /* Rewrite the journal in LRU order without the evicted keys. */
+   struct journal_record *compacted = malloc(num_items * sizeof(*compacted));
+   if (!compacted)
+      goto done;
+
+   for (unsigned i = num_evict; i < num_items; i++) {
+      memcpy(compacted[i - num_evict].key, items[i].key, CACHE_KEY_SIZE);
+      compacted[i - num_evict].blocks = items[i].blocks;
+   }
+
+   if (ftruncate(fd, 0) == 0)
+      write_all(fd, compacted, (num_items - num_evict) * sizeof(*compacted));
+   free(compacted);
+
+   *count = num_evict;
+
+done:
+   journal_unlock(fd);
+   simple_mtx_unlock(&cache->journal_mtx);
+
+   if (ht)
+      _mesa_hash_table_destroy(ht, NULL);
+   free(items);
+   free(records);
+
+   if (*count == 0) {
+      free(evict);
+      return NULL;
+   }
+
+   return evict;
+}
+
+/* Evict the least recently used items known to the journal until the cache
+ * is no larger than target_size.  Returns false if the journal doesn't
+ * track enough of the cache to be used, in which case the caller should
+ * fall back to disk_cache_evict_lru_item().
+ */
+bool
+disk_cache_evict_from_journal(struct disk_cache *cache, uint64_t target_size)
+{
+   if (cache->journal_fd == -1)
+      return false;
+
+   unsigned count;
+   bool tracks_cache;
+   struct journal_record *evict =
+      compact_journal(cache, target_size, &count, &tracks_cache);
+
+   /* The journal lock is released before unlinking so that puts in other
+    * processes don't wait on the file system.
+    */
+   for (unsigned i = 0; i < count; i++) {
+      char *filename = disk_cache_get_cache_filename(cache, evict[i].key);
+      if (filename == NULL)
+         continue;
+
+      if (unlink(filename) == 0)
+         p_atomic_add(cache->size, - (uint64_t)evict[i].blocks * 512);
+      free(filename);
+   }
+   free(evict);
+
+   return tracks_cache;
+}
+
 static void *
-parse_and_validate_cache_item(struct disk_cache *cache, void *cache_item,
+parse_and_validate_cache_item(struct disk_cache *cache, const void *cache_item,
                               size_t cache_item_size, size_t *size)
 {
    uint8_t *uncompressed_data = NULL;
@@ -511,8 +813,9 @@ parse_and_validate_cache_item(struct disk_cache *cache, void *cache_item,
 
    /* Uncompress the cache data */
    uncompressed_data = malloc(cf_data->uncompressed_size);
-   if (!util_compress_inflate(data, cache_data_size, uncompressed_data,
-                              cf_data->uncompressed_size))
+   if (!util_compress_inflate_dict(cache->dict, data, cache_data_size,
+                                   uncompressed_data,
+                                   cf_data->uncompressed_size))
       goto fail;
 
    if (size)
@@ -604,8 +907,8 @@ create_cache_item_header_and_blob(struct disk_cache_put_job *dc_job,
       return false;
 
    size_t compressed_size =
-      util_compress_deflate(dc_job->data, dc_job->size,
-                            compressed_data, max_buf);
+      util_compress_deflate_dict(dc_job->cache->dict, dc_job->data,
+                                 dc_job->size, compressed_data, max_buf);
    if (compressed_size == 0)
       goto fail;
 
@@ -751,6 +1054,7 @@ disk_cache_write_item_to_disk(struct disk_cache_put_job *dc_job,
    }
 
    p_atomic_add(dc_job->cache->size, sb.st_blocks * 512);
+   disk_cache_journal_append(dc_job->cache, dc_job->key, sb.st_blocks);
 
  done:
    if (fd_final != -1)
@@ -891,6 +1195,16 @@ disk_cache_load_item_foz(struct disk_cache *cache, const cache_key key,
                          size_t *size)
 {
    size_t cache_tem_size = 0;
+
+   /* Entries from mapped read only dbs can be inflated straight from the
+    * mapping without copying them first.
+    */
+   const void *mapped_item =
+      foz_read_entry_mapped(&cache->foz_db, key, &cache_tem_size);
+   if (mapped_item)
+      return parse_and_validate_cache_item(cache, mapped_item, cache_tem_size,
+                                           size);
+
    void *cache_item = foz_read_entry(&cache->foz_db, key, &cache_tem_size);
    if (!cache_item)
       return NULL;
@@ -988,6 +1302,202 @@ disk_cache_destroy_mmap(struct disk_cache *cache)
 {
    munmap(cache->index_mmap, cache->index_mmap_size);
 }
+
+/* zstd recommends a dictionary of around 100KB trained on about 100 times
+ * that amount of samples. Our items are smaller than what zstd expects so
+ * use a somewhat smaller dictionary.
+ */
+#define CACHE_DICT_MAX_SIZE (64 * 1024)
+#define CACHE_DICT_SAMPLES_SIZE (100 * CACHE_DICT_MAX_SIZE)
+
+/* Training on fewer samples than this doesn't give a useful dictionary. */
+#define CACHE_DICT_MIN_SAMPLES 32
+
+/* Load the dictionary stored in the cache directory, if there is one. */
+void
+disk_cache_load_dict(struct disk_cache *cache)
+{
+   char *filename;
+   if (asprintf(&filename, "%s/%s", cache->path, CACHE_DICT_NAME) == -1)
+      return;
+
+   int fd = open(filename, O_RDONLY | O_CLOEXEC);
+   free(filename);
+   if (fd == -1)
+      return;
+
+   struct stat sb;
+   if (fstat(fd, &sb) == 0 && sb.st_size > 0 &&
+       sb.st_size <= CACHE_DICT_MAX_SIZE) {
+      void *data = malloc(sb.st_size);
+      if (data && read_all(fd, data, sb.st_size) != -1)
+         cache->dict = util_compress_dict_create(data, sb.st_size);
+      free(data);
+   }
+
+   close(fd);
+}
+
+struct dict_samples {
+   struct blob data;               /* Uncompressed items back to back */
+   struct util_dynarray sizes;     /* size_t per item */
+};
+
+/* Takes ownership of data. Returns false once we have enough samples. */
+static bool
+add_dict_sample(struct dict_samples *samples, void *data, size_t size)
+{
+   if (data) {
+      if (blob_write_bytes(&samples->data, data, size))
+         util_dynarray_append(&samples->sizes, size_t, size);
+      free(data);
+   }
+
+   return !samples->data.out_of_memory &&
+          samples->data.size < CACHE_DICT_SAMPLES_SIZE;
+}
+
+static void
+collect_dict_samples(struct disk_cache *cache, struct dict_samples *samples)
+{
+   DIR *dir = opendir(cache->path);
+   if (!dir)
+      return;
+
+   bool want_more = true;
+   struct dirent *d;
+   while (want_more && (d = readdir(dir)) != NULL) {
+      if (strlen(d->d_name) != 2 || strcmp(d->d_name, "..") == 0)
+         continue;
+
+      char *subdir_path;
+      if (asprintf(&subdir_path, "%s/%s", cache->path, d->d_name) == -1)
+         break;
+
+      DIR *subdir = opendir(subdir_path);
+      if (!subdir) {
+         free(subdir_path);
+         continue;
+      }
+
+      struct dirent *f;
+      while (want_more && (f = readdir(subdir)) != NULL) {
+         size_t len = strlen(f->d_name);
+         if (f->d_name[0] == '.' ||
+             (len >= 4 && strcmp(&f->d_name[len - 4], ".tmp") == 0))
+            continue;
+
+         char *filename;
+         if (asprintf(&filename, "%s/%s", subdir_path, f->d_name) == -1)
+            break;
+
+         /* disk_cache_load_item() frees filename. */
+         size_t size = 0;
+         void *data = disk_cache_load_item(cache, filename, &size);
+         want_more = add_dict_sample(samples, data, size);
+      }
+
+      closedir(subdir);
+      free(subdir_path);
+   }
+
+   closedir(dir);
+}
+
+static void
+collect_dict_samples_foz(struct disk_cache *cache,
+                         struct dict_samples *samples)
+{
+   /* We can't know how big the items are before reading them, so assume
+    * they are at least 1KB when deciding how many keys to look at.
+    */
+   const unsigned max_keys = CACHE_DICT_SAMPLES_SIZE / 1024;
+   uint8_t (*keys)[20] = malloc(max_keys * sizeof(*keys));
+   if (!keys)
+      return;
+
+   unsigned num_keys = foz_get_keys(&cache->foz_db, keys, max_keys);
+   for (unsigned i = 0; i < num_keys; i++) {
+      size_t size = 0;
+      void *data = disk_cache_load_item_foz(cache, keys[i], &size);
+      if (!add_dict_sample(samples, data, size))
+         break;
+   }
+
+   free(keys);
+}
+
+/* Train a dictionary from the items currently in the cache and store it in
+ * the cache directory. It only gets used by caches created afterwards, as
+ * switching dictionaries under running writers isn't safe.
+ */
+bool
+disk_cache_train_dict(struct disk_cache *cache)
+{
+   struct dict_samples samples;
+   bool stored = false;
+   char *filename = NULL, *filename_tmp = NULL;
+   void *dict = NULL;
+   int fd = -1;
+
+   blob_init(&samples.data);
+   util_dynarray_init(&samples.sizes, NULL);
+
+   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      collect_dict_samples_foz(cache, &samples);
+   else
+      collect_dict_samples(cache, &samples);
+
+   unsigned num_samples = util_dynarray_num_elements(&samples.sizes, size_t);
+   if (num_samples < CACHE_DICT_MIN_SAMPLES)
+      goto done;
+
+   dict = malloc(CACHE_DICT_MAX_SIZE);
+   if (!dict)
+      goto done;
+
+   size_t dict_size =
+      util_compress_train_dict(samples.data.data, samples.sizes.data,
+                               num_samples, dict, CACHE_DICT_MAX_SIZE);
+   if (dict_size == 0)
+      goto done;
+
+   if (asprintf(&filename, "%s/%s", cache->path, CACHE_DICT_NAME) == -1) {
+      filename = NULL;
+      goto done;
+   }
+
+   if (asprintf(&filename_tmp, "%s.tmp", filename) == -1) {
+      filename_tmp = NULL;
+      goto done;
+   }
+
+   /* O_EXCL makes sure only one process writes the dictionary. Linking it
+    * into place makes sure no one ever sees a partially written dictionary
+    * and that we never replace one that is already in use, as items
+    * compressed with it couldn't be read anymore.
+    */
+   fd = open(filename_tmp, O_WRONLY | O_CLOEXEC | O_CREAT | O_EXCL, 0644);
+   if (fd == -1)
+      goto done;
+
+   if (write_all(fd, dict, dict_size) != -1 &&
+       link(filename_tmp, filename) == 0)
+      stored = true;
+
+   unlink(filename_tmp);
+
+done:
+   if (fd != -1)
+      close(fd);
+   free(filename_tmp);
+   free(filename);
+   free(dict);
+   util_dynarray_fini(&samples.sizes);
+   blob_finish(&samples.data);
+
+   return stored;
+}
 #endif
 
 #endif /* ENABLE_SHADER_CACHE */
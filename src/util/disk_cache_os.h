@@ -33,6 +33,18 @@
 #else
 
 #include "util/fossilize_db.h"
+#include "util/list.h"
+
+struct util_compress_dict;
+
+/* Name of the zstd dictionary file within the cache directory. */
+#define CACHE_DICT_NAME "zstd_dict"
+
+/* Name of the LRU journal file within the cache directory. */
+#define CACHE_JOURNAL_NAME "lru_journal"
+
+/* Journal size above which it gets compacted when a cache is created. */
+#define CACHE_JOURNAL_COMPACT_SIZE (4 * 1024 * 1024)
 
 /* Number of bits to mask off from a cache key to get an index. */
 #define CACHE_INDEX_KEY_BITS 16
@@ -53,6 +65,20 @@ struct disk_cache {
 
    struct foz_db foz_db;
 
+   /* Thread queue evicting old items once the cache grows too large, so
+    * that puts never wait for it.
+    */
+   struct util_queue evict_queue;
+   unsigned evict_pending;
+   uint64_t evict_room;
+
+   /* Append-only journal of puts and hits, shared by all processes using
+    * the cache directory. Eviction picks its victims from it instead of
+    * scanning the cache.
+    */
+   int journal_fd;
+   simple_mtx_t journal_mtx;
+
    /* Seed for rand, which is used to pick a random directory */
    uint64_t seed_xorshift128plus[2];
 
@@ -75,6 +101,33 @@ struct disk_cache {
 
    disk_cache_put_cb blob_put_cb;
    disk_cache_get_cb blob_get_cb;
+
+   /* Dictionary used to compress and decompress cache items, if one was
+    * trained for this cache.
+    */
+   struct util_compress_dict *dict;
+   struct util_queue_fence train_dict_fence;
+
+   /* In-memory tier holding recently used, uncompressed cache items. It is
+    * disabled when max_size is 0.
+    */
+   struct {
+      simple_mtx_t mtx;
+      struct hash_table *items;
+      struct list_head lru;          /* Most recently used first */
+      uint64_t size;
+      uint64_t max_size;
+      uint64_t hits;
+      uint64_t misses;
+   } mem;
+};
+
+/* An item in disk_cache::mem. */
+struct disk_cache_mem_item {
+   struct list_head link;
+   cache_key key;
+   size_t size;
+   uint8_t data[];
 };
 
 struct disk_cache_put_job {
@@ -103,6 +156,19 @@ disk_cache_evict_lru_item(struct disk_cache *cache);
 void
 disk_cache_evict_item(struct disk_cache *cache, char *filename);
 
+bool
+disk_cache_open_journal(struct disk_cache *cache);
+
+void
+disk_cache_close_journal(struct disk_cache *cache);
+
+void
+disk_cache_journal_append(struct disk_cache *cache, const cache_key key,
+                          uint32_t blocks);
+
+bool
+disk_cache_evict_from_journal(struct disk_cache *cache, uint64_t target_size);
+
 void *
 disk_cache_load_item_foz(struct disk_cache *cache, const cache_key key,
                          size_t *size);
@@ -133,6 +199,12 @@ disk_cache_mmap_cache_index(void *mem_ctx, struct disk_cache *cache,
 void
 disk_cache_destroy_mmap(struct disk_cache *cache);
 
+void
+disk_cache_load_dict(struct disk_cache *cache);
+
+bool
+disk_cache_train_dict(struct disk_cache *cache);
+
 #endif
 
 #endif /* DISK_CACHE_OS_H */
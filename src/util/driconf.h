@@ -353,6 +353,10 @@
    DRI_CONF_OPT_B(adaptive_sync,def, \
                   "Adapt the monitor sync to the application performance (when possible)")
 
+#define DRI_CONF_DRI3_MAX_BACK(def) \
+   DRI_CONF_OPT_I(dri3_max_back, def, 0, 4, \
+                  "Maximum number of back buffers of a flipped DRI3 window (0 = automatic)")
+
 #define DRI_CONF_VK_WSI_FORCE_BGRA8_UNORM_FIRST(def) \
    DRI_CONF_OPT_B(vk_wsi_force_bgra8_unorm_first, def, \
                   "Force vkGetPhysicalDeviceSurfaceFormatsKHR to return VK_FORMAT_B8G8R8A8_UNORM as the first format")
@@ -51,11 +51,114 @@ util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_neon(uint8_t *restrict dst, const
       util_format_b8g8r8a8_unorm_unpack_rgba_8unorm(dst, src, width);
 }
 
+/* Same as ubyte_to_float() on the bytes of four pixels. */
+static inline void
+unpack_4_rgba8_float(float *restrict dst, uint8x16_t pixels)
+{
+   const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
+   uint16x8_t lo = vmovl_u8(vget_low_u8(pixels));
+   uint16x8_t hi = vmovl_u8(vget_high_u8(pixels));
+
+   vst1q_f32(dst + 0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), scale));
+   vst1q_f32(dst + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+   vst1q_f32(dst + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), scale));
+   vst1q_f32(dst + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+}
+
+static void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_neon(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 4; width -= 4, src += 16, dst += 16)
+      unpack_4_rgba8_float(dst, vld1q_u8(src));
+
+   if (width)
+      util_format_r8g8b8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+static void
+util_format_b8g8r8a8_unorm_unpack_rgba_float_neon(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 4; width -= 4, src += 16, dst += 16) {
+      /* Swap B and R by reversing each pixel and rotating A back. */
+      uint32x4_t pixels = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(src)));
+      pixels = vorrq_u32(vshrq_n_u32(pixels, 8), vshlq_n_u32(pixels, 24));
+      unpack_4_rgba8_float(dst, vreinterpretq_u8_u32(pixels));
+   }
+
+   if (width)
+      util_format_b8g8r8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+/* Same as float_to_ubyte() on four floats, leaving the result in the low
+ * byte of each lane.
+ */
+static inline uint32x4_t
+float_to_ubyte_4(float32x4_t f)
+{
+   /* The comparison is false for NaN, which maps NaN to 0 like the scalar
+    * code does.
+    */
+   uint32x4_t positive = vcgtq_f32(f, vdupq_n_f32(0.0f));
+
+   f = vminq_f32(f, vdupq_n_f32(1.0f));
+   f = vaddq_f32(vmulq_f32(f, vdupq_n_f32(255.0f / 256.0f)),
+                 vdupq_n_f32(32768.0f));
+
+   return vandq_u32(vandq_u32(vreinterpretq_u32_f32(f), positive),
+                    vdupq_n_u32(0xff));
+}
+
+static void
+util_format_r32g32b32a32_float_unpack_rgba_8unorm_neon(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   for (; width >= 4; width -= 4, src += 64, dst += 16) {
+      const float *f = (const float *)src;
+      uint16x8_t lo = vcombine_u16(vmovn_u32(float_to_ubyte_4(vld1q_f32(f + 0))),
+                                   vmovn_u32(float_to_ubyte_4(vld1q_f32(f + 4))));
+      uint16x8_t hi = vcombine_u16(vmovn_u32(float_to_ubyte_4(vld1q_f32(f + 8))),
+                                   vmovn_u32(float_to_ubyte_4(vld1q_f32(f + 12))));
+      vst1q_u8(dst, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+   }
+
+   if (width)
+      util_format_r32g32b32a32_float_unpack_rgba_8unorm(dst, src, width);
+}
+
+#ifdef PIPE_ARCH_AARCH64
+/* Half float conversion is only guaranteed on arm64. */
+static void
+util_format_r16g16b16a16_float_unpack_rgba_float_neon(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 1; width -= 1, src += 8, dst += 4)
+      vst1q_f32(dst, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16((const uint16_t *)src))));
+}
+#endif
+
 static const struct util_format_unpack_description util_format_unpack_descriptions_neon[] = {
+   [PIPE_FORMAT_R8G8B8A8_UNORM] = {
+      .unpack_rgba_8unorm = &util_format_r8g8b8a8_unorm_unpack_rgba_8unorm,
+      .unpack_rgba = &util_format_r8g8b8a8_unorm_unpack_rgba_float_neon,
+   },
    [PIPE_FORMAT_B8G8R8A8_UNORM] = {
       .unpack_rgba_8unorm = &util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_neon,
-      .unpack_rgba = &util_format_b8g8r8a8_unorm_unpack_rgba_float,
+      .unpack_rgba = &util_format_b8g8r8a8_unorm_unpack_rgba_float_neon,
+   },
+   [PIPE_FORMAT_R32G32B32A32_FLOAT] = {
+      .unpack_rgba_8unorm = &util_format_r32g32b32a32_float_unpack_rgba_8unorm_neon,
+      .unpack_rgba = &util_format_r32g32b32a32_float_unpack_rgba_float,
    },
+#ifdef PIPE_ARCH_AARCH64
+   [PIPE_FORMAT_R16G16B16A16_FLOAT] = {
+      .unpack_rgba_8unorm = &util_format_r16g16b16a16_float_unpack_rgba_8unorm,
+      .unpack_rgba = &util_format_r16g16b16a16_float_unpack_rgba_float_neon,
+   },
+#endif
 };
 
 const struct util_format_unpack_description *
@@ -0,0 +1,338 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <u_format.h>
+
+#if (defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64)) && defined(__GNUC__) && !defined(NO_FORMAT_ASM)
+
+#include <immintrin.h>
+#include "c11/threads.h"
+#include "u_format_other.h"
+#include "u_format_pack.h"
+#include "util/format_srgb.h"
+#include "util/u_cpu_detect.h"
+
+/* The kernels below are built with target attributes rather than build
+ * flags, and each one only handles whole vectors, leaving the rest of the
+ * row to the generic code.  They produce exactly the same results as the
+ * generic code.
+ */
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define F16C_TARGET __attribute__((target("avx,f16c")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/* Same as ubyte_to_float() on each byte of four pixels. */
+SSE2_TARGET static inline void
+unpack_4_rgba8_float(float *restrict dst, __m128i pixels)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+   __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+   __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+
+   _mm_storeu_ps(dst + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+   _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+   _mm_storeu_ps(dst + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+   _mm_storeu_ps(dst + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+}
+
+/* Swaps the first and third byte of each pixel. */
+SSE2_TARGET static inline __m128i
+swap_rb_8888(__m128i pixels)
+{
+   const __m128i ga = _mm_set1_epi32(0xff00ff00);
+   const __m128i low = _mm_set1_epi32(0xff);
+
+   return _mm_or_si128(_mm_and_si128(pixels, ga),
+                       _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 16), low),
+                                    _mm_slli_epi32(_mm_and_si128(pixels, low), 16)));
+}
+
+/* Same as float_to_ubyte() on 16 floats, packed to 16 bytes. */
+SSE2_TARGET static inline __m128i
+float_to_ubyte_16(const float *restrict src)
+{
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 scale = _mm_set1_ps(255.0f / 256.0f);
+   const __m128 bias = _mm_set1_ps(32768.0f);
+   const __m128i low = _mm_set1_epi32(0xff);
+   __m128i v[4];
+
+   for (unsigned i = 0; i < 4; i++) {
+      /* max() returns its second operand for NaN, which maps NaN to 0. */
+      __m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), zero), one);
+      f = _mm_add_ps(_mm_mul_ps(f, scale), bias);
+      v[i] = _mm_and_si128(_mm_castps_si128(f), low);
+   }
+
+   return _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]),
+                           _mm_packs_epi32(v[2], v[3]));
+}
+
+SSE2_TARGET static void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_sse2(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 4; width -= 4, src += 16, dst += 16)
+      unpack_4_rgba8_float(dst, _mm_loadu_si128((const __m128i *)src));
+
+   if (width)
+      util_format_r8g8b8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+SSE2_TARGET static void
+util_format_b8g8r8a8_unorm_unpack_rgba_float_sse2(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 4; width -= 4, src += 16, dst += 16)
+      unpack_4_rgba8_float(dst, swap_rb_8888(_mm_loadu_si128((const __m128i *)src)));
+
+   if (width)
+      util_format_b8g8r8a8_unorm_unpack_rgba_float(dst, src, width);
+}
+
+SSE2_TARGET static void
+util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_sse2(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   for (; width >= 4; width -= 4, src += 16, dst += 16) {
+      _mm_storeu_si128((__m128i *)dst,
+                       swap_rb_8888(_mm_loadu_si128((const __m128i *)src)));
+   }
+
+   if (width)
+      util_format_b8g8r8a8_unorm_unpack_rgba_8unorm(dst, src, width);
+}
+
+SSE2_TARGET static void
+util_format_r32g32b32a32_float_unpack_rgba_8unorm_sse2(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   for (; width >= 4; width -= 4, src += 64, dst += 16)
+      _mm_storeu_si128((__m128i *)dst, float_to_ubyte_16((const float *)src));
+
+   if (width)
+      util_format_r32g32b32a32_float_unpack_rgba_8unorm(dst, src, width);
+}
+
+/* Same as uf11_to_f32()/uf10_to_f32() on the channel of four pixels that
+ * starts at bit shift, for mantissa_bits 6 and 5 respectively.
+ */
+SSE2_TARGET static inline __m128
+unpack_4_ufloat(__m128i pixels, unsigned shift, unsigned mantissa_bits)
+{
+   const __m128i value = _mm_and_si128(_mm_srli_epi32(pixels, shift),
+                                       _mm_set1_epi32((1 << (mantissa_bits + 5)) - 1));
+   const __m128i mantissa = _mm_and_si128(value, _mm_set1_epi32((1 << mantissa_bits) - 1));
+   const __m128i exponent = _mm_srli_epi32(value, mantissa_bits);
+
+   /* Normal values only need the exponent rebiased from 15 to 127. */
+   __m128i normal = _mm_add_epi32(_mm_slli_epi32(value, 23 - mantissa_bits),
+                                  _mm_set1_epi32((127 - 15) << 23));
+
+   /* Denormals are converted from the mantissa, rather than with the bias
+    * trick, so that they don't depend on the denormal mode.
+    */
+   __m128i denorm = _mm_castps_si128(
+      _mm_mul_ps(_mm_cvtepi32_ps(mantissa),
+                 _mm_set1_ps(1.0f / (1 << (14 + mantissa_bits)))));
+
+   __m128i special = _mm_or_si128(mantissa, _mm_set1_epi32(0x7f800000));
+
+   __m128i is_denorm = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+   __m128i is_special = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(31));
+
+   __m128i result = _mm_or_si128(_mm_and_si128(is_denorm, denorm),
+                                 _mm_andnot_si128(is_denorm, normal));
+   result = _mm_or_si128(_mm_and_si128(is_special, special),
+                         _mm_andnot_si128(is_special, result));
+
+   return _mm_castsi128_ps(result);
+}
+
+SSE2_TARGET static void
+util_format_r11g11b10_float_unpack_rgba_float_sse2(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 4; width -= 4, src += 16, dst += 16) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+      __m128 r = unpack_4_ufloat(pixels, 0, 6);
+      __m128 g = unpack_4_ufloat(pixels, 11, 6);
+      __m128 b = unpack_4_ufloat(pixels, 22, 5);
+      __m128 a = _mm_set1_ps(1.0f);
+
+      _MM_TRANSPOSE4_PS(r, g, b, a);
+      _mm_storeu_ps(dst + 0, r);
+      _mm_storeu_ps(dst + 4, g);
+      _mm_storeu_ps(dst + 8, b);
+      _mm_storeu_ps(dst + 12, a);
+   }
+
+   if (width)
+      util_format_r11g11b10_float_unpack_rgba_float(dst, src, width);
+}
+
+F16C_TARGET static void
+util_format_r16g16b16a16_float_unpack_rgba_float_f16c(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 2; width -= 2, src += 16, dst += 8) {
+      __m128i halfs = _mm_loadu_si128((const __m128i *)src);
+      _mm256_storeu_ps(dst, _mm256_cvtph_ps(halfs));
+   }
+
+   if (width)
+      util_format_r16g16b16a16_float_unpack_rgba_float(dst, src, width);
+}
+
+F16C_TARGET static void
+util_format_r16g16b16a16_float_unpack_rgba_8unorm_f16c(uint8_t *restrict dst, const uint8_t *restrict src, unsigned width)
+{
+   float tmp[16];
+
+   for (; width >= 4; width -= 4, src += 32, dst += 16) {
+      _mm256_storeu_ps(tmp, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)src)));
+      _mm256_storeu_ps(tmp + 8, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + 16))));
+      _mm_storeu_si128((__m128i *)dst, float_to_ubyte_16(tmp));
+   }
+
+   if (width)
+      util_format_r16g16b16a16_float_unpack_rgba_8unorm(dst, src, width);
+}
+
+/* Converts the R, G and B bytes of eight pixels through the sRGB table and
+ * the A byte like ubyte_to_float().
+ */
+AVX2_TARGET static inline void
+unpack_8_srgba8_float(float *restrict dst, __m256i pixels)
+{
+   const __m256i byte = _mm256_set1_epi32(0xff);
+   const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+   __m256 c[4];
+
+   for (unsigned i = 0; i < 3; i++) {
+      __m256i index = _mm256_and_si256(_mm256_srli_epi32(pixels, i * 8), byte);
+      c[i] = _mm256_i32gather_ps(util_format_srgb_8unorm_to_linear_float_table,
+                                 index, 4);
+   }
+   c[3] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(pixels, 24)), scale);
+
+   /* Interleave the channels back into pixels. */
+   __m256 rg_lo = _mm256_unpacklo_ps(c[0], c[1]);
+   __m256 rg_hi = _mm256_unpackhi_ps(c[0], c[1]);
+   __m256 ba_lo = _mm256_unpacklo_ps(c[2], c[3]);
+   __m256 ba_hi = _mm256_unpackhi_ps(c[2], c[3]);
+   __m256 p0 = _mm256_shuffle_ps(rg_lo, ba_lo, _MM_SHUFFLE(1, 0, 1, 0));
+   __m256 p1 = _mm256_shuffle_ps(rg_lo, ba_lo, _MM_SHUFFLE(3, 2, 3, 2));
+   __m256 p2 = _mm256_shuffle_ps(rg_hi, ba_hi, _MM_SHUFFLE(1, 0, 1, 0));
+   __m256 p3 = _mm256_shuffle_ps(rg_hi, ba_hi, _MM_SHUFFLE(3, 2, 3, 2));
+
+   _mm256_storeu_ps(dst + 0, _mm256_permute2f128_ps(p0, p1, 0x20));
+   _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(p2, p3, 0x20));
+   _mm256_storeu_ps(dst + 16, _mm256_permute2f128_ps(p0, p1, 0x31));
+   _mm256_storeu_ps(dst + 24, _mm256_permute2f128_ps(p2, p3, 0x31));
+}
+
+AVX2_TARGET static void
+util_format_r8g8b8a8_srgb_unpack_rgba_float_avx2(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   float *dst = dst_row;
+
+   for (; width >= 8; width -= 8, src += 32, dst += 32)
+      unpack_8_srgba8_float(dst, _mm256_loadu_si256((const __m256i *)src));
+
+   if (width)
+      util_format_r8g8b8a8_srgb_unpack_rgba_float(dst, src, width);
+}
+
+AVX2_TARGET static void
+util_format_b8g8r8a8_srgb_unpack_rgba_float_avx2(void *restrict dst_row, const uint8_t *restrict src, unsigned width)
+{
+   const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15,
+                                         2, 1, 0, 3, 6, 5, 4, 7,
+                                         10, 9, 8, 11, 14, 13, 12, 15);
+   float *dst = dst_row;
+
+   for (; width >= 8; width -= 8, src += 32, dst += 32) {
+      __m256i pixels = _mm256_loadu_si256((const __m256i *)src);
+      unpack_8_srgba8_float(dst, _mm256_shuffle_epi8(pixels, swap));
+   }
+
+   if (width)
+      util_format_b8g8r8a8_srgb_unpack_rgba_float(dst, src, width);
+}
+
+static struct util_format_unpack_description util_format_unpack_descriptions_x86[PIPE_FORMAT_COUNT];
+
+#define OVERRIDE(format, member, func) do {                                  \
+   struct util_format_unpack_description *desc =                             \
+      &util_format_unpack_descriptions_x86[PIPE_FORMAT_##format];            \
+   if (!desc->unpack_rgba)                                                   \
+      *desc = *util_format_unpack_description_generic(PIPE_FORMAT_##format); \
+   desc->member = func;                                                      \
+} while (0)
+
+static void
+util_format_unpack_descriptions_x86_init(void)
+{
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+
+   if (caps->has_sse2) {
+      OVERRIDE(R8G8B8A8_UNORM, unpack_rgba, &util_format_r8g8b8a8_unorm_unpack_rgba_float_sse2);
+      OVERRIDE(B8G8R8A8_UNORM, unpack_rgba, &util_format_b8g8r8a8_unorm_unpack_rgba_float_sse2);
+      OVERRIDE(B8G8R8A8_UNORM, unpack_rgba_8unorm, &util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_sse2);
+      OVERRIDE(R32G32B32A32_FLOAT, unpack_rgba_8unorm, &util_format_r32g32b32a32_float_unpack_rgba_8unorm_sse2);
+      OVERRIDE(R11G11B10_FLOAT, unpack_rgba, &util_format_r11g11b10_float_unpack_rgba_float_sse2);
+   }
+
+   if (caps->has_f16c) {
+      OVERRIDE(R16G16B16A16_FLOAT, unpack_rgba, &util_format_r16g16b16a16_float_unpack_rgba_float_f16c);
+      OVERRIDE(R16G16B16A16_FLOAT, unpack_rgba_8unorm, &util_format_r16g16b16a16_float_unpack_rgba_8unorm_f16c);
+   }
+
+   if (caps->has_avx2) {
+      OVERRIDE(R8G8B8A8_SRGB, unpack_rgba, &util_format_r8g8b8a8_srgb_unpack_rgba_float_avx2);
+      OVERRIDE(B8G8R8A8_SRGB, unpack_rgba, &util_format_b8g8r8a8_srgb_unpack_rgba_float_avx2);
+   }
+}
+
+#undef OVERRIDE
+
+const struct util_format_unpack_description *
+util_format_unpack_description_x86(enum pipe_format format)
+{
+   static once_flag flag = ONCE_FLAG_INIT;
+   call_once(&flag, util_format_unpack_descriptions_x86_init);
+
+   if (!util_format_unpack_descriptions_x86[format].unpack_rgba)
+      return NULL;
+
+   return &util_format_unpack_descriptions_x86[format];
+}
+
+#endif /* PIPE_ARCH_X86 | PIPE_ARCH_X86_64 */
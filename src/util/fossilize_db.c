@@ -37,10 +37,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include "crc32.h"
+#include "debug.h"
 #include "hash_table.h"
 #include "mesa-sha1.h"
 #include "ralloc.h"
@@ -170,7 +173,12 @@ update_foz_index(struct foz_db *foz_db, FILE *db_idx, unsigned file_idx)
 
       entry->offset = cache_offset;
 
-      _mesa_hash_table_u64_insert(foz_db->index_db, key, entry);
+      /* Read only dbs go into their own table, which is never modified once
+       * foz_prepare() returns.
+       */
+      _mesa_hash_table_u64_insert(file_idx == 0 ? foz_db->index_db :
+                                                  foz_db->ro_index_db,
+                                  key, entry);
    }
 
 
@@ -261,6 +269,27 @@ fail:
    return false;
 }
 
+/* Map a read only foz db into memory so that entries can be read from it
+ * without seeking the shared FILE under the mutex. If this fails we simply
+ * fall back to regular file reads for this db.
+ */
+static void
+map_foz_db(struct foz_db *foz_db, uint8_t file_idx)
+{
+   int fd = fileno(foz_db->file[file_idx]);
+
+   struct stat sb;
+   if (fstat(fd, &sb) == -1 || sb.st_size == 0)
+      return;
+
+   void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   if (map == MAP_FAILED)
+      return;
+
+   foz_db->mapped[file_idx] = map;
+   foz_db->mapped_size[file_idx] = sb.st_size;
+}
+
 /* Here we open mesa cache foz dbs files. If the files exist we load the index
  * db into a hash table. The index db contains the offsets needed to later
  * read cache entries from the foz db containing the actual cache entries.
@@ -289,6 +318,7 @@ foz_prepare(struct foz_db *foz_db, char *cache_path)
    simple_mtx_init(&foz_db->flock_mtx, mtx_plain);
    foz_db->mem_ctx = ralloc_context(NULL);
    foz_db->index_db = _mesa_hash_table_u64_create(NULL);
+   foz_db->ro_index_db = _mesa_hash_table_u64_create(NULL);
 
    if (!load_foz_dbs(foz_db, foz_db->db_idx, 0, false))
       return false;
@@ -298,6 +328,9 @@ foz_prepare(struct foz_db *foz_db, char *cache_path)
    if (!foz_dbs)
       return true;
 
+   bool map_ro_dbs =
+      env_var_as_boolean("MESA_DISK_CACHE_READ_ONLY_FOZ_DBS_MMAP", false);
+
    for (unsigned n; n = strcspn(foz_dbs, ","), *foz_dbs;
         foz_dbs += MAX2(1, n)) {
       char *foz_db_filename = strndup(foz_dbs, n);
@@ -331,6 +364,10 @@ foz_prepare(struct foz_db *foz_db, char *cache_path)
       }
 
       fclose(db_idx);
+
+      if (map_ro_dbs)
+         map_foz_db(foz_db, file_idx);
+
       file_idx++;
 
       if (file_idx >= FOZ_MAX_DBS)
@@ -346,11 +383,16 @@ foz_destroy(struct foz_db *foz_db)
    if (foz_db->db_idx)
       fclose(foz_db->db_idx);
    for (unsigned i = 0; i < FOZ_MAX_DBS; i++) {
+      if (foz_db->mapped[i]) {
+         munmap((void *)foz_db->mapped[i], foz_db->mapped_size[i]);
+         foz_db->mapped[i] = NULL;
+      }
       if (foz_db->file[i])
          fclose(foz_db->file[i]);
    }
 
    if (foz_db->mem_ctx) {
+      _mesa_hash_table_u64_destroy(foz_db->ro_index_db);
       _mesa_hash_table_u64_destroy(foz_db->index_db);
       ralloc_free(foz_db->mem_ctx);
       simple_mtx_destroy(&foz_db->flock_mtx);
@@ -358,6 +400,48 @@ foz_destroy(struct foz_db *foz_db)
    }
 }
 
+/* Validate an entry of a mapped read only db and return a pointer to its
+ * payload within the mapping. The entry itself is shared between threads so
+ * we must not write to it here.
+ */
+static const void *
+read_mapped_entry(struct foz_db *foz_db, struct foz_db_entry *entry,
+                  const uint8_t *cache_key_160bit, size_t *size)
+{
+   const uint8_t *map = foz_db->mapped[entry->file_idx];
+   size_t map_size = foz_db->mapped_size[entry->file_idx];
+   struct foz_payload_header header;
+
+   /* Check for collision using full 160bit hash for increased assurance
+    * against potential collisions.
+    */
+   if (memcmp(cache_key_160bit, entry->key, 20) != 0)
+      return NULL;
+
+   if (entry->offset > map_size ||
+       map_size - entry->offset < sizeof(header))
+      return NULL;
+
+   memcpy(&header, map + entry->offset, sizeof(header));
+
+   uint64_t data_offset = entry->offset + sizeof(header);
+   if (header.payload_size > map_size - data_offset)
+      return NULL;
+
+   const uint8_t *data = map + data_offset;
+
+   /* verify checksum */
+   if (header.crc != 0) {
+      if (util_hash_crc32(data, header.payload_size) != header.crc)
+         return NULL;
+   }
+
+   if (size)
+      *size = header.payload_size;
+
+   return data;
+}
+
 /* Here we lookup a cache entry in the index hash table. If an entry is found
  * we use the retrieved offset to read the cache entry from disk.
  */
@@ -372,10 +456,34 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    if (!foz_db->alive)
       return NULL;
 
+   /* The read only index is immutable, so it can be searched without the
+    * lock. Entries in mapped dbs don't need the lock to be read either.
+    */
+   struct foz_db_entry *entry =
+      _mesa_hash_table_u64_search(foz_db->ro_index_db, hash);
+   if (entry && foz_db->mapped[entry->file_idx]) {
+      size_t data_sz;
+      const void *mapped_data =
+         read_mapped_entry(foz_db, entry, cache_key_160bit, &data_sz);
+      if (!mapped_data)
+         return NULL;
+
+      data = malloc(data_sz);
+      if (!data)
+         return NULL;
+
+      memcpy(data, mapped_data, data_sz);
+
+      if (size)
+         *size = data_sz;
+
+      return data;
+   }
+
    simple_mtx_lock(&foz_db->mtx);
 
-   struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
+   if (!entry)
+      entry = _mesa_hash_table_u64_search(foz_db->index_db, hash);
    if (!entry) {
       update_foz_index(foz_db, foz_db->db_idx, 0);
       entry = _mesa_hash_table_u64_search(foz_db->index_db, hash);
@@ -429,6 +537,64 @@ fail:
    return NULL;
 }
 
+/* Like foz_read_entry() but only succeeds for entries stored in a mapped read
+ * only db. No lock is taken and no copy is made: the returned pointer points
+ * into the mapping, must not be freed by the caller and stays valid until
+ * foz_destroy().
+ */
+const void *
+foz_read_entry_mapped(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
+                      size_t *size)
+{
+   if (!foz_db->alive)
+      return NULL;
+
+   uint64_t hash = truncate_hash_to_64bits(cache_key_160bit);
+   struct foz_db_entry *entry =
+      _mesa_hash_table_u64_search(foz_db->ro_index_db, hash);
+   if (!entry || !foz_db->mapped[entry->file_idx])
+      return NULL;
+
+   return read_mapped_entry(foz_db, entry, cache_key_160bit, size);
+}
+
+static unsigned
+copy_index_keys(struct hash_table_u64 *index, uint8_t (*keys)[20],
+                unsigned num_keys, unsigned max_keys)
+{
+   hash_table_foreach(index->table, he) {
+      if (num_keys >= max_keys)
+         break;
+
+      struct foz_db_entry *entry = he->data;
+      memcpy(keys[num_keys++], entry->key, 20);
+   }
+
+   return num_keys;
+}
+
+/* Copy the full 160bit keys of up to max_keys entries of all dbs into keys
+ * and return how many were copied. This lets callers walk the db without
+ * holding any lock while they read the entries.
+ */
+unsigned
+foz_get_keys(struct foz_db *foz_db, uint8_t (*keys)[20], unsigned max_keys)
+{
+   if (!foz_db->alive)
+      return 0;
+
+   simple_mtx_lock(&foz_db->mtx);
+
+   update_foz_index(foz_db, foz_db->db_idx, 0);
+
+   unsigned num_keys = copy_index_keys(foz_db->index_db, keys, 0, max_keys);
+   num_keys = copy_index_keys(foz_db->ro_index_db, keys, num_keys, max_keys);
+
+   simple_mtx_unlock(&foz_db->mtx);
+
+   return num_keys;
+}
+
 /* Here we write the cache entry to disk and store its offset in the index db.
  */
 bool
@@ -456,7 +622,9 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    update_foz_index(foz_db, foz_db->db_idx, 0);
 
    struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
+      _mesa_hash_table_u64_search(foz_db->ro_index_db, hash);
+   if (!entry)
+      entry = _mesa_hash_table_u64_search(foz_db->index_db, hash);
    if (entry) {
       simple_mtx_unlock(&foz_db->mtx);
       flock(fileno(foz_db->file[0]), LOCK_UN);
@@ -557,6 +725,19 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    return false;
 }
 
+const void *
+foz_read_entry_mapped(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
+                      size_t *size)
+{
+   return NULL;
+}
+
+unsigned
+foz_get_keys(struct foz_db *foz_db, uint8_t (*keys)[20], unsigned max_keys)
+{
+   return 0;
+}
+
 bool
 foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
                 const void *blob, size_t size)
@@ -78,7 +78,21 @@ struct foz_db {
    simple_mtx_t mtx;                 /* Mutex for file/hash table read/writes */
    simple_mtx_t flock_mtx;           /* Mutex for flocking the file for writes */
    void *mem_ctx;
-   struct hash_table_u64 *index_db;  /* Hash table of all foz db entries */
+   struct hash_table_u64 *index_db;  /* Hash table of default foz db entries */
+
+   /* Hash table of the read only foz db entries. This is filled in by
+    * foz_prepare() and never modified afterwards, so it may be searched
+    * without holding mtx.
+    */
+   struct hash_table_u64 *ro_index_db;
+
+   /* Read only foz dbs mapped into memory when
+    * MESA_DISK_CACHE_READ_ONLY_FOZ_DBS_MMAP is set. Entries living in a
+    * mapped db are read without taking mtx.
+    */
+   const uint8_t *mapped[FOZ_MAX_DBS];
+   size_t mapped_size[FOZ_MAX_DBS];
+
    bool alive;
 };
 
@@ -92,6 +106,13 @@ void *
 foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
                size_t *size);
 
+const void *
+foz_read_entry_mapped(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
+                      size_t *size);
+
+unsigned
+foz_get_keys(struct foz_db *foz_db, uint8_t (*keys)[20], unsigned max_keys);
+
 bool
 foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
                 const void *blob, size_t size);
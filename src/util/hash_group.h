@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Helpers for the "grouped" layout of struct hash_table and struct set.
+ *
+ * Next to the entries, a grouped table keeps one control byte per slot that
+ * is either HASH_CTRL_EMPTY, HASH_CTRL_DELETED, or 7 bits of the hash of
+ * the entry stored in the slot. Lookups compare the control bytes of
+ * a whole group of HASH_GROUP_SIZE slots at once, and only touch the entries
+ * whose control byte matches, instead of every entry along the probe
+ * sequence.
+ *
+ * Tables are a power of two number of slots, and probe groups with
+ * triangular numbers, which visits every group once.
+ */
+
+#ifndef HASH_GROUP_H
+#define HASH_GROUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || (defined(_M_X64) && !defined(_M_ARM64EC))
+#include <emmintrin.h>
+#define HASH_GROUP_USE_SSE2
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define HASH_GROUP_USE_NEON
+#endif
+
+#define HASH_GROUP_SIZE 16
+
+/* Sizes go from HASH_GROUP_SIZE to 2^31 slots. */
+#define HASH_GROUP_NUM_SIZES 28
+
+/* A slot that was never used, which ends probe sequences. */
+#define HASH_CTRL_EMPTY 0x80
+/* A slot whose entry was removed, which probe sequences continue past. */
+#define HASH_CTRL_DELETED 0xfe
+
+static inline uint32_t
+hash_group_table_size(unsigned size_index)
+{
+   return HASH_GROUP_SIZE << size_index;
+}
+
+/* Keep the load factor below 7/8. */
+static inline uint32_t
+hash_group_max_entries(unsigned size_index)
+{
+   uint32_t size = hash_group_table_size(size_index);
+   return size - size / 8;
+}
+
+#ifdef HASH_GROUP_USE_NEON
+static inline uint32_t
+hash_group_neon_mask(uint8x16_t cmp)
+{
+   static const uint8_t bits[16] = {
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128,
+   };
+   uint8x16_t m = vandq_u8(cmp, vld1q_u8(bits));
+   return vaddv_u8(vget_low_u8(m)) | (vaddv_u8(vget_high_u8(m)) << 8);
+}
+#endif
+
+/* Returns the mask of the slots of the group whose control byte is ctrl. */
+static inline uint32_t
+hash_group_match(const uint8_t *group, uint8_t ctrl)
+{
+#if defined(HASH_GROUP_USE_SSE2)
+   __m128i g = _mm_loadu_si128((const __m128i *)group);
+   return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(ctrl)));
+#elif defined(HASH_GROUP_USE_NEON)
+   return hash_group_neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(ctrl)));
+#else
+   uint32_t mask = 0;
+   for (unsigned i = 0; i < HASH_GROUP_SIZE; i++)
+      mask |= (uint32_t)(group[i] == ctrl) << i;
+   return mask;
+#endif
+}
+
+/* Returns the mask of the slots of the group that are empty or deleted. */
+static inline uint32_t
+hash_group_match_free(const uint8_t *group)
+{
+#if defined(HASH_GROUP_USE_SSE2)
+   return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#elif defined(HASH_GROUP_USE_NEON)
+   return hash_group_neon_mask(vtstq_u8(vld1q_u8(group), vdupq_n_u8(0x80)));
+#else
+   uint32_t mask = 0;
+   for (unsigned i = 0; i < HASH_GROUP_SIZE; i++)
+      mask |= (uint32_t)(group[i] >> 7) << i;
+   return mask;
+#endif
+}
+
+struct hash_group_probe {
+   uint32_t mask;
+   uint32_t pos;
+   uint32_t stride;
+   /* Control byte of the full slots of the entry's hash. */
+   uint8_t ctrl;
+};
+
+/* Hashes like _mesa_hash_pointer() are weak, so mix the bits before
+ * picking the first group and the control byte.
+ */
+static inline void
+hash_group_probe_init(struct hash_group_probe *probe, uint32_t hash,
+                      uint32_t size)
+{
+   hash ^= hash >> 16;
+   hash *= 0x85ebca6b;
+   hash ^= hash >> 13;
+   hash *= 0xc2b2ae35;
+   hash ^= hash >> 16;
+
+   probe->mask = size - 1;
+   probe->pos = hash & probe->mask & ~(HASH_GROUP_SIZE - 1);
+   probe->stride = 0;
+   probe->ctrl = hash >> 25;
+}
+
+/* Moves to the next group, returns false once all of them were visited. */
+static inline bool
+hash_group_probe_next(struct hash_group_probe *probe)
+{
+   probe->stride += HASH_GROUP_SIZE;
+   probe->pos = (probe->pos + probe->stride) & probe->mask;
+   return probe->stride <= probe->mask;
+}
+
+#endif /* HASH_GROUP_H */
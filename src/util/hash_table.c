@@ -49,6 +49,8 @@
 #include "macros.h"
 #include "u_memory.h"
 #include "fast_urem_by_const.h"
+#include "hash_group.h"
+#include "bitscan.h"
 #include "util/u_memory.h"
 
 #define XXH_INLINE_ALL
@@ -145,22 +147,63 @@ entry_is_present(const struct hash_table *ht, struct hash_entry *entry)
    return entry->key != NULL && entry->key != ht->deleted_key;
 }
 
-bool
-_mesa_hash_table_init(struct hash_table *ht,
-                      void *mem_ctx,
-                      uint32_t (*key_hash_function)(const void *key),
-                      bool (*key_equals_function)(const void *a,
-                                                  const void *b))
+static unsigned
+hash_table_num_sizes(bool grouped)
 {
-   ht->size_index = 0;
-   ht->size = hash_sizes[ht->size_index].size;
-   ht->rehash = hash_sizes[ht->size_index].rehash;
-   ht->size_magic = hash_sizes[ht->size_index].size_magic;
-   ht->rehash_magic = hash_sizes[ht->size_index].rehash_magic;
-   ht->max_entries = hash_sizes[ht->size_index].max_entries;
+   return grouped ? HASH_GROUP_NUM_SIZES : ARRAY_SIZE(hash_sizes);
+}
+
+static void
+hash_table_set_size(struct hash_table *ht, unsigned size_index, bool grouped)
+{
+   ht->size_index = size_index;
+   if (grouped) {
+      ht->size = hash_group_table_size(size_index);
+      ht->rehash = 0;
+      ht->size_magic = 0;
+      ht->rehash_magic = 0;
+      ht->max_entries = hash_group_max_entries(size_index);
+   } else {
+      ht->size = hash_sizes[size_index].size;
+      ht->rehash = hash_sizes[size_index].rehash;
+      ht->size_magic = hash_sizes[size_index].size_magic;
+      ht->rehash_magic = hash_sizes[size_index].rehash_magic;
+      ht->max_entries = hash_sizes[size_index].max_entries;
+   }
+}
+
+/* The control bytes of grouped tables are allocated out of the table. */
+static struct hash_entry *
+hash_table_alloc(void *mem_ctx, uint32_t size, uint8_t **ctrl)
+{
+   struct hash_entry *table = rzalloc_array(mem_ctx, struct hash_entry, size);
+
+   if (table && ctrl) {
+      *ctrl = ralloc_array(table, uint8_t, size);
+      if (*ctrl == NULL) {
+         ralloc_free(table);
+         return NULL;
+      }
+      memset(*ctrl, HASH_CTRL_EMPTY, size);
+   }
+
+   return table;
+}
+
+static bool
+hash_table_init(struct hash_table *ht,
+                void *mem_ctx,
+                uint32_t (*key_hash_function)(const void *key),
+                bool (*key_equals_function)(const void *a,
+                                            const void *b),
+                bool grouped)
+{
+   hash_table_set_size(ht, 0, grouped);
    ht->key_hash_function = key_hash_function;
    ht->key_equals_function = key_equals_function;
-   ht->table = rzalloc_array(mem_ctx, struct hash_entry, ht->size);
+   ht->ctrl = NULL;
+   ht->table = hash_table_alloc(mem_ctx, ht->size,
+                                grouped ? &ht->ctrl : NULL);
    ht->entries = 0;
    ht->deleted_entries = 0;
    ht->deleted_key = &deleted_key_value;
@@ -168,11 +211,34 @@ _mesa_hash_table_init(struct hash_table *ht,
    return ht->table != NULL;
 }
 
-struct hash_table *
-_mesa_hash_table_create(void *mem_ctx,
-                        uint32_t (*key_hash_function)(const void *key),
-                        bool (*key_equals_function)(const void *a,
-                                                    const void *b))
+bool
+_mesa_hash_table_init(struct hash_table *ht,
+                      void *mem_ctx,
+                      uint32_t (*key_hash_function)(const void *key),
+                      bool (*key_equals_function)(const void *a,
+                                                  const void *b))
+{
+   return hash_table_init(ht, mem_ctx, key_hash_function,
+                          key_equals_function, false);
+}
+
+bool
+_mesa_hash_table_init_grouped(struct hash_table *ht,
+                              void *mem_ctx,
+                              uint32_t (*key_hash_function)(const void *key),
+                              bool (*key_equals_function)(const void *a,
+                                                          const void *b))
+{
+   return hash_table_init(ht, mem_ctx, key_hash_function,
+                          key_equals_function, true);
+}
+
+static struct hash_table *
+hash_table_create(void *mem_ctx,
+                  uint32_t (*key_hash_function)(const void *key),
+                  bool (*key_equals_function)(const void *a,
+                                              const void *b),
+                  bool grouped)
 {
    struct hash_table *ht;
 
@@ -183,7 +249,8 @@ _mesa_hash_table_create(void *mem_ctx,
    if (ht == NULL)
       return NULL;
 
-   if (!_mesa_hash_table_init(ht, ht, key_hash_function, key_equals_function)) {
+   if (!hash_table_init(ht, ht, key_hash_function, key_equals_function,
+                        grouped)) {
       ralloc_free(ht);
       return NULL;
    }
@@ -191,6 +258,26 @@ _mesa_hash_table_create(void *mem_ctx,
    return ht;
 }
 
+struct hash_table *
+_mesa_hash_table_create(void *mem_ctx,
+                        uint32_t (*key_hash_function)(const void *key),
+                        bool (*key_equals_function)(const void *a,
+                                                    const void *b))
+{
+   return hash_table_create(mem_ctx, key_hash_function,
+                            key_equals_function, false);
+}
+
+struct hash_table *
+_mesa_hash_table_create_grouped(void *mem_ctx,
+                                uint32_t (*key_hash_function)(const void *key),
+                                bool (*key_equals_function)(const void *a,
+                                                            const void *b))
+{
+   return hash_table_create(mem_ctx, key_hash_function,
+                            key_equals_function, true);
+}
+
 static uint32_t
 key_u32_hash(const void *key)
 {
@@ -230,6 +317,16 @@ _mesa_hash_table_clone(struct hash_table *src, void *dst_mem_ctx)
 
    memcpy(ht->table, src->table, ht->size * sizeof(struct hash_entry));
 
+   if (src->ctrl) {
+      ht->ctrl = ralloc_array(ht->table, uint8_t, ht->size);
+      if (ht->ctrl == NULL) {
+         ralloc_free(ht);
+         return NULL;
+      }
+
+      memcpy(ht->ctrl, src->ctrl, ht->size);
+   }
+
    return ht;
 }
 
@@ -257,7 +354,9 @@ _mesa_hash_table_destroy(struct hash_table *ht,
 static void
 hash_table_clear_fast(struct hash_table *ht)
 {
-   memset(ht->table, 0, sizeof(struct hash_entry) * hash_sizes[ht->size_index].size);
+   memset(ht->table, 0, sizeof(struct hash_entry) * ht->size);
+   if (ht->ctrl)
+      memset(ht->ctrl, HASH_CTRL_EMPTY, ht->size);
    ht->entries = ht->deleted_entries = 0;
 }
 
@@ -283,6 +382,8 @@ _mesa_hash_table_clear(struct hash_table *ht,
 
          entry->key = NULL;
       }
+      if (ht->ctrl)
+         memset(ht->ctrl, HASH_CTRL_EMPTY, ht->size);
       ht->entries = 0;
       ht->deleted_entries = 0;
    } else
@@ -305,11 +406,40 @@ _mesa_hash_table_set_deleted_key(struct hash_table *ht, const void *deleted_key)
    ht->deleted_key = deleted_key;
 }
 
+static struct hash_entry *
+hash_table_search_grouped(struct hash_table *ht, uint32_t hash,
+                          const void *key)
+{
+   struct hash_group_probe probe;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      const uint8_t *group = ht->ctrl + probe.pos;
+
+      unsigned match = hash_group_match(group, probe.ctrl);
+      while (match) {
+         struct hash_entry *entry = ht->table + probe.pos + u_bit_scan(&match);
+
+         if (entry->hash == hash && entry_is_present(ht, entry) &&
+             ht->key_equals_function(key, entry->key))
+            return entry;
+      }
+
+      if (hash_group_match(group, HASH_CTRL_EMPTY))
+         return NULL;
+   } while (hash_group_probe_next(&probe));
+
+   return NULL;
+}
+
 static struct hash_entry *
 hash_table_search(struct hash_table *ht, uint32_t hash, const void *key)
 {
    assert(!key_pointer_is_reserved(ht, key));
 
+   if (ht->ctrl)
+      return hash_table_search_grouped(ht, hash, key);
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -360,10 +490,39 @@ static struct hash_entry *
 hash_table_insert(struct hash_table *ht, uint32_t hash,
                   const void *key, void *data);
 
+static void
+hash_table_insert_rehash_grouped(struct hash_table *ht, uint32_t hash,
+                                 const void *key, void *data)
+{
+   struct hash_group_probe probe;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      unsigned available = hash_group_match_free(ht->ctrl + probe.pos);
+      if (likely(available)) {
+         uint32_t idx = probe.pos + u_bit_scan(&available);
+         struct hash_entry *entry = ht->table + idx;
+
+         ht->ctrl[idx] = probe.ctrl;
+         entry->hash = hash;
+         entry->key = key;
+         entry->data = data;
+         return;
+      }
+   } while (hash_group_probe_next(&probe));
+
+   unreachable("rehashed table is full");
+}
+
 static void
 hash_table_insert_rehash(struct hash_table *ht, uint32_t hash,
                          const void *key, void *data)
 {
+   if (ht->ctrl) {
+      hash_table_insert_rehash_grouped(ht, hash, key, data);
+      return;
+   }
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -390,6 +549,8 @@ _mesa_hash_table_rehash(struct hash_table *ht, unsigned new_size_index)
 {
    struct hash_table old_ht;
    struct hash_entry *table;
+   uint8_t *ctrl = NULL;
+   bool grouped = ht->ctrl != NULL;
 
    if (ht->size_index == new_size_index && ht->deleted_entries == ht->max_entries) {
       hash_table_clear_fast(ht);
@@ -397,23 +558,21 @@ _mesa_hash_table_rehash(struct hash_table *ht, unsigned new_size_index)
       return;
    }
 
-   if (new_size_index >= ARRAY_SIZE(hash_sizes))
+   if (new_size_index >= hash_table_num_sizes(grouped))
       return;
 
-   table = rzalloc_array(ralloc_parent(ht->table), struct hash_entry,
-                         hash_sizes[new_size_index].size);
+   table = hash_table_alloc(ralloc_parent(ht->table),
+                            grouped ? hash_group_table_size(new_size_index) :
+                                      hash_sizes[new_size_index].size,
+                            grouped ? &ctrl : NULL);
    if (table == NULL)
       return;
 
    old_ht = *ht;
 
    ht->table = table;
-   ht->size_index = new_size_index;
-   ht->size = hash_sizes[ht->size_index].size;
-   ht->rehash = hash_sizes[ht->size_index].rehash;
-   ht->size_magic = hash_sizes[ht->size_index].size_magic;
-   ht->rehash_magic = hash_sizes[ht->size_index].rehash_magic;
-   ht->max_entries = hash_sizes[ht->size_index].max_entries;
+   ht->ctrl = ctrl;
+   hash_table_set_size(ht, new_size_index, grouped);
    ht->entries = 0;
    ht->deleted_entries = 0;
 
@@ -426,6 +585,55 @@ _mesa_hash_table_rehash(struct hash_table *ht, unsigned new_size_index)
    ralloc_free(old_ht.table);
 }
 
+static struct hash_entry *
+hash_table_insert_grouped(struct hash_table *ht, uint32_t hash,
+                          const void *key, void *data)
+{
+   struct hash_group_probe probe;
+   uint32_t available_idx = UINT32_MAX;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      const uint8_t *group = ht->ctrl + probe.pos;
+
+      /* Replace the entry with a matching key, as below. */
+      unsigned match = hash_group_match(group, probe.ctrl);
+      while (match) {
+         struct hash_entry *entry = ht->table + probe.pos + u_bit_scan(&match);
+
+         if (entry->hash == hash && entry_is_present(ht, entry) &&
+             ht->key_equals_function(key, entry->key)) {
+            entry->key = key;
+            entry->data = data;
+            return entry;
+         }
+      }
+
+      /* Stash the first available entry we find */
+      unsigned available = hash_group_match_free(group);
+      if (available_idx == UINT32_MAX && available)
+         available_idx = probe.pos + ffs(available) - 1;
+
+      if (hash_group_match(group, HASH_CTRL_EMPTY))
+         break;
+   } while (hash_group_probe_next(&probe));
+
+   if (available_idx != UINT32_MAX) {
+      struct hash_entry *entry = ht->table + available_idx;
+
+      if (ht->ctrl[available_idx] == HASH_CTRL_DELETED)
+         ht->deleted_entries--;
+      ht->ctrl[available_idx] = probe.ctrl;
+      entry->hash = hash;
+      entry->key = key;
+      entry->data = data;
+      ht->entries++;
+      return entry;
+   }
+
+   return NULL;
+}
+
 static struct hash_entry *
 hash_table_insert(struct hash_table *ht, uint32_t hash,
                   const void *key, void *data)
@@ -440,6 +648,9 @@ hash_table_insert(struct hash_table *ht, uint32_t hash,
       _mesa_hash_table_rehash(ht, ht->size_index);
    }
 
+   if (ht->ctrl)
+      return hash_table_insert_grouped(ht, hash, key, data);
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -530,6 +741,23 @@ _mesa_hash_table_remove(struct hash_table *ht,
    if (!entry)
       return;
 
+   if (ht->ctrl) {
+      uint32_t idx = entry - ht->table;
+
+      /* No probe sequence goes past a group that still has empty slots, so
+       * the slot can be made empty instead of deleted.
+       */
+      if (hash_group_match(ht->ctrl + (idx & ~(HASH_GROUP_SIZE - 1)),
+                           HASH_CTRL_EMPTY)) {
+         ht->ctrl[idx] = HASH_CTRL_EMPTY;
+         entry->key = NULL;
+         ht->entries--;
+         return;
+      }
+
+      ht->ctrl[idx] = HASH_CTRL_DELETED;
+   }
+
    entry->key = ht->deleted_key;
    ht->entries--;
    ht->deleted_entries++;
@@ -565,6 +793,22 @@ _mesa_hash_table_next_entry_unsafe(const struct hash_table *ht, struct hash_entr
    return NULL;
 }
 
+/**
+ * Clears an entry returned by _mesa_hash_table_next_entry_unsafe(), as part
+ * of hash_table_foreach_remove().
+ */
+void
+_mesa_hash_table_clear_entry_unsafe(struct hash_table *ht,
+                                    struct hash_entry *entry)
+{
+   if (ht->ctrl)
+      ht->ctrl[entry - ht->table] = HASH_CTRL_EMPTY;
+   entry->hash = 0;
+   entry->key = NULL;
+   entry->data = NULL;
+   ht->entries--;
+}
+
 /**
  * This function is an iterator over the hash table.
  *
@@ -731,10 +975,13 @@ _mesa_pointer_hash_table_create(void *mem_ctx)
 bool
 _mesa_hash_table_reserve(struct hash_table *ht, unsigned size)
 {
+   bool grouped = ht->ctrl != NULL;
+
    if (size < ht->max_entries)
       return true;
-   for (unsigned i = ht->size_index + 1; i < ARRAY_SIZE(hash_sizes); i++) {
-      if (hash_sizes[i].max_entries >= size) {
+   for (unsigned i = ht->size_index + 1; i < hash_table_num_sizes(grouped); i++) {
+      if ((grouped ? hash_group_max_entries(i) :
+                     hash_sizes[i].max_entries) >= size) {
          _mesa_hash_table_rehash(ht, i);
          break;
       }
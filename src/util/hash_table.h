@@ -46,6 +46,8 @@ struct hash_entry {
 
 struct hash_table {
    struct hash_entry *table;
+   /* Control bytes of the grouped layout, NULL for the default layout. */
+   uint8_t *ctrl;
    uint32_t (*key_hash_function)(const void *key);
    bool (*key_equals_function)(const void *a, const void *b);
    const void *deleted_key;
@@ -72,6 +74,26 @@ _mesa_hash_table_init(struct hash_table *ht,
                       bool (*key_equals_function)(const void *a,
                                                   const void *b));
 
+/**
+ * Creates a hash table with the grouped layout, which probes the table with
+ * SIMD compares of a separate array of control bytes instead of touching
+ * each entry along the way. Lookups are faster on large tables or with
+ * expensive key compares, at the cost of a bigger minimum table size.
+ * Otherwise it is used exactly like a table with the default layout.
+ */
+struct hash_table *
+_mesa_hash_table_create_grouped(void *mem_ctx,
+                                uint32_t (*key_hash_function)(const void *key),
+                                bool (*key_equals_function)(const void *a,
+                                                            const void *b));
+
+bool
+_mesa_hash_table_init_grouped(struct hash_table *ht,
+                              void *mem_ctx,
+                              uint32_t (*key_hash_function)(const void *key),
+                              bool (*key_equals_function)(const void *a,
+                                                          const void *b));
+
 struct hash_table *
 _mesa_hash_table_create_u32_keys(void *mem_ctx);
 
@@ -108,6 +130,8 @@ struct hash_entry *_mesa_hash_table_next_entry(struct hash_table *ht,
                                                struct hash_entry *entry);
 struct hash_entry *_mesa_hash_table_next_entry_unsafe(const struct hash_table *ht,
                                                struct hash_entry *entry);
+void _mesa_hash_table_clear_entry_unsafe(struct hash_table *ht,
+                                         struct hash_entry *entry);
 struct hash_entry *
 _mesa_hash_table_random_entry(struct hash_table *ht,
                               bool (*predicate)(struct hash_entry *entry));
@@ -149,8 +173,8 @@ _mesa_hash_table_reserve(struct hash_table *ht, unsigned size);
 #define hash_table_foreach_remove(ht, entry)                                      \
    for (struct hash_entry *entry = _mesa_hash_table_next_entry_unsafe(ht, NULL);  \
         (ht)->entries;                                                     \
-        entry->hash = 0, entry->key = (void*)NULL, entry->data = NULL,      \
-        (ht)->entries--, entry = _mesa_hash_table_next_entry_unsafe(ht, entry))
+        _mesa_hash_table_clear_entry_unsafe(ht, entry),                    \
+        entry = _mesa_hash_table_next_entry_unsafe(ht, entry))
 
 static inline void
 hash_table_call_foreach(struct hash_table *ht,
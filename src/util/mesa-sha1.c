@@ -26,8 +26,229 @@
 
 #include "sha1/sha1.h"
 #include "mesa-sha1.h"
+#include "c11/threads.h"
+#include "macros.h"
+#include "u_atomic.h"
+#include "u_cpu_detect.h"
+#include "u_endian.h"
+#include "u_math.h"
+#include "u_thread.h"
 #include <string.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_SHA1_X86 1
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#include <arm_neon.h>
+#define HAVE_SHA1_ARMV8 1
+#define SHA1_ARMV8_TARGET
+#elif defined(__aarch64__) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 10
+#include <arm_neon.h>
+#define HAVE_SHA1_ARMV8 1
+#define SHA1_ARMV8_TARGET __attribute__((target("+crypto")))
+#endif
+
+typedef void (*sha1_blocks_func)(uint32_t state[5], const uint8_t *data,
+                                 size_t blocks);
+
+static void
+sha1_blocks_c(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+   for (size_t i = 0; i < blocks; i++)
+      SHA1Transform(state, data + i * SHA1_BLOCK_LENGTH);
+}
+
+#ifdef HAVE_SHA1_X86
+/* Each step runs four rounds.  Steps 4 and up first extend the message
+ * schedule in m0 from the previous four message vectors.
+ */
+#define SHA1_X86_SCHEDULE(m0, m1, m2, m3) \
+   m0 = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(m0, m1), m2), m3)
+
+#define SHA1_X86_ROUNDS(f, ea, eb, m) do { \
+   ea = _mm_sha1nexte_epu32(ea, m);        \
+   eb = abcd;                              \
+   abcd = _mm_sha1rnds4_epu32(abcd, ea, f); \
+} while (0)
+
+#define SHA1_X86_STEP(f, ea, eb, m0, m1, m2, m3) do { \
+   SHA1_X86_SCHEDULE(m0, m1, m2, m3);                 \
+   SHA1_X86_ROUNDS(f, ea, eb, m0);                    \
+} while (0)
+
+__attribute__((target("sha,sse4.1")))
+static void
+sha1_blocks_x86(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+   const __m128i bswap = _mm_set_epi64x(0x0001020304050607ull,
+                                        0x08090a0b0c0d0e0full);
+   __m128i abcd, e0, e1, m0, m1, m2, m3;
+
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1b);
+   e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+   for (; blocks; blocks--, data += SHA1_BLOCK_LENGTH) {
+      const __m128i abcd_saved = abcd;
+      const __m128i e0_saved = e0;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), bswap);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), bswap);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), bswap);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), bswap);
+
+      e0 = _mm_add_epi32(e0, m0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      SHA1_X86_ROUNDS(0, e1, e0, m1);
+      SHA1_X86_ROUNDS(0, e0, e1, m2);
+      SHA1_X86_ROUNDS(0, e1, e0, m3);
+      SHA1_X86_STEP(0, e0, e1, m0, m1, m2, m3);
+
+      SHA1_X86_STEP(1, e1, e0, m1, m2, m3, m0);
+      SHA1_X86_STEP(1, e0, e1, m2, m3, m0, m1);
+      SHA1_X86_STEP(1, e1, e0, m3, m0, m1, m2);
+      SHA1_X86_STEP(1, e0, e1, m0, m1, m2, m3);
+      SHA1_X86_STEP(1, e1, e0, m1, m2, m3, m0);
+
+      SHA1_X86_STEP(2, e0, e1, m2, m3, m0, m1);
+      SHA1_X86_STEP(2, e1, e0, m3, m0, m1, m2);
+      SHA1_X86_STEP(2, e0, e1, m0, m1, m2, m3);
+      SHA1_X86_STEP(2, e1, e0, m1, m2, m3, m0);
+      SHA1_X86_STEP(2, e0, e1, m2, m3, m0, m1);
+
+      SHA1_X86_STEP(3, e1, e0, m3, m0, m1, m2);
+      SHA1_X86_STEP(3, e0, e1, m0, m1, m2, m3);
+      SHA1_X86_STEP(3, e1, e0, m1, m2, m3, m0);
+      SHA1_X86_STEP(3, e0, e1, m2, m3, m0, m1);
+      SHA1_X86_STEP(3, e1, e0, m3, m0, m1, m2);
+
+      e0 = _mm_sha1nexte_epu32(e0, e0_saved);
+      abcd = _mm_add_epi32(abcd, abcd_saved);
+   }
+
+   _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1b));
+   state[4] = _mm_extract_epi32(e0, 3);
+}
+#endif
+
+#ifdef HAVE_SHA1_ARMV8
+#define SHA1_ARMV8_ROUNDS(op, k, m) do {           \
+   const uint32x4_t wk = vaddq_u32(m, vdupq_n_u32(k)); \
+   const uint32_t e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0)); \
+   abcd = op(abcd, e, wk);                         \
+   e = e_next;                                     \
+} while (0)
+
+#define SHA1_ARMV8_STEP(op, k, m0, m1, m2, m3) do {           \
+   m0 = vsha1su1q_u32(vsha1su0q_u32(m0, m1, m2), m3);         \
+   SHA1_ARMV8_ROUNDS(op, k, m0);                              \
+} while (0)
+
+SHA1_ARMV8_TARGET
+static void
+sha1_blocks_armv8(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+   uint32x4_t abcd = vld1q_u32(state);
+   uint32_t e = state[4];
+   uint32x4_t m0, m1, m2, m3;
+
+   for (; blocks; blocks--, data += SHA1_BLOCK_LENGTH) {
+      const uint32x4_t abcd_saved = abcd;
+      const uint32_t e_saved = e;
+
+      m0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data)));
+      m1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+      m2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+      m3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+      SHA1_ARMV8_ROUNDS(vsha1cq_u32, 0x5a827999, m0);
+      SHA1_ARMV8_ROUNDS(vsha1cq_u32, 0x5a827999, m1);
+      SHA1_ARMV8_ROUNDS(vsha1cq_u32, 0x5a827999, m2);
+      SHA1_ARMV8_ROUNDS(vsha1cq_u32, 0x5a827999, m3);
+      SHA1_ARMV8_STEP(vsha1cq_u32, 0x5a827999, m0, m1, m2, m3);
+
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0x6ed9eba1, m1, m2, m3, m0);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0x6ed9eba1, m2, m3, m0, m1);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0x6ed9eba1, m3, m0, m1, m2);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0x6ed9eba1, m0, m1, m2, m3);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0x6ed9eba1, m1, m2, m3, m0);
+
+      SHA1_ARMV8_STEP(vsha1mq_u32, 0x8f1bbcdc, m2, m3, m0, m1);
+      SHA1_ARMV8_STEP(vsha1mq_u32, 0x8f1bbcdc, m3, m0, m1, m2);
+      SHA1_ARMV8_STEP(vsha1mq_u32, 0x8f1bbcdc, m0, m1, m2, m3);
+      SHA1_ARMV8_STEP(vsha1mq_u32, 0x8f1bbcdc, m1, m2, m3, m0);
+      SHA1_ARMV8_STEP(vsha1mq_u32, 0x8f1bbcdc, m2, m3, m0, m1);
+
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0xca62c1d6, m3, m0, m1, m2);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0xca62c1d6, m0, m1, m2, m3);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0xca62c1d6, m1, m2, m3, m0);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0xca62c1d6, m2, m3, m0, m1);
+      SHA1_ARMV8_STEP(vsha1pq_u32, 0xca62c1d6, m3, m0, m1, m2);
+
+      abcd = vaddq_u32(abcd, abcd_saved);
+      e += e_saved;
+   }
+
+   vst1q_u32(state, abcd);
+   state[4] = e;
+}
+#endif
+
+static sha1_blocks_func sha1_blocks = sha1_blocks_c;
+static once_flag sha1_blocks_once = ONCE_FLAG_INIT;
+
+static void
+sha1_blocks_init(void)
+{
+#if defined(HAVE_SHA1_X86) || defined(HAVE_SHA1_ARMV8)
+   util_cpu_detect();
+
+   if (util_get_cpu_caps()->has_sha) {
+#if defined(HAVE_SHA1_X86)
+      sha1_blocks = sha1_blocks_x86;
+#else
+      sha1_blocks = sha1_blocks_armv8;
+#endif
+   }
+#endif
+}
+
+void
+_mesa_sha1_update(struct mesa_sha1 *ctx, const void *data, size_t size)
+{
+   const uint8_t *bytes = (const uint8_t *)data;
+   size_t used = (ctx->count >> 3) & (SHA1_BLOCK_LENGTH - 1);
+
+   call_once(&sha1_blocks_once, sha1_blocks_init);
+
+   ctx->count += (uint64_t)size << 3;
+
+   if (used) {
+      size_t fill = MIN2(SHA1_BLOCK_LENGTH - used, size);
+
+      memcpy(&ctx->buffer[used], bytes, fill);
+      bytes += fill;
+      size -= fill;
+
+      if (used + fill < SHA1_BLOCK_LENGTH)
+         return;
+
+      sha1_blocks(ctx->state, ctx->buffer, 1);
+   }
+
+   if (size >= SHA1_BLOCK_LENGTH) {
+      size_t blocks = size / SHA1_BLOCK_LENGTH;
+
+      sha1_blocks(ctx->state, bytes, blocks);
+      bytes += blocks * SHA1_BLOCK_LENGTH;
+      size -= blocks * SHA1_BLOCK_LENGTH;
+   }
+
+   memcpy(ctx->buffer, bytes, size);
+}
+
 void
 _mesa_sha1_compute(const void *data, size_t size, unsigned char result[20])
 {
@@ -38,6 +259,104 @@ _mesa_sha1_compute(const void *data, size_t size, unsigned char result[20])
    _mesa_sha1_final(&ctx, result);
 }
 
+/* Upper bound on the threads _mesa_sha1_compute_tree uses for one input,
+ * including the calling thread.
+ */
+#define SHA1_TREE_MAX_THREADS 8
+
+struct sha1_tree_job {
+   const uint8_t *data;
+   size_t size;
+   unsigned num_chunks;
+   unsigned next_chunk;
+   uint8_t (*leaves)[SHA1_DIGEST_LENGTH];
+};
+
+static void
+sha1_tree_leaf(const struct sha1_tree_job *job, unsigned chunk,
+               uint8_t leaf[SHA1_DIGEST_LENGTH])
+{
+   size_t offset = (size_t)chunk * MESA_SHA1_TREE_CHUNK_SIZE;
+
+   _mesa_sha1_compute(job->data + offset,
+                      MIN2(job->size - offset, MESA_SHA1_TREE_CHUNK_SIZE),
+                      leaf);
+}
+
+static int
+sha1_tree_worker(void *data)
+{
+   struct sha1_tree_job *job = (struct sha1_tree_job *)data;
+   unsigned chunk;
+
+   while ((chunk = p_atomic_inc_return(&job->next_chunk) - 1) < job->num_chunks)
+      sha1_tree_leaf(job, chunk, job->leaves[chunk]);
+
+   return 0;
+}
+
+void
+_mesa_sha1_compute_tree(const void *data, size_t size,
+                        unsigned char result[20])
+{
+   if (size <= MESA_SHA1_TREE_CHUNK_SIZE) {
+      _mesa_sha1_compute(data, size, result);
+      return;
+   }
+
+   struct sha1_tree_job job = {
+      .data = (const uint8_t *)data,
+      .size = size,
+      .num_chunks = DIV_ROUND_UP(size, MESA_SHA1_TREE_CHUNK_SIZE),
+   };
+
+   /* The root hashes the little-endian input size followed by the hash of
+    * every chunk in order.
+    */
+   struct mesa_sha1 ctx;
+   uint64_t size64 = util_cpu_to_le64(size);
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &size64, sizeof(size64));
+
+   util_cpu_detect();
+   unsigned num_threads = MIN3((unsigned)util_get_cpu_caps()->nr_cpus,
+                               job.num_chunks,
+                               SHA1_TREE_MAX_THREADS);
+
+   if (num_threads > 1)
+      job.leaves = malloc(job.num_chunks * sizeof(*job.leaves));
+
+   if (job.leaves) {
+      thrd_t threads[SHA1_TREE_MAX_THREADS - 1];
+      unsigned started = 0;
+
+      for (unsigned i = 0; i < num_threads - 1; i++) {
+         threads[started] = u_thread_create(sha1_tree_worker, &job);
+         if (threads[started])
+            started++;
+      }
+
+      sha1_tree_worker(&job);
+
+      for (unsigned i = 0; i < started; i++)
+         thrd_join(threads[i], NULL);
+
+      _mesa_sha1_update(&ctx, job.leaves,
+                        job.num_chunks * sizeof(*job.leaves));
+      free(job.leaves);
+   } else {
+      for (unsigned i = 0; i < job.num_chunks; i++) {
+         uint8_t leaf[SHA1_DIGEST_LENGTH];
+
+         sha1_tree_leaf(&job, i, leaf);
+         _mesa_sha1_update(&ctx, leaf, sizeof(leaf));
+      }
+   }
+
+   _mesa_sha1_final(&ctx, result);
+}
+
 void
 _mesa_sha1_format(char *buf, const unsigned char *sha1)
 {
@@ -42,11 +42,11 @@ _mesa_sha1_init(struct mesa_sha1 *ctx)
    SHA1Init(ctx);
 }
 
-static inline void
-_mesa_sha1_update(struct mesa_sha1 *ctx, const void *data, size_t size)
-{
-   SHA1Update(ctx, (const unsigned char *)data, size);
-}
+/* Uses the SHA instructions of the CPU when util_cpu_caps reports them and
+ * falls back to the portable implementation otherwise.
+ */
+void
+_mesa_sha1_update(struct mesa_sha1 *ctx, const void *data, size_t size);
 
 static inline void
 _mesa_sha1_final(struct mesa_sha1 *ctx, unsigned char result[20])
@@ -63,6 +63,19 @@ _mesa_sha1_hex_to_sha1(unsigned char *buf, const char *hex);
 void
 _mesa_sha1_compute(const void *data, size_t size, unsigned char result[20]);
 
+/* Inputs larger than this are hashed in chunks by _mesa_sha1_compute_tree. */
+#define MESA_SHA1_TREE_CHUNK_SIZE (1024 * 1024)
+
+/* Hashes the data in MESA_SHA1_TREE_CHUNK_SIZE chunks, spread across several
+ * threads, and combines the chunk hashes into the result.  The result only
+ * depends on the data, not on the number of threads used, but it is not the
+ * SHA-1 of the data unless size <= MESA_SHA1_TREE_CHUNK_SIZE.  Only use it
+ * for keys that are never compared against plain SHA-1 hashes.
+ */
+void
+_mesa_sha1_compute_tree(const void *data, size_t size,
+                        unsigned char result[20]);
+
 void
 _mesa_sha1_print(FILE *f, const uint8_t sha1[SHA1_DIGEST_LENGTH]);
 
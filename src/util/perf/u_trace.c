@@ -22,7 +22,9 @@
  */
 
 #include <inttypes.h>
+#include <stdio.h>
 
+#include "util/detect_os.h"
 #include "util/list.h"
 #include "util/u_debug.h"
 #include "util/u_inlines.h"
@@ -31,6 +33,10 @@
 
 #include "u_trace.h"
 
+#if DETECT_OS_UNIX
+#include <unistd.h>
+#endif
+
 #define __NEEDS_TRACE_PRIV
 #include "u_trace_priv.h"
 
@@ -65,6 +71,16 @@ struct u_trace_event {
    const void *payload;
 };
 
+/**
+ * An event kept in the ring of recent events.  Payloads live in chunks
+ * that are freed once processed, so only the name is kept.
+ */
+struct u_trace_ring_event {
+   const char *name;
+   uint64_t ns;
+   uint32_t frame_nr;
+};
+
 /**
  * A "chunk" of trace-events and corresponding timestamp buffer.  As
  * trace events are emitted, additional trace chucks will be allocated
@@ -222,6 +238,9 @@ get_chunk(struct u_trace *ut, size_t payload_size)
 DEBUG_GET_ONCE_BOOL_OPTION(trace_instrument, "GPU_TRACE_INSTRUMENT", false)
 DEBUG_GET_ONCE_BOOL_OPTION(trace, "GPU_TRACE", false)
 DEBUG_GET_ONCE_FILE_OPTION(trace_file, "GPU_TRACEFILE", NULL, "w")
+DEBUG_GET_ONCE_NUM_OPTION(trace_sample_rate, "GPU_TRACE_SAMPLE_RATE", 1)
+DEBUG_GET_ONCE_NUM_OPTION(trace_ring, "GPU_TRACE_RING", 0)
+DEBUG_GET_ONCE_OPTION(trace_trigger, "GPU_TRACE_TRIGGER", NULL)
 
 static FILE *
 get_tracefile(void)
@@ -278,9 +297,24 @@ u_trace_context_init(struct u_trace_context *utctx,
    utctx->first_time_ns = 0;
    utctx->frame_nr = 0;
 
+   utctx->sample_rate = MAX2(debug_get_option_trace_sample_rate(), 1);
+   utctx->flushed_frame_nr = 0;
+
    list_inithead(&utctx->flushed_trace_chunks);
 
-   utctx->out = get_tracefile();
+   /* With a ring, events are only written out when the trigger file shows
+    * up, so the trace file isn't used.
+    */
+   utctx->ring_size = debug_get_option_trace_ring();
+   utctx->ring_next = 0;
+   utctx->ring_count = 0;
+   if (utctx->ring_size) {
+      utctx->ring = calloc(utctx->ring_size, sizeof(*utctx->ring));
+      utctx->out = NULL;
+   } else {
+      utctx->ring = NULL;
+      utctx->out = get_tracefile();
+   }
 
 #ifdef HAVE_PERFETTO
    list_add(&utctx->node, &ctx_list);
@@ -298,12 +332,15 @@ u_trace_context_fini(struct u_trace_context *utctx)
 #ifdef HAVE_PERFETTO
    list_del(&utctx->node);
 #endif
-   if (!utctx->queue.jobs)
-      return;
-   util_queue_finish(&utctx->queue);
-   util_queue_destroy(&utctx->queue);
-   fflush(utctx->out);
-   free_chunks(&utctx->flushed_trace_chunks);
+   if (utctx->queue.jobs) {
+      util_queue_finish(&utctx->queue);
+      util_queue_destroy(&utctx->queue);
+      if (utctx->out)
+         fflush(utctx->out);
+      free_chunks(&utctx->flushed_trace_chunks);
+   }
+   free(utctx->ring);
+   utctx->ring = NULL;
 }
 
 #ifdef HAVE_PERFETTO
@@ -323,6 +360,71 @@ u_trace_perfetto_stop(void)
 }
 #endif
 
+static void
+ring_add_event(struct u_trace_context *utctx, const char *name, uint64_t ns)
+{
+   utctx->ring[utctx->ring_next] = (struct u_trace_ring_event) {
+      .name = name,
+      .ns = ns,
+      .frame_nr = utctx->frame_nr,
+   };
+   utctx->ring_next = (utctx->ring_next + 1) % utctx->ring_size;
+   utctx->ring_count = MIN2(utctx->ring_count + 1, utctx->ring_size);
+}
+
+#if DETECT_OS_UNIX
+/**
+ * Write the ring as a JSON trace that chrome://tracing and the perfetto UI
+ * can load, next to the trigger file.
+ */
+static void
+ring_dump(struct u_trace_context *utctx, const char *trigger)
+{
+   char path[4096];
+   snprintf(path, sizeof(path), "%s.%d.%u.json", trigger, (int)getpid(),
+            utctx->frame_nr);
+
+   FILE *f = fopen(path, "w");
+   if (!f)
+      return;
+
+   fprintf(f, "{\"traceEvents\":[");
+   for (uint32_t i = 0; i < utctx->ring_count; i++) {
+      uint32_t idx = (utctx->ring_next + utctx->ring_size -
+                      utctx->ring_count + i) % utctx->ring_size;
+      const struct u_trace_ring_event *evt = &utctx->ring[idx];
+
+      fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\","
+              "\"pid\":%d,\"tid\":0,\"ts\":%.3f,"
+              "\"args\":{\"frame\":%u}}",
+              i ? "," : "", evt->name, (int)getpid(), evt->ns / 1000.0,
+              evt->frame_nr);
+   }
+   fprintf(f, "\n]}\n");
+   fclose(f);
+
+   utctx->ring_count = 0;
+}
+#endif
+
+/**
+ * Dump the ring if the trigger file exists, removing the trigger so that
+ * it can be touched again for the next dump.
+ */
+static void
+ring_check_trigger(struct u_trace_context *utctx)
+{
+#if DETECT_OS_UNIX
+   const char *trigger = debug_get_option_trace_trigger();
+
+   if (!trigger || access(trigger, F_OK) != 0)
+      return;
+
+   if (unlink(trigger) == 0)
+      ring_dump(utctx, trigger);
+#endif
+}
+
 static void
 process_chunk(void *job, void *gdata, int thread_index)
 {
@@ -365,6 +467,8 @@ process_chunk(void *job, void *gdata, int thread_index)
             fprintf(utctx->out, "%016"PRIu64" %+9d: %s\n", ns, delta, evt->tp->name);
          }
       }
+      if (utctx->ring)
+         ring_add_event(utctx, evt->tp->name, ns);
 #ifdef HAVE_PERFETTO
       if (evt->tp->perfetto) {
          evt->tp->perfetto(utctx->pctx, ns, chunk->flush_data, evt->payload);
@@ -386,8 +490,12 @@ process_chunk(void *job, void *gdata, int thread_index)
       utctx->delete_flush_data(utctx, chunk->flush_data);
    }
 
-   if (utctx->out && chunk->eof) {
-      fprintf(utctx->out, "END OF FRAME %u\n", utctx->frame_nr++);
+   if (chunk->eof) {
+      if (utctx->out)
+         fprintf(utctx->out, "END OF FRAME %u\n", utctx->frame_nr);
+      if (utctx->ring)
+         ring_check_trigger(utctx);
+      utctx->frame_nr++;
    }
 }
 
@@ -402,6 +510,10 @@ u_trace_context_process(struct u_trace_context *utctx, bool eof)
 {
    struct list_head *chunks = &utctx->flushed_trace_chunks;
 
+   /* Frames that aren't sampled have no chunks, but still count. */
+   if (eof)
+      utctx->flushed_frame_nr++;
+
    if (list_is_empty(chunks))
       return;
 
@@ -431,6 +543,7 @@ u_trace_init(struct u_trace *ut, struct u_trace_context *utctx)
    ut->utctx = utctx;
    list_inithead(&ut->trace_chunks);
    ut->enabled = u_trace_context_instrumenting(utctx);
+   ut->sampled = u_trace_context_sampling(utctx);
 }
 
 void
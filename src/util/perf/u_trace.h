@@ -69,6 +69,7 @@ extern "C" {
 struct u_trace_context;
 struct u_trace;
 struct u_trace_chunk;
+struct u_trace_ring_event;
 
 /**
  * Special reserved value to indicate that no timestamp was captured,
@@ -163,6 +164,20 @@ struct u_trace_context {
 
    uint32_t frame_nr;
 
+   /* Sampling: only one in sample_rate frames is instrumented.  Counted on
+    * the driver thread, unlike frame_nr which is counted by the queue.
+    */
+   uint32_t sample_rate;
+   uint32_t flushed_frame_nr;
+
+   /* Ring of the most recent events, used instead of writing to the trace
+    * file when GPU_TRACE_RING is set.  Only accessed by the queue.
+    */
+   struct u_trace_ring_event *ring;
+   uint32_t ring_size;
+   uint32_t ring_next;
+   uint32_t ring_count;
+
    /* list of unprocessed trace chunks in fifo order: */
    struct list_head flushed_trace_chunks;
 };
@@ -184,6 +199,7 @@ struct u_trace {
    struct list_head trace_chunks;  /* list of unflushed trace chunks in fifo order */
 
    bool enabled;
+   bool sampled;  /* whether this batch is part of a sampled frame */
 };
 
 void u_trace_context_init(struct u_trace_context *utctx,
@@ -285,13 +301,25 @@ void u_trace_perfetto_stop(void);
 static inline bool
 u_trace_context_actively_tracing(struct u_trace_context *utctx)
 {
-   return !!utctx->out || (ut_perfetto_enabled > 0);
+   return !!utctx->out || !!utctx->ring || (ut_perfetto_enabled > 0);
 }
 
 static inline bool
 u_trace_context_instrumenting(struct u_trace_context *utctx)
 {
-   return !!utctx->out || ut_trace_instrument || (ut_perfetto_enabled > 0);
+   return !!utctx->out || !!utctx->ring || ut_trace_instrument ||
+          (ut_perfetto_enabled > 0);
+}
+
+/**
+ * Whether batches started now belong to a frame that is sampled, see
+ * GPU_TRACE_SAMPLE_RATE.
+ */
+static inline bool
+u_trace_context_sampling(struct u_trace_context *utctx)
+{
+   return utctx->sample_rate <= 1 ||
+          (utctx->flushed_frame_nr % utctx->sample_rate) == 0;
 }
 
 #ifdef __cplusplus
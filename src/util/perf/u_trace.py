@@ -222,9 +222,10 @@ static inline void trace_${trace_name}(
 %    endfor
 ) {
 %    if trace.tp_perfetto is not None:
-   if (!unlikely(ut->enabled || ut_trace_instrument || ut_perfetto_enabled))
+   if (!unlikely(ut->enabled || ut_trace_instrument || ut_perfetto_enabled) ||
+       !ut->sampled)
 %    else:
-   if (!unlikely(ut->enabled || ut_trace_instrument))
+   if (!unlikely(ut->enabled || ut_trace_instrument) || !ut->sampled)
 %    endif
       return;
    __trace_${trace_name}(
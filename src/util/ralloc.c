@@ -31,6 +31,7 @@
 #include "util/macros.h"
 #include "util/u_math.h"
 #include "util/u_printf.h"
+#include "util/u_thread.h"
 
 #include "ralloc.h"
 
@@ -60,6 +61,11 @@ __declspec(align(16))
    unsigned canary;
 #endif
 
+   /* RALLOC_ARENA_* flags, and the size of arena allocated blocks. This
+    * fits in the padding of the header on 64-bit.
+    */
+   uint32_t arena_flags;
+
    struct ralloc_header *parent;
 
    /* The first child (head of a linked list) */
@@ -74,6 +80,9 @@ __declspec(align(16))
 
 typedef struct ralloc_header ralloc_header;
 
+/* Bytes requested by this thread, see ralloc_thread_allocated_bytes(). */
+static __THREAD_INITIAL_EXEC uint64_t thread_allocated_bytes;
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
@@ -88,6 +97,85 @@ get_header(const void *ptr)
 
 #define PTR_FROM_HEADER(info) (((char *) info) + sizeof(ralloc_header))
 
+/* The block's user data is the struct ralloc_arena of an arena context. */
+#define RALLOC_ARENA_ROOT   (1 << 0)
+/* The block is a descendant of an arena context. */
+#define RALLOC_ARENA_MEMBER (1 << 1)
+/* The block lives in the memory of an arena and must not be free()'d. */
+#define RALLOC_ARENA_MEMORY (1 << 2)
+#define RALLOC_ARENA_FLAG_BITS 3
+
+#define RALLOC_ARENA_CHUNK_SIZE (64 * 1024)
+/* Bigger blocks are malloc'd, even when allocated from an arena. */
+#define RALLOC_ARENA_MAX_BLOCK_SIZE (RALLOC_ARENA_CHUNK_SIZE / 4)
+
+struct ralloc_arena_chunk {
+   struct ralloc_arena_chunk *next;
+};
+
+struct ralloc_arena {
+   struct ralloc_arena_chunk *chunks;
+   char *next;
+   char *end;
+
+   /* Whether freeing the arena has to visit its descendants, because some
+    * of them have a destructor or weren't allocated from the arena.
+    */
+   bool needs_walk;
+};
+
+static size_t
+arena_block_size(const ralloc_header *info)
+{
+   return info->arena_flags >> RALLOC_ARENA_FLAG_BITS;
+}
+
+/* Find the arena the descendants of info are allocated from, if any. */
+static struct ralloc_arena *
+find_arena(ralloc_header *info)
+{
+   while (info &&
+          (info->arena_flags & (RALLOC_ARENA_ROOT | RALLOC_ARENA_MEMBER))) {
+      if (info->arena_flags & RALLOC_ARENA_ROOT)
+         return (struct ralloc_arena *) PTR_FROM_HEADER(info);
+      info = info->parent;
+   }
+
+   return NULL;
+}
+
+static void *
+arena_alloc(struct ralloc_arena *arena, size_t size)
+{
+   assert(size <= RALLOC_ARENA_MAX_BLOCK_SIZE);
+
+   if (unlikely((size_t)(arena->end - arena->next) < size)) {
+      struct ralloc_arena_chunk *chunk = malloc(RALLOC_ARENA_CHUNK_SIZE);
+      if (unlikely(chunk == NULL))
+         return NULL;
+
+      chunk->next = arena->chunks;
+      arena->chunks = chunk;
+      arena->next = (char *) chunk + align64(sizeof(*chunk),
+                                             alignof(ralloc_header));
+      arena->end = (char *) chunk + RALLOC_ARENA_CHUNK_SIZE;
+   }
+
+   void *ptr = arena->next;
+   arena->next += size;
+   return ptr;
+}
+
+static void
+arena_finish(struct ralloc_arena *arena)
+{
+   while (arena->chunks) {
+      struct ralloc_arena_chunk *chunk = arena->chunks;
+      arena->chunks = chunk->next;
+      free(chunk);
+   }
+}
+
 static void
 add_child(ralloc_header *parent, ralloc_header *info)
 {
@@ -107,8 +195,8 @@ ralloc_context(const void *ctx)
    return ralloc_size(ctx, 0);
 }
 
-void *
-ralloc_size(const void *ctx, size_t size)
+static void *
+ralloc_size_internal(const void *ctx, size_t size, bool allow_arena)
 {
    /* Some malloc allocation doesn't always align to 16 bytes even on 64 bits
     * system, from Android bionic/tests/malloc_test.cpp:
@@ -117,27 +205,49 @@ ralloc_size(const void *ctx, size_t size)
     *  - Allocations of a size that rounds up to a multiple of 8 bytes and
     *    not 16 bytes, are only required to have at least 8 byte alignment.
     */
-   void *block = malloc(align64(size + sizeof(ralloc_header),
-                                alignof(ralloc_header)));
+   size_t block_size = align64(size + sizeof(ralloc_header),
+                               alignof(ralloc_header));
+   ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+   struct ralloc_arena *arena = parent ? find_arena(parent) : NULL;
+   uint32_t arena_flags = 0;
+   void *block = NULL;
+
+   if (arena) {
+      arena_flags = RALLOC_ARENA_MEMBER;
+      if (allow_arena && block_size <= RALLOC_ARENA_MAX_BLOCK_SIZE) {
+         block = arena_alloc(arena, block_size);
+         arena_flags |= RALLOC_ARENA_MEMORY |
+                        (size << RALLOC_ARENA_FLAG_BITS);
+      } else {
+         arena->needs_walk = true;
+      }
+   }
+
+   if (!block) {
+      block = malloc(block_size);
+      arena_flags &= ~RALLOC_ARENA_MEMORY;
+      arena_flags &= (1 << RALLOC_ARENA_FLAG_BITS) - 1;
+   }
+
    ralloc_header *info;
-   ralloc_header *parent;
 
    if (unlikely(block == NULL))
       return NULL;
 
+   thread_allocated_bytes += size;
+
    info = (ralloc_header *) block;
    /* measurements have shown that calloc is slower (because of
     * the multiplication overflow checking?), so clear things
     * manually
     */
+   info->arena_flags = arena_flags;
    info->parent = NULL;
    info->child = NULL;
    info->prev = NULL;
    info->next = NULL;
    info->destructor = NULL;
 
-   parent = ctx != NULL ? get_header(ctx) : NULL;
-
    add_child(parent, info);
 
 #ifndef NDEBUG
@@ -147,6 +257,33 @@ ralloc_size(const void *ctx, size_t size)
    return PTR_FROM_HEADER(info);
 }
 
+void *
+ralloc_size(const void *ctx, size_t size)
+{
+   return ralloc_size_internal(ctx, size, true);
+}
+
+void *
+ralloc_arena_context(const void *ctx)
+{
+   /* The arena state itself must not live in a (parent) arena, as it
+    * outlives all of its descendants.
+    */
+   struct ralloc_arena *arena =
+      ralloc_size_internal(ctx, sizeof(struct ralloc_arena), false);
+   if (unlikely(arena == NULL))
+      return NULL;
+
+   arena->chunks = NULL;
+   arena->next = NULL;
+   arena->end = NULL;
+   arena->needs_walk = false;
+
+   get_header(arena)->arena_flags |= RALLOC_ARENA_ROOT;
+
+   return arena;
+}
+
 void *
 rzalloc_size(const void *ctx, size_t size)
 {
@@ -158,6 +295,41 @@ rzalloc_size(const void *ctx, size_t size)
    return ptr;
 }
 
+/* Move a block allocated from an arena, which can't be realloc'd in
+ * place.
+ */
+static ralloc_header *
+arena_resize(ralloc_header *old, size_t size)
+{
+   size_t block_size = align64(size + sizeof(ralloc_header),
+                               alignof(ralloc_header));
+   struct ralloc_arena *arena = find_arena(old->parent);
+   ralloc_header *info = NULL;
+   uint32_t arena_flags =
+      old->arena_flags & ((1 << RALLOC_ARENA_FLAG_BITS) - 1);
+
+   if (arena && block_size <= RALLOC_ARENA_MAX_BLOCK_SIZE) {
+      info = arena_alloc(arena, block_size);
+      arena_flags |= size << RALLOC_ARENA_FLAG_BITS;
+   }
+
+   if (!info) {
+      info = malloc(block_size);
+      arena_flags &= ~RALLOC_ARENA_MEMORY;
+      if (arena)
+         arena->needs_walk = true;
+   }
+
+   if (info == NULL)
+      return NULL;
+
+   memcpy(info, old, sizeof(ralloc_header) +
+                     MIN2(arena_block_size(old), size));
+   info->arena_flags = arena_flags;
+
+   return info;
+}
+
 /* helper function - assumes ptr != NULL */
 static void *
 resize(void *ptr, size_t size)
@@ -165,12 +337,18 @@ resize(void *ptr, size_t size)
    ralloc_header *child, *old, *info;
 
    old = get_header(ptr);
-   info = realloc(old, align64(size + sizeof(ralloc_header),
-                               alignof(ralloc_header)));
+   if (old->arena_flags & RALLOC_ARENA_MEMORY) {
+      info = arena_resize(old, size);
+   } else {
+      info = realloc(old, align64(size + sizeof(ralloc_header),
+                                  alignof(ralloc_header)));
+   }
 
    if (info == NULL)
       return NULL;
 
+   thread_allocated_bytes += size;
+
    /* Update parent and sibling's links to the reallocated node. */
    if (info != old && info->parent != NULL) {
       if (info->parent->child == old)
@@ -287,9 +465,15 @@ unlink_block(ralloc_header *info)
 static void
 unsafe_free(ralloc_header *info)
 {
+   /* If all the descendants of an arena live in its memory and have no
+    * destructors, releasing the arena releases everything.
+    */
+   bool free_children = !(info->arena_flags & RALLOC_ARENA_ROOT) ||
+      ((struct ralloc_arena *) PTR_FROM_HEADER(info))->needs_walk;
+
    /* Recursively free any children...don't waste time unlinking them. */
    ralloc_header *temp;
-   while (info->child != NULL) {
+   while (free_children && info->child != NULL) {
       temp = info->child;
       info->child = temp->next;
       unsafe_free(temp);
@@ -299,7 +483,11 @@ unsafe_free(ralloc_header *info)
    if (info->destructor != NULL)
       info->destructor(PTR_FROM_HEADER(info));
 
-   free(info);
+   if (info->arena_flags & RALLOC_ARENA_ROOT)
+      arena_finish((struct ralloc_arena *) PTR_FROM_HEADER(info));
+
+   if (!(info->arena_flags & RALLOC_ARENA_MEMORY))
+      free(info);
 }
 
 void
@@ -316,6 +504,13 @@ ralloc_steal(const void *new_ctx, void *ptr)
    unlink_block(info);
 
    add_child(parent, info);
+
+   /* The arena can't know whether the block or its children have to be
+    * freed individually.
+    */
+   struct ralloc_arena *arena = parent ? find_arena(parent) : NULL;
+   if (arena)
+      arena->needs_walk = true;
 }
 
 void
@@ -345,6 +540,16 @@ ralloc_adopt(const void *new_ctx, void *old_ctx)
       child->next->prev = child;
    new_info->child = old_info->child;
    old_info->child = NULL;
+
+   struct ralloc_arena *arena = find_arena(new_info);
+   if (arena)
+      arena->needs_walk = true;
+}
+
+uint64_t
+ralloc_thread_allocated_bytes(void)
+{
+   return thread_allocated_bytes;
 }
 
 void *
@@ -364,6 +569,10 @@ ralloc_set_destructor(const void *ptr, void(*destructor)(void *))
 {
    ralloc_header *info = get_header(ptr);
    info->destructor = destructor;
+
+   struct ralloc_arena *arena = find_arena(info->parent);
+   if (arena && destructor)
+      arena->needs_walk = true;
 }
 
 char *
@@ -49,6 +49,7 @@
 #include <stddef.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "macros.h"
 
@@ -91,6 +92,21 @@ extern "C" {
  */
 void *ralloc_context(const void *ctx);
 
+/**
+ * Allocate a new ralloc context backed by an arena.
+ *
+ * All descendants of an arena context are bump-allocated from large chunks
+ * owned by the context instead of being malloc'd one by one. Freeing a
+ * descendant runs its destructor and unlinks it as usual, but its memory is
+ * only reclaimed when the arena context itself is freed, which releases
+ * everything at once. This suits short-lived, allocation heavy work like a
+ * shader compile.
+ *
+ * Memory allocated from an arena is owned by the arena: such allocations
+ * may be stolen to other contexts, but must not outlive the arena context.
+ */
+void *ralloc_arena_context(const void *ctx);
+
 /**
  * Allocate memory chained off of the given context.
  *
@@ -308,6 +324,15 @@ void ralloc_adopt(const void *new_ctx, void *old_ctx);
  */
 void *ralloc_parent(const void *ptr);
 
+/**
+ * Return the total number of bytes requested through ralloc by the calling
+ * thread so far, including the new sizes of resized blocks.
+ *
+ * The counter only grows; the difference between two calls gives the
+ * amount allocated in between, which is useful for profiling.
+ */
+uint64_t ralloc_thread_allocated_bytes(void);
+
 /**
  * Set a callback to occur just before an object is freed.
  */
@@ -401,6 +401,7 @@ ra_set_serialize(const struct ra_regs *regs, struct blob *blob)
 
    bool is_contig = regs->classes[0]->contig_len != 0;
    blob_write_uint8(blob, is_contig);
+   blob_align(blob, sizeof(BITSET_WORD));
 
    if (!is_contig) {
       for (unsigned int r = 0; r < regs->count; r++) {
@@ -423,26 +424,54 @@ ra_set_serialize(const struct ra_regs *regs, struct blob *blob)
    blob_write_uint32(blob, regs->round_robin);
 }
 
-struct ra_regs *
-ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
+/* Reads an array of 32-bit words, either copied to a new allocation or
+ * pointing into the blob when borrowing.
+ */
+static void *
+ra_read_words(void *mem_ctx, struct blob_reader *blob, unsigned int count,
+              bool borrow)
+{
+   if (borrow) {
+      return (void *)blob_read_aligned_bytes(blob, sizeof(uint32_t),
+                                             count * sizeof(uint32_t));
+   }
+
+   uint32_t *words = ralloc_array(mem_ctx, uint32_t, count);
+   blob_copy_bytes(blob, words, count * sizeof(uint32_t));
+   return words;
+}
+
+static struct ra_regs *
+ra_set_deserialize_internal(void *mem_ctx, struct blob_reader *blob,
+                            bool borrow)
 {
    unsigned int reg_count = blob_read_uint32(blob);
    unsigned int class_count = blob_read_uint32(blob);
    bool is_contig = blob_read_uint8(blob);
+   blob_reader_align(blob, sizeof(BITSET_WORD));
+
+   STATIC_ASSERT(sizeof(BITSET_WORD) == sizeof(uint32_t));
 
    struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, reg_count, false);
    assert(regs->count == reg_count);
 
-   if (is_contig) {
+   if (is_contig || borrow) {
       for (int i = 0; i < regs->count; i++) {
          ralloc_free(regs->regs[i].conflicts);
          regs->regs[i].conflicts = NULL;
       }
-   } else {
+   }
+
+   if (!is_contig) {
       for (unsigned int r = 0; r < reg_count; r++) {
          struct ra_reg *reg = &regs->regs[r];
-         blob_copy_bytes(blob, reg->conflicts, BITSET_WORDS(reg_count) *
-                                             sizeof(BITSET_WORD));
+         if (borrow) {
+            reg->conflicts = ra_read_words(regs->regs, blob,
+                                           BITSET_WORDS(reg_count), true);
+         } else {
+            blob_copy_bytes(blob, reg->conflicts, BITSET_WORDS(reg_count) *
+                                                sizeof(BITSET_WORD));
+         }
       }
    }
 
@@ -456,15 +485,13 @@ ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
       class->regset = regs;
       class->index = c;
 
-      class->regs = ralloc_array(class, BITSET_WORD, BITSET_WORDS(reg_count));
-      blob_copy_bytes(blob, class->regs, BITSET_WORDS(reg_count) *
-                                         sizeof(BITSET_WORD));
+      class->regs = ra_read_words(class, blob, BITSET_WORDS(reg_count),
+                                  borrow);
 
       class->contig_len = blob_read_uint32(blob);
       class->p = blob_read_uint32(blob);
 
-      class->q = ralloc_array(regs->classes[c], unsigned int, class_count);
-      blob_copy_bytes(blob, class->q, class_count * sizeof(*class->q));
+      class->q = ra_read_words(class, blob, class_count, borrow);
    }
 
    regs->round_robin = blob_read_uint32(blob);
@@ -472,6 +499,20 @@ ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
    return regs;
 }
 
+struct ra_regs *
+ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
+{
+   return ra_set_deserialize_internal(mem_ctx, blob, false);
+}
+
+struct ra_regs *
+ra_set_deserialize_borrowed(void *mem_ctx, struct blob_reader *blob)
+{
+   /* The bitsets can only be used in place if they are aligned. */
+   bool aligned = ((uintptr_t)blob->data % sizeof(BITSET_WORD)) == 0;
+   return ra_set_deserialize_internal(mem_ctx, blob, aligned);
+}
+
 static uint64_t
 ra_get_num_adjacency_bits(uint64_t n)
 {
@@ -569,10 +610,16 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
    g->tmp.reg_assigned = reralloc(g, g->tmp.reg_assigned, BITSET_WORD,
                                   bitset_count);
    g->tmp.pq_test = reralloc(g, g->tmp.pq_test, BITSET_WORD, bitset_count);
+   g->tmp.pq_pending = reralloc(g, g->tmp.pq_pending, BITSET_WORD,
+                                BITSET_WORDS(bitset_count));
    g->tmp.min_q_total = reralloc(g, g->tmp.min_q_total, unsigned int,
                                  bitset_count);
    g->tmp.min_q_node = reralloc(g, g->tmp.min_q_node, unsigned int,
                                 bitset_count);
+   g->tmp.min_q_tree = reralloc(g, g->tmp.min_q_tree, unsigned int,
+                                2 * util_next_power_of_two(bitset_count));
+   g->tmp.min_q_changed = reralloc(g, g->tmp.min_q_changed, BITSET_WORD,
+                                   BITSET_WORDS(bitset_count));
 
    g->alloc = alloc;
 }
@@ -660,6 +707,7 @@ update_pq_info(struct ra_graph *g, unsigned int n)
    int n_class = g->nodes[n].class;
    if (g->nodes[n].tmp.q_total < g->regs->classes[n_class]->p) {
       BITSET_SET(g->tmp.pq_test, n);
+      BITSET_SET(g->tmp.pq_pending, i);
    } else if (g->tmp.min_q_total[i] != UINT_MAX) {
       /* Only update min_q_total and min_q_node if min_q_total != UINT_MAX so
        * that we don't update while we have stale data and accidentally mark
@@ -672,6 +720,7 @@ update_pq_info(struct ra_graph *g, unsigned int n)
            n > g->tmp.min_q_node[i])) {
          g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
          g->tmp.min_q_node[i] = n;
+         BITSET_SET(g->tmp.min_q_changed, i);
       }
    }
 }
@@ -701,6 +750,90 @@ add_node_to_stack(struct ra_graph *g, unsigned int n)
 
    /* Flag the min_q_total for n's block as dirty so it gets recalculated */
    g->tmp.min_q_total[n / BITSET_WORDBITS] = UINT_MAX;
+   BITSET_SET(g->tmp.min_q_changed, n / BITSET_WORDBITS);
+}
+
+/**
+ * Returns the highest BITSET_WORD index of pq_test no greater than i that may
+ * have pending nodes, or -1 if there is none.
+ */
+static int
+ra_find_pq_pending_word(struct ra_graph *g, int i)
+{
+   while (i >= 0) {
+      int w = i / BITSET_WORDBITS;
+      BITSET_WORD pending = g->tmp.pq_pending[w] &
+         (~(BITSET_WORD)0 >> (BITSET_WORDBITS - 1 - i % BITSET_WORDBITS));
+
+      if (pending)
+         return w * BITSET_WORDBITS + util_last_bit(pending) - 1;
+
+      i = w * BITSET_WORDBITS - 1;
+   }
+
+   return -1;
+}
+
+/* Whether word a has a lower min_q_total than word b.  On ties, the highest
+ * word wins, like in a scan from the top.
+ */
+static bool
+ra_min_q_word_better(struct ra_graph *g, unsigned int a, unsigned int b)
+{
+   if (a == UINT_MAX || b == UINT_MAX)
+      return b == UINT_MAX && a != UINT_MAX;
+
+   return g->tmp.min_q_total[a] < g->tmp.min_q_total[b] ||
+          (g->tmp.min_q_total[a] == g->tmp.min_q_total[b] && a > b);
+}
+
+/**
+ * Returns the node with the lowest q_total among the nodes which aren't in
+ * the stack or pre-assigned, or UINT_MAX if there is none.
+ */
+static unsigned int
+ra_find_min_q_node(struct ra_graph *g)
+{
+   const unsigned int word_count = BITSET_WORDS(g->count);
+   unsigned int *tree = g->tmp.min_q_tree;
+   unsigned int i;
+
+   BITSET_FOREACH_SET(i, g->tmp.min_q_changed, word_count) {
+      BITSET_CLEAR(g->tmp.min_q_changed, i);
+
+      if (g->tmp.min_q_total[i] == UINT_MAX) {
+         /* The min_q_total and min_q_node are dirty because we added
+          * one of these nodes to the stack.  It needs to be
+          * recalculated.
+          */
+         unsigned int high_bit = i == word_count - 1 ?
+            (g->count - 1) % BITSET_WORDBITS : BITSET_WORDBITS - 1;
+         BITSET_WORD avail = (~(BITSET_WORD)0 >> (31 - high_bit)) &
+            ~(g->tmp.in_stack[i] | g->tmp.reg_assigned[i]);
+
+         while (avail) {
+            int j = util_last_bit(avail) - 1;
+            unsigned int n = i * BITSET_WORDBITS + j;
+            assert(n < g->count);
+            if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i]) {
+               g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
+               g->tmp.min_q_node[i] = n;
+            }
+            avail &= ~BITSET_BIT(j);
+         }
+      }
+
+      for (unsigned int p = (g->tmp.min_q_tree_leaves + i) / 2; p >= 1; p /= 2) {
+         tree[p] = ra_min_q_word_better(g, tree[2 * p + 1], tree[2 * p]) ?
+                   tree[2 * p + 1] : tree[2 * p];
+      }
+   }
+
+   unsigned int best = tree[1];
+   if (best == UINT_MAX || g->tmp.min_q_total[best] == UINT_MAX)
+      return UINT_MAX;
+
+   return g->tmp.min_q_node[best];
 }
 
 /**
@@ -712,6 +845,11 @@ add_node_to_stack(struct ra_graph *g, unsigned int n)
  * we optimistically choose a node and push it on the stack. We heuristically
  * push the node with the lowest total q value, since it has the fewest
  * neighbors and therefore is most likely to be allocated.
+ *
+ * Nodes are visited from the highest index down, a BITSET_WORD at a time,
+ * and the words without trivially-colorable nodes are skipped using
+ * pq_pending, so each pass doesn't have to walk the whole graph.  Likewise,
+ * finding the lowest q value only revisits the words whose nodes changed.
  */
 static void
 ra_simplify(struct ra_graph *g)
@@ -719,13 +857,28 @@ ra_simplify(struct ra_graph *g)
    bool progress = true;
    unsigned int stack_optimistic_start = UINT_MAX;
 
-   /* Figure out the high bit and bit mask for the first iteration of a loop
-    * over BITSET_WORDs.
+   /* Figure out the high bit for the first iteration of a loop over
+    * BITSET_WORDs.
     */
    const unsigned int top_word_high_bit = (g->count - 1) % BITSET_WORDBITS;
 
    /* Do a quick pre-pass to set things up */
    g->tmp.stack_count = 0;
+   g->tmp.stack_optimistic_start = UINT_MAX;
+   if (g->count == 0)
+      return;
+
+   memset(g->tmp.pq_pending, 0,
+          BITSET_WORDS(BITSET_WORDS(g->count)) * sizeof(BITSET_WORD));
+   memset(g->tmp.min_q_changed, 0,
+          BITSET_WORDS(BITSET_WORDS(g->count)) * sizeof(BITSET_WORD));
+
+   g->tmp.min_q_tree_leaves = util_next_power_of_two(BITSET_WORDS(g->count));
+   for (unsigned int i = 0; i < g->tmp.min_q_tree_leaves; i++) {
+      g->tmp.min_q_tree[i] = UINT_MAX;
+      g->tmp.min_q_tree[g->tmp.min_q_tree_leaves + i] =
+         i < BITSET_WORDS(g->count) ? i : UINT_MAX;
+   }
    for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
         i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
       g->tmp.in_stack[i] = 0;
@@ -733,6 +886,7 @@ ra_simplify(struct ra_graph *g)
       g->tmp.pq_test[i] = 0;
       g->tmp.min_q_total[i] = UINT_MAX;
       g->tmp.min_q_node[i] = UINT_MAX;
+      BITSET_SET(g->tmp.min_q_changed, i);
       for (int j = high_bit; j >= 0; j--) {
          unsigned int n = i * BITSET_WORDBITS + j;
          g->nodes[n].reg = g->nodes[n].forced_reg;
@@ -744,65 +898,43 @@ ra_simplify(struct ra_graph *g)
    }
 
    while (progress) {
-      unsigned int min_q_total = UINT_MAX;
-      unsigned int min_q_node = UINT_MAX;
-
       progress = false;
 
-      for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
-           i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
-         BITSET_WORD mask = ~(BITSET_WORD)0 >> (31 - high_bit);
-
+      /* Words below the current one may get new pending nodes as we push
+       * nodes to the stack, and are still visited in this pass.  Words above
+       * it are visited again in the next pass.
+       */
+      for (int i = ra_find_pq_pending_word(g, BITSET_WORDS(g->count) - 1);
+           i >= 0; i = ra_find_pq_pending_word(g, i - 1)) {
          BITSET_WORD skip = g->tmp.in_stack[i] | g->tmp.reg_assigned[i];
-         if (skip == mask)
-            continue;
-
          BITSET_WORD pq = g->tmp.pq_test[i] & ~skip;
-         if (pq) {
-            /* In this case, we have stuff we can immediately take off the
-             * stack.  This also means that we're guaranteed to make progress
-             * and we don't need to bother updating lowest_q_total because we
-             * know we're going to loop again before attempting to do anything
-             * optimistic.
+
+         BITSET_CLEAR(g->tmp.pq_pending, i);
+
+         /* In this case, we have stuff we can immediately take off the
+          * stack.  This also means that we're guaranteed to make progress
+          * and we don't need to bother updating lowest_q_total because we
+          * know we're going to loop again before attempting to do anything
+          * optimistic.
+          */
+         while (pq) {
+            int j = util_last_bit(pq) - 1;
+            unsigned int n = i * BITSET_WORDBITS + j;
+            assert(n < g->count);
+            add_node_to_stack(g, n);
+            /* add_node_to_stack() may update pq_test for this word so
+             * we need to update our local copy.
              */
-            for (int j = high_bit; j >= 0; j--) {
-               if (pq & BITSET_BIT(j)) {
-                  unsigned int n = i * BITSET_WORDBITS + j;
-                  assert(n < g->count);
-                  add_node_to_stack(g, n);
-                  /* add_node_to_stack() may update pq_test for this word so
-                   * we need to update our local copy.
-                   */
-                  pq = g->tmp.pq_test[i] & ~skip;
-                  progress = true;
-               }
-            }
-         } else if (!progress) {
-            if (g->tmp.min_q_total[i] == UINT_MAX) {
-               /* The min_q_total and min_q_node are dirty because we added
-                * one of these nodes to the stack.  It needs to be
-                * recalculated.
-                */
-               for (int j = high_bit; j >= 0; j--) {
-                  if (skip & BITSET_BIT(j))
-                     continue;
-
-                  unsigned int n = i * BITSET_WORDBITS + j;
-                  assert(n < g->count);
-                  if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i]) {
-                     g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
-                     g->tmp.min_q_node[i] = n;
-                  }
-               }
-            }
-            if (g->tmp.min_q_total[i] < min_q_total) {
-               min_q_node = g->tmp.min_q_node[i];
-               min_q_total = g->tmp.min_q_total[i];
-            }
+            pq = g->tmp.pq_test[i] & ~skip & (BITSET_BIT(j) - 1);
+            progress = true;
          }
       }
 
-      if (!progress && min_q_total != UINT_MAX) {
+      if (progress)
+         continue;
+
+      unsigned int min_q_node = ra_find_min_q_node(g);
+      if (min_q_node != UINT_MAX) {
          if (stack_optimistic_start == UINT_MAX)
             stack_optimistic_start = g->tmp.stack_count;
 
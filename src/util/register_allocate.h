@@ -74,6 +74,13 @@ void ra_set_finalize(struct ra_regs *regs, unsigned int **conflicts);
 
 void ra_set_serialize(const struct ra_regs *regs, struct blob *blob);
 struct ra_regs *ra_set_deserialize(void *mem_ctx, struct blob_reader *blob);
+
+/* Like ra_set_deserialize(), but the conflict and class bitsets point into
+ * the data of the blob reader instead of being copied, so that data must
+ * outlive the register set.  The register set can't be modified.
+ */
+struct ra_regs *ra_set_deserialize_borrowed(void *mem_ctx,
+                                            struct blob_reader *blob);
 /** @} */
 
 /** @{ Interference graph setup.
@@ -85,6 +92,13 @@ struct ra_regs *ra_set_deserialize(void *mem_ctx, struct blob_reader *blob);
  * two nodes if their classes haven't been assigned yet. The user
  * should set the class of each node before building the interference
  * graph.
+ *
+ * The graph doesn't need to be rebuilt when ra_allocate() fails and a
+ * node gets spilled: resetting the spilled node with
+ * ra_reset_node_interference(), adding the new nodes of the spill code
+ * with ra_add_node() and their interferences, then calling ra_allocate()
+ * again gives the same allocation as a new graph, at the cost of the
+ * nodes that changed.
  */
 struct ra_graph *ra_alloc_interference_graph(struct ra_regs *regs,
                                              unsigned int count);
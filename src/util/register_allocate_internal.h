@@ -152,6 +152,12 @@ struct ra_graph {
       /** Bit-set indicating, for each register, the value of the pq test */
       BITSET_WORD *pq_test;
 
+      /**
+       * Bit-set indicating, for each BITSET_WORD of pq_test, whether it may
+       * have nodes that passed the pq test and aren't in the stack yet.
+       */
+      BITSET_WORD *pq_pending;
+
       /** For each BITSET_WORD, the minimum q value or ~0 if unknown */
       unsigned int *min_q_total;
 
@@ -161,6 +167,17 @@ struct ra_graph {
        */
       unsigned int *min_q_node;
 
+      /**
+       * Tournament tree over the BITSET_WORDs, giving at the root the word
+       * whose min_q_total is the lowest.  It is only updated for the words
+       * in min_q_changed when we need to pick a node optimistically.
+       */
+      unsigned int *min_q_tree;
+      unsigned int min_q_tree_leaves;
+
+      /** Bit-set indicating, for each BITSET_WORD, if min_q_total changed */
+      BITSET_WORD *min_q_changed;
+
       /**
        * Tracks the start of the set of optimistically-colored registers in the
        * stack.
@@ -41,6 +41,8 @@
 #include "ralloc.h"
 #include "set.h"
 #include "fast_urem_by_const.h"
+#include "hash_group.h"
+#include "bitscan.h"
 
 /*
  * From Knuth -- a good choice for hash/rehash values is p, p-2 where
@@ -116,32 +118,100 @@ entry_is_present(struct set_entry *entry)
    return entry->key != NULL && entry->key != deleted_key;
 }
 
-bool
-_mesa_set_init(struct set *ht, void *mem_ctx,
-                 uint32_t (*key_hash_function)(const void *key),
-                 bool (*key_equals_function)(const void *a,
-                                             const void *b))
+static unsigned
+set_num_sizes(bool grouped)
+{
+   return grouped ? HASH_GROUP_NUM_SIZES : ARRAY_SIZE(hash_sizes);
+}
+
+static uint32_t
+set_max_entries(unsigned size_index, bool grouped)
 {
-   ht->size_index = 0;
-   ht->size = hash_sizes[ht->size_index].size;
-   ht->rehash = hash_sizes[ht->size_index].rehash;
-   ht->size_magic = hash_sizes[ht->size_index].size_magic;
-   ht->rehash_magic = hash_sizes[ht->size_index].rehash_magic;
-   ht->max_entries = hash_sizes[ht->size_index].max_entries;
+   return grouped ? hash_group_max_entries(size_index) :
+                    hash_sizes[size_index].max_entries;
+}
+
+static void
+set_set_size(struct set *ht, unsigned size_index, bool grouped)
+{
+   ht->size_index = size_index;
+   if (grouped) {
+      ht->size = hash_group_table_size(size_index);
+      ht->rehash = 0;
+      ht->size_magic = 0;
+      ht->rehash_magic = 0;
+      ht->max_entries = hash_group_max_entries(size_index);
+   } else {
+      ht->size = hash_sizes[size_index].size;
+      ht->rehash = hash_sizes[size_index].rehash;
+      ht->size_magic = hash_sizes[size_index].size_magic;
+      ht->rehash_magic = hash_sizes[size_index].rehash_magic;
+      ht->max_entries = hash_sizes[size_index].max_entries;
+   }
+}
+
+/* The control bytes of grouped sets are allocated out of the table. */
+static struct set_entry *
+set_alloc(void *mem_ctx, uint32_t size, uint8_t **ctrl)
+{
+   struct set_entry *table = rzalloc_array(mem_ctx, struct set_entry, size);
+
+   if (table && ctrl) {
+      *ctrl = ralloc_array(table, uint8_t, size);
+      if (*ctrl == NULL) {
+         ralloc_free(table);
+         return NULL;
+      }
+      memset(*ctrl, HASH_CTRL_EMPTY, size);
+   }
+
+   return table;
+}
+
+static bool
+set_init(struct set *ht, void *mem_ctx,
+         uint32_t (*key_hash_function)(const void *key),
+         bool (*key_equals_function)(const void *a,
+                                     const void *b),
+         bool grouped)
+{
+   set_set_size(ht, 0, grouped);
    ht->key_hash_function = key_hash_function;
    ht->key_equals_function = key_equals_function;
-   ht->table = rzalloc_array(mem_ctx, struct set_entry, ht->size);
+   ht->ctrl = NULL;
+   ht->table = set_alloc(mem_ctx, ht->size, grouped ? &ht->ctrl : NULL);
    ht->entries = 0;
    ht->deleted_entries = 0;
 
    return ht->table != NULL;
 }
 
-struct set *
-_mesa_set_create(void *mem_ctx,
+bool
+_mesa_set_init(struct set *ht, void *mem_ctx,
                  uint32_t (*key_hash_function)(const void *key),
                  bool (*key_equals_function)(const void *a,
                                              const void *b))
+{
+   return set_init(ht, mem_ctx, key_hash_function, key_equals_function,
+                   false);
+}
+
+bool
+_mesa_set_init_grouped(struct set *ht, void *mem_ctx,
+                       uint32_t (*key_hash_function)(const void *key),
+                       bool (*key_equals_function)(const void *a,
+                                                   const void *b))
+{
+   return set_init(ht, mem_ctx, key_hash_function, key_equals_function,
+                   true);
+}
+
+static struct set *
+set_create(void *mem_ctx,
+           uint32_t (*key_hash_function)(const void *key),
+           bool (*key_equals_function)(const void *a,
+                                       const void *b),
+           bool grouped)
 {
    struct set *ht;
 
@@ -149,7 +219,7 @@ _mesa_set_create(void *mem_ctx,
    if (ht == NULL)
       return NULL;
 
-   if (!_mesa_set_init(ht, ht, key_hash_function, key_equals_function)) {
+   if (!set_init(ht, ht, key_hash_function, key_equals_function, grouped)) {
       ralloc_free(ht);
       return NULL;
    }
@@ -157,6 +227,24 @@ _mesa_set_create(void *mem_ctx,
    return ht;
 }
 
+struct set *
+_mesa_set_create(void *mem_ctx,
+                 uint32_t (*key_hash_function)(const void *key),
+                 bool (*key_equals_function)(const void *a,
+                                             const void *b))
+{
+   return set_create(mem_ctx, key_hash_function, key_equals_function, false);
+}
+
+struct set *
+_mesa_set_create_grouped(void *mem_ctx,
+                         uint32_t (*key_hash_function)(const void *key),
+                         bool (*key_equals_function)(const void *a,
+                                                     const void *b))
+{
+   return set_create(mem_ctx, key_hash_function, key_equals_function, true);
+}
+
 static uint32_t
 key_u32_hash(const void *key)
 {
@@ -196,6 +284,16 @@ _mesa_set_clone(struct set *set, void *dst_mem_ctx)
 
    memcpy(clone->table, set->table, clone->size * sizeof(struct set_entry));
 
+   if (set->ctrl) {
+      clone->ctrl = ralloc_array(clone->table, uint8_t, clone->size);
+      if (clone->ctrl == NULL) {
+         ralloc_free(clone);
+         return NULL;
+      }
+
+      memcpy(clone->ctrl, set->ctrl, clone->size);
+   }
+
    return clone;
 }
 
@@ -224,7 +322,9 @@ _mesa_set_destroy(struct set *ht, void (*delete_function)(struct set_entry *entr
 static void
 set_clear_fast(struct set *ht)
 {
-   memset(ht->table, 0, sizeof(struct set_entry) * hash_sizes[ht->size_index].size);
+   memset(ht->table, 0, sizeof(struct set_entry) * ht->size);
+   if (ht->ctrl)
+      memset(ht->ctrl, HASH_CTRL_EMPTY, ht->size);
    ht->entries = ht->deleted_entries = 0;
 }
 
@@ -249,6 +349,8 @@ _mesa_set_clear(struct set *set, void (*delete_function)(struct set_entry *entry
 
          entry->key = NULL;
       }
+      if (set->ctrl)
+         memset(set->ctrl, HASH_CTRL_EMPTY, set->size);
       set->entries = 0;
       set->deleted_entries = 0;
    } else
@@ -260,11 +362,39 @@ _mesa_set_clear(struct set *set, void (*delete_function)(struct set_entry *entry
  *
  * Returns NULL if no entry is found.
  */
+static struct set_entry *
+set_search_grouped(const struct set *ht, uint32_t hash, const void *key)
+{
+   struct hash_group_probe probe;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      const uint8_t *group = ht->ctrl + probe.pos;
+
+      unsigned match = hash_group_match(group, probe.ctrl);
+      while (match) {
+         struct set_entry *entry = ht->table + probe.pos + u_bit_scan(&match);
+
+         if (entry->hash == hash && entry_is_present(entry) &&
+             ht->key_equals_function(key, entry->key))
+            return entry;
+      }
+
+      if (hash_group_match(group, HASH_CTRL_EMPTY))
+         return NULL;
+   } while (hash_group_probe_next(&probe));
+
+   return NULL;
+}
+
 static struct set_entry *
 set_search(const struct set *ht, uint32_t hash, const void *key)
 {
    assert(!key_pointer_is_reserved(key));
 
+   if (ht->ctrl)
+      return set_search_grouped(ht, hash, key);
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -305,9 +435,36 @@ _mesa_set_search_pre_hashed(const struct set *set, uint32_t hash,
    return set_search(set, hash, key);
 }
 
+static void
+set_add_rehash_grouped(struct set *ht, uint32_t hash, const void *key)
+{
+   struct hash_group_probe probe;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      unsigned available = hash_group_match_free(ht->ctrl + probe.pos);
+      if (likely(available)) {
+         uint32_t idx = probe.pos + u_bit_scan(&available);
+         struct set_entry *entry = ht->table + idx;
+
+         ht->ctrl[idx] = probe.ctrl;
+         entry->hash = hash;
+         entry->key = key;
+         return;
+      }
+   } while (hash_group_probe_next(&probe));
+
+   unreachable("rehashed set is full");
+}
+
 static void
 set_add_rehash(struct set *ht, uint32_t hash, const void *key)
 {
+   if (ht->ctrl) {
+      set_add_rehash_grouped(ht, hash, key);
+      return;
+   }
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -332,6 +489,8 @@ set_rehash(struct set *ht, unsigned new_size_index)
 {
    struct set old_ht;
    struct set_entry *table;
+   uint8_t *ctrl = NULL;
+   bool grouped = ht->ctrl != NULL;
 
    if (ht->size_index == new_size_index && ht->deleted_entries == ht->max_entries) {
       set_clear_fast(ht);
@@ -339,23 +498,21 @@ set_rehash(struct set *ht, unsigned new_size_index)
       return;
    }
 
-   if (new_size_index >= ARRAY_SIZE(hash_sizes))
+   if (new_size_index >= set_num_sizes(grouped))
       return;
 
-   table = rzalloc_array(ralloc_parent(ht->table), struct set_entry,
-                         hash_sizes[new_size_index].size);
+   table = set_alloc(ralloc_parent(ht->table),
+                     grouped ? hash_group_table_size(new_size_index) :
+                               hash_sizes[new_size_index].size,
+                     grouped ? &ctrl : NULL);
    if (table == NULL)
       return;
 
    old_ht = *ht;
 
    ht->table = table;
-   ht->size_index = new_size_index;
-   ht->size = hash_sizes[ht->size_index].size;
-   ht->rehash = hash_sizes[ht->size_index].rehash;
-   ht->size_magic = hash_sizes[ht->size_index].size_magic;
-   ht->rehash_magic = hash_sizes[ht->size_index].rehash_magic;
-   ht->max_entries = hash_sizes[ht->size_index].max_entries;
+   ht->ctrl = ctrl;
+   set_set_size(ht, new_size_index, grouped);
    ht->entries = 0;
    ht->deleted_entries = 0;
 
@@ -375,8 +532,10 @@ _mesa_set_resize(struct set *set, uint32_t entries)
    if (set->entries > entries)
       entries = set->entries;
 
+   bool grouped = set->ctrl != NULL;
    unsigned size_index = 0;
-   while (hash_sizes[size_index].max_entries < entries)
+   while (size_index + 1 < set_num_sizes(grouped) &&
+          set_max_entries(size_index, grouped) < entries)
       size_index++;
 
    set_rehash(set, size_index);
@@ -389,6 +548,56 @@ _mesa_set_resize(struct set *set, uint32_t entries)
  * Note that insertion may rearrange the table on a resize or rehash,
  * so previously found hash_entries are no longer valid after this function.
  */
+static struct set_entry *
+set_search_or_add_grouped(struct set *ht, uint32_t hash, const void *key,
+                          bool *found)
+{
+   struct hash_group_probe probe;
+   uint32_t available_idx = UINT32_MAX;
+
+   hash_group_probe_init(&probe, hash, ht->size);
+   do {
+      const uint8_t *group = ht->ctrl + probe.pos;
+
+      unsigned match = hash_group_match(group, probe.ctrl);
+      while (match) {
+         struct set_entry *entry = ht->table + probe.pos + u_bit_scan(&match);
+
+         if (entry->hash == hash && entry_is_present(entry) &&
+             ht->key_equals_function(key, entry->key)) {
+            if (found)
+               *found = true;
+            return entry;
+         }
+      }
+
+      /* Stash the first available entry we find */
+      unsigned available = hash_group_match_free(group);
+      if (available_idx == UINT32_MAX && available)
+         available_idx = probe.pos + ffs(available) - 1;
+
+      if (hash_group_match(group, HASH_CTRL_EMPTY))
+         break;
+   } while (hash_group_probe_next(&probe));
+
+   if (available_idx != UINT32_MAX) {
+      /* There is no matching entry, create it. */
+      struct set_entry *entry = ht->table + available_idx;
+
+      if (ht->ctrl[available_idx] == HASH_CTRL_DELETED)
+         ht->deleted_entries--;
+      ht->ctrl[available_idx] = probe.ctrl;
+      entry->hash = hash;
+      entry->key = key;
+      ht->entries++;
+      if (found)
+         *found = false;
+      return entry;
+   }
+
+   return NULL;
+}
+
 static struct set_entry *
 set_search_or_add(struct set *ht, uint32_t hash, const void *key, bool *found)
 {
@@ -402,6 +611,9 @@ set_search_or_add(struct set *ht, uint32_t hash, const void *key, bool *found)
       set_rehash(ht, ht->size_index);
    }
 
+   if (ht->ctrl)
+      return set_search_or_add_grouped(ht, hash, key, found);
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -546,6 +758,23 @@ _mesa_set_remove(struct set *ht, struct set_entry *entry)
    if (!entry)
       return;
 
+   if (ht->ctrl) {
+      uint32_t idx = entry - ht->table;
+
+      /* No probe sequence goes past a group that still has empty slots, so
+       * the slot can be made empty instead of deleted.
+       */
+      if (hash_group_match(ht->ctrl + (idx & ~(HASH_GROUP_SIZE - 1)),
+                           HASH_CTRL_EMPTY)) {
+         ht->ctrl[idx] = HASH_CTRL_EMPTY;
+         entry->key = NULL;
+         ht->entries--;
+         return;
+      }
+
+      ht->ctrl[idx] = HASH_CTRL_DELETED;
+   }
+
    entry->key = deleted_key;
    ht->entries--;
    ht->deleted_entries++;
@@ -581,6 +810,20 @@ _mesa_set_next_entry_unsafe(const struct set *ht, struct set_entry *entry)
    return NULL;
 }
 
+/**
+ * Clears an entry returned by _mesa_set_next_entry_unsafe(), as part of
+ * set_foreach_remove().
+ */
+void
+_mesa_set_clear_entry_unsafe(struct set *ht, struct set_entry *entry)
+{
+   if (ht->ctrl)
+      ht->ctrl[entry - ht->table] = HASH_CTRL_EMPTY;
+   entry->hash = 0;
+   entry->key = NULL;
+   ht->entries--;
+}
+
 /**
  * This function is an iterator over the hash table.
  *
@@ -43,6 +43,8 @@ struct set_entry {
 struct set {
    void *mem_ctx;
    struct set_entry *table;
+   /* Control bytes of the grouped layout, NULL for the default layout. */
+   uint8_t *ctrl;
    uint32_t (*key_hash_function)(const void *key);
    bool (*key_equals_function)(const void *a, const void *b);
    uint32_t size;
@@ -66,6 +68,22 @@ _mesa_set_create(void *mem_ctx,
                  uint32_t (*key_hash_function)(const void *key),
                  bool (*key_equals_function)(const void *a,
                                              const void *b));
+/**
+ * Creates a set with the grouped layout, see
+ * _mesa_hash_table_create_grouped().
+ */
+struct set *
+_mesa_set_create_grouped(void *mem_ctx,
+                         uint32_t (*key_hash_function)(const void *key),
+                         bool (*key_equals_function)(const void *a,
+                                                     const void *b));
+
+bool
+_mesa_set_init_grouped(struct set *ht, void *mem_ctx,
+                       uint32_t (*key_hash_function)(const void *key),
+                       bool (*key_equals_function)(const void *a,
+                                                   const void *b));
+
 struct set *
 _mesa_set_create_u32_keys(void *mem_ctx);
 
@@ -113,6 +131,8 @@ struct set_entry *
 _mesa_set_next_entry(const struct set *set, struct set_entry *entry);
 struct set_entry *
 _mesa_set_next_entry_unsafe(const struct set *set, struct set_entry *entry);
+void
+_mesa_set_clear_entry_unsafe(struct set *set, struct set_entry *entry);
 
 struct set_entry *
 _mesa_set_random_entry(struct set *set,
@@ -141,7 +161,7 @@ _mesa_set_intersects(struct set *a, struct set *b);
 #define set_foreach_remove(set, entry)                              \
    for (struct set_entry *entry = _mesa_set_next_entry_unsafe(set, NULL);  \
         (set)->entries;                                              \
-        entry->hash = 0, entry->key = (void*)NULL, (set)->entries--, entry = _mesa_set_next_entry_unsafe(set, entry))
+        _mesa_set_clear_entry_unsafe(set, entry), entry = _mesa_set_next_entry_unsafe(set, entry))
 
 #ifdef __cplusplus
 } /* extern C */
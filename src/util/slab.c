@@ -127,8 +127,81 @@ void slab_create_child(struct slab_child_pool *pool,
 {
    pool->parent = parent;
    pool->pages = NULL;
+   pool->num_pages = 0;
    pool->free = NULL;
    pool->migrated = NULL;
+   memset(pool->magazines, 0, sizeof(pool->magazines));
+}
+
+/* Return the elements in the magazine to their owners, taking the parent
+ * mutex only once.
+ */
+static void
+slab_flush_magazine(struct slab_child_pool *pool, struct slab_magazine *mag)
+{
+   struct slab_element_header *orphaned = NULL;
+
+   if (!mag->elements)
+      return;
+
+   simple_mtx_lock(&pool->parent->mutex);
+
+   while (mag->elements) {
+      struct slab_element_header *elt = mag->elements;
+      mag->elements = elt->next;
+
+      /* The owner may have been destroyed, and possibly replaced by a new
+       * pool at the same address, since the element was put into the
+       * magazine. Re-read the owner of every element under the mutex.
+       */
+      intptr_t owner_int = p_atomic_read(&elt->owner);
+      if (!(owner_int & 1)) {
+         struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
+         elt->next = owner->migrated;
+         owner->migrated = elt;
+      } else {
+         elt->next = orphaned;
+         orphaned = elt;
+      }
+   }
+
+   simple_mtx_unlock(&pool->parent->mutex);
+
+   while (orphaned) {
+      struct slab_element_header *elt = orphaned;
+      orphaned = elt->next;
+      slab_free_orphaned(elt);
+   }
+
+   mag->owner = NULL;
+   mag->num_elements = 0;
+}
+
+/**
+ * Return all foreign elements cached in the magazines of the pool to their
+ * owners. Single-threaded, like slab_free.
+ */
+void
+slab_flush_magazines(struct slab_child_pool *pool)
+{
+   if (!pool->parent)
+      return;
+
+   for (unsigned i = 0; i < SLAB_NUM_MAGAZINES; i++)
+      slab_flush_magazine(pool, &pool->magazines[i]);
+}
+
+/**
+ * Return statistics about the child pool. Single-threaded, like slab_alloc.
+ */
+void
+slab_get_child_stats(struct slab_child_pool *pool,
+                     struct slab_child_stats *stats)
+{
+   stats->num_pages = pool->num_pages;
+   stats->num_cached = 0;
+   for (unsigned i = 0; i < SLAB_NUM_MAGAZINES; i++)
+      stats->num_cached += pool->magazines[i].num_elements;
 }
 
 /**
@@ -142,6 +215,8 @@ void slab_destroy_child(struct slab_child_pool *pool)
    if (!pool->parent)
       return; /* the slab probably wasn't even created */
 
+   slab_flush_magazines(pool);
+
    simple_mtx_lock(&pool->parent->mutex);
 
    while (pool->pages) {
@@ -194,6 +269,7 @@ slab_add_new_page(struct slab_child_pool *pool)
 
    page->u.next = pool->pages;
    pool->pages = page;
+   pool->num_pages++;
 
    return true;
 }
@@ -260,7 +336,8 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
    CHECK_MAGIC(elt, SLAB_MAGIC_ALLOCATED);
    SET_MAGIC(elt, SLAB_MAGIC_FREE);
 
-   if (p_atomic_read(&elt->owner) == (intptr_t)pool) {
+   owner_int = p_atomic_read(&elt->owner);
+   if (owner_int == (intptr_t)pool) {
       /* This is the simple case: The caller guarantees that we can safely
        * access the free list.
        */
@@ -269,27 +346,38 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
       return;
    }
 
-   /* The slow case: migration or an orphaned page. */
-   if (pool->parent)
-      simple_mtx_lock(&pool->parent->mutex);
+   /* Orphaned pages stay orphaned, so we don't need the mutex to tell. */
+   if (owner_int & 1) {
+      slab_free_orphaned(elt);
+      return;
+   }
 
-   /* Note: we _must_ re-read elt->owner here because the owning child pool
-    * may have been destroyed by another thread in the meantime.
-    */
-   owner_int = p_atomic_read(&elt->owner);
+   if (pool->parent) {
+      /* Migration: batch the element up with others from the same owner.
+       * The owner is only used as a key here, it is checked again under the
+       * mutex when the magazine is flushed.
+       */
+      struct slab_magazine *mag =
+         &pool->magazines[((uintptr_t)owner_int >> 4) % SLAB_NUM_MAGAZINES];
 
-   if (!(owner_int & 1)) {
-      struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
-      elt->next = owner->migrated;
-      owner->migrated = elt;
-      if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
-   } else {
-      if (pool->parent)
-         simple_mtx_unlock(&pool->parent->mutex);
+      if (mag->owner != (struct slab_child_pool *)owner_int) {
+         slab_flush_magazine(pool, mag);
+         mag->owner = (struct slab_child_pool *)owner_int;
+      }
 
-      slab_free_orphaned(elt);
+      elt->next = mag->elements;
+      mag->elements = elt;
+      if (++mag->num_elements >= SLAB_MAGAZINE_SIZE)
+         slab_flush_magazine(pool, mag);
+      return;
    }
+
+   /* The slow case: freeing through a destroyed pool, which has no parent
+    * mutex we could take anymore.
+    */
+   struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
+   elt->next = owner->migrated;
+   owner->migrated = elt;
 }
 
 /**
@@ -32,8 +32,10 @@
  *
  * Allocations obtained from one child pool should usually be freed in the
  * same child pool. Freeing an allocation in a different child pool associated
- * to the same parent is allowed (and requires no locking by the caller), but
- * it is discouraged because it implies a performance penalty.
+ * to the same parent is allowed (and requires no locking by the caller). Such
+ * allocations are collected in per owner "magazines" of the freeing pool and
+ * returned to their owner in batches, so the parent mutex is only taken once
+ * per batch.
  *
  * For convenience and to ease the transition, there is also a set of wrapper
  * functions around a single parent-child pair.
@@ -58,10 +60,23 @@ struct slab_parent_pool {
    unsigned item_size;
 };
 
+/* Elements owned by another child pool that were freed through this one,
+ * waiting to be returned to their owner.
+ */
+struct slab_magazine {
+   struct slab_child_pool *owner;
+   struct slab_element_header *elements;
+   unsigned num_elements;
+};
+
+#define SLAB_NUM_MAGAZINES 4
+#define SLAB_MAGAZINE_SIZE 32
+
 struct slab_child_pool {
    struct slab_parent_pool *parent;
 
    struct slab_page_header *pages;
+   unsigned num_pages;
 
    /* Free elements. */
    struct slab_element_header *free;
@@ -72,6 +87,13 @@ struct slab_child_pool {
     * This list is protected by the parent mutex.
     */
    struct slab_element_header *migrated;
+
+   struct slab_magazine magazines[SLAB_NUM_MAGAZINES];
+};
+
+struct slab_child_stats {
+   unsigned num_pages;          /* pages allocated by this pool */
+   unsigned num_cached;         /* foreign elements waiting in magazines */
 };
 
 void slab_create_parent(struct slab_parent_pool *parent,
@@ -84,6 +106,9 @@ void slab_destroy_child(struct slab_child_pool *pool);
 void *slab_alloc(struct slab_child_pool *pool);
 void *slab_zalloc(struct slab_child_pool *pool);
 void slab_free(struct slab_child_pool *pool, void *ptr);
+void slab_flush_magazines(struct slab_child_pool *pool);
+void slab_get_child_stats(struct slab_child_pool *pool,
+                          struct slab_child_stats *stats);
 
 struct slab_mempool {
    struct slab_parent_pool parent;
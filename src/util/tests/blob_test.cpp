@@ -175,6 +175,35 @@ TEST(BlobTest, Alignment)
    blob_finish(&blob);
 }
 
+// Test that aligned reads return views of the data in place.
+TEST(BlobTest, AlignedBytes)
+{
+   struct blob blob;
+   struct blob_reader reader;
+   uint32_t words[] = { 1, 2, 3, 4 };
+
+   blob_init(&blob);
+
+   blob_write_uint8(&blob, 42);
+   blob_align(&blob, sizeof(uint32_t));
+   blob_write_bytes(&blob, words, sizeof(words));
+
+   blob_reader_init(&reader, blob.data, blob.size);
+
+   EXPECT_EQ(42, blob_read_uint8(&reader));
+   const uint32_t *view = (const uint32_t *)
+      blob_read_aligned_bytes(&reader, sizeof(uint32_t), sizeof(words));
+   EXPECT_EQ((const uint8_t *)view, blob.data + sizeof(uint32_t));
+   EXPECT_EQ(0, memcmp(view, words, sizeof(words)));
+   EXPECT_EQ(reader.current, reader.end);
+   EXPECT_FALSE(reader.overrun);
+
+   EXPECT_EQ(NULL, blob_read_aligned_bytes(&reader, sizeof(uint32_t), 1));
+   EXPECT_TRUE(reader.overrun);
+
+   blob_finish(&blob);
+}
+
 // Test that we detect overrun.
 TEST(BlobTest, DetectOverrun)
 {
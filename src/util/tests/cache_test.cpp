@@ -519,6 +519,149 @@ test_put_and_get_between_instances()
    disk_cache_destroy(cache1);
    disk_cache_destroy(cache2);
 }
+
+static void
+test_mem_cache(void)
+{
+   char blob[] = "This is a blob of thirty-seven bytes";
+   uint8_t blob_key[20];
+   uint8_t *one_KB;
+   uint8_t one_KB_key[20];
+   struct disk_cache_mem_stats stats;
+   char *result;
+   size_t size;
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   /* Keep the on-disk cache large enough to never evict anything. */
+   setenv("MESA_SHADER_CACHE_MAX_SIZE", "1G", 1);
+   setenv("MESA_SHADER_CACHE_MEM_MAX_SIZE", "1K", 1);
+   struct disk_cache *cache = disk_cache_create("test_mem", "make_check", 0);
+   unsetenv("MESA_SHADER_CACHE_MEM_MAX_SIZE");
+
+   disk_cache_get_mem_stats(cache, &stats);
+   EXPECT_EQ(stats.max_size, 1024) << "in-memory tier size";
+
+   disk_cache_compute_key(cache, blob, sizeof(blob), blob_key);
+
+   result = (char *) disk_cache_get(cache, blob_key, &size);
+   EXPECT_EQ(result, nullptr) << "disk_cache_get with non-existent item";
+
+   disk_cache_put(cache, blob_key, blob, sizeof(blob), NULL);
+
+   /* The item is held in memory right away, so no need to wait for the
+    * writer thread.
+    */
+   result = (char *) disk_cache_get(cache, blob_key, &size);
+   EXPECT_STREQ(result, blob) << "disk_cache_get of item in memory (pointer)";
+   EXPECT_EQ(size, sizeof(blob)) << "disk_cache_get of item in memory (size)";
+   free(result);
+
+   disk_cache_get_mem_stats(cache, &stats);
+   EXPECT_EQ(stats.hits, 1) << "in-memory tier hits";
+   EXPECT_EQ(stats.misses, 1) << "in-memory tier misses";
+   EXPECT_EQ(stats.size, sizeof(blob)) << "in-memory tier bytes";
+
+   /* A 1KB item fills the whole tier and must evict the blob. */
+   one_KB = (uint8_t *) calloc(1, 1024);
+   one_KB[0] = 'm';
+   disk_cache_compute_key(cache, one_KB, 1024, one_KB_key);
+   disk_cache_put(cache, one_KB_key, one_KB, 1024, NULL);
+   free(one_KB);
+
+   disk_cache_get_mem_stats(cache, &stats);
+   EXPECT_EQ(stats.size, 1024) << "in-memory tier evicts to fit";
+
+   /* The evicted item is still available from disk and gets pulled back
+    * into memory.
+    */
+   disk_cache_wait_for_idle(cache);
+   result = (char *) disk_cache_get(cache, blob_key, &size);
+   EXPECT_STREQ(result, blob) << "disk_cache_get of evicted item (pointer)";
+   free(result);
+
+   disk_cache_get_mem_stats(cache, &stats);
+   EXPECT_EQ(stats.misses, 2) << "in-memory tier misses after eviction";
+   EXPECT_EQ(stats.size, sizeof(blob)) << "in-memory tier reloads item";
+
+   disk_cache_remove(cache, blob_key);
+   result = (char *) disk_cache_get(cache, blob_key, &size);
+   EXPECT_EQ(result, nullptr) << "disk_cache_get of removed item";
+
+   disk_cache_destroy(cache);
+}
+
+/* Put an item of incompressible data, so that its file is a little larger
+ * than size on any file system.
+ */
+static void
+put_random_item(struct disk_cache *cache, uint32_t seed, size_t size,
+                cache_key key)
+{
+   uint32_t *data = (uint32_t *) malloc(size);
+
+   for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+      seed = seed * 1664525 + 1013904223;
+      data[i] = seed;
+   }
+
+   disk_cache_compute_key(cache, data, size, key);
+   disk_cache_put(cache, key, data, size, NULL);
+   free(data);
+}
+
+static void
+test_lru_eviction(void)
+{
+   const size_t item_size = 64 * 1024;
+   uint8_t keys[4][20];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   /* Room for three items, but not for a fourth one. */
+   setenv("MESA_SHADER_CACHE_MAX_SIZE", "256K", 1);
+   struct disk_cache *cache = disk_cache_create("test_lru", "make_check", 0);
+
+   for (unsigned i = 0; i < 3; i++) {
+      put_random_item(cache, i, item_size, keys[i]);
+      disk_cache_wait_for_idle(cache);
+   }
+
+   /* Using the first item makes the second one least recently used. */
+   EXPECT_TRUE(does_cache_contain(cache, keys[0])) << "first item was put";
+
+   /* The fourth item overflows the cache, and eviction frees room for
+    * another item from the least recently used ones.
+    */
+   put_random_item(cache, 3, item_size, keys[3]);
+   disk_cache_wait_for_idle(cache);
+
+   EXPECT_FALSE(does_cache_contain(cache, keys[1])) << "LRU item evicted";
+   EXPECT_FALSE(does_cache_contain(cache, keys[2])) << "2nd LRU item evicted";
+   EXPECT_TRUE(does_cache_contain(cache, keys[0])) << "used item kept";
+   EXPECT_TRUE(does_cache_contain(cache, keys[3])) << "new item kept";
+
+   disk_cache_destroy(cache);
+
+   /* The journal is shared with new instances of the cache. */
+   cache = disk_cache_create("test_lru", "make_check", 0);
+
+   put_random_item(cache, 4, item_size, keys[1]);
+   disk_cache_wait_for_idle(cache);
+   put_random_item(cache, 5, item_size, keys[2]);
+   disk_cache_wait_for_idle(cache);
+
+   EXPECT_FALSE(does_cache_contain(cache, keys[0])) << "LRU item evicted "
+                                                       "by new instance";
+   EXPECT_TRUE(does_cache_contain(cache, keys[2])) << "new item kept by "
+                                                      "new instance";
+
+   disk_cache_destroy(cache);
+}
 #endif /* ENABLE_SHADER_CACHE */
 
 class Cache : public ::testing::Test {
@@ -549,6 +692,40 @@ TEST_F(Cache, MultiFile)
 #endif
 }
 
+TEST_F(Cache, Memory)
+{
+#ifndef ENABLE_SHADER_CACHE
+   GTEST_SKIP() << "ENABLE_SHADER_CACHE not defined.";
+#else
+   int err = mkdir(CACHE_TEST_TMP, 0755);
+   ASSERT_EQ(err, 0) << "Creating " CACHE_TEST_TMP;
+
+   setenv("MESA_SHADER_CACHE_DIR", CACHE_TEST_TMP "/mesa-shader-cache-dir", 1);
+
+   test_mem_cache();
+
+   err = rmrf_local(CACHE_TEST_TMP);
+   EXPECT_EQ(err, 0) << "Removing " CACHE_TEST_TMP " again";
+#endif
+}
+
+TEST_F(Cache, LRU)
+{
+#ifndef ENABLE_SHADER_CACHE
+   GTEST_SKIP() << "ENABLE_SHADER_CACHE not defined.";
+#else
+   int err = mkdir(CACHE_TEST_TMP, 0755);
+   ASSERT_EQ(err, 0) << "Creating " CACHE_TEST_TMP;
+
+   setenv("MESA_SHADER_CACHE_DIR", CACHE_TEST_TMP "/mesa-shader-cache-dir", 1);
+
+   test_lru_eviction();
+
+   err = rmrf_local(CACHE_TEST_TMP);
+   EXPECT_EQ(err, 0) << "Removing " CACHE_TEST_TMP " again";
+#endif
+}
+
 TEST_F(Cache, SingleFile)
 {
 #ifndef ENABLE_SHADER_CACHE
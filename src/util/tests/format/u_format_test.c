@@ -29,6 +29,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <float.h>
+#include <math.h>
+#include <string.h>
 
 #include "util/half_float.h"
 #include "util/u_math.h"
@@ -731,6 +733,66 @@ test_format_norm_flags(const struct util_format_description *format_desc)
    return success;
 }
 
+/* Unpacks a long row through the selected (possibly SIMD) unpack functions
+ * and checks that it matches the generic code, covering both the vector
+ * loops and their tails.
+ */
+static boolean
+test_format_unpack_span(const struct util_format_description *format_desc)
+{
+   const struct util_format_unpack_description *unpack =
+      util_format_unpack_description(format_desc->format);
+   const struct util_format_unpack_description *generic =
+      util_format_unpack_description_generic(format_desc->format);
+   const unsigned width = 67;
+   uint8_t packed[67 * UTIL_FORMAT_MAX_PACKED_BYTES];
+   float obtained[67][4], expected[67][4];
+   uint8_t obtained_8unorm[67][4], expected_8unorm[67][4];
+   unsigned i, j;
+   boolean success = TRUE;
+
+   if (unpack == generic ||
+       format_desc->block.width != 1 || format_desc->block.height != 1)
+      return TRUE;
+
+   for (i = 0; i < sizeof packed; ++i)
+      packed[i] = rand();
+
+   if (unpack->unpack_rgba && generic->unpack_rgba) {
+      unpack->unpack_rgba(obtained, packed, width);
+      generic->unpack_rgba(expected, packed, width);
+
+      for (i = 0; i < width; ++i) {
+         for (j = 0; j < 4; ++j) {
+            if (memcmp(&obtained[i][j], &expected[i][j], sizeof(float)) &&
+                !(isnan(obtained[i][j]) && isnan(expected[i][j]))) {
+               printf("FAILED: pixel %u channel %u: %f obtained, %f expected\n",
+                      i, j, obtained[i][j], expected[i][j]);
+               success = FALSE;
+            }
+         }
+      }
+   }
+
+   if (unpack->unpack_rgba_8unorm && generic->unpack_rgba_8unorm) {
+      unpack->unpack_rgba_8unorm(&obtained_8unorm[0][0], packed, width);
+      generic->unpack_rgba_8unorm(&expected_8unorm[0][0], packed, width);
+
+      for (i = 0; i < width; ++i) {
+         for (j = 0; j < 4; ++j) {
+            if (obtained_8unorm[i][j] != expected_8unorm[i][j]) {
+               printf("FAILED: pixel %u channel %u: 0x%02x obtained, 0x%02x expected\n",
+                      i, j, obtained_8unorm[i][j], expected_8unorm[i][j]);
+               success = FALSE;
+            }
+         }
+      }
+   }
+
+   return success;
+}
+
+
 typedef boolean
 (*test_func_t)(const struct util_format_description *format_desc,
                const struct util_format_test_case *test);
@@ -856,6 +918,7 @@ test_all(void)
       TEST_ONE_PACK_FUNC(pack_s_8uint);
 
       TEST_FORMAT_METADATA(norm_flags);
+      TEST_FORMAT_METADATA(unpack_span);
 
 #     undef TEST_ONE_FUNC
 #     undef TEST_ONE_FORMAT
@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "hash_table.h"
+
+#define SIZE 10000
+
+static uint32_t
+key_value(const void *key)
+{
+   return *(const uint32_t *)key;
+}
+
+static bool
+uint32_t_key_equals(const void *a, const void *b)
+{
+   return key_value(a) == key_value(b);
+}
+
+/* Tests the grouped layout with the same sequences as the other tests. */
+int
+main(int argc, char **argv)
+{
+   struct hash_table *ht, *clone;
+   struct hash_entry *entry;
+   uint32_t keys[SIZE];
+   uint32_t i;
+
+   (void) argc;
+   (void) argv;
+
+   ht = _mesa_hash_table_create_grouped(NULL, key_value, uint32_t_key_equals);
+
+   for (i = 0; i < SIZE; i++) {
+      keys[i] = i;
+
+      _mesa_hash_table_insert(ht, keys + i, NULL);
+
+      if (i >= 100) {
+         uint32_t delete_value = i - 100;
+         entry = _mesa_hash_table_search(ht, &delete_value);
+         _mesa_hash_table_remove(ht, entry);
+      }
+   }
+
+   for (i = 0; i < SIZE; i++) {
+      entry = _mesa_hash_table_search(ht, keys + i);
+      if (i < SIZE - 100) {
+         assert(!entry);
+      } else {
+         assert(entry);
+         assert(key_value(entry->key) == i);
+      }
+   }
+   assert(ht->entries == 100);
+
+   /* Replacement keeps a single entry. */
+   _mesa_hash_table_insert(ht, keys + SIZE - 1, keys);
+   assert(ht->entries == 100);
+   entry = _mesa_hash_table_search(ht, keys + SIZE - 1);
+   assert(entry && entry->data == keys);
+
+   clone = _mesa_hash_table_clone(ht, NULL);
+   assert(clone->entries == 100);
+   assert(_mesa_hash_table_search(clone, keys + SIZE - 50));
+   _mesa_hash_table_destroy(clone, NULL);
+
+   _mesa_hash_table_clear(ht, NULL);
+   assert(ht->entries == 0);
+   assert(!_mesa_hash_table_search(ht, keys + SIZE - 1));
+
+   assert(_mesa_hash_table_reserve(ht, SIZE));
+   for (i = 0; i < SIZE; i++)
+      _mesa_hash_table_insert(ht, keys + i, NULL);
+   assert(ht->entries == SIZE);
+
+   hash_table_foreach_remove(ht, entry) {
+      assert(key_value(entry->key) < SIZE);
+   }
+   assert(ht->entries == 0);
+   assert(!_mesa_hash_table_next_entry(ht, NULL));
+
+   for (i = 0; i < SIZE; i += 2)
+      _mesa_hash_table_insert(ht, keys + i, NULL);
+   for (i = 0; i < SIZE; i++)
+      assert(!!_mesa_hash_table_search(ht, keys + i) == !(i & 1));
+
+   _mesa_hash_table_destroy(ht, NULL);
+
+   return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Compares the default and the grouped layouts of struct hash_table and
+ * struct set, with pointer keys like the remap tables of the compiler.
+ *
+ * Usage: hash_table_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util/hash_table.h"
+#include "util/os_time.h"
+#include "util/set.h"
+
+static const unsigned sizes[] = { 8, 64, 512, 4096, 32768, 262144 };
+
+static void **keys;
+static void **misses;
+
+static void
+report(const char *what, const char *layout, unsigned size,
+       int64_t ns, uint64_t ops)
+{
+   printf("%-12s %-8s %8u %8.2f ns/op\n", what, layout, size,
+          (double)ns / ops);
+}
+
+static void
+bench_hash_table(bool grouped, unsigned size, unsigned iterations)
+{
+   const char *layout = grouped ? "grouped" : "default";
+   int64_t insert = 0, hit = 0, miss = 0, remove = 0;
+   uintptr_t sum = 0;
+
+   for (unsigned it = 0; it < iterations; it++) {
+      struct hash_table *ht = grouped ?
+         _mesa_hash_table_create_grouped(NULL, _mesa_hash_pointer,
+                                         _mesa_key_pointer_equal) :
+         _mesa_pointer_hash_table_create(NULL);
+
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         _mesa_hash_table_insert(ht, keys[i], keys[i]);
+      int64_t inserted = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         sum += (uintptr_t)_mesa_hash_table_search(ht, keys[i])->data;
+      int64_t searched = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         sum += _mesa_hash_table_search(ht, misses[i]) != NULL;
+      int64_t missed = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         _mesa_hash_table_remove_key(ht, keys[i]);
+      int64_t removed = os_time_get_nano();
+
+      insert += inserted - start;
+      hit += searched - inserted;
+      miss += missed - searched;
+      remove += removed - missed;
+
+      _mesa_hash_table_destroy(ht, NULL);
+   }
+
+   uint64_t ops = (uint64_t)size * iterations;
+   report("ht insert", layout, size, insert, ops);
+   report("ht hit", layout, size, hit, ops);
+   report("ht miss", layout, size, miss, ops);
+   report("ht remove", layout, size, remove, ops);
+
+   /* Keep the lookups from being optimized away. */
+   if (sum == 1)
+      printf("\n");
+}
+
+static void
+bench_set(bool grouped, unsigned size, unsigned iterations)
+{
+   const char *layout = grouped ? "grouped" : "default";
+   int64_t add = 0, hit = 0, miss = 0;
+   uintptr_t sum = 0;
+
+   for (unsigned it = 0; it < iterations; it++) {
+      struct set *s = grouped ?
+         _mesa_set_create_grouped(NULL, _mesa_hash_pointer,
+                                  _mesa_key_pointer_equal) :
+         _mesa_pointer_set_create(NULL);
+
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         _mesa_set_add(s, keys[i]);
+      int64_t added = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         sum += _mesa_set_search(s, keys[i]) != NULL;
+      int64_t searched = os_time_get_nano();
+      for (unsigned i = 0; i < size; i++)
+         sum += _mesa_set_search(s, misses[i]) != NULL;
+      int64_t missed = os_time_get_nano();
+
+      add += added - start;
+      hit += searched - added;
+      miss += missed - searched;
+
+      _mesa_set_destroy(s, NULL);
+   }
+
+   uint64_t ops = (uint64_t)size * iterations;
+   report("set add", layout, size, add, ops);
+   report("set hit", layout, size, hit, ops);
+   report("set miss", layout, size, miss, ops);
+
+   if (sum == 1)
+      printf("\n");
+}
+
+int
+main(int argc, char **argv)
+{
+   unsigned max_size = sizes[ARRAY_SIZE(sizes) - 1];
+   unsigned total = argc > 1 ? atoi(argv[1]) : 4 * 1024 * 1024;
+
+   /* Heap addresses of similar objects, as in the compiler. */
+   keys = malloc(max_size * sizeof(*keys));
+   misses = malloc(max_size * sizeof(*misses));
+   for (unsigned i = 0; i < max_size; i++) {
+      keys[i] = malloc(48);
+      misses[i] = malloc(48);
+   }
+
+   for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++) {
+      unsigned iterations = MAX2(total / sizes[i], 1);
+
+      bench_hash_table(false, sizes[i], iterations);
+      bench_hash_table(true, sizes[i], iterations);
+      bench_set(false, sizes[i], iterations);
+      bench_set(true, sizes[i], iterations);
+   }
+
+   for (unsigned i = 0; i < max_size; i++) {
+      free(keys[i]);
+      free(misses[i]);
+   }
+   free(keys);
+   free(misses);
+
+   return 0;
+}
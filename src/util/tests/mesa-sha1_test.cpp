@@ -22,6 +22,8 @@
  */
 
 #include "mesa-sha1.h"
+#include "macros.h"
+#include "u_math.h"
 
 #include <gtest/gtest.h>
 
@@ -57,3 +59,79 @@ TEST_P(MesaSHA1TestFixture, Match)
       << "\t  Actual: " << buf << "\n"
       << "\tExpected: " << p.expected_sha1 << "\n";
 }
+
+TEST(MesaSHA1Test, MillionA)
+{
+   static const char expected_sha1[] = "34aa973cd4c4daa4f61eeb2bdbad27316534016f";
+   char a[1000];
+   memset(a, 'a', sizeof(a));
+
+   /* Feed the data in uneven pieces so that partial blocks get buffered. */
+   struct mesa_sha1 ctx;
+   _mesa_sha1_init(&ctx);
+   size_t left = 1000000;
+   for (size_t i = 1; left; i = (i * 7 + 3) % sizeof(a)) {
+      size_t size = MIN2(i, left);
+      _mesa_sha1_update(&ctx, a, size);
+      left -= size;
+   }
+
+   unsigned char sha1[20];
+   _mesa_sha1_final(&ctx, sha1);
+
+   char buf[41];
+   _mesa_sha1_format(buf, sha1);
+   EXPECT_STREQ(buf, expected_sha1);
+}
+
+TEST(MesaSHA1Test, MatchesPortable)
+{
+   uint8_t data[4096 + 17];
+   for (size_t i = 0; i < sizeof(data); i++)
+      data[i] = (uint8_t)(i * 131 + (i >> 5));
+
+   for (size_t size = 0; size <= sizeof(data); size += 61) {
+      SHA1_CTX ref;
+      unsigned char expected[20], sha1[20];
+
+      SHA1Init(&ref);
+      SHA1Update(&ref, data, size);
+      SHA1Final(expected, &ref);
+
+      _mesa_sha1_compute(data, size, sha1);
+      EXPECT_EQ(memcmp(sha1, expected, sizeof(sha1)), 0) << "size " << size;
+   }
+}
+
+TEST(MesaSHA1Test, Tree)
+{
+   const size_t chunk = MESA_SHA1_TREE_CHUNK_SIZE;
+   const size_t size = chunk * 3 + chunk / 2;
+   uint8_t *data = (uint8_t *)malloc(size);
+   ASSERT_NE(data, nullptr);
+   for (size_t i = 0; i < size; i++)
+      data[i] = (uint8_t)(i ^ (i >> 11));
+
+   /* Small inputs are hashed as plain SHA-1. */
+   unsigned char expected[20], sha1[20];
+   _mesa_sha1_compute(data, chunk, expected);
+   _mesa_sha1_compute_tree(data, chunk, sha1);
+   EXPECT_EQ(memcmp(sha1, expected, sizeof(sha1)), 0);
+
+   /* Larger ones hash the size and then every chunk's hash. */
+   struct mesa_sha1 ctx;
+   uint64_t size64 = util_cpu_to_le64(size);
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &size64, sizeof(size64));
+   for (size_t offset = 0; offset < size; offset += chunk) {
+      unsigned char leaf[20];
+      _mesa_sha1_compute(data + offset, MIN2(chunk, size - offset), leaf);
+      _mesa_sha1_update(&ctx, leaf, sizeof(leaf));
+   }
+   _mesa_sha1_final(&ctx, expected);
+
+   _mesa_sha1_compute_tree(data, size, sha1);
+   EXPECT_EQ(memcmp(sha1, expected, sizeof(sha1)), 0);
+
+   free(data);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "util/ralloc.h"
+
+static int destroyed;
+
+static void
+count_destructor(void *ptr)
+{
+   destroyed++;
+}
+
+TEST(ralloc, arena_free_all)
+{
+   void *arena = ralloc_arena_context(NULL);
+   ASSERT_NE(arena, nullptr);
+
+   void *ctx = ralloc_context(arena);
+   for (unsigned i = 0; i < 10000; i++) {
+      uint32_t *p = (uint32_t *) ralloc_size(i % 2 ? ctx : arena, 24);
+      ASSERT_NE(p, nullptr);
+      *p = i;
+   }
+
+   /* Too big for the arena chunks, must still be released with it. */
+   void *big = ralloc_size(ctx, 1024 * 1024);
+   ASSERT_NE(big, nullptr);
+   memset(big, 0xff, 1024 * 1024);
+
+   ralloc_free(arena);
+}
+
+TEST(ralloc, arena_destructors)
+{
+   void *arena = ralloc_arena_context(NULL);
+   destroyed = 0;
+
+   void *a = ralloc_size(arena, 16);
+   void *b = ralloc_context(a);
+   ralloc_set_destructor(b, count_destructor);
+   void *c = ralloc_size(arena, 16);
+   ralloc_set_destructor(c, count_destructor);
+
+   ralloc_free(c);
+   EXPECT_EQ(destroyed, 1);
+
+   ralloc_free(arena);
+   EXPECT_EQ(destroyed, 2);
+}
+
+TEST(ralloc, arena_resize_and_steal)
+{
+   void *arena = ralloc_arena_context(NULL);
+   void *other = ralloc_context(NULL);
+
+   char *str = ralloc_strdup(arena, "foo");
+   void *child = ralloc_size(str, 8);
+   for (unsigned i = 0; i < 1000; i++)
+      ralloc_strcat(&str, "bar");
+   EXPECT_EQ(strlen(str), 3 + 3 * 1000);
+   EXPECT_EQ(strncmp(str, "foobarbar", 9), 0);
+   EXPECT_EQ(ralloc_parent(child), str);
+   EXPECT_EQ(ralloc_parent(str), arena);
+
+   /* Blocks stolen into an arena are released with it. */
+   void *stolen = ralloc_size(other, 32);
+   ralloc_steal(arena, stolen);
+
+   /* Blocks stolen out of an arena stay valid until it is freed. */
+   void *moved = ralloc_size(arena, 32);
+   ralloc_steal(other, moved);
+   memset(moved, 0, 32);
+   ralloc_free(other);
+
+   ralloc_free(arena);
+}
+
+TEST(ralloc, nested_arena)
+{
+   void *ctx = ralloc_context(NULL);
+   void *outer = ralloc_arena_context(ctx);
+   void *inner = ralloc_arena_context(outer);
+   destroyed = 0;
+
+   for (unsigned i = 0; i < 100; i++) {
+      ralloc_size(outer, 64);
+      ralloc_size(inner, 64);
+   }
+   ralloc_set_destructor(ralloc_size(inner, 8), count_destructor);
+
+   ralloc_free(ctx);
+   EXPECT_EQ(destroyed, 1);
+}
+
+TEST(ralloc, thread_allocated_bytes)
+{
+   void *ctx = ralloc_context(NULL);
+   void *arena = ralloc_arena_context(ctx);
+   uint64_t start = ralloc_thread_allocated_bytes();
+
+   void *ptr = ralloc_size(ctx, 100);
+   ralloc_size(arena, 50);
+   EXPECT_EQ(ralloc_thread_allocated_bytes() - start, 150u);
+
+   /* Resizing counts the new size, freeing doesn't give anything back. */
+   reralloc_size(ctx, ptr, 300);
+   ralloc_free(ctx);
+   EXPECT_EQ(ralloc_thread_allocated_bytes() - start, 450u);
+}
@@ -22,6 +22,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
 #include "ralloc.h"
 #include "register_allocate.h"
 #include "register_allocate_internal.h"
@@ -217,7 +220,7 @@ TEST_F(ra_test, serialization_roundtrip)
    struct blob blob;
    blob_init(&blob);
 
-   for (int i = 0; i < 2; i++) {
+   for (int i = 0; i < 3; i++) {
       void *mem_ctx = ralloc_context(this->mem_ctx);
       struct ra_regs *regs;
 
@@ -253,7 +256,19 @@ TEST_F(ra_test, serialization_roundtrip)
          struct blob_reader reader;
          blob_reader_init(&reader, blob.data, blob.size);
 
-         regs = ra_set_deserialize(mem_ctx, &reader);
+         if (i == 1) {
+            regs = ra_set_deserialize(mem_ctx, &reader);
+         } else {
+            regs = ra_set_deserialize_borrowed(mem_ctx, &reader);
+
+            /* The bitsets point into the serialized data. */
+            const uint8_t *regs8 =
+               (const uint8_t *)ra_get_class_from_index(regs, 0)->regs;
+            EXPECT_GE(regs8, blob.data);
+            EXPECT_LT(regs8, blob.data + blob.size);
+         }
+         EXPECT_FALSE(reader.overrun);
+         EXPECT_EQ(reader.current, reader.end);
       }
 
       /* Verify the register set for each case. */
@@ -279,3 +294,81 @@ TEST_F(ra_test, serialization_roundtrip)
    blob_finish(&blob);
 }
 
+
+static void
+check_allocation(struct ra_graph *g, const std::vector<std::pair<unsigned, unsigned>> &edges)
+{
+   for (auto &e : edges)
+      ASSERT_NE(ra_get_node_reg(g, e.first), ra_get_node_reg(g, e.second));
+}
+
+/* Spilling a node and patching the graph in place must allocate the same
+ * registers as building a new graph from scratch.
+ */
+TEST_F(ra_test, patch_graph_after_spill)
+{
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, 8, true);
+   struct ra_class *c = ra_alloc_reg_class(regs);
+   for (int i = 0; i < 8; i++)
+      ra_class_add_reg(c, i);
+   ra_set_finalize(regs, NULL);
+
+   /* Live ranges of 10 values each overlapping with the next 9, in a
+    * program of 200 values.
+    */
+   const unsigned count = 200;
+   std::vector<std::pair<unsigned, unsigned>> edges;
+   for (unsigned i = 0; i < count; i++) {
+      for (unsigned j = i + 1; j < MIN2(count, i + 10); j++)
+         edges.push_back(std::make_pair(i, j));
+   }
+
+   struct ra_graph *g = ra_alloc_interference_graph(regs, count);
+   for (unsigned i = 0; i < count; i++) {
+      ra_set_node_class(g, i, c);
+      ra_set_node_spill_cost(g, i, 1.0f + i % 3);
+   }
+   for (auto &e : edges)
+      ra_add_node_interference(g, e.first, e.second);
+
+   unsigned nodes = count;
+   while (!ra_allocate(g)) {
+      int spill = ra_get_best_spill_node(g);
+      ASSERT_GE(spill, 0);
+
+      /* The spilled value is replaced by a fill that only interferes with its
+       * direct neighbours.
+       */
+      ra_reset_node_interference(g, spill);
+      ra_set_node_spill_cost(g, spill, 0.0f);
+      edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                 [&](const std::pair<unsigned, unsigned> &e) {
+                                    return e.first == (unsigned)spill ||
+                                           e.second == (unsigned)spill;
+                                 }), edges.end());
+
+      unsigned fill = ra_add_node(g, c);
+      for (unsigned n = MAX2(spill, 1) - 1; n <= MIN2(spill + 1, count - 1); n++) {
+         if (n != (unsigned)spill) {
+            ra_add_node_interference(g, fill, n);
+            edges.push_back(std::make_pair(fill, n));
+         }
+      }
+      nodes++;
+   }
+   check_allocation(g, edges);
+   ASSERT_GT(nodes, count);
+
+   struct ra_graph *fresh = ra_alloc_interference_graph(regs, nodes);
+   for (unsigned i = 0; i < nodes; i++)
+      ra_set_node_class(fresh, i, c);
+   for (auto &e : edges)
+      ra_add_node_interference(fresh, e.first, e.second);
+   ASSERT_TRUE(ra_allocate(fresh));
+
+   for (unsigned i = 0; i < nodes; i++)
+      ASSERT_EQ(ra_get_node_reg(g, i), ra_get_node_reg(fresh, i));
+
+   ralloc_free(fresh);
+   ralloc_free(g);
+}
@@ -171,3 +171,72 @@ TEST(set, search_or_add)
 
    _mesa_set_destroy(s, NULL);
 }
+
+static uint32_t
+bad_hash(const void *key)
+{
+   /* Only a few distinct hashes, to fill whole groups with collisions. */
+   return (uintptr_t)key % 7;
+}
+
+static void
+check_grouped_set(uint32_t (*hash)(const void *key))
+{
+   struct set *s = _mesa_set_create_grouped(NULL, hash,
+                                            _mesa_key_pointer_equal);
+   struct set *ref = _mesa_set_create(NULL, hash, _mesa_key_pointer_equal);
+
+   for (uintptr_t i = 1; i < 2000; i++) {
+      _mesa_set_add(s, (void *)i);
+      _mesa_set_add(ref, (void *)i);
+   }
+   for (uintptr_t i = 1; i < 2000; i += 3) {
+      _mesa_set_remove_key(s, (void *)i);
+      _mesa_set_remove_key(ref, (void *)i);
+   }
+   for (uintptr_t i = 1; i < 3000; i += 2) {
+      bool found, ref_found;
+      _mesa_set_search_or_add(s, (void *)i, &found);
+      _mesa_set_search_or_add(ref, (void *)i, &ref_found);
+      EXPECT_EQ(found, ref_found);
+   }
+
+   EXPECT_EQ(s->entries, ref->entries);
+   for (uintptr_t i = 1; i < 3000; i++)
+      EXPECT_EQ(!!_mesa_set_search(s, (void *)i),
+                !!_mesa_set_search(ref, (void *)i));
+   set_foreach(s, entry)
+      EXPECT_TRUE(_mesa_set_search(ref, entry->key));
+
+   struct set *clone = _mesa_set_clone(s, NULL);
+   EXPECT_EQ(clone->entries, s->entries);
+   for (uintptr_t i = 1; i < 3000; i++)
+      EXPECT_EQ(!!_mesa_set_search(clone, (void *)i),
+                !!_mesa_set_search(ref, (void *)i));
+   _mesa_set_destroy(clone, NULL);
+
+   _mesa_set_clear(s, NULL);
+   for (uintptr_t i = 1; i < 100; i++)
+      _mesa_set_add(s, (void *)i);
+   set_foreach_remove(s, entry) {
+   }
+   EXPECT_EQ(s->entries, 0);
+   for (uintptr_t i = 1; i < 100; i++)
+      _mesa_set_add(s, (void *)(i * 2));
+   EXPECT_EQ(s->entries, 99);
+   EXPECT_TRUE(_mesa_set_search(s, (void *)42));
+   EXPECT_FALSE(_mesa_set_search(s, (void *)43));
+
+   _mesa_set_destroy(ref, NULL);
+   _mesa_set_destroy(s, NULL);
+}
+
+TEST(set, grouped)
+{
+   check_grouped_set(_mesa_hash_pointer);
+}
+
+TEST(set, grouped_collisions)
+{
+   check_grouped_set(bad_hash);
+}
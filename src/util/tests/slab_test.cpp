@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "util/slab.h"
+
+TEST(slab, foreign_free_is_batched)
+{
+   struct slab_parent_pool parent;
+   struct slab_child_pool owner, freer;
+   struct slab_child_stats stats;
+   void *elts[SLAB_MAGAZINE_SIZE];
+
+   slab_create_parent(&parent, 32, 16);
+   slab_create_child(&owner, &parent);
+   slab_create_child(&freer, &parent);
+
+   for (unsigned i = 0; i < SLAB_MAGAZINE_SIZE; i++)
+      elts[i] = slab_alloc(&owner);
+
+   slab_get_child_stats(&owner, &stats);
+   EXPECT_EQ(stats.num_pages, SLAB_MAGAZINE_SIZE / 16);
+
+   /* All but the last free stay in the magazine of the freeing pool. */
+   for (unsigned i = 0; i < SLAB_MAGAZINE_SIZE - 1; i++)
+      slab_free(&freer, elts[i]);
+
+   slab_get_child_stats(&freer, &stats);
+   EXPECT_EQ(stats.num_pages, 0);
+   EXPECT_EQ(stats.num_cached, SLAB_MAGAZINE_SIZE - 1);
+
+   /* A full magazine is handed back to the owner. */
+   slab_free(&freer, elts[SLAB_MAGAZINE_SIZE - 1]);
+   slab_get_child_stats(&freer, &stats);
+   EXPECT_EQ(stats.num_cached, 0);
+
+   /* The owner reuses the returned elements instead of growing. */
+   for (unsigned i = 0; i < SLAB_MAGAZINE_SIZE; i++)
+      elts[i] = slab_alloc(&owner);
+   slab_get_child_stats(&owner, &stats);
+   EXPECT_EQ(stats.num_pages, SLAB_MAGAZINE_SIZE / 16);
+
+   for (unsigned i = 0; i < SLAB_MAGAZINE_SIZE; i++)
+      slab_free(&owner, elts[i]);
+
+   slab_destroy_child(&freer);
+   slab_destroy_child(&owner);
+   slab_destroy_parent(&parent);
+}
+
+TEST(slab, owner_destroyed_while_cached)
+{
+   struct slab_parent_pool parent;
+   struct slab_child_pool owner, freer;
+   void *elts[8];
+
+   slab_create_parent(&parent, 32, 4);
+   slab_create_child(&owner, &parent);
+   slab_create_child(&freer, &parent);
+
+   for (unsigned i = 0; i < 8; i++)
+      elts[i] = slab_alloc(&owner);
+
+   for (unsigned i = 0; i < 4; i++)
+      slab_free(&freer, elts[i]);
+
+   /* The cached elements end up on orphaned pages, flushing them must
+    * free those pages rather than touch the destroyed owner.
+    */
+   slab_destroy_child(&owner);
+   slab_flush_magazines(&freer);
+
+   for (unsigned i = 4; i < 8; i++)
+      slab_free(&freer, elts[i]);
+
+   slab_destroy_child(&freer);
+   slab_destroy_parent(&parent);
+}
+
+TEST(slab, cross_thread_free)
+{
+   struct slab_parent_pool parent;
+   struct slab_child_pool owner;
+   const unsigned num_elts = 4096;
+   void **elts = new void *[num_elts];
+
+   slab_create_parent(&parent, 64, 64);
+   slab_create_child(&owner, &parent);
+
+   for (unsigned i = 0; i < num_elts; i++)
+      elts[i] = slab_alloc(&owner);
+
+   std::thread freers[4];
+   for (unsigned t = 0; t < 4; t++) {
+      freers[t] = std::thread([&parent, elts, t, num_elts]() {
+         struct slab_child_pool pool;
+         slab_create_child(&pool, &parent);
+         for (unsigned i = t; i < num_elts; i += 4)
+            slab_free(&pool, elts[i]);
+         slab_destroy_child(&pool);
+      });
+   }
+
+   /* Keep allocating from the owner while the other threads free. */
+   for (unsigned i = 0; i < num_elts; i++)
+      slab_free(&owner, slab_alloc(&owner));
+
+   for (unsigned t = 0; t < 4; t++)
+      freers[t].join();
+
+   struct slab_child_stats stats;
+   slab_get_child_stats(&owner, &stats);
+   unsigned pages = stats.num_pages;
+
+   /* Everything was returned, so this must not need new pages. */
+   for (unsigned i = 0; i < num_elts; i++)
+      elts[i] = slab_alloc(&owner);
+   slab_get_child_stats(&owner, &stats);
+   EXPECT_EQ(stats.num_pages, pages);
+
+   for (unsigned i = 0; i < num_elts; i++)
+      slab_free(&owner, elts[i]);
+
+   delete[] elts;
+   slab_destroy_child(&owner);
+   slab_destroy_parent(&parent);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "util/u_atomic.h"
+#include "util/u_queue.h"
+
+struct order_job {
+   unsigned id;
+   unsigned *order;
+   unsigned *num_done;
+};
+
+static void
+record_order(void *data, void *gdata, int thread_index)
+{
+   struct order_job *job = (struct order_job *) data;
+   unsigned idx = *job->num_done;
+   job->order[idx] = job->id;
+   *job->num_done = idx + 1;
+}
+
+static void
+wait_for_fence(void *data, void *gdata, int thread_index)
+{
+   util_queue_fence_wait((struct util_queue_fence *) data);
+}
+
+static void
+count_job(void *data, void *gdata, int thread_index)
+{
+   p_atomic_inc((unsigned *) data);
+}
+
+TEST(u_queue, high_priority_jumps_ahead)
+{
+   struct util_queue queue;
+   struct util_queue_fence block, block_done, fences[4];
+   struct order_job jobs[4];
+   unsigned order[4] = {0}, num_done = 0;
+
+   ASSERT_TRUE(util_queue_init(&queue, "test", 8, 1, 0, NULL));
+
+   /* Keep the only thread busy until all jobs are queued. */
+   util_queue_fence_init(&block);
+   util_queue_fence_reset(&block);
+   util_queue_fence_init(&block_done);
+   util_queue_add_job(&queue, &block, &block_done, wait_for_fence, NULL, 0);
+
+   for (unsigned i = 0; i < 4; i++) {
+      jobs[i].id = i;
+      jobs[i].order = order;
+      jobs[i].num_done = &num_done;
+      util_queue_fence_init(&fences[i]);
+   }
+
+   util_queue_add_job(&queue, &jobs[0], &fences[0], record_order, NULL, 0);
+   util_queue_add_job(&queue, &jobs[1], &fences[1], record_order, NULL, 0);
+   util_queue_add_job_with_priority(&queue, &jobs[2], &fences[2],
+                                    record_order, NULL, 0,
+                                    UTIL_QUEUE_PRIORITY_HIGH);
+   util_queue_add_job_with_priority(&queue, &jobs[3], &fences[3],
+                                    record_order, NULL, 0,
+                                    UTIL_QUEUE_PRIORITY_HIGH);
+
+   util_queue_fence_signal(&block);
+   util_queue_finish(&queue);
+
+   EXPECT_EQ(num_done, 4);
+   EXPECT_EQ(order[0], 2);
+   EXPECT_EQ(order[1], 3);
+   EXPECT_EQ(order[2], 0);
+   EXPECT_EQ(order[3], 1);
+
+   for (unsigned i = 0; i < 4; i++) {
+      EXPECT_TRUE(util_queue_fence_is_signalled(&fences[i]));
+      util_queue_fence_destroy(&fences[i]);
+   }
+   util_queue_fence_destroy(&block_done);
+   util_queue_fence_destroy(&block);
+   util_queue_destroy(&queue);
+}
+
+TEST(u_queue, add_jobs_batch)
+{
+   struct util_queue queue;
+   const unsigned num_jobs = 64;
+   struct util_queue_fence fences[num_jobs];
+   struct util_queue_job jobs[num_jobs];
+   unsigned count = 0;
+
+   /* Start with fewer slots than jobs to exercise resizing. */
+   ASSERT_TRUE(util_queue_init(&queue, "test", 8, 4,
+                               UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                               UTIL_QUEUE_INIT_SCALE_THREADS, NULL));
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      util_queue_fence_init(&fences[i]);
+      memset(&jobs[i], 0, sizeof(jobs[i]));
+      jobs[i].job = &count;
+      jobs[i].fence = &fences[i];
+      jobs[i].execute = count_job;
+   }
+
+   util_queue_add_jobs(&queue, jobs, num_jobs, UTIL_QUEUE_PRIORITY_NORMAL);
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      util_queue_fence_wait(&fences[i]);
+      util_queue_fence_destroy(&fences[i]);
+   }
+
+   EXPECT_EQ(p_atomic_read(&count), num_jobs);
+
+   util_queue_destroy(&queue);
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Fragmentation and throughput benchmark for util_vma_heap.
+ *
+ * The heap is filled with a number of live BO-like allocations of random
+ * size and alignment, freeing a random one from time to time so that it
+ * gets fragmented.  Then a steady state of frees and allocations is timed.
+ * The time per operation should stay roughly flat as the number of live
+ * allocations grows.
+ *
+ * Build with NDEBUG for meaningful numbers: debug builds validate the whole
+ * heap on every operation.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+#include <err.h>
+#else
+#define errx(code, msg, ...)             \
+   do {                                  \
+      fprintf(stderr, msg, __VA_ARGS__); \
+      exit(code);                        \
+   } while (0);
+#endif
+
+#include "vma.h"
+
+namespace {
+
+static const uint64_t MEM_PAGE_SIZE = 4096;
+static const uint64_t MEM_START = 1ull << 20;
+static const uint64_t MEM_SIZE = 1ull << 47;
+
+struct allocation {
+   uint64_t addr;
+   uint64_t size;
+};
+
+struct bench {
+   bench(bool alloc_high, uint_fast32_t seed)
+      : rand{seed}
+   {
+      util_vma_heap_init(&heap, MEM_START, MEM_SIZE);
+      heap.alloc_high = alloc_high;
+   }
+
+   ~bench()
+   {
+      util_vma_heap_finish(&heap);
+   }
+
+   /* Mostly small buffers, with a long tail of big ones, like a real
+    * application's BOs.
+    */
+   bool alloc()
+   {
+      std::geometric_distribution<> pages_order(0.4);
+      std::geometric_distribution<> align_order(0.6);
+
+      uint64_t size = (1ull << std::min(pages_order(rand), 16)) * MEM_PAGE_SIZE;
+      size += (rand() % 4) * MEM_PAGE_SIZE;
+      uint64_t align = (1ull << std::min(align_order(rand), 9)) * MEM_PAGE_SIZE;
+
+      uint64_t addr = util_vma_heap_alloc(&heap, size, align);
+      if (!addr)
+         return false;
+
+      allocations.push_back(allocation{addr, size});
+      return true;
+   }
+
+   void dealloc()
+   {
+      std::uniform_int_distribution<size_t> dist(0, allocations.size() - 1);
+      size_t i = dist(rand);
+
+      std::swap(allocations[i], allocations.back());
+      util_vma_heap_free(&heap, allocations.back().addr,
+                         allocations.back().size);
+      allocations.pop_back();
+   }
+
+   void fill(unsigned long count)
+   {
+      while (allocations.size() < count) {
+         if (!alloc())
+            errx(1, "heap full after %zu allocations\n", allocations.size());
+         /* Free one in four to leave holes behind */
+         if (rand() % 4 == 0)
+            dealloc();
+      }
+   }
+
+   void report_fragmentation()
+   {
+      std::vector<allocation> sorted = allocations;
+      std::sort(sorted.begin(), sorted.end(),
+                [](const allocation& a, const allocation& b) {
+                   return a.addr < b.addr;
+                });
+
+      /* Only count the holes between allocations, not the untouched space
+       * at either end of the heap.
+       */
+      uint64_t holes = 0, largest = 0, used = 0;
+      uint64_t last_end = sorted.front().addr;
+      for (const auto& a : sorted) {
+         if (a.addr > last_end) {
+            holes++;
+            largest = std::max(largest, a.addr - last_end);
+         }
+         used += a.size;
+         last_end = a.addr + a.size;
+      }
+
+      uint64_t span = last_end - sorted.front().addr;
+      printf("  %zu allocations, %" PRIu64 " holes between them, "
+             "%.1f%% of their range free, largest hole %" PRIu64 " KiB\n",
+             allocations.size(), holes, 100.0 * (span - used) / span,
+             largest / 1024);
+   }
+
+   double time_steady_state(unsigned long ops)
+   {
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned long i = 0; i < ops; i++) {
+         dealloc();
+         if (!alloc())
+            errx(1, "heap full after %zu allocations\n", allocations.size());
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      return std::chrono::duration<double, std::nano>(end - start).count() /
+             (2 * ops);
+   }
+
+   struct util_vma_heap heap;
+   std::default_random_engine rand;
+   std::vector<allocation> allocations;
+};
+
+}
+
+int main(int argc, char **argv)
+{
+   unsigned long max_live = 262144, ops = 100000;
+   if (argc == 3) {
+      char *arg_end = NULL;
+      max_live = strtoul(argv[1], &arg_end, 0);
+      if (!arg_end || *arg_end || max_live == 0 || max_live == ULONG_MAX)
+         errx(1, "invalid allocation count \"%s\"", argv[1]);
+
+      arg_end = NULL;
+      ops = strtoul(argv[2], &arg_end, 0);
+      if (!arg_end || *arg_end || ops == 0 || ops == ULONG_MAX)
+         errx(1, "invalid operation count \"%s\"", argv[2]);
+   } else if (argc != 1) {
+      errx(1, "USAGE: %s max_live_allocations ops\n", argv[0]);
+   }
+
+   for (int alloc_high = 1; alloc_high >= 0; alloc_high--) {
+      printf("alloc_high = %s\n", alloc_high ? "true" : "false");
+
+      for (unsigned long live = 1024; live <= max_live; live *= 4) {
+         bench b{(bool)alloc_high, 8675309};
+
+         b.fill(live);
+         printf("%lu live allocations: %.1f ns per alloc/free\n",
+                live, b.time_steady_state(ops));
+         b.report_fragmentation();
+      }
+   }
+
+   return 0;
+}
@@ -24,6 +24,10 @@
 #include <gtest/gtest.h>
 #include <driconf.h>
 #include <xmlconfig.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
 
 class xmlconfig_test : public ::testing::Test {
 protected:
@@ -289,3 +293,53 @@ TEST_F(xmlconfig_test, drirc_exec_regexp)
    driDestroyOptionCache(&cache);
 }
 #endif
+
+#if WITH_XMLCONFIG
+static void
+write_drirc(const std::string &path, const char *value)
+{
+   FILE *f = fopen(path.c_str(), "w");
+   ASSERT_NE(f, nullptr);
+   fprintf(f, "<driconf><device><application name=\"App\" executable=\"app1\">"
+              "<option name=\"mesa_drirc_option\" value=\"%s\" />"
+              "</application></device></driconf>\n", value);
+   fclose(f);
+}
+
+TEST_F(xmlconfig_test, drirc_file_changed)
+{
+   /* Parsed files are cached, make sure that a file changing between two
+    * parses is read again.
+    */
+   char dir[] = "/tmp/xmlconfig_test_XXXXXX";
+   ASSERT_NE(mkdtemp(dir), nullptr);
+   const std::string path = std::string(dir) + "/00-test.conf";
+
+   const char *configdir = getenv("DRIRC_CONFIGDIR");
+   const std::string old_configdir = configdir ? configdir : "";
+   setenv("DRIRC_CONFIGDIR", dir, 1);
+
+   write_drirc(path, "1");
+   driOptionCache cache = drirc_init("driver", "drm", "app1", NULL, 0, NULL, 0);
+   EXPECT_EQ(driQueryOptioni(&cache, "mesa_drirc_option"), 1);
+   driDestroyOptionCache(&cache);
+   driDestroyOptionInfo(&options);
+
+   cache = drirc_init("driver", "drm", "app1", NULL, 0, NULL, 0);
+   EXPECT_EQ(driQueryOptioni(&cache, "mesa_drirc_option"), 1);
+   driDestroyOptionCache(&cache);
+   driDestroyOptionInfo(&options);
+
+   write_drirc(path, "100");
+   cache = drirc_init("driver", "drm", "app1", NULL, 0, NULL, 0);
+   EXPECT_EQ(driQueryOptioni(&cache, "mesa_drirc_option"), 100);
+   driDestroyOptionCache(&cache);
+
+   unlink(path.c_str());
+   rmdir(dir);
+   if (configdir)
+      setenv("DRIRC_CONFIGDIR", old_configdir.c_str(), 1);
+   else
+      unsetenv("DRIRC_CONFIGDIR");
+}
+#endif
@@ -27,6 +27,14 @@
 
 #include "u_perfetto.h"
 
+#define UTIL_PERFETTO_CATEGORY "mesa"
+
+PERFETTO_DEFINE_CATEGORIES(
+   perfetto::Category(UTIL_PERFETTO_CATEGORY)
+      .SetDescription("Mesa CPU-side events"));
+
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+
 static void
 util_perfetto_init_once(void)
 {
@@ -34,6 +42,8 @@ util_perfetto_init_once(void)
    perfetto::TracingInitArgs args;
    args.backends = perfetto::kSystemBackend;
    perfetto::Tracing::Initialize(args);
+
+   perfetto::TrackEvent::Register();
 }
 
 static once_flag perfetto_once_flag = ONCE_FLAG_INIT;
@@ -43,3 +53,15 @@ util_perfetto_init(void)
 {
    call_once(&perfetto_once_flag, util_perfetto_init_once);
 }
+
+void
+util_perfetto_trace_begin(const char *name)
+{
+   TRACE_EVENT_BEGIN(UTIL_PERFETTO_CATEGORY, perfetto::DynamicString(name));
+}
+
+void
+util_perfetto_trace_end(void)
+{
+   TRACE_EVENT_END(UTIL_PERFETTO_CATEGORY);
+}
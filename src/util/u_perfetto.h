@@ -29,8 +29,38 @@
 extern "C" {
 #endif
 
+#ifdef HAVE_PERFETTO
+
 void util_perfetto_init(void);
 
+/* Begin and end a slice on the calling thread's track, in the "mesa"
+ * track event category.  The name is copied, so it doesn't need to outlive
+ * the call.
+ */
+void util_perfetto_trace_begin(const char *name);
+
+void util_perfetto_trace_end(void);
+
+#else
+
+static inline void
+util_perfetto_init(void)
+{
+}
+
+static inline void
+util_perfetto_trace_begin(const char *name)
+{
+   (void)name;
+}
+
+static inline void
+util_perfetto_trace_end(void)
+{
+}
+
+#endif /* HAVE_PERFETTO */
+
 #ifdef __cplusplus
 }
 #endif
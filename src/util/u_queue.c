@@ -300,6 +300,8 @@ util_queue_thread_func(void *input)
       memset(&queue->jobs[queue->read_idx], 0, sizeof(struct util_queue_job));
       queue->read_idx = (queue->read_idx + 1) % queue->max_jobs;
 
+      if (queue->num_high_priority)
+         queue->num_high_priority--;
       queue->num_queued--;
       cnd_signal(&queue->has_space_cond);
       if (job.job)
@@ -328,6 +330,7 @@ util_queue_thread_func(void *input)
       }
       queue->read_idx = queue->write_idx;
       queue->num_queued = 0;
+      queue->num_high_priority = 0;
    }
    mtx_unlock(&queue->lock);
    return 0;
@@ -547,41 +550,24 @@ util_queue_destroy(struct util_queue *queue)
    free(queue->threads);
 }
 
-void
-util_queue_add_job(struct util_queue *queue,
-                   void *job,
-                   struct util_queue_fence *fence,
-                   util_queue_execute_func execute,
-                   util_queue_execute_func cleanup,
-                   const size_t job_size)
+/* Must be called with the queue lock held. Waits for a free slot or grows
+ * the ring, and then inserts the job.
+ */
+static void
+util_queue_insert_job_locked(struct util_queue *queue,
+                             const struct util_queue_job *job,
+                             bool high_priority)
 {
    struct util_queue_job *ptr;
 
-   mtx_lock(&queue->lock);
-   if (queue->num_threads == 0) {
-      mtx_unlock(&queue->lock);
-      /* well no good option here, but any leaks will be
-       * short-lived as things are shutting down..
-       */
-      return;
-   }
-
-   if (fence)
-      util_queue_fence_reset(fence);
+   if (job->fence)
+      util_queue_fence_reset(job->fence);
 
    assert(queue->num_queued >= 0 && queue->num_queued <= queue->max_jobs);
 
-   /* Scale the number of threads up if there's already one job waiting. */
-   if (queue->num_queued > 0 &&
-       queue->flags & UTIL_QUEUE_INIT_SCALE_THREADS &&
-       execute != util_queue_finish_execute &&
-       queue->num_threads < queue->max_threads) {
-      util_queue_adjust_num_threads(queue, queue->num_threads + 1);
-   }
-
    if (queue->num_queued == queue->max_jobs) {
       if (queue->flags & UTIL_QUEUE_INIT_RESIZE_IF_FULL &&
-          queue->total_jobs_size + job_size < S_256MB) {
+          queue->total_jobs_size + job->job_size < S_256MB) {
          /* If the queue is full, make it larger to avoid waiting for a free
           * slot.
           */
@@ -608,29 +594,139 @@ util_queue_add_job(struct util_queue *queue,
          queue->write_idx = num_jobs;
          queue->max_jobs = new_max_jobs;
       } else {
-         /* Wait until there is a free slot. */
+         /* Wake up the threads in case we are in the middle of adding a
+          * batch of jobs they haven't been told about yet, and wait until
+          * there is a free slot.
+          */
+         cnd_broadcast(&queue->has_queued_cond);
          while (queue->num_queued == queue->max_jobs)
             cnd_wait(&queue->has_space_cond, &queue->lock);
       }
    }
 
-   ptr = &queue->jobs[queue->write_idx];
-   assert(ptr->job == NULL);
-   ptr->job = job;
+   if (high_priority) {
+      /* High priority jobs go right after the ones already queued at high
+       * priority, so shift all normal priority jobs back by one slot. Jobs
+       * are small and the queue is short, so this is cheap.
+       */
+      unsigned idx = (queue->read_idx + queue->num_high_priority) %
+                     queue->max_jobs;
+      unsigned i = queue->write_idx;
+
+      while (i != idx) {
+         unsigned prev = (i + queue->max_jobs - 1) % queue->max_jobs;
+         queue->jobs[i] = queue->jobs[prev];
+         i = prev;
+      }
+
+      ptr = &queue->jobs[idx];
+      queue->num_high_priority++;
+   } else {
+      ptr = &queue->jobs[queue->write_idx];
+      assert(ptr->job == NULL);
+   }
+
+   *ptr = *job;
    ptr->global_data = queue->global_data;
-   ptr->fence = fence;
-   ptr->execute = execute;
-   ptr->cleanup = cleanup;
-   ptr->job_size = job_size;
 
    queue->write_idx = (queue->write_idx + 1) % queue->max_jobs;
    queue->total_jobs_size += ptr->job_size;
 
    queue->num_queued++;
+}
+
+/* Scale the number of threads up if jobs are already waiting, one thread
+ * per job added. Must be called with the queue lock held.
+ */
+static void
+util_queue_scale_threads_locked(struct util_queue *queue, unsigned num_jobs,
+                                util_queue_execute_func execute)
+{
+   unsigned num_waiting = queue->num_queued > 0 ? num_jobs : num_jobs - 1;
+
+   if (num_waiting &&
+       queue->flags & UTIL_QUEUE_INIT_SCALE_THREADS &&
+       execute != util_queue_finish_execute &&
+       queue->num_threads < queue->max_threads) {
+      util_queue_adjust_num_threads(queue, queue->num_threads + num_waiting);
+   }
+}
+
+void
+util_queue_add_job_with_priority(struct util_queue *queue,
+                                 void *job,
+                                 struct util_queue_fence *fence,
+                                 util_queue_execute_func execute,
+                                 util_queue_execute_func cleanup,
+                                 const size_t job_size,
+                                 enum util_queue_priority priority)
+{
+   mtx_lock(&queue->lock);
+   if (queue->num_threads == 0) {
+      mtx_unlock(&queue->lock);
+      /* well no good option here, but any leaks will be
+       * short-lived as things are shutting down..
+       */
+      return;
+   }
+
+   const struct util_queue_job desc = {
+      .job = job,
+      .job_size = job_size,
+      .fence = fence,
+      .execute = execute,
+      .cleanup = cleanup,
+   };
+
+   util_queue_scale_threads_locked(queue, 1, execute);
+   util_queue_insert_job_locked(queue, &desc,
+                                priority == UTIL_QUEUE_PRIORITY_HIGH);
+
    cnd_signal(&queue->has_queued_cond);
    mtx_unlock(&queue->lock);
 }
 
+void
+util_queue_add_job(struct util_queue *queue,
+                   void *job,
+                   struct util_queue_fence *fence,
+                   util_queue_execute_func execute,
+                   util_queue_execute_func cleanup,
+                   const size_t job_size)
+{
+   util_queue_add_job_with_priority(queue, job, fence, execute, cleanup,
+                                    job_size, UTIL_QUEUE_PRIORITY_NORMAL);
+}
+
+void
+util_queue_add_jobs(struct util_queue *queue,
+                    const struct util_queue_job *jobs,
+                    unsigned num_jobs,
+                    enum util_queue_priority priority)
+{
+   if (!num_jobs)
+      return;
+
+   mtx_lock(&queue->lock);
+   if (queue->num_threads == 0) {
+      mtx_unlock(&queue->lock);
+      return;
+   }
+
+   util_queue_scale_threads_locked(queue, num_jobs, jobs[0].execute);
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      util_queue_insert_job_locked(queue, &jobs[i],
+                                   priority == UTIL_QUEUE_PRIORITY_HIGH);
+   }
+
+   if (num_jobs == 1)
+      cnd_signal(&queue->has_queued_cond);
+   else
+      cnd_broadcast(&queue->has_queued_cond);
+   mtx_unlock(&queue->lock);
+}
+
 /**
  * Remove a queued job. If the job hasn't started execution, it's removed from
  * the queue. If the job has started execution, the function waits for it to
@@ -52,6 +52,14 @@ extern "C" {
 #define UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY  (1 << 2)
 #define UTIL_QUEUE_INIT_SCALE_THREADS             (1 << 3)
 
+enum util_queue_priority {
+   UTIL_QUEUE_PRIORITY_NORMAL,
+   /* Executed before all normal priority jobs that haven't started yet, for
+    * latency sensitive work.
+    */
+   UTIL_QUEUE_PRIORITY_HIGH,
+};
+
 #if UTIL_FUTEX_SUPPORTED
 #define UTIL_QUEUE_FENCE_FUTEX
 #else
@@ -216,6 +224,7 @@ struct util_queue {
    unsigned num_threads; /* decreasing this number will terminate threads */
    int max_jobs;
    int write_idx, read_idx; /* ring buffer pointers */
+   int num_high_priority;   /* high priority jobs at the start of the ring */
    size_t total_jobs_size;  /* memory use of all jobs in the queue */
    struct util_queue_job *jobs;
    void *global_data;
@@ -239,6 +248,21 @@ void util_queue_add_job(struct util_queue *queue,
                         util_queue_execute_func execute,
                         util_queue_execute_func cleanup,
                         const size_t job_size);
+void util_queue_add_job_with_priority(struct util_queue *queue,
+                                      void *job,
+                                      struct util_queue_fence *fence,
+                                      util_queue_execute_func execute,
+                                      util_queue_execute_func cleanup,
+                                      const size_t job_size,
+                                      enum util_queue_priority priority);
+
+/* Add num_jobs jobs at once, taking the queue lock and waking up the threads
+ * only once. The global_data of the jobs is ignored, the queue's is used.
+ */
+void util_queue_add_jobs(struct util_queue *queue,
+                         const struct util_queue_job *jobs,
+                         unsigned num_jobs,
+                         enum util_queue_priority priority);
 void util_queue_drop_job(struct util_queue *queue,
                          struct util_queue_fence *fence);
 
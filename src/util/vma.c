@@ -31,6 +31,15 @@ struct util_vma_hole {
    struct list_head link;
    uint64_t offset;
    uint64_t size;
+
+   /* The holes also form a treap, i.e. a binary search tree on offset that
+    * is a max-heap on a random priority, which keeps it balanced.  Every
+    * node caches the size of the largest hole in its subtree so that
+    * searches can skip subtrees in which nothing fits.
+    */
+   struct util_vma_hole *left, *right;
+   uint64_t max_size;
+   uint32_t priority;
 };
 
 #define util_vma_foreach_hole(_hole, _heap) \
@@ -39,14 +48,181 @@ struct util_vma_hole {
 #define util_vma_foreach_hole_safe(_hole, _heap) \
    list_for_each_entry_safe(struct util_vma_hole, _hole, &(_heap)->holes, link)
 
-#define util_vma_foreach_hole_safe_rev(_hole, _heap) \
-   list_for_each_entry_safe_rev(struct util_vma_hole, _hole, &(_heap)->holes, link)
+static uint64_t
+util_vma_hole_tree_max(const struct util_vma_hole *hole)
+{
+   return hole ? hole->max_size : 0;
+}
+
+static void
+util_vma_hole_tree_update(struct util_vma_hole *hole)
+{
+   hole->max_size = MAX3(hole->size,
+                         util_vma_hole_tree_max(hole->left),
+                         util_vma_hole_tree_max(hole->right));
+}
+
+/* Splits tree into the holes below offset and the ones at or above it. */
+static void
+util_vma_hole_tree_split(struct util_vma_hole *tree, uint64_t offset,
+                         struct util_vma_hole **low,
+                         struct util_vma_hole **high)
+{
+   if (!tree) {
+      *low = *high = NULL;
+   } else if (tree->offset < offset) {
+      util_vma_hole_tree_split(tree->right, offset, &tree->right, high);
+      util_vma_hole_tree_update(tree);
+      *low = tree;
+   } else {
+      util_vma_hole_tree_split(tree->left, offset, low, &tree->left);
+      util_vma_hole_tree_update(tree);
+      *high = tree;
+   }
+}
+
+/* Joins two trees, all holes of low being below all holes of high. */
+static struct util_vma_hole *
+util_vma_hole_tree_merge(struct util_vma_hole *low, struct util_vma_hole *high)
+{
+   if (!low)
+      return high;
+   if (!high)
+      return low;
+
+   if (low->priority > high->priority) {
+      low->right = util_vma_hole_tree_merge(low->right, high);
+      util_vma_hole_tree_update(low);
+      return low;
+   } else {
+      high->left = util_vma_hole_tree_merge(low, high->left);
+      util_vma_hole_tree_update(high);
+      return high;
+   }
+}
+
+static void
+util_vma_hole_tree_insert(struct util_vma_heap *heap,
+                          struct util_vma_hole *hole)
+{
+   /* xorshift32 */
+   uint32_t x = heap->hole_tree_seed;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   heap->hole_tree_seed = x;
+
+   hole->priority = x;
+   hole->left = hole->right = NULL;
+   hole->max_size = hole->size;
+
+   struct util_vma_hole *low, *high;
+   util_vma_hole_tree_split(heap->hole_tree, hole->offset, &low, &high);
+   heap->hole_tree =
+      util_vma_hole_tree_merge(util_vma_hole_tree_merge(low, hole), high);
+}
+
+static struct util_vma_hole *
+util_vma_hole_tree_remove(struct util_vma_hole *tree,
+                          struct util_vma_hole *hole)
+{
+   if (tree == hole)
+      return util_vma_hole_tree_merge(hole->left, hole->right);
+
+   if (hole->offset < tree->offset)
+      tree->left = util_vma_hole_tree_remove(tree->left, hole);
+   else
+      tree->right = util_vma_hole_tree_remove(tree->right, hole);
+   util_vma_hole_tree_update(tree);
+
+   return tree;
+}
+
+/* Updates the cached sizes after the size or offset of hole changed.  The
+ * hole must not have moved past any other hole.
+ */
+static void
+util_vma_hole_tree_resize(struct util_vma_hole *tree,
+                          struct util_vma_hole *hole)
+{
+   if (tree != hole) {
+      util_vma_hole_tree_resize(hole->offset < tree->offset ?
+                                tree->left : tree->right, hole);
+   }
+   util_vma_hole_tree_update(tree);
+}
+
+/* Returns the highest hole starting at or below offset. */
+static struct util_vma_hole *
+util_vma_hole_tree_find(struct util_vma_heap *heap, uint64_t offset)
+{
+   struct util_vma_hole *found = NULL;
+
+   for (struct util_vma_hole *hole = heap->hole_tree; hole;) {
+      if (hole->offset <= offset) {
+         found = hole;
+         hole = hole->right;
+      } else {
+         hole = hole->left;
+      }
+   }
+
+   return found;
+}
+
+/* Returns the highest hole of at least size bytes starting at or below
+ * max_offset.
+ */
+static struct util_vma_hole *
+util_vma_hole_tree_find_high(struct util_vma_hole *tree,
+                             uint64_t size, uint64_t max_offset)
+{
+   if (!tree || tree->max_size < size)
+      return NULL;
+
+   if (tree->offset <= max_offset) {
+      struct util_vma_hole *hole =
+         util_vma_hole_tree_find_high(tree->right, size, max_offset);
+      if (hole)
+         return hole;
+
+      if (tree->size >= size)
+         return tree;
+   }
+
+   return util_vma_hole_tree_find_high(tree->left, size, max_offset);
+}
+
+/* Returns the lowest hole of at least size bytes starting at or above
+ * min_offset.
+ */
+static struct util_vma_hole *
+util_vma_hole_tree_find_low(struct util_vma_hole *tree,
+                            uint64_t size, uint64_t min_offset)
+{
+   if (!tree || tree->max_size < size)
+      return NULL;
+
+   if (tree->offset >= min_offset) {
+      struct util_vma_hole *hole =
+         util_vma_hole_tree_find_low(tree->left, size, min_offset);
+      if (hole)
+         return hole;
+
+      if (tree->size >= size)
+         return tree;
+   }
+
+   return util_vma_hole_tree_find_low(tree->right, size, min_offset);
+}
 
 void
 util_vma_heap_init(struct util_vma_heap *heap,
                    uint64_t start, uint64_t size)
 {
    list_inithead(&heap->holes);
+   heap->hole_tree = NULL;
+   heap->hole_tree_seed = 0x9e3779b9;
    util_vma_heap_free(heap, start, size);
 
    /* Default to using high addresses */
@@ -61,10 +237,29 @@ util_vma_heap_finish(struct util_vma_heap *heap)
 }
 
 #ifndef NDEBUG
+static unsigned
+util_vma_hole_tree_validate(const struct util_vma_hole *hole)
+{
+   if (!hole)
+      return 0;
+
+   assert(!hole->left || (hole->left->offset < hole->offset &&
+                          hole->left->priority <= hole->priority));
+   assert(!hole->right || (hole->right->offset > hole->offset &&
+                           hole->right->priority <= hole->priority));
+   assert(hole->max_size == MAX3(hole->size,
+                                 util_vma_hole_tree_max(hole->left),
+                                 util_vma_hole_tree_max(hole->right)));
+
+   return 1 + util_vma_hole_tree_validate(hole->left) +
+              util_vma_hole_tree_validate(hole->right);
+}
+
 static void
 util_vma_heap_validate(struct util_vma_heap *heap)
 {
    uint64_t prev_offset = 0;
+   unsigned num_holes = 0;
    util_vma_foreach_hole(hole, heap) {
       assert(hole->offset > 0);
       assert(hole->size > 0);
@@ -85,14 +280,17 @@ util_vma_heap_validate(struct util_vma_heap *heap)
                 hole->size + hole->offset < prev_offset);
       }
       prev_offset = hole->offset;
+      num_holes++;
    }
+
+   assert(util_vma_hole_tree_validate(heap->hole_tree) == num_holes);
 }
 #else
 #define util_vma_heap_validate(heap)
 #endif
 
 static void
-util_vma_hole_alloc(struct util_vma_hole *hole,
+util_vma_hole_alloc(struct util_vma_heap *heap, struct util_vma_hole *hole,
                     uint64_t offset, uint64_t size)
 {
    assert(hole->offset <= offset);
@@ -100,6 +298,7 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
 
    if (offset == hole->offset && size == hole->size) {
       /* Just get rid of the hole. */
+      heap->hole_tree = util_vma_hole_tree_remove(heap->hole_tree, hole);
       list_del(&hole->link);
       free(hole);
       return;
@@ -110,6 +309,7 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
    if (waste == 0) {
       /* We allocated at the top.  Shrink the hole down. */
       hole->size -= size;
+      util_vma_hole_tree_resize(heap->hole_tree, hole);
       return;
    }
 
@@ -117,6 +317,7 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
       /* We allocated at the bottom. Shrink the hole up. */
       hole->offset += size;
       hole->size -= size;
+      util_vma_hole_tree_resize(heap->hole_tree, hole);
       return;
    }
 
@@ -131,11 +332,13 @@ util_vma_hole_alloc(struct util_vma_hole *hole,
     * original hole.
     */
    hole->size = offset - hole->offset;
+   util_vma_hole_tree_resize(heap->hole_tree, hole);
 
    /* Place the new hole before the old hole so that the list is in order
     * from high to low.
     */
    list_addtail(&high_hole->link, &hole->link);
+   util_vma_hole_tree_insert(heap, high_hole);
 }
 
 uint64_t
@@ -148,10 +351,17 @@ util_vma_heap_alloc(struct util_vma_heap *heap,
 
    util_vma_heap_validate(heap);
 
+   /* Holes are tried in the same order as walking the list would, from the
+    * top or the bottom, but the tree lets us skip the ones that are too
+    * small.
+    */
    if (heap->alloc_high) {
-      util_vma_foreach_hole_safe(hole, heap) {
-         if (size > hole->size)
-            continue;
+      uint64_t max_offset = UINT64_MAX;
+      struct util_vma_hole *hole;
+      while ((hole = util_vma_hole_tree_find_high(heap->hole_tree, size,
+                                                  max_offset))) {
+         /* Holes are never at offset 0, so this doesn't wrap */
+         max_offset = hole->offset - 1;
 
          /* Compute the offset as the highest address where a chunk of the
           * given size can be without going over the top of the hole.
@@ -169,28 +379,35 @@ util_vma_heap_alloc(struct util_vma_heap *heap,
          if (offset < hole->offset)
             continue;
 
-         util_vma_hole_alloc(hole, offset, size);
+         util_vma_hole_alloc(heap, hole, offset, size);
          util_vma_heap_validate(heap);
          return offset;
       }
    } else {
-      util_vma_foreach_hole_safe_rev(hole, heap) {
-         if (size > hole->size)
-            continue;
-
+      uint64_t min_offset = 0;
+      struct util_vma_hole *hole;
+      while ((hole = util_vma_hole_tree_find_low(heap->hole_tree, size,
+                                                 min_offset))) {
          uint64_t offset = hole->offset;
 
          /* Align the offset */
          uint64_t misalign = offset % alignment;
          if (misalign) {
             uint64_t pad = alignment - misalign;
-            if (pad > hole->size - size)
+            if (pad > hole->size - size) {
+               /* Only the top-most hole can start at UINT64_MAX and there
+                * is nothing above it to try next.
+                */
+               if (hole->offset == UINT64_MAX)
+                  break;
+               min_offset = hole->offset + 1;
                continue;
+            }
 
             offset += pad;
          }
 
-         util_vma_hole_alloc(hole, offset, size);
+         util_vma_hole_alloc(heap, hole, offset, size);
          util_vma_heap_validate(heap);
          return offset;
       }
@@ -217,25 +434,20 @@ util_vma_heap_alloc_addr(struct util_vma_heap *heap,
     */
    assert(offset + size == 0 || offset + size > offset);
 
-   /* Find the hole if one exists. */
-   util_vma_foreach_hole_safe(hole, heap) {
-      if (hole->offset > offset)
-         continue;
-
-      /* Holes are ordered high-to-low so the first hole we find with
-       * hole->offset <= is our hole.  If it's not big enough to contain the
-       * requested range, then the allocation fails.
-       */
-      assert(hole->offset <= offset);
-      if (hole->size < offset - hole->offset + size)
-         return false;
-
-      util_vma_hole_alloc(hole, offset, size);
-      return true;
-   }
+   /* Find the hole if one exists.  It is the highest hole with
+    * hole->offset <= offset.  If it's not big enough to contain the
+    * requested range, then the allocation fails.
+    */
+   struct util_vma_hole *hole = util_vma_hole_tree_find(heap, offset);
+   if (!hole)
+      return false;
 
-   /* We didn't find a suitable hole */
-   return false;
+   assert(hole->offset <= offset);
+   if (hole->size < offset - hole->offset + size)
+      return false;
+
+   util_vma_hole_alloc(heap, hole, offset, size);
+   return true;
 }
 
 void
@@ -257,15 +469,15 @@ util_vma_heap_free(struct util_vma_heap *heap,
 
    util_vma_heap_validate(heap);
 
-   /* Find immediately higher and lower holes if they exist. */
+   /* Find immediately higher and lower holes if they exist.  The higher
+    * one comes right before the lower one in the list.
+    */
    struct util_vma_hole *high_hole = NULL, *low_hole = NULL;
-   util_vma_foreach_hole(hole, heap) {
-      if (hole->offset <= offset) {
-         low_hole = hole;
-         break;
-      }
-      high_hole = hole;
-   }
+   low_hole = util_vma_hole_tree_find(heap, offset);
+   struct list_head *high_link = low_hole ? low_hole->link.prev :
+                                            heap->holes.prev;
+   if (high_link != &heap->holes)
+      high_hole = LIST_ENTRY(struct util_vma_hole, high_link, link);
 
    if (high_hole)
       assert(offset + size <= high_hole->offset);
@@ -280,15 +492,19 @@ util_vma_heap_free(struct util_vma_heap *heap,
    if (low_adjacent && high_adjacent) {
       /* Merge the two holes */
       low_hole->size += size + high_hole->size;
+      heap->hole_tree = util_vma_hole_tree_remove(heap->hole_tree, high_hole);
+      util_vma_hole_tree_resize(heap->hole_tree, low_hole);
       list_del(&high_hole->link);
       free(high_hole);
    } else if (low_adjacent) {
       /* Merge into the low hole */
       low_hole->size += size;
+      util_vma_hole_tree_resize(heap->hole_tree, low_hole);
    } else if (high_adjacent) {
       /* Merge into the high hole */
       high_hole->offset = offset;
       high_hole->size += size;
+      util_vma_hole_tree_resize(heap->hole_tree, high_hole);
    } else {
       /* Neither hole is adjacent; make a new one */
       struct util_vma_hole *hole = calloc(1, sizeof(*hole));
@@ -301,6 +517,7 @@ util_vma_heap_free(struct util_vma_heap *heap,
          list_add(&hole->link, &high_hole->link);
       else
          list_add(&hole->link, &heap->holes);
+      util_vma_hole_tree_insert(heap, hole);
    }
 
    util_vma_heap_validate(heap);
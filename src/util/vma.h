@@ -33,9 +33,22 @@
 extern "C" {
 #endif
 
+struct util_vma_hole;
+
 struct util_vma_heap {
+   /** Holes, ordered from high to low addresses */
    struct list_head holes;
 
+   /** Root of a search tree over the same holes
+    *
+    * This lets allocations and frees find their hole in O(log n) rather
+    * than walking the list.
+    */
+   struct util_vma_hole *hole_tree;
+
+   /** State of the random number generator for hole_tree balancing */
+   uint32_t hole_tree_seed;
+
    /** If true, util_vma_heap_alloc will prefer high addresses
     *
     * Default is true.
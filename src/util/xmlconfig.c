@@ -59,6 +59,10 @@ static inline void regfree(regex_t* r) {}
 #include "strndup.h"
 #include "u_process.h"
 #include "os_file.h"
+#if WITH_XMLCONFIG
+#include "simple_mtx.h"
+#include "u_dynarray.h"
+#endif
 
 /* For systems like Hurd */
 #ifndef PATH_MAX
@@ -590,6 +594,7 @@ struct OptConfData {
    const char *name;
 #if WITH_XMLCONFIG
    XML_Parser parser;
+   struct OptConfFile *recording;
 #endif
    driOptionCache *cache;
    int screenNum;
@@ -937,18 +942,155 @@ optConfEndElem(void *userData, const char *name)
    }
 }
 
+/** \brief A start or end tag of a configuration file */
+struct OptConfEvent {
+   const char *name;
+   /** NULL-terminated attributes of a start tag, NULL for an end tag */
+   const char **attr;
+};
+
+/** \brief The tags of a configuration file that was parsed before
+ *
+ * The loader and every screen or device go through the same files, so
+ * each file is only run through expat once per process.  Later parses
+ * replay its tags as long as stat() reports the same file.
+ */
+struct OptConfFile {
+   struct OptConfFile *next;
+   char *name;
+   dev_t dev;
+   ino_t ino;
+   off_t size;
+   time_t mtime;
+   bool failed;
+   struct util_dynarray events;
+};
+
+static struct OptConfFile *optConfFiles;
+static simple_mtx_t optConfFilesMutex = _SIMPLE_MTX_INITIALIZER_NP;
+
+static void
+recordOptConfEvent(struct OptConfFile *file, const char *name,
+                   const char **attr)
+{
+   struct OptConfEvent event = { ralloc_strdup(file, name), NULL };
+   if (!event.name) {
+      file->failed = true;
+      return;
+   }
+
+   if (attr) {
+      unsigned count = 0;
+      while (attr[count])
+         count++;
+
+      event.attr = ralloc_array(file, const char *, count + 1);
+      if (!event.attr) {
+         file->failed = true;
+         return;
+      }
+      for (unsigned i = 0; i < count; i++) {
+         event.attr[i] = ralloc_strdup(file, attr[i]);
+         if (!event.attr[i]) {
+            file->failed = true;
+            return;
+         }
+      }
+      event.attr[count] = NULL;
+   }
+
+   util_dynarray_append(&file->events, struct OptConfEvent, event);
+}
+
 static void
+recordStartElem(void *userData, const char *name, const char **attr)
+{
+   struct OptConfData *data = (struct OptConfData *)userData;
+   recordOptConfEvent(data->recording, name, attr);
+   optConfStartElem(userData, name, attr);
+}
+
+static void
+recordEndElem(void *userData, const char *name)
+{
+   struct OptConfData *data = (struct OptConfData *)userData;
+   recordOptConfEvent(data->recording, name, NULL);
+   optConfEndElem(userData, name);
+}
+
+static void
+resetOptConfData(struct OptConfData *data, const char *filename)
+{
+   data->name = filename;
+   data->ignoringDevice = 0;
+   data->ignoringApp = 0;
+   data->inDriConf = 0;
+   data->inDevice = 0;
+   data->inApp = 0;
+   data->inOption = 0;
+}
+
+/** \brief Replay a configuration file parsed before, if it didn't change */
+static bool
+replayConfigFile(struct OptConfData *data, const char *filename,
+                 const struct stat *st)
+{
+   bool found = false;
+
+   simple_mtx_lock(&optConfFilesMutex);
+   for (struct OptConfFile *file = optConfFiles; file; file = file->next) {
+      if (strcmp(file->name, filename))
+         continue;
+
+      if (file->dev == st->st_dev && file->ino == st->st_ino &&
+          file->size == st->st_size && file->mtime == st->st_mtime) {
+         resetOptConfData(data, filename);
+         data->parser = NULL;
+         util_dynarray_foreach(&file->events, struct OptConfEvent, event) {
+            if (event->attr)
+               optConfStartElem(data, event->name, event->attr);
+            else
+               optConfEndElem(data, event->name);
+         }
+         found = true;
+      }
+      break;
+   }
+   simple_mtx_unlock(&optConfFilesMutex);
+
+   return found;
+}
+
+static void
+storeConfigFile(struct OptConfFile *file)
+{
+   simple_mtx_lock(&optConfFilesMutex);
+   for (struct OptConfFile **prev = &optConfFiles; *prev; prev = &(*prev)->next) {
+      if (!strcmp((*prev)->name, file->name)) {
+         struct OptConfFile *stale = *prev;
+         *prev = stale->next;
+         ralloc_free(stale);
+         break;
+      }
+   }
+   file->next = optConfFiles;
+   optConfFiles = file;
+   simple_mtx_unlock(&optConfFilesMutex);
+}
+
+static bool
 _parseOneConfigFile(XML_Parser p)
 {
 #define BUF_SIZE 0x1000
    struct OptConfData *data = (struct OptConfData *)XML_GetUserData(p);
+   bool success = false;
    int status;
    int fd;
 
    if ((fd = open(data->name, O_RDONLY)) == -1) {
       __driUtilMessage("Can't open configuration file %s: %s.",
                        data->name, strerror(errno));
-      return;
+      return false;
    }
 
    while (1) {
@@ -969,11 +1111,14 @@ _parseOneConfigFile(XML_Parser p)
          XML_ERROR("%s.", XML_ErrorString(XML_GetErrorCode(p)));
          break;
       }
-      if (bytesRead == 0)
+      if (bytesRead == 0) {
+         success = true;
          break;
+      }
    }
 
    close(fd);
+   return success;
 #undef BUF_SIZE
 }
 
@@ -981,22 +1126,50 @@ _parseOneConfigFile(XML_Parser p)
 static void
 parseOneConfigFile(struct OptConfData *data, const char *filename)
 {
+   struct OptConfFile *file = NULL;
+   struct stat st;
    XML_Parser p;
 
+   /* Files that can't be stat'ed go through the parser for its error
+    * messages and are never cached.
+    */
+   if (stat(filename, &st) == 0) {
+      if (replayConfigFile(data, filename, &st))
+         return;
+
+      file = rzalloc(NULL, struct OptConfFile);
+      if (file) {
+         file->name = ralloc_strdup(file, filename);
+         file->dev = st.st_dev;
+         file->ino = st.st_ino;
+         file->size = st.st_size;
+         file->mtime = st.st_mtime;
+         file->failed = !file->name;
+         util_dynarray_init(&file->events, file);
+      }
+   }
+
    p = XML_ParserCreate(NULL); /* use encoding specified by file */
-   XML_SetElementHandler(p, optConfStartElem, optConfEndElem);
+   if (file)
+      XML_SetElementHandler(p, recordStartElem, recordEndElem);
+   else
+      XML_SetElementHandler(p, optConfStartElem, optConfEndElem);
    XML_SetUserData(p, data);
    data->parser = p;
-   data->name = filename;
-   data->ignoringDevice = 0;
-   data->ignoringApp = 0;
-   data->inDriConf = 0;
-   data->inDevice = 0;
-   data->inApp = 0;
-   data->inOption = 0;
+   data->recording = file;
+   resetOptConfData(data, filename);
 
-   _parseOneConfigFile(p);
+   bool success = _parseOneConfigFile(p);
    XML_ParserFree(p);
+   data->parser = NULL;
+   data->recording = NULL;
+
+   if (file) {
+      if (success && !file->failed)
+         storeConfigFile(file);
+      else
+         ralloc_free(file);
+   }
 }
 
 static int
@@ -1025,7 +1198,8 @@ scandir_filter(const struct dirent *ent)
 
 /** \brief Parse configuration files in a directory */
 static void
-parseConfigDir(struct OptConfData *data, const char *dirname)
+parseConfigDir(struct OptConfData *data, const char *dirname,
+               const char *skip)
 {
    int i, count;
    struct dirent **entries = NULL;
@@ -1040,6 +1214,11 @@ parseConfigDir(struct OptConfData *data, const char *dirname)
       unsigned char d_type = entries[i]->d_type;
 #endif
 
+      if (skip && !strcmp(entries[i]->d_name, skip)) {
+         free(entries[i]);
+         continue;
+      }
+
       snprintf(filename, PATH_MAX, "%s/%s", dirname, entries[i]->d_name);
       free(entries[i]);
 
@@ -1061,8 +1240,9 @@ parseConfigDir(struct OptConfData *data, const char *dirname)
 
    free(entries);
 }
-#else
-#  include "driconf_static.h"
+#endif /* WITH_XMLCONFIG */
+
+#include "driconf_static.h"
 
 static void
 parseStaticOptions(struct OptConfData *data, const struct driconf_option *options,
@@ -1080,9 +1260,11 @@ parseStaticOptions(struct OptConfData *data, const struct driconf_option *option
    }
 }
 
+/** \brief Apply the defaults compiled in from 00-mesa-defaults.conf */
 static void
 parseStaticConfig(struct OptConfData *data)
 {
+   data->name = "00-mesa-defaults.conf";
    data->ignoringDevice = 0;
    data->ignoringApp = 0;
    data->inDriConf = 0;
@@ -1138,7 +1320,6 @@ parseStaticConfig(struct OptConfData *data)
       data->inApp--;
    }
 }
-#endif /* WITH_XMLCONFIG */
 
 /** \brief Initialize an option cache based on info */
 static void
@@ -1208,7 +1389,15 @@ driParseConfigFiles(driOptionCache *cache, const driOptionCache *info,
 #if WITH_XMLCONFIG
    char *home;
 
-   parseConfigDir(&userData, datadir);
+   /* The defaults installed by Mesa are compiled in, so only the files
+    * added by the distribution or the user need to be parsed.  A data
+    * directory injected by a test is read as is.
+    */
+   const bool builtin_defaults = !strcmp(datadir, DATADIR "/drirc.d");
+   if (builtin_defaults)
+      parseStaticConfig(&userData);
+   parseConfigDir(&userData, datadir,
+                  builtin_defaults ? "00-mesa-defaults.conf" : NULL);
    parseOneConfigFile(&userData, SYSCONFDIR "/drirc");
 
    if ((home = getenv("HOME"))) {
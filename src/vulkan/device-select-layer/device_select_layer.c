@@ -54,6 +54,12 @@ struct instance_info {
    PFN_vkGetPhysicalDeviceProperties2 GetPhysicalDeviceProperties2;
    bool has_pci_bus, has_vulkan11;
    bool has_wayland, has_xcb;
+
+   /* Physical devices in the order reported to the application, computed on
+    * the first vkEnumeratePhysicalDevices call. Protected by
+    * device_select_mutex until set, immutable afterwards. */
+   VkPhysicalDevice *selected_physical_devices;
+   uint32_t selected_physical_device_count;
 };
 
 static struct hash_table *device_select_instance_ht = NULL;
@@ -190,6 +196,7 @@ static void device_select_DestroyInstance(VkInstance instance, const VkAllocatio
 
    device_select_layer_remove_instance(instance);
    info->DestroyInstance(instance, pAllocator);
+   free(info->selected_physical_devices);
    free(info);
 }
 
@@ -467,22 +474,25 @@ static uint32_t get_default_device(const struct instance_info *info,
    return default_idx == -1 ? 0 : default_idx;
 }
 
-static VkResult device_select_EnumeratePhysicalDevices(VkInstance instance,
-						       uint32_t* pPhysicalDeviceCount,
-						       VkPhysicalDevice *pPhysicalDevices)
+/*
+ * Enumerates the physical devices of the instance and returns them in the
+ * order they are reported to the application, default device first.
+ */
+static VkResult device_select_select_physical_devices(VkInstance instance,
+                                                      struct instance_info *info,
+                                                      uint32_t *pSelectedCount,
+                                                      VkPhysicalDevice **pSelected)
 {
-   struct instance_info *info = device_select_layer_get_instance(instance);
    uint32_t physical_device_count = 0;
    uint32_t selected_physical_device_count = 0;
    const char* selection = getenv("MESA_VK_DEVICE_SELECT");
    VkResult result = info->EnumeratePhysicalDevices(instance, &physical_device_count, NULL);
-   VK_OUTARRAY_MAKE_TYPED(VkPhysicalDevice, out, pPhysicalDevices, pPhysicalDeviceCount);
    if (result != VK_SUCCESS)
       return result;
 
-   VkPhysicalDevice *physical_devices = (VkPhysicalDevice*)calloc(sizeof(VkPhysicalDevice),  physical_device_count);
+   VkPhysicalDevice *physical_devices = (VkPhysicalDevice*)calloc(sizeof(VkPhysicalDevice),  MAX2(physical_device_count, 1));
    VkPhysicalDevice *selected_physical_devices = (VkPhysicalDevice*)calloc(sizeof(VkPhysicalDevice),
-                                                                           physical_device_count);
+                                                                           MAX2(physical_device_count, 1));
 
    if (!physical_devices || !selected_physical_devices) {
       result = VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -512,7 +522,7 @@ static VkResult device_select_EnumeratePhysicalDevices(VkInstance instance,
       for (unsigned i = 0; i < physical_device_count; ++i)
          print_gpu(info, i, physical_devices[i]);
       exit(0);
-   } else {
+   } else if (physical_device_count) {
       unsigned selected_index = get_default_device(info, selection, physical_device_count, physical_devices);
       selected_physical_device_count = physical_device_count;
       selected_physical_devices[0] = physical_devices[selected_index];
@@ -533,18 +543,57 @@ static VkResult device_select_EnumeratePhysicalDevices(VkInstance instance,
    if (force_default_device && !strcmp(force_default_device, "1") && selected_physical_device_count != 0)
       selected_physical_device_count = 1;
 
-   for (unsigned i = 0; i < selected_physical_device_count; i++) {
-      vk_outarray_append_typed(VkPhysicalDevice, &out, ent) {
-         *ent = selected_physical_devices[i];
-      }
-   }
-   result = vk_outarray_status(&out);
+   *pSelectedCount = selected_physical_device_count;
+   *pSelected = selected_physical_devices;
+   selected_physical_devices = NULL;
  out:
    free(physical_devices);
    free(selected_physical_devices);
    return result;
 }
 
+static VkResult device_select_EnumeratePhysicalDevices(VkInstance instance,
+						       uint32_t* pPhysicalDeviceCount,
+						       VkPhysicalDevice *pPhysicalDevices)
+{
+   struct instance_info *info = device_select_layer_get_instance(instance);
+   VK_OUTARRAY_MAKE_TYPED(VkPhysicalDevice, out, pPhysicalDevices, pPhysicalDeviceCount);
+
+   /* Applications call this at least twice, to get the count and then the
+    * devices, and selecting the default device may need to connect to the
+    * display server. Do it once per instance.
+    */
+   mtx_lock(&device_select_mutex);
+   bool selected = info->selected_physical_devices != NULL;
+   mtx_unlock(&device_select_mutex);
+
+   if (!selected) {
+      VkPhysicalDevice *selected_physical_devices;
+      uint32_t selected_physical_device_count;
+      VkResult result = device_select_select_physical_devices(instance, info,
+                                                              &selected_physical_device_count,
+                                                              &selected_physical_devices);
+      if (result != VK_SUCCESS)
+         return result;
+
+      mtx_lock(&device_select_mutex);
+      if (!info->selected_physical_devices) {
+         info->selected_physical_devices = selected_physical_devices;
+         info->selected_physical_device_count = selected_physical_device_count;
+      } else {
+         free(selected_physical_devices);
+      }
+      mtx_unlock(&device_select_mutex);
+   }
+
+   for (unsigned i = 0; i < info->selected_physical_device_count; i++) {
+      vk_outarray_append_typed(VkPhysicalDevice, &out, ent) {
+         *ent = info->selected_physical_devices[i];
+      }
+   }
+   return vk_outarray_status(&out);
+}
+
 static VkResult device_select_EnumeratePhysicalDeviceGroups(VkInstance instance,
                                                             uint32_t* pPhysicalDeviceGroupCount,
                                                             VkPhysicalDeviceGroupProperties *pPhysicalDeviceGroups)
@@ -65,6 +65,10 @@ struct instance_data {
 
    /* Dumping of frame stats to a file has been enabled and started. */
    bool capture_started;
+
+   /* The control client asked to receive the stats of every sampling
+    * period. */
+   bool stats_streaming;
 };
 
 struct frame_stat {
@@ -585,6 +589,8 @@ static void parse_command(struct instance_data *instance_data,
          instance_data->capture_enabled = false;
          instance_data->capture_started = false;
       }
+   } else if (!strncmp(cmd, "stats", cmdlen)) {
+      instance_data->stats_streaming = atoi(param) > 0;
    }
 }
 
@@ -728,6 +734,7 @@ static void control_client_disconnected(struct instance_data *instance_data)
 {
    os_socket_close(instance_data->control_client);
    instance_data->control_client = -1;
+   instance_data->stats_streaming = false;
 }
 
 static void process_control_socket(struct instance_data *instance_data)
@@ -769,6 +776,40 @@ static void process_control_socket(struct instance_data *instance_data)
    }
 }
 
+/**
+ * Sends the stats accumulated over the last sampling period to the control
+ * client as a single :Stats=<name> <value>,...; command, with the same
+ * units as the output file.
+ */
+static void control_send_stats(struct swapchain_data *data)
+{
+   struct instance_data *instance_data = data->device->instance;
+   const char *statsCmd = "Stats";
+   char param[BUFSIZE / 2];
+   int len = 0;
+
+   for (int s = 0; s < OVERLAY_PARAM_ENABLED_MAX; s++) {
+      if (!instance_data->params.enabled[s])
+         continue;
+
+      int n;
+      if (s == OVERLAY_PARAM_ENABLED_fps) {
+         n = snprintf(&param[len], sizeof(param) - len, "%s%s %.2f",
+                      len ? "," : "", overlay_param_names[s], data->fps);
+      } else {
+         n = snprintf(&param[len], sizeof(param) - len, "%s%s %" PRIu64,
+                      len ? "," : "", overlay_param_names[s],
+                      data->accumulated_stats.stats[s]);
+      }
+
+      if (n < 0 || n >= (int)sizeof(param) - len)
+         break;
+      len += n;
+   }
+
+   control_send(instance_data, statsCmd, strlen(statsCmd), param, len);
+}
+
 static void snapshot_swapchain_frame(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
@@ -847,6 +888,10 @@ static void snapshot_swapchain_frame(struct swapchain_data *data)
             fflush(instance_data->params.output_file);
          }
 
+         if (instance_data->stats_streaming &&
+             instance_data->control_client >= 0)
+            control_send_stats(data);
+
          memset(&data->accumulated_stats, 0, sizeof(data->accumulated_stats));
          data->n_frames_since_update = 0;
          data->last_fps_update = now;
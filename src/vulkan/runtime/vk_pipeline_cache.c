@@ -140,19 +140,27 @@ object_key_hash(const void *void_object)
    return _mesa_hash_data(object->key_data, object->key_size);
 }
 
-static void
-vk_pipeline_cache_lock(struct vk_pipeline_cache *cache)
+static struct vk_pipeline_cache_shard *
+vk_pipeline_cache_get_shard(struct vk_pipeline_cache *cache, uint32_t hash)
 {
+   /* The sets index with the low bits of the hash, use the high ones. */
+   return &cache->shards[hash >> (32 - VK_PIPELINE_CACHE_SHARD_BITS)];
+}
 
+static void
+vk_pipeline_cache_lock(struct vk_pipeline_cache *cache,
+                       struct vk_pipeline_cache_shard *shard)
+{
    if (!(cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT))
-      simple_mtx_lock(&cache->lock);
+      simple_mtx_lock(&shard->lock);
 }
 
 static void
-vk_pipeline_cache_unlock(struct vk_pipeline_cache *cache)
+vk_pipeline_cache_unlock(struct vk_pipeline_cache *cache,
+                         struct vk_pipeline_cache_shard *shard)
 {
    if (!(cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT))
-      simple_mtx_unlock(&cache->lock);
+      simple_mtx_unlock(&shard->lock);
 }
 
 static void
@@ -160,16 +168,19 @@ vk_pipeline_cache_remove_object(struct vk_pipeline_cache *cache,
                                 uint32_t hash,
                                 struct vk_pipeline_cache_object *object)
 {
-   vk_pipeline_cache_lock(cache);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
+
+   vk_pipeline_cache_lock(cache, shard);
    struct set_entry *entry =
-      _mesa_set_search_pre_hashed(cache->object_cache, hash, object);
+      _mesa_set_search_pre_hashed(shard->objects, hash, object);
    if (entry && entry->key == (const void *)object) {
       /* Drop the reference owned by the cache */
       vk_pipeline_cache_object_unref(object);
 
-      _mesa_set_remove(cache->object_cache, entry);
+      _mesa_set_remove(shard->objects, entry);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_unlock(cache, shard);
 
    /* Drop our reference */
    vk_pipeline_cache_object_unref(object);
@@ -184,9 +195,12 @@ vk_pipeline_cache_replace_object(struct vk_pipeline_cache *cache,
 {
    assert(object_keys_equal(search, replace));
 
-   vk_pipeline_cache_lock(cache);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
+
+   vk_pipeline_cache_lock(cache, shard);
    struct set_entry *entry =
-      _mesa_set_search_pre_hashed(cache->object_cache, hash, search);
+      _mesa_set_search_pre_hashed(shard->objects, hash, search);
 
    struct vk_pipeline_cache_object *found = NULL;
    if (entry) {
@@ -201,9 +215,9 @@ vk_pipeline_cache_replace_object(struct vk_pipeline_cache *cache,
    } else {
       /* I guess the object was purged?  Re-add it to the cache */
       vk_pipeline_cache_object_ref(replace);
-      _mesa_set_add_pre_hashed(cache->object_cache, hash, replace);
+      _mesa_set_add_pre_hashed(shard->objects, hash, replace);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_unlock(cache, shard);
 
    vk_pipeline_cache_object_unref(search);
 
@@ -319,16 +333,19 @@ vk_pipeline_cache_lookup_object(struct vk_pipeline_cache *cache,
 
    struct vk_pipeline_cache_object *object = NULL;
 
-   if (cache != NULL && cache->object_cache != NULL) {
-      vk_pipeline_cache_lock(cache);
+   if (cache != NULL && cache->object_cache) {
+      struct vk_pipeline_cache_shard *shard =
+         vk_pipeline_cache_get_shard(cache, hash);
+
+      vk_pipeline_cache_lock(cache, shard);
       struct set_entry *entry =
-         _mesa_set_search_pre_hashed(cache->object_cache, hash, &key);
+         _mesa_set_search_pre_hashed(shard->objects, hash, &key);
       if (entry) {
          object = vk_pipeline_cache_object_ref((void *)entry->key);
          if (cache_hit != NULL)
             *cache_hit = true;
       }
-      vk_pipeline_cache_unlock(cache);
+      vk_pipeline_cache_unlock(cache, shard);
    }
 
    if (object == NULL) {
@@ -389,15 +406,17 @@ vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
 {
    assert(object->ops != NULL);
 
-   if (cache->object_cache == NULL)
+   if (!cache->object_cache)
       return object;
 
    uint32_t hash = object_key_hash(object);
+   struct vk_pipeline_cache_shard *shard =
+      vk_pipeline_cache_get_shard(cache, hash);
 
-   vk_pipeline_cache_lock(cache);
+   vk_pipeline_cache_lock(cache, shard);
    bool found = false;
    struct set_entry *entry =
-      _mesa_set_search_or_add_pre_hashed(cache->object_cache,
+      _mesa_set_search_or_add_pre_hashed(shard->objects,
                                          hash, object, &found);
 
    struct vk_pipeline_cache_object *found_object = NULL;
@@ -407,7 +426,7 @@ vk_pipeline_cache_add_object(struct vk_pipeline_cache *cache,
       /* The cache now owns a reference */
       vk_pipeline_cache_object_ref(object);
    }
-   vk_pipeline_cache_unlock(cache);
+   vk_pipeline_cache_unlock(cache, shard);
 
    if (found) {
       vk_pipeline_cache_object_unref(object);
@@ -600,12 +619,20 @@ vk_pipeline_cache_create(struct vk_device *device,
    };
    memcpy(cache->header.uuid, pdevice_props.pipelineCacheUUID, VK_UUID_SIZE);
 
-   simple_mtx_init(&cache->lock, mtx_plain);
+   cache->object_cache = info->force_enable ||
+      env_var_as_boolean("VK_ENABLE_PIPELINE_CACHE", true);
+
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++)
+      simple_mtx_init(&cache->shards[i].lock, mtx_plain);
 
-   if (info->force_enable ||
-       env_var_as_boolean("VK_ENABLE_PIPELINE_CACHE", true)) {
-      cache->object_cache = _mesa_set_create(NULL, object_key_hash,
-                                             object_keys_equal);
+   for (unsigned i = 0; cache->object_cache &&
+                        i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      cache->shards[i].objects = _mesa_set_create(NULL, object_key_hash,
+                                                  object_keys_equal);
+      if (cache->shards[i].objects == NULL) {
+         vk_pipeline_cache_destroy(cache, pAllocator);
+         return NULL;
+      }
    }
 
    if (cache->object_cache && pCreateInfo->initialDataSize > 0) {
@@ -626,9 +653,16 @@ void
 vk_pipeline_cache_destroy(struct vk_pipeline_cache *cache,
                           const VkAllocationCallbacks *pAllocator)
 {
-   if (cache->object_cache)
-      _mesa_set_destroy(cache->object_cache, object_unref_cb);
-   simple_mtx_destroy(&cache->lock);
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[i];
+
+      /* Shards past a failed allocation in vk_pipeline_cache_create() have
+       * no set.
+       */
+      if (shard->objects)
+         _mesa_set_destroy(shard->objects, object_unref_cb);
+      simple_mtx_destroy(&shard->lock);
+   }
    vk_object_free(cache->base.device, pAllocator, cache);
 }
 
@@ -693,11 +727,14 @@ vk_common_GetPipelineCacheData(VkDevice _device,
       return VK_INCOMPLETE;
    }
 
-   vk_pipeline_cache_lock(cache);
-
    VkResult result = VK_SUCCESS;
-   if (cache->object_cache != NULL) {
-      set_foreach(cache->object_cache, entry) {
+   for (unsigned s = 0; cache->object_cache &&
+                        s < VK_PIPELINE_CACHE_NUM_SHARDS; s++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[s];
+
+      vk_pipeline_cache_lock(cache, shard);
+
+      set_foreach(shard->objects, entry) {
          struct vk_pipeline_cache_object *object = (void *)entry->key;
 
          if (object->ops->serialize == NULL)
@@ -732,9 +769,12 @@ vk_common_GetPipelineCacheData(VkDevice _device,
          assert(data_size_resv >= 0);
          blob_overwrite_uint32(&blob, data_size_resv, data_size);
       }
-   }
 
-   vk_pipeline_cache_unlock(cache);
+      vk_pipeline_cache_unlock(cache, shard);
+
+      if (result != VK_SUCCESS)
+         break;
+   }
 
    blob_overwrite_uint32(&blob, count_offset, count);
 
@@ -756,8 +796,6 @@ vk_common_MergePipelineCaches(VkDevice device,
    if (!dst->object_cache)
       return VK_SUCCESS;
 
-   vk_pipeline_cache_lock(dst);
-
    for (uint32_t i = 0; i < srcCacheCount; i++) {
       VK_FROM_HANDLE(vk_pipeline_cache, src, pSrcCaches[i]);
 
@@ -768,37 +806,46 @@ vk_common_MergePipelineCaches(VkDevice device,
       if (src == dst)
          continue;
 
-      vk_pipeline_cache_lock(src);
-
-      set_foreach(src->object_cache, src_entry) {
-         struct vk_pipeline_cache_object *src_object = (void *)src_entry->key;
-
-         bool found_in_dst = false;
-         struct set_entry *dst_entry =
-            _mesa_set_search_or_add_pre_hashed(dst->object_cache,
-                                               src_entry->hash,
-                                               src_object, &found_in_dst);
-         if (found_in_dst) {
-            struct vk_pipeline_cache_object *dst_object = (void *)dst_entry->key;
-            if (dst_object->ops == &raw_data_object_ops &&
-                src_object->ops != &raw_data_object_ops) {
-               /* Even though dst has the object, it only has the blob version
-                * which isn't as useful.  Replace it with the real object.
-                */
-               vk_pipeline_cache_object_unref(dst_object);
-               dst_entry->key = vk_pipeline_cache_object_ref(src_object);
+      /* An object lives in the shard picked by its hash in both caches. */
+      for (unsigned s = 0; s < VK_PIPELINE_CACHE_NUM_SHARDS; s++) {
+         struct vk_pipeline_cache_shard *dst_shard = &dst->shards[s];
+         struct vk_pipeline_cache_shard *src_shard = &src->shards[s];
+
+         vk_pipeline_cache_lock(dst, dst_shard);
+         vk_pipeline_cache_lock(src, src_shard);
+
+         set_foreach(src_shard->objects, src_entry) {
+            struct vk_pipeline_cache_object *src_object =
+               (void *)src_entry->key;
+
+            bool found_in_dst = false;
+            struct set_entry *dst_entry =
+               _mesa_set_search_or_add_pre_hashed(dst_shard->objects,
+                                                  src_entry->hash,
+                                                  src_object, &found_in_dst);
+            if (found_in_dst) {
+               struct vk_pipeline_cache_object *dst_object =
+                  (void *)dst_entry->key;
+               if (dst_object->ops == &raw_data_object_ops &&
+                   src_object->ops != &raw_data_object_ops) {
+                  /* Even though dst has the object, it only has the blob
+                   * version which isn't as useful.  Replace it with the real
+                   * object.
+                   */
+                  vk_pipeline_cache_object_unref(dst_object);
+                  dst_entry->key = vk_pipeline_cache_object_ref(src_object);
+               }
+            } else {
+               /* We inserted src_object in dst so it needs a reference */
+               assert(dst_entry->key == (const void *)src_object);
+               vk_pipeline_cache_object_ref(src_object);
             }
-         } else {
-            /* We inserted src_object in dst so it needs a reference */
-            assert(dst_entry->key == (const void *)src_object);
-            vk_pipeline_cache_object_ref(src_object);
          }
-      }
 
-      vk_pipeline_cache_unlock(src);
+         vk_pipeline_cache_unlock(src, src_shard);
+         vk_pipeline_cache_unlock(dst, dst_shard);
+      }
    }
 
-   vk_pipeline_cache_unlock(dst);
-
    return VK_SUCCESS;
 }
@@ -151,6 +151,17 @@ vk_pipeline_cache_object_unref(struct vk_pipeline_cache_object *object)
       object->ops->destroy(object);
 }
 
+#define VK_PIPELINE_CACHE_SHARD_BITS 4
+#define VK_PIPELINE_CACHE_NUM_SHARDS (1 << VK_PIPELINE_CACHE_SHARD_BITS)
+
+/** A slice of the objects in a vk_pipeline_cache, selected by key hash */
+struct vk_pipeline_cache_shard {
+   /** Protects objects */
+   simple_mtx_t lock;
+
+   struct set *objects;
+};
+
 /** A generic implementation of VkPipelineCache */
 struct vk_pipeline_cache {
    struct vk_object_base base;
@@ -160,10 +171,13 @@ struct vk_pipeline_cache {
 
    struct vk_pipeline_cache_header header;
 
-   /** Protects object_cache */
-   simple_mtx_t lock;
+   /** False if VK_ENABLE_PIPELINE_CACHE=false, the shards have no sets */
+   bool object_cache;
 
-   struct set *object_cache;
+   /* Threads creating pipelines against the same cache mostly look up
+    * different keys, so each shard has its own lock.
+    */
+   struct vk_pipeline_cache_shard shards[VK_PIPELINE_CACHE_NUM_SHARDS];
 };
 
 VK_DEFINE_NONDISP_HANDLE_CASTS(vk_pipeline_cache, base, VkPipelineCache,
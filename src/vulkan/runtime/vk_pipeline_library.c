@@ -0,0 +1,351 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "vk_pipeline_library.h"
+
+#include "vk_alloc.h"
+#include "vk_device.h"
+#include "vk_log.h"
+#include "vk_shader_module.h"
+#include "vk_util.h"
+
+#include "compiler/nir/nir_serialize.h"
+
+#include "util/bitscan.h"
+#include "util/blob.h"
+
+VkGraphicsPipelineLibraryFlagsEXT
+vk_graphics_pipeline_create_info_parts(const VkGraphicsPipelineCreateInfo *info)
+{
+   const VkGraphicsPipelineLibraryCreateInfoEXT *gpl_info =
+      vk_find_struct_const(info->pNext,
+                           GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT);
+
+   /* The VK_EXT_graphics_pipeline_library spec says:
+    *
+    *    "If this structure is omitted, and either
+    *    VkGraphicsPipelineCreateInfo::flags includes
+    *    VK_PIPELINE_CREATE_LIBRARY_BIT_KHR or the
+    *    VkGraphicsPipelineCreateInfo::pNext chain includes a
+    *    VkPipelineLibraryCreateInfoKHR structure with a libraryCount greater
+    *    than 0, it is as if flags is 0.  Otherwise if this structure is
+    *    omitted, it is as if flags includes all possible subsets of the
+    *    graphics pipeline (i.e. a complete graphics pipeline)."
+    */
+   if (gpl_info != NULL)
+      return gpl_info->flags;
+
+   const VkPipelineLibraryCreateInfoKHR *lib_info =
+      vk_find_struct_const(info->pNext, PIPELINE_LIBRARY_CREATE_INFO_KHR);
+
+   if ((info->flags & VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) ||
+       (lib_info != NULL && lib_info->libraryCount > 0))
+      return 0;
+
+   return VK_GRAPHICS_PIPELINE_LIBRARY_ALL_PARTS_EXT;
+}
+
+VkShaderStageFlags
+vk_graphics_pipeline_library_part_stages(VkGraphicsPipelineLibraryFlagBitsEXT part)
+{
+   switch (part) {
+   case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+      return VK_SHADER_STAGE_VERTEX_BIT |
+             VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+             VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+             VK_SHADER_STAGE_GEOMETRY_BIT |
+             VK_SHADER_STAGE_TASK_BIT_NV |
+             VK_SHADER_STAGE_MESH_BIT_NV;
+   case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+      return VK_SHADER_STAGE_FRAGMENT_BIT;
+   default:
+      return 0;
+   }
+}
+
+void
+vk_pipeline_hash_shader_stage(struct mesa_sha1 *ctx,
+                              const VkPipelineShaderStageCreateInfo *info)
+{
+   VK_FROM_HANDLE(vk_shader_module, module, info->module);
+
+   if (module != NULL) {
+      _mesa_sha1_update(ctx, module->sha1, sizeof(module->sha1));
+   } else {
+      /* Libraries may pass the SPIR-V directly in the pNext chain. */
+      const VkShaderModuleCreateInfo *module_info =
+         vk_find_struct_const(info->pNext, SHADER_MODULE_CREATE_INFO);
+      assert(module_info != NULL);
+
+      unsigned char sha1[SHA1_DIGEST_LENGTH];
+      _mesa_sha1_compute(module_info->pCode, module_info->codeSize, sha1);
+      _mesa_sha1_update(ctx, sha1, sizeof(sha1));
+   }
+
+   _mesa_sha1_update(ctx, &info->flags, sizeof(info->flags));
+   _mesa_sha1_update(ctx, &info->stage, sizeof(info->stage));
+   _mesa_sha1_update(ctx, info->pName, strlen(info->pName) + 1);
+
+   const VkSpecializationInfo *spec_info = info->pSpecializationInfo;
+   if (spec_info && spec_info->mapEntryCount > 0) {
+      _mesa_sha1_update(ctx, spec_info->pMapEntries,
+                        spec_info->mapEntryCount *
+                        sizeof(*spec_info->pMapEntries));
+      _mesa_sha1_update(ctx, spec_info->pData, spec_info->dataSize);
+   }
+}
+
+void
+vk_graphics_pipeline_library_part_hash(struct mesa_sha1 *ctx,
+                                       VkGraphicsPipelineLibraryFlagBitsEXT part,
+                                       const VkGraphicsPipelineCreateInfo *info,
+                                       unsigned char sha1_out[SHA1_DIGEST_LENGTH])
+{
+   const VkShaderStageFlags part_stages =
+      vk_graphics_pipeline_library_part_stages(part);
+
+   _mesa_sha1_update(ctx, &part, sizeof(part));
+
+   /* Stages are hashed in the order the application gave them.  Drivers
+    * that want to share parts across reordered stage arrays can hash the
+    * stages themselves.
+    */
+   for (uint32_t i = 0; i < info->stageCount; i++) {
+      if (info->pStages[i].stage & part_stages)
+         vk_pipeline_hash_shader_stage(ctx, &info->pStages[i]);
+   }
+
+   _mesa_sha1_final(ctx, sha1_out);
+}
+
+static struct vk_pipeline_library_part *
+vk_pipeline_library_part_alloc(struct vk_device *device,
+                               VkGraphicsPipelineLibraryFlagBitsEXT part,
+                               const unsigned char sha1[SHA1_DIGEST_LENGTH],
+                               VkShaderStageFlags stages,
+                               const uint32_t *nir_sizes)
+{
+   size_t nir_size = 0;
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++)
+      nir_size += nir_sizes[s];
+
+   VK_MULTIALLOC(ma);
+   VK_MULTIALLOC_DECL(&ma, struct vk_pipeline_library_part, lib_part, 1);
+   VK_MULTIALLOC_DECL_SIZE(&ma, char, nir_data, nir_size);
+
+   if (!vk_multialloc_alloc(&ma, &device->alloc,
+                            VK_SYSTEM_ALLOCATION_SCOPE_DEVICE))
+      return NULL;
+
+   vk_pipeline_cache_object_init(device, &lib_part->base,
+                                 &vk_pipeline_library_part_ops,
+                                 lib_part->sha1, sizeof(lib_part->sha1));
+   lib_part->part = part;
+   lib_part->stages = stages;
+   memcpy(lib_part->sha1, sha1, sizeof(lib_part->sha1));
+
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      lib_part->nir[s].data = nir_sizes[s] ? nir_data : NULL;
+      lib_part->nir[s].size = nir_sizes[s];
+      nir_data += nir_sizes[s];
+   }
+
+   return lib_part;
+}
+
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_create(struct vk_device *device,
+                                VkGraphicsPipelineLibraryFlagBitsEXT part,
+                                const unsigned char sha1[SHA1_DIGEST_LENGTH],
+                                struct nir_shader *const *nir)
+{
+   struct blob blobs[MESA_VULKAN_SHADER_STAGES];
+   uint32_t nir_sizes[MESA_VULKAN_SHADER_STAGES] = { 0 };
+   VkShaderStageFlags stages = 0;
+   bool out_of_memory = false;
+
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      blob_init(&blobs[s]);
+      if (nir[s] == NULL)
+         continue;
+
+      nir_serialize(&blobs[s], nir[s], false);
+      out_of_memory |= blobs[s].out_of_memory || blobs[s].size > UINT32_MAX;
+      nir_sizes[s] = blobs[s].size;
+      stages |= mesa_to_vk_shader_stage(s);
+   }
+
+   struct vk_pipeline_library_part *lib_part = NULL;
+   if (!out_of_memory) {
+      lib_part = vk_pipeline_library_part_alloc(device, part, sha1, stages,
+                                                nir_sizes);
+   }
+
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      if (lib_part != NULL && nir_sizes[s])
+         memcpy((void *)lib_part->nir[s].data, blobs[s].data, nir_sizes[s]);
+      blob_finish(&blobs[s]);
+   }
+
+   return lib_part;
+}
+
+static bool
+vk_pipeline_library_part_serialize(struct vk_pipeline_cache_object *object,
+                                   struct blob *blob)
+{
+   struct vk_pipeline_library_part *lib_part =
+      container_of(object, struct vk_pipeline_library_part, base);
+
+   blob_write_uint32(blob, lib_part->part);
+   blob_write_uint32(blob, lib_part->stages);
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      if (!(lib_part->stages & mesa_to_vk_shader_stage(s)))
+         continue;
+
+      blob_write_uint32(blob, lib_part->nir[s].size);
+      blob_write_bytes(blob, lib_part->nir[s].data, lib_part->nir[s].size);
+   }
+
+   return !blob->out_of_memory;
+}
+
+static struct vk_pipeline_cache_object *
+vk_pipeline_library_part_deserialize(struct vk_device *device,
+                                     const void *key_data, size_t key_size,
+                                     struct blob_reader *blob)
+{
+   if (key_size != SHA1_DIGEST_LENGTH)
+      return NULL;
+
+   VkGraphicsPipelineLibraryFlagBitsEXT part = blob_read_uint32(blob);
+   VkShaderStageFlags stages = blob_read_uint32(blob);
+
+   uint32_t nir_sizes[MESA_VULKAN_SHADER_STAGES] = { 0 };
+   const void *nir_data[MESA_VULKAN_SHADER_STAGES] = { NULL };
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      if (!(stages & mesa_to_vk_shader_stage(s)))
+         continue;
+
+      nir_sizes[s] = blob_read_uint32(blob);
+      nir_data[s] = blob_read_bytes(blob, nir_sizes[s]);
+   }
+
+   if (blob->overrun)
+      return NULL;
+
+   struct vk_pipeline_library_part *lib_part =
+      vk_pipeline_library_part_alloc(device, part, key_data, stages,
+                                     nir_sizes);
+   if (lib_part == NULL)
+      return NULL;
+
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      if (nir_sizes[s])
+         memcpy((void *)lib_part->nir[s].data, nir_data[s], nir_sizes[s]);
+   }
+
+   return &lib_part->base;
+}
+
+static void
+vk_pipeline_library_part_destroy(struct vk_pipeline_cache_object *object)
+{
+   struct vk_pipeline_library_part *lib_part =
+      container_of(object, struct vk_pipeline_library_part, base);
+
+   vk_free(&lib_part->base.device->alloc, lib_part);
+}
+
+const struct vk_pipeline_cache_object_ops vk_pipeline_library_part_ops = {
+   .serialize = vk_pipeline_library_part_serialize,
+   .deserialize = vk_pipeline_library_part_deserialize,
+   .destroy = vk_pipeline_library_part_destroy,
+};
+
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_lookup(struct vk_pipeline_cache *cache,
+                                const unsigned char sha1[SHA1_DIGEST_LENGTH],
+                                bool *cache_hit)
+{
+   struct vk_pipeline_cache_object *object =
+      vk_pipeline_cache_lookup_object(cache, sha1, SHA1_DIGEST_LENGTH,
+                                      &vk_pipeline_library_part_ops,
+                                      cache_hit);
+   if (object == NULL)
+      return NULL;
+
+   return container_of(object, struct vk_pipeline_library_part, base);
+}
+
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_add(struct vk_pipeline_cache *cache,
+                             struct vk_pipeline_library_part *part)
+{
+   struct vk_pipeline_cache_object *object =
+      vk_pipeline_cache_add_object(cache, &part->base);
+
+   return container_of(object, struct vk_pipeline_library_part, base);
+}
+
+struct nir_shader *
+vk_pipeline_library_part_get_nir(const struct vk_pipeline_library_part *part,
+                                 gl_shader_stage stage,
+                                 const struct nir_shader_compiler_options *nir_options,
+                                 void *mem_ctx)
+{
+   if (!(part->stages & mesa_to_vk_shader_stage(stage)))
+      return NULL;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, part->nir[stage].data, part->nir[stage].size);
+
+   nir_shader *nir = nir_deserialize(mem_ctx, nir_options, &blob);
+   if (blob.overrun) {
+      ralloc_free(nir);
+      return NULL;
+   }
+
+   return nir;
+}
+
+void
+vk_graphics_pipeline_library_link_hash(struct mesa_sha1 *ctx,
+                                       const struct vk_pipeline_library_part *const *parts,
+                                       uint32_t part_count,
+                                       unsigned char sha1_out[SHA1_DIGEST_LENGTH])
+{
+   /* Hash the parts in bit order so that the key doesn't depend on the
+    * order of VkPipelineLibraryCreateInfoKHR::pLibraries.
+    */
+   u_foreach_bit(b, VK_GRAPHICS_PIPELINE_LIBRARY_ALL_PARTS_EXT) {
+      for (uint32_t i = 0; i < part_count; i++) {
+         if (parts[i]->part == (1u << b)) {
+            _mesa_sha1_update(ctx, &parts[i]->part, sizeof(parts[i]->part));
+            _mesa_sha1_update(ctx, parts[i]->sha1, sizeof(parts[i]->sha1));
+         }
+      }
+   }
+
+   _mesa_sha1_final(ctx, sha1_out);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2022 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef VK_PIPELINE_LIBRARY_H
+#define VK_PIPELINE_LIBRARY_H
+
+#include "vk_pipeline_cache.h"
+
+#include "compiler/shader_enums.h"
+#include "util/mesa-sha1.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct nir_shader;
+struct nir_shader_compiler_options;
+
+/** Every part VK_EXT_graphics_pipeline_library splits a pipeline into */
+#define VK_GRAPHICS_PIPELINE_LIBRARY_ALL_PARTS_EXT \
+   (VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT | \
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT | \
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT | \
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)
+
+/** Returns the parts that a VkGraphicsPipelineCreateInfo describes itself
+ *
+ * This is VkGraphicsPipelineLibraryCreateInfoEXT::flags if present and all
+ * parts otherwise.  Parts that come from VkPipelineLibraryCreateInfoKHR
+ * libraries are not included.
+ */
+VkGraphicsPipelineLibraryFlagsEXT
+vk_graphics_pipeline_create_info_parts(const VkGraphicsPipelineCreateInfo *info);
+
+/** Returns the shader stages that belong to a pipeline library part */
+VkShaderStageFlags
+vk_graphics_pipeline_library_part_stages(VkGraphicsPipelineLibraryFlagBitsEXT part);
+
+/** Adds a shader stage to a SHA1 context
+ *
+ * This hashes the SPIR-V, the stage, the entrypoint name and the
+ * specialization constants, which is everything about the stage that
+ * affects the NIR produced by spirv_to_nir.
+ */
+void
+vk_pipeline_hash_shader_stage(struct mesa_sha1 *ctx,
+                              const VkPipelineShaderStageCreateInfo *info);
+
+/** Computes the cache key of one part of a graphics pipeline
+ *
+ * Only the shader stages of info that belong to the part are hashed.  The
+ * driver passes in ctx with whatever else its compile of the part depends
+ * on, such as the pipeline layout or its own compiler options, already
+ * added.
+ */
+void
+vk_graphics_pipeline_library_part_hash(struct mesa_sha1 *ctx,
+                                       VkGraphicsPipelineLibraryFlagBitsEXT part,
+                                       const VkGraphicsPipelineCreateInfo *info,
+                                       unsigned char sha1_out[SHA1_DIGEST_LENGTH]);
+
+/** A compiled part of a graphics pipeline, kept in a vk_pipeline_cache
+ *
+ * It stores the serialized NIR of each of the part's stages after the
+ * driver's per-stage lowering, so that linking the part into a pipeline
+ * only costs a nir_deserialize and no SPIR-V parsing.
+ */
+struct vk_pipeline_library_part {
+   struct vk_pipeline_cache_object base;
+
+   VkGraphicsPipelineLibraryFlagBitsEXT part;
+
+   /** The part hash, also the cache key */
+   unsigned char sha1[SHA1_DIGEST_LENGTH];
+
+   /** Stages of the part whose NIR is in the nir array */
+   VkShaderStageFlags stages;
+
+   struct {
+      const void *data;
+      uint32_t size;
+   } nir[MESA_VULKAN_SHADER_STAGES];
+};
+
+extern const struct vk_pipeline_cache_object_ops vk_pipeline_library_part_ops;
+
+/** Creates a part from the NIR of its stages
+ *
+ * nir is indexed by gl_shader_stage and may contain NULL for stages the
+ * part doesn't have.  The returned part has a single reference.
+ */
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_create(struct vk_device *device,
+                                VkGraphicsPipelineLibraryFlagBitsEXT part,
+                                const unsigned char sha1[SHA1_DIGEST_LENGTH],
+                                struct nir_shader *const *nir);
+
+/** Looks a part up in the cache, or the disk cache behind it
+ *
+ * Returns a new reference or NULL.
+ */
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_lookup(struct vk_pipeline_cache *cache,
+                                const unsigned char sha1[SHA1_DIGEST_LENGTH],
+                                bool *cache_hit);
+
+/** Adds a part to the cache
+ *
+ * Consumes the reference to part and returns a reference to the cached
+ * part, which may be a different object with the same key.
+ */
+struct vk_pipeline_library_part *
+vk_pipeline_library_part_add(struct vk_pipeline_cache *cache,
+                             struct vk_pipeline_library_part *part);
+
+static inline struct vk_pipeline_library_part *
+vk_pipeline_library_part_ref(struct vk_pipeline_library_part *part)
+{
+   vk_pipeline_cache_object_ref(&part->base);
+   return part;
+}
+
+static inline void
+vk_pipeline_library_part_unref(struct vk_pipeline_library_part *part)
+{
+   vk_pipeline_cache_object_unref(&part->base);
+}
+
+/** Deserializes the NIR of one stage of a part
+ *
+ * Returns NULL if the part has no such stage.
+ */
+struct nir_shader *
+vk_pipeline_library_part_get_nir(const struct vk_pipeline_library_part *part,
+                                 gl_shader_stage stage,
+                                 const struct nir_shader_compiler_options *nir_options,
+                                 void *mem_ctx);
+
+/** Computes the cache key of a pipeline linked from library parts
+ *
+ * The key only depends on the set of parts, not on the order they are
+ * listed in, and any extra link-time state the driver adds to ctx.
+ */
+void
+vk_graphics_pipeline_library_link_hash(struct mesa_sha1 *ctx,
+                                       const struct vk_pipeline_library_part *const *parts,
+                                       uint32_t part_count,
+                                       unsigned char sha1_out[SHA1_DIGEST_LENGTH]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VK_PIPELINE_LIBRARY_H */
@@ -24,6 +24,9 @@
 #include "vk_queue.h"
 
 #include "util/debug.h"
+#include "util/log.h"
+#include "util/os_time.h"
+#include "util/u_math.h"
 #include <inttypes.h>
 
 #include "vk_alloc.h"
@@ -256,6 +259,8 @@ static void
 vk_queue_push_submit(struct vk_queue *queue,
                      struct vk_queue_submit *submit)
 {
+   submit->_push_time_ns = os_time_get_nano();
+
    mtx_lock(&queue->submit.mutex);
    list_addtail(&submit->link, &queue->submit.submits);
    cnd_signal(&queue->submit.push);
@@ -453,6 +458,126 @@ done:
    return result;
 }
 
+/* Whether next can be handed to the driver together with prev.  next must
+ * not wait on anything, since prev's signals may only move later and its
+ * waits stay in front of everything.  Sparse binds and emulated timeline
+ * points are kept in their own submits.
+ */
+static bool
+vk_queue_can_merge_submits(struct vk_queue *queue,
+                           const struct vk_queue_submit *prev,
+                           const struct vk_queue_submit *next)
+{
+   if (queue->base.device->timeline_mode == VK_DEVICE_TIMELINE_MODE_EMULATED)
+      return false;
+
+   if (next->wait_count > 0)
+      return false;
+
+   if (prev->perf_pass_index != next->perf_pass_index)
+      return false;
+
+   return prev->buffer_bind_count == 0 &&
+          prev->image_opaque_bind_count == 0 &&
+          prev->image_bind_count == 0 &&
+          next->buffer_bind_count == 0 &&
+          next->image_opaque_bind_count == 0 &&
+          next->image_bind_count == 0;
+}
+
+/* Submits count submits starting at first with a single driver_submit.
+ * The waits of first are used in place so that the compaction done by
+ * vk_queue_submit_final() is seen by vk_queue_submit_cleanup().
+ */
+static VkResult
+vk_queue_submit_merged(struct vk_queue *queue,
+                       struct vk_queue_submit *first,
+                       uint32_t count)
+{
+   uint32_t command_buffer_count = 0, signal_count = 0;
+   struct vk_queue_submit *submit = first;
+   for (uint32_t i = 0; i < count; i++) {
+      command_buffer_count += submit->command_buffer_count;
+      signal_count += submit->signal_count;
+      submit = LIST_ENTRY(struct vk_queue_submit, submit->link.next, link);
+   }
+
+   VK_MULTIALLOC(ma);
+   VK_MULTIALLOC_DECL(&ma, struct vk_queue_submit, merged, 1);
+   VK_MULTIALLOC_DECL(&ma, struct vk_command_buffer *, command_buffers,
+                      command_buffer_count);
+   VK_MULTIALLOC_DECL(&ma, struct vk_sync_signal, signals, signal_count);
+
+   if (!vk_multialloc_zalloc(&ma, &queue->base.device->alloc,
+                             VK_SYSTEM_ALLOCATION_SCOPE_DEVICE))
+      return vk_error(queue, VK_ERROR_OUT_OF_HOST_MEMORY);
+
+   merged->wait_count = first->wait_count;
+   merged->waits = first->waits;
+   merged->_wait_temps = first->_wait_temps;
+   merged->perf_pass_index = first->perf_pass_index;
+   merged->command_buffers = command_buffers;
+   merged->signals = signals;
+
+   submit = first;
+   for (uint32_t i = 0; i < count; i++) {
+      memcpy(&command_buffers[merged->command_buffer_count],
+             submit->command_buffers,
+             submit->command_buffer_count * sizeof(*command_buffers));
+      merged->command_buffer_count += submit->command_buffer_count;
+
+      memcpy(&signals[merged->signal_count], submit->signals,
+             submit->signal_count * sizeof(*signals));
+      merged->signal_count += submit->signal_count;
+
+      submit = LIST_ENTRY(struct vk_queue_submit, submit->link.next, link);
+   }
+
+   VkResult result = vk_queue_submit_final(queue, merged);
+   first->wait_count = merged->wait_count;
+
+   vk_free(&queue->base.device->alloc, merged);
+
+   return result;
+}
+
+static void
+vk_queue_record_submit_latency(struct vk_queue *queue,
+                               const struct vk_queue_submit *submit,
+                               int64_t now_ns)
+{
+   const uint64_t latency_us = MAX2(now_ns - submit->_push_time_ns, 0) / 1000;
+   const unsigned bucket = MIN2(util_logbase2_64(latency_us | 1),
+                                VK_QUEUE_SUBMIT_LATENCY_BUCKETS - 1);
+
+   queue->submit.latency_histogram[bucket]++;
+}
+
+static void
+vk_queue_print_submit_stats(struct vk_queue *queue)
+{
+   if (queue->submit.thread_submit_count == 0)
+      return;
+
+   mesa_logi("vk_queue %u.%u: %"PRIu64" submits in %"PRIu64" driver submits",
+             queue->queue_family_index, queue->index_in_family,
+             queue->submit.thread_submit_count,
+             queue->submit.thread_driver_submit_count);
+
+   for (unsigned i = 0; i < VK_QUEUE_SUBMIT_LATENCY_BUCKETS; i++) {
+      if (queue->submit.latency_histogram[i] == 0)
+         continue;
+
+      if (i == VK_QUEUE_SUBMIT_LATENCY_BUCKETS - 1) {
+         mesa_logi("   >= %8u us: %"PRIu64, 1u << i,
+                   queue->submit.latency_histogram[i]);
+      } else {
+         mesa_logi("   <  %8u us: %"PRIu64, 1u << (i + 1),
+                   queue->submit.latency_histogram[i]);
+      }
+   }
+}
+
 static int
 vk_queue_submit_thread_func(void *_data)
 {
@@ -476,6 +601,23 @@ vk_queue_submit_thread_func(void *_data)
          list_first_entry(&queue->submit.submits,
                           struct vk_queue_submit, link);
 
+      /* Apps that submit lots of small batches would otherwise pay for a
+       * kernel submit each.  Everything queued right behind this submit
+       * that doesn't wait goes to the driver with it.
+       */
+      uint32_t submit_count = 1;
+      struct vk_queue_submit *last = submit;
+      while (submit_count < VK_QUEUE_MAX_MERGED_SUBMITS &&
+             last->link.next != &queue->submit.submits) {
+         struct vk_queue_submit *next =
+            LIST_ENTRY(struct vk_queue_submit, last->link.next, link);
+         if (!vk_queue_can_merge_submits(queue, last, next))
+            break;
+
+         last = next;
+         submit_count++;
+      }
+
       /* Drop the lock while we wait */
       mtx_unlock(&queue->submit.mutex);
 
@@ -487,26 +629,45 @@ vk_queue_submit_thread_func(void *_data)
          return 1;
       }
 
-      result = vk_queue_submit_final(queue, submit);
+      if (submit_count > 1)
+         result = vk_queue_submit_merged(queue, submit, submit_count);
+      else
+         result = vk_queue_submit_final(queue, submit);
       if (unlikely(result != VK_SUCCESS)) {
          vk_queue_set_lost(queue, "queue::driver_submit failed");
          return 1;
       }
 
       /* Do all our cleanup of individual fences etc. outside the lock.
-       * We can't actually remove it from the list yet.  We have to do
-       * that under the lock.
+       * We can't actually remove them from the list yet.  We have to do
+       * that under the lock.  Only new submits are added to the list
+       * while it's unlocked, so the links up to last are stable.
        */
-      vk_queue_submit_cleanup(queue, submit);
+      const int64_t now_ns = os_time_get_nano();
+      struct vk_queue_submit *cleanup = submit;
+      for (uint32_t i = 0; i < submit_count; i++) {
+         vk_queue_record_submit_latency(queue, cleanup, now_ns);
+         vk_queue_submit_cleanup(queue, cleanup);
+         cleanup = LIST_ENTRY(struct vk_queue_submit,
+                              cleanup->link.next, link);
+      }
+
+      queue->submit.thread_submit_count += submit_count;
+      queue->submit.thread_driver_submit_count++;
 
       mtx_lock(&queue->submit.mutex);
 
-      /* Only remove the submit from from the list and free it after
+      /* Only remove the submits from from the list and free them after
        * queue->submit() has completed.  This ensures that, when
        * vk_queue_drain() completes, there are no more pending jobs.
        */
-      list_del(&submit->link);
-      vk_queue_submit_free(queue, submit);
+      for (uint32_t i = 0; i < submit_count; i++) {
+         struct vk_queue_submit *done =
+            list_first_entry(&queue->submit.submits,
+                             struct vk_queue_submit, link);
+         list_del(&done->link);
+         vk_queue_submit_free(queue, done);
+      }
 
       cnd_broadcast(&queue->submit.pop);
    }
@@ -1113,6 +1274,9 @@ vk_queue_finish(struct vk_queue *queue)
       vk_queue_submit_destroy(queue, submit);
    }
 
+   if (env_var_as_boolean("MESA_VK_SUBMIT_STATS", false))
+      vk_queue_print_submit_stats(queue);
+
    cnd_destroy(&queue->submit.pop);
    cnd_destroy(&queue->submit.push);
    mtx_destroy(&queue->submit.mutex);
@@ -42,6 +42,12 @@ struct vk_sync_wait;
 struct vk_sync_signal;
 struct vk_sync_timeline_point;
 
+/** Most submits the submit thread hands to vk_queue::driver_submit at once */
+#define VK_QUEUE_MAX_MERGED_SUBMITS 16
+
+/** Buckets of vk_queue::submit.latency_histogram, by powers of two in us */
+#define VK_QUEUE_SUBMIT_LATENCY_BUCKETS 16
+
 struct vk_queue {
    struct vk_object_base base;
 
@@ -67,6 +73,10 @@ struct vk_queue {
     * managed submit thread.  We do, however, guarantee that as long as the
     * client follows the Vulkan threading rules, this function will never be
     * called by the runtime concurrently on the same queue.
+    *
+    * The submit thread merges queued submits that don't wait on anything
+    * into the submit before them, so one call may contain the command
+    * buffers and signals of several vkQueueSubmit batches.
     */
    VkResult (*driver_submit)(struct vk_queue *queue,
                              struct vk_queue_submit *submit);
@@ -96,6 +106,20 @@ struct vk_queue {
 
       bool thread_run;
       thrd_t thread;
+
+      /** Submits handed to driver_submit by the submit thread, and the
+       * number of driver_submit calls they took
+       */
+      uint64_t thread_submit_count;
+      uint64_t thread_driver_submit_count;
+
+      /** Time from vkQueueSubmit to driver_submit returning for submits
+       * that went through the submit thread.  Bucket i counts latencies
+       * below 2^(i + 1) us that don't fit a lower bucket, the last one
+       * everything above.  Printed by vk_queue_finish() with
+       * MESA_VK_SUBMIT_STATS=true.
+       */
+      uint64_t latency_histogram[VK_QUEUE_SUBMIT_LATENCY_BUCKETS];
    } submit;
 
    struct {
@@ -219,6 +243,7 @@ struct vk_queue_submit {
    uint32_t perf_pass_index;
 
    /* Used internally; should be ignored by drivers */
+   int64_t _push_time_ns;
    struct vk_sync **_wait_temps;
    struct vk_sync *_mem_signal_temp;
    struct vk_sync_timeline_point **_wait_points;
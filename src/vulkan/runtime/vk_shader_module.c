@@ -51,7 +51,12 @@ vk_common_CreateShaderModule(VkDevice _device,
     module->nir = NULL;
     memcpy(module->data, pCreateInfo->pCode, module->size);
 
-    _mesa_sha1_compute(module->data, module->size, module->sha1);
+    module->nir_cache_enabled = true;
+    module->nir_cache_next = 0;
+    memset(module->nir_cache, 0, sizeof(module->nir_cache));
+    simple_mtx_init(&module->nir_cache_lock, mtx_plain);
+
+    _mesa_sha1_compute_tree(module->data, module->size, module->sha1);
 
     *pShaderModule = vk_shader_module_to_handle(module);
 
@@ -76,6 +81,12 @@ vk_common_DestroyShaderModule(VkDevice _device,
     */
    assert(module->nir == NULL);
 
+   if (module->nir_cache_enabled) {
+      for (unsigned i = 0; i < VK_SHADER_MODULE_NIR_CACHE_SIZE; i++)
+         ralloc_free(module->nir_cache[i].nir);
+      simple_mtx_destroy(&module->nir_cache_lock);
+   }
+
    vk_object_free(device, pAllocator, module);
 }
 
@@ -90,6 +101,75 @@ vk_shader_module_spirv_version(const struct vk_shader_module *mod)
    return vk_spirv_version((uint32_t *)mod->data, mod->size);
 }
 
+static void
+hash_to_nir_args(gl_shader_stage stage,
+                 const char *entrypoint_name,
+                 const VkSpecializationInfo *spec_info,
+                 const struct spirv_to_nir_options *spirv_options,
+                 const nir_shader_compiler_options *nir_options,
+                 unsigned char key[20])
+{
+   struct mesa_sha1 ctx;
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &stage, sizeof(stage));
+   _mesa_sha1_update(&ctx, entrypoint_name, strlen(entrypoint_name) + 1);
+
+   if (spec_info && spec_info->mapEntryCount > 0) {
+      _mesa_sha1_update(&ctx, spec_info->pMapEntries,
+                        spec_info->mapEntryCount *
+                        sizeof(*spec_info->pMapEntries));
+      _mesa_sha1_update(&ctx, spec_info->pData, spec_info->dataSize);
+   }
+
+   /* The options are hashed as bytes, pointers included.  Drivers build
+    * them the same way every time, and a difference in padding only costs
+    * a cache miss.
+    */
+   _mesa_sha1_update(&ctx, spirv_options, sizeof(*spirv_options));
+   _mesa_sha1_update(&ctx, &nir_options, sizeof(nir_options));
+   _mesa_sha1_final(&ctx, key);
+}
+
+static nir_shader *
+shader_module_nir_cache_get(struct vk_shader_module *mod,
+                            const unsigned char key[20], void *mem_ctx)
+{
+   nir_shader *nir = NULL;
+
+   simple_mtx_lock(&mod->nir_cache_lock);
+   for (unsigned i = 0; i < VK_SHADER_MODULE_NIR_CACHE_SIZE; i++) {
+      if (mod->nir_cache[i].nir &&
+          memcmp(mod->nir_cache[i].key, key, 20) == 0) {
+         nir = nir_shader_clone(mem_ctx, mod->nir_cache[i].nir);
+         break;
+      }
+   }
+   simple_mtx_unlock(&mod->nir_cache_lock);
+
+   return nir;
+}
+
+static void
+shader_module_nir_cache_put(struct vk_shader_module *mod,
+                            const unsigned char key[20],
+                            const nir_shader *nir)
+{
+   nir_shader *clone = nir_shader_clone(NULL, nir);
+   if (clone == NULL)
+      return;
+
+   simple_mtx_lock(&mod->nir_cache_lock);
+   struct vk_shader_module_nir_cache_entry *entry =
+      &mod->nir_cache[mod->nir_cache_next];
+   mod->nir_cache_next = (mod->nir_cache_next + 1) %
+                         VK_SHADER_MODULE_NIR_CACHE_SIZE;
+
+   ralloc_free(entry->nir);
+   memcpy(entry->key, key, 20);
+   entry->nir = clone;
+   simple_mtx_unlock(&mod->nir_cache_lock);
+}
+
 VkResult
 vk_shader_module_to_nir(struct vk_device *device,
                         const struct vk_shader_module *mod,
@@ -119,6 +199,24 @@ vk_shader_module_to_nir(struct vk_device *device,
       *nir_out = clone;
       return VK_SUCCESS;
    } else {
+      /* The cache is internally synchronized, so it can be used through the
+       * const module.
+       */
+      struct vk_shader_module *cache_mod =
+         mod->nir_cache_enabled ? (struct vk_shader_module *)mod : NULL;
+      unsigned char key[20];
+
+      if (cache_mod) {
+         hash_to_nir_args(stage, entrypoint_name, spec_info, spirv_options,
+                          nir_options, key);
+
+         nir_shader *nir = shader_module_nir_cache_get(cache_mod, key, mem_ctx);
+         if (nir != NULL) {
+            *nir_out = nir;
+            return VK_SUCCESS;
+         }
+      }
+
       nir_shader *nir = vk_spirv_to_nir(device,
                                         (uint32_t *)mod->data, mod->size,
                                         stage, entrypoint_name, spec_info,
@@ -127,6 +225,9 @@ vk_shader_module_to_nir(struct vk_device *device,
       if (nir == NULL)
          return vk_errorf(device, VK_ERROR_UNKNOWN, "spirv_to_nir failed");
 
+      if (cache_mod)
+         shader_module_nir_cache_put(cache_mod, key, nir);
+
       *nir_out = nir;
       return VK_SUCCESS;
    }
@@ -142,6 +243,11 @@ vk_shader_module_clone(void *mem_ctx, const struct vk_shader_module *src)
 
    dst->nir = NULL;
 
+   /* Clones are freed with their ralloc parent, without a chance to free
+    * cached NIR, so they don't cache.
+    */
+   dst->nir_cache_enabled = false;
+
    memcpy(dst->sha1, src->sha1, sizeof(src->sha1));
 
    dst->size = src->size;
@@ -27,6 +27,7 @@
 #include <vulkan/vulkan.h>
 
 #include "compiler/shader_enums.h"
+#include "util/simple_mtx.h"
 #include "vk_object.h"
 
 #ifdef __cplusplus
@@ -37,10 +38,28 @@ struct nir_shader;
 struct nir_shader_compiler_options;
 struct spirv_to_nir_options;
 
+#define VK_SHADER_MODULE_NIR_CACHE_SIZE 4
+
+struct vk_shader_module_nir_cache_entry {
+   unsigned char key[20];
+   struct nir_shader *nir;
+};
+
 struct vk_shader_module {
    struct vk_object_base base;
    struct nir_shader *nir;
    unsigned char sha1[20];
+
+   /* NIR returned by vk_shader_module_to_nir() for the last few distinct
+    * sets of arguments, so that pipelines using the same entrypoint and
+    * specialization don't run spirv_to_nir again.  Only modules created by
+    * vk_common_CreateShaderModule() have it enabled.
+    */
+   bool nir_cache_enabled;
+   simple_mtx_t nir_cache_lock;
+   unsigned nir_cache_next;
+   struct vk_shader_module_nir_cache_entry nir_cache[VK_SHADER_MODULE_NIR_CACHE_SIZE];
+
    uint32_t size;
    char data[0];
 };
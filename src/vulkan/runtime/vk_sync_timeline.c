@@ -31,6 +31,23 @@
 #include "vk_alloc.h"
 #include "vk_device.h"
 #include "vk_log.h"
+#include "vk_util.h"
+
+/* A thread blocked until one or all of a set of timelines have a point
+ * pending.  It has a vk_sync_timeline_waiter on the waiters list of each of
+ * those timelines, all sharing one wake.
+ */
+struct vk_sync_timeline_wake {
+   mtx_t mutex;
+   cnd_t cond;
+   bool woken;
+};
+
+struct vk_sync_timeline_waiter {
+   struct list_head link;
+   uint64_t wait_value;
+   struct vk_sync_timeline_wake *wake;
+};
 
 static struct vk_sync_timeline *
 to_vk_sync_timeline(struct vk_sync *sync)
@@ -69,16 +86,11 @@ vk_sync_timeline_init(struct vk_device *device,
    if (ret != thrd_success)
       return vk_errorf(device, VK_ERROR_UNKNOWN, "mtx_init failed");
 
-   ret = cnd_init(&timeline->cond);
-   if (ret != thrd_success) {
-      mtx_destroy(&timeline->mutex);
-      return vk_errorf(device, VK_ERROR_UNKNOWN, "cnd_init failed");
-   }
-
    timeline->highest_past =
       timeline->highest_pending = initial_value;
    list_inithead(&timeline->pending_points);
    list_inithead(&timeline->free_points);
+   list_inithead(&timeline->waiters);
 
    return VK_SUCCESS;
 }
@@ -102,7 +114,7 @@ vk_sync_timeline_finish(struct vk_device *device,
       vk_free(&device->alloc, point);
    }
 
-   cnd_destroy(&timeline->cond);
+   assert(list_is_empty(&timeline->waiters));
    mtx_destroy(&timeline->mutex);
 }
 
@@ -289,6 +301,27 @@ vk_sync_timeline_gc_locked(struct vk_device *device,
    return VK_SUCCESS;
 }
 
+/* Wakes the waiters that highest_pending has caught up with.  They are
+ * taken off the list, a woken waiter re-adds itself if it still has to wait
+ * on something.
+ */
+static void
+vk_sync_timeline_wake_waiters_locked(struct vk_sync_timeline *timeline)
+{
+   list_for_each_entry_safe(struct vk_sync_timeline_waiter, waiter,
+                            &timeline->waiters, link) {
+      if (waiter->wait_value > timeline->highest_pending)
+         continue;
+
+      list_delinit(&waiter->link);
+
+      mtx_lock(&waiter->wake->mutex);
+      waiter->wake->woken = true;
+      cnd_signal(&waiter->wake->cond);
+      mtx_unlock(&waiter->wake->mutex);
+   }
+}
+
 VkResult
 vk_sync_timeline_point_install(struct vk_device *device,
                                struct vk_sync_timeline_point *point)
@@ -304,13 +337,10 @@ vk_sync_timeline_point_install(struct vk_device *device,
    point->pending = true;
    list_addtail(&point->link, &timeline->pending_points);
 
-   int ret = cnd_broadcast(&timeline->cond);
+   vk_sync_timeline_wake_waiters_locked(timeline);
 
    mtx_unlock(&timeline->mutex);
 
-   if (ret == thrd_error)
-      return vk_errorf(device, VK_ERROR_UNKNOWN, "cnd_broadcast failed");
-
    return VK_SUCCESS;
 }
 
@@ -381,9 +411,7 @@ vk_sync_timeline_signal_locked(struct vk_device *device,
    assert(timeline->highest_pending == timeline->highest_past);
    timeline->highest_pending = timeline->highest_past = value;
 
-   int ret = cnd_broadcast(&timeline->cond);
-   if (ret == thrd_error)
-      return vk_errorf(device, VK_ERROR_UNKNOWN, "cnd_broadcast failed");
+   vk_sync_timeline_wake_waiters_locked(timeline);
 
    return VK_SUCCESS;
 }
@@ -421,56 +449,138 @@ vk_sync_timeline_get_value(struct vk_device *device,
    return VK_SUCCESS;
 }
 
-static VkResult
-vk_sync_timeline_wait_locked(struct vk_device *device,
-                             struct vk_sync_timeline *timeline,
-                             uint64_t wait_value,
-                             enum vk_sync_wait_flags wait_flags,
-                             uint64_t abs_timeout_ns)
+static int
+vk_sync_timeline_cnd_wait(cnd_t *cond, mtx_t *mutex,
+                          uint64_t now_ns, uint64_t abs_timeout_ns)
 {
-   /* Wait on the queue_submit condition variable until the timeline has a
-    * time point pending that's at least as high as wait_value.
+   if (abs_timeout_ns >= INT64_MAX) {
+      /* Common infinite wait case */
+      return cnd_wait(cond, mutex);
+   }
+
+   /* This is really annoying.  The C11 threads API uses CLOCK_REALTIME
+    * while all our absolute timeouts are in CLOCK_MONOTONIC.  Best
+    * thing we can do is to convert and hope the system admin doesn't
+    * change the time out from under us.
     */
+   uint64_t rel_timeout_ns = abs_timeout_ns - now_ns;
+
+   struct timespec now_ts, abs_timeout_ts;
+   timespec_get(&now_ts, TIME_UTC);
+   if (timespec_add_nsec(&abs_timeout_ts, &now_ts, rel_timeout_ns)) {
+      /* Overflowed; may as well be infinite */
+      return cnd_wait(cond, mutex);
+   }
+
+   return cnd_timedwait(cond, mutex, &abs_timeout_ts);
+}
+
+/* Waits until one (wait_any) or all of the timelines in waits have a time
+ * point pending that's at least as high as the wait value.
+ */
+static VkResult
+vk_sync_timeline_wait_pending(struct vk_device *device,
+                              uint32_t wait_count,
+                              const struct vk_sync_wait *waits,
+                              bool wait_any,
+                              uint64_t abs_timeout_ns)
+{
+   STACK_ARRAY(struct vk_sync_timeline_waiter, waiters, wait_count);
+   if (waiters == NULL)
+      return vk_error(device, VK_ERROR_OUT_OF_HOST_MEMORY);
+
+   struct vk_sync_timeline_wake wake = { .woken = false };
+   VkResult result = VK_SUCCESS;
+
+   if (mtx_init(&wake.mutex, mtx_plain) != thrd_success) {
+      STACK_ARRAY_FINISH(waiters);
+      return vk_errorf(device, VK_ERROR_UNKNOWN, "mtx_init failed");
+   }
+
+   if (cnd_init(&wake.cond) != thrd_success) {
+      mtx_destroy(&wake.mutex);
+      STACK_ARRAY_FINISH(waiters);
+      return vk_errorf(device, VK_ERROR_UNKNOWN, "cnd_init failed");
+   }
+
+   for (uint32_t i = 0; i < wait_count; i++) {
+      list_inithead(&waiters[i].link);
+      waiters[i].wait_value = waits[i].wait_value;
+      waiters[i].wake = &wake;
+   }
+
    uint64_t now_ns = os_time_get_nano();
-   while (timeline->highest_pending < wait_value) {
-      if (now_ns >= abs_timeout_ns)
-         return VK_TIMEOUT;
-
-      int ret;
-      if (abs_timeout_ns >= INT64_MAX) {
-         /* Common infinite wait case */
-         ret = cnd_wait(&timeline->cond, &timeline->mutex);
-      } else {
-         /* This is really annoying.  The C11 threads API uses CLOCK_REALTIME
-          * while all our absolute timeouts are in CLOCK_MONOTONIC.  Best
-          * thing we can do is to convert and hope the system admin doesn't
-          * change the time out from under us.
-          */
-         uint64_t rel_timeout_ns = abs_timeout_ns - now_ns;
-
-         struct timespec now_ts, abs_timeout_ts;
-         timespec_get(&now_ts, TIME_UTC);
-         if (timespec_add_nsec(&abs_timeout_ts, &now_ts, rel_timeout_ns)) {
-            /* Overflowed; may as well be infinite */
-            ret = cnd_wait(&timeline->cond, &timeline->mutex);
-         } else {
-            ret = cnd_timedwait(&timeline->cond, &timeline->mutex,
-                                &abs_timeout_ts);
+   while (true) {
+      /* Checking and adding the waiter under the timeline's lock means no
+       * install in between can be missed.
+       */
+      uint32_t ready_count = 0;
+      for (uint32_t i = 0; i < wait_count; i++) {
+         struct vk_sync_timeline *timeline = to_vk_sync_timeline(waits[i].sync);
+
+         mtx_lock(&timeline->mutex);
+         if (timeline->highest_pending >= waits[i].wait_value)
+            ready_count++;
+         else if (list_is_empty(&waiters[i].link))
+            list_addtail(&waiters[i].link, &timeline->waiters);
+         mtx_unlock(&timeline->mutex);
+      }
+
+      if (wait_any ? ready_count > 0 : ready_count == wait_count)
+         break;
+
+      mtx_lock(&wake.mutex);
+      while (!wake.woken && now_ns < abs_timeout_ns) {
+         int ret = vk_sync_timeline_cnd_wait(&wake.cond, &wake.mutex,
+                                             now_ns, abs_timeout_ns);
+         if (ret == thrd_error) {
+            result = vk_errorf(device, VK_ERROR_UNKNOWN,
+                               "cnd_timedwait failed");
+            break;
          }
+
+         /* We don't trust the timeout condition on cnd_timedwait() because
+          * of the potential clock issues caused by using CLOCK_REALTIME.
+          * Instead, update now_ns, go back to the top of the loop, and
+          * re-check.
+          */
+         now_ns = os_time_get_nano();
       }
-      if (ret == thrd_error)
-         return vk_errorf(device, VK_ERROR_UNKNOWN, "cnd_timedwait failed");
+      const bool woken = wake.woken;
+      wake.woken = false;
+      mtx_unlock(&wake.mutex);
 
-      /* We don't trust the timeout condition on cnd_timedwait() because of
-       * the potential clock issues caused by using CLOCK_REALTIME.  Instead,
-       * update now_ns, go back to the top of the loop, and re-check.
-       */
-      now_ns = os_time_get_nano();
+      if (result != VK_SUCCESS)
+         break;
+
+      if (!woken) {
+         result = VK_TIMEOUT;
+         break;
+      }
    }
 
-   if (wait_flags & VK_SYNC_WAIT_PENDING)
-      return VK_SUCCESS;
+   for (uint32_t i = 0; i < wait_count; i++) {
+      struct vk_sync_timeline *timeline = to_vk_sync_timeline(waits[i].sync);
+
+      mtx_lock(&timeline->mutex);
+      if (!list_is_empty(&waiters[i].link))
+         list_del(&waiters[i].link);
+      mtx_unlock(&timeline->mutex);
+   }
+
+   cnd_destroy(&wake.cond);
+   mtx_destroy(&wake.mutex);
+   STACK_ARRAY_FINISH(waiters);
+
+   return result;
+}
 
+static VkResult
+vk_sync_timeline_wait_complete_locked(struct vk_device *device,
+                                      struct vk_sync_timeline *timeline,
+                                      uint64_t wait_value,
+                                      uint64_t abs_timeout_ns)
+{
    VkResult result = vk_sync_timeline_gc_locked(device, timeline, false);
    if (result != VK_SUCCESS)
       return result;
@@ -508,16 +618,112 @@ vk_sync_timeline_wait(struct vk_device *device,
                       uint64_t abs_timeout_ns)
 {
    struct vk_sync_timeline *timeline = to_vk_sync_timeline(sync);
+   const struct vk_sync_wait wait = {
+      .sync = sync,
+      .wait_value = wait_value,
+   };
+
+   VkResult result = vk_sync_timeline_wait_pending(device, 1, &wait, false,
+                                                   abs_timeout_ns);
+   if (result != VK_SUCCESS || (wait_flags & VK_SYNC_WAIT_PENDING))
+      return result;
 
    mtx_lock(&timeline->mutex);
-   VkResult result = vk_sync_timeline_wait_locked(device, timeline,
-                                             wait_value, wait_flags,
-                                             abs_timeout_ns);
+   result = vk_sync_timeline_wait_complete_locked(device, timeline,
+                                                  wait_value, abs_timeout_ns);
    mtx_unlock(&timeline->mutex);
 
    return result;
 }
 
+static VkResult
+vk_sync_timeline_wait_many(struct vk_device *device,
+                           uint32_t wait_count,
+                           const struct vk_sync_wait *waits,
+                           enum vk_sync_wait_flags wait_flags,
+                           uint64_t abs_timeout_ns)
+{
+   if (!(wait_flags & VK_SYNC_WAIT_ANY)) {
+      for (uint32_t i = 0; i < wait_count; i++) {
+         VkResult result = vk_sync_timeline_wait(device, waits[i].sync,
+                                                 waits[i].wait_value,
+                                                 wait_flags, abs_timeout_ns);
+         if (result != VK_SUCCESS)
+            return result;
+      }
+      return VK_SUCCESS;
+   }
+
+   VkResult result = vk_sync_timeline_wait_pending(device, wait_count, waits,
+                                                   true, abs_timeout_ns);
+   if (result != VK_SUCCESS || (wait_flags & VK_SYNC_WAIT_PENDING))
+      return result;
+
+   /* At least one of the timelines has its point pending now.  Wait for
+    * any of the pending points to complete with a single wait on the
+    * point syncs, which the point sync type can do without polling.
+    * Timelines that only get a point submitted from here on aren't waited
+    * for, which can only make us return later than strictly needed.
+    */
+   STACK_ARRAY(struct vk_sync_timeline_point *, points, wait_count);
+   STACK_ARRAY(struct vk_sync_wait, point_waits, wait_count);
+   if (points == NULL || point_waits == NULL) {
+      STACK_ARRAY_FINISH(points);
+      STACK_ARRAY_FINISH(point_waits);
+      return vk_error(device, VK_ERROR_OUT_OF_HOST_MEMORY);
+   }
+
+   uint32_t point_count = 0;
+   bool done = false;
+   for (uint32_t i = 0; i < wait_count && !done; i++) {
+      struct vk_sync_timeline *timeline = to_vk_sync_timeline(waits[i].sync);
+      struct vk_sync_timeline_point *point = NULL;
+
+      mtx_lock(&timeline->mutex);
+      result = vk_sync_timeline_gc_locked(device, timeline, false);
+      if (result == VK_SUCCESS) {
+         result = vk_sync_timeline_get_point_locked(device, timeline,
+                                                    waits[i].wait_value,
+                                                    &point);
+      }
+      mtx_unlock(&timeline->mutex);
+
+      if (result == VK_NOT_READY) {
+         /* Nothing submitted for this one yet */
+         result = VK_SUCCESS;
+         continue;
+      } else if (result != VK_SUCCESS) {
+         done = true;
+      } else if (point == NULL) {
+         /* Already complete */
+         done = true;
+      } else {
+         points[point_count] = point;
+         point_waits[point_count] = (struct vk_sync_wait) {
+            .sync = &point->sync,
+            .stage_mask = ~(VkPipelineStageFlags2)0,
+            .wait_value = 0,
+         };
+         point_count++;
+      }
+   }
+
+   if (!done) {
+      assert(point_count > 0);
+      result = vk_sync_wait_many(device, point_count, point_waits,
+                                 VK_SYNC_WAIT_COMPLETE | VK_SYNC_WAIT_ANY,
+                                 abs_timeout_ns);
+   }
+
+   for (uint32_t i = 0; i < point_count; i++)
+      vk_sync_timeline_point_release(device, points[i]);
+
+   STACK_ARRAY_FINISH(points);
+   STACK_ARRAY_FINISH(point_waits);
+
+   return result;
+}
+
 struct vk_sync_timeline_type
 vk_sync_timeline_get_type(const struct vk_sync_type *point_sync_type)
 {
@@ -535,6 +741,7 @@ vk_sync_timeline_get_type(const struct vk_sync_type *point_sync_type)
          .signal = vk_sync_timeline_signal,
          .get_value = vk_sync_timeline_get_value,
          .wait = vk_sync_timeline_wait,
+         .wait_many = vk_sync_timeline_wait_many,
       },
       .point_sync_type = point_sync_type,
    };
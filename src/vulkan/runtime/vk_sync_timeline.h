@@ -79,13 +79,17 @@ struct vk_sync_timeline {
    struct vk_sync sync;
 
    mtx_t mutex;
-   cnd_t cond;
 
    uint64_t highest_past;
    uint64_t highest_pending;
 
    struct list_head pending_points;
    struct list_head free_points;
+
+   /* Threads waiting for highest_pending to reach some value, woken
+    * individually once it does.
+    */
+   struct list_head waiters;
 };
 
 VkResult vk_sync_timeline_init(struct vk_device *device,
@@ -64,6 +64,8 @@ TEMPLATE_H = Template(COPYRIGHT + """\
 
 #pragma once
 
+#include <assert.h>
+
 #include "util/list.h"
 
 #define VK_PROTOTYPES
@@ -74,11 +76,23 @@ extern "C" {
 #endif
 
 struct vk_device_dispatch_table;
+struct vk_cmd_queue_chunk;
+struct vk_cmd_queue_entry;
 
 struct vk_cmd_queue {
    const VkAllocationCallbacks *alloc;
    struct list_head cmds;
    VkResult error;
+
+   /* Commands and their parameters are bump-allocated out of these chunks
+    * with vk_cmd_queue_zalloc().  Resetting the queue only rewinds to the
+    * first chunk, they are freed in vk_cmd_queue_finish().
+    */
+   struct list_head chunks;
+   struct vk_cmd_queue_chunk *chunk;
+
+   /* Entries with a driver_free_cb, linked through free_cb_next */
+   struct vk_cmd_queue_entry *free_cb_cmds;
 };
 
 enum vk_cmd_type {
@@ -132,8 +146,27 @@ struct vk_cmd_queue_entry {
    void *driver_data;
    void (*driver_free_cb)(struct vk_cmd_queue *queue,
                           struct vk_cmd_queue_entry *cmd);
+   struct vk_cmd_queue_entry *free_cb_next;
 };
 
+/* Allocates zeroed memory that lives until the queue is reset */
+void *vk_cmd_queue_zalloc(struct vk_cmd_queue *queue, size_t size);
+
+/* Makes the queue call free_cb on cmd when it is reset or finished, for
+ * the driver to drop whatever cmd or driver_data references.
+ */
+static inline void
+vk_cmd_queue_entry_set_free_cb(struct vk_cmd_queue *queue,
+                               struct vk_cmd_queue_entry *cmd,
+                               void (*free_cb)(struct vk_cmd_queue *queue,
+                                               struct vk_cmd_queue_entry *cmd))
+{
+   assert(cmd->driver_free_cb == NULL);
+   cmd->driver_free_cb = free_cb;
+   cmd->free_cb_next = queue->free_cb_cmds;
+   queue->free_cb_cmds = cmd;
+}
+
 % for c in commands:
 % if c.name in manual_commands or c.name in no_enqueue_commands:
 <% continue %>
@@ -160,6 +193,9 @@ vk_cmd_queue_init(struct vk_cmd_queue *queue, VkAllocationCallbacks *alloc)
    queue->alloc = alloc;
    list_inithead(&queue->cmds);
    queue->error = VK_SUCCESS;
+   list_inithead(&queue->chunks);
+   queue->chunk = NULL;
+   queue->free_cb_cmds = NULL;
 }
 
 static inline void
@@ -170,12 +206,7 @@ vk_cmd_queue_reset(struct vk_cmd_queue *queue)
    queue->error = VK_SUCCESS;
 }
 
-static inline void
-vk_cmd_queue_finish(struct vk_cmd_queue *queue)
-{
-   vk_free_queue(queue);
-   list_inithead(&queue->cmds);
-}
+void vk_cmd_queue_finish(struct vk_cmd_queue *queue);
 
 void vk_cmd_queue_execute(struct vk_cmd_queue *queue,
                           VkCommandBuffer commandBuffer,
@@ -194,12 +225,81 @@ TEMPLATE_C = Template(COPYRIGHT + """
 #define VK_PROTOTYPES
 #include <vulkan/vulkan.h>
 
+#include "util/macros.h"
+
 #include "vk_alloc.h"
 #include "vk_cmd_enqueue_entrypoints.h"
 #include "vk_command_buffer.h"
 #include "vk_dispatch_table.h"
 #include "vk_device.h"
 
+struct vk_cmd_queue_chunk {
+   struct list_head link;
+   size_t size;
+   size_t used;
+   uint64_t data[];
+};
+
+#define VK_CMD_QUEUE_CHUNK_MIN_SIZE 4096
+#define VK_CMD_QUEUE_CHUNK_MAX_SIZE (64 * 1024)
+
+static struct vk_cmd_queue_chunk *
+vk_cmd_queue_next_chunk(struct vk_cmd_queue *queue, size_t size)
+{
+   /* Chunks after the current one are left over from before the last reset,
+    * reuse those first.
+    */
+   struct list_head *next = queue->chunk != NULL ?
+                            queue->chunk->link.next : queue->chunks.next;
+   for (; next != &queue->chunks; next = next->next) {
+      struct vk_cmd_queue_chunk *chunk =
+         LIST_ENTRY(struct vk_cmd_queue_chunk, next, link);
+      if (chunk->size >= size) {
+         chunk->used = 0;
+         queue->chunk = chunk;
+         return chunk;
+      }
+   }
+
+   size_t chunk_size = VK_CMD_QUEUE_CHUNK_MIN_SIZE;
+   if (queue->chunk != NULL)
+      chunk_size = MIN2(queue->chunk->size * 2, VK_CMD_QUEUE_CHUNK_MAX_SIZE);
+   chunk_size = MAX2(chunk_size, size);
+
+   struct vk_cmd_queue_chunk *chunk =
+      vk_alloc(queue->alloc, sizeof(*chunk) + chunk_size, 8,
+               VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+   if (chunk == NULL)
+      return NULL;
+
+   chunk->size = chunk_size;
+   chunk->used = 0;
+   list_add(&chunk->link, queue->chunk != NULL ? &queue->chunk->link
+                                               : &queue->chunks);
+   queue->chunk = chunk;
+
+   return chunk;
+}
+
+void *
+vk_cmd_queue_zalloc(struct vk_cmd_queue *queue, size_t size)
+{
+   size = ALIGN_POT(size, 8);
+
+   struct vk_cmd_queue_chunk *chunk = queue->chunk;
+   if (chunk == NULL || chunk->size - chunk->used < size) {
+      chunk = vk_cmd_queue_next_chunk(queue, size);
+      if (chunk == NULL)
+         return NULL;
+   }
+
+   void *ptr = (char *)chunk->data + chunk->used;
+   chunk->used += size;
+   memset(ptr, 0, size);
+
+   return ptr;
+}
+
 const char *vk_cmd_queue_type_names[] = {
 % for c in commands:
 % if c.guard is not None:
@@ -216,25 +316,6 @@ const char *vk_cmd_queue_type_names[] = {
 % if c.guard is not None:
 #ifdef ${c.guard}
 % endif
-static void
-vk_free_${to_underscore(c.name)}(struct vk_cmd_queue *queue,
-${' ' * len('vk_free_' + to_underscore(c.name) + '(')}\\
-struct vk_cmd_queue_entry *cmd)
-{
-   if (cmd->driver_free_cb)
-      cmd->driver_free_cb(queue, cmd);
-   else
-      vk_free(queue->alloc, cmd->driver_data);
-% for p in c.params[1:]:
-% if p.len:
-   vk_free(queue->alloc, (${remove_suffix(p.decl.replace("const", ""), p.name)})cmd->u.${to_struct_field_name(c.name)}.${to_field_name(p.name)});
-% elif '*' in p.decl:
-   ${get_struct_free(c, p, types)}
-% endif
-% endfor
-   vk_free(queue->alloc, cmd);
-}
-
 % if c.name not in manual_commands and c.name not in no_enqueue_commands:
 void vk_enqueue_${to_underscore(c.name)}(struct vk_cmd_queue *queue
 % for p in c.params[1:]:
@@ -245,9 +326,7 @@ void vk_enqueue_${to_underscore(c.name)}(struct vk_cmd_queue *queue
    if (queue->error)
       return;
 
-   struct vk_cmd_queue_entry *cmd = vk_zalloc(queue->alloc,
-                                              sizeof(*cmd), 8,
-                                              VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+   struct vk_cmd_queue_entry *cmd = vk_cmd_queue_zalloc(queue, sizeof(*cmd));
    if (!cmd) goto err;
 
    cmd->type = ${to_enum_name(c.name)};
@@ -273,9 +352,8 @@ void vk_enqueue_${to_underscore(c.name)}(struct vk_cmd_queue *queue
    return;
 
 err:
+   /* Whatever was allocated is reclaimed when the queue is reset */
    queue->error = VK_ERROR_OUT_OF_HOST_MEMORY;
-   if (cmd)
-      vk_free_${to_underscore(c.name)}(queue, cmd);
 }
 % endif
 % if c.guard is not None:
@@ -287,22 +365,25 @@ err:
 void
 vk_free_queue(struct vk_cmd_queue *queue)
 {
-   struct vk_cmd_queue_entry *tmp, *cmd;
-   LIST_FOR_EACH_ENTRY_SAFE(cmd, tmp, &queue->cmds, cmd_link) {
-      switch(cmd->type) {
-% for c in commands:
-% if c.guard is not None:
-#ifdef ${c.guard}
-% endif
-      case ${to_enum_name(c.name)}:
-         vk_free_${to_underscore(c.name)}(queue, cmd);
-         break;
-% if c.guard is not None:
-#endif // ${c.guard}
-% endif
-% endfor
-      }
-   }
+   for (struct vk_cmd_queue_entry *cmd = queue->free_cb_cmds;
+        cmd != NULL; cmd = cmd->free_cb_next)
+      cmd->driver_free_cb(queue, cmd);
+   queue->free_cb_cmds = NULL;
+
+   /* Everything else lives in the chunks, start over from the first one */
+   queue->chunk = NULL;
+}
+
+void
+vk_cmd_queue_finish(struct vk_cmd_queue *queue)
+{
+   vk_free_queue(queue);
+   list_inithead(&queue->cmds);
+
+   list_for_each_entry_safe(struct vk_cmd_queue_chunk, chunk,
+                            &queue->chunks, link)
+      vk_free(queue->alloc, chunk);
+   list_inithead(&queue->chunks);
 }
 
 void
@@ -422,7 +503,7 @@ def get_array_copy(command, param):
         field_size = "1"
     else:
         field_size = "sizeof(*%s)" % field_name
-    allocation = "%s = vk_zalloc(queue->alloc, %s * %s, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);\n   if (%s == NULL) goto err;\n" % (field_name, field_size, param.len, field_name)
+    allocation = "%s = vk_cmd_queue_zalloc(queue, %s * %s);\n   if (%s == NULL) goto err;\n" % (field_name, field_size, param.len, field_name)
     const_cast = remove_suffix(param.decl.replace("const", ""), param.name)
     copy = "memcpy((%s)%s, %s, %s * %s);" % (const_cast, field_name, param.name, field_size, param.len)
     return "%s\n   %s" % (allocation, copy)
@@ -433,7 +514,7 @@ def get_array_member_copy(struct, src_name, member):
         field_size = "sizeof(*%s)" % (field_name)
     else:
         field_size = "sizeof(*%s) * %s->%s" % (field_name, struct, member.len)
-    allocation = "%s = vk_zalloc(queue->alloc, %s, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);\n   if (%s == NULL) goto err;\n" % (field_name, field_size, field_name)
+    allocation = "%s = vk_cmd_queue_zalloc(queue, %s);\n   if (%s == NULL) goto err;\n" % (field_name, field_size, field_name)
     const_cast = remove_suffix(member.decl.replace("const", ""), member.name)
     copy = "memcpy((%s)%s, %s->%s, %s);" % (const_cast, field_name, src_name, member.name, field_size)
     return "if (%s->%s) {\n   %s\n   %s\n}\n" % (src_name, member.name, allocation, copy)
@@ -463,7 +544,7 @@ def get_struct_copy(dst, src_name, src_type, size, types, level=0):
     global tmp_dst_idx
     global tmp_src_idx
 
-    allocation = "%s = vk_zalloc(queue->alloc, %s, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);\n      if (%s == NULL) goto err;\n" % (dst, size, dst)
+    allocation = "%s = vk_cmd_queue_zalloc(queue, %s);\n      if (%s == NULL) goto err;\n" % (dst, size, dst)
     copy = "memcpy((void*)%s, %s, %s);" % (dst, src_name, size)
 
     level += 1
@@ -482,19 +563,6 @@ def get_struct_copy(dst, src_name, src_type, size, types, level=0):
     if_stmt = "if (%s) {" % src_name
     return "%s\n      %s\n      %s\n   %s\n   %s   \n   %s   } else {\n      %s\n   }" % (if_stmt, allocation, copy, tmp_dst, tmp_src, member_copies, null_assignment)
 
-def get_struct_free(command, param, types):
-    field_name = "cmd->u.%s.%s" % (to_struct_field_name(command.name), to_field_name(param.name))
-    const_cast = remove_suffix(param.decl.replace("const", ""), param.name)
-    struct_free = "vk_free(queue->alloc, (%s)%s);" % (const_cast, field_name)
-    member_frees = ""
-    if (param.type in types):
-        for member in types[param.type].members:
-            if member.len and member.len != 'null-terminated':
-                member_name = "cmd->u.%s.%s->%s" % (to_struct_field_name(command.name), to_field_name(param.name), member.name)
-                const_cast = remove_suffix(member.decl.replace("const", ""), member.name)
-                member_frees += "vk_free(queue->alloc, (%s)%s);\n" % (const_cast, member_name)
-    return "%s      %s\n" % (member_frees, struct_free)
-
 EntrypointType = namedtuple('EntrypointType', 'name enum members extended_by')
 
 def get_types(doc):
@@ -575,7 +643,6 @@ def main():
         'to_struct_name': to_struct_name,
         'get_array_copy': get_array_copy,
         'get_struct_copy': get_struct_copy,
-        'get_struct_free': get_struct_free,
         'types': types,
         'manual_commands': MANUAL_COMMANDS,
         'no_enqueue_commands': NO_ENQUEUE_COMMANDS,
@@ -922,6 +922,8 @@ wsi_common_queue_present(const struct wsi_device *wsi,
 
    const VkPresentRegionsKHR *regions =
       vk_find_struct_const(pPresentInfo->pNext, PRESENT_REGIONS_KHR);
+   const VkPresentTimesInfoGOOGLE *times =
+      vk_find_struct_const(pPresentInfo->pNext, PRESENT_TIMES_INFO_GOOGLE);
 
    for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++) {
       VK_FROM_HANDLE(wsi_swapchain, swapchain, pPresentInfo->pSwapchains[i]);
@@ -1053,7 +1055,12 @@ wsi_common_queue_present(const struct wsi_device *wsi,
       if (regions && regions->pRegions)
          region = &regions->pRegions[i];
 
-      result = swapchain->queue_present(swapchain, image_index, region);
+      const VkPresentTimeGOOGLE *present_time = NULL;
+      if (times && times->pTimes)
+         present_time = &times->pTimes[i];
+
+      result = swapchain->queue_present(swapchain, image_index,
+                                        present_time, region);
       if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
          goto fail_present;
 
@@ -1086,6 +1093,39 @@ wsi_QueuePresentKHR(VkQueue _queue, const VkPresentInfoKHR *pPresentInfo)
                                    pPresentInfo);
 }
 
+VKAPI_ATTR VkResult VKAPI_CALL
+wsi_GetRefreshCycleDurationGOOGLE(VkDevice device,
+                                  VkSwapchainKHR _swapchain,
+                                  VkRefreshCycleDurationGOOGLE *pDisplayTimingProperties)
+{
+   VK_FROM_HANDLE(wsi_swapchain, swapchain, _swapchain);
+
+   if (!swapchain->get_refresh_cycle_duration)
+      return VK_ERROR_SURFACE_LOST_KHR;
+
+   return swapchain->get_refresh_cycle_duration(swapchain,
+                                                pDisplayTimingProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+wsi_GetPastPresentationTimingGOOGLE(VkDevice device,
+                                    VkSwapchainKHR _swapchain,
+                                    uint32_t *pPresentationTimingCount,
+                                    VkPastPresentationTimingGOOGLE *pPresentationTimings)
+{
+   VK_FROM_HANDLE(wsi_swapchain, swapchain, _swapchain);
+
+   /* Backends without presentation feedback never have any to report */
+   if (!swapchain->get_past_presentation_timing) {
+      *pPresentationTimingCount = 0;
+      return VK_SUCCESS;
+   }
+
+   return swapchain->get_past_presentation_timing(swapchain,
+                                                  pPresentationTimingCount,
+                                                  pPresentationTimings);
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL
 wsi_GetDeviceGroupPresentCapabilitiesKHR(VkDevice device,
                                          VkDeviceGroupPresentCapabilitiesKHR *pCapabilities)
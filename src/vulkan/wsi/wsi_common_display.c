@@ -139,20 +139,42 @@ struct wsi_display_image {
    uint32_t                     fb_id;
    uint32_t                     buffer[4];
    uint64_t                     flip_sequence;
+
+   /* VK_GOOGLE_display_timing state of the pending present */
+   bool                         has_present_time;
+   bool                         paced;
+   uint32_t                     present_id;
+   uint64_t                     desired_present_time;
+   uint64_t                     earliest_present_time;
+   uint64_t                     flip_submit_time;
 };
 
+/* Number of past presents VK_GOOGLE_display_timing reports on */
+#define WSI_DISPLAY_PAST_TIMINGS 16
+
 struct wsi_display_swapchain {
    struct wsi_swapchain         base;
    struct wsi_display           *wsi;
    VkIcdSurfaceDisplay          *surface;
    uint64_t                     flip_sequence;
    VkResult                     status;
+
+   /* Presentation feedback, protected by wsi->wait_mutex */
+   uint64_t                     refresh_duration;
+   uint64_t                     last_flip_time;
+   struct wsi_display_fence     *pacing_fence;
+   uint32_t                     past_timing_count;
+   uint32_t                     past_timing_first;
+   VkPastPresentationTimingGOOGLE past_timings[WSI_DISPLAY_PAST_TIMINGS];
+
    struct wsi_display_image     images[0];
 };
 
 struct wsi_display_fence {
    struct list_head             link;
    struct wsi_display           *wsi;
+   /* swapchain whose flip is held back until this vblank, if any */
+   struct wsi_display_swapchain *chain;
    bool                         event_received;
    bool                         destroyed;
    uint32_t                     syncobj; /* syncobj to signal on event */
@@ -1162,6 +1184,14 @@ wsi_display_swapchain_destroy(struct wsi_swapchain *drv_chain,
    struct wsi_display_swapchain *chain =
       (struct wsi_display_swapchain *) drv_chain;
 
+   /* A pending pacing event frees itself once it arrives, it just mustn't
+    * touch the swapchain anymore.
+    */
+   pthread_mutex_lock(&chain->wsi->wait_mutex);
+   if (chain->pacing_fence)
+      chain->pacing_fence->chain = NULL;
+   pthread_mutex_unlock(&chain->wsi->wait_mutex);
+
    for (uint32_t i = 0; i < chain->base.image_count; i++)
       wsi_display_image_finish(drv_chain, allocator, &chain->images[i]);
    wsi_destroy_image_info(&chain->base, &chain->base.image_info);
@@ -1200,6 +1230,47 @@ wsi_display_idle_old_displaying(struct wsi_display_image *active_image)
 static VkResult
 _wsi_display_queue_next(struct wsi_swapchain *drv_chain);
 
+/*
+ * Record when an image made it to the screen for
+ * vkGetPastPresentationTimingGOOGLE. Call with wait_mutex held
+ */
+static void
+wsi_display_record_timing(struct wsi_display_image *image,
+                          uint64_t flip_time)
+{
+   struct wsi_display_swapchain *chain = image->chain;
+
+   chain->last_flip_time = flip_time;
+
+   if (!image->has_present_time)
+      return;
+   image->has_present_time = false;
+
+   /* Drop the oldest entry when the application doesn't query them */
+   if (chain->past_timing_count == WSI_DISPLAY_PAST_TIMINGS) {
+      chain->past_timing_first =
+         (chain->past_timing_first + 1) % WSI_DISPLAY_PAST_TIMINGS;
+      chain->past_timing_count--;
+   }
+
+   uint32_t idx = (chain->past_timing_first + chain->past_timing_count) %
+                  WSI_DISPLAY_PAST_TIMINGS;
+   chain->past_timing_count++;
+
+   uint64_t earliest = image->earliest_present_time ?
+                       MIN2(image->earliest_present_time, flip_time) :
+                       flip_time;
+
+   chain->past_timings[idx] = (VkPastPresentationTimingGOOGLE) {
+      .presentID = image->present_id,
+      .desiredPresentTime = image->desired_present_time,
+      .actualPresentTime = flip_time,
+      .earliestPresentTime = earliest,
+      .presentMargin = flip_time > image->flip_submit_time ?
+                       flip_time - image->flip_submit_time : 0,
+   };
+}
+
 static void
 wsi_display_page_flip_handler2(int fd,
                                unsigned int frame,
@@ -1213,6 +1284,9 @@ wsi_display_page_flip_handler2(int fd,
 
    wsi_display_debug("image %ld displayed at %d\n",
                      image - &(image->chain->images[0]), frame);
+   /* Page flip timestamps are CLOCK_MONOTONIC, like os_time_get_nano */
+   wsi_display_record_timing(image, (uint64_t) sec * 1000000000ull +
+                                    (uint64_t) usec * 1000ull);
    image->state = WSI_IMAGE_DISPLAYING;
    wsi_display_idle_old_displaying(image);
    VkResult result = _wsi_display_queue_next(&(chain->base));
@@ -1604,6 +1678,18 @@ wsi_display_fence_check_free(struct wsi_display_fence *fence)
 
 static void wsi_display_fence_event_handler(struct wsi_display_fence *fence)
 {
+   if (fence->chain) {
+      struct wsi_display_swapchain *chain = fence->chain;
+
+      assert(chain->pacing_fence == fence);
+      chain->pacing_fence = NULL;
+      fence->chain = NULL;
+
+      VkResult result = _wsi_display_queue_next(&chain->base);
+      if (result != VK_SUCCESS)
+         chain->status = result;
+   }
+
    if (fence->syncobj) {
       (void) drmSyncobjSignal(fence->wsi->syncobj_fd, &fence->syncobj, 1);
       (void) drmSyncobjDestroy(fence->wsi->syncobj_fd, fence->syncobj);
@@ -1785,6 +1871,65 @@ wsi_register_vblank_event(struct wsi_display_fence *fence,
    }
 }
 
+/*
+ * Hold the flip of image back if flipping now would show it more than half
+ * a refresh cycle before its desiredPresentTime. Instead an event is queued
+ * for the vblank before the one it should land on, and the flip is sent
+ * from there. Call with wait_mutex held
+ */
+static bool
+wsi_display_pace_flip(struct wsi_display_swapchain *chain,
+                      struct wsi_display_image *image,
+                      uint32_t crtc_id)
+{
+   struct wsi_display *wsi = chain->wsi;
+   const uint64_t refresh = chain->refresh_duration;
+
+   if (image->paced || !image->desired_present_time ||
+       !chain->last_flip_time || !refresh || !crtc_id)
+      return false;
+
+   /* The flip can't complete before the next vblank, estimated from the
+    * last one we got an event for.
+    */
+   uint64_t now = os_time_get_nano();
+   uint64_t next_vblank = chain->last_flip_time + refresh;
+   if (now > chain->last_flip_time)
+      next_vblank += (now - chain->last_flip_time) / refresh * refresh;
+
+   if (image->desired_present_time <= next_vblank + refresh / 2)
+      return false;
+
+   uint64_t frames = (image->desired_present_time - next_vblank +
+                      refresh / 2) / refresh;
+
+   struct wsi_display_fence *fence = wsi_display_fence_alloc(wsi, -1);
+   if (!fence)
+      return false;
+
+   /* Nobody but the event handler references the fence */
+   fence->destroyed = true;
+   fence->chain = chain;
+
+   /* This can't go through wsi_register_vblank_event because that takes
+    * wait_mutex when the kernel event queue is full. Flipping right away
+    * is a fine fallback in that case.
+    */
+   if (wsi_display_start_wait_thread(wsi) ||
+       drmCrtcQueueSequence(wsi->fd, crtc_id, DRM_CRTC_SEQUENCE_RELATIVE,
+                            frames, NULL, (uintptr_t) fence)) {
+      vk_free(wsi->alloc, fence);
+      return false;
+   }
+
+   wsi_display_debug("pacing image %ld for %lu frames\n",
+                     image - &chain->images[0], frames);
+   image->paced = true;
+   image->earliest_present_time = next_vblank;
+   chain->pacing_fence = fence;
+   return true;
+}
+
 /*
  * Check to see if the kernel has no flip queued and if there's an image
  * waiting to be displayed.
@@ -1833,8 +1978,16 @@ _wsi_display_queue_next(struct wsi_swapchain *drv_chain)
       if (!image)
          return VK_SUCCESS;
 
+      /* Waiting for the vblank a queued image is due at */
+      if (chain->pacing_fence)
+         return VK_SUCCESS;
+
       int ret;
       if (connector->active) {
+         if (wsi_display_pace_flip(chain, image, connector->crtc_id))
+            return VK_SUCCESS;
+
+         image->flip_submit_time = os_time_get_nano();
          ret = drmModePageFlip(wsi->fd, connector->crtc_id, image->fb_id,
                                    DRM_MODE_PAGE_FLIP_EVENT, image);
          if (ret == 0) {
@@ -1896,6 +2049,7 @@ _wsi_display_queue_next(struct wsi_swapchain *drv_chain)
 static VkResult
 wsi_display_queue_present(struct wsi_swapchain *drv_chain,
                           uint32_t image_index,
+                          const VkPresentTimeGOOGLE *present_time,
                           const VkPresentRegionKHR *damage)
 {
    struct wsi_display_swapchain *chain =
@@ -1916,6 +2070,13 @@ wsi_display_queue_present(struct wsi_swapchain *drv_chain,
    image->flip_sequence = ++chain->flip_sequence;
    image->state = WSI_IMAGE_QUEUED;
 
+   image->has_present_time = present_time != NULL;
+   image->paced = false;
+   image->present_id = present_time ? present_time->presentID : 0;
+   image->desired_present_time =
+      present_time ? present_time->desiredPresentTime : 0;
+   image->earliest_present_time = 0;
+
    result = _wsi_display_queue_next(drv_chain);
    if (result != VK_SUCCESS)
       chain->status = result;
@@ -1928,6 +2089,50 @@ wsi_display_queue_present(struct wsi_swapchain *drv_chain,
    return chain->status;
 }
 
+static VkResult
+wsi_display_get_refresh_cycle_duration(struct wsi_swapchain *drv_chain,
+                                       VkRefreshCycleDurationGOOGLE *duration)
+{
+   struct wsi_display_swapchain *chain =
+      (struct wsi_display_swapchain *) drv_chain;
+
+   duration->refreshDuration = chain->refresh_duration;
+   return VK_SUCCESS;
+}
+
+static VkResult
+wsi_display_get_past_presentation_timing(struct wsi_swapchain *drv_chain,
+                                         uint32_t *count,
+                                         VkPastPresentationTimingGOOGLE *timings)
+{
+   struct wsi_display_swapchain *chain =
+      (struct wsi_display_swapchain *) drv_chain;
+   struct wsi_display *wsi = chain->wsi;
+   VkResult result = VK_SUCCESS;
+
+   pthread_mutex_lock(&wsi->wait_mutex);
+
+   if (!timings) {
+      *count = chain->past_timing_count;
+   } else {
+      /* Returned timings are consumed */
+      uint32_t n = MIN2(*count, chain->past_timing_count);
+      for (uint32_t i = 0; i < n; i++) {
+         timings[i] = chain->past_timings[chain->past_timing_first];
+         chain->past_timing_first =
+            (chain->past_timing_first + 1) % WSI_DISPLAY_PAST_TIMINGS;
+      }
+      chain->past_timing_count -= n;
+      *count = n;
+      if (chain->past_timing_count)
+         result = VK_INCOMPLETE;
+   }
+
+   pthread_mutex_unlock(&wsi->wait_mutex);
+
+   return result;
+}
+
 static VkResult
 wsi_display_surface_create_swapchain(
    VkIcdSurfaceBase *icd_surface,
@@ -1962,6 +2167,10 @@ wsi_display_surface_create_swapchain(
    chain->base.get_wsi_image = wsi_display_get_wsi_image;
    chain->base.acquire_next_image = wsi_display_acquire_next_image;
    chain->base.queue_present = wsi_display_queue_present;
+   chain->base.get_refresh_cycle_duration =
+      wsi_display_get_refresh_cycle_duration;
+   chain->base.get_past_presentation_timing =
+      wsi_display_get_past_presentation_timing;
    chain->base.present_mode = wsi_swapchain_get_present_mode(wsi_device, create_info);
    chain->base.image_count = num_images;
 
@@ -1970,6 +2179,11 @@ wsi_display_surface_create_swapchain(
 
    chain->surface = (VkIcdSurfaceDisplay *) icd_surface;
 
+   wsi_display_mode *display_mode =
+      wsi_display_mode_from_handle(chain->surface->displayMode);
+   chain->refresh_duration =
+      (uint64_t) (1.0e9 / wsi_display_mode_refresh(display_mode) + 0.5);
+
    result = wsi_configure_native_image(&chain->base, create_info,
                                        0, NULL, NULL,
                                        NULL /* alloc_shm */,
@@ -121,7 +121,15 @@ struct wsi_swapchain {
                                   uint32_t *image_index);
    VkResult (*queue_present)(struct wsi_swapchain *swap_chain,
                              uint32_t image_index,
+                             const VkPresentTimeGOOGLE *present_time,
                              const VkPresentRegionKHR *damage);
+
+   /* Optional, for VK_GOOGLE_display_timing */
+   VkResult (*get_refresh_cycle_duration)(struct wsi_swapchain *swap_chain,
+                                          VkRefreshCycleDurationGOOGLE *duration);
+   VkResult (*get_past_presentation_timing)(struct wsi_swapchain *swap_chain,
+                                            uint32_t *count,
+                                            VkPastPresentationTimingGOOGLE *timings);
 };
 
 bool
@@ -483,6 +483,7 @@ wsi_win32_acquire_next_image(struct wsi_swapchain *drv_chain,
 static VkResult
 wsi_win32_queue_present(struct wsi_swapchain *drv_chain,
                           uint32_t image_index,
+                          const VkPresentTimeGOOGLE *present_time,
                           const VkPresentRegionKHR *damage)
 {
    struct wsi_win32_swapchain *chain = (struct wsi_win32_swapchain *) drv_chain;
@@ -1365,6 +1365,7 @@ x11_acquire_next_image(struct wsi_swapchain *anv_chain,
 static VkResult
 x11_queue_present(struct wsi_swapchain *anv_chain,
                   uint32_t image_index,
+                  const VkPresentTimeGOOGLE *present_time,
                   const VkPresentRegionKHR *damage)
 {
    struct x11_swapchain *chain = (struct x11_swapchain *)anv_chain;
@@ -1396,7 +1397,7 @@ x11_queue_present(struct wsi_swapchain *anv_chain,
       wsi_queue_push(&chain->present_queue, image_index);
       return chain->status;
    } else {
-      /* No present queue means immedate mode, so we present immediately. */
+      /* No present queue means a software driver, so we present immediately. */
       return x11_present_to_x11(chain, image_index, 0);
    }
 }
@@ -1444,14 +1445,15 @@ static unsigned x11_driver_owned_images(const struct x11_swapchain *chain)
 
 /**
  * Our queue manager. Albeit called x11_manage_fifo_queues only directly
- * manages the present-queue and does this in general in fifo and mailbox presentation
- * modes (there is no present-queue in immediate mode with the exception of Xwayland).
+ * manages the present-queue and does this in all presentation modes on
+ * hardware drivers.
  *
  * Runs in a separate thread, blocks and reacts to queued images on the
  * present-queue
  *
- * In mailbox mode the queue management is simplified since we only need to
- * pull new images from the present queue and can directly present them.
+ * In mailbox and immediate mode the queue management is simplified since we
+ * only need to pull new images from the present queue and can directly present
+ * them.
  *
  * In fifo mode images can only be presented one after the other. For that after
  * sending the image to the X server we wait until the image either has been
@@ -2103,17 +2105,16 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
     * - Acquire queue: for images already presented but not yet released by the
     *                  X server.
     *
-    * In general queues are not used on software drivers, otherwise which queues
-    * are used depends on our presentation mode:
+    * Queues are not used on software drivers, otherwise which queues are used
+    * depends on our presentation mode:
     * - Fifo: present and acquire
-    * - Mailbox: present only
-    * - Immediate: present when we wait on fences before buffer submission (Xwayland)
+    * - Mailbox and Immediate: present only
+    *
+    * Immediate mode gets a present queue too, so that the round-trip to the
+    * X server happens on the queue manager thread and not in the
+    * application's vkQueuePresentKHR.
     */
-   if ((chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR ||
-        chain->base.present_mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR ||
-        x11_needs_wait_for_fences(wsi_device, wsi_conn,
-                                  chain->base.present_mode)) &&
-       !chain->base.wsi->sw) {
+   if (!chain->base.wsi->sw) {
       chain->has_present_queue = true;
 
       /* The queues have a length of base.image_count + 1 because we will